@@ -396,6 +396,16 @@ void Client::entityRemove(frontend::ClientEntityId id) {
 	_worldRenderer.entityMgr().removeEntity(id);
 }
 
+void Client::entityUpdate(const frontend::ClientEntityPtr& entity, const frontend::EntitySnapshot& snapshot) {
+	// our own player is not interpolated - and servers without timestamps can't be interpolated
+	if (entity == _player || snapshot.serverMillis <= 0.0) {
+		entity->setPosition(snapshot.position);
+		entity->setOrientation(snapshot.orientation);
+		return;
+	}
+	_worldRenderer.entityMgr().addSnapshot(entity->id(), snapshot);
+}
+
 void Client::spawn(frontend::ClientEntityId id, const char *name, const glm::vec3& pos, float orientation) {
 	Log::info("User %li (%s) logged in at pos %f:%f:%f with orientation: %f", id, name, pos.x, pos.y, pos.z, orientation);
 	_camera.setTarget(pos);
@@ -106,6 +106,8 @@ public:
 
 	void entitySpawn(frontend::ClientEntityId id, network::EntityType type, float orientation, const glm::vec3& pos, animation::Animation animation);
 	void entityRemove(frontend::ClientEntityId id);
+	/** @brief remote entities are interpolated between the received server states */
+	void entityUpdate(const frontend::ClientEntityPtr& entity, const frontend::EntitySnapshot& snapshot);
 	frontend::ClientEntityPtr getEntity(frontend::ClientEntityId id) const;
 };
 
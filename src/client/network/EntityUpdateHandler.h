@@ -20,8 +20,7 @@ CLIENTPROTOHANDLERIMPL(EntityUpdate) {
 	const network::Animation animation = message->animation();
 	const glm::vec3 pos(_pos->x(), _pos->y(), _pos->z());
 	const float orientation = message->rotation();
-	entity->setPosition(pos);
-	entity->setOrientation(orientation);
+	client->entityUpdate(entity, frontend::EntitySnapshot{(double)message->serverMillis(), pos, orientation});
 	// TODO: get all animations from server - the full array
 	entity->setAnimation(animation, true);
 }
@@ -0,0 +1,40 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "IProtocolMessage.h"
+
+namespace ai {
+
+/**
+ * @brief Message for the remote debugging interface
+ *
+ * Acknowledges the snapshot of an @c AIStateDeltaMessage. The server uses the acknowledged
+ * snapshot as the baseline for the next deltas.
+ */
+class AIStateAckMessage: public IProtocolMessage {
+private:
+	uint32_t _snapshotId;
+
+public:
+	explicit AIStateAckMessage(uint32_t snapshotId) :
+			IProtocolMessage(PROTO_STATEACK), _snapshotId(snapshotId) {
+	}
+
+	explicit AIStateAckMessage(streamContainer& in) :
+			IProtocolMessage(PROTO_STATEACK) {
+		_snapshotId = static_cast<uint32_t>(readInt(in));
+	}
+
+	void serialize(streamContainer& out) const override {
+		addByte(out, _id);
+		addInt(out, static_cast<int32_t>(_snapshotId));
+	}
+
+	inline uint32_t getSnapshotId() const {
+		return _snapshotId;
+	}
+};
+
+}
@@ -0,0 +1,88 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "AIStateMessage.h"
+
+namespace ai {
+
+/**
+ * @brief Message for the remote debugging interface
+ *
+ * The state of the world for a client that subscribed with an @c AISubscribeMessage. The message
+ * is relative to the baseline snapshot that was acknowledged by the client. It contains the characters
+ * that entered the subscription or changed since the baseline - and the ids of the characters that
+ * left the subscription or the zone. A baseline of @c 0 is the empty snapshot.
+ *
+ * @see StateSnapshots
+ */
+class AIStateDeltaMessage: public AIStateMessage {
+private:
+	uint32_t _snapshotId;
+	uint32_t _baselineId;
+	std::vector<CharacterId> _removed;
+
+public:
+	AIStateDeltaMessage(uint32_t snapshotId = 0u, uint32_t baselineId = 0u) :
+			AIStateMessage(PROTO_STATEDELTA), _snapshotId(snapshotId), _baselineId(baselineId) {
+	}
+
+	explicit AIStateDeltaMessage(streamContainer& in) :
+			AIStateMessage(PROTO_STATEDELTA) {
+		_snapshotId = static_cast<uint32_t>(readInt(in));
+		_baselineId = static_cast<uint32_t>(readInt(in));
+		readStates(in);
+		const int removedSize = readInt(in);
+		_removed.reserve(removedSize);
+		for (int i = 0; i < removedSize; ++i) {
+			_removed.push_back(readInt(in));
+		}
+	}
+
+	void serialize(streamContainer& out) const override {
+		addByte(out, _id);
+		addInt(out, static_cast<int32_t>(_snapshotId));
+		addInt(out, static_cast<int32_t>(_baselineId));
+		writeStates(out);
+		addInt(out, static_cast<int>(_removed.size()));
+		for (const CharacterId& id : _removed) {
+			addInt(out, id);
+		}
+	}
+
+	void clear() {
+		_states.clear();
+		_removed.clear();
+	}
+
+	void addRemoved(const CharacterId& id) {
+		_removed.push_back(id);
+	}
+
+	inline void setSnapshot(uint32_t snapshotId, uint32_t baselineId) {
+		_snapshotId = snapshotId;
+		_baselineId = baselineId;
+	}
+
+	/**
+	 * @return The ids of the characters that are no longer part of the subscription
+	 */
+	inline const std::vector<CharacterId>& getRemoved() const {
+		return _removed;
+	}
+
+	inline uint32_t getSnapshotId() const {
+		return _snapshotId;
+	}
+
+	inline uint32_t getBaselineId() const {
+		return _baselineId;
+	}
+
+	inline bool empty() const {
+		return _states.empty() && _removed.empty();
+	}
+};
+
+}
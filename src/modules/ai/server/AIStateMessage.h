@@ -15,7 +15,7 @@ namespace ai {
  * State of the world. You receive basic information about every watched AI controller entity
  */
 class AIStateMessage: public IProtocolMessage {
-private:
+protected:
 	typedef std::vector<AIStateWorld> States;
 	States _states;
 
@@ -61,6 +61,24 @@ private:
 		}
 	}
 
+	void readStates(streamContainer& in) {
+		const int treeSize = readInt(in);
+		for (int i = 0; i < treeSize; ++i) {
+			readState(in);
+		}
+	}
+
+	void writeStates(streamContainer& out) const {
+		addInt(out, static_cast<int>(_states.size()));
+		for (States::const_iterator i = _states.begin(); i != _states.end(); ++i) {
+			writeState(out, *i);
+		}
+	}
+
+	explicit AIStateMessage(const ProtocolId& id) :
+			IProtocolMessage(id) {
+	}
+
 public:
 	AIStateMessage() :
 			IProtocolMessage(PROTO_STATE) {
@@ -68,10 +86,7 @@ public:
 
 	explicit AIStateMessage(streamContainer& in) :
 			IProtocolMessage(PROTO_STATE) {
-		const int treeSize = readInt(in);
-		for (int i = 0; i < treeSize; ++i) {
-			readState(in);
-		}
+		readStates(in);
 	}
 
 	void addState(const AIStateWorld& tree) {
@@ -84,10 +99,7 @@ public:
 
 	void serialize(streamContainer& out) const override {
 		addByte(out, _id);
-		addInt(out, static_cast<int>(_states.size()));
-		for (States::const_iterator i = _states.begin(); i != _states.end(); ++i) {
-			writeState(out, *i);
-		}
+		writeStates(out);
 	}
 
 	inline const std::vector<AIStateWorld>& getStates() const {
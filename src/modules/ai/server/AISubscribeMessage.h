@@ -0,0 +1,73 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "IProtocolMessage.h"
+#include "AI.h"
+#include <glm/vec2.hpp>
+
+namespace ai {
+
+/**
+ * @brief Message for the remote debugging interface
+ *
+ * Switches the sending client into the streaming mode. Instead of the full @c AIStateMessage the
+ * client only receives @c AIStateDeltaMessage with the characters that are inside the given
+ * viewport rectangle (on the x and z axis) or that are selected. Every @c AIStateDeltaMessage
+ * must be acknowledged with an @c AIStateAckMessage.
+ *
+ * Sending this message again changes the viewport or the selection of the subscription.
+ */
+class AISubscribeMessage: public IProtocolMessage {
+private:
+	glm::vec2 _mins;
+	glm::vec2 _maxs;
+	ai::CharacterId _chrId;
+
+public:
+	AISubscribeMessage(const glm::vec2& mins, const glm::vec2& maxs, ai::CharacterId id = AI_NOTHING_SELECTED) :
+			IProtocolMessage(PROTO_SUBSCRIBE), _mins(mins), _maxs(maxs), _chrId(id) {
+	}
+
+	explicit AISubscribeMessage(streamContainer& in) :
+			IProtocolMessage(PROTO_SUBSCRIBE) {
+		_mins.x = readFloat(in);
+		_mins.y = readFloat(in);
+		_maxs.x = readFloat(in);
+		_maxs.y = readFloat(in);
+		_chrId = readInt(in);
+	}
+
+	void serialize(streamContainer& out) const override {
+		addByte(out, _id);
+		addFloat(out, _mins.x);
+		addFloat(out, _mins.y);
+		addFloat(out, _maxs.x);
+		addFloat(out, _maxs.y);
+		addInt(out, _chrId);
+	}
+
+	/**
+	 * @return The lower corner of the viewport on the x and z axis
+	 */
+	inline const glm::vec2& getMins() const {
+		return _mins;
+	}
+
+	/**
+	 * @return The upper corner of the viewport on the x and z axis
+	 */
+	inline const glm::vec2& getMaxs() const {
+		return _maxs;
+	}
+
+	/**
+	 * @return The selected character that is part of the stream even if it is outside of the viewport
+	 */
+	inline const CharacterId& getCharacterId() const {
+		return _chrId;
+	}
+};
+
+}
@@ -42,7 +42,7 @@
 namespace ai {
 
 Network::Network(uint16_t port, const core::String& hostname) :
-		_port(port), _hostname(hostname), _socketFD(INVALID_SOCKET), _time(0L) {
+		_port(port), _hostname(hostname), _socketFD(INVALID_SOCKET), _time(0L), _nextClientId(0) {
 	FD_ZERO(&_readFDSet);
 	FD_ZERO(&_writeFDSet);
 }
@@ -178,7 +178,7 @@ void Network::update(int64_t deltaTime) {
 		const SOCKET clientSocket = accept(_socketFD, nullptr, nullptr);
 		if (clientSocket != INVALID_SOCKET) {
 			FD_SET(clientSocket, &_readFDSet);
-			const Client c(clientSocket);
+			const Client c(_nextClientId++, clientSocket);
 			_clientSockets.push_back(c);
 			for (INetworkListener* listener : _listeners) {
 				listener->onConnect(&_clientSockets.back());
@@ -186,8 +186,7 @@ void Network::update(int64_t deltaTime) {
 		}
 	}
 
-	ClientId clientId = 0;
-	for (ClientSocketsIter i = _clientSockets.begin(); i != _clientSockets.end(); ++clientId) {
+	for (ClientSocketsIter i = _clientSockets.begin(); i != _clientSockets.end();) {
 		Client& client = *i;
 		const SOCKET clientSocket = client.socket;
 		if (clientSocket == INVALID_SOCKET) {
@@ -221,14 +220,23 @@ void Network::update(int64_t deltaTime) {
 			}
 			IProtocolHandler* handler = ProtocolHandlerRegistry::get().getHandler(*msg);
 			if (handler) {
-				handler->execute(clientId, *msg);
+				handler->execute(client.id, *msg);
 			}
 		}
 		++i;
 	}
 }
 
-bool Network::broadcast(const IProtocolMessage& msg) {
+Client* Network::getClient(const ClientId& id) {
+	for (Client& client : _clientSockets) {
+		if (client.id == id) {
+			return client.socket == INVALID_SOCKET ? nullptr : &client;
+		}
+	}
+	return nullptr;
+}
+
+bool Network::broadcast(const IProtocolMessage& msg, bool includeStreaming) {
 	if (_clientSockets.empty()) {
 		return false;
 	}
@@ -241,6 +249,9 @@ bool Network::broadcast(const IProtocolMessage& msg) {
 			i = closeClient(i);
 			continue;
 		}
+		if (!includeStreaming && client.streaming) {
+			continue;
+		}
 
 		IProtocolMessage::addInt(client.out, static_cast<int32_t>(out.size()));
 		std::copy(out.begin(), out.end(), std::back_inserter(client.out));
@@ -25,11 +25,15 @@ namespace ai {
 class IProtocolMessage;
 
 struct Client {
-	explicit Client(SOCKET _socket) :
-			socket(_socket), finished(false), in(), out() {
+	Client(ClientId _id, SOCKET _socket) :
+			id(_id), socket(_socket), finished(false), streaming(false), in(), out() {
 	}
+	// unique for the lifetime of the network
+	ClientId id;
 	SOCKET socket;
 	bool finished;
+	// the client subscribed to state deltas and doesn't get the full state broadcasts
+	bool streaming;
 	streamContainer in;
 	streamContainer out;
 };
@@ -51,6 +55,7 @@ protected:
 	fd_set _readFDSet;
 	fd_set _writeFDSet;
 	int64_t _time;
+	ClientId _nextClientId;
 
 	typedef std::list<Client> ClientSockets;
 	typedef ClientSockets::iterator ClientSocketsIter;
@@ -74,9 +79,16 @@ public:
 	int getConnectedClients() const;
 
 	/**
+	 * @return The connected client with the given id or @c nullptr
+	 */
+	Client* getClient(const ClientId& id);
+
+	/**
+	 * @param[in] includeStreaming If @c false the message is not sent to clients that are in
+	 * the streaming mode (see @c Client::streaming)
 	 * @return @c false if there are no clients
 	 */
-	bool broadcast(const IProtocolMessage& msg);
+	bool broadcast(const IProtocolMessage& msg, bool includeStreaming = true);
 	bool sendToClient(Client* client, const IProtocolMessage& msg);
 };
 
@@ -14,6 +14,9 @@
 #include "AIUpdateNodeMessage.h"
 #include "AIAddNodeMessage.h"
 #include "AIDeleteNodeMessage.h"
+#include "AISubscribeMessage.h"
+#include "AIStateDeltaMessage.h"
+#include "AIStateAckMessage.h"
 
 namespace ai {
 
@@ -30,7 +33,10 @@ ProtocolMessageFactory::ProtocolMessageFactory() :
 	_aiCharacterStatic(new uint8_t[sizeof(AICharacterStaticMessage)]),
 	_aiUpdateNode(new uint8_t[sizeof(AIUpdateNodeMessage)]),
 	_aiAddNode(new uint8_t[sizeof(AIAddNodeMessage)]),
-	_aiDeleteNode(new uint8_t[sizeof(AIDeleteNodeMessage)]) {
+	_aiDeleteNode(new uint8_t[sizeof(AIDeleteNodeMessage)]),
+	_aiSubscribe(new uint8_t[sizeof(AISubscribeMessage)]),
+	_aiStateDelta(new uint8_t[sizeof(AIStateDeltaMessage)]),
+	_aiStateAck(new uint8_t[sizeof(AIStateAckMessage)]) {
 }
 
 ProtocolMessageFactory::~ProtocolMessageFactory() {
@@ -47,6 +53,9 @@ ProtocolMessageFactory::~ProtocolMessageFactory() {
 	delete[] _aiUpdateNode;
 	delete[] _aiAddNode;
 	delete[] _aiDeleteNode;
+	delete[] _aiSubscribe;
+	delete[] _aiStateDelta;
+	delete[] _aiStateAck;
 }
 
 bool ProtocolMessageFactory::isNewMessageAvailable(const streamContainer& in) const {
@@ -95,6 +104,12 @@ IProtocolMessage *ProtocolMessageFactory::create(streamContainer& in) {
 		return new (_aiAddNode) AIAddNodeMessage(in);
 	} else if (type == PROTO_DELETENODE) {
 		return new (_aiDeleteNode) AIDeleteNodeMessage(in);
+	} else if (type == PROTO_SUBSCRIBE) {
+		return new (_aiSubscribe) AISubscribeMessage(in);
+	} else if (type == PROTO_STATEDELTA) {
+		return new (_aiStateDelta) AIStateDeltaMessage(in);
+	} else if (type == PROTO_STATEACK) {
+		return new (_aiStateAck) AIStateAckMessage(in);
 	}
 
 	return nullptr;
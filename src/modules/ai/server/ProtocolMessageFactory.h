@@ -23,6 +23,9 @@ private:
 	uint8_t *_aiUpdateNode;
 	uint8_t *_aiAddNode;
 	uint8_t *_aiDeleteNode;
+	uint8_t *_aiSubscribe;
+	uint8_t *_aiStateDelta;
+	uint8_t *_aiStateAck;
 
 	ProtocolMessageFactory();
 public:
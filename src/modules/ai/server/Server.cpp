@@ -11,12 +11,15 @@
 #include "AddNodeHandler.h"
 #include "DeleteNodeHandler.h"
 #include "UpdateNodeHandler.h"
+#include "SubscribeHandler.h"
+#include "StateAckHandler.h"
 
 #include "AIPauseMessage.h"
 #include "AIStateMessage.h"
 #include "AINamesMessage.h"
 #include "AICharacterDetailsMessage.h"
 #include "AICharacterStaticMessage.h"
+#include "AIStateDeltaMessage.h"
 
 #include "conditions/ConditionParser.h"
 #include "tree/TreeNodeParser.h"
@@ -27,13 +30,27 @@ namespace ai {
 namespace {
 const int SV_BROADCAST_CHRDETAILS = 1 << 0;
 const int SV_BROADCAST_STATE      = 1 << 1;
+
+uint64_t hashMessage(const IProtocolMessage& msg) {
+	streamContainer out;
+	msg.serialize(out);
+	// fnv-1a
+	uint64_t hash = 14695981039346656037ull;
+	for (uint8_t byte : out) {
+		hash ^= byte;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
 }
 
 Server::Server(AIRegistry& aiRegistry, short port, const core::String& hostname) :
 		_aiRegistry(aiRegistry), _network(port, hostname), _selectedCharacterId(AI_NOTHING_SELECTED), _time(0L),
 		_selectHandler(new SelectHandler(*this)), _pauseHandler(new PauseHandler(*this)), _resetHandler(new ResetHandler(*this)),
 		_stepHandler(new StepHandler(*this)), _changeHandler(new ChangeHandler(*this)), _addNodeHandler(new AddNodeHandler(*this)),
-		_deleteNodeHandler(new DeleteNodeHandler(*this)), _updateNodeHandler(new UpdateNodeHandler(*this)), _pause(false), _zone(nullptr) {
+		_deleteNodeHandler(new DeleteNodeHandler(*this)), _updateNodeHandler(new UpdateNodeHandler(*this)),
+		_subscribeHandler(new SubscribeHandler(*this)), _stateAckHandler(new StateAckHandler(*this)), _pause(false), _zone(nullptr) {
 	_network.addListener(this);
 	ProtocolHandlerRegistry& r = ai::ProtocolHandlerRegistry::get();
 	r.registerHandler(ai::PROTO_SELECT, _selectHandler);
@@ -45,6 +62,8 @@ Server::Server(AIRegistry& aiRegistry, short port, const core::String& hostname)
 	r.registerHandler(ai::PROTO_ADDNODE, _addNodeHandler);
 	r.registerHandler(ai::PROTO_DELETENODE, _deleteNodeHandler);
 	r.registerHandler(ai::PROTO_UPDATENODE, _updateNodeHandler);
+	r.registerHandler(ai::PROTO_SUBSCRIBE, _subscribeHandler);
+	r.registerHandler(ai::PROTO_STATEACK, _stateAckHandler);
 }
 
 Server::~Server() {
@@ -56,6 +75,8 @@ Server::~Server() {
 	delete _addNodeHandler;
 	delete _deleteNodeHandler;
 	delete _updateNodeHandler;
+	delete _subscribeHandler;
+	delete _stateAckHandler;
 	_network.removeListener(this);
 }
 
@@ -71,8 +92,9 @@ void Server::onConnect(Client* client) {
 	enqueueEvent(event);
 }
 
-void Server::onDisconnect(Client* /*client*/) {
+void Server::onDisconnect(Client* client) {
 	ai_log("remote debugger disconnect (%i)", _network.getConnectedClients());
+	_subscriptions.erase(client->id);
 	Zone* zone = _zone;
 	if (zone == nullptr) {
 		return;
@@ -130,14 +152,105 @@ void Server::addChildren(const TreeNodePtr& node, AIStateNode& parent, const AIP
 void Server::broadcastState(const Zone* zone) {
 	core_trace_scoped(AIServerBroadcastState);
 	_broadcastMask |= SV_BROADCAST_STATE;
+	// only serialize the whole zone if there is at least one client that is not in the streaming mode
+	const bool fullState = _network.getConnectedClients() > (int)_subscriptions.size();
+	for (auto& e : _subscriptions) {
+		e.second.beginSnapshot();
+	}
 	AIStateMessage msg;
 	auto func = [&] (const AIPtr& ai) {
 		const ICharacterPtr& chr = ai->getCharacter();
+		for (auto& e : _subscriptions) {
+			e.second.addCharacter(*chr);
+		}
+		if (!fullState) {
+			return;
+		}
 		const AIStateWorld b(chr->getId(), chr->getPosition(), chr->getOrientation(), chr->getAttributes());
 		msg.addState(b);
 	};
 	zone->execute(func);
-	_network.broadcast(msg);
+	if (fullState) {
+		_network.broadcast(msg, false);
+	}
+	for (auto& e : _subscriptions) {
+		const AIStateDeltaMessage* delta = e.second.endSnapshot();
+		if (delta == nullptr) {
+			continue;
+		}
+		Client* client = _network.getClient(e.first);
+		if (client != nullptr) {
+			_network.sendToClient(client, *delta);
+		}
+	}
+}
+
+void Server::createStaticCharacterDetails(const AIPtr& ai, std::vector<AIStateNodeStatic>& out) const {
+	const TreeNodePtr& node = ai->getBehaviour();
+	const int32_t nodeId = node->getId();
+	out.push_back(AIStateNodeStatic(nodeId, node->getName(), node->getType(), node->getParameters(), node->getCondition()->getName(), node->getCondition()->getParameters()));
+	addChildren(node, out);
+}
+
+AIStateNode Server::createCharacterDetails(const AIPtr& ai, AIStateAggro& aggro) const {
+	const TreeNodePtr& node = ai->getBehaviour();
+	const int32_t nodeId = node->getId();
+	const ConditionPtr& condition = node->getCondition();
+	const core::String conditionStr = condition ? condition->getNameWithConditions(ai) : "";
+	AIStateNode root(nodeId, conditionStr, _time - node->getLastExecMillis(ai), node->getLastStatus(ai), true);
+	addChildren(node, root, ai);
+
+	const ai::AggroMgr::Entries& entries = ai->getAggroMgr().getEntries();
+	aggro.reserve(entries.size());
+	for (const Entry& e : entries) {
+		aggro.addAggro(AIStateAggroEntry(e.getCharacterId(), e.getAggro()));
+	}
+	return root;
+}
+
+void Server::sendStaticCharacterDetails(const Zone* zone, Client* client, CharacterId id) {
+	if (id == AI_NOTHING_SELECTED) {
+		return;
+	}
+	auto func = [&] (const AIPtr& ai) {
+		if (!ai) {
+			return false;
+		}
+		std::vector<AIStateNodeStatic> nodeStaticData;
+		createStaticCharacterDetails(ai, nodeStaticData);
+		const AICharacterStaticMessage msgStatic(ai->getId(), nodeStaticData);
+		_network.sendToClient(client, msgStatic);
+		return true;
+	};
+	zone->execute(id, func);
+}
+
+void Server::sendCharacterDetails(const Zone* zone) {
+	for (auto& e : _subscriptions) {
+		StateSubscription& subscription = e.second;
+		const CharacterId id = subscription.selection();
+		if (id == AI_NOTHING_SELECTED) {
+			continue;
+		}
+		Client* client = _network.getClient(e.first);
+		if (client == nullptr) {
+			continue;
+		}
+		auto func = [&] (const AIPtr& ai) {
+			if (!ai) {
+				return false;
+			}
+			AIStateAggro aggro;
+			const AIStateNode& root = createCharacterDetails(ai, aggro);
+			const AICharacterDetailsMessage msg(ai->getId(), aggro, root);
+			// don't resend the behaviour tree state if nothing changed since the last time
+			if (subscription.updateDetails(hashMessage(msg))) {
+				_network.sendToClient(client, msg);
+			}
+			return true;
+		};
+		zone->execute(id, func);
+	}
 }
 
 void Server::broadcastStaticCharacterDetails(const Zone* zone) {
@@ -151,10 +264,7 @@ void Server::broadcastStaticCharacterDetails(const Zone* zone) {
 			return false;
 		}
 		std::vector<AIStateNodeStatic> nodeStaticData;
-		const TreeNodePtr& node = ai->getBehaviour();
-		const int32_t nodeId = node->getId();
-		nodeStaticData.push_back(AIStateNodeStatic(nodeId, node->getName(), node->getType(), node->getParameters(), node->getCondition()->getName(), node->getCondition()->getParameters()));
-		addChildren(node, nodeStaticData);
+		createStaticCharacterDetails(ai, nodeStaticData);
 
 		const AICharacterStaticMessage msgStatic(ai->getId(), nodeStaticData);
 		_network.broadcast(msgStatic);
@@ -168,8 +278,9 @@ void Server::broadcastStaticCharacterDetails(const Zone* zone) {
 void Server::broadcastCharacterDetails(const Zone* zone) {
 	core_trace_scoped(AIServerBroadcastCharacterDetails);
 	_broadcastMask |= SV_BROADCAST_CHRDETAILS;
+	sendCharacterDetails(zone);
 	const CharacterId id = _selectedCharacterId;
-	if (id == AI_NOTHING_SELECTED) {
+	if (id == AI_NOTHING_SELECTED || _network.getConnectedClients() <= (int)_subscriptions.size()) {
 		return;
 	}
 
@@ -177,22 +288,10 @@ void Server::broadcastCharacterDetails(const Zone* zone) {
 		if (!ai) {
 			return false;
 		}
-		const TreeNodePtr& node = ai->getBehaviour();
-		const int32_t nodeId = node->getId();
-		const ConditionPtr& condition = node->getCondition();
-		const core::String conditionStr = condition ? condition->getNameWithConditions(ai) : "";
-		AIStateNode root(nodeId, conditionStr, _time - node->getLastExecMillis(ai), node->getLastStatus(ai), true);
-		addChildren(node, root, ai);
-
 		AIStateAggro aggro;
-		const ai::AggroMgr::Entries& entries = ai->getAggroMgr().getEntries();
-		aggro.reserve(entries.size());
-		for (const Entry& e : entries) {
-			aggro.addAggro(AIStateAggroEntry(e.getCharacterId(), e.getAggro()));
-		}
-
+		const AIStateNode& root = createCharacterDetails(ai, aggro);
 		const AICharacterDetailsMessage msg(ai->getId(), aggro, root);
-		_network.broadcast(msg);
+		_network.broadcast(msg, false);
 		return true;
 	};
 	if (!zone->execute(id, func)) {
@@ -317,6 +416,41 @@ void Server::handleEvents(Zone* zone, bool pauseState) {
 
 			break;
 		}
+		case EV_SUBSCRIBE: {
+			const ClientId clientId = event.data.subscribe.clientId;
+			Client* client = _network.getClient(clientId);
+			if (client == nullptr) {
+				break;
+			}
+			client->streaming = true;
+			const glm::vec2 mins(event.data.subscribe.mins[0], event.data.subscribe.mins[1]);
+			const glm::vec2 maxs(event.data.subscribe.maxs[0], event.data.subscribe.maxs[1]);
+			const CharacterId characterId = event.data.subscribe.characterId;
+			auto i = _subscriptions.find(clientId);
+			if (i == _subscriptions.end()) {
+				i = _subscriptions.emplace(clientId, StateSubscription(mins, maxs)).first;
+			} else {
+				i->second.setViewport(mins, maxs);
+			}
+			if (i->second.selection() != characterId) {
+				i->second.setSelection(characterId);
+				if (zone != nullptr) {
+					sendStaticCharacterDetails(zone, client, characterId);
+				}
+			}
+			if (pauseState && zone != nullptr) {
+				broadcastState(zone);
+				broadcastCharacterDetails(zone);
+			}
+			break;
+		}
+		case EV_STATEACK: {
+			auto i = _subscriptions.find(event.data.ack.clientId);
+			if (i != _subscriptions.end()) {
+				i->second.ack(event.data.ack.snapshotId);
+			}
+			break;
+		}
 		case EV_MAX:
 			break;
 		}
@@ -481,6 +615,26 @@ void Server::pause(const ClientId& /*clientId*/, bool state) {
 	enqueueEvent(event);
 }
 
+void Server::subscribe(const ClientId& clientId, const glm::vec2& mins, const glm::vec2& maxs, const CharacterId& id) {
+	Event event;
+	event.type = EV_SUBSCRIBE;
+	event.data.subscribe.clientId = clientId;
+	event.data.subscribe.characterId = id;
+	event.data.subscribe.mins[0] = mins.x;
+	event.data.subscribe.mins[1] = mins.y;
+	event.data.subscribe.maxs[0] = maxs.x;
+	event.data.subscribe.maxs[1] = maxs.y;
+	enqueueEvent(event);
+}
+
+void Server::ack(const ClientId& clientId, uint32_t snapshotId) {
+	Event event;
+	event.type = EV_STATEACK;
+	event.data.ack.clientId = clientId;
+	event.data.ack.snapshotId = snapshotId;
+	enqueueEvent(event);
+}
+
 void Server::step(int64_t stepMillis) {
 	Event event;
 	event.type = EV_STEP;
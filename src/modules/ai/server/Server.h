@@ -11,7 +11,9 @@
 #include "AIRegistry.h"
 #include "AIStubTypes.h"
 #include "ProtocolHandlerRegistry.h"
+#include "StateSubscription.h"
 #include "tree/TreeNode.h"
+#include <unordered_map>
 
 namespace ai {
 
@@ -26,6 +28,8 @@ class ChangeHandler;
 class AddNodeHandler;
 class DeleteNodeHandler;
 class UpdateNodeHandler;
+class SubscribeHandler;
+class StateAckHandler;
 class NopHandler;
 
 /**
@@ -40,6 +44,11 @@ class NopHandler;
  * will also broadcast an @ai{AICharacterDetailsMessage} to all connected clients.
  *
  * You can only debug one @ai{Zone} at the same time. The debugging session is shared between all connected clients.
+ *
+ * Clients that send an @ai{AISubscribeMessage} are switched into the streaming mode. They don't get the full
+ * world state, but only the @ai{AIStateDeltaMessage} for the characters in their viewport and their own
+ * selection - relative to the last snapshot they acknowledged with @ai{AIStateAckMessage}. The character
+ * details are only sent to them for their own selection and only if they changed.
  */
 class Server: public INetworkListener {
 protected:
@@ -59,6 +68,8 @@ protected:
 	AddNodeHandler *_addNodeHandler;
 	DeleteNodeHandler *_deleteNodeHandler;
 	UpdateNodeHandler *_updateNodeHandler;
+	SubscribeHandler *_subscribeHandler;
+	StateAckHandler *_stateAckHandler;
 	NopHandler _nopHandler;
 	core::AtomicBool _pause;
 	// the current active debugging zone
@@ -66,6 +77,8 @@ protected:
 	core_trace_mutex(core::Lock, _lock, "AIServer");
 	std::vector<core::String> _names;
 	uint32_t _broadcastMask = 0u;
+	// the clients in the streaming mode - only touched from the Server::update method
+	std::unordered_map<ClientId, StateSubscription> _subscriptions;
 
 	enum EventType {
 		EV_SELECTION,
@@ -77,6 +90,8 @@ protected:
 		EV_PAUSE,
 		EV_RESET,
 		EV_SETDEBUG,
+		EV_SUBSCRIBE,
+		EV_STATEACK,
 
 		EV_MAX
 	};
@@ -88,6 +103,16 @@ protected:
 			Zone* zone;
 			Client* newClient;
 			bool pauseState;
+			struct {
+				ClientId clientId;
+				CharacterId characterId;
+				float mins[2];
+				float maxs[2];
+			} subscribe;
+			struct {
+				ClientId clientId;
+				uint32_t snapshotId;
+			} ack;
 		} data;
 		core::String strData = "";
 		EventType type;
@@ -98,11 +123,15 @@ protected:
 
 	void addChildren(const TreeNodePtr& node, std::vector<AIStateNodeStatic>& out) const;
 	void addChildren(const TreeNodePtr& node, AIStateNode& parent, const AIPtr& ai) const;
+	void createStaticCharacterDetails(const AIPtr& ai, std::vector<AIStateNodeStatic>& out) const;
+	AIStateNode createCharacterDetails(const AIPtr& ai, AIStateAggro& aggro) const;
 
 	// only call these from the Server::update method
 	void broadcastState(const Zone* zone);
 	void broadcastCharacterDetails(const Zone* zone);
 	void broadcastStaticCharacterDetails(const Zone* zone);
+	void sendStaticCharacterDetails(const Zone* zone, Client* client, CharacterId id);
+	void sendCharacterDetails(const Zone* zone);
 
 	void onConnect(Client* client) override;
 	void onDisconnect(Client* client) override;
@@ -198,6 +227,21 @@ public:
 	 */
 	void pause(const ClientId& clientId, bool pause);
 
+	/**
+	 * @brief Switches the client into the streaming mode or updates the viewport and the selection of the
+	 * subscription
+	 *
+	 * @param[in] mins The lower corner of the viewport on the x and z axis
+	 * @param[in] maxs The upper corner of the viewport on the x and z axis
+	 * @param[in] id The selected character that is streamed even if it's outside of the viewport
+	 */
+	void subscribe(const ClientId& clientId, const glm::vec2& mins, const glm::vec2& maxs, const CharacterId& id);
+
+	/**
+	 * @brief Acknowledges the snapshot of an @ai{AIStateDeltaMessage} for the given client
+	 */
+	void ack(const ClientId& clientId, uint32_t snapshotId);
+
 	/**
 	 * @brief Performs one step of the @ai{AI} in pause mode
 	 */
@@ -0,0 +1,21 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "IProtocolHandler.h"
+
+namespace ai {
+
+class Server;
+
+class StateAckHandler: public ai::IProtocolHandler {
+private:
+	Server& _server;
+public:
+	explicit StateAckHandler(Server& server);
+
+	void execute(const ClientId& clientId, const IProtocolMessage& message) override;
+};
+
+}
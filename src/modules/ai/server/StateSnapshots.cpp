@@ -0,0 +1,45 @@
+/**
+ * @file
+ */
+
+#include "StateSnapshots.h"
+
+namespace ai {
+
+bool StateSnapshots::apply(const AIStateDeltaMessage& msg) {
+	const uint32_t baselineId = msg.getBaselineId();
+	States states;
+	if (baselineId != 0u) {
+		auto i = _snapshots.find(baselineId);
+		if (i == _snapshots.end()) {
+			return false;
+		}
+		states = i->second;
+	}
+	for (const CharacterId& id : msg.getRemoved()) {
+		states.erase(id);
+	}
+	for (const AIStateWorld& state : msg.getStates()) {
+		states[state.getId()] = state;
+	}
+	// the server never goes back to an older baseline
+	_snapshots.erase(_snapshots.begin(), _snapshots.lower_bound(baselineId));
+	_snapshots[msg.getSnapshotId()] = std::move(states);
+	_latestId = msg.getSnapshotId();
+	return true;
+}
+
+const StateSnapshots::States& StateSnapshots::states() const {
+	auto i = _snapshots.find(_latestId);
+	if (i == _snapshots.end()) {
+		return _empty;
+	}
+	return i->second;
+}
+
+void StateSnapshots::clear() {
+	_snapshots.clear();
+	_latestId = 0u;
+}
+
+}
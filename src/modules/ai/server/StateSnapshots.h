@@ -0,0 +1,59 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "AIStateDeltaMessage.h"
+#include <unordered_map>
+#include <map>
+
+namespace ai {
+
+/**
+ * @brief Reconstructs the state of the subscribed characters on the client side from @c AIStateDeltaMessage
+ *
+ * Every applied snapshot should get acknowledged with an @c AIStateAckMessage. The snapshots are kept until
+ * the server uses a newer baseline.
+ *
+ * @see StateSubscription
+ */
+class StateSnapshots {
+public:
+	typedef std::unordered_map<CharacterId, AIStateWorld> States;
+
+private:
+	std::map<uint32_t, States> _snapshots;
+	uint32_t _latestId = 0u;
+	States _empty;
+
+public:
+	/**
+	 * @return @c false if the baseline of the message is not known - the client should subscribe again in
+	 * this case to get a full snapshot.
+	 */
+	bool apply(const AIStateDeltaMessage& msg);
+
+	/**
+	 * @return The states of the latest applied snapshot
+	 */
+	const States& states() const;
+
+	uint32_t latestSnapshotId() const;
+
+	/**
+	 * @return The amount of snapshots that are kept as possible baseline
+	 */
+	size_t size() const;
+
+	void clear();
+};
+
+inline uint32_t StateSnapshots::latestSnapshotId() const {
+	return _latestId;
+}
+
+inline size_t StateSnapshots::size() const {
+	return _snapshots.size();
+}
+
+}
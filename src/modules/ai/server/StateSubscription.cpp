@@ -0,0 +1,115 @@
+/**
+ * @file
+ */
+
+#include "StateSubscription.h"
+#include "core/Hash.h"
+#include "core/Trace.h"
+
+namespace ai {
+
+StateSubscription::StateSubscription(const glm::vec2& mins, const glm::vec2& maxs, CharacterId selection) :
+		_mins(mins), _maxs(maxs), _selection(selection) {
+}
+
+void StateSubscription::setViewport(const glm::vec2& mins, const glm::vec2& maxs) {
+	_mins = mins;
+	_maxs = maxs;
+}
+
+void StateSubscription::setSelection(CharacterId selection) {
+	if (_selection != selection) {
+		_detailsHash = 0u;
+	}
+	_selection = selection;
+}
+
+bool StateSubscription::contains(const ICharacter& chr) const {
+	if (chr.getId() == _selection) {
+		return true;
+	}
+	const glm::vec3& pos = chr.getPosition();
+	return pos.x >= _mins.x && pos.x <= _maxs.x && pos.z >= _mins.y && pos.z <= _maxs.y;
+}
+
+void StateSubscription::beginSnapshot() {
+	if (_pending.size() >= MaxPendingSnapshots) {
+		// the client doesn't acknowledge the snapshots - start over with the empty baseline
+		_pending.clear();
+		_baseline.clear();
+		_baselineId = 0u;
+	}
+	_current.clear();
+	_current.reserve(_baseline.size());
+	_delta.clear();
+}
+
+void StateSubscription::addCharacter(const ICharacter& chr) {
+	if (!contains(chr)) {
+		return;
+	}
+	const CharacterId id = chr.getId();
+	const uint64_t hash = stateHash(chr);
+	_current[id] = hash;
+	auto i = _baseline.find(id);
+	if (i != _baseline.end() && i->second == hash) {
+		return;
+	}
+	_delta.addState(AIStateWorld(id, chr.getPosition(), chr.getOrientation(), chr.getAttributes()));
+}
+
+const AIStateDeltaMessage* StateSubscription::endSnapshot() {
+	core_trace_scoped(StateSubscriptionEndSnapshot);
+	for (const auto& e : _baseline) {
+		if (_current.find(e.first) == _current.end()) {
+			_delta.addRemoved(e.first);
+		}
+	}
+	// if there are pending snapshots, the client might know a state that differs from the baseline
+	if (_delta.empty() && _pending.empty()) {
+		return nullptr;
+	}
+	if (++_lastSnapshotId == 0u) {
+		_lastSnapshotId = 1u;
+	}
+	_delta.setSnapshot(_lastSnapshotId, _baselineId);
+	_pending.push_back(PendingSnapshot{_lastSnapshotId, std::move(_current)});
+	_current = Snapshot();
+	return &_delta;
+}
+
+bool StateSubscription::ack(uint32_t snapshotId) {
+	for (auto i = _pending.begin(); i != _pending.end(); ++i) {
+		if (i->id != snapshotId) {
+			continue;
+		}
+		_baselineId = snapshotId;
+		_baseline = std::move(i->states);
+		_pending.erase(_pending.begin(), std::next(i));
+		return true;
+	}
+	return false;
+}
+
+bool StateSubscription::updateDetails(uint64_t detailsHash) {
+	if (_detailsHash == detailsHash) {
+		return false;
+	}
+	_detailsHash = detailsHash;
+	return true;
+}
+
+uint64_t StateSubscription::stateHash(const ICharacter& chr) {
+	const glm::vec3& pos = chr.getPosition();
+	const float values[] = {pos.x, pos.y, pos.z, chr.getOrientation()};
+	const uint32_t positionHash = core::hash(values, sizeof(values));
+	// the iteration order of the attributes is not defined - combine the entries order independent
+	uint32_t attributesHash = (uint32_t)chr.getAttributes().size();
+	for (const auto& e : chr.getAttributes()) {
+		const uint32_t keyHash = core::hash(e.first.c_str(), (int)e.first.size());
+		attributesHash += core::hash(e.second.c_str(), (int)e.second.size(), keyHash);
+	}
+	return ((uint64_t)positionHash << 32) | (uint64_t)attributesHash;
+}
+
+}
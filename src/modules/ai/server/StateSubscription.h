@@ -0,0 +1,110 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "AIStateDeltaMessage.h"
+#include "AI.h"
+#include <glm/vec2.hpp>
+#include <unordered_map>
+#include <deque>
+
+namespace ai {
+
+/**
+ * @brief The server side state of a debugger client that subscribed to a viewport and a selection
+ *
+ * Only the characters inside the viewport (on the x and z axis) and the selected character are part of the
+ * snapshots. For every snapshot only a hash of the character state is stored - the delta against the last
+ * acknowledged snapshot (the baseline) is computed by comparing those hashes. This means that the full
+ * @c AIStateWorld is only built for the characters that entered the subscription or changed.
+ *
+ * @see AISubscribeMessage
+ * @see StateSnapshots for the client side
+ */
+class StateSubscription {
+public:
+	/**
+	 * @brief If the client doesn't acknowledge this many snapshots, the baseline is dropped and the
+	 * next delta contains every character of the subscription again.
+	 */
+	static constexpr size_t MaxPendingSnapshots = 32u;
+
+private:
+	// character id to state hash
+	typedef std::unordered_map<CharacterId, uint64_t> Snapshot;
+	struct PendingSnapshot {
+		uint32_t id;
+		Snapshot states;
+	};
+
+	glm::vec2 _mins;
+	glm::vec2 _maxs;
+	CharacterId _selection = AI_NOTHING_SELECTED;
+	uint32_t _lastSnapshotId = 0u;
+	uint32_t _baselineId = 0u;
+	Snapshot _baseline;
+	// sent, but not yet acknowledged snapshots - sorted by id
+	std::deque<PendingSnapshot> _pending;
+	Snapshot _current;
+	AIStateDeltaMessage _delta;
+	uint64_t _detailsHash = 0u;
+
+public:
+	StateSubscription(const glm::vec2& mins, const glm::vec2& maxs, CharacterId selection = AI_NOTHING_SELECTED);
+
+	void setViewport(const glm::vec2& mins, const glm::vec2& maxs);
+	void setSelection(CharacterId selection);
+	CharacterId selection() const;
+
+	/**
+	 * @return @c true if the character is inside the viewport or selected
+	 */
+	bool contains(const ICharacter& chr) const;
+
+	/**
+	 * @brief Starts to collect a new snapshot. Call @c addCharacter() for every character of the zone and
+	 * finish the snapshot with @c endSnapshot()
+	 */
+	void beginSnapshot();
+	void addCharacter(const ICharacter& chr);
+	/**
+	 * @return The delta message that should be sent to the client or @c nullptr if the client already
+	 * knows the current state.
+	 */
+	const AIStateDeltaMessage* endSnapshot();
+
+	/**
+	 * @brief Use the given snapshot as baseline for the next deltas
+	 * @return @c false if the snapshot is unknown or was already acknowledged
+	 */
+	bool ack(uint32_t snapshotId);
+
+	/**
+	 * @brief Remembers the hash of the last character details that were sent to the client
+	 * @return @c true if the given hash differs from the last sent details
+	 */
+	bool updateDetails(uint64_t detailsHash);
+
+	uint32_t baselineId() const;
+	size_t pendingSnapshots() const;
+
+	/**
+	 * @return Hash over the serialized state of the character - position, orientation and attributes
+	 */
+	static uint64_t stateHash(const ICharacter& chr);
+};
+
+inline CharacterId StateSubscription::selection() const {
+	return _selection;
+}
+
+inline uint32_t StateSubscription::baselineId() const {
+	return _baselineId;
+}
+
+inline size_t StateSubscription::pendingSnapshots() const {
+	return _pending.size();
+}
+
+}
@@ -0,0 +1,259 @@
+/**
+ * @file
+ */
+
+#include "TestShared.h"
+#include "server/ProtocolMessageFactory.h"
+#include "server/AIStateMessage.h"
+#include "server/AIStateDeltaMessage.h"
+#include "server/AIStateAckMessage.h"
+#include "server/AISubscribeMessage.h"
+#include "server/StateSubscription.h"
+#include "server/StateSnapshots.h"
+#include "tree/PrioritySelector.h"
+#include <deque>
+
+namespace {
+
+/**
+ * @brief Debugger client that reconstructs the state from the deltas and acknowledges them with a delay
+ */
+class FakeClient {
+private:
+	ai::StateSnapshots _snapshots;
+	std::deque<uint32_t> _acks;
+	const size_t _ackDelay;
+
+public:
+	template<class T>
+	static T* transfer(const T& msg) {
+		ai::streamContainer stream;
+		// fake the size that is used in the network stream
+		ai::IProtocolMessage::addInt(stream, 0);
+		msg.serialize(stream);
+		return static_cast<T*>(ai::ProtocolMessageFactory::get().create(stream));
+	}
+
+	explicit FakeClient(size_t ackDelay) : _ackDelay(ackDelay) {
+	}
+
+	bool receive(const ai::AIStateDeltaMessage& msg) {
+		ai::AIStateDeltaMessage* delta = transfer(msg);
+		const bool applied = _snapshots.apply(*delta);
+		if (applied) {
+			_acks.push_back(delta->getSnapshotId());
+		}
+		// the factory reuses the memory of the message
+		delta->~AIStateDeltaMessage();
+		return applied;
+	}
+
+	/**
+	 * @brief Sends the acknowledgements that are older than the ack delay to the server
+	 */
+	void sendAcks(ai::StateSubscription& subscription) {
+		while (_acks.size() > _ackDelay) {
+			const ai::AIStateAckMessage* ack = transfer(ai::AIStateAckMessage(_acks.front()));
+			_acks.pop_front();
+			subscription.ack(ack->getSnapshotId());
+		}
+	}
+
+	inline const ai::StateSnapshots& snapshots() const {
+		return _snapshots;
+	}
+};
+
+}
+
+class StateDeltaTest: public TestSuite {
+protected:
+	ai::TreeNodePtr _root = std::make_shared<ai::PrioritySelector>("test", "", ai::True::get());
+	std::vector<ai::AIPtr> _ais;
+	ai::CharacterId _nextId = 1;
+
+	void add(ai::Zone& zone, const glm::vec3& pos) {
+		ai::ICharacterPtr character = std::make_shared<TestEntity>(_nextId++);
+		character->setPosition(pos);
+		character->setAttribute("Name", "test");
+		ai::AIPtr ai = std::make_shared<ai::AI>(_root);
+		ai->setCharacter(character);
+		ASSERT_TRUE(zone.addAI(ai));
+		_ais.push_back(ai);
+	}
+
+	glm::vec3 randomPosition() const {
+		return glm::vec3(ai::randomBinomial(100.0f), 0.0f, ai::randomBinomial(100.0f));
+	}
+
+	void snapshot(const ai::Zone& zone, ai::StateSubscription& subscription, FakeClient& client) {
+		subscription.beginSnapshot();
+		zone.execute([&] (const ai::AIPtr& ai) {
+			subscription.addCharacter(*ai->getCharacter());
+		});
+		const ai::AIStateDeltaMessage* delta = subscription.endSnapshot();
+		if (delta != nullptr) {
+			ASSERT_TRUE(client.receive(*delta));
+		}
+		client.sendAcks(subscription);
+	}
+
+	/**
+	 * @brief Compares the reconstructed states with the full state broadcast filtered by the subscription
+	 */
+	::testing::AssertionResult same(const ai::Zone& zone, const ai::StateSubscription& subscription, const FakeClient& client) const {
+		ai::AIStateMessage full;
+		zone.execute([&] (const ai::AIPtr& ai) {
+			const ai::ICharacterPtr& chr = ai->getCharacter();
+			full.addState(ai::AIStateWorld(chr->getId(), chr->getPosition(), chr->getOrientation(), chr->getAttributes()));
+		});
+		const ai::StateSnapshots::States& states = client.snapshots().states();
+		size_t expected = 0u;
+		for (const ai::AIStateWorld& state : full.getStates()) {
+			const ai::AIPtr& ai = zone.getAI(state.getId());
+			if (!subscription.contains(*ai->getCharacter())) {
+				if (states.find(state.getId()) != states.end()) {
+					return ::testing::AssertionFailure() << "character " << state.getId() << " should not be known by the client";
+				}
+				continue;
+			}
+			++expected;
+			auto i = states.find(state.getId());
+			if (i == states.end()) {
+				return ::testing::AssertionFailure() << "character " << state.getId() << " is missing";
+			}
+			if (i->second.getPosition() != state.getPosition() || i->second.getOrientation() != state.getOrientation()
+				|| i->second.getAttributes() != state.getAttributes()) {
+				return ::testing::AssertionFailure() << "character " << state.getId() << " differs";
+			}
+		}
+		if (expected != states.size()) {
+			return ::testing::AssertionFailure() << "expected " << expected << " characters, but got " << states.size();
+		}
+		return ::testing::AssertionSuccess();
+	}
+
+	void TearDown() override {
+		_ais.clear();
+		TestSuite::TearDown();
+	}
+};
+
+TEST_F(StateDeltaTest, testDeltaMessage) {
+	ai::AIStateDeltaMessage msg(3u, 2u);
+	msg.addState(ai::AIStateWorld(1, glm::vec3(1.0f, 2.0f, 3.0f), 0.5f));
+	msg.addRemoved(4);
+	ai::AIStateDeltaMessage* d = FakeClient::transfer(msg);
+	ASSERT_EQ(ai::PROTO_STATEDELTA, d->getId());
+	EXPECT_EQ(3u, d->getSnapshotId());
+	EXPECT_EQ(2u, d->getBaselineId());
+	ASSERT_EQ(1u, d->getStates().size());
+	EXPECT_EQ(1, d->getStates()[0].getId());
+	EXPECT_FLOAT_EQ(0.5f, d->getStates()[0].getOrientation());
+	ASSERT_EQ(1u, d->getRemoved().size());
+	EXPECT_EQ(4, d->getRemoved()[0]);
+	d->~AIStateDeltaMessage();
+}
+
+TEST_F(StateDeltaTest, testSubscribeMessage) {
+	const ai::AISubscribeMessage msg(glm::vec2(-1.0f, -2.0f), glm::vec2(3.0f, 4.0f), 5);
+	const ai::AISubscribeMessage* d = FakeClient::transfer(msg);
+	ASSERT_EQ(ai::PROTO_SUBSCRIBE, d->getId());
+	EXPECT_FLOAT_EQ(-2.0f, d->getMins().y);
+	EXPECT_FLOAT_EQ(3.0f, d->getMaxs().x);
+	EXPECT_EQ(5, d->getCharacterId());
+}
+
+TEST_F(StateDeltaTest, testOnlyChanges) {
+	ai::Zone zone("test");
+	add(zone, glm::vec3(0.0f));
+	add(zone, glm::vec3(1.0f));
+	add(zone, glm::vec3(1000.0f));
+	zone.update(0);
+	ai::StateSubscription subscription(glm::vec2(-10.0f), glm::vec2(10.0f));
+	FakeClient client(0u);
+
+	subscription.beginSnapshot();
+	zone.execute([&] (const ai::AIPtr& ai) {
+		subscription.addCharacter(*ai->getCharacter());
+	});
+	const ai::AIStateDeltaMessage* delta = subscription.endSnapshot();
+	ASSERT_NE(nullptr, delta);
+	EXPECT_EQ(0u, delta->getBaselineId());
+	EXPECT_EQ(2u, delta->getStates().size());
+	ASSERT_TRUE(client.receive(*delta));
+	client.sendAcks(subscription);
+	EXPECT_EQ(delta->getSnapshotId(), subscription.baselineId());
+
+	// nothing changed - nothing to send
+	subscription.beginSnapshot();
+	zone.execute([&] (const ai::AIPtr& ai) {
+		subscription.addCharacter(*ai->getCharacter());
+	});
+	EXPECT_EQ(nullptr, subscription.endSnapshot());
+
+	_ais[0]->getCharacter()->setAttribute("Name", "changed");
+	_ais[1]->getCharacter()->setPosition(glm::vec3(100.0f));
+	subscription.beginSnapshot();
+	zone.execute([&] (const ai::AIPtr& ai) {
+		subscription.addCharacter(*ai->getCharacter());
+	});
+	delta = subscription.endSnapshot();
+	ASSERT_NE(nullptr, delta);
+	ASSERT_EQ(1u, delta->getStates().size());
+	EXPECT_EQ(_ais[0]->getId(), delta->getStates()[0].getId());
+	ASSERT_EQ(1u, delta->getRemoved().size());
+	EXPECT_EQ(_ais[1]->getId(), delta->getRemoved()[0]);
+}
+
+TEST_F(StateDeltaTest, testReconstruction) {
+	ai::Zone zone("test");
+	for (int i = 0; i < 500; ++i) {
+		add(zone, randomPosition());
+	}
+	zone.update(0);
+	// the selection is outside of the viewport
+	ai::StateSubscription subscription(glm::vec2(-50.0f), glm::vec2(50.0f));
+	_ais[0]->getCharacter()->setPosition(glm::vec3(500.0f));
+	subscription.setSelection(_ais[0]->getId());
+	FakeClient client(2u);
+
+	for (int tick = 0; tick < 50; ++tick) {
+		for (int i = 0; i < 20; ++i) {
+			const ai::AIPtr& ai = _ais[ai::random(1, (int)_ais.size() - 1)];
+			ai->getCharacter()->setPosition(randomPosition());
+			ai->getCharacter()->setOrientation(ai::randomf(6.0f));
+		}
+		_ais[ai::random(0, (int)_ais.size() - 1)]->getCharacter()->setAttribute("Tick", core::String::format("%i", tick));
+		// characters leave and enter the zone
+		const int removeIndex = ai::random(1, (int)_ais.size() - 1);
+		ASSERT_TRUE(zone.removeAI(_ais[removeIndex]));
+		_ais.erase(_ais.begin() + removeIndex);
+		add(zone, randomPosition());
+		if (tick == 25) {
+			subscription.setViewport(glm::vec2(0.0f), glm::vec2(80.0f));
+		}
+		zone.update(0);
+		snapshot(zone, subscription, client);
+		ASSERT_TRUE(same(zone, subscription, client)) << "tick " << tick;
+		EXPECT_LE(client.snapshots().size(), 4u);
+	}
+}
+
+TEST_F(StateDeltaTest, testMissingAcks) {
+	ai::Zone zone("test");
+	for (int i = 0; i < 10; ++i) {
+		add(zone, glm::vec3((float)i, 0.0f, 0.0f));
+	}
+	zone.update(0);
+	ai::StateSubscription subscription(glm::vec2(-100.0f), glm::vec2(100.0f));
+	// this client never acknowledges a snapshot
+	FakeClient client((size_t)-1);
+	for (size_t tick = 0; tick <= ai::StateSubscription::MaxPendingSnapshots; ++tick) {
+		_ais[tick % _ais.size()]->getCharacter()->setOrientation((float)tick);
+		snapshot(zone, subscription, client);
+		ASSERT_TRUE(same(zone, subscription, client)) << "tick " << tick;
+		EXPECT_EQ(0u, subscription.baselineId());
+	}
+	EXPECT_LE(subscription.pendingSnapshots(), ai::StateSubscription::MaxPendingSnapshots);
+}
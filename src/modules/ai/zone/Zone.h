@@ -16,6 +16,7 @@
 #include "ICharacter.h"
 #include "group/GroupMgr.h"
 #include "common/Thread.h"
+#include "core/concurrent/TaskGroup.h"
 #include "core/concurrent/ThreadPool.h"
 #include "core/concurrent/Lock.h"
 #include "core/Trace.h"
@@ -253,17 +254,17 @@ public:
 	template<typename Func>
 	void executeParallel(Func& func) {
 		core_trace_scoped(ZoneExecuteParallel);
-		std::vector<std::future<void> > results;
 		_lock.lock();
 		AIMap copy(_ais);
 		_lock.unlock();
+		core::TaskGroup group(_threadPool);
 		for (auto i = copy.begin(); i != copy.end(); ++i) {
 			const AIPtr& ai = i->second;
-			results.emplace_back(executeAsync(ai, func));
-		}
-		for (auto & result: results) {
-			result.wait();
+			group.spawn([&func, &ai] () {
+				func(ai);
+			});
 		}
+		group.wait();
 	}
 
 	/**
@@ -276,17 +277,17 @@ public:
 	template<typename Func>
 	void executeParallel(const Func& func) const {
 		core_trace_scoped(ZoneExecuteParallel);
-		std::vector<std::future<void> > results;
 		_lock.lock();
 		AIMap copy(_ais);
 		_lock.unlock();
+		core::TaskGroup group(_threadPool);
 		for (auto i = copy.begin(); i != copy.end(); ++i) {
 			const AIPtr& ai = i->second;
-			results.emplace_back(executeAsync(ai, func));
-		}
-		for (auto & result: results) {
-			result.wait();
+			group.spawn([&func, &ai] () {
+				func(ai);
+			});
 		}
+		group.wait();
 	}
 
 	/**
@@ -0,0 +1,159 @@
+/**
+ * @file
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "backend/entity/EntitySlotMap.h"
+#include "math/Random.h"
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+enum Storage {
+	// the std::unordered_map that was used by the map and the entity storage before
+	UnorderedMap = 0,
+	SlotMap = 1
+};
+
+static constexpr int Entities = 100000;
+
+/**
+ * @brief Only the members the passes read - the backend entities need the whole server setup
+ */
+class BenchmarkEntity {
+private:
+	backend::EntityId _id;
+	glm::vec3 _pos;
+	glm::vec3 _velocity;
+	int _visibleCount = 0;
+	// the other members of a backend entity that are not needed by most passes
+	uint8_t _cold[256] {};
+
+public:
+	BenchmarkEntity(backend::EntityId id, const glm::vec3& pos, const glm::vec3& velocity) :
+			_id(id), _pos(pos), _velocity(velocity) {
+	}
+
+	void update(long dt) {
+		_pos += _velocity * ((float)dt / 1000.0f);
+		_visibleCount = (int)(_id & 3);
+	}
+
+	backend::EntityId id() const {
+		return _id;
+	}
+	glm::vec3 pos() const {
+		return _pos;
+	}
+	int visibleCount() const {
+		return _visibleCount;
+	}
+};
+typedef std::shared_ptr<BenchmarkEntity> BenchmarkEntityPtr;
+
+}
+
+class EntityStorageBenchmark: public core::AbstractBenchmark {
+protected:
+	std::unordered_map<backend::EntityId, BenchmarkEntityPtr> _unorderedMap;
+	backend::EntitySlotMap<BenchmarkEntityPtr> _slotMap;
+	std::vector<backend::EntityId> _lookups;
+
+public:
+	bool onInitApp() override {
+		math::Random random(1u);
+		_unorderedMap.reserve(Entities);
+		for (int i = 0; i < Entities; ++i) {
+			// the ids are not continuous - the entities are removed and added while the server is running
+			const backend::EntityId id = (backend::EntityId)i * 7 + random.random(0, 6);
+			const glm::vec3 pos(random.randomf(-1000.0f, 1000.0f), random.randomf(0.0f, 255.0f), random.randomf(-1000.0f, 1000.0f));
+			const glm::vec3 velocity(random.randomf(-1.0f, 1.0f), 0.0f, random.randomf(-1.0f, 1.0f));
+			const BenchmarkEntityPtr& entity = std::make_shared<BenchmarkEntity>(id, pos, velocity);
+			_unorderedMap.emplace(id, entity);
+			_slotMap.add(entity);
+			_lookups.push_back(id);
+		}
+		random.shuffle(_lookups.begin(), _lookups.end());
+		return true;
+	}
+
+	void onCleanupApp() override {
+		_unorderedMap.clear();
+		_slotMap.clear();
+		_lookups.clear();
+	}
+};
+
+// Map::update() - update every entity
+BENCHMARK_DEFINE_F(EntityStorageBenchmark, Update)(benchmark::State &state) {
+	for (auto _ : state) {
+		if (state.range(0) == UnorderedMap) {
+			for (const auto& e : _unorderedMap) {
+				e.second->update(10L);
+			}
+		} else {
+			_slotMap.update([] (const BenchmarkEntityPtr& entity) {
+				entity->update(10L);
+				return true;
+			});
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * Entities);
+}
+
+// a pass that only needs the position - e.g. collecting the entities in range
+BENCHMARK_DEFINE_F(EntityStorageBenchmark, InRange)(benchmark::State &state) {
+	const glm::vec3 center(0.0f, 64.0f, 0.0f);
+	const float radiusSquared = 200.0f * 200.0f;
+	int64_t inRange = 0;
+	for (auto _ : state) {
+		if (state.range(0) == UnorderedMap) {
+			for (const auto& e : _unorderedMap) {
+				const glm::vec3 delta = e.second->pos() - center;
+				if (glm::dot(delta, delta) < radiusSquared) {
+					++inRange;
+				}
+			}
+		} else {
+			_slotMap.visit([&] (const BenchmarkEntityPtr& entity) {
+				const glm::vec3 delta = entity->pos() - center;
+				if (glm::dot(delta, delta) < radiusSquared) {
+					++inRange;
+				}
+			});
+		}
+	}
+	benchmark::DoNotOptimize(inRange);
+	state.SetItemsProcessed(state.iterations() * Entities);
+}
+
+BENCHMARK_DEFINE_F(EntityStorageBenchmark, Lookup)(benchmark::State &state) {
+	int64_t found = 0;
+	for (auto _ : state) {
+		for (backend::EntityId id : _lookups) {
+			if (state.range(0) == UnorderedMap) {
+				auto i = _unorderedMap.find(id);
+				if (i != _unorderedMap.end() && i->second->visibleCount() > 0) {
+					++found;
+				}
+			} else {
+				const BenchmarkEntityPtr& entity = _slotMap.get(id);
+				if (entity && entity->visibleCount() > 0) {
+					++found;
+				}
+			}
+		}
+	}
+	benchmark::DoNotOptimize(found);
+	state.SetItemsProcessed(state.iterations() * (int64_t)_lookups.size());
+}
+
+BENCHMARK_REGISTER_F(EntityStorageBenchmark, Update)->ArgName("storage")->Arg(UnorderedMap)->Arg(SlotMap);
+BENCHMARK_REGISTER_F(EntityStorageBenchmark, InRange)->ArgName("storage")->Arg(UnorderedMap)->Arg(SlotMap);
+BENCHMARK_REGISTER_F(EntityStorageBenchmark, Lookup)->ArgName("storage")->Arg(UnorderedMap)->Arg(SlotMap);
+
+BENCHMARK_MAIN();
@@ -7,6 +7,7 @@
 #include "core/ArrayLength.h"
 #include "core/Assert.h"
 #include "core/Log.h"
+#include "core/TimeProvider.h"
 #include "math/Rect.h"
 #include "core/Common.h"
 #include "math/Frustum.h"
@@ -24,7 +25,7 @@ Entity::Entity(EntityId id,
 		const network::ServerMessageSenderPtr& messageSender,
 		const core::TimeProviderPtr& timeProvider,
 		const attrib::ContainerProviderPtr& containerProvider) :
-		_messageSender(messageSender), _containerProvider(containerProvider),
+		_messageSender(messageSender), _timeProvider(timeProvider), _containerProvider(containerProvider),
 		_map(map), _entityId(id) {
 	_attribs.addListener(std::bind(&Entity::onAttribChange, this, std::placeholders::_1));
 }
@@ -61,20 +62,17 @@ bool Entity::attack(EntityId victimId) {
 void Entity::sendToVisible(flatbuffers::FlatBufferBuilder& fbb, network::ServerMsgType type,
 		flatbuffers::Offset<void> data, bool sendToSelf, uint32_t flags) const {
 	const EntitySet& visible = visibleCopy();
-	std::vector<ENetPeer*> peers;
+	std::vector<network::Connection> peers;
 	peers.reserve(visible.size() + 1);
-	if (sendToSelf) {
-		ENetPeer* p = peer();
-		if (p != nullptr) {
-			peers.push_back(p);
-		}
+	if (sendToSelf && _connection.valid()) {
+		peers.push_back(_connection);
 	}
 	for (const EntityPtr& e : visible) {
-		ENetPeer* peer = e->peer();
-		if (peer == nullptr) {
+		const network::Connection& connection = e->connection();
+		if (!connection.valid()) {
 			continue;
 		}
-		peers.push_back(peer);
+		peers.push_back(connection);
 	}
 	if (peers.empty()) {
 		Log::debug("don't send message of type '%s' - no peers found", network::toString(type, network::EnumNamesServerMsgType()));
@@ -169,7 +167,7 @@ bool Entity::update(long dt) {
 	return true;
 }
 
-void Entity::updateVisible(const EntitySet& set) {
+void Entity::updateVisible(const EntitySet& set, bool sendEntityUpdates) {
 	core_trace_scoped(UpdateVisible);
 	_visibleLock.lockWrite();
 	const auto& stillVisible = core::setIntersection(set, _visible);
@@ -178,8 +176,10 @@ void Entity::updateVisible(const EntitySet& set) {
 	_visible = core::setUnion(stillVisible, add);
 	_visibleLock.unlockWrite();
 
-	for (const auto& e : _visible) {
-		sendEntityUpdate(e);
+	if (sendEntityUpdates) {
+		for (const auto& e : _visible) {
+			sendEntityUpdate(e);
+		}
 	}
 
 	if (!add.empty()) {
@@ -191,18 +191,19 @@ void Entity::updateVisible(const EntitySet& set) {
 }
 
 void Entity::sendEntityUpdate(const EntityPtr& entity) const {
-	if (_peer == nullptr) {
+	if (!_connection.valid()) {
 		return;
 	}
 	const glm::vec3& _pos = entity->pos();
 	const network::Vec3 pos { _pos.x, _pos.y, _pos.z };
+	const int64_t serverMillis = (int64_t)_timeProvider->tickMillis();
 	_entityUpdateFBB.Clear();
-	_messageSender->sendServerMessage(_peer, _entityUpdateFBB, network::ServerMsgType::EntityUpdate,
-			network::CreateEntityUpdate(_entityUpdateFBB, entity->id(), &pos, entity->orientation(), entity->animation()).Union());
+	_messageSender->sendServerMessage(_connection, _entityUpdateFBB, network::ServerMsgType::EntityUpdate,
+			network::CreateEntityUpdate(_entityUpdateFBB, entity->id(), &pos, entity->orientation(), entity->animation(), serverMillis).Union());
 }
 
 void Entity::sendEntitySpawn(const EntityPtr& entity) const {
-	if (_peer == nullptr) {
+	if (!_connection.valid()) {
 		return;
 	}
 	const glm::vec3& pos = entity->pos();
@@ -210,16 +211,16 @@ void Entity::sendEntitySpawn(const EntityPtr& entity) const {
 	const EntityId entityId = id();
 	_entitySpawnFBB.Clear();
 	// TODO: User::sendUserSpawn()?
-	_messageSender->sendServerMessage(_peer, _entitySpawnFBB, network::ServerMsgType::EntitySpawn,
+	_messageSender->sendServerMessage(_connection, _entitySpawnFBB, network::ServerMsgType::EntitySpawn,
 			network::CreateEntitySpawn(_entitySpawnFBB, entity->id(), entity->entityType(), &vec3, entityId, entity->animation()).Union());
 }
 
 void Entity::sendEntityRemove(const EntityPtr& entity) const {
-	if (_peer == nullptr) {
+	if (!_connection.valid()) {
 		return;
 	}
 	_entityRemoveFBB.Clear();
-	_messageSender->sendServerMessage(_peer, _entityRemoveFBB, network::ServerMsgType::EntityRemove,
+	_messageSender->sendServerMessage(_connection, _entityRemoveFBB, network::ServerMsgType::EntityRemove,
 			network::CreateEntityRemove(_entityRemoveFBB, entity->id()).Union());
 }
 
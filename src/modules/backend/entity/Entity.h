@@ -42,9 +42,11 @@ private:
 protected:
 	// network stuff
 	network::ServerMessageSenderPtr _messageSender;
-	ENetPeer *_peer = nullptr;
+	// invalid if the entity isn't connected
+	network::Connection _connection;
 
 	network::Animation _animation = network::Animation::IDLE;
+	core::TimeProviderPtr _timeProvider;
 
 	// attribute stuff
 	attrib::ContainerProviderPtr _containerProvider;
@@ -90,6 +92,7 @@ public:
 
 	EntityId id() const;
 	const MapPtr& map() const;
+	const core::TimeProviderPtr& timeProvider() const;
 	void setMap(const MapPtr& map, const glm::vec3& pos);
 
 	void setPointOfInterest(poi::Type type = poi::Type::NONE);
@@ -98,7 +101,7 @@ public:
 
 	bool attack(EntityId id);
 
-	ENetPeer* peer() const;
+	const network::Connection& connection() const;
 
 	/**
 	 * If the object is currently maintained by a shared_ptr, you can get a shared_ptr from a raw pointer
@@ -152,10 +155,12 @@ public:
 	/**
 	 * @brief This will inform the entity about all the other entities that it can see.
 	 * @param[in] set The entities that are currently visible
+	 * @param[in] sendEntityUpdates Send the current state of all visible entities. The clients interpolate
+	 * between the updates - so this doesn't have to happen every tick.
 	 * @note All entities have the same view range - see @c Entity::regionRect
 	 * @note This is thread safe
 	 */
-	void updateVisible(const EntitySet& set);
+	void updateVisible(const EntitySet& set, bool sendEntityUpdates = true);
 
 	/**
 	 * @brief The tick of the entity
@@ -214,6 +219,10 @@ inline const MapPtr& Entity::map() const {
 	return _map;
 }
 
+inline const core::TimeProviderPtr& Entity::timeProvider() const {
+	return _timeProvider;
+}
+
 inline network::Animation Entity::animation() const {
 	return _animation;
 }
@@ -273,11 +282,8 @@ inline bool Entity::dead() const {
 	return _attribs.current(attrib::Type::HEALTH) < 0.00001;
 }
 
-inline ENetPeer* Entity::peer() const {
-	if (_peer != nullptr && _peer->state == ENET_PEER_STATE_DISCONNECTED) {
-		return nullptr;
-	}
-	return _peer;
+inline const network::Connection& Entity::connection() const {
+	return _connection;
 }
 
 inline bool Entity::inFrustum(const Entity& other) const {
@@ -0,0 +1,208 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "EntityId.h"
+#include "core/collection/HashMap.h"
+#include "core/Assert.h"
+#include <functional>
+#include <vector>
+#include <stdint.h>
+
+namespace backend {
+
+/**
+ * @brief Dense storage for entity pointers
+ *
+ * The entities are stored in a contiguous array - removing an entity moves the last entity into the
+ * free place. The slots add one indirection that stays stable for the lifetime
+ * of an entity, the handles of removed entities are detected by the generation counter of the slot.
+ * The lookup by @c EntityId is O(1).
+ *
+ * @note Adding or removing entities invalidates the iteration order - the handles stay valid.
+ * @tparam PTR A (shared) pointer to the entity - the entity must provide @c id()
+ */
+template<class PTR>
+class EntitySlotMap {
+public:
+	struct Handle {
+		uint32_t slot = UINT32_MAX;
+		uint32_t generation = 0u;
+
+		inline bool valid() const {
+			return slot != UINT32_MAX;
+		}
+	};
+
+private:
+	struct Slot {
+		uint32_t dense;
+		uint32_t generation;
+	};
+
+	std::vector<PTR> _entities;
+	std::vector<uint32_t> _denseToSlot;
+	std::vector<Slot> _slots;
+	std::vector<uint32_t> _freeSlots;
+	core::HashMap<EntityId, uint32_t, std::hash<EntityId>> _slotById;
+
+	void removeDense(uint32_t dense) {
+		const uint32_t slot = _denseToSlot[dense];
+		const uint32_t last = (uint32_t)_entities.size() - 1u;
+		_slotById.remove(_entities[dense]->id());
+		if (dense != last) {
+			_entities[dense] = std::move(_entities[last]);
+			_denseToSlot[dense] = _denseToSlot[last];
+			_slots[_denseToSlot[dense]].dense = dense;
+		}
+		_entities.pop_back();
+		_denseToSlot.pop_back();
+		++_slots[slot].generation;
+		_freeSlots.push_back(slot);
+	}
+
+	int denseIndex(EntityId id) const {
+		auto i = _slotById.find(id);
+		if (i == _slotById.end()) {
+			return -1;
+		}
+		return (int)_slots[i->value].dense;
+	}
+
+public:
+	/**
+	 * @return An invalid handle if an entity with the same id is already stored
+	 */
+	Handle add(const PTR& entity) {
+		const EntityId id = entity->id();
+		if (_slotById.hasKey(id)) {
+			return Handle();
+		}
+		uint32_t slot;
+		if (_freeSlots.empty()) {
+			slot = (uint32_t)_slots.size();
+			_slots.push_back(Slot{0u, 0u});
+		} else {
+			slot = _freeSlots.back();
+			_freeSlots.pop_back();
+		}
+		const uint32_t dense = (uint32_t)_entities.size();
+		_slots[slot].dense = dense;
+		_entities.push_back(entity);
+		_denseToSlot.push_back(slot);
+		_slotById.put(id, slot);
+		return Handle{slot, _slots[slot].generation};
+	}
+
+	bool remove(EntityId id) {
+		const int dense = denseIndex(id);
+		if (dense == -1) {
+			return false;
+		}
+		removeDense((uint32_t)dense);
+		return true;
+	}
+
+	bool remove(const Handle& handle) {
+		if (!valid(handle)) {
+			return false;
+		}
+		removeDense(_slots[handle.slot].dense);
+		return true;
+	}
+
+	/**
+	 * @return @c false if the entity was removed in the meantime
+	 */
+	inline bool valid(const Handle& handle) const {
+		return handle.slot < _slots.size() && _slots[handle.slot].generation == handle.generation
+				&& _slots[handle.slot].dense < _denseToSlot.size() && _denseToSlot[_slots[handle.slot].dense] == handle.slot;
+	}
+
+	Handle handle(EntityId id) const {
+		auto i = _slotById.find(id);
+		if (i == _slotById.end()) {
+			return Handle();
+		}
+		return Handle{i->value, _slots[i->value].generation};
+	}
+
+	/**
+	 * @return A copy of the pointer or an empty pointer if there is no entity with the given id
+	 */
+	PTR get(EntityId id) const {
+		const int dense = denseIndex(id);
+		if (dense == -1) {
+			return PTR();
+		}
+		return _entities[dense];
+	}
+
+	const PTR* get(const Handle& handle) const {
+		if (!valid(handle)) {
+			return nullptr;
+		}
+		return &_entities[_slots[handle.slot].dense];
+	}
+
+	inline bool has(EntityId id) const {
+		return _slotById.hasKey(id);
+	}
+
+	/**
+	 * @brief Calls the functor with @c (const PTR&) for every entity
+	 * @note Don't add or remove entities in the functor
+	 */
+	template<class FUNC>
+	void visit(FUNC&& func) const {
+		for (const PTR& entity : _entities) {
+			func(entity);
+		}
+	}
+
+	/**
+	 * @brief Calls the functor with @c (const PTR&) for every entity
+	 * @param func Returns @c false if the entity should get removed - the functor has to do the
+	 * cleanup before returning. Don't add or remove entities in the functor.
+	 * @return The amount of removed entities
+	 */
+	template<class FUNC>
+	int update(FUNC&& func) {
+		int removed = 0;
+		for (uint32_t i = 0u; i < (uint32_t)_entities.size();) {
+			// keep a reference while the functor runs - the slot might get reused by the removal
+			const PTR entity = _entities[i];
+			if (func(entity)) {
+				++i;
+				continue;
+			}
+			// the last entity is moved to this index and is updated next
+			removeDense(i);
+			++removed;
+		}
+		return removed;
+	}
+
+	void clear() {
+		_entities.clear();
+		_denseToSlot.clear();
+		_slotById.clear();
+		_freeSlots.clear();
+		for (uint32_t i = 0u; i < (uint32_t)_slots.size(); ++i) {
+			++_slots[i].generation;
+			_freeSlots.push_back(i);
+		}
+	}
+
+	inline size_t size() const {
+		return _entities.size();
+	}
+
+	inline bool empty() const {
+		return _entities.empty();
+	}
+};
+
+}
@@ -7,6 +7,7 @@
 #include "core/Trace.h"
 #include "User.h"
 #include "Npc.h"
+#include "backend/world/Map.h"
 #include "backend/eventbus/Event.h"
 
 namespace backend {
@@ -21,33 +22,8 @@ EntityStorage::~EntityStorage() {
 	core_assert(_users.empty());
 }
 
-void EntityStorage::visit(const std::function<void(const EntityPtr&)>& visitor) {
-	core_trace_scoped(EntityStorageVisit);
-	for (auto& e : _users) {
-		visitor(e.second);
-	}
-	for (auto& e : _npcs) {
-		visitor(e.second);
-	}
-}
-
-void EntityStorage::visitNpcs(const std::function<void(const NpcPtr&)>& visitor) {
-	core_trace_scoped(EntityStorageVisitNpcs);
-	for (auto& e : _npcs) {
-		visitor(e.second);
-	}
-}
-
-void EntityStorage::visitUsers(const std::function<void(const UserPtr&)>& visitor) {
-	core_trace_scoped(EntityStorageVisitUsers);
-	for (auto& e : _users) {
-		visitor(e.second);
-	}
-}
-
 bool EntityStorage::addUser(const UserPtr& user) {
-	auto i = _users.insert(std::make_pair(user->id(), user));
-	if (!i.second) {
+	if (!_users.add(user).valid()) {
 		Log::debug("User with id " PRIEntId " is already connected", user->id());
 		return false;
 	}
@@ -57,14 +33,13 @@ bool EntityStorage::addUser(const UserPtr& user) {
 }
 
 bool EntityStorage::removeUser(EntityId userId) {
-	auto i = _users.find(userId);
-	if (i == _users.end()) {
+	UserPtr user = _users.get(userId);
+	if (!user) {
 		Log::warn("User with id " PRIEntId " can't get removed. Reason: NotFound", userId);
 		return false;
 	}
 	Log::info("User with id " PRIEntId " is going to be removed", userId);
-	UserPtr user = i->second;
-	_users.erase(i);
+	_users.remove(userId);
 	user->shutdown();
 	const uint64_t count = user.use_count();
 	if (count != 1) {
@@ -74,17 +49,15 @@ bool EntityStorage::removeUser(EntityId userId) {
 }
 
 UserPtr EntityStorage::user(EntityId id) {
-	UsersIter i = _users.find(id);
-	if (i == _users.end()) {
+	UserPtr user = _users.get(id);
+	if (!user) {
 		Log::trace("Could not find user with id " PRIEntId, id);
-		return UserPtr();
 	}
-	return i->second;
+	return user;
 }
 
 bool EntityStorage::addNpc(const NpcPtr& npc) {
-	auto i = _npcs.insert(std::make_pair(npc->id(), npc));
-	if (!i.second) {
+	if (!_npcs.add(npc).valid()) {
 		Log::warn("Could not add npc with id " PRIEntId ". Reason: AlreadyExists", npc->id());
 		return false;
 	}
@@ -104,13 +77,12 @@ void EntityStorage::onEvent(const EntityDeleteEvent& event) {
 }
 
 bool EntityStorage::removeNpc(EntityId id) {
-	NpcsIter i = _npcs.find(id);
-	if (i == _npcs.end()) {
+	NpcPtr npc = _npcs.get(id);
+	if (!npc) {
 		Log::warn("Could not delete npc with id " PRIEntId, id);
 		return false;
 	}
-	NpcPtr npc = i->second;
-	_npcs.erase(i);
+	_npcs.remove(id);
 	npc->shutdown();
 	const uint64_t count = npc.use_count();
 	if (count != 1) {
@@ -120,12 +92,11 @@ bool EntityStorage::removeNpc(EntityId id) {
 }
 
 NpcPtr EntityStorage::npc(EntityId id) {
-	NpcsIter i = _npcs.find(id);
-	if (i == _npcs.end()) {
+	NpcPtr npc = _npcs.get(id);
+	if (!npc) {
 		Log::trace("Could not find npc with id " PRIEntId, id);
-		return NpcPtr();
 	}
-	return i->second;
+	return npc;
 }
 
 }
@@ -8,8 +8,8 @@
 #include "ai/common/CharacterId.h"
 #include "core/EventBus.h"
 #include "backend/eventbus/Event.h"
-#include <functional>
-#include <unordered_map>
+#include "core/Trace.h"
+#include "EntitySlotMap.h"
 
 namespace backend {
 
@@ -20,12 +20,10 @@ namespace backend {
  */
 class EntityStorage : public core::IEventBusHandler<EntityDeleteEvent>{
 private:
-	typedef std::unordered_map<EntityId, UserPtr> Users;
-	typedef Users::iterator UsersIter;
+	typedef EntitySlotMap<UserPtr> Users;
 	Users _users;
 
-	typedef std::unordered_map<EntityId, NpcPtr> Npcs;
-	typedef Npcs::iterator NpcsIter;
+	typedef EntitySlotMap<NpcPtr> Npcs;
 	Npcs _npcs;
 
 	core::EventBusPtr _eventBus;
@@ -43,11 +41,36 @@ public:
 	bool removeNpc(EntityId id);
 	NpcPtr npc(EntityId id);
 
-	void visit(const std::function<void(const EntityPtr&)>& visitor);
-	void visitNpcs(const std::function<void(const NpcPtr&)>& visitor);
-	void visitUsers(const std::function<void(const UserPtr&)>& visitor);
+	/**
+	 * @brief Calls the functor with @c (const EntityPtr&) for all users and npcs
+	 */
+	template<class FUNC>
+	void visit(FUNC&& visitor) const;
+	template<class FUNC>
+	void visitNpcs(FUNC&& visitor) const;
+	template<class FUNC>
+	void visitUsers(FUNC&& visitor) const;
 };
 
+template<class FUNC>
+inline void EntityStorage::visit(FUNC&& visitor) const {
+	core_trace_scoped(EntityStorageVisit);
+	_users.visit(visitor);
+	_npcs.visit(visitor);
+}
+
+template<class FUNC>
+inline void EntityStorage::visitNpcs(FUNC&& visitor) const {
+	core_trace_scoped(EntityStorageVisitNpcs);
+	_npcs.visit(visitor);
+}
+
+template<class FUNC>
+inline void EntityStorage::visitUsers(FUNC&& visitor) const {
+	core_trace_scoped(EntityStorageVisitUsers);
+	_users.visit(visitor);
+}
+
 typedef std::shared_ptr<EntityStorage> EntityStoragePtr;
 
 }
@@ -10,7 +10,7 @@
 
 namespace backend {
 
-User::User(ENetPeer* peer, EntityId id,
+User::User(const network::Connection& connection, EntityId id,
 		const core::String& name,
 		const MapPtr& map,
 		const network::ServerMessageSenderPtr& messageSender,
@@ -23,14 +23,13 @@ User::User(ENetPeer* peer, EntityId id,
 		Super(id, map, messageSender, timeProvider, containerProvider),
 		_name(name),
 		_dbHandler(dbHandler),
-		_timeProvider(timeProvider),
 		_cooldownProvider(cooldownProvider),
 		_stockMgr(this, stockDataProvider, dbHandler),
 		_cooldownMgr(this, timeProvider, cooldownProvider, dbHandler, persistenceMgr),
 		_attribMgr(id, _attribs, dbHandler, persistenceMgr),
 		_logoutMgr(_cooldownMgr),
 		_movementMgr(this) {
-	setPeer(peer);
+	setConnection(connection);
 	_entityType = network::EntityType::PLAYER;
 }
 
@@ -60,7 +59,7 @@ void User::sendVars() const {
 			auto value = fbb.CreateString(svalue.c_str(), svalue.size());
 			return network::CreateVar(fbb, name, value);
 		});
-	if (!_messageSender->sendServerMessage(_peer, fbb, network::ServerMsgType::VarUpdate,
+	if (!_messageSender->sendServerMessage(_connection, fbb, network::ServerMsgType::VarUpdate,
 			network::CreateVarUpdate(fbb, fbbVars).Union())) {
 		Log::warn("Failed to send var message to the client");
 	}
@@ -76,12 +75,9 @@ void User::shutdown() {
 	_movementMgr.shutdown();
 }
 
-ENetPeer* User::setPeer(ENetPeer* peer) {
-	ENetPeer* old = _peer;
-	_peer = peer;
-	if (_peer) {
-		_peer->data = this;
-	}
+network::Connection User::setConnection(const network::Connection& connection) {
+	const network::Connection old = _connection;
+	_connection = connection;
 	return old;
 }
 
@@ -140,10 +136,10 @@ void User::broadcastUserSpawn() const {
 }
 
 bool User::sendMessage(flatbuffers::FlatBufferBuilder& fbb, network::ServerMsgType type, flatbuffers::Offset<void> msg) const {
-	if (_peer == nullptr) {
+	if (!_connection.valid()) {
 		return false;
 	}
-	_messageSender->sendServerMessage(_peer, fbb, type, msg);
+	_messageSender->sendServerMessage(_connection, fbb, type, msg);
 	return true;
 }
 
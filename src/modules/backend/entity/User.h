@@ -23,7 +23,6 @@ private:
 	core::String _name;
 	core::String _email;
 	persistence::DBHandlerPtr _dbHandler;
-	core::TimeProviderPtr _timeProvider;
 	cooldown::CooldownProviderPtr _cooldownProvider;
 	core::StringMap<core::String> _userinfo;
 
@@ -34,7 +33,7 @@ private:
 	UserMovementMgr _movementMgr;
 
 public:
-	User(ENetPeer* peer,
+	User(const network::Connection& connection,
 			EntityId id,
 			const core::String& name,
 			const MapPtr& map,
@@ -77,9 +76,10 @@ public:
 	void shutdown() override;
 
 	/**
-	 * @brief Sets a new ENetPeer and returns the old one.
+	 * @brief Sets a new connection and returns the old one.
+	 * @note The user must be attached to the connection at the @c network::ServerNetwork to receive its messages
 	 */
-	ENetPeer* setPeer(ENetPeer* peer);
+	network::Connection setConnection(const network::Connection& connection);
 
 	bool sendMessage(flatbuffers::FlatBufferBuilder& fbb, network::ServerMsgType type, flatbuffers::Offset<void> msg) const;
 
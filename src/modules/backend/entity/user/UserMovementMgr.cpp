@@ -36,9 +36,10 @@ void UserMovementMgr::update(long dt) {
 
 	if (_sendUpdate || _movement.animation() != oldAnimation || !glm::all(glm::epsilonEqual(oldPos, newPos, glm::epsilon<float>()))) {
 		const network::Vec3 netPos { newPos.x, newPos.y, newPos.z };
+		const int64_t serverMillis = (int64_t)_user->timeProvider()->tickMillis();
 		_user->sendToVisible(_entityUpdateFBB,
 				network::ServerMsgType::EntityUpdate,
-				network::CreateEntityUpdate(_entityUpdateFBB, _user->id(), &netPos, orientation, _movement.animation()).Union(), true, 0u);
+				network::CreateEntityUpdate(_entityUpdateFBB, _user->id(), &netPos, orientation, _movement.animation(), serverMillis).Union(), true, 0u);
 		_sendUpdate = false;
 	}
 
@@ -336,11 +336,17 @@ bool ServerLoop::init() {
 	addTimer(_persistenceMgrTimer, [] (uv_timer_t* handle) {
 		core_trace_scoped(PersistenceTimer);
 		const ServerLoop* loop = (const ServerLoop*)handle->data;
-		const long dt = handle->repeat;
+		// this is executed in between two world ticks - the flusher thread of the
+		// persistence manager writes the snapshots to the database
 		const persistence::PersistenceMgrPtr& persistenceMgr = loop->_persistenceMgr;
-		core::App::getInstance()->threadPool().enqueue([=] () {
-			persistenceMgr->update(dt);
-		});
+		persistenceMgr->snapshot();
+		const persistence::PersistenceMgr::Stats& stats = persistenceMgr->stats();
+		const metric::MetricPtr& metric = loop->_metricMgr->metric();
+		metric->gauge("persistence.backlog", (uint32_t)stats.backlog);
+		metric->gauge("persistence.batchsize", (uint32_t)stats.batchSize);
+		metric->timing("persistence.flush", (uint32_t)stats.lastFlushMillis);
+		metric->gauge("persistence.flushed", (uint32_t)stats.flushed);
+		metric->gauge("persistence.coalesced", (uint32_t)stats.coalesced);
 	}, 10000);
 
 	_idleTimer = new uv_idle_t;
@@ -372,6 +378,10 @@ bool ServerLoop::init() {
 		return false;
 	}
 	Log::info("Server socket is up at %s:%i", host->strVal().c_str(), port->intVal());
+	if (core::Var::getSafe(cfg::ServerNetworkThread)->boolVal() && !_network->startThread()) {
+		Log::error("Failed to start the network thread");
+		return false;
+	}
 
 	return true;
 }
@@ -449,12 +459,13 @@ void ServerLoop::replicateVars() const {
 // TODO: doesn't belong here
 void ServerLoop::onEvent(const network::DisconnectEvent& event) {
 	core_trace_scoped(OnDisconnectEvent);
-	ENetPeer* peer = event.peer();
-	Log::info("disconnect peer: %u", peer->connectID);
-	User* user = reinterpret_cast<User*>(peer->data);
+	const network::Connection& connection = event.connection();
+	Log::info("disconnect peer: %u", connection.connectID);
+	User* user = static_cast<User*>(_network->attachment(connection));
 	if (user == nullptr) {
 		return;
 	}
+	user->setConnection(network::Connection());
 	user->logoutMgr().triggerLogout();
 }
 
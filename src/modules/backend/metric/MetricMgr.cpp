@@ -54,7 +54,7 @@ void MetricMgr::onEvent(const metric::MetricEvent& event) {
 }
 
 void MetricMgr::onEvent(const network::NewConnectionEvent& event) {
-	Log::info("new connection - waiting for login request from %u", event.get()->connectID);
+	Log::info("new connection - waiting for login request from %u", event.get().connectID);
 	_metric->increment("count.user");
 }
 
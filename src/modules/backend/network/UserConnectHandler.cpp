@@ -18,7 +18,7 @@
 namespace backend {
 
 UserConnectHandler::UserConnectHandler(
-		const network::NetworkPtr& network,
+		const network::ServerNetworkPtr& network,
 		const MapProviderPtr& mapProvider,
 		const persistence::DBHandlerPtr& dbHandler,
 		const persistence::PersistenceMgrPtr& persistenceMgr,
@@ -37,12 +37,12 @@ UserConnectHandler::UserConnectHandler(
 	network::FinishServerMessageBuffer(_authFailed, msg);
 }
 
-void UserConnectHandler::sendAuthFailed(ENetPeer* peer) {
+void UserConnectHandler::sendAuthFailed(const network::Connection& connection) {
 	ENetPacket* packet = _messageSender->createServerPacket(network::ServerMsgType::AuthFailed, _authFailed.GetBufferPointer(), _authFailed.GetSize(), ENET_PACKET_FLAG_RELIABLE);
-	_network->sendMessage(peer, packet);
+	_network->sendMessage(connection, packet);
 }
 
-UserPtr UserConnectHandler::login(ENetPeer* peer, const core::String& email, const core::String& passwd) {
+UserPtr UserConnectHandler::login(const network::Connection& connection, const core::String& email, const core::String& passwd) {
 	db::UserModel model;
 	const db::DBConditionUserModelEmail emailCond(email.c_str());
 	const db::DBConditionUserModelPassword passwordCond(passwd.c_str());
@@ -51,12 +51,16 @@ UserPtr UserConnectHandler::login(ENetPeer* peer, const core::String& email, con
 		Log::warn(logid, "Could not get user id for email: %s", email.c_str());
 		return UserPtr();
 	}
+	const ENetAddress& address = connection.address;
 	const UserPtr& user = _entityStorage->user(model.id());
 	if (user) {
-		ENetPeer* oldPeer = user->peer();
-		if (oldPeer == nullptr || oldPeer->address.host == peer->address.host) {
-			Log::debug(logid, "user %i reconnects with host %u on port %i", (int) model.id(), peer->address.host, peer->address.port);
-			user->setPeer(peer);
+		const network::Connection& oldConnection = user->connection();
+		if (!oldConnection.valid() || oldConnection.address.host == address.host) {
+			Log::debug(logid, "user %i reconnects with host %u on port %i", (int) model.id(), address.host, address.port);
+			// the messages of the old connection are no longer executed for the user
+			_network->setAttachment(oldConnection, nullptr);
+			_network->setAttachment(connection, user.get());
+			user->setConnection(connection);
 			user->onReconnect();
 			return user;
 		}
@@ -65,35 +69,36 @@ UserPtr UserConnectHandler::login(ENetPeer* peer, const core::String& email, con
 	}
 	static const core::String name = "NONAME";
 	MapPtr map = _mapProvider->map(model.mapid(), true);
-	Log::info(logid, "user %i connects with host %u on port %i", (int) model.id(), peer->address.host, peer->address.port);
-	const UserPtr& u = std::make_shared<User>(peer, model.id(), model.name(), map, _messageSender, _timeProvider,
+	Log::info(logid, "user %i connects with host %u on port %i", (int) model.id(), address.host, address.port);
+	const UserPtr& u = std::make_shared<User>(connection, model.id(), model.name(), map, _messageSender, _timeProvider,
 			_containerProvider, _cooldownProvider, _dbHandler, _persistenceMgr, _stockDataProvider);
 	u->init();
+	_network->setAttachment(connection, u.get());
 	map->addUser(u);
 	_entityStorage->addUser(u);
 	return u;
 }
 
-void UserConnectHandler::execute(ENetPeer* peer, const void* raw) {
+void UserConnectHandler::execute(const network::Connection& connection, void* /*attachment*/, const void* raw) {
 	const auto* message = getMsg<network::UserConnect>(raw);
 
 	const core::String email(message->email()->c_str());
 	if (!util::isValidEmail(email)) {
-		sendAuthFailed(peer);
+		sendAuthFailed(connection);
 		Log::debug(logid, "Invalid email given: '%s', %c", email.c_str(), email[0]);
 		return;
 	}
 	const core::String password(message->password()->c_str());
 	if (password.empty()) {
 		Log::debug(logid, "User tries to log into the server without providing a password");
-		sendAuthFailed(peer);
+		sendAuthFailed(connection);
 		return;
 	}
 	Log::debug(logid, "User %s tries to log into the server", email.c_str());
 
-	const UserPtr& user = login(peer, email, password);
+	const UserPtr& user = login(connection, email, password);
 	if (!user) {
-		sendAuthFailed(peer);
+		sendAuthFailed(connection);
 		return;
 	}
 
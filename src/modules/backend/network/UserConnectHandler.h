@@ -5,7 +5,7 @@
 #pragma once
 
 #include "backend/ForwardDecl.h"
-#include "network/Network.h"
+#include "network/ServerNetwork.h"
 #include "core/TimeProvider.h"
 #include "core/Log.h"
 #include "ai/common/CharacterId.h"
@@ -20,7 +20,7 @@ namespace backend {
 class UserConnectHandler: public network::IProtocolHandler {
 private:
 	static constexpr auto logid = Log::logid("UserConnectHandler");
-	network::NetworkPtr _network;
+	network::ServerNetworkPtr _network;
 	MapProviderPtr _mapProvider;
 	persistence::DBHandlerPtr _dbHandler;
 	persistence::PersistenceMgrPtr _persistenceMgr;
@@ -32,12 +32,12 @@ private:
 	stock::StockDataProviderPtr _stockDataProvider;
 	flatbuffers::FlatBufferBuilder _authFailed;
 
-	void sendAuthFailed(ENetPeer* peer);
-	UserPtr login(ENetPeer* peer, const core::String& email, const core::String& passwd);
+	void sendAuthFailed(const network::Connection& connection);
+	UserPtr login(const network::Connection& connection, const core::String& email, const core::String& passwd);
 
 public:
 	UserConnectHandler(
-			const network::NetworkPtr& network,
+			const network::ServerNetworkPtr& network,
 			const MapProviderPtr& mapProvider,
 			const persistence::DBHandlerPtr& dbHandler,
 			const persistence::PersistenceMgrPtr& persistenceMgr,
@@ -48,7 +48,7 @@ public:
 			const cooldown::CooldownProviderPtr& cooldownProvider,
 			const stock::StockDataProviderPtr& stockDataProvider);
 
-	void execute(ENetPeer* peer, const void* message) override;
+	void execute(const network::Connection& connection, void* attachment, const void* message) override;
 };
 
 }
@@ -14,10 +14,18 @@
 #include "backend/entity/Npc.h"
 #include "backend/world/Map.h"
 #include "attrib/ContainerProvider.h"
+#include "voxel/Constants.h"
+#include "voxelutil/FloorTraceResult.h"
 
 namespace backend {
 
 static const long spawnTime = 15000L;
+// the amount of npcs that are spawned in one tick at most - the rest is spawned in the following ticks
+static const int spawnBudgetPerTick = 16;
+// the amount of validated positions per spawn area
+static const int spawnPoolSize = 64;
+// the amount of floor traces per position before the refill gives up
+static const int spawnPoolAttempts = 8;
 
 SpawnMgr::SpawnMgr(Map* map,
 		const io::FilesystemPtr& filesytem,
@@ -29,16 +37,126 @@ SpawnMgr::SpawnMgr(Map* map,
 		const cooldown::CooldownProviderPtr& cooldownProvider) :
 		_map(map), _loader(loader), _entityStorage(entityStorage), _messageSender(messageSender), _timeProvider(timeProvider),
 		_containerProvider(containerProvider), _cooldownProvider(cooldownProvider),
-		_filesystem(filesytem) {
+		_filesystem(filesytem), _population(EntityTypes, 0), _pending(EntityTypes, 0),
+		_behaviours(EntityTypes), _threadPool(1, "SpawnMgr") {
 }
 
 void SpawnMgr::shutdown() {
+	_shutdown = true;
+	_threadPool.shutdown();
+	_areas.clear();
+	for (ai::TreeNodePtr& behaviour : _behaviours) {
+		behaviour = ai::TreeNodePtr();
+	}
 }
 
 bool SpawnMgr::init() {
+	_shutdown = false;
+	_threadPool.init();
+	// the same area as voxelworld::WorldMgr::randomPos()
+	addSpawnArea(math::Rect<int>(-100, -100, 100, 100));
+	return true;
+}
+
+void SpawnMgr::addSpawnArea(const math::Rect<int>& rect) {
+	// the pool is filled as soon as the first npc is waiting for its spawn
+	_areas.emplace_back(new SpawnArea(rect, (unsigned int)_areas.size() + 1u));
+}
+
+void SpawnMgr::onNpcAdded(network::EntityType type) {
+	++_population[(int)type];
+}
+
+void SpawnMgr::onNpcRemoved(network::EntityType type) {
+	core_assert_msg(_population[(int)type] > 0, "Population of %s would get negative", network::EnumNameEntityType(type));
+	--_population[(int)type];
+}
+
+int SpawnMgr::spawnPositions() const {
+	int amount = 0;
+	for (const std::unique_ptr<SpawnArea>& area : _areas) {
+		core::ScopedLock lock(area->lock);
+		amount += (int)area->positions.size();
+	}
+	return amount;
+}
+
+void SpawnMgr::refill(SpawnArea* area) {
+	if (area->exhausted || area->refilling.exchange(true)) {
+		return;
+	}
+	_threadPool.enqueue([this, area] () {
+		fillSpawnArea(area);
+		area->refilling = false;
+	});
+}
+
+void SpawnMgr::fillSpawnArea(SpawnArea* area) {
+	core_trace_scoped(SpawnMgrFillSpawnArea);
+	int missing;
+	{
+		core::ScopedLock lock(area->lock);
+		missing = spawnPoolSize - (int)area->positions.size();
+	}
+	const math::Rect<int>& rect = area->rect;
+	const int attempts = missing * spawnPoolAttempts;
+	bool found = false;
+	for (int i = 0; i < attempts && missing > 0; ++i) {
+		if (_shutdown) {
+			return;
+		}
+		const int x = area->random.random(rect.getMinX(), rect.getMaxX());
+		const int z = area->random.random(rect.getMinZ(), rect.getMaxZ());
+		const voxelutil::FloorTraceResult& trace = _map->findFloor(glm::ivec3(x, voxel::MAX_HEIGHT / 2, z));
+		if (!trace.isValid()) {
+			continue;
+		}
+		core::ScopedLock lock(area->lock);
+		area->positions.emplace_back(x, trace.heightLevel, z);
+		--missing;
+		found = true;
+	}
+	if (!found && attempts > 0) {
+		Log::debug("No floor found in spawn area %i:%i - %i:%i", rect.getMinX(), rect.getMinZ(), rect.getMaxX(), rect.getMaxZ());
+		area->exhausted = true;
+	}
+}
+
+bool SpawnMgr::spawnAreasExhausted() const {
+	for (const std::unique_ptr<SpawnArea>& area : _areas) {
+		if (!area->exhausted || area->refilling) {
+			return false;
+		}
+	}
 	return true;
 }
 
+bool SpawnMgr::popSpawnPosition(glm::ivec3& pos) {
+	const size_t areas = _areas.size();
+	for (size_t i = 0u; i < areas; ++i) {
+		SpawnArea* area = _areas[_nextArea].get();
+		_nextArea = (_nextArea + 1u) % areas;
+		bool found = false;
+		bool low;
+		{
+			core::ScopedLock lock(area->lock);
+			if (!area->positions.empty()) {
+				pos = area->positions.back();
+				area->positions.pop_back();
+				found = true;
+			}
+			low = (int)area->positions.size() < spawnPoolSize / 2;
+		}
+		if (low) {
+			refill(area);
+		}
+		if (found) {
+			return true;
+		}
+	}
+	return false;
+}
+
 void SpawnMgr::spawnCharacters() {
 	// TODO: let this number come from the map lua script
 	spawnEntity(network::EntityType::BEGIN_CHARACTERS, network::EntityType::MAX_CHARACTERS, 1);
@@ -50,55 +168,82 @@ void SpawnMgr::spawnAnimals() {
 }
 
 void SpawnMgr::spawnEntity(network::EntityType start, network::EntityType end, int maxAmount) {
-	ai::Zone& zone = *_map->zone();
-	const int offset = (int)start + 1;
-	const int size = (int)end - offset;
-	std::vector<int> count(size, 0);
-	zone.execute([&] (const ai::AIPtr& ai) {
-		const AICharacter& chr = ai::character_cast<AICharacter>(ai->getCharacter());
-		const Npc& npc = chr.getNpc();
-		const network::EntityType type = npc.entityType();
-		if (type <= start || type >= end) {
-			return;
+	for (int i = (int)start + 1; i < (int)end; ++i) {
+		const int needToSpawn = maxAmount - _population[i] - _pending[i];
+		if (needToSpawn <= 0) {
+			continue;
 		}
-		const int index = (int)type - offset;
-		++count[index];
-	});
-
-	for (int i = 0; i < size; ++i) {
-		if (count[i] >= maxAmount) {
+		if (!behaviour(static_cast<network::EntityType>(i))) {
+			// don't validate spawn positions for npcs that can't be spawned anyway
 			continue;
 		}
+		_pending[i] += needToSpawn;
+	}
+}
 
-		const int needToSpawn = maxAmount - count[i];
-		network::EntityType type = static_cast<network::EntityType>(offset + i);
-		spawn(type, needToSpawn);
+void SpawnMgr::spawnPending() {
+	int budget = spawnBudgetPerTick;
+	for (int i = 0; i < EntityTypes && budget > 0; ++i) {
+		while (_pending[i] > 0 && budget > 0) {
+			glm::ivec3 pos;
+			const poi::PoiResult& poi = _map->poiProvider()->query(poi::Type::GENERIC);
+			if (poi.valid) {
+				pos = glm::ivec3(poi.pos);
+			} else if (!popSpawnPosition(pos)) {
+				if (spawnAreasExhausted()) {
+					// don't wait forever for positions that will never come - the npcs are
+					// queued again in the next spawn interval
+					int dropped = 0;
+					for (int& pending : _pending) {
+						dropped += pending;
+						pending = 0;
+					}
+					Log::warn("No spawn position found - dropped %i pending npcs", dropped);
+				}
+				// wait for the background refill
+				return;
+			}
+			--_pending[i];
+			--budget;
+			const network::EntityType type = static_cast<network::EntityType>(i);
+			if (!spawn(type, &pos)) {
+				Log::warn("Failed to spawn %s", network::EnumNameEntityType(type));
+			}
+		}
 	}
 }
 
 bool SpawnMgr::onSpawn(const NpcPtr& npc, const glm::ivec3* pos) {
 	npc->init(pos);
 	// now let it tick
-	if (_map->addNpc(npc)) {
+	const bool added = pos != nullptr ? _map->addNpc(npc, glm::vec3(*pos)) : _map->addNpc(npc);
+	if (added) {
 		_entityStorage->addNpc(npc);
 		return true;
 	}
 	return false;
 }
 
+const ai::TreeNodePtr& SpawnMgr::behaviour(network::EntityType type) {
+	ai::TreeNodePtr& behaviour = _behaviours[(int)type];
+	if (!behaviour) {
+		behaviour = _loader->load(network::EnumNameEntityType(type));
+	}
+	return behaviour;
+}
+
 NpcPtr SpawnMgr::createNpc(network::EntityType type, const ai::TreeNodePtr& behaviour) {
 	return std::make_shared<Npc>(type, behaviour, _map->ptr(), _messageSender,
 					_timeProvider, _containerProvider, _cooldownProvider);
 }
 
 NpcPtr SpawnMgr::spawn(network::EntityType type, const glm::ivec3* pos) {
-	const char *typeName = network::EnumNameEntityType(type);
-	const ai::TreeNodePtr& behaviour = _loader->load(typeName);
-	if (!behaviour) {
-		Log::error("could not load the behaviour tree %s", typeName);
+	const ai::TreeNodePtr& treeNode = behaviour(type);
+	if (!treeNode) {
+		Log::error("could not load the behaviour tree %s", network::EnumNameEntityType(type));
 		return NpcPtr();
 	}
-	const NpcPtr& npc = createNpc(type, behaviour);
+	const NpcPtr& npc = createNpc(type, treeNode);
 	if (!onSpawn(npc, pos)) {
 		return NpcPtr();
 	}
@@ -113,14 +258,13 @@ int SpawnMgr::spawn(network::EntityType type, int amount, const glm::ivec3* pos)
 		return 0;
 	}
 
-	const char *typeName = network::EnumNameEntityType(type);
-	const ai::TreeNodePtr& behaviour = _loader->load(typeName);
-	if (!behaviour) {
-		Log::error("could not load the behaviour tree %s", typeName);
+	const ai::TreeNodePtr& treeNode = behaviour(type);
+	if (!treeNode) {
+		Log::error("could not load the behaviour tree %s", network::EnumNameEntityType(type));
 		return 0;
 	}
 	for (int x = 0; x < amount; ++x) {
-		const NpcPtr& npc = createNpc(type, behaviour);
+		const NpcPtr& npc = createNpc(type, treeNode);
 		onSpawn(npc, pos);
 	}
 
@@ -132,9 +276,14 @@ void SpawnMgr::update(long dt) {
 	_time += dt;
 	if (_time >= spawnTime) {
 		_time -= spawnTime;
+		// try the areas without floor again
+		for (const std::unique_ptr<SpawnArea>& area : _areas) {
+			area->exhausted = false;
+		}
 		spawnAnimals();
 		spawnCharacters();
 	}
+	spawnPending();
 }
 
 }
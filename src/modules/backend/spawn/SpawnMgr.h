@@ -7,13 +7,51 @@
 #include "ServerMessages_generated.h"
 #include "backend/ForwardDecl.h"
 #include "core/IComponent.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ThreadPool.h"
+#include "core/Trace.h"
+#include "math/Random.h"
+#include "math/Rect.h"
 #include <glm/fwd.hpp>
 #include <glm/vec3.hpp>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 namespace backend {
 
+/**
+ * @brief Keeps the npc population of a map at the configured amount
+ *
+ * The population of each entity type is counted when npcs are added to or removed from the map - so the
+ * zone is never scanned. Missing npcs are queued and spawned with a per tick budget. Like in
+ * @c Map::findStartPosition() a point of interest is preferred - otherwise the spawn position is taken from
+ * a pool of positions that were validated in the background. If no area yields a valid floor, the queued
+ * npcs are dropped and queued again in the next spawn interval.
+ */
 class SpawnMgr : public core::IComponent {
 private:
+	static constexpr int EntityTypes = (int)network::EntityType::MAX + 1;
+
+	/**
+	 * @brief Spawn positions with a valid floor in an area of the map
+	 *
+	 * The pool is refilled by a task in the thread pool of the spawn manager - there is only one
+	 * task per area at a time.
+	 */
+	struct SpawnArea {
+		math::Rect<int> rect;
+		math::Random random;
+		core_trace_mutex(core::Lock, lock, "SpawnArea");
+		std::vector<glm::ivec3> positions;
+		std::atomic_bool refilling { false };
+		// the last refill didn't find any floor - the area isn't refilled before the next spawn interval
+		std::atomic_bool exhausted { false };
+
+		SpawnArea(const math::Rect<int>& _rect, unsigned int seed) : rect(_rect), random(seed) {
+		}
+	};
+
 	Map* _map;
 	AILoaderPtr _loader;
 	EntityStoragePtr _entityStorage;
@@ -24,10 +62,31 @@ private:
 	io::FilesystemPtr _filesystem;
 	long _time = 15000L;
 
+	// npcs of each type that are on the map
+	std::vector<int> _population;
+	// npcs of each type that are waiting for their spawn
+	std::vector<int> _pending;
+	std::vector<ai::TreeNodePtr> _behaviours;
+
+	std::vector<std::unique_ptr<SpawnArea>> _areas;
+	size_t _nextArea = 0u;
+	core::ThreadPool _threadPool;
+	std::atomic_bool _shutdown { false };
+
 	void spawnEntity(network::EntityType start, network::EntityType end, int maxAmount);
 	void spawnAnimals();
 	void spawnCharacters();
+	void spawnPending();
+
+	bool popSpawnPosition(glm::ivec3& pos);
+	/**
+	 * @return @c true if the refills of all areas didn't find any floor
+	 */
+	bool spawnAreasExhausted() const;
+	void refill(SpawnArea* area);
+	void fillSpawnArea(SpawnArea* area);
 
+	const ai::TreeNodePtr& behaviour(network::EntityType type);
 	NpcPtr createNpc(network::EntityType type, const ai::TreeNodePtr& behaviour);
 	bool onSpawn(const NpcPtr& npc, const glm::ivec3* pos);
 
@@ -46,8 +105,44 @@ public:
 	NpcPtr spawn(network::EntityType type, const glm::ivec3* pos = nullptr);
 	int spawn(network::EntityType type, int amount, const glm::ivec3* pos = nullptr);
 	void update(long dt);
+
+	/**
+	 * @brief Adds an area (x and z) that the pooled spawn positions are taken from
+	 * @note The map area around the origin is added in @c init()
+	 */
+	void addSpawnArea(const math::Rect<int>& rect);
+
+	/**
+	 * @brief Must be called by the map for every npc that is added to the map
+	 */
+	void onNpcAdded(network::EntityType type);
+	/**
+	 * @brief Must be called by the map for every npc that is removed from the map
+	 */
+	void onNpcRemoved(network::EntityType type);
+
+	/**
+	 * @return The amount of npcs of the given type that are currently on the map
+	 */
+	int population(network::EntityType type) const;
+	/**
+	 * @return The amount of npcs of the given type that are waiting to get spawned
+	 */
+	int pending(network::EntityType type) const;
+	/**
+	 * @return The amount of validated spawn positions in all areas
+	 */
+	int spawnPositions() const;
 };
 
+inline int SpawnMgr::population(network::EntityType type) const {
+	return _population[(int)type];
+}
+
+inline int SpawnMgr::pending(network::EntityType type) const {
+	return _pending[(int)type];
+}
+
 typedef std::shared_ptr<SpawnMgr> SpawnMgrPtr;
 
 }
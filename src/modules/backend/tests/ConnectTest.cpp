@@ -99,7 +99,7 @@ public:
 			UserConnectHandler(int *called) : _called(called) {
 			}
 
-			void execute(ENetPeer* peer, const void* message) override {
+			void execute(const network::Connection& connection, void* attachment, const void* message) override {
 				(*_called)++;
 			}
 		};
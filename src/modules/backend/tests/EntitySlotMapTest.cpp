@@ -0,0 +1,106 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "backend/entity/EntitySlotMap.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace backend {
+
+namespace {
+
+class TestEntity {
+public:
+	EntityId _id;
+
+	TestEntity(EntityId id) : _id(id) {
+	}
+
+	EntityId id() const {
+		return _id;
+	}
+};
+typedef std::shared_ptr<TestEntity> TestEntityPtr;
+typedef EntitySlotMap<TestEntityPtr> TestSlotMap;
+
+}
+
+class EntitySlotMapTest: public core::AbstractTest {
+protected:
+	std::vector<TestEntityPtr> create(TestSlotMap& slotMap, int amount) const {
+		std::vector<TestEntityPtr> entities;
+		for (int i = 0; i < amount; ++i) {
+			entities.push_back(std::make_shared<TestEntity>((EntityId)(i + 1) * 10));
+			EXPECT_TRUE(slotMap.add(entities.back()).valid());
+		}
+		return entities;
+	}
+};
+
+TEST_F(EntitySlotMapTest, testAddRemove) {
+	TestSlotMap slotMap;
+	const std::vector<TestEntityPtr>& entities = create(slotMap, 10);
+	EXPECT_EQ(10u, slotMap.size());
+	EXPECT_FALSE(slotMap.add(entities[3]).valid()) << "Entities with the same id should not be added twice";
+	for (const TestEntityPtr& entity : entities) {
+		EXPECT_EQ(entity, slotMap.get(entity->id()));
+	}
+	EXPECT_TRUE(slotMap.remove(entities[0]->id()));
+	EXPECT_FALSE(slotMap.remove(entities[0]->id()));
+	EXPECT_FALSE(slotMap.get(entities[0]->id()));
+	EXPECT_TRUE(slotMap.remove(entities[9]->id()));
+	EXPECT_EQ(8u, slotMap.size());
+	for (int i = 1; i < 9; ++i) {
+		EXPECT_EQ(entities[i], slotMap.get(entities[i]->id()));
+	}
+	slotMap.clear();
+	EXPECT_TRUE(slotMap.empty());
+	EXPECT_FALSE(slotMap.get(entities[1]->id()));
+}
+
+TEST_F(EntitySlotMapTest, testStaleHandle) {
+	TestSlotMap slotMap;
+	const std::vector<TestEntityPtr>& entities = create(slotMap, 3);
+	const TestSlotMap::Handle handle = slotMap.handle(entities[0]->id());
+	const TestSlotMap::Handle other = slotMap.handle(entities[2]->id());
+	ASSERT_TRUE(slotMap.valid(handle));
+	ASSERT_NE(nullptr, slotMap.get(handle));
+	EXPECT_EQ(entities[0], *slotMap.get(handle));
+	EXPECT_TRUE(slotMap.remove(handle));
+	EXPECT_FALSE(slotMap.valid(handle));
+	EXPECT_EQ(nullptr, slotMap.get(handle));
+	// the last entity was moved into the free place - the handle is still valid
+	ASSERT_TRUE(slotMap.valid(other));
+	EXPECT_EQ(entities[2], *slotMap.get(other));
+	// the slot is reused with a new generation
+	const TestEntityPtr& entity = std::make_shared<TestEntity>(1000);
+	const TestSlotMap::Handle reused = slotMap.add(entity);
+	EXPECT_EQ(handle.slot, reused.slot);
+	EXPECT_NE(handle.generation, reused.generation);
+	EXPECT_FALSE(slotMap.valid(handle));
+	EXPECT_EQ(entity, *slotMap.get(reused));
+}
+
+TEST_F(EntitySlotMapTest, testUpdateRemove) {
+	TestSlotMap slotMap;
+	const std::vector<TestEntityPtr>& entities = create(slotMap, 100);
+	std::vector<EntityId> updated;
+	const int removed = slotMap.update([&] (const TestEntityPtr& entity) {
+		updated.push_back(entity->id());
+		return entity->id() % 30 != 0;
+	});
+	EXPECT_EQ(33, removed);
+	EXPECT_EQ(67u, slotMap.size());
+	// every entity is updated exactly once - even if the last entity is moved to the index of a removed one
+	ASSERT_EQ(100u, updated.size());
+	std::sort(updated.begin(), updated.end());
+	for (size_t i = 0; i < entities.size(); ++i) {
+		EXPECT_EQ(entities[i]->id(), updated[i]);
+		EXPECT_EQ(entities[i]->id() % 30 != 0, slotMap.has(entities[i]->id()));
+	}
+}
+
+}
@@ -0,0 +1,84 @@
+/**
+ * @file
+ */
+
+#include "NpcTest.h"
+#include "backend/entity/ai/AICharacter.h"
+#include "math/Random.h"
+#include <SDL_timer.h>
+#include <vector>
+
+namespace backend {
+
+class SpawnMgrTest: public NpcTest {
+private:
+	using Super = NpcTest;
+protected:
+	const network::EntityType _types[2] { network::EntityType::ANIMAL_RABBIT, network::EntityType::ANIMAL_WOLF };
+
+	int zoneCount(network::EntityType type) const {
+		int count = 0;
+		map->zone()->execute([&] (const ai::AIPtr& ai) {
+			const AICharacter& chr = ai::character_cast<AICharacter>(ai->getCharacter());
+			if (chr.getNpc().entityType() == type) {
+				++count;
+			}
+		});
+		return count;
+	}
+};
+
+TEST_F(SpawnMgrTest, testPopulationChurn) {
+	const SpawnMgrPtr& spawnMgr = map->spawnMgr();
+	math::Random random(42);
+	std::vector<NpcPtr> npcs;
+	for (int round = 0; round < 10; ++round) {
+		for (int i = 0; i < 20; ++i) {
+			npcs.push_back(create(_types[random.random(0, 1)]));
+		}
+		for (int i = 0; i < 15; ++i) {
+			const int index = random.random(0, (int)npcs.size() - 1);
+			ASSERT_TRUE(map->removeNpc(npcs[index]->id()));
+			npcs.erase(npcs.begin() + index);
+		}
+		// removing an npc that is no longer on the map doesn't change the population
+		EXPECT_FALSE(map->removeNpc(0));
+		map->zone()->update(0L);
+		for (network::EntityType type : _types) {
+			ASSERT_EQ(zoneCount(type), spawnMgr->population(type)) << "round " << round << " type " << network::EnumNameEntityType(type);
+		}
+	}
+	EXPECT_EQ((int)npcs.size(), spawnMgr->population(_types[0]) + spawnMgr->population(_types[1]));
+}
+
+TEST_F(SpawnMgrTest, testSpawnPending) {
+	const SpawnMgrPtr& spawnMgr = map->spawnMgr();
+	const NpcPtr& rabbit = create(network::EntityType::ANIMAL_RABBIT);
+	EXPECT_EQ(0, spawnMgr->spawnPositions());
+	// one npc of every animal and character type is queued - the rabbit is already there
+	spawnMgr->update(15000L);
+	EXPECT_EQ(0, spawnMgr->pending(network::EntityType::ANIMAL_RABBIT));
+	EXPECT_EQ(1, spawnMgr->population(network::EntityType::ANIMAL_WOLF) + spawnMgr->pending(network::EntityType::ANIMAL_WOLF));
+	// the next spawn interval doesn't queue the pending npcs again
+	spawnMgr->update(15000L);
+	EXPECT_EQ(1, spawnMgr->population(network::EntityType::ANIMAL_WOLF) + spawnMgr->pending(network::EntityType::ANIMAL_WOLF));
+	// the spawn positions are validated in the background - the npcs are spawned once they are available
+	for (int i = 0; i < 6000 && spawnMgr->pending(network::EntityType::ANIMAL_WOLF) > 0; ++i) {
+		SDL_Delay(10);
+		spawnMgr->update(0L);
+	}
+	map->zone()->update(0L);
+	for (int i = (int)network::EntityType::BEGIN_ANIMAL + 1; i < (int)network::EntityType::MAX_ANIMAL; ++i) {
+		const network::EntityType type = (network::EntityType)i;
+		EXPECT_EQ(0, spawnMgr->pending(type)) << network::EnumNameEntityType(type);
+		EXPECT_EQ(1, spawnMgr->population(type)) << network::EnumNameEntityType(type);
+		EXPECT_EQ(zoneCount(type), spawnMgr->population(type)) << network::EnumNameEntityType(type);
+	}
+	// a removed npc is queued again with the next spawn interval
+	ASSERT_TRUE(map->removeNpc(rabbit->id()));
+	EXPECT_EQ(0, spawnMgr->population(network::EntityType::ANIMAL_RABBIT));
+	spawnMgr->update(15000L);
+	EXPECT_EQ(1, spawnMgr->pending(network::EntityType::ANIMAL_RABBIT) + spawnMgr->population(network::EntityType::ANIMAL_RABBIT));
+}
+
+}
@@ -67,8 +67,15 @@ protected:
 		}
 	}
 
+	void TearDown() override {
+		if (_dbSupported) {
+			persistenceMgr->shutdown();
+		}
+		Super::TearDown();
+	}
+
 	inline UserPtr create(EntityId id, const char* name = "noname") {
-		const UserPtr& u = std::make_shared<User>(nullptr, id, name, map, messageSender, timeProvider,
+		const UserPtr& u = std::make_shared<User>(network::Connection(), id, name, map, messageSender, timeProvider,
 				containerProvider, cooldownProvider, dbHandler, persistenceMgr, stockDataProvider);
 		u->init();
 		map->addUser(u);
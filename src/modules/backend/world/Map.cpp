@@ -59,7 +59,7 @@ bool Map::getDirtyModels(Models& models) {
 	return false;
 }
 
-bool Map::updateEntity(const EntityPtr& entity, long dt) {
+bool Map::updateEntity(const EntityPtr& entity, long dt, bool sendEntityUpdates) {
 	core_trace_scoped(EntityUpdate);
 	if (!entity->update(dt)) {
 		return false;
@@ -77,7 +77,7 @@ bool Map::updateEntity(const EntityPtr& entity, long dt) {
 		}
 	}
 	set.erase(entity);
-	entity->updateVisible(set);
+	entity->updateVisible(set, sendEntityUpdates);
 	return true;
 }
 
@@ -88,32 +88,37 @@ void Map::update(long dt) {
 	_zone->update(dt);
 	_attackMgr.update(dt);
 
-	for (auto i = _users.begin(); i != _users.end();) {
-		UserPtr user = i->second;
-		if (updateEntity(user, dt)) {
-			++i;
-			continue;
+	// the clients are interpolating between the entity updates - they don't have to be sent every tick
+	_entityUpdateTime += dt;
+	const bool sendEntityUpdates = _entityUpdateTime >= _entityUpdateInterval->intVal();
+	if (sendEntityUpdates) {
+		_entityUpdateTime = 0;
+	}
+
+	_users.update([this, dt, sendEntityUpdates] (const UserPtr& user) {
+		if (updateEntity(user, dt, sendEntityUpdates)) {
+			return true;
 		}
 		Log::debug("remove user " PRIEntId, user->id());
 		_quadTree.remove(QuadTreeNode { user });
-		i = _users.erase(i);
 		_eventBus->enqueue(std::make_shared<EntityDeleteEvent>(user->id(), user->entityType()));
-	}
-	for (auto i = _npcs.begin(); i != _npcs.end();) {
-		NpcPtr npc = i->second;
-		if (updateEntity(npc, dt)) {
-			++i;
-			continue;
+		return false;
+	});
+	_npcs.update([this, dt, sendEntityUpdates] (const NpcPtr& npc) {
+		if (updateEntity(npc, dt, sendEntityUpdates)) {
+			return true;
 		}
 		Log::debug("remove npc " PRIEntId, npc->id());
 		_quadTree.remove(QuadTreeNode { npc });
-		i = _npcs.erase(i);
 		_zone->removeAI(npc->ai());
+		_spawnMgr->onNpcRemoved(npc->entityType());
 		_eventBus->enqueue(std::make_shared<EntityDeleteEvent>(npc->id(), npc->entityType()));
-	}
+		return false;
+	});
 }
 
 bool Map::init() {
+	_entityUpdateInterval = core::Var::get(cfg::ServerEntityUpdateInterval, "200");
 	if (!_attackMgr.init()) {
 		Log::error("Failed to init attack mgr");
 		return false;
@@ -174,46 +179,51 @@ glm::vec3 Map::findStartPosition(const EntityPtr& entity, poi::Type type) const
 }
 
 void Map::addUser(const UserPtr& user) {
-	auto i = _users.insert(std::make_pair(user->id(), user));
-	if (!i.second) {
+	if (_users.has(user->id())) {
 		return;
 	}
 	const glm::vec3& pos = findStartPosition(user);
 	user->setMap(ptr(), pos);
+	_users.add(user);
 	_quadTree.insert(QuadTreeNode { user });
 	_eventBus->enqueue(std::make_shared<EntityAddToMapEvent>(user));
 	_poiProvider->add(pos, poi::Type::SPAWN);
 }
 
 bool Map::removeUser(EntityId id) {
-	UsersIter i = _users.find(id);
-	if (i == _users.end()) {
+	UserPtr user = _users.get(id);
+	if (!user) {
 		return false;
 	}
-	UserPtr user = i->second;
 	_quadTree.remove(QuadTreeNode { user });
-	_users.erase(i);
+	_users.remove(id);
 	_eventBus->enqueue(std::make_shared<EntityRemoveFromMapEvent>(user));
 	return true;
 }
 
 UserPtr Map::user(EntityId id) {
-	UsersIter i = _users.find(id);
-	if (i == _users.end()) {
+	UserPtr user = _users.get(id);
+	if (!user) {
 		Log::trace("Could not find user with id " PRIEntId, id);
-		return UserPtr();
 	}
-	return i->second;
+	return user;
 }
 
 bool Map::addNpc(const NpcPtr& npc) {
-	auto i = _npcs.insert(std::make_pair(npc->id(), npc));
-	if (!i.second) {
+	if (_npcs.has(npc->id())) {
+		return false;
+	}
+	return addNpc(npc, findStartPosition(npc));
+}
+
+bool Map::addNpc(const NpcPtr& npc, const glm::vec3& pos) {
+	if (_npcs.has(npc->id())) {
 		return false;
 	}
-	const glm::vec3& pos = findStartPosition(npc);
 	npc->setMap(ptr(), pos);
+	_npcs.add(npc);
 	_zone->addAI(npc->ai());
+	_spawnMgr->onNpcAdded(npc->entityType());
 	_quadTree.insert(QuadTreeNode { npc });
 	_eventBus->enqueue(std::make_shared<EntityAddToMapEvent>(npc));
 	_poiProvider->add(pos, poi::Type::SPAWN);
@@ -221,25 +231,24 @@ bool Map::addNpc(const NpcPtr& npc) {
 }
 
 bool Map::removeNpc(EntityId id) {
-	NpcsIter i = _npcs.find(id);
-	if (i == _npcs.end()) {
+	NpcPtr npc = _npcs.get(id);
+	if (!npc) {
 		return false;
 	}
-	NpcPtr npc = i->second;
 	_quadTree.remove(QuadTreeNode { npc });
-	_npcs.erase(i);
+	_npcs.remove(id);
 	_zone->removeAI(npc->ai());
+	_spawnMgr->onNpcRemoved(npc->entityType());
 	_eventBus->enqueue(std::make_shared<EntityRemoveFromMapEvent>(npc));
 	return true;
 }
 
 NpcPtr Map::npc(EntityId id) {
-	NpcsIter i = _npcs.find(id);
-	if (i == _npcs.end()) {
+	NpcPtr npc = _npcs.get(id);
+	if (!npc) {
 		Log::trace("Could not find npc with id " PRIEntId, id);
-		return NpcPtr();
 	}
-	return i->second;
+	return npc;
 }
 
 voxelutil::FloorTraceResult Map::findFloor(const glm::ivec3& pos, int maxDistanceY) const {
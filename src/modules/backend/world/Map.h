@@ -12,6 +12,7 @@
 #include "ai/common/CharacterId.h"
 #include "voxelutil/FloorTraceResult.h"
 #include "core/IComponent.h"
+#include "core/Var.h"
 #include "backend/attack/AttackMgr.h"
 #include "persistence/ISavable.h"
 #include "persistence/ForwardDecl.h"
@@ -19,8 +20,8 @@
 #include "voxel/Constants.h"
 #include "DBChunkPersister.h"
 #include "MapId.h"
+#include "backend/entity/EntitySlotMap.h"
 #include <memory>
-#include <unordered_map>
 #include <glm/fwd.hpp>
 #include <glm/vec3.hpp>
 
@@ -46,12 +47,10 @@ private:
 
 	ai::Zone* _zone = nullptr;
 
-	typedef std::unordered_map<ai::CharacterId, NpcPtr> Npcs;
-	typedef Npcs::iterator NpcsIter;
+	typedef EntitySlotMap<NpcPtr> Npcs;
 	Npcs _npcs;
 
-	typedef std::unordered_map<EntityId, UserPtr> Users;
-	typedef Users::iterator UsersIter;
+	typedef EntitySlotMap<UserPtr> Users;
 	Users _users;
 
 	AttackMgr _attackMgr;
@@ -65,10 +64,14 @@ private:
 
 	math::QuadTree<QuadTreeNode, float> _quadTree;
 	DBChunkPersisterPtr _chunkPersister;
+	core::VarPtr _entityUpdateInterval;
+	// the millis since the last entity updates were sent
+	long _entityUpdateTime = 0;
 	/**
+	 * @param sendEntityUpdates Send the state of the visible entities to the clients
 	 * @return @c false if the entity should be removed from the server.
 	 */
-	bool updateEntity(const EntityPtr& entity, long dt);
+	bool updateEntity(const EntityPtr& entity, long dt, bool sendEntityUpdates);
 
 	glm::vec3 findStartPosition(const EntityPtr& entity, poi::Type type = poi::Type::GENERIC) const;
 
@@ -114,6 +117,10 @@ public:
 	UserPtr user(EntityId id);
 
 	bool addNpc(const NpcPtr& npc);
+	/**
+	 * @brief Adds the npc at the given position - the position is not validated
+	 */
+	bool addNpc(const NpcPtr& npc, const glm::vec3& pos);
 	/**
 	 * @brief Remove npc from map but keep it in the world
 	 * @note The npc will keep this map set up to the point a new @c addNpc() was called on another map instance.
@@ -25,6 +25,7 @@
 #include <sys/time.h>
 #endif
 #include <signal.h>
+#include <atomic>
 
 namespace core {
 
@@ -33,6 +34,15 @@ static void catch_function(int signo) {
 	abort();
 }
 
+// the trace is written in the main loop - nothing else is safe to do in a signal handler
+static std::atomic_bool _traceDumpRequested { false };
+
+#ifdef SIGUSR1
+static void catch_tracedump(int signo) {
+	_traceDumpRequested = true;
+}
+#endif
+
 App* App::_staticInstance;
 thread_local std::stack<App::TraceData> App::_traceData;
 
@@ -45,6 +55,9 @@ App::App(const metric::MetricPtr& metric, const io::FilesystemPtr& filesystem, c
 		_filesystem(filesystem), _eventBus(eventBus), _threadPool(std::make_shared<core::ThreadPool>(threadPoolSize, "Core")),
 		_timeProvider(timeProvider), _metric(metric) {
 	signal(SIGSEGV, catch_function);
+#ifdef SIGUSR1
+	signal(SIGUSR1, catch_tracedump);
+#endif
 	_initialLogLevel = SDL_LOG_PRIORITY_INFO;
 	SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, (SDL_LogPriority)_initialLogLevel);
 	_timeProvider->updateTickTime();
@@ -53,6 +66,7 @@ App::App(const metric::MetricPtr& metric, const io::FilesystemPtr& filesystem, c
 
 App::~App() {
 	core_trace_set(nullptr);
+	core::traceRecorderSet(nullptr);
 	_metricSender->shutdown();
 	_metric->shutdown();
 	Log::shutdown();
@@ -208,6 +222,9 @@ AppState App::onConstruct() {
 		logVar->setVal(logLevelVal);
 	}
 	core::Var::get(cfg::CoreSysLog, _syslog ? "true" : "false");
+	core::Var::get(cfg::CoreLogAsync, "false");
+	core::Var::get(cfg::CoreLogFile, "");
+	core::Var::get(cfg::CoreTraceRecorder, "false");
 
 	Log::init();
 
@@ -228,6 +245,12 @@ AppState App::onConstruct() {
 		}
 	}).setHelp("Toggle application tracing via statsd");
 
+	core::Command::registerCommand("core_tracedump", [&] (const core::CmdArgs& args) {
+		const double seconds = args.size() > 0 ? core::string::toDouble(args[0]) : 10.0;
+		const core::String filename = args.size() > 1 ? args[1] : _appname + "-trace.json";
+		dumpTrace(seconds, filename);
+	}).setHelp("Write the trace scopes of the last seconds as chrome trace json: [seconds] [file] - needs core_tracerecorder");
+
 	AppCommand::init(_timeProvider);
 
 	for (int i = 0; i < _argc; ++i) {
@@ -287,6 +310,29 @@ AppState App::onConstruct() {
 	return AppState::Init;
 }
 
+void App::updateTraceRecorder() {
+	if (_traceRecorderVar->boolVal()) {
+		core::traceRecorderSet(&_traceRecorder);
+		Log::debug("Activated the trace recorder");
+	} else if (core::traceRecorderSet(nullptr) != nullptr) {
+		Log::debug("Deactivated the trace recorder");
+	}
+}
+
+bool App::dumpTrace(double seconds, const core::String& filename) {
+	if (!_traceRecorderVar || !_traceRecorderVar->boolVal()) {
+		Log::warn("The trace recorder is not active - set %s to true", cfg::CoreTraceRecorder);
+		return false;
+	}
+	const core::String& json = _traceRecorder.chromeTrace(seconds);
+	if (!_filesystem->write(filename, json)) {
+		Log::error("Failed to write the trace to %s", filename.c_str());
+		return false;
+	}
+	Log::info("Wrote the trace of the last %.1f seconds to %s", seconds, filename.c_str());
+	return true;
+}
+
 bool App::toggleTrace() {
 	_traceBlockUntilNextFrame = true;
 	if (core_trace_set(this) == this) {
@@ -344,6 +390,8 @@ AppState App::onInit() {
 	Log::init();
 	_logLevelVar = core::Var::getSafe(cfg::CoreLogLevel);
 	_syslogVar = core::Var::getSafe(cfg::CoreSysLog);
+	_traceRecorderVar = core::Var::getSafe(cfg::CoreTraceRecorder);
+	updateTraceRecorder();
 
 	core::Var::visit([&] (const core::VarPtr& var) {
 		var->markClean();
@@ -410,6 +458,10 @@ void App::onAfterInit() {
 		_logLevelVar->markClean();
 		_syslogVar->markClean();
 	}
+	if (_traceRecorderVar->isDirty()) {
+		updateTraceRecorder();
+		_traceRecorderVar->markClean();
+	}
 }
 
 void App::usage() const {
@@ -504,6 +556,13 @@ AppState App::onRunning() {
 		_logLevelVar->markClean();
 		_syslogVar->markClean();
 	}
+	if (_traceRecorderVar->isDirty()) {
+		updateTraceRecorder();
+		_traceRecorderVar->markClean();
+	}
+	if (_traceDumpRequested.exchange(false)) {
+		dumpTrace(10.0, _appname + "-trace.json");
+	}
 
 	core::Command::update(_deltaFrameSeconds);
 
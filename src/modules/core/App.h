@@ -6,6 +6,7 @@
 
 #include "Common.h"
 #include "Trace.h"
+#include "TraceRecorder.h"
 #include "BindingContext.h"
 #include "String.h"
 #include "collection/List.h"
@@ -129,8 +130,16 @@ protected:
 		uint64_t nanos;
 	};
 	static thread_local std::stack<TraceData> _traceData;
+	// the built-in recorder of the trace scopes - see core_tracedump
+	core::TraceRecorder _traceRecorder;
+	core::VarPtr _traceRecorderVar;
 
 	bool toggleTrace();
+	void updateTraceRecorder();
+	/**
+	 * @brief Writes the trace scopes of the last seconds as chrome trace event json
+	 */
+	bool dumpTrace(double seconds, const core::String& filename);
 
 	virtual void traceBeginFrame(const char *threadName) override;
 	virtual void traceBegin(const char *threadName, const char* name) override;
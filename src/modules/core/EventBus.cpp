@@ -4,87 +4,219 @@
 
 #include "EventBus.h"
 #include "Log.h"
+#include <algorithm>
+#include <thread>
 
 namespace core {
 
-EventBus::EventBus(const int initialHandlerSize) :
-		_lock("EventBus") {
+namespace {
+
+// the event buses the current thread is publishing on - used to detect unsubscribe() calls from handlers
+thread_local std::vector<const EventBus*> _publishingBuses;
+
+}
+
+EventBus::EventBus(const int initialHandlerSize, const int initialQueueSize) :
+		_lock("EventBus"), _dispatchTable(new DispatchTable()), _initialQueueSize(core_max(1, initialQueueSize)),
+		_sharedQueue(_initialQueueSize), _order(_initialQueueSize) {
 	_handlers.reserve(initialHandlerSize);
 }
 
 EventBus::~EventBus() {
 	_handlers.clear();
+	delete (DispatchTable*)_dispatchTable;
+	for (const auto& retired : _retiredTables) {
+		delete retired.second;
+	}
+	_retiredTables.clear();
 }
 
 void EventBus::subscribe(ClassTypeId index, void *handler, const IEventBusTopic* topic) {
 	ScopedWriteLock lock(_lock);
 	EventBusHandlerReferences& handlers = _handlers[index];
-	const EventBusHandlerReference registration(handler, topic);
-	handlers.push_back(registration);
+	handlers.emplace_back(handler, topic);
+	_dirty = true;
 }
 
 int EventBus::unsubscribe(ClassTypeId index, void* handler, const IEventBusTopic* topic) {
 	int unsubscribedHandlers = 0;
-	ScopedWriteLock lock(_lock);
-	EventBusHandlerReferences& handlers = _handlers[index];
-	for (EventBusHandlerReferences::iterator i = handlers.begin(); i != handlers.end();) {
-		EventBusHandlerReference& r = *i;
-		if (r.getHandler() != reinterpret_cast<IEventBusHandler<IEventBusEvent>*>(handler)) {
-			++i;
-			continue;
-		}
-		if (topic != nullptr) {
-			if (r.getTopic() == nullptr) {
+	{
+		ScopedWriteLock lock(_lock);
+		EventBusHandlerReferences& handlers = _handlers[index];
+		for (EventBusHandlerReferences::iterator i = handlers.begin(); i != handlers.end();) {
+			EventBusHandlerReference& r = *i;
+			if (r.getHandler() != reinterpret_cast<IEventBusHandler<IEventBusEvent>*>(handler)) {
 				++i;
 				continue;
 			}
-			if (!(*r.getTopic() == *topic)) {
-				++i;
-				continue;
+			if (topic != nullptr) {
+				if (r.getTopic() == nullptr) {
+					++i;
+					continue;
+				}
+				if (!(*r.getTopic() == *topic)) {
+					++i;
+					continue;
+				}
 			}
+			i = handlers.erase(i);
+			++unsubscribedHandlers;
 		}
-		i = handlers.erase(i);
-		++unsubscribedHandlers;
+		if (unsubscribedHandlers == 0) {
+			return 0;
+		}
+		_dirty = true;
+	}
+	// new publish() calls must not see the handler anymore
+	rebuildDispatchTable();
+	if (isPublishing()) {
+		// waiting for ourselves would never end
+		return unsubscribedHandlers;
 	}
+	waitForPublishers();
+	ScopedWriteLock lock(_lock);
+	reclaimTables();
 	return unsubscribedHandlers;
 }
 
+void EventBus::rebuildDispatchTable() {
+	core_trace_scoped(EventBusRebuildDispatchTable);
+	ScopedWriteLock lock(_lock);
+	if (!_dirty) {
+		return;
+	}
+	DispatchTable* table = new DispatchTable();
+	table->handlers.reserve(_handlers.size());
+	for (const auto& e : _handlers) {
+		if (e.second.empty()) {
+			continue;
+		}
+		table->handlers.emplace(e.first, e.second);
+	}
+	DispatchTable* old = _dispatchTable.exchange(table);
+	_dirty = false;
+	// a publish() call that started in this epoch (or before) might still iterate the old table
+	_retiredTables.emplace_back(_epoch.load(), old);
+	reclaimTables();
+}
+
+void EventBus::tryAdvanceEpoch() {
+	uint64_t epoch = _epoch.load();
+	// the slot of the next epoch is still in use by publish() calls of the previous epoch
+	if (_publishing[(epoch + 1u) & 1u] != 0) {
+		return;
+	}
+	_epoch.compare_exchange_strong(epoch, epoch + 1u);
+}
+
+bool EventBus::isEpochDone(uint64_t epoch) const {
+	const uint64_t current = _epoch.load();
+	if (current >= epoch + 2u) {
+		// the epoch was only advanced after all publish() calls of this epoch were done
+		return true;
+	}
+	// new publish() calls are registered in the slot of the next epoch
+	return current == epoch + 1u && _publishing[epoch & 1u] == 0;
+}
+
+void EventBus::reclaimTables() {
+	if (_retiredTables.empty()) {
+		return;
+	}
+	tryAdvanceEpoch();
+	_retiredTables.erase(std::remove_if(_retiredTables.begin(), _retiredTables.end(), [this] (const std::pair<uint64_t, DispatchTable*>& retired) {
+		if (!isEpochDone(retired.first)) {
+			return false;
+		}
+		delete retired.second;
+		return true;
+	}), _retiredTables.end());
+}
+
+void EventBus::waitForPublishers() {
+	core_trace_scoped(EventBusWaitForPublishers);
+	const uint64_t epoch = _epoch.load();
+	for (;;) {
+		if (_epoch.load() == epoch) {
+			tryAdvanceEpoch();
+		}
+		if (isEpochDone(epoch)) {
+			return;
+		}
+		std::this_thread::yield();
+	}
+}
+
+bool EventBus::isPublishing() const {
+	return std::find(_publishingBuses.begin(), _publishingBuses.end(), this) != _publishingBuses.end();
+}
+
+void EventBus::collectIncoming() {
+	if (_incomingSize == 0) {
+		return;
+	}
+	core::ScopedLock<core::Lock> lock(_incomingLock);
+	for (const IEventBusEventPtr& e : _incoming) {
+		_sharedQueue.push(e);
+		_order.push(&_sharedQueue);
+	}
+	_incoming.clear();
+	_incomingSize = 0;
+}
+
 int EventBus::update(int limit) {
 	core_trace_scoped(EventBusUpdate);
+	collectIncoming();
 	int i = 0;
-	IEventBusEventPtr event;
-	while (_queue.pop(event)) {
-		publish(*event);
+	while (_order.size() > 0u) {
+		EventQueue* queue = _order.front();
+		_order.pop();
+		queue->publishFront(*this);
 		if (limit > 0 && ++i >= limit) {
 			break;
 		}
 	}
-	return _queue.size();
+	return size();
 }
 
 int EventBus::size() const {
-	return  _queue.size();
+	return (int)_order.size() + _incomingSize;
 }
 
 void EventBus::enqueue(const IEventBusEventPtr& e) {
-	_queue.push(e);
+	core::ScopedLock<core::Lock> lock(_incomingLock);
+	_incoming.push_back(e);
+	_incomingSize.increment();
 }
 
 int EventBus::publish(const IEventBusEvent& e) {
+	if (_dirty) {
+		rebuildDispatchTable();
+	}
+	// the table is not deleted as long as we are publishing - it's immutable, so there is no
+	// need to lock - and handlers might subscribe, unsubscribe or publish from within their callbacks.
+	uint64_t epoch;
+	for (;;) {
+		epoch = _epoch.load();
+		_publishing[epoch & 1u].increment();
+		if (_epoch.load() == epoch) {
+			break;
+		}
+		// the epoch was advanced in the meantime - the slot might already be waited for
+		_publishing[epoch & 1u].decrement();
+	}
+	const DispatchTable* table = _dispatchTable;
 	const ClassTypeId index = e.typeId();
-	// must be locked until the execution is done, because we are dealing with raw pointers here.
-	// that means nobody may unsubscribe/subscribe during a publish as we are iterating the list.
-	// if someone would unsubscribe he would maybe still get notified otherwise - or even worse,
-	// the pointer we are iterating over is already freed.
-	ScopedReadLock lock(_lock);
-	EventBusHandlerReferenceMap::iterator i = _handlers.find(index);
-	if (i == _handlers.end()) {
+	auto i = table->handlers.find(index);
+	if (i == table->handlers.end()) {
+		_publishing[epoch & 1u].decrement();
 		return 0;
 	}
+	_publishingBuses.push_back(this);
 
 	int notifiedHandlers = 0;
-	EventBusHandlerReferences& handlers = i->second;
-	for (auto& r : handlers) {
+	const EventBusHandlerReferences& handlers = i->second;
+	for (const EventBusHandlerReference& r : handlers) {
 		if (r.getTopic() != nullptr) {
 			const IEventBusTopic* topic = e.getTopic();
 			if (topic == nullptr) {
@@ -98,6 +230,8 @@ int EventBus::publish(const IEventBusEvent& e) {
 		handler->dispatch(e);
 		++notifiedHandlers;
 	}
+	_publishingBuses.pop_back();
+	_publishing[epoch & 1u].decrement();
 	return notifiedHandlers;
 }
 
@@ -5,13 +5,18 @@
 #pragma once
 
 #include <unordered_map>
-#include <list>
+#include <vector>
 #include <type_traits>
+#include <atomic>
+#include <stdint.h>
 #include <memory>
+#include <new>
 #include "core/Log.h"
 #include "core/Common.h"
+#include "core/Trace.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Lock.h"
 #include "core/concurrent/ReadWriteLock.h"
-#include "core/collection/ConcurrentQueue.h"
 
 namespace core {
 
@@ -128,19 +133,19 @@ public: \
  * @brief EventBus with topic (IEventBusTopic) support
  *
  * Use subscribe() and unsubscribe() to manage your @c IEventBusHandler instances.
+ *
+ * The handlers are dispatched from a flat table per event type. The table is only rebuilt if the
+ * subscriptions changed - publishing an event doesn't allocate memory and doesn't lock.
+ *
+ * Queued events are delivered in the order they were enqueued (strict fifo). Events that are
+ * enqueued by value are copied into a preallocated ring buffer per event type - no memory is
+ * allocated once the ring buffers are big enough.
  */
 class EventBus {
 private:
-	class EventBusHandlerReference;
-	typedef std::list<EventBusHandlerReference> EventBusHandlerReferences;
-	typedef std::unordered_map<ClassTypeId, EventBusHandlerReferences> EventBusHandlerReferenceMap;
-	core::ReadWriteLock _lock;
-
-	core::ConcurrentQueue<IEventBusEventPtr, std::less<IEventBusEventPtr> > _queue;
-
 	class EventBusHandlerReference {
 	private:
-		void* const _handler;
+		void* _handler;
 		const IEventBusTopic *_topic;
 
 	public:
@@ -156,18 +161,188 @@ private:
 			return _topic;
 		}
 	};
+	typedef std::vector<EventBusHandlerReference> EventBusHandlerReferences;
+	typedef std::unordered_map<ClassTypeId, EventBusHandlerReferences> EventBusHandlerReferenceMap;
+
+	/**
+	 * @brief Immutable snapshot of the handlers that is used for publishing events
+	 */
+	struct DispatchTable {
+		EventBusHandlerReferenceMap handlers;
+	};
+
+	/**
+	 * @brief Fifo ring buffer that is only growing if it is full
+	 */
+	template<class T>
+	class EventRing {
+	private:
+		using Storage = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+		Storage* _buffer = nullptr;
+		// always a power of two
+		size_t _capacity = 0u;
+		size_t _front = 0u;
+		size_t _size = 0u;
+
+		inline T* at(size_t i) const {
+			return reinterpret_cast<T*>(&_buffer[(_front + i) & (_capacity - 1u)]);
+		}
+
+		void grow(size_t capacity) {
+			Storage* buffer = new Storage[capacity];
+			for (size_t i = 0u; i < _size; ++i) {
+				T* e = at(i);
+				new (&buffer[i]) T(std::move(*e));
+				e->~T();
+			}
+			delete[] _buffer;
+			_buffer = buffer;
+			_capacity = capacity;
+			_front = 0u;
+		}
+	public:
+		EventRing(size_t capacity) {
+			size_t pot = 1u;
+			while (pot < capacity) {
+				pot <<= 1;
+			}
+			grow(pot);
+		}
+
+		~EventRing() {
+			while (_size > 0u) {
+				pop();
+			}
+			delete[] _buffer;
+		}
+
+		inline size_t size() const {
+			return _size;
+		}
+
+		inline void push(const T& value) {
+			if (_size == _capacity) {
+				grow(_capacity * 2u);
+			}
+			new (at(_size)) T(value);
+			++_size;
+		}
+
+		inline T& front() {
+			core_assert(_size > 0u);
+			return *at(0u);
+		}
+
+		inline void pop() {
+			core_assert(_size > 0u);
+			at(0u)->~T();
+			_front = (_front + 1u) & (_capacity - 1u);
+			--_size;
+		}
+	};
+
+	class EventQueue {
+	public:
+		virtual ~EventQueue() = default;
+		/**
+		 * @brief Removes the oldest event from the queue and publishes it
+		 */
+		virtual void publishFront(EventBus& eventBus) = 0;
+	};
+
+	template<class T>
+	class TypedEventQueue : public EventQueue {
+	private:
+		EventRing<T> _events;
+	public:
+		TypedEventQueue(size_t capacity) :
+				_events(capacity) {
+		}
+
+		inline void push(const T& event) {
+			_events.push(event);
+		}
+
+		void publishFront(EventBus& eventBus) override {
+			// the event is removed before it's published - the handlers might enqueue new events
+			const T event(std::move(_events.front()));
+			_events.pop();
+			eventBus.publishQueued(event);
+		}
+	};
 
+	// the registered handlers - this is only used to build the dispatch table
 	EventBusHandlerReferenceMap _handlers;
+	core::ReadWriteLock _lock;
+	core::AtomicPtr<DispatchTable> _dispatchTable;
+	core::AtomicBool _dirty { false };
+	/**
+	 * Grace periods for the dispatch tables and the unsubscribed handlers: each publish() registers in
+	 * the slot of the epoch it started in. The epoch is only advanced if no publish() of the previous
+	 * epoch is left. After the epoch was advanced, the slot of the old epoch only drains - so once it is
+	 * empty, all publish() calls that might have seen an old table are done.
+	 */
+	std::atomic<uint64_t> _epoch { 0u };
+	core::AtomicInt _publishing[2];
+	// the replaced dispatch tables and the epoch they were replaced in
+	std::vector<std::pair<uint64_t, DispatchTable*>> _retiredTables;
+
+	const size_t _initialQueueSize;
+	std::unordered_map<ClassTypeId, std::unique_ptr<EventQueue>> _typedQueues;
+	TypedEventQueue<IEventBusEventPtr> _sharedQueue;
+	// the queue of each enqueued event - in the order they were enqueued
+	EventRing<EventQueue*> _order;
+
+	// events from enqueue(const IEventBusEventPtr&) - they might come from any thread
+	mutable core_trace_mutex(core::Lock, _incomingLock, "EventBus");
+	std::vector<IEventBusEventPtr> _incoming;
+	core::AtomicInt _incomingSize { 0 };
 
 	int unsubscribe(ClassTypeId index, void* handler, const IEventBusTopic* topic);
 	void subscribe(ClassTypeId index, void *handler, const IEventBusTopic* topic);
+	void rebuildDispatchTable();
+	/**
+	 * @brief Advances the epoch if no publish() of the previous epoch is running anymore
+	 */
+	void tryAdvanceEpoch();
+	/**
+	 * @return @c true if all publish() calls that started in the given epoch (or before) are done
+	 */
+	bool isEpochDone(uint64_t epoch) const;
+	/**
+	 * @brief Deletes the retired dispatch tables that no publish() can use anymore
+	 * @note The write lock must be held
+	 */
+	void reclaimTables();
+	/**
+	 * @brief Waits until all publish() calls that were running when this was called are done
+	 */
+	void waitForPublishers();
+	/**
+	 * @return @c true if the calling thread is inside of a publish() call of this event bus
+	 */
+	bool isPublishing() const;
+	/**
+	 * @brief Move the events from other threads into the fifo
+	 */
+	void collectIncoming();
+
+	inline void publishQueued(const IEventBusEvent& e) {
+		publish(e);
+	}
+
+	inline void publishQueued(const IEventBusEventPtr& e) {
+		publish(*e);
+	}
 
 public:
 	/**
 	 * @param[in] initialHandlerSize Used to calculate the amount of memory that is reserved in the
 	 * handler map to reduce memory allocations.
+	 * @param[in] initialQueueSize The amount of events that can be queued (per event type) before the
+	 * queues have to grow.
 	 */
-	EventBus(const int initialHandlerSize = 64);
+	EventBus(const int initialHandlerSize = 64, const int initialQueueSize = 64);
 	~EventBus();
 
 	/**
@@ -190,6 +365,11 @@ public:
 	 * @c nullptr the given handler is unsubscribed no matter which topic it was subscribed with.
 	 * @sa subscribe()
 	 * @return The amount of unsubscribed IEventBusHandler instances
+	 * @note This waits for the publish() calls in other threads that might still notify the handler - the
+	 * handler can be destroyed once this returns. If this is called from within a handler (the calling thread
+	 * is publishing on this event bus), there is no waiting: the handler must not be destroyed before the
+	 * outermost publish() of this thread returned, and other threads might still notify it until then.
+	 * Because of the waiting, a handler must not block on anything that the unsubscribing thread holds.
 	 */
 	template<class T>
 	int unsubscribe(IEventBusHandler<T>& handler, const IEventBusTopic* topic = nullptr) {
@@ -219,8 +399,27 @@ public:
 
 	/**
 	 * @brief Execute in the main thread in the next tick
+	 * @note This is thread safe
 	 */
 	void enqueue(const IEventBusEventPtr& e);
+
+	/**
+	 * @brief Copies the event into the queue of its type - it is executed in the next update() call
+	 * @note This is not thread safe - must be called from the thread that calls update()
+	 */
+	template<class T, typename std::enable_if<std::is_base_of<IEventBusEvent, T>::value, int>::type = 0>
+	void enqueue(const T& event) {
+		// keep the order of the events that were enqueued before
+		collectIncoming();
+		const ClassTypeId index = T::classTypeId();
+		auto i = _typedQueues.find(index);
+		if (i == _typedQueues.end()) {
+			i = _typedQueues.emplace(index, std::unique_ptr<EventQueue>(new TypedEventQueue<T>(_initialQueueSize))).first;
+		}
+		TypedEventQueue<T>* queue = static_cast<TypedEventQueue<T>*>(i->second.get());
+		queue->push(event);
+		_order.push(queue);
+	}
 };
 
 typedef std::shared_ptr<EventBus> EventBusPtr;
@@ -35,6 +35,11 @@ constexpr const char *ClientGamma = "cl_gamma";
 constexpr const char *ClientShadowMap = "cl_shadowmap";
 constexpr const char *ClientWater = "cl_water";
 constexpr const char *ClientFog = "cl_fog";
+constexpr const char *ClientOcclusionCulling = "cl_occlusionculling";
+// the delay in millis the remote entities are rendered behind the server time
+constexpr const char *ClientInterpolationDelay = "cl_interpolationdelay";
+// the max millis the remote entities are extrapolated if no new update arrives
+constexpr const char *ClientMaxExtrapolation = "cl_maxextrapolation";
 constexpr const char *ClientCameraMaxTargetDistance = "cl_cameramaxtargetdistance";
 constexpr const char *ClientCameraZoomSpeed = "cl_camzoomspeed";
 
@@ -44,11 +49,15 @@ constexpr const char *ClientDebugShadow = "cl_debug_shadow";
 constexpr const char *RenderOutline = "r_renderoutline";
 
 constexpr const char *ServerUserTimeout = "sv_usertimeout";
+// the millis between two entity updates that are sent to the users
+constexpr const char *ServerEntityUpdateInterval = "sv_entityupdateinterval";
 // the server side seed that is used to create the world
 constexpr const char *ServerSeed = "sv_seed";
 constexpr const char *ServerHost = "sv_host";
 constexpr const char *ServerPort = "sv_port";
 constexpr const char *ServerMaxClients = "sv_maxclients";
+// send and receive the packets on a dedicated network thread
+constexpr const char *ServerNetworkThread = "sv_networkthread";
 constexpr const char *ServerPostgresLib = "sv_postgreslib";
 constexpr const char *ServerHttpPort = "sv_httpport";
 // the download urls for the chunks
@@ -59,10 +68,18 @@ constexpr const char *ConsoleCurses = "con_curses";
 constexpr const char *CoreMaxFPS = "core_maxfps";
 constexpr const char *CoreLogLevel = "core_loglevel";
 constexpr const char *CoreSysLog = "core_syslog";
+// log messages are written by a background thread
+constexpr const char *CoreLogAsync = "core_logasync";
+// write the asynchronous log messages into this (rotating) file instead of the console
+constexpr const char *CoreLogFile = "core_logfile";
+// record the trace scopes for core_tracedump
+constexpr const char *CoreTraceRecorder = "core_tracerecorder";
 constexpr const char *CorePath = "core_path";
 
 // The size of the chunk that is extracted with each step
 constexpr const char *VoxelMeshSize = "voxel_meshsize";
+// The memory budget of the mesh cache in kilobytes - 0 is unlimited
+constexpr const char *VoxformatMeshCacheBudget = "voxformat_meshcachebudget";
 
 constexpr const char *DatabaseName = "db_name";
 constexpr const char *DatabaseHost = "db_host";
@@ -71,6 +88,8 @@ constexpr const char *DatabasePassword = "db_pw";
 constexpr const char *DatabaseUser = "db_user";
 constexpr const char *DatabaseMinConnections = "db_minconnections";
 constexpr const char *DatabaseMaxConnections = "db_maxconnections";
+// The time in millis one flush of the persistence manager should take at most
+constexpr const char *DatabaseFlushLatency = "db_flushlatency";
 
 constexpr const char *AppHomePath = "app_homepath";
 constexpr const char *AppBasePath = "app_basepath";
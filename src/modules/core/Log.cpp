@@ -11,8 +11,11 @@
 #include "Enum.h"
 #include "ArrayLength.h"
 #include "Assert.h"
+#include "LogQueue.h"
+#include "concurrent/Lock.h"
 #include <string.h>
 #include <stdio.h>
+#include <atomic>
 #include <unordered_map>
 
 #ifdef HAVE_SYSLOG_H
@@ -39,6 +42,19 @@ static bool _syslog = false;
 static constexpr int bufSize = 4096;
 static SDL_LogPriority _logLevel = SDL_LOG_PRIORITY_INFO;
 static std::unordered_map<uint32_t, int> _logActive;
+// only created if asynchronous logging is enabled - it's never deleted, because other threads
+// might still be about to push a message while the logging is shut down
+static std::atomic<core::LogQueue*> _logQueue { nullptr };
+static std::atomic_bool _logAsync { false };
+
+// the log file is written by the drain thread of the log queue - or by the thread that logs a
+// message while the queue is shut down
+static core_trace_mutex(core::Lock, _logFileLock, "LogFile");
+static FILE* _logFile = nullptr;
+static core::String _logFilePath;
+static size_t _logFileSize = 0u;
+static constexpr size_t logFileMaxSize = 16u * 1024u * 1024u;
+static constexpr int logFileBackups = 3;
 
 #ifdef HAVE_SYSLOG_H
 static SDL_LogOutputFunction _sdlCallback = nullptr;
@@ -63,6 +79,111 @@ static void sysLogOutputFunction(void *userdata, int category, SDL_LogPriority p
 }
 #endif
 
+static const char* colorForPriority(SDL_LogPriority priority) {
+	switch (priority) {
+	case SDL_LOG_PRIORITY_VERBOSE:
+	case SDL_LOG_PRIORITY_INFO:
+		return ANSI_COLOR_GREEN;
+	case SDL_LOG_PRIORITY_DEBUG:
+		return ANSI_COLOR_BLUE;
+	case SDL_LOG_PRIORITY_WARN:
+		return ANSI_COLOR_YELLOW;
+	default:
+		return ANSI_COLOR_RED;
+	}
+}
+
+static void logMessage(SDL_LogPriority priority, uint32_t id, const char *buf) {
+	if (_syslog) {
+		SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, priority, "(%u) %s\n", id, buf);
+	} else {
+		SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, priority, "(%u) %s%s" ANSI_COLOR_RESET "\n", id, colorForPriority(priority), buf);
+	}
+}
+
+static void rotateLogFile() {
+	if (_logFile != nullptr) {
+		fclose(_logFile);
+		_logFile = nullptr;
+	}
+	for (int i = logFileBackups - 1; i >= 1; --i) {
+		const core::String& from = core::string::format("%s.%i", _logFilePath.c_str(), i);
+		const core::String& to = core::string::format("%s.%i", _logFilePath.c_str(), i + 1);
+		rename(from.c_str(), to.c_str());
+	}
+	const core::String& backup = core::string::format("%s.1", _logFilePath.c_str());
+	rename(_logFilePath.c_str(), backup.c_str());
+	_logFile = fopen(_logFilePath.c_str(), "w");
+	_logFileSize = 0u;
+}
+
+static void closeLogFile() {
+	if (_logFile != nullptr) {
+		fclose(_logFile);
+		_logFile = nullptr;
+	}
+	_logFileSize = 0u;
+}
+
+static void setLogFilePath(const core::String& path) {
+	core::ScopedLock<core::Lock> lock(_logFileLock);
+	if (_logFilePath == path) {
+		return;
+	}
+	closeLogFile();
+	_logFilePath = path;
+}
+
+/**
+ * @brief Sink of the log queue - this is executed in the drain thread
+ */
+static void sinkMessage(int priority, uint32_t id, const char *message) {
+	core::ScopedLock<core::Lock> lock(_logFileLock);
+	if (_logFilePath.empty()) {
+		logMessage((SDL_LogPriority)priority, id, message);
+		return;
+	}
+	if (_logFile == nullptr || _logFileSize >= logFileMaxSize) {
+		rotateLogFile();
+		if (_logFile == nullptr) {
+			logMessage((SDL_LogPriority)priority, id, message);
+			return;
+		}
+	}
+	const int written = fprintf(_logFile, "%s: (%u) %s\n", Log::toLogLevel((Log::Level)priority), id, message);
+	if (written > 0) {
+		_logFileSize += (size_t)written;
+	}
+}
+
+static void logVA(SDL_LogPriority priority, uint32_t id, const char *msg, va_list args) {
+	core::LogQueue* queue = _logQueue.load(std::memory_order_acquire);
+	if (_logAsync && queue != nullptr) {
+		va_list queueArgs;
+		va_copy(queueArgs, args);
+		const bool queued = queue->push(priority, id, msg, queueArgs);
+		va_end(queueArgs);
+		// a full ring drops and counts the message - writing it here would break the order of the
+		// messages of this thread
+		if (queued || queue->isRunning()) {
+			va_end(args);
+			return;
+		}
+		// the queue was shut down while the message was logged
+		char buf[bufSize];
+		SDL_vsnprintf(buf, sizeof(buf), msg, args);
+		buf[sizeof(buf) - 1] = '\0';
+		sinkMessage(priority, id, buf);
+		va_end(args);
+		return;
+	}
+	char buf[bufSize];
+	SDL_vsnprintf(buf, sizeof(buf), msg, args);
+	buf[sizeof(buf) - 1] = '\0';
+	logMessage(priority, id, buf);
+	va_end(args);
+}
+
 Log::Level Log::toLogLevel(const char* level) {
 	const core::String string(level);
 	if (core::string::iequals(string, "trace")) {
@@ -133,11 +254,54 @@ void Log::init() {
 #endif
 		_syslog = false;
 	}
+
+	const bool async = core::Var::getSafe(cfg::CoreLogAsync)->boolVal();
+	if (async) {
+		setLogFilePath(core::Var::getSafe(cfg::CoreLogFile)->strVal());
+	}
+	if (async && !_logAsync) {
+		core::LogQueue* queue = _logQueue.load();
+		if (queue == nullptr) {
+			queue = new core::LogQueue(sinkMessage);
+			_logQueue.store(queue, std::memory_order_release);
+		}
+		queue->init();
+		_logAsync = true;
+	} else if (!async && _logAsync) {
+		// the queue is kept alive - other threads might still use it
+		_logAsync = false;
+		_logQueue.load()->flush();
+	}
+}
+
+void Log::flush() {
+	if (core::LogQueue* queue = _logQueue.load()) {
+		queue->flush();
+	}
+}
+
+uint64_t Log::dropped() {
+	core::LogQueue* queue = _logQueue.load();
+	if (queue == nullptr) {
+		return 0u;
+	}
+	return queue->dropped();
 }
 
 void Log::shutdown() {
 	// this is one of the last methods that is executed - so don't rely on anything
 	// still being available here - it won't
+	_logAsync = false;
+	if (core::LogQueue* queue = _logQueue.load()) {
+		// the queue is not deleted - another thread might just be about to push a message. The messages
+		// that are pushed after this are written synchronously.
+		queue->shutdown();
+		const uint64_t dropped = queue->dropped();
+		if (dropped > 0u) {
+			SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Dropped %u log messages", (unsigned int)dropped);
+		}
+	}
+	setLogFilePath("");
 #ifdef HAVE_SYSLOG_H
 	if (_syslog) {
 		SDL_LogSetOutputFunction(_sdlCallback, _sdlCallbackUserData);
@@ -151,73 +315,13 @@ void Log::shutdown() {
 	_syslog = false;
 }
 
-static void traceVA(uint32_t id, const char *msg, va_list args) {
-	char buf[bufSize];
-	SDL_vsnprintf(buf, sizeof(buf), msg, args);
-	buf[sizeof(buf) - 1] = '\0';
-	if (_syslog) {
-		SDL_LogVerbose(SDL_LOG_CATEGORY_APPLICATION, "(%u) %s\n", id, buf);
-	} else {
-		SDL_LogVerbose(SDL_LOG_CATEGORY_APPLICATION, "(%u) " ANSI_COLOR_GREEN "%s" ANSI_COLOR_RESET "\n", id, buf);
-	}
-	va_end(args);
-}
-
-static void debugVA(uint32_t id, const char *msg, va_list args) {
-	char buf[bufSize];
-	SDL_vsnprintf(buf, sizeof(buf), msg, args);
-	buf[sizeof(buf) - 1] = '\0';
-	if (_syslog) {
-		SDL_LogDebug(SDL_LOG_CATEGORY_APPLICATION, "(%u) %s\n", id, buf);
-	} else {
-		SDL_LogDebug(SDL_LOG_CATEGORY_APPLICATION, "(%u) " ANSI_COLOR_BLUE "%s" ANSI_COLOR_RESET "\n", id, buf);
-	}
-	va_end(args);
-}
-
-static void infoVA(uint32_t id, const char *msg, va_list args) {
-	char buf[bufSize];
-	SDL_vsnprintf(buf, sizeof(buf), msg, args);
-	buf[sizeof(buf) - 1] = '\0';
-	if (_syslog) {
-		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "(%u) %s\n", id, buf);
-	} else {
-		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "(%u) " ANSI_COLOR_GREEN "%s" ANSI_COLOR_RESET "\n", id, buf);
-	}
-	va_end(args);
-}
-
-static void warnVA(uint32_t id, const char *msg, va_list args) {
-	char buf[bufSize];
-	SDL_vsnprintf(buf, sizeof(buf), msg, args);
-	buf[sizeof(buf) - 1] = '\0';
-	if (_syslog) {
-		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "(%u) %s\n", id, buf);
-	} else {
-		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "(%u) " ANSI_COLOR_YELLOW "%s" ANSI_COLOR_RESET "\n", id, buf);
-	}
-	va_end(args);
-}
-
-static void errorVA(uint32_t id, const char *msg, va_list args) {
-	char buf[bufSize];
-	SDL_vsnprintf(buf, sizeof(buf), msg, args);
-	buf[sizeof(buf) - 1] = '\0';
-	if (_syslog) {
-		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "(%u) %s\n", id, buf);
-	} else {
-		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "(%u) " ANSI_COLOR_RED "%s" ANSI_COLOR_RESET "\n", id, buf);
-	}
-	va_end(args);
-}
-
 void Log::trace(const char* msg, ...) {
 	if (_logLevel > SDL_LOG_PRIORITY_VERBOSE) {
 		return;
 	}
 	va_list args;
 	va_start(args, msg);
-	traceVA(0u, msg, args);
+	logVA(SDL_LOG_PRIORITY_VERBOSE, 0u, msg, args);
 }
 
 void Log::debug(const char* msg, ...) {
@@ -226,7 +330,7 @@ void Log::debug(const char* msg, ...) {
 	}
 	va_list args;
 	va_start(args, msg);
-	debugVA(0u, msg, args);
+	logVA(SDL_LOG_PRIORITY_DEBUG, 0u, msg, args);
 }
 
 void Log::info(const char* msg, ...) {
@@ -235,7 +339,7 @@ void Log::info(const char* msg, ...) {
 	}
 	va_list args;
 	va_start(args, msg);
-	infoVA(0u, msg, args);
+	logVA(SDL_LOG_PRIORITY_INFO, 0u, msg, args);
 }
 
 void Log::warn(const char* msg, ...) {
@@ -244,7 +348,7 @@ void Log::warn(const char* msg, ...) {
 	}
 	va_list args;
 	va_start(args, msg);
-	warnVA(0u, msg, args);
+	logVA(SDL_LOG_PRIORITY_WARN, 0u, msg, args);
 }
 
 void Log::error(const char* msg, ...) {
@@ -253,7 +357,7 @@ void Log::error(const char* msg, ...) {
 	}
 	va_list args;
 	va_start(args, msg);
-	errorVA(0u, msg, args);
+	logVA(SDL_LOG_PRIORITY_ERROR, 0u, msg, args);
 }
 
 void Log::trace(uint32_t id, const char* msg, ...) {
@@ -268,7 +372,7 @@ void Log::trace(uint32_t id, const char* msg, ...) {
 	}
 	va_list args;
 	va_start(args, msg);
-	traceVA(id, msg, args);
+	logVA(SDL_LOG_PRIORITY_VERBOSE, id, msg, args);
 }
 
 void Log::debug(uint32_t id, const char* msg, ...) {
@@ -283,7 +387,7 @@ void Log::debug(uint32_t id, const char* msg, ...) {
 	}
 	va_list args;
 	va_start(args, msg);
-	debugVA(id, msg, args);
+	logVA(SDL_LOG_PRIORITY_DEBUG, id, msg, args);
 }
 
 void Log::info(uint32_t id, const char* msg, ...) {
@@ -298,7 +402,7 @@ void Log::info(uint32_t id, const char* msg, ...) {
 	}
 	va_list args;
 	va_start(args, msg);
-	infoVA(id, msg, args);
+	logVA(SDL_LOG_PRIORITY_INFO, id, msg, args);
 }
 
 void Log::warn(uint32_t id, const char* msg, ...) {
@@ -313,7 +417,7 @@ void Log::warn(uint32_t id, const char* msg, ...) {
 	}
 	va_list args;
 	va_start(args, msg);
-	warnVA(id, msg, args);
+	logVA(SDL_LOG_PRIORITY_WARN, id, msg, args);
 }
 
 void Log::error(uint32_t id, const char* msg, ...) {
@@ -328,7 +432,7 @@ void Log::error(uint32_t id, const char* msg, ...) {
 	}
 	va_list args;
 	va_start(args, msg);
-	errorVA(id, msg, args);
+	logVA(SDL_LOG_PRIORITY_ERROR, id, msg, args);
 }
 
 bool Log::enable(uint32_t id, Log::Level level) {
@@ -25,8 +25,22 @@ public:
 	static Level toLogLevel(const char* level);
 	static const char* toLogLevel(Level level);
 
+	/**
+	 * @brief Applies the log configuration
+	 * @note If @c core_logasync is enabled the messages are formatted into a ring buffer per thread
+	 * and written by a background thread - see core::LogQueue
+	 */
 	static void init();
 	static void shutdown();
+	/**
+	 * @brief Blocks until all asynchronously queued messages are written
+	 */
+	static void flush();
+	/**
+	 * @return The amount of asynchronous log messages that were dropped because the ring buffer
+	 * of the logging thread was full
+	 */
+	static uint64_t dropped();
 	static void trace(CORE_FORMAT_STRING const char* msg, ...) CORE_PRINTF_VARARG_FUNC(1);
 	static void debug(CORE_FORMAT_STRING const char* msg, ...) CORE_PRINTF_VARARG_FUNC(1);
 	static void info(CORE_FORMAT_STRING const char* msg, ...) CORE_PRINTF_VARARG_FUNC(1);
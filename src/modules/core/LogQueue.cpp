@@ -0,0 +1,290 @@
+/**
+ * @file
+ */
+
+#include "LogQueue.h"
+#include "core/Assert.h"
+#include "core/Common.h"
+#include "core/concurrent/Concurrency.h"
+#include <SDL_stdinc.h>
+#include <string.h>
+#include <algorithm>
+
+namespace core {
+
+namespace {
+
+// the max length of a single formatted record
+static constexpr int MaxMessageLength = 4096;
+// marks the unused space at the end of the ring buffer if a record didn't fit anymore
+static constexpr uint32_t WrapMarker = 0xFFFFFFFFu;
+
+struct RecordHeader {
+	// the size of the whole record - including the header and the padding
+	uint32_t size;
+	int32_t priority;
+	uint32_t id;
+	uint32_t length;
+};
+
+inline size_t alignRecord(size_t size) {
+	return (size + 7u) & ~(size_t)7u;
+}
+
+std::atomic<uint32_t> _queueIds { 0u };
+
+}
+
+/**
+ * @brief Single producer, single consumer ring buffer with variable sized records
+ */
+class LogQueue::Ring {
+private:
+	uint8_t* _buffer;
+	const size_t _capacity;
+	// monotonic write and read positions
+	std::atomic<size_t> _head { 0u };
+	std::atomic<size_t> _tail { 0u };
+	std::atomic<uint64_t> _dropped { 0u };
+	// set if the producer thread exited
+	std::atomic_bool _closed { false };
+
+	inline RecordHeader* header(size_t pos) const {
+		return (RecordHeader*)(_buffer + (pos & (_capacity - 1u)));
+	}
+public:
+	Ring(size_t capacity) :
+			_capacity(capacity) {
+		_buffer = (uint8_t*)SDL_malloc(_capacity);
+	}
+
+	~Ring() {
+		SDL_free(_buffer);
+	}
+
+	bool push(int priority, uint32_t id, const char *message, size_t length) {
+		const size_t need = alignRecord(sizeof(RecordHeader) + length + 1u);
+		size_t head = _head.load(std::memory_order_relaxed);
+		const size_t tail = _tail.load(std::memory_order_acquire);
+		size_t available = _capacity - (head - tail);
+		const size_t contiguous = _capacity - (head & (_capacity - 1u));
+		if (contiguous < need) {
+			// the record must be contiguous - skip the rest of the buffer
+			if (available < contiguous + need) {
+				_dropped.fetch_add(1u, std::memory_order_relaxed);
+				return false;
+			}
+			header(head)->size = WrapMarker;
+			head += contiguous;
+			available -= contiguous;
+		}
+		if (available < need) {
+			_dropped.fetch_add(1u, std::memory_order_relaxed);
+			return false;
+		}
+		RecordHeader* record = header(head);
+		record->size = (uint32_t)need;
+		record->priority = priority;
+		record->id = id;
+		record->length = (uint32_t)length;
+		char *text = (char*)(record + 1);
+		SDL_memcpy(text, message, length);
+		text[length] = '\0';
+		_head.store(head + need, std::memory_order_release);
+		return true;
+	}
+
+	template<class FUNC>
+	int consume(FUNC&& func) {
+		size_t tail = _tail.load(std::memory_order_relaxed);
+		const size_t head = _head.load(std::memory_order_acquire);
+		int n = 0;
+		while (tail != head) {
+			const RecordHeader* record = header(tail);
+			if (record->size == WrapMarker) {
+				tail += _capacity - (tail & (_capacity - 1u));
+				continue;
+			}
+			func(record->priority, record->id, (const char*)(record + 1));
+			tail += record->size;
+			++n;
+		}
+		_tail.store(tail, std::memory_order_release);
+		return n;
+	}
+
+	inline bool empty() const {
+		return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+	}
+
+	inline uint64_t dropped() const {
+		return _dropped.load(std::memory_order_relaxed);
+	}
+
+	inline void close() {
+		_closed = true;
+	}
+
+	inline bool closed() const {
+		return _closed;
+	}
+};
+
+namespace {
+
+/**
+ * @brief The rings of the current thread - one for each queue the thread has written to
+ */
+struct ThreadRings {
+	std::vector<std::pair<uint32_t, std::shared_ptr<void>>> rings;
+	std::vector<std::function<void()>> onExit;
+
+	~ThreadRings() {
+		for (const std::function<void()>& func : onExit) {
+			func();
+		}
+	}
+};
+
+thread_local ThreadRings _threadRings;
+
+}
+
+LogQueue::LogQueue(const Sink& sink, size_t ringSize) :
+		_sink(sink), _ringSize(ringSize), _queueId(_queueIds.fetch_add(1u) + 1u) {
+}
+
+LogQueue::~LogQueue() {
+	shutdown();
+}
+
+bool LogQueue::init() {
+	if (_running) {
+		return true;
+	}
+	_running = true;
+	_thread = std::thread([this] () {
+		run();
+	});
+	return true;
+}
+
+void LogQueue::shutdown() {
+	if (!_running.exchange(false)) {
+		return;
+	}
+	{
+		core::ScopedLock<core::Lock> lock(_drainLock);
+		_drainCondition.notify_one();
+	}
+	_thread.join();
+	// the producers might have added records after the drain thread stopped
+	drain();
+	core::ScopedLock<core::Lock> lock(_drainLock);
+	_flushed = _flushRequests;
+	_flushedCondition.notify_all();
+}
+
+LogQueue::Ring* LogQueue::threadRing() {
+	for (const auto& e : _threadRings.rings) {
+		if (e.first == _queueId) {
+			return (Ring*)e.second.get();
+		}
+	}
+	size_t capacity = 1u;
+	while (capacity < _ringSize) {
+		capacity <<= 1;
+	}
+	RingPtr ring = std::make_shared<Ring>(capacity);
+	{
+		core::ScopedLock<core::Lock> lock(_ringsLock);
+		_rings.push_back(ring);
+	}
+	_threadRings.rings.emplace_back(_queueId, ring);
+	// the queue keeps the ring alive until all records are consumed
+	std::weak_ptr<Ring> weak = ring;
+	_threadRings.onExit.emplace_back([weak] () {
+		if (RingPtr r = weak.lock()) {
+			r->close();
+		}
+	});
+	return ring.get();
+}
+
+bool LogQueue::push(int priority, uint32_t id, const char *msg, va_list args) {
+	if (!_running) {
+		return false;
+	}
+	char buf[MaxMessageLength];
+	const int written = SDL_vsnprintf(buf, sizeof(buf), msg, args);
+	if (written < 0) {
+		return false;
+	}
+	const size_t length = core_min((size_t)written, sizeof(buf) - 1u);
+	return threadRing()->push(priority, id, buf, length);
+}
+
+int LogQueue::drain() {
+	core_trace_scoped(LogQueueDrain);
+	{
+		core::ScopedLock<core::Lock> lock(_ringsLock);
+		_drainRings = _rings;
+	}
+	int n = 0;
+	for (const RingPtr& ring : _drainRings) {
+		n += ring->consume([this] (int priority, uint32_t id, const char *message) {
+			_sink(priority, id, message);
+		});
+		// the producer thread is gone and everything was consumed
+		if (ring->closed() && ring->empty()) {
+			core::ScopedLock<core::Lock> lock(_ringsLock);
+			auto i = std::find(_rings.begin(), _rings.end(), ring);
+			if (i != _rings.end()) {
+				_droppedRemovedRings += ring->dropped();
+				_rings.erase(i);
+			}
+		}
+	}
+	_drainRings.clear();
+	return n;
+}
+
+void LogQueue::run() {
+	core::setThreadName("logqueue");
+	while (_running) {
+		const uint64_t flushRequests = _flushRequests;
+		const int n = drain();
+		core::ScopedLock<core::Lock> lock(_drainLock);
+		// everything that was pushed before the flush requests is consumed now
+		if (_flushed < flushRequests) {
+			_flushed = flushRequests;
+			_flushedCondition.notify_all();
+		}
+		if (n == 0 && _running && _flushRequests == flushRequests) {
+			_drainCondition.waitTimeout(_drainLock, 5);
+		}
+	}
+}
+
+void LogQueue::flush() {
+	if (!_running) {
+		return;
+	}
+	core::ScopedLock<core::Lock> lock(_drainLock);
+	const uint64_t request = ++_flushRequests;
+	_drainCondition.notify_one();
+	while (_running && _flushed < request) {
+		_flushedCondition.waitTimeout(_drainLock, 100);
+	}
+}
+
+uint64_t LogQueue::dropped() const {
+	uint64_t n = _droppedRemovedRings;
+	core::ScopedLock<core::Lock> lock(_ringsLock);
+	for (const RingPtr& ring : _rings) {
+		n += ring->dropped();
+	}
+	return n;
+}
+
+}
@@ -0,0 +1,111 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/Trace.h"
+#include <stdint.h>
+#include <stdarg.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace core {
+
+/**
+ * @brief Asynchronous log record queue
+ *
+ * Each producer thread formats its records into its own lock free single producer/single consumer
+ * ring buffer. A drain thread collects the records of all rings and hands them to the sink. The
+ * order of the records of one thread is kept - there is no order between the records of different
+ * threads.
+ *
+ * If a ring buffer is full the record is dropped and counted (see dropped()). The producer never
+ * blocks.
+ */
+class LogQueue {
+public:
+	/**
+	 * @brief Called from the drain thread for each record
+	 * @param priority The @c SDL_LogPriority of the record
+	 * @param id The log id of the record - @c 0 if there is no id
+	 * @param message The formatted null terminated message
+	 */
+	using Sink = std::function<void(int priority, uint32_t id, const char *message)>;
+
+private:
+	class Ring;
+	using RingPtr = std::shared_ptr<Ring>;
+
+	const Sink _sink;
+	const size_t _ringSize;
+	// unique id of the queue - used to find the ring of the calling thread
+	const uint32_t _queueId;
+
+	core_trace_mutex(core::Lock, _ringsLock, "LogQueueRings");
+	std::vector<RingPtr> _rings;
+	// only used by the drain thread - reused to not allocate memory for each drain
+	std::vector<RingPtr> _drainRings;
+
+	core_trace_mutex(core::Lock, _drainLock, "LogQueueDrain");
+	core::ConditionVariable _drainCondition;
+	core::ConditionVariable _flushedCondition;
+	std::thread _thread;
+	std::atomic_bool _running { false };
+	std::atomic<uint64_t> _flushRequests { 0u };
+	uint64_t _flushed = 0u;
+	// the dropped records of rings that were already removed
+	std::atomic<uint64_t> _droppedRemovedRings { 0u };
+
+	Ring* threadRing();
+	/**
+	 * @return The amount of records that were handed to the sink
+	 */
+	int drain();
+	void run();
+
+public:
+	/**
+	 * @param[in] ringSize The size of the ring buffer of each producer thread in bytes
+	 */
+	LogQueue(const Sink& sink, size_t ringSize = 64u * 1024u);
+	~LogQueue();
+
+	/**
+	 * @brief Starts the drain thread
+	 */
+	bool init();
+	/**
+	 * @brief Sinks all the remaining records and stops the drain thread
+	 */
+	void shutdown();
+
+	/**
+	 * @brief Formats the message into the ring buffer of the calling thread
+	 * @return @c false if the record was dropped because the ring buffer is full or the queue
+	 * is not running
+	 */
+	bool push(int priority, uint32_t id, const char *msg, va_list args);
+
+	/**
+	 * @brief Blocks until all records that were pushed before this call are handed to the sink
+	 * @note Must not be called from within the sink
+	 */
+	void flush();
+
+	/**
+	 * @return The amount of records that were dropped because the ring buffers were full
+	 */
+	uint64_t dropped() const;
+
+	inline bool isRunning() const {
+		return _running;
+	}
+};
+
+}
@@ -0,0 +1,305 @@
+/**
+ * @file
+ */
+
+#include "OffsetAllocator.h"
+#include "core/Common.h"
+
+namespace core {
+
+namespace {
+
+inline uint32_t countTrailingZeros(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+	return (uint32_t)__builtin_ctz(mask);
+#else
+	uint32_t n = 0u;
+	while ((mask & 1u) == 0u) {
+		mask >>= 1;
+		++n;
+	}
+	return n;
+#endif
+}
+
+inline uint32_t mostSignificantBit(uint32_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+	return 31u - (uint32_t)__builtin_clz(value);
+#else
+	uint32_t n = 0u;
+	while (value >>= 1) {
+		++n;
+	}
+	return n;
+#endif
+}
+
+}
+
+OffsetAllocator::OffsetAllocator(uint32_t capacity) {
+	reset(capacity);
+}
+
+void OffsetAllocator::reset(uint32_t capacity) {
+	_capacity = capacity;
+	_used = 0u;
+	_allocations = 0u;
+	_nodes.clear();
+	_unusedNodes.clear();
+	for (uint32_t& head : _binHeads) {
+		head = InvalidIndex;
+	}
+	_firstLevelMask = 0u;
+	for (uint8_t& mask : _secondLevelMask) {
+		mask = 0u;
+	}
+	if (capacity > 0u) {
+		insertFree(createNode(0u, capacity));
+	}
+}
+
+uint32_t OffsetAllocator::binIndex(uint32_t size) {
+	core_assert(size > 0u);
+	if (size < SecondLevelBins) {
+		return size;
+	}
+	const uint32_t msb = mostSignificantBit(size);
+	const uint32_t firstLevel = msb - SecondLevelBits + 1u;
+	const uint32_t secondLevel = (size >> (msb - SecondLevelBits)) & (SecondLevelBins - 1u);
+	return firstLevel * SecondLevelBins + secondLevel;
+}
+
+uint32_t OffsetAllocator::binIndexRoundUp(uint32_t size) {
+	if (size < SecondLevelBins) {
+		return size;
+	}
+	// every region in the returned bin is at least of the given size
+	const uint32_t msb = mostSignificantBit(size);
+	const uint64_t rounded = (uint64_t)size + (1u << (msb - SecondLevelBits)) - 1u;
+	if (rounded > 0xFFFFFFFFu) {
+		return Bins;
+	}
+	return binIndex((uint32_t)rounded);
+}
+
+uint32_t OffsetAllocator::findFreeBin(uint32_t minBin) const {
+	if (minBin >= Bins) {
+		return InvalidIndex;
+	}
+	uint32_t firstLevel = minBin / SecondLevelBins;
+	const uint32_t secondLevel = minBin % SecondLevelBins;
+	const uint32_t secondLevelMask = _secondLevelMask[firstLevel] & (0xFFu << secondLevel);
+	if (secondLevelMask != 0u) {
+		return firstLevel * SecondLevelBins + countTrailingZeros(secondLevelMask);
+	}
+	if (firstLevel + 1u >= FirstLevelBins) {
+		return InvalidIndex;
+	}
+	const uint32_t firstLevelMask = _firstLevelMask & (0xFFFFFFFFu << (firstLevel + 1u));
+	if (firstLevelMask == 0u) {
+		return InvalidIndex;
+	}
+	firstLevel = countTrailingZeros(firstLevelMask);
+	return firstLevel * SecondLevelBins + countTrailingZeros(_secondLevelMask[firstLevel]);
+}
+
+uint32_t OffsetAllocator::createNode(uint32_t offset, uint32_t size) {
+	uint32_t index;
+	if (_unusedNodes.empty()) {
+		index = (uint32_t)_nodes.size();
+		_nodes.emplace_back();
+	} else {
+		index = _unusedNodes.back();
+		_unusedNodes.pop_back();
+	}
+	Node& node = _nodes[index];
+	node = Node();
+	node.offset = offset;
+	node.size = size;
+	return index;
+}
+
+void OffsetAllocator::releaseNode(uint32_t index) {
+	_nodes[index].state = NodeState::Unused;
+	_unusedNodes.push_back(index);
+}
+
+void OffsetAllocator::insertFree(uint32_t index) {
+	Node& node = _nodes[index];
+	const uint32_t bin = binIndex(node.size);
+	node.state = NodeState::Free;
+	node.bin = bin;
+	node.binPrev = InvalidIndex;
+	node.binNext = _binHeads[bin];
+	if (node.binNext != InvalidIndex) {
+		_nodes[node.binNext].binPrev = index;
+	}
+	_binHeads[bin] = index;
+	const uint32_t firstLevel = bin / SecondLevelBins;
+	_secondLevelMask[firstLevel] |= (uint8_t)(1u << (bin % SecondLevelBins));
+	_firstLevelMask |= 1u << firstLevel;
+}
+
+void OffsetAllocator::removeFree(uint32_t index) {
+	Node& node = _nodes[index];
+	core_assert(node.state == NodeState::Free);
+	if (node.binPrev != InvalidIndex) {
+		_nodes[node.binPrev].binNext = node.binNext;
+	} else {
+		_binHeads[node.bin] = node.binNext;
+	}
+	if (node.binNext != InvalidIndex) {
+		_nodes[node.binNext].binPrev = node.binPrev;
+	}
+	if (_binHeads[node.bin] == InvalidIndex) {
+		const uint32_t firstLevel = node.bin / SecondLevelBins;
+		_secondLevelMask[firstLevel] &= (uint8_t)~(1u << (node.bin % SecondLevelBins));
+		if (_secondLevelMask[firstLevel] == 0u) {
+			_firstLevelMask &= ~(1u << firstLevel);
+		}
+	}
+	node.binPrev = InvalidIndex;
+	node.binNext = InvalidIndex;
+	node.bin = InvalidIndex;
+}
+
+OffsetAllocator::Handle OffsetAllocator::allocate(uint32_t size) {
+	if (size == 0u || size > freeSpace()) {
+		return InvalidHandle;
+	}
+	uint32_t index = InvalidIndex;
+	const uint32_t bin = findFreeBin(binIndexRoundUp(size));
+	if (bin != InvalidIndex) {
+		index = _binHeads[bin];
+	} else {
+		// the bin of the requested size might still contain a region that is large enough
+		for (uint32_t i = _binHeads[binIndex(size)]; i != InvalidIndex; i = _nodes[i].binNext) {
+			if (_nodes[i].size >= size) {
+				index = i;
+				break;
+			}
+		}
+		if (index == InvalidIndex) {
+			return InvalidHandle;
+		}
+	}
+	removeFree(index);
+	Node& node = _nodes[index];
+	core_assert(node.size >= size);
+	if (node.size > size) {
+		// put the rest back into the free lists
+		const uint32_t remaining = node.size - size;
+		const uint32_t offset = node.offset + size;
+		const uint32_t neighborNext = node.neighborNext;
+		node.size = size;
+		// the node reference might get invalid here
+		const uint32_t restIndex = createNode(offset, remaining);
+		Node& rest = _nodes[restIndex];
+		rest.neighborPrev = index;
+		rest.neighborNext = neighborNext;
+		if (neighborNext != InvalidIndex) {
+			_nodes[neighborNext].neighborPrev = restIndex;
+		}
+		_nodes[index].neighborNext = restIndex;
+		insertFree(restIndex);
+	}
+	_nodes[index].state = NodeState::Allocated;
+	_used += size;
+	++_allocations;
+	return (Handle)index;
+}
+
+void OffsetAllocator::free(Handle handle) {
+	if (!valid(handle)) {
+		core_assert_msg(handle == InvalidHandle, "Invalid handle %u given", handle);
+		return;
+	}
+	const uint32_t index = handle;
+	_used -= _nodes[index].size;
+	--_allocations;
+
+	const uint32_t prevIndex = _nodes[index].neighborPrev;
+	if (prevIndex != InvalidIndex && _nodes[prevIndex].state == NodeState::Free) {
+		removeFree(prevIndex);
+		Node& node = _nodes[index];
+		const Node& prev = _nodes[prevIndex];
+		node.offset = prev.offset;
+		node.size += prev.size;
+		node.neighborPrev = prev.neighborPrev;
+		if (node.neighborPrev != InvalidIndex) {
+			_nodes[node.neighborPrev].neighborNext = index;
+		}
+		releaseNode(prevIndex);
+	}
+	const uint32_t nextIndex = _nodes[index].neighborNext;
+	if (nextIndex != InvalidIndex && _nodes[nextIndex].state == NodeState::Free) {
+		removeFree(nextIndex);
+		Node& node = _nodes[index];
+		const Node& next = _nodes[nextIndex];
+		node.size += next.size;
+		node.neighborNext = next.neighborNext;
+		if (node.neighborNext != InvalidIndex) {
+			_nodes[node.neighborNext].neighborPrev = index;
+		}
+		releaseNode(nextIndex);
+	}
+	insertFree(index);
+}
+
+uint32_t OffsetAllocator::lastNode() const {
+	for (uint32_t i = 0u; i < (uint32_t)_nodes.size(); ++i) {
+		const Node& node = _nodes[i];
+		if (node.state != NodeState::Unused && node.neighborNext == InvalidIndex) {
+			return i;
+		}
+	}
+	return InvalidIndex;
+}
+
+bool OffsetAllocator::grow(uint32_t capacity) {
+	if (capacity < _capacity) {
+		return false;
+	}
+	if (capacity == _capacity) {
+		return true;
+	}
+	const uint32_t added = capacity - _capacity;
+	const uint32_t last = lastNode();
+	if (last != InvalidIndex && _nodes[last].state == NodeState::Free) {
+		removeFree(last);
+		_nodes[last].size += added;
+		insertFree(last);
+	} else {
+		const uint32_t index = createNode(_capacity, added);
+		_nodes[index].neighborPrev = last;
+		if (last != InvalidIndex) {
+			_nodes[last].neighborNext = index;
+		}
+		insertFree(index);
+	}
+	_capacity = capacity;
+	return true;
+}
+
+uint32_t OffsetAllocator::largestFreeRegion() const {
+	if (_firstLevelMask == 0u) {
+		return 0u;
+	}
+	const uint32_t firstLevel = mostSignificantBit(_firstLevelMask);
+	const uint32_t bin = firstLevel * SecondLevelBins + mostSignificantBit(_secondLevelMask[firstLevel]);
+	uint32_t largest = 0u;
+	for (uint32_t index = _binHeads[bin]; index != InvalidIndex; index = _nodes[index].binNext) {
+		largest = core_max(largest, _nodes[index].size);
+	}
+	return largest;
+}
+
+float OffsetAllocator::fragmentation() const {
+	const uint32_t free = freeSpace();
+	if (free == 0u) {
+		return 0.0f;
+	}
+	return 1.0f - (float)largestFreeRegion() / (float)free;
+}
+
+}
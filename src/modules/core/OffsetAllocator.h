@@ -0,0 +1,218 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Assert.h"
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+
+namespace core {
+
+/**
+ * @brief Manages ranges inside of a linear address space without touching any memory
+ *
+ * This is meant to sub allocate regions of large buffers that live somewhere else - e.g. gpu buffers. The free
+ * regions are kept in two level segregated free lists (TLSF) - allocating and freeing a range is O(1). Only if
+ * no bin with regions that are guaranteed to be large enough exists, the bin of the requested size is searched.
+ * Adjacent free regions are merged when a range is freed.
+ *
+ * The unit of the offsets and sizes is up to the caller (bytes, vertices, ...).
+ *
+ * @note The allocations are identified by handles that stay valid until the allocation is freed - the offset of
+ * an allocation only changes if the allocator is defragmented.
+ */
+class OffsetAllocator {
+public:
+	using Handle = uint32_t;
+	static constexpr Handle InvalidHandle = 0xFFFFFFFFu;
+private:
+	static constexpr uint32_t InvalidIndex = 0xFFFFFFFFu;
+	// the amount of second level bins per first level bin
+	static constexpr uint32_t SecondLevelBits = 3u;
+	static constexpr uint32_t SecondLevelBins = 1u << SecondLevelBits;
+	static constexpr uint32_t FirstLevelBins = 32u - SecondLevelBits + 1u;
+	static constexpr uint32_t Bins = FirstLevelBins * SecondLevelBins;
+
+	enum class NodeState : uint8_t {
+		// the node is not part of the address space
+		Unused,
+		Free,
+		Allocated
+	};
+
+	struct Node {
+		uint32_t offset = 0u;
+		uint32_t size = 0u;
+		// the nodes in the same bin
+		uint32_t binPrev = InvalidIndex;
+		uint32_t binNext = InvalidIndex;
+		// the nodes that are next to this one in the address space
+		uint32_t neighborPrev = InvalidIndex;
+		uint32_t neighborNext = InvalidIndex;
+		uint32_t bin = InvalidIndex;
+		NodeState state = NodeState::Unused;
+	};
+
+	std::vector<Node> _nodes;
+	std::vector<uint32_t> _unusedNodes;
+	uint32_t _binHeads[Bins];
+	uint32_t _firstLevelMask = 0u;
+	uint8_t _secondLevelMask[FirstLevelBins];
+
+	uint32_t _capacity;
+	uint32_t _used = 0u;
+	uint32_t _allocations = 0u;
+
+	static uint32_t binIndex(uint32_t size);
+	static uint32_t binIndexRoundUp(uint32_t size);
+	uint32_t findFreeBin(uint32_t minBin) const;
+
+	uint32_t createNode(uint32_t offset, uint32_t size);
+	void releaseNode(uint32_t index);
+	void insertFree(uint32_t index);
+	void removeFree(uint32_t index);
+	// the node at the end of the address space
+	uint32_t lastNode() const;
+public:
+	/**
+	 * @param capacity The size of the managed address space
+	 */
+	OffsetAllocator(uint32_t capacity = 0u);
+
+	/**
+	 * @brief Frees all allocations. Handles that were handed out before are invalid afterwards.
+	 */
+	void reset(uint32_t capacity);
+
+	/**
+	 * @return @c InvalidHandle if there is no free region that is large enough. A free region might still be
+	 * found after calling @c defragment() if @c freeSpace() is large enough.
+	 */
+	Handle allocate(uint32_t size);
+	void free(Handle handle);
+
+	/**
+	 * @brief Extends the address space at the end. Shrinking is not supported.
+	 */
+	bool grow(uint32_t capacity);
+
+	/**
+	 * @brief Moves all allocations to the start of the address space - there is only one free region afterwards.
+	 *
+	 * @param func Called with the handle, the old offset, the new offset and the size for every allocation in
+	 * ascending offset order - the new offset is never bigger than the old one. Allocations that don't move
+	 * are reported, too - this allows the caller to copy the whole content into a new buffer.
+	 * @return The amount of allocations that were moved
+	 */
+	template<class FUNC>
+	uint32_t defragment(FUNC&& func);
+
+	bool valid(Handle handle) const;
+	uint32_t offset(Handle handle) const;
+	uint32_t size(Handle handle) const;
+
+	uint32_t capacity() const;
+	/**
+	 * @return The sum of the sizes of all allocations
+	 */
+	uint32_t used() const;
+	uint32_t freeSpace() const;
+	uint32_t allocations() const;
+	/**
+	 * @return The size of the biggest free region
+	 */
+	uint32_t largestFreeRegion() const;
+	/**
+	 * @return @c 0.0 if all the free space is one region, values towards @c 1.0 mean that the free space is
+	 * split into many small regions
+	 */
+	float fragmentation() const;
+};
+
+template<class FUNC>
+uint32_t OffsetAllocator::defragment(FUNC&& func) {
+	std::vector<uint32_t> allocated;
+	allocated.reserve(_allocations);
+	for (uint32_t i = 0u; i < (uint32_t)_nodes.size(); ++i) {
+		Node& node = _nodes[i];
+		if (node.state == NodeState::Free) {
+			releaseNode(i);
+		} else if (node.state == NodeState::Allocated) {
+			allocated.push_back(i);
+		}
+	}
+	std::sort(allocated.begin(), allocated.end(), [this] (uint32_t lhs, uint32_t rhs) {
+		return _nodes[lhs].offset < _nodes[rhs].offset;
+	});
+	for (uint32_t& head : _binHeads) {
+		head = InvalidIndex;
+	}
+	_firstLevelMask = 0u;
+	for (uint8_t& mask : _secondLevelMask) {
+		mask = 0u;
+	}
+
+	uint32_t moved = 0u;
+	uint32_t offset = 0u;
+	uint32_t prev = InvalidIndex;
+	for (uint32_t index : allocated) {
+		Node& node = _nodes[index];
+		core_assert(node.offset >= offset);
+		if (node.offset != offset) {
+			++moved;
+		}
+		func((Handle)index, node.offset, offset, node.size);
+		node.offset = offset;
+		node.neighborPrev = prev;
+		node.neighborNext = InvalidIndex;
+		if (prev != InvalidIndex) {
+			_nodes[prev].neighborNext = index;
+		}
+		prev = index;
+		offset += node.size;
+	}
+	if (offset < _capacity) {
+		const uint32_t freeIndex = createNode(offset, _capacity - offset);
+		_nodes[freeIndex].neighborPrev = prev;
+		if (prev != InvalidIndex) {
+			_nodes[prev].neighborNext = freeIndex;
+		}
+		insertFree(freeIndex);
+	}
+	return moved;
+}
+
+inline bool OffsetAllocator::valid(Handle handle) const {
+	return handle < (Handle)_nodes.size() && _nodes[handle].state == NodeState::Allocated;
+}
+
+inline uint32_t OffsetAllocator::offset(Handle handle) const {
+	core_assert(valid(handle));
+	return _nodes[handle].offset;
+}
+
+inline uint32_t OffsetAllocator::size(Handle handle) const {
+	core_assert(valid(handle));
+	return _nodes[handle].size;
+}
+
+inline uint32_t OffsetAllocator::capacity() const {
+	return _capacity;
+}
+
+inline uint32_t OffsetAllocator::used() const {
+	return _used;
+}
+
+inline uint32_t OffsetAllocator::freeSpace() const {
+	return _capacity - _used;
+}
+
+inline uint32_t OffsetAllocator::allocations() const {
+	return _allocations;
+}
+
+}
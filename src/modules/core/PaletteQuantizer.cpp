@@ -0,0 +1,179 @@
+/**
+ * @file
+ */
+
+#include "PaletteQuantizer.h"
+#include "core/Color.h"
+#include "core/Trace.h"
+#include <float.h>
+#include <math.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace core {
+
+namespace {
+
+// the weights of core::Color::getDistance()
+const float WeightHue = 0.8f;
+const float WeightSaturation = 0.1f;
+const float WeightValue = 0.1f;
+
+/**
+ * @return The 24 bit rgb value if the color channels are exactly 8 bit values that were converted
+ * by @c core::Color::fromRGBA() - otherwise @c -1
+ */
+inline int64_t rgb8(const glm::vec4& color) {
+	int64_t rgb = 0;
+	for (int i = 0; i < 3; ++i) {
+		const float c = color[i];
+		if (!(c >= 0.0f && c <= 1.0f)) {
+			return -1;
+		}
+		const int v = (int)(c * Color::magnitudef + 0.5f);
+		if (static_cast<float>(v) / Color::magnitudef != c) {
+			return -1;
+		}
+		rgb |= (int64_t)v << (i * 8);
+	}
+	return rgb;
+}
+
+inline uint32_t cacheSlot(uint32_t rgb) {
+	return (rgb * 2654435761u) >> (32 - 14);
+}
+
+static_assert(PaletteQuantizer::CacheSize == (1u << 14), "Cache slot computation doesn't match the cache size");
+
+}
+
+PaletteQuantizer::PaletteQuantizer() : _cache(new std::atomic<uint64_t>[CacheSize]) {
+	clearCache();
+}
+
+void PaletteQuantizer::clearCache() {
+	for (uint32_t i = 0u; i < CacheSize; ++i) {
+		_cache[i].store(0u, std::memory_order_relaxed);
+	}
+}
+
+void PaletteQuantizer::setPalette(const glm::vec4* colors, int size) {
+	_size = size;
+	const size_t padded = (size_t)((size + 3) & ~3);
+	// padding entries get a distance of NaN - that never compares less than the current minimum
+	_hue.assign(padded, NAN);
+	_saturation.assign(padded, NAN);
+	_brightness.assign(padded, NAN);
+	for (int i = 0; i < size; ++i) {
+		Color::getHSB(colors[i], _hue[i], _saturation[i], _brightness[i]);
+	}
+	clearCache();
+}
+
+// The distances must be bit identical to the ones of core::Color::getDistance(). The squares are computed
+// in double precision there (glm::pow(float, int) resolves to the double overload), the sum is truncated to
+// float afterwards. So the SIMD version computes the differences in float and the rest in double, too.
+int PaletteQuantizer::closestIndex(float hue, float saturation, float brightness) const {
+	int minIndex = -1;
+#if defined(__SSE2__)
+	const __m128 h = _mm_set1_ps(hue);
+	const __m128 s = _mm_set1_ps(saturation);
+	const __m128 b = _mm_set1_ps(brightness);
+	const __m128d weightHue = _mm_set1_pd((double)WeightHue);
+	const __m128d weightSaturation = _mm_set1_pd((double)WeightSaturation);
+	const __m128d weightValue = _mm_set1_pd((double)WeightValue);
+	__m128 minDistances = _mm_set1_ps(FLT_MAX);
+	__m128i minIndices = _mm_set1_epi32(-1);
+	__m128i indices = _mm_set_epi32(3, 2, 1, 0);
+	const __m128i four = _mm_set1_epi32(4);
+	const int padded = (int)_hue.size();
+	for (int i = 0; i < padded; i += 4) {
+		const __m128 dH = _mm_sub_ps(_mm_loadu_ps(&_hue[i]), h);
+		const __m128 dS = _mm_sub_ps(_mm_loadu_ps(&_saturation[i]), s);
+		const __m128 dV = _mm_sub_ps(_mm_loadu_ps(&_brightness[i]), b);
+		__m128d dist[2];
+		for (int half = 0; half < 2; ++half) {
+			const __m128d dHd = _mm_cvtps_pd(half == 0 ? dH : _mm_movehl_ps(dH, dH));
+			const __m128d dSd = _mm_cvtps_pd(half == 0 ? dS : _mm_movehl_ps(dS, dS));
+			const __m128d dVd = _mm_cvtps_pd(half == 0 ? dV : _mm_movehl_ps(dV, dV));
+			// same order as in core::Color::getDistance(): hue + value + saturation
+			__m128d val = _mm_mul_pd(weightHue, _mm_mul_pd(dHd, dHd));
+			val = _mm_add_pd(val, _mm_mul_pd(weightValue, _mm_mul_pd(dVd, dVd)));
+			val = _mm_add_pd(val, _mm_mul_pd(weightSaturation, _mm_mul_pd(dSd, dSd)));
+			dist[half] = val;
+		}
+		const __m128 distances = _mm_movelh_ps(_mm_cvtpd_ps(dist[0]), _mm_cvtpd_ps(dist[1]));
+		// every lane keeps the first index with the smallest distance
+		const __m128 less = _mm_cmplt_ps(distances, minDistances);
+		const __m128i lessi = _mm_castps_si128(less);
+		minDistances = _mm_or_ps(_mm_and_ps(less, distances), _mm_andnot_ps(less, minDistances));
+		minIndices = _mm_or_si128(_mm_and_si128(lessi, indices), _mm_andnot_si128(lessi, minIndices));
+		indices = _mm_add_epi32(indices, four);
+	}
+	alignas(16) float laneDistances[4];
+	alignas(16) int32_t laneIndices[4];
+	_mm_store_ps(laneDistances, minDistances);
+	_mm_store_si128((__m128i*)laneIndices, minIndices);
+	float minDistance = FLT_MAX;
+	for (int lane = 0; lane < 4; ++lane) {
+		if (laneIndices[lane] == -1) {
+			continue;
+		}
+		// the smallest index wins for equal distances - like the linear search
+		if (laneDistances[lane] < minDistance || (laneDistances[lane] == minDistance && laneIndices[lane] < minIndex)) {
+			minDistance = laneDistances[lane];
+			minIndex = laneIndices[lane];
+		}
+	}
+#else
+	float minDistance = FLT_MAX;
+	for (int i = 0; i < _size; ++i) {
+		const float dH = _hue[i] - hue;
+		const float dS = _saturation[i] - saturation;
+		const float dV = _brightness[i] - brightness;
+		const float val = (float)((double)WeightHue * ((double)dH * dH) + (double)WeightValue * ((double)dV * dV)
+				+ (double)WeightSaturation * ((double)dS * dS));
+		if (val < minDistance) {
+			minDistance = val;
+			minIndex = i;
+		}
+	}
+#endif
+	return minIndex;
+}
+
+int PaletteQuantizer::getClosestMatch(const glm::vec4& color) const {
+	if (_size == 0) {
+		return -1;
+	}
+	const int64_t rgb = rgb8(color);
+	uint32_t slot = 0u;
+	uint64_t key = 0u;
+	if (rgb != -1) {
+		slot = cacheSlot((uint32_t)rgb);
+		key = (uint64_t)(rgb | (1 << 24)) << 32;
+		const uint64_t entry = _cache[slot].load(std::memory_order_relaxed);
+		if ((entry & 0xFFFFFFFF00000000ull) == key) {
+			return (int)(int32_t)(uint32_t)entry;
+		}
+	}
+	float hue;
+	float saturation;
+	float brightness;
+	Color::getHSB(color, hue, saturation, brightness);
+	const int index = closestIndex(hue, saturation, brightness);
+	if (rgb != -1) {
+		_cache[slot].store(key | (uint32_t)index, std::memory_order_relaxed);
+	}
+	return index;
+}
+
+void PaletteQuantizer::getClosestMatches(const glm::vec4* colors, int amount, int* indices) const {
+	core_trace_scoped(PaletteQuantizerClosestMatches);
+	for (int i = 0; i < amount; ++i) {
+		indices[i] = getClosestMatch(colors[i]);
+	}
+}
+
+}
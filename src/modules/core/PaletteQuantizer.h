@@ -0,0 +1,84 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/NonCopyable.h"
+#include <glm/vec4.hpp>
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+namespace core {
+
+/**
+ * @brief Maps colors onto the closest entry of a palette
+ *
+ * This gives the same results as @c core::Color::getClosestMatch() - but the hue, saturation and brightness
+ * values of the palette entries are only computed once, the distances are computed for several palette
+ * entries at once and the results for 8 bit colors (like they are read by the importers) are cached.
+ *
+ * @note The lookups are thread safe - changing the palette is not.
+ */
+class PaletteQuantizer : public NonCopyable {
+public:
+	/**
+	 * @brief Amount of slots in the direct mapped cache for 8 bit colors
+	 */
+	static constexpr uint32_t CacheSize = 1u << 14;
+
+private:
+	// structure of arrays - the size is a multiple of 4, padding entries never match
+	std::vector<float> _hue;
+	std::vector<float> _saturation;
+	std::vector<float> _brightness;
+	int _size = 0;
+	// the key is the 24 bit rgb value with bit 24 set as valid marker, the value is the palette index
+	std::unique_ptr<std::atomic<uint64_t>[]> _cache;
+
+	int closestIndex(float hue, float saturation, float brightness) const;
+
+public:
+	PaletteQuantizer();
+
+	template<class T>
+	explicit PaletteQuantizer(const T& colors) : PaletteQuantizer() {
+		setPalette(colors.data(), (int)colors.size());
+	}
+
+	void setPalette(const glm::vec4* colors, int size);
+
+	template<class T>
+	inline void setPalette(const T& colors) {
+		setPalette(colors.data(), (int)colors.size());
+	}
+
+	/**
+	 * @return index in the palette or @c -1 if the palette is empty
+	 * @see core::Color::getClosestMatch()
+	 */
+	int getClosestMatch(const glm::vec4& color) const;
+
+	/**
+	 * @brief Maps all given colors onto the palette
+	 * @param[out] indices Receives @c amount palette indices
+	 */
+	void getClosestMatches(const glm::vec4* colors, int amount, int* indices) const;
+
+	/**
+	 * @brief Drops all cached color lookups
+	 */
+	void clearCache();
+
+	inline int size() const {
+		return _size;
+	}
+
+	inline bool empty() const {
+		return _size == 0;
+	}
+};
+
+}
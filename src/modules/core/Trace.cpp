@@ -3,10 +3,12 @@
  */
 
 #include "core/Trace.h"
+#include "core/TraceRecorder.h"
 #include "core/Var.h"
 #include "core/Log.h"
 #include "core/Common.h"
 #include "core/command/Command.h"
+#include <atomic>
 
 #ifdef USE_EMTRACE
 #include <emscripten/trace.h>
@@ -17,6 +19,7 @@ namespace core {
 namespace {
 
 static TraceCallback* _callback = nullptr;
+static std::atomic<TraceRecorder*> _recorder { nullptr };
 static thread_local const char* _threadName = "Unknown";
 
 }
@@ -87,6 +90,10 @@ TraceCallback* traceSet(TraceCallback* callback) {
 	return old;
 }
 
+TraceRecorder* traceRecorderSet(TraceRecorder* recorder) {
+	return _recorder.exchange(recorder);
+}
+
 void traceInit() {
 #ifdef USE_EMTRACE
 	Log::info("emtrace active");
@@ -101,6 +108,9 @@ void traceBeginFrame() {
 	emscripten_trace_record_frame_start();
 #else
 	if (_callback != nullptr) {
+		if (TraceRecorder* recorder = _recorder.load(std::memory_order_acquire)) {
+			recorder->begin("Frame");
+		}
 		_callback->traceBeginFrame(_threadName);
 	} else {
 		traceBegin("Frame");
@@ -114,6 +124,9 @@ void traceEndFrame() {
 #else
 	if (_callback != nullptr) {
 		_callback->traceEndFrame(_threadName);
+		if (TraceRecorder* recorder = _recorder.load(std::memory_order_acquire)) {
+			recorder->end();
+		}
 	} else {
 		traceEnd();
 	}
@@ -124,6 +137,9 @@ void traceBegin(const char* name) {
 #ifdef USE_EMTRACE
 	emscripten_trace_enter_context(name);
 #else
+	if (TraceRecorder* recorder = _recorder.load(std::memory_order_acquire)) {
+		recorder->begin(name);
+	}
 	if (_callback != nullptr) {
 		_callback->traceBegin(_threadName, name);
 	}
@@ -137,6 +153,9 @@ void traceEnd() {
 	if (_callback != nullptr) {
 		_callback->traceEnd(_threadName);
 	}
+	if (TraceRecorder* recorder = _recorder.load(std::memory_order_acquire)) {
+		recorder->end();
+	}
 #endif
 }
 
@@ -149,6 +168,13 @@ void traceMessage(const char* message) {
 
 void traceThread(const char* name) {
 	_threadName = name;
+	if (TraceRecorder* recorder = _recorder.load(std::memory_order_acquire)) {
+		recorder->threadName(name);
+	}
+}
+
+const char* traceThreadName() {
+	return _threadName;
 }
 
 }
@@ -34,7 +34,15 @@ public:
 	virtual void traceEndFrame(const char *threadName) {}
 };
 
+class TraceRecorder;
+
+
 extern TraceCallback* traceSet(TraceCallback* callback);
+/**
+ * @brief Records all trace scopes into the given recorder - @c nullptr disables the recording
+ * @return The previous recorder
+ */
+extern TraceRecorder* traceRecorderSet(TraceRecorder* recorder);
 extern void traceInit();
 extern void traceShutdown();
 extern void traceBeginFrame();
@@ -43,6 +51,7 @@ extern void traceBegin(const char* name);
 extern void traceEnd();
 extern void traceMessage(const char* name);
 extern void traceThread(const char* name);
+extern const char* traceThreadName();
 
 #ifdef TRACY_ENABLE
 #define core_trace_value_scoped(name, x) ZoneNamedN(__tracy_scoped_##name, #name, true); ZoneValueV(__tracy_scoped_##name, (uint64_t)(x))
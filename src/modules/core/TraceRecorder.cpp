@@ -0,0 +1,293 @@
+/**
+ * @file
+ */
+
+#include "TraceRecorder.h"
+#include "core/Common.h"
+#include "core/Trace.h"
+#include <SDL_stdinc.h>
+#include <SDL_timer.h>
+#include <inttypes.h>
+#include <algorithm>
+
+namespace core {
+
+namespace {
+
+std::atomic<uint32_t> _recorderIds { 0u };
+// the events of exited threads are kept until there are more buffers than this
+static constexpr size_t MaxBuffers = 64u;
+
+}
+
+/**
+ * @brief Single producer ring buffer of begin and end events - the oldest events are overwritten
+ */
+class TraceRecorder::Buffer {
+public:
+	struct Event {
+		std::atomic<uint64_t> ticks { 0u };
+		// nullptr for end events
+		std::atomic<const char*> name { nullptr };
+	};
+
+	std::unique_ptr<Event[]> events;
+	const size_t capacity;
+	// monotonic write position
+	std::atomic<uint64_t> head { 0u };
+	// set if the thread that owned the buffer exited - the buffer can be reused
+	std::atomic_bool unused { false };
+	uint32_t threadId = 0u;
+	char threadName[64] = "";
+
+	Buffer(size_t _capacity) :
+			events(new Event[_capacity]), capacity(_capacity) {
+	}
+
+	inline void add(const char *name) {
+		const uint64_t pos = head.load(std::memory_order_relaxed);
+		Event& event = events[pos & (capacity - 1u)];
+		event.ticks.store(SDL_GetPerformanceCounter(), std::memory_order_relaxed);
+		event.name.store(name, std::memory_order_relaxed);
+		head.store(pos + 1u, std::memory_order_release);
+	}
+};
+
+namespace {
+
+/**
+ * @brief The buffers of the current thread - one for each recorder the thread has written to
+ */
+struct ThreadBuffers {
+	uint32_t lastRecorderId = 0u;
+	void *lastBuffer = nullptr;
+	std::vector<std::pair<uint32_t, std::weak_ptr<void>>> buffers;
+	std::vector<std::function<void()>> onExit;
+
+	~ThreadBuffers() {
+		for (const std::function<void()>& func : onExit) {
+			func();
+		}
+	}
+};
+
+thread_local ThreadBuffers _threadBuffers;
+
+void appendEscaped(core::String& out, const char *str) {
+	for (const char *c = str; *c != '\0'; ++c) {
+		if (*c == '"' || *c == '\\') {
+			out += '\\';
+			out += *c;
+		} else if ((unsigned char)*c < 0x20) {
+			out += ' ';
+		} else {
+			out += *c;
+		}
+	}
+}
+
+}
+
+TraceRecorder::TraceRecorder(size_t eventsPerThread) :
+		_eventsPerThread(eventsPerThread), _recorderId(_recorderIds.fetch_add(1u) + 1u),
+		_startTicks(SDL_GetPerformanceCounter()), _ticksPerSecond(SDL_GetPerformanceFrequency()) {
+}
+
+TraceRecorder::~TraceRecorder() {
+	core::ScopedLock<core::Lock> lock(_lock);
+	_buffers.clear();
+}
+
+TraceRecorder::Buffer* TraceRecorder::threadBuffer() {
+	if (_threadBuffers.lastRecorderId == _recorderId) {
+		return (Buffer*)_threadBuffers.lastBuffer;
+	}
+	for (const auto& e : _threadBuffers.buffers) {
+		if (e.first != _recorderId) {
+			continue;
+		}
+		// the recorder is still alive - otherwise nobody could call this method
+		Buffer* buffer = (Buffer*)e.second.lock().get();
+		_threadBuffers.lastRecorderId = _recorderId;
+		_threadBuffers.lastBuffer = buffer;
+		return buffer;
+	}
+	size_t capacity = 2u;
+	while (capacity < _eventsPerThread) {
+		capacity <<= 1;
+	}
+	BufferPtr buffer;
+	{
+		core::ScopedLock<core::Lock> lock(_lock);
+		// reuse the buffer of a thread that already exited
+		if (_buffers.size() >= MaxBuffers) {
+			for (const BufferPtr& b : _buffers) {
+				if (b->unused) {
+					buffer = b;
+					break;
+				}
+			}
+		}
+		if (buffer) {
+			buffer->head = 0u;
+			buffer->unused = false;
+		} else {
+			buffer = std::make_shared<Buffer>(capacity);
+			_buffers.push_back(buffer);
+		}
+		buffer->threadId = _nextThreadId++;
+		SDL_strlcpy(buffer->threadName, traceThreadName(), sizeof(buffer->threadName));
+	}
+	_threadBuffers.buffers.emplace_back(_recorderId, buffer);
+	std::weak_ptr<Buffer> weak = buffer;
+	_threadBuffers.onExit.emplace_back([weak] () {
+		if (BufferPtr b = weak.lock()) {
+			b->unused = true;
+		}
+	});
+	_threadBuffers.lastRecorderId = _recorderId;
+	_threadBuffers.lastBuffer = buffer.get();
+	return buffer.get();
+}
+
+uint64_t TraceRecorder::toMicros(uint64_t ticks) const {
+	const uint64_t delta = ticks > _startTicks ? ticks - _startTicks : 0u;
+	return delta / _ticksPerSecond * 1000000u + (delta % _ticksPerSecond) * 1000000u / _ticksPerSecond;
+}
+
+void TraceRecorder::begin(const char *name) {
+	threadBuffer()->add(name);
+}
+
+void TraceRecorder::end() {
+	threadBuffer()->add(nullptr);
+}
+
+void TraceRecorder::threadName(const char *name) {
+	Buffer* buffer = threadBuffer();
+	core::ScopedLock<core::Lock> lock(_lock);
+	SDL_strlcpy(buffer->threadName, name, sizeof(buffer->threadName));
+}
+
+void TraceRecorder::visit(double seconds, const Visitor& visitor) {
+	struct Snapshot {
+		BufferPtr buffer;
+		uint32_t threadId;
+		char threadName[64];
+	};
+	std::vector<Snapshot> snapshots;
+	{
+		core::ScopedLock<core::Lock> lock(_lock);
+		snapshots.reserve(_buffers.size());
+		for (const BufferPtr& buffer : _buffers) {
+			Snapshot snapshot;
+			snapshot.buffer = buffer;
+			snapshot.threadId = buffer->threadId;
+			SDL_memcpy(snapshot.threadName, buffer->threadName, sizeof(snapshot.threadName));
+			snapshots.push_back(snapshot);
+		}
+	}
+
+	const uint64_t now = SDL_GetPerformanceCounter();
+	const uint64_t window = (uint64_t)(core_max(0.0, seconds) * (double)_ticksPerSecond);
+	const uint64_t cutoff = now > window ? now - window : 0u;
+
+	struct Event {
+		uint64_t ticks;
+		const char *name;
+	};
+	std::vector<Event> events;
+	std::vector<Event> stack;
+	for (const Snapshot& snapshot : snapshots) {
+		const Buffer& buffer = *snapshot.buffer;
+		const uint64_t capacity = buffer.capacity;
+		const uint64_t head = buffer.head.load(std::memory_order_acquire);
+		const uint64_t start = head > capacity ? head - capacity : 0u;
+		events.clear();
+		events.reserve(head - start);
+		for (uint64_t i = start; i < head; ++i) {
+			const Buffer::Event& event = buffer.events[i & (capacity - 1u)];
+			events.push_back(Event{event.ticks.load(std::memory_order_relaxed), event.name.load(std::memory_order_relaxed)});
+		}
+		// the owner thread might have overwritten the oldest events while we were copying them
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const uint64_t headAfter = buffer.head.load(std::memory_order_relaxed);
+		if (headAfter < head) {
+			// the buffer was reused by another thread
+			continue;
+		}
+		const uint64_t firstValid = headAfter > capacity ? headAfter - capacity : 0u;
+		const size_t skip = (size_t)(core_max(start, firstValid) - start);
+
+		stack.clear();
+		for (size_t i = skip; i < events.size(); ++i) {
+			const Event& event = events[i];
+			if (event.name != nullptr) {
+				stack.push_back(event);
+				continue;
+			}
+			// the begin event was already overwritten
+			if (stack.empty()) {
+				continue;
+			}
+			const Event beginEvent = stack.back();
+			stack.pop_back();
+			if (event.ticks < cutoff) {
+				continue;
+			}
+			visitor(Scope{beginEvent.name, snapshot.threadName, snapshot.threadId, (int)stack.size(),
+					toMicros(beginEvent.ticks), toMicros(event.ticks)});
+		}
+		while (!stack.empty()) {
+			const Event beginEvent = stack.back();
+			stack.pop_back();
+			visitor(Scope{beginEvent.name, snapshot.threadName, snapshot.threadId, (int)stack.size(),
+					toMicros(beginEvent.ticks), toMicros(now)});
+		}
+	}
+}
+
+core::String TraceRecorder::chromeTrace(double seconds) {
+	core::String json;
+	// the string grows linear - so reserve the memory in bigger steps
+	size_t reserved = 64u * 1024u;
+	json.reserve(reserved);
+	json += "{\"traceEvents\":[";
+	std::vector<uint32_t> threadIds;
+	char buf[256];
+	bool first = true;
+	visit(seconds, [&] (const Scope& scope) {
+		if (json.size() + sizeof(buf) * 2u > reserved) {
+			reserved *= 2u;
+			json.reserve(reserved);
+		}
+		if (std::find(threadIds.begin(), threadIds.end(), scope.threadId) == threadIds.end()) {
+			threadIds.push_back(scope.threadId);
+			json += first ? "\n" : ",\n";
+			SDL_snprintf(buf, sizeof(buf), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"",
+					scope.threadId);
+			json += buf;
+			appendEscaped(json, scope.threadName);
+			json += "\"}}";
+			first = false;
+		}
+		json += first ? "\n" : ",\n";
+		json += "{\"name\":\"";
+		appendEscaped(json, scope.name);
+		SDL_snprintf(buf, sizeof(buf), "\",\"ph\":\"X\",\"ts\":%" PRIu64 ",\"dur\":%" PRIu64 ",\"pid\":1,\"tid\":%u}",
+				scope.beginMicros, scope.endMicros - scope.beginMicros, scope.threadId);
+		json += buf;
+		first = false;
+	});
+	json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return json;
+}
+
+void TraceRecorder::clear() {
+	core::ScopedLock<core::Lock> lock(_lock);
+	for (const BufferPtr& buffer : _buffers) {
+		buffer->head = 0u;
+	}
+}
+
+}
@@ -0,0 +1,105 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include "core/Trace.h"
+#include "core/concurrent/Lock.h"
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace core {
+
+/**
+ * @brief Records the begin and end events of the trace scopes into per thread ring buffers
+ *
+ * Recording an event doesn't lock or allocate - each thread owns a fixed size ring buffer and the oldest
+ * events are overwritten. The recorded scopes of the last seconds can be visited or exported as chrome
+ * trace event json (chrome://tracing, perfetto, speedscope, ...).
+ *
+ * @note The names of the scopes must stay valid for the lifetime of the recorder - the @c core_trace_scoped
+ * macros are using string literals.
+ * @note Only active if tracy is not compiled in - see @c core_trace_scoped
+ * @sa traceRecorderSet()
+ */
+class TraceRecorder {
+public:
+	/**
+	 * @brief A completed (or still open) scope
+	 */
+	struct Scope {
+		const char *name;
+		const char *threadName;
+		// unique id of the thread that recorded the scope
+		uint32_t threadId;
+		// the nesting level of the scope in its thread - 0 is the outermost recorded scope
+		int depth;
+		// the microseconds since the creation of the recorder
+		uint64_t beginMicros;
+		uint64_t endMicros;
+	};
+
+	using Visitor = std::function<void(const Scope& scope)>;
+
+private:
+	class Buffer;
+	using BufferPtr = std::shared_ptr<Buffer>;
+
+	const size_t _eventsPerThread;
+	// unique id of the recorder - used to find the buffer of the calling thread
+	const uint32_t _recorderId;
+	const uint64_t _startTicks;
+	const uint64_t _ticksPerSecond;
+
+	core_trace_mutex(core::Lock, _lock, "TraceRecorder");
+	std::vector<BufferPtr> _buffers;
+	uint32_t _nextThreadId = 1u;
+
+	Buffer* threadBuffer();
+	uint64_t toMicros(uint64_t ticks) const;
+
+public:
+	/**
+	 * @param[in] eventsPerThread The amount of begin and end events each thread can record before the
+	 * oldest ones are overwritten. Each event needs 16 bytes.
+	 */
+	TraceRecorder(size_t eventsPerThread = 32768u);
+	~TraceRecorder();
+
+	void begin(const char *name);
+	void end();
+	/**
+	 * @brief Sets the name of the calling thread
+	 */
+	void threadName(const char *name);
+
+	/**
+	 * @brief Visits all the recorded scopes that ended (or are still open) within the last seconds
+	 *
+	 * The scopes of each thread are visited in the order they ended. Scopes that were started before
+	 * the oldest event of the ring buffer was recorded are skipped. Scopes that are still open end
+	 * at the time of this call.
+	 *
+	 * @note Can be called from any thread while the other threads are still recording
+	 */
+	void visit(double seconds, const Visitor& visitor);
+
+	/**
+	 * @brief Exports the scopes of the last seconds as chrome trace event json
+	 * @sa visit()
+	 */
+	core::String chromeTrace(double seconds);
+
+	/**
+	 * @brief Removes all recorded events
+	 * @note Must not be called while other threads are recording
+	 */
+	void clear();
+};
+
+}
@@ -1,8 +1,10 @@
 #include "core/benchmark/AbstractBenchmark.h"
 #include "core/collection/Map.h"
+#include "core/collection/HashMap.h"
 #include "core/Assert.h"
 #include <unordered_map>
 #include <map>
+#include <memory>
 
 class MapBenchmark: public core::AbstractBenchmark {
 };
@@ -57,4 +59,183 @@ BENCHMARK_REGISTER_F(MapBenchmark, compareToMapCore)->RangeMultiplier(2)->Range(
 BENCHMARK_REGISTER_F(MapBenchmark, compareToMapStd)->RangeMultiplier(2)->Range(8, 512);
 BENCHMARK_REGISTER_F(MapBenchmark, compareToUnorderedMapStd)->RangeMultiplier(2)->Range(8, 512);
 
+namespace {
+
+using CoreMap = core::Map<int64_t, int64_t, 4096, std::hash<int64_t>>;
+using CoreHashMap = core::HashMap<int64_t, int64_t, std::hash<int64_t>>;
+using StdUnorderedMap = std::unordered_map<int64_t, int64_t, std::hash<int64_t>>;
+
+// spread the keys - sequential keys would be a best case for the identity hash of core::Map
+inline int64_t benchmarkKey(int64_t i) {
+	return i * 0x9E3779B97F4A7C15ll;
+}
+
+template<class MAP>
+struct MapOps;
+
+template<>
+struct MapOps<CoreMap> {
+	static std::unique_ptr<CoreMap> create(int64_t n) {
+		return std::unique_ptr<CoreMap>(new CoreMap((int)n));
+	}
+	static inline void put(CoreMap& map, int64_t key, int64_t value) {
+		map.put(key, value);
+	}
+	static inline bool get(const CoreMap& map, int64_t key, int64_t& value) {
+		return map.get(key, value);
+	}
+	static inline bool remove(CoreMap& map, int64_t key) {
+		return map.remove(key);
+	}
+	static inline int64_t sum(const CoreMap& map) {
+		int64_t sum = 0;
+		for (auto i : map) {
+			sum += i->value;
+		}
+		return sum;
+	}
+};
+
+template<>
+struct MapOps<CoreHashMap> {
+	static std::unique_ptr<CoreHashMap> create(int64_t) {
+		return std::unique_ptr<CoreHashMap>(new CoreHashMap());
+	}
+	static inline void put(CoreHashMap& map, int64_t key, int64_t value) {
+		map.put(key, value);
+	}
+	static inline bool get(const CoreHashMap& map, int64_t key, int64_t& value) {
+		return map.get(key, value);
+	}
+	static inline bool remove(CoreHashMap& map, int64_t key) {
+		return map.remove(key);
+	}
+	static inline int64_t sum(const CoreHashMap& map) {
+		int64_t sum = 0;
+		for (auto i : map) {
+			sum += i->value;
+		}
+		return sum;
+	}
+};
+
+template<>
+struct MapOps<StdUnorderedMap> {
+	static std::unique_ptr<StdUnorderedMap> create(int64_t) {
+		return std::unique_ptr<StdUnorderedMap>(new StdUnorderedMap());
+	}
+	static inline void put(StdUnorderedMap& map, int64_t key, int64_t value) {
+		map[key] = value;
+	}
+	static inline bool get(const StdUnorderedMap& map, int64_t key, int64_t& value) {
+		auto i = map.find(key);
+		if (i == map.end()) {
+			return false;
+		}
+		value = i->second;
+		return true;
+	}
+	static inline bool remove(StdUnorderedMap& map, int64_t key) {
+		return map.erase(key) == 1u;
+	}
+	static inline int64_t sum(const StdUnorderedMap& map) {
+		int64_t sum = 0;
+		for (const auto& i : map) {
+			sum += i.second;
+		}
+		return sum;
+	}
+};
+
+template<class MAP>
+std::unique_ptr<MAP> filledMap(int64_t n) {
+	std::unique_ptr<MAP> map = MapOps<MAP>::create(n);
+	for (int64_t i = 0; i < n; ++i) {
+		MapOps<MAP>::put(*map, benchmarkKey(i), i);
+	}
+	return map;
+}
+
+template<class MAP>
+void mapInsert(benchmark::State& state) {
+	const int64_t n = state.range(0);
+	for (auto _ : state) {
+		std::unique_ptr<MAP> map = filledMap<MAP>(n);
+		benchmark::DoNotOptimize(map.get());
+		state.PauseTiming();
+		map.reset();
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<class MAP>
+void mapLookup(benchmark::State& state) {
+	const int64_t n = state.range(0);
+	const std::unique_ptr<MAP> map = filledMap<MAP>(n);
+	for (auto _ : state) {
+		for (int64_t i = 0; i < n; ++i) {
+			int64_t value;
+			// every second lookup is a miss
+			const bool found = MapOps<MAP>::get(*map, benchmarkKey(i / 2 + (i & 1) * n), value);
+			benchmark::DoNotOptimize(found);
+			benchmark::DoNotOptimize(value);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<class MAP>
+void mapErase(benchmark::State& state) {
+	const int64_t n = state.range(0);
+	for (auto _ : state) {
+		state.PauseTiming();
+		std::unique_ptr<MAP> map = filledMap<MAP>(n);
+		state.ResumeTiming();
+		for (int64_t i = 0; i < n; ++i) {
+			if (!MapOps<MAP>::remove(*map, benchmarkKey(i))) {
+				state.SkipWithError("Failed!");
+				break;
+			}
+		}
+		state.PauseTiming();
+		map.reset();
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<class MAP>
+void mapIterate(benchmark::State& state) {
+	const int64_t n = state.range(0);
+	const std::unique_ptr<MAP> map = filledMap<MAP>(n);
+	for (auto _ : state) {
+		const int64_t sum = MapOps<MAP>::sum(*map);
+		if (sum != n * (n - 1) / 2) {
+			state.SkipWithError("Failed!");
+			break;
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+}
+
+#define MAP_BENCHMARK(op, name, type) \
+	BENCHMARK_DEFINE_F(MapBenchmark, op##name) (benchmark::State& state) { \
+		map##op<type>(state); \
+	} \
+	BENCHMARK_REGISTER_F(MapBenchmark, op##name)->Unit(benchmark::kMicrosecond)->Arg(1000)->Arg(65000)
+
+// the pool allocator of core::Map can't hold more than 65535 entries
+#define MAP_BENCHMARKS(op) \
+	MAP_BENCHMARK(op, MapCore, CoreMap); \
+	MAP_BENCHMARK(op, HashMapCore, CoreHashMap)->Arg(100000)->Arg(1000000); \
+	MAP_BENCHMARK(op, UnorderedMapStd, StdUnorderedMap)->Arg(100000)->Arg(1000000)
+
+MAP_BENCHMARKS(Insert);
+MAP_BENCHMARKS(Lookup);
+MAP_BENCHMARKS(Erase);
+MAP_BENCHMARKS(Iterate);
+
 BENCHMARK_MAIN();
@@ -0,0 +1,72 @@
+/**
+ * @file
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "core/EventBus.h"
+
+namespace {
+
+EVENTBUSPAYLOADEVENT(BenchmarkEvent, int);
+
+class BenchmarkHandler: public core::IEventBusHandler<BenchmarkEvent> {
+public:
+	int64_t sum = 0;
+
+	void onEvent(const BenchmarkEvent& e) override {
+		sum += e.get();
+	}
+};
+
+}
+
+class EventBusBenchmark: public core::AbstractBenchmark {
+};
+
+BENCHMARK_DEFINE_F(EventBusBenchmark, Publish) (benchmark::State& state) {
+	core::EventBus eventBus;
+	BenchmarkHandler handler;
+	eventBus.subscribe(handler);
+	const BenchmarkEvent event(1);
+	for (auto _ : state) {
+		for (int64_t i = 0; i < state.range(0); ++i) {
+			eventBus.publish(event);
+		}
+	}
+	benchmark::DoNotOptimize(handler.sum);
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// events that are allocated and enqueued as shared pointer - this is thread safe
+BENCHMARK_DEFINE_F(EventBusBenchmark, EnqueueShared) (benchmark::State& state) {
+	core::EventBus eventBus;
+	BenchmarkHandler handler;
+	eventBus.subscribe(handler);
+	for (auto _ : state) {
+		for (int64_t i = 0; i < state.range(0); ++i) {
+			eventBus.enqueue(std::make_shared<BenchmarkEvent>(1));
+		}
+		eventBus.update();
+	}
+	benchmark::DoNotOptimize(handler.sum);
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// events that are copied into the preallocated ring buffer of their type
+BENCHMARK_DEFINE_F(EventBusBenchmark, EnqueueTyped) (benchmark::State& state) {
+	core::EventBus eventBus(64, (int)state.range(0));
+	BenchmarkHandler handler;
+	eventBus.subscribe(handler);
+	for (auto _ : state) {
+		for (int64_t i = 0; i < state.range(0); ++i) {
+			eventBus.enqueue(BenchmarkEvent(1));
+		}
+		eventBus.update();
+	}
+	benchmark::DoNotOptimize(handler.sum);
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_REGISTER_F(EventBusBenchmark, Publish)->Arg(1000)->Arg(100000);
+BENCHMARK_REGISTER_F(EventBusBenchmark, EnqueueShared)->Arg(1000)->Arg(100000);
+BENCHMARK_REGISTER_F(EventBusBenchmark, EnqueueTyped)->Arg(1000)->Arg(100000);
@@ -0,0 +1,63 @@
+/**
+ * @file
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "core/GameConfig.h"
+#include "core/Log.h"
+#include "core/Var.h"
+#include <SDL_log.h>
+#include <stdio.h>
+
+class LogBenchmark: public core::AbstractBenchmark {
+protected:
+	SDL_LogOutputFunction _outputFunction = nullptr;
+	void *_outputUserData = nullptr;
+	FILE *_devNull = nullptr;
+
+	// emulates the console output without flooding it
+	static void output(void *userdata, int category, SDL_LogPriority priority, const char *message) {
+		fputs(message, (FILE*)userdata);
+	}
+
+	void setAsync(bool async) {
+		core::Var::getSafe(cfg::CoreLogAsync)->setVal(async);
+		Log::init();
+	}
+
+public:
+	bool onInitApp() override {
+		_devNull = fopen("/dev/null", "w");
+		if (_devNull == nullptr) {
+			return false;
+		}
+		SDL_LogGetOutputFunction(&_outputFunction, &_outputUserData);
+		SDL_LogSetOutputFunction(output, _devNull);
+		return true;
+	}
+
+	void onCleanupApp() override {
+		SDL_LogSetOutputFunction(_outputFunction, _outputUserData);
+		if (_devNull != nullptr) {
+			fclose(_devNull);
+			_devNull = nullptr;
+		}
+	}
+};
+
+// caller side latency of a log call - range 0 is the synchronous and 1 the asynchronous mode
+BENCHMARK_DEFINE_F(LogBenchmark, Warn) (benchmark::State& state) {
+	setAsync(state.range(0) != 0);
+	const uint64_t droppedBefore = Log::dropped();
+	int64_t i = 0;
+	for (auto _ : state) {
+		Log::warn("benchmark message %i with some payload %s", (int)++i, "and a string");
+	}
+	Log::flush();
+	state.SetItemsProcessed(state.iterations());
+	state.counters["dropped"] = (double)(Log::dropped() - droppedBefore);
+	// the vars are already gone when the app is cleaned up
+	setAsync(false);
+}
+
+BENCHMARK_REGISTER_F(LogBenchmark, Warn)->Arg(0)->Arg(1);
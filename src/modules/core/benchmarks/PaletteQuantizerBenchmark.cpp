@@ -0,0 +1,82 @@
+/**
+ * @file
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "core/PaletteQuantizer.h"
+#include "core/Color.h"
+#include <random>
+#include <vector>
+
+namespace {
+
+// amount of colors that are mapped per iteration - the amount of distinct colors is the benchmark argument
+static constexpr int Colors = 1 << 16;
+
+enum Mode {
+	// core::Color::getClosestMatch() for every color
+	Linear = 0,
+	// the quantizer with colors that are not cached
+	Kernel = 1,
+	// the quantizer with 8 bit colors like they are read by the importers
+	Cached = 2
+};
+
+}
+
+class PaletteQuantizerBenchmark : public core::AbstractBenchmark {
+protected:
+	std::vector<glm::vec4> _palette;
+
+	bool onInitApp() override {
+		std::mt19937 engine(42);
+		std::uniform_int_distribution<int> byteDist(0, 255);
+		_palette.clear();
+		for (int i = 0; i < 256; ++i) {
+			_palette.push_back(core::Color::fromRGBA(byteDist(engine), byteDist(engine), byteDist(engine), 255));
+		}
+		return true;
+	}
+
+	std::vector<glm::vec4> colors(int distinct, bool eightBit) const {
+		std::mt19937 engine(1);
+		std::uniform_int_distribution<int> byteDist(0, 255);
+		std::vector<glm::vec4> distinctColors;
+		for (int i = 0; i < distinct; ++i) {
+			glm::vec4 color = core::Color::fromRGBA(byteDist(engine), byteDist(engine), byteDist(engine), 255);
+			if (!eightBit) {
+				// not representable as 8 bit color - this bypasses the cache
+				color.r = color.r * 0.999f + 0.0001f;
+			}
+			distinctColors.push_back(color);
+		}
+		std::vector<glm::vec4> result;
+		result.reserve(Colors);
+		for (int i = 0; i < Colors; ++i) {
+			result.push_back(distinctColors[i % distinct]);
+		}
+		return result;
+	}
+};
+
+BENCHMARK_DEFINE_F(PaletteQuantizerBenchmark, Quantize)(benchmark::State &state) {
+	const Mode mode = (Mode)state.range(0);
+	const std::vector<glm::vec4>& input = colors((int)state.range(1), mode == Cached);
+	std::vector<int> indices(input.size());
+	const core::PaletteQuantizer quantizer(_palette);
+	for (auto _ : state) {
+		if (mode == Linear) {
+			for (size_t i = 0; i < input.size(); ++i) {
+				indices[i] = core::Color::getClosestMatch(input[i], _palette);
+			}
+		} else {
+			quantizer.getClosestMatches(input.data(), (int)input.size(), indices.data());
+		}
+		benchmark::DoNotOptimize(indices.data());
+	}
+	state.SetItemsProcessed(state.iterations() * (int64_t)input.size());
+}
+
+BENCHMARK_REGISTER_F(PaletteQuantizerBenchmark, Quantize)->ArgNames({"mode", "distinct"})
+	->Args({Linear, 4096})->Args({Kernel, 4096})->Args({Cached, 4096})->Args({Cached, Colors})
+	->Unit(benchmark::kMillisecond)->UseRealTime();
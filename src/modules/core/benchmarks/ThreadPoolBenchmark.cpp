@@ -0,0 +1,220 @@
+/**
+ * @file
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "core/concurrent/TaskGroup.h"
+#include "core/concurrent/ThreadPool.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/Lock.h"
+#include <SDL_timer.h>
+#include <algorithm>
+#include <atomic>
+#include <queue>
+#include <vector>
+
+namespace {
+
+static constexpr int TinyTasks = 10000;
+
+// microseconds between the submission and the start of the task
+class Latencies {
+private:
+	std::vector<uint64_t> _micros;
+	const uint64_t _frequency;
+public:
+	Latencies() : _micros(TinyTasks), _frequency(SDL_GetPerformanceFrequency()) {
+	}
+
+	inline void record(int i, uint64_t submitted) {
+		_micros[i] = (SDL_GetPerformanceCounter() - submitted) * 1000000u / _frequency;
+	}
+
+	void report(benchmark::State& state) {
+		std::sort(_micros.begin(), _micros.end());
+		state.counters["p50_us"] = (double)_micros[_micros.size() / 2];
+		state.counters["p99_us"] = (double)_micros[_micros.size() * 99 / 100];
+	}
+};
+
+/**
+ * @brief The previous implementation of the pool as reference - one queue behind one lock with a
+ * std::future for each task
+ */
+class SingleQueuePool {
+private:
+	std::vector<std::thread> _workers;
+	std::queue<std::function<void()>> _tasks;
+	core::Lock _queueMutex;
+	core::ConditionVariable _queueCondition;
+	bool _stop = false;
+public:
+	SingleQueuePool(size_t threads) {
+		for (size_t i = 0; i < threads; ++i) {
+			_workers.emplace_back([this] {
+				for (;;) {
+					std::function<void()> task;
+					{
+						core::ScopedLock lock(_queueMutex);
+						_queueCondition.wait(_queueMutex, [this] {
+							return _stop || !_tasks.empty();
+						});
+						if (_stop && _tasks.empty()) {
+							break;
+						}
+						task = std::move(_tasks.front());
+						_tasks.pop();
+					}
+					task();
+				}
+			});
+		}
+	}
+
+	~SingleQueuePool() {
+		{
+			core::ScopedLock lock(_queueMutex);
+			_stop = true;
+		}
+		_queueCondition.notify_all();
+		for (std::thread& worker : _workers) {
+			worker.join();
+		}
+	}
+
+	template<class F>
+	std::future<void> enqueue(F&& f) {
+		auto task = std::make_shared<std::packaged_task<void()>>(std::forward<F>(f));
+		std::future<void> res = task->get_future();
+		{
+			core::ScopedLock lock(_queueMutex);
+			_tasks.emplace([task]() {(*task)();});
+		}
+		_queueCondition.notify_one();
+		return res;
+	}
+};
+
+void forkJoin(core::ThreadPool& pool, std::atomic_int& leaves, int depth) {
+	if (depth == 0) {
+		++leaves;
+		return;
+	}
+	core::TaskGroup group(pool);
+	group.spawn([&pool, &leaves, depth] () {
+		forkJoin(pool, leaves, depth - 1);
+	});
+	group.spawn([&pool, &leaves, depth] () {
+		forkJoin(pool, leaves, depth - 1);
+	});
+	group.wait();
+}
+
+}
+
+class ThreadPoolBenchmark: public core::AbstractBenchmark {
+protected:
+	core::ThreadPool _pool { 4, "benchmark" };
+public:
+	bool onInitApp() override {
+		_pool.init();
+		return true;
+	}
+
+	void onCleanupApp() override {
+		_pool.shutdown(true);
+	}
+};
+
+template<class POOL>
+static void tinyTasksFuture(POOL& pool, benchmark::State& state) {
+	Latencies latencies;
+	std::vector<std::future<void>> futures;
+	futures.reserve(TinyTasks);
+	std::atomic_int sum { 0 };
+	for (auto _ : state) {
+		futures.clear();
+		for (int i = 0; i < TinyTasks; ++i) {
+			const uint64_t submitted = SDL_GetPerformanceCounter();
+			futures.emplace_back(pool.enqueue([&latencies, &sum, i, submitted] () {
+				latencies.record(i, submitted);
+				++sum;
+			}));
+		}
+		for (std::future<void>& f : futures) {
+			f.get();
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * TinyTasks);
+	latencies.report(state);
+}
+
+// 10k tiny tasks with a std::future for each task in the previous pool implementation
+BENCHMARK_F(ThreadPoolBenchmark, TinyTasksSingleQueue) (benchmark::State& state) {
+	SingleQueuePool pool(_pool.size());
+	tinyTasksFuture(pool, state);
+}
+
+BENCHMARK_F(ThreadPoolBenchmark, TinyTasksFuture) (benchmark::State& state) {
+	tinyTasksFuture(_pool, state);
+}
+
+// 10k tiny tasks in a task group - no future and no allocation per task
+BENCHMARK_F(ThreadPoolBenchmark, TinyTasksGroup) (benchmark::State& state) {
+	Latencies latencies;
+	std::atomic_int sum { 0 };
+	for (auto _ : state) {
+		core::TaskGroup group(_pool);
+		for (int i = 0; i < TinyTasks; ++i) {
+			const uint64_t submitted = SDL_GetPerformanceCounter();
+			group.spawn([&latencies, &sum, i, submitted] () {
+				latencies.record(i, submitted);
+				++sum;
+			});
+		}
+		group.wait();
+	}
+	state.SetItemsProcessed(state.iterations() * TinyTasks);
+	latencies.report(state);
+}
+
+// nested fork/join can't wait for futures within the workers without the risk of a deadlock - so the
+// caller has to split the work level by level
+template<class POOL>
+static void forkJoinFuture(POOL& pool, benchmark::State& state) {
+	std::atomic_int leaves { 0 };
+	std::vector<std::future<void>> futures;
+	for (auto _ : state) {
+		for (int level = 0; level <= 10; ++level) {
+			futures.clear();
+			for (int i = 0; i < (1 << level); ++i) {
+				futures.emplace_back(pool.enqueue([&leaves, level] () {
+					if (level == 10) {
+						++leaves;
+					}
+				}));
+			}
+			for (std::future<void>& f : futures) {
+				f.get();
+			}
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * 1024);
+}
+
+BENCHMARK_F(ThreadPoolBenchmark, ForkJoinSingleQueue) (benchmark::State& state) {
+	SingleQueuePool pool(_pool.size());
+	forkJoinFuture(pool, state);
+}
+
+BENCHMARK_F(ThreadPoolBenchmark, ForkJoinFuture) (benchmark::State& state) {
+	forkJoinFuture(_pool, state);
+}
+
+BENCHMARK_F(ThreadPoolBenchmark, ForkJoinGroup) (benchmark::State& state) {
+	std::atomic_int leaves { 0 };
+	for (auto _ : state) {
+		forkJoin(_pool, leaves, 10);
+	}
+	state.SetItemsProcessed(state.iterations() * 1024);
+}
@@ -0,0 +1,37 @@
+/**
+ * @file
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "core/Trace.h"
+#include "core/TraceRecorder.h"
+
+class TraceBenchmark: public core::AbstractBenchmark {
+};
+
+// the overhead of a trace scope - range 0 is without and 1 with an active recorder
+BENCHMARK_DEFINE_F(TraceBenchmark, Scope) (benchmark::State& state) {
+	core::TraceRecorder recorder;
+	core::TraceRecorder* old = core::traceRecorderSet(state.range(0) != 0 ? &recorder : nullptr);
+	for (auto _ : state) {
+		core_trace_scoped(TraceBenchmarkScope);
+	}
+	core::traceRecorderSet(old);
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_DEFINE_F(TraceBenchmark, ChromeTrace) (benchmark::State& state) {
+	core::TraceRecorder recorder;
+	for (int i = 0; i < 16384; ++i) {
+		recorder.begin("TraceBenchmarkScope");
+		recorder.end();
+	}
+	for (auto _ : state) {
+		const core::String& json = recorder.chromeTrace(3600.0);
+		benchmark::DoNotOptimize(json.c_str());
+	}
+	state.SetItemsProcessed(state.iterations() * 16384);
+}
+
+BENCHMARK_REGISTER_F(TraceBenchmark, Scope)->Arg(0)->Arg(1);
+BENCHMARK_REGISTER_F(TraceBenchmark, ChromeTrace);
@@ -0,0 +1,495 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/collection/Map.h"
+#include "core/Assert.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <initializer_list>
+#include <new>
+#include <utility>
+#include <SDL_stdinc.h>
+#include <SDL_endian.h>
+
+namespace core {
+
+/**
+ * @brief Open addressing hash map that grows with the amount of entries
+ *
+ * Each slot has a control byte that is either empty, deleted or holds the lower 7 bits of the hash
+ * of the key (the layout of the swiss tables). The lookup compares the control bytes of 8 slots at once
+ * and only compares the keys of the slots whose 7 bits match.
+ *
+ * The api is the same as for @c core::Map - but there is no max size. Removing an entry
+ * doesn't move any other entry - so iterators stay valid and you can remove the current entry while
+ * iterating. Inserting might rehash the map and invalidates all iterators.
+ *
+ * @note The hasher doesn't need to distribute the bits well - the hash is mixed before it is used.
+ * @sa core::Map
+ * @ingroup Collections
+ */
+template<typename KEYTYPE, typename VALUETYPE, typename HASHER = priv::DefaultHasher, typename COMPARE = priv::EqualCompare>
+class HashMap {
+public:
+	using value_type = VALUETYPE;
+	using key_type = KEYTYPE;
+
+	struct KeyValue {
+		inline KeyValue(const KEYTYPE& _key, const VALUETYPE& _value) :
+				key(_key), value(_value), first(key), second(value) {
+		}
+
+		inline KeyValue(const KEYTYPE& _key, VALUETYPE&& _value) :
+				key(_key), value(std::move(_value)), first(key), second(value) {
+		}
+
+		inline KeyValue(KeyValue &&other) :
+				key(std::move(other.key)), value(std::move(other.value)), first(key), second(value) {
+		}
+
+		KEYTYPE key;
+		VALUETYPE value;
+		const KEYTYPE &first;
+		const VALUETYPE &second;
+	};
+
+private:
+	using ctrl_t = int8_t;
+	static constexpr ctrl_t Empty = -128;
+	static constexpr ctrl_t Deleted = -2;
+	static constexpr size_t GroupWidth = 8u;
+	static constexpr size_t MinCapacity = 8u;
+	static constexpr uint64_t Lsbs = 0x0101010101010101ull;
+	static constexpr uint64_t Msbs = 0x8080808080808080ull;
+
+	// capacity + GroupWidth control bytes - the first GroupWidth bytes are cloned at the end to
+	// be able to load a full group at each position
+	ctrl_t *_ctrl = nullptr;
+	KeyValue *_slots = nullptr;
+	size_t _capacity = 0u;
+	size_t _size = 0u;
+	// the amount of entries that can be added before a rehash is needed - deleted slots are not reused
+	// by this counter
+	size_t _growthLeft = 0u;
+	HASHER _hasher;
+
+	static inline bool isFull(ctrl_t c) {
+		return c >= 0;
+	}
+
+	static inline size_t maxLoad(size_t capacity) {
+		return capacity - capacity / 8u;
+	}
+
+	inline size_t hash(const KEYTYPE& key) const {
+		// murmur3 finalizer - the default hasher is the identity
+		uint64_t h = (uint64_t)_hasher(key);
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ull;
+		h ^= h >> 33;
+		return (size_t)h;
+	}
+
+	static inline ctrl_t h2(size_t hash) {
+		return (ctrl_t)(hash & 0x7F);
+	}
+
+	static inline size_t h1(size_t hash) {
+		return hash >> 7;
+	}
+
+	inline uint64_t group(size_t pos) const {
+		uint64_t g;
+		memcpy(&g, _ctrl + pos, sizeof(g));
+		return SDL_SwapLE64(g);
+	}
+
+	// bitmask with the high bit set for each byte that matches - might have false positives
+	// which are filtered by comparing the key
+	static inline uint64_t match(uint64_t g, ctrl_t h) {
+		const uint64_t x = g ^ (Lsbs * (uint8_t)h);
+		return (x - Lsbs) & ~x & Msbs;
+	}
+
+	static inline uint64_t matchEmpty(uint64_t g) {
+		return (g & ~(g << 6)) & Msbs;
+	}
+
+	static inline uint64_t matchEmptyOrDeleted(uint64_t g) {
+		return (g & ~(g << 7)) & Msbs;
+	}
+
+	static inline size_t countTrailingBytes(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+		return (size_t)__builtin_ctzll(mask) / 8u;
+#else
+		size_t n = 0u;
+		while ((mask & 0xFFu) == 0u) {
+			mask >>= 8;
+			++n;
+		}
+		return n;
+#endif
+	}
+
+	inline void setCtrl(size_t i, ctrl_t c) {
+		_ctrl[i] = c;
+		if (i < GroupWidth) {
+			_ctrl[_capacity + i] = c;
+		}
+	}
+
+	size_t findIndex(const KEYTYPE& key, size_t hashValue) const {
+		if (_capacity == 0u) {
+			return _capacity;
+		}
+		const size_t mask = _capacity - 1u;
+		const ctrl_t h = h2(hashValue);
+		size_t pos = h1(hashValue) & mask;
+		size_t step = 0u;
+		for (;;) {
+			const uint64_t g = group(pos);
+			for (uint64_t m = match(g, h); m != 0u; m &= m - 1u) {
+				const size_t i = (pos + countTrailingBytes(m)) & mask;
+				// the group match might report false positives for non full slots
+				if (_ctrl[i] == h && COMPARE()(_slots[i].key, key)) {
+					return i;
+				}
+			}
+			if (matchEmpty(g) != 0u) {
+				return _capacity;
+			}
+			step += GroupWidth;
+			pos = (pos + step) & mask;
+			if (step > _capacity) {
+				return _capacity;
+			}
+		}
+	}
+
+	size_t findInsertSlot(size_t hashValue) const {
+		const size_t mask = _capacity - 1u;
+		size_t pos = h1(hashValue) & mask;
+		size_t step = 0u;
+		for (;;) {
+			const uint64_t m = matchEmptyOrDeleted(group(pos));
+			if (m != 0u) {
+				return (pos + countTrailingBytes(m)) & mask;
+			}
+			step += GroupWidth;
+			pos = (pos + step) & mask;
+		}
+	}
+
+	void allocate(size_t capacity) {
+		_capacity = capacity;
+		_ctrl = (ctrl_t*)SDL_malloc(_capacity + GroupWidth);
+		SDL_memset(_ctrl, (uint8_t)Empty, _capacity + GroupWidth);
+		_slots = (KeyValue*)SDL_malloc(sizeof(KeyValue) * _capacity);
+		_growthLeft = maxLoad(_capacity);
+	}
+
+	void release() {
+		SDL_free(_ctrl);
+		SDL_free(_slots);
+		_ctrl = nullptr;
+		_slots = nullptr;
+		_capacity = 0u;
+		_growthLeft = 0u;
+	}
+
+	void rehash(size_t capacity) {
+		ctrl_t *oldCtrl = _ctrl;
+		KeyValue *oldSlots = _slots;
+		const size_t oldCapacity = _capacity;
+		allocate(capacity);
+		for (size_t i = 0u; i < oldCapacity; ++i) {
+			if (!isFull(oldCtrl[i])) {
+				continue;
+			}
+			KeyValue &kv = oldSlots[i];
+			const size_t hashValue = hash(kv.key);
+			const size_t target = findInsertSlot(hashValue);
+			setCtrl(target, h2(hashValue));
+			new (&_slots[target]) KeyValue(std::move(kv));
+			kv.~KeyValue();
+		}
+		_growthLeft -= _size;
+		SDL_free(oldCtrl);
+		SDL_free(oldSlots);
+	}
+
+	// makes sure there is room for one more entry
+	void prepareInsert() {
+		if (_growthLeft > 0u) {
+			return;
+		}
+		if (_capacity == 0u) {
+			allocate(MinCapacity);
+			return;
+		}
+		// if enough of the used slots are deleted, just clean them up instead of growing
+		if (_size * 32u <= _capacity * 25u) {
+			rehash(_capacity);
+		} else {
+			rehash(_capacity * 2u);
+		}
+	}
+
+	template<typename V>
+	void insert(const KEYTYPE& key, V&& value) {
+		size_t hashValue = hash(key);
+		const size_t index = findIndex(key, hashValue);
+		if (index != _capacity) {
+			_slots[index].value = std::forward<V>(value);
+			return;
+		}
+		prepareInsert();
+		const size_t target = findInsertSlot(hashValue);
+		if (_ctrl[target] == Empty) {
+			--_growthLeft;
+		}
+		setCtrl(target, h2(hashValue));
+		new (&_slots[target]) KeyValue(key, std::forward<V>(value));
+		++_size;
+	}
+
+	void copyFrom(const HashMap& other) {
+		reserve(other.size());
+		for (auto i = other.begin(); i != other.end(); ++i) {
+			put(i->key, i->value);
+		}
+	}
+
+public:
+	HashMap(std::initializer_list<KeyValue> other) {
+		reserve(other.size());
+		for (auto i = other.begin(); i != other.end(); ++i) {
+			put(i->key, i->value);
+		}
+	}
+
+	/**
+	 * @param[in] initialSize The amount of entries that can be added without a rehash
+	 */
+	HashMap(size_t initialSize = 0u) {
+		reserve(initialSize);
+	}
+
+	HashMap(const HashMap& other) : _hasher(other._hasher) {
+		copyFrom(other);
+	}
+
+	HashMap(HashMap&& other) noexcept :
+			_ctrl(other._ctrl), _slots(other._slots), _capacity(other._capacity), _size(other._size),
+			_growthLeft(other._growthLeft), _hasher(other._hasher) {
+		other._ctrl = nullptr;
+		other._slots = nullptr;
+		other._capacity = 0u;
+		other._size = 0u;
+		other._growthLeft = 0u;
+	}
+
+	~HashMap() {
+		clear();
+		release();
+	}
+
+	HashMap& operator=(const HashMap& other) {
+		if (this != &other) {
+			clear();
+			_hasher = other._hasher;
+			copyFrom(other);
+		}
+		return *this;
+	}
+
+	HashMap& operator=(HashMap&& other) noexcept {
+		if (this != &other) {
+			clear();
+			release();
+			std::swap(_ctrl, other._ctrl);
+			std::swap(_slots, other._slots);
+			std::swap(_capacity, other._capacity);
+			std::swap(_size, other._size);
+			std::swap(_growthLeft, other._growthLeft);
+			// the slots were placed with the hasher of the other map
+			std::swap(_hasher, other._hasher);
+		}
+		return *this;
+	}
+
+	class iterator {
+	private:
+		const HashMap* _map;
+		size_t _index;
+
+		inline void skip() {
+			while (_index < _map->_capacity && !isFull(_map->_ctrl[_index])) {
+				++_index;
+			}
+			if (_index >= _map->_capacity) {
+				_map = nullptr;
+				_index = 0u;
+			}
+		}
+	public:
+		constexpr iterator() :
+			_map(nullptr), _index(0u) {
+		}
+
+		iterator(const HashMap* map, size_t index) :
+				_map(map), _index(index) {
+			skip();
+		}
+
+		inline KeyValue* operator*() const {
+			return &_map->_slots[_index];
+		}
+
+		iterator& operator++() {
+			++_index;
+			skip();
+			return *this;
+		}
+
+		iterator operator++(int) {
+			iterator copy = *this;
+			++(*this);
+			return copy;
+		}
+
+		inline KeyValue* operator->() const {
+			return &_map->_slots[_index];
+		}
+
+		inline bool operator!=(const iterator& rhs) const {
+			return _map != rhs._map || _index != rhs._index;
+		}
+
+		inline bool operator==(const iterator& rhs) const {
+			return _map == rhs._map && _index == rhs._index;
+		}
+	};
+
+	inline size_t size() const {
+		return _size;
+	}
+
+	inline bool empty() const {
+		return _size == 0u;
+	}
+
+	/**
+	 * @return The amount of slots - not all of them can be used before the map is growing
+	 */
+	inline size_t capacity() const {
+		return _capacity;
+	}
+
+	/**
+	 * @brief Makes sure that the given amount of entries fits into the map without a rehash
+	 */
+	void reserve(size_t entries) {
+		if (entries == 0u) {
+			return;
+		}
+		size_t capacity = MinCapacity;
+		while (maxLoad(capacity) < entries) {
+			capacity *= 2u;
+		}
+		if (capacity <= _capacity) {
+			return;
+		}
+		if (_capacity == 0u) {
+			allocate(capacity);
+			return;
+		}
+		rehash(capacity);
+	}
+
+	bool get(const KEYTYPE& key, VALUETYPE& value) const {
+		const size_t index = findIndex(key, hash(key));
+		if (index == _capacity) {
+			return false;
+		}
+		value = _slots[index].value;
+		return true;
+	}
+
+	inline bool hasKey(const KEYTYPE& key) const {
+		return findIndex(key, hash(key)) != _capacity;
+	}
+
+	iterator find(const KEYTYPE& key) const {
+		const size_t index = findIndex(key, hash(key));
+		if (index == _capacity) {
+			return end();
+		}
+		return iterator(this, index);
+	}
+
+	void emplace(const KEYTYPE& key, VALUETYPE&& value) {
+		insert(key, std::move(value));
+	}
+
+	void put(const KEYTYPE& key, const VALUETYPE& value) {
+		insert(key, value);
+	}
+
+	iterator begin() const {
+		if (_size == 0u) {
+			return end();
+		}
+		return iterator(this, 0u);
+	}
+
+	constexpr iterator end() const {
+		return iterator();
+	}
+
+	void clear() {
+		if (_size > 0u) {
+			for (size_t i = 0u; i < _capacity; ++i) {
+				if (isFull(_ctrl[i])) {
+					_slots[i].~KeyValue();
+				}
+			}
+		}
+		if (_capacity > 0u) {
+			SDL_memset(_ctrl, (uint8_t)Empty, _capacity + GroupWidth);
+			_growthLeft = maxLoad(_capacity);
+		}
+		_size = 0u;
+	}
+
+	/**
+	 * @note The iterator stays valid - you can increment it to get the next entry
+	 */
+	inline void erase(const iterator& iter) {
+		const size_t index = (size_t)(*iter - _slots);
+		core_assert(index < _capacity && isFull(_ctrl[index]));
+		_slots[index].~KeyValue();
+		setCtrl(index, Deleted);
+		--_size;
+	}
+
+	bool remove(const KEYTYPE& key) {
+		const size_t index = findIndex(key, hash(key));
+		if (index == _capacity) {
+			return false;
+		}
+		_slots[index].~KeyValue();
+		setCtrl(index, Deleted);
+		--_size;
+		return true;
+	}
+};
+
+}
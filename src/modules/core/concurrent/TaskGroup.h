@@ -0,0 +1,98 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/concurrent/ThreadPool.h"
+#include "core/Common.h"
+#include "core/NonCopyable.h"
+#include <atomic>
+#include <thread>
+
+namespace core {
+
+/**
+ * @brief Fork/join helper for the @c ThreadPool without a @c std::future per task
+ *
+ * @code
+ * core::TaskGroup group(threadPool);
+ * group.spawn([&] () { ... });
+ * group.spawn([&] () { ... });
+ * group.wait();
+ * @endcode
+ *
+ * @note The waiting thread executes pending tasks of the pool - so groups can be nested within the tasks
+ * of the same pool without blocking the workers.
+ */
+class TaskGroup : public core::NonCopyable {
+private:
+	ThreadPool& _threadPool;
+	std::atomic_int _pending { 0 };
+
+public:
+	TaskGroup(ThreadPool& threadPool) :
+			_threadPool(threadPool) {
+	}
+
+	~TaskGroup() {
+		wait();
+	}
+
+	/**
+	 * @brief Schedules the functor in the pool - if the pool was already shut down, the functor
+	 * is executed in the calling thread.
+	 */
+	template<class F>
+	void spawn(F&& f) {
+		++_pending;
+		ThreadPool::Task task([this, f = std::forward<F>(f)] () mutable {
+			f();
+			--_pending;
+		});
+		if (!_threadPool.schedule(task)) {
+			task();
+		}
+	}
+
+	/**
+	 * @brief Blocks until all spawned tasks are done and helps to execute the pending tasks of the pool
+	 */
+	void wait() {
+		while (_pending > 0) {
+			if (!_threadPool.runPendingTask()) {
+				std::this_thread::yield();
+			}
+		}
+	}
+};
+
+/**
+ * @brief Splits the range [start, end) into chunks and executes them in the pool
+ * @param func The functor that is called with the chunk range: @c func(int start, int end)
+ * @param grainSize The amount of elements per chunk - if @c 0 the range is split into four chunks per thread
+ */
+template<class F>
+void parallelFor(ThreadPool& threadPool, int start, int end, const F& func, int grainSize = 0) {
+	const int n = end - start;
+	if (n <= 0) {
+		return;
+	}
+	if (grainSize <= 0) {
+		grainSize = core_max(1, n / (int)(core_max((size_t)1u, threadPool.size()) * 4u));
+	}
+	if (grainSize >= n) {
+		func(start, end);
+		return;
+	}
+	TaskGroup group(threadPool);
+	for (int i = start; i < end; i += grainSize) {
+		const int chunkEnd = core_min(end, i + grainSize);
+		group.spawn([&func, i, chunkEnd] () {
+			func(i, chunkEnd);
+		});
+	}
+	group.wait();
+}
+
+}
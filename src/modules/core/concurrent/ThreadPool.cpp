@@ -3,14 +3,88 @@
  */
 
 #include "ThreadPool.h"
+#include "core/Common.h"
 #include "core/StringUtil.h"
 #include "core/Trace.h"
 #include "core/concurrent/Concurrency.h"
 
 namespace core {
 
+/**
+ * @brief Growing ring buffer of tasks that can be used as stack and as queue
+ * @note Not thread safe
+ */
+class ThreadPool::TaskQueue {
+private:
+	std::vector<Task> _tasks;
+	// monotonic positions of the first and behind the last task
+	size_t _head = 0u;
+	size_t _tail = 0u;
+
+	void grow() {
+		const size_t size = _tail - _head;
+		std::vector<Task> tasks(core_max((size_t)64u, _tasks.size() * 2u));
+		for (size_t i = 0u; i < size; ++i) {
+			tasks[i] = std::move(_tasks[(_head + i) & (_tasks.size() - 1u)]);
+		}
+		_tasks = std::move(tasks);
+		_head = 0u;
+		_tail = size;
+	}
+public:
+	inline bool empty() const {
+		return _head == _tail;
+	}
+
+	void push(Task& task) {
+		if (_tail - _head == _tasks.size()) {
+			grow();
+		}
+		_tasks[_tail & (_tasks.size() - 1u)] = std::move(task);
+		++_tail;
+	}
+
+	bool popBack(Task& task) {
+		if (empty()) {
+			return false;
+		}
+		--_tail;
+		task = std::move(_tasks[_tail & (_tasks.size() - 1u)]);
+		return true;
+	}
+
+	bool popFront(Task& task) {
+		if (empty()) {
+			return false;
+		}
+		task = std::move(_tasks[_head & (_tasks.size() - 1u)]);
+		++_head;
+		return true;
+	}
+
+	void clear() {
+		for (Task& task : _tasks) {
+			task.reset();
+		}
+		_head = _tail = 0u;
+	}
+};
+
+struct ThreadPool::Worker {
+	core_trace_mutex(core::Lock, lock, "ThreadPoolWorker");
+	TaskQueue tasks;
+};
+
+namespace {
+
+// the pool and the worker index of the current thread - used to push tasks to the deque of the worker
+thread_local const ThreadPool* _currentPool = nullptr;
+thread_local int _currentWorker = -1;
+
+}
+
 ThreadPool::ThreadPool(size_t threads, const char *name) :
-		_threads(threads), _name(name) {
+		_threads(threads), _name(name), _tasks(new TaskQueue()) {
 	if (_name == nullptr) {
 		_name = "ThreadPool";
 	}
@@ -20,48 +94,122 @@ void ThreadPool::init() {
 	_force = false;
 	_stop = false;
 	_workers.reserve(_threads);
+	_workerQueues.clear();
+	for (size_t i = 0; i < _threads; ++i) {
+		_workerQueues.emplace_back(new Worker());
+	}
 	for (size_t i = 0; i < _threads; ++i) {
 		_workers.emplace_back([this, i] {
-			const core::String n = core::string::format("%s-%i", this->_name, (int)i);
-			if (!setThreadName(n.c_str())) {
-				Log::error("Failed to set thread name for pool thread %i", (int)i);
-			}
-			core_trace_thread(n.c_str());
-			for (;;) {
-				std::function<void()> task;
-				{
-					core::ScopedLock lock(this->_queueMutex);
-					if (!this->_stop) {
-						this->_queueCondition.wait(this->_queueMutex, [this] {
-							// predicate must return false if the waiting should continue
-							if (this->_stop) {
-								return true;
-							}
-							if (!this->_tasks.empty()) {
-								return true;
-							}
-							return false;
-						});
-					}
-					if (this->_stop && (this->_force || this->_tasks.empty())) {
-						Log::debug(logid, "Shutdown worker thread for %i", (int)getThreadId());
-						break;
-					}
-					task = std::move(this->_tasks.front());
-					this->_tasks.pop();
-				}
-
-				core_trace_begin_frame(n.c_str());
-				core_trace_scoped(ThreadPoolWorker);
-				Log::debug(logid, "Execute task in %i", (int)getThreadId());
-				task();
-				Log::debug(logid, "End of task in %i", (int)getThreadId());
-				core_trace_end_frame(n.c_str());
-			}
+			run((int)i);
 		});
 	}
 }
 
+void ThreadPool::run(int workerIndex) {
+	const core::String n = core::string::format("%s-%i", _name, workerIndex);
+	if (!setThreadName(n.c_str())) {
+		Log::error("Failed to set thread name for pool thread %i", workerIndex);
+	}
+	core_trace_thread(n.c_str());
+	_currentPool = this;
+	_currentWorker = workerIndex;
+	for (;;) {
+		if (_stop && _force) {
+			break;
+		}
+		Task task;
+		if (pop(workerIndex, task)) {
+			core_trace_begin_frame(n.c_str());
+			core_trace_scoped(ThreadPoolWorker);
+			Log::debug(logid, "Execute task in %i", (int)getThreadId());
+			task();
+			Log::debug(logid, "End of task in %i", (int)getThreadId());
+			core_trace_end_frame(n.c_str());
+			continue;
+		}
+		core::ScopedLock lock(_queueMutex);
+		if (_stop && (_force || _pending == 0)) {
+			break;
+		}
+		if (_pending > 0) {
+			// a task is about to be pushed or popped by another thread
+			continue;
+		}
+		++_sleeping;
+		_queueCondition.wait(_queueMutex, [this] {
+			// predicate must return false if the waiting should continue
+			return _stop || _pending > 0;
+		});
+		--_sleeping;
+	}
+	Log::debug(logid, "Shutdown worker thread for %i", (int)getThreadId());
+	_currentPool = nullptr;
+	_currentWorker = -1;
+}
+
+bool ThreadPool::schedule(Task& task) {
+	if (_stop) {
+		return false;
+	}
+	// increase before the push - a worker might pop the task before we are done here
+	++_pending;
+	if (_currentPool == this) {
+		Worker& worker = *_workerQueues[_currentWorker];
+		core::ScopedLock lock(worker.lock);
+		worker.tasks.push(task);
+	} else {
+		core::ScopedLock lock(_tasksMutex);
+		_tasks->push(task);
+	}
+	if (_sleeping > 0) {
+		core::ScopedLock lock(_queueMutex);
+		_queueCondition.notify_one();
+	}
+	return true;
+}
+
+bool ThreadPool::pop(int workerIndex, Task& task) {
+	if (_pending <= 0) {
+		return false;
+	}
+	bool found = false;
+	if (workerIndex >= 0) {
+		// the newest task of the own deque is most likely still in the cache
+		Worker& worker = *_workerQueues[workerIndex];
+		core::ScopedLock lock(worker.lock);
+		found = worker.tasks.popBack(task);
+	}
+	if (!found) {
+		core::ScopedLock lock(_tasksMutex);
+		found = _tasks->popFront(task);
+	}
+	// steal the oldest task of another worker
+	const int workers = (int)_workerQueues.size();
+	for (int i = 1; !found && i <= workers; ++i) {
+		const int victim = (workerIndex + i) % workers;
+		if (victim == workerIndex) {
+			continue;
+		}
+		Worker& worker = *_workerQueues[victim];
+		core::ScopedLock lock(worker.lock);
+		found = worker.tasks.popFront(task);
+	}
+	if (found) {
+		--_pending;
+	}
+	return found;
+}
+
+bool ThreadPool::runPendingTask() {
+	Task task;
+	const int workerIndex = _currentPool == this ? _currentWorker : -1;
+	if (!pop(workerIndex, task)) {
+		return false;
+	}
+	task();
+	return true;
+}
+
 ThreadPool::~ThreadPool() {
 	shutdown();
 }
@@ -71,12 +219,25 @@ void ThreadPool::shutdown(bool wait) {
 		return;
 	}
 	_force = !wait;
-	_stop = true;
-	_queueCondition.notify_all();
+	{
+		core::ScopedLock lock(_queueMutex);
+		_stop = true;
+		_queueCondition.notify_all();
+	}
 	for (std::thread &worker : _workers) {
 		worker.join();
 	}
 	_workers.clear();
+	// the tasks that were not executed because of a forced shutdown
+	{
+		core::ScopedLock lock(_tasksMutex);
+		_tasks->clear();
+	}
+	for (const std::unique_ptr<Worker>& worker : _workerQueues) {
+		core::ScopedLock lock(worker->lock);
+		worker->tasks.clear();
+	}
+	_pending = 0;
 }
 
 }
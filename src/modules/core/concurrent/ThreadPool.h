@@ -28,11 +28,13 @@
 #pragma once
 
 #include <vector>
-#include <queue>
 #include <memory>
 #include <thread>
 #include <future>
 #include <functional>
+#include <atomic>
+#include <new>
+#include <type_traits>
 #include "core/concurrent/Atomic.h"
 #include "core/concurrent/Lock.h"
 #include "core/concurrent/ConditionVariable.h"
@@ -41,35 +43,184 @@
 
 namespace core {
 
+/**
+ * @brief Work stealing thread pool
+ *
+ * Each worker has its own task deque. Tasks that are scheduled from within a worker are pushed to the
+ * deque of that worker - all other tasks are pushed to a shared queue. An idle worker takes the newest task
+ * of its own deque, then the oldest task of the shared queue and then steals the oldest task of the other workers.
+ *
+ * Use @c schedule() or a @c TaskGroup for fan-out work - there is no @c std::future and no heap allocation for
+ * small functors. @c enqueue() is the convenience version that returns a @c std::future.
+ *
+ * @sa TaskGroup
+ */
 class ThreadPool final {
 private:
 	static constexpr auto logid = Log::logid("ThreadPool");
 public:
+	/**
+	 * @brief Move only type erased functor - small functors are stored inline without a heap allocation
+	 */
+	class Task {
+	private:
+		enum class Op { Invoke, Move, Destroy };
+		using Ops = void (*)(Op op, Task *self, Task *other);
+		static constexpr size_t InlineSize = 48u;
+		alignas(16) uint8_t _storage[InlineSize];
+		Ops _ops = nullptr;
+
+		template<class F>
+		static constexpr bool fitsInline() {
+			return sizeof(F) <= InlineSize && alignof(F) <= 16u && std::is_nothrow_move_constructible<F>::value;
+		}
+
+		template<class F>
+		static void ops(Op op, Task *self, Task *other) {
+			if constexpr (fitsInline<F>()) {
+				F *f = (F*)self->_storage;
+				switch (op) {
+				case Op::Invoke:
+					(*f)();
+					break;
+				case Op::Move:
+					new (self->_storage) F(std::move(*(F*)other->_storage));
+					((F*)other->_storage)->~F();
+					break;
+				case Op::Destroy:
+					f->~F();
+					break;
+				}
+			} else {
+				F **f = (F**)self->_storage;
+				switch (op) {
+				case Op::Invoke:
+					(**f)();
+					break;
+				case Op::Move:
+					*f = *(F**)other->_storage;
+					break;
+				case Op::Destroy:
+					delete *f;
+					break;
+				}
+			}
+		}
+
+		void moveFrom(Task& other) {
+			if (other._ops != nullptr) {
+				other._ops(Op::Move, this, &other);
+				_ops = other._ops;
+				other._ops = nullptr;
+			}
+		}
+	public:
+		Task() {
+		}
+
+		template<class F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, Task>::value>::type>
+		Task(F&& f) {
+			using Functor = typename std::decay<F>::type;
+			if constexpr (fitsInline<Functor>()) {
+				new (_storage) Functor(std::forward<F>(f));
+			} else {
+				*(Functor**)_storage = new Functor(std::forward<F>(f));
+			}
+			_ops = &ops<Functor>;
+		}
+
+		Task(Task&& other) {
+			moveFrom(other);
+		}
+
+		Task& operator=(Task&& other) {
+			if (this != &other) {
+				reset();
+				moveFrom(other);
+			}
+			return *this;
+		}
+
+		Task(const Task&) = delete;
+		Task& operator=(const Task&) = delete;
+
+		~Task() {
+			reset();
+		}
+
+		inline void operator()() {
+			_ops(Op::Invoke, this, nullptr);
+		}
+
+		inline explicit operator bool() const {
+			return _ops != nullptr;
+		}
+
+		void reset() {
+			if (_ops != nullptr) {
+				_ops(Op::Destroy, this, nullptr);
+				_ops = nullptr;
+			}
+		}
+	};
+
 	explicit ThreadPool(size_t, const char *name = nullptr);
 	~ThreadPool();
 
 	/**
 	 * Enqueue functors or lambdas into the thread pool
+	 * @note This allocates a shared state for the returned future - use @c schedule() or a @c TaskGroup
+	 * if you don't need the return value.
 	 */
 	template<class F, class ... Args>
 	auto enqueue(F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type>;
 
+	/**
+	 * @brief Schedules the task without creating a future
+	 * @return @c false if the pool was shut down - the task is not executed in this case and left untouched
+	 */
+	bool schedule(Task& task);
+	template<class F>
+	bool schedule(F&& f);
+
+	/**
+	 * @brief Executes one pending task in the calling thread
+	 *
+	 * Threads that are waiting for other tasks can help out instead of blocking a worker - this
+	 * makes nested fork/join possible (see @c TaskGroup::wait()).
+	 *
+	 * @return @c false if there was no pending task
+	 */
+	bool runPendingTask();
+
 	size_t size() const;
 	void init();
 	void shutdown(bool wait = false);
 private:
+	class TaskQueue;
+	struct Worker;
+
 	const size_t _threads;
 	const char *_name;
 	// need to keep track of threads so we can join them
 	std::vector<std::thread> _workers;
-	// the task queue
-	std::queue<std::function<void()> > _tasks;
-
-	// synchronization
+	// the task deques of the workers - the index is the worker index
+	std::vector<std::unique_ptr<Worker>> _workerQueues;
+	// the tasks that are scheduled from outside of the workers
+	std::unique_ptr<TaskQueue> _tasks;
+	core_trace_mutex(core::Lock, _tasksMutex, "ThreadPoolTasks");
+	// the amount of tasks in all queues
+	std::atomic_int _pending { 0 };
+
+	// synchronization of the idle workers
 	core_trace_mutex(core::Lock, _queueMutex, "ThreadPoolQueue");
 	core::ConditionVariable _queueCondition;
+	std::atomic_int _sleeping { 0 };
 	core::AtomicBool _stop { false };
 	core::AtomicBool _force { false };
+
+	bool pop(int workerIndex, Task& task);
+	void run(int workerIndex);
 };
 
 // add new work item to the pool
@@ -81,20 +232,21 @@ auto ThreadPool::enqueue(F&& f, Args&&... args)
 		return std::future<return_type>();
 	}
 
-	auto task = std::make_shared<std::packaged_task<return_type()> >(std::bind(std::forward<F>(f), std::forward<Args>(args)...));
-
-	std::future<return_type> res = task->get_future();
-	{
-		std::unique_lock lock(_queueMutex);
-		if (_stop) {
-			return std::future<return_type>();
-		}
-		_tasks.emplace([task]() {(*task)();});
+	std::packaged_task<return_type()> packagedTask(std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+	std::future<return_type> res = packagedTask.get_future();
+	Task task(std::move(packagedTask));
+	if (!schedule(task)) {
+		return std::future<return_type>();
 	}
-	_queueCondition.notify_one();
 	return res;
 }
 
+template<class F>
+bool ThreadPool::schedule(F&& f) {
+	Task task(std::forward<F>(f));
+	return schedule(task);
+}
+
 inline size_t ThreadPool::size() const {
 	return _threads;
 }
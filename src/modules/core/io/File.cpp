@@ -19,6 +19,11 @@ File::File(const core::String& rawPath, FileMode mode) :
 	_file = createRWops(mode);
 }
 
+File::File(const core::String& rawPath, SDL_RWops* rwops) :
+		IOResource(), _file(rwops), _rawPath(rawPath), _mode(FileMode::Read) {
+	normalizePath(_rawPath);
+}
+
 File::~File() {
 	close();
 }
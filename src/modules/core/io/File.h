@@ -35,6 +35,10 @@ protected:
 	FileMode _mode;
 
 	File(const core::String& rawPath, FileMode mode);
+	/**
+	 * @brief Read only file that reads from the given rwops - the file takes the ownership of the rwops
+	 */
+	File(const core::String& rawPath, SDL_RWops* rwops);
 public:
 	virtual ~File();
 
@@ -7,21 +7,70 @@
 #include "core/io/File.h"
 #include "core/Assert.h"
 #include "core/Log.h"
+#include "core/StandardLib.h"
 #include <stdarg.h>
+#include <atomic>
 
 namespace io {
 
+static std::atomic<size_t> _defaultReadBufferSize { FileStream::DefaultReadBufferSize };
+
+void FileStream::setDefaultReadBufferSize(size_t size) {
+	_defaultReadBufferSize = size;
+}
+
 FileStream::FileStream(File* file) :
 		FileStream(file->_file) {
 }
 
 FileStream::FileStream(SDL_RWops* rwops) :
-		_rwops(rwops) {
+		_rwops(rwops), _bufferCapacity(_defaultReadBufferSize) {
 	core_assert(rwops != nullptr);
 	_size = SDL_RWsize(_rwops);
+	if (_bufferCapacity > 0u && (_rwops->type == SDL_RWOPS_MEMORY || _rwops->type == SDL_RWOPS_MEMORY_RO)) {
+		_buffer = _rwops->hidden.mem.base;
+		_bufferSize = (int64_t)(_rwops->hidden.mem.stop - _rwops->hidden.mem.base);
+		_ownsBuffer = false;
+	}
 }
 
 FileStream::~FileStream() {
+	if (_ownsBuffer) {
+		core_free(_buffer);
+	}
+}
+
+size_t FileStream::readRaw(int64_t pos, uint8_t *buf, size_t bufSize) const {
+	SDL_RWseek(_rwops, pos, RW_SEEK_SET);
+	size_t completeBytesRead = 0;
+	size_t bytesRead = 1;
+	while (completeBytesRead < bufSize && bytesRead != 0) {
+		bytesRead = SDL_RWread(_rwops, buf + completeBytesRead, 1, bufSize - completeBytesRead);
+		completeBytesRead += bytesRead;
+	}
+	return completeBytesRead;
+}
+
+int FileStream::peekSlow(void *buf, size_t bufSize) const {
+	if (!_ownsBuffer || _bufferCapacity < bufSize) {
+		if (readRaw(_pos, (uint8_t*)buf, bufSize) != bufSize) {
+			return -1;
+		}
+		return 0;
+	}
+	if (_buffer == nullptr) {
+		// don't allocate more than needed for small files
+		_bufferCapacity = core_min(_bufferCapacity, (size_t)core_max(_size, (int64_t)bufSize));
+		_buffer = (uint8_t*)core_malloc(_bufferCapacity);
+	}
+	const size_t toRead = (size_t)core_min((int64_t)_bufferCapacity, _size - _pos);
+	_bufferOffset = _pos;
+	_bufferSize = (int64_t)readRaw(_pos, _buffer, toRead);
+	if (_bufferSize < (int64_t)bufSize) {
+		return -1;
+	}
+	memcpy(buf, _buffer, bufSize);
+	return 0;
 }
 
 int FileStream::peekInt(uint32_t& val) const {
@@ -220,10 +269,26 @@ int FileStream::readInt(uint32_t& val) {
 }
 
 int FileStream::readBuf(uint8_t *buf, size_t bufSize) {
-	for (size_t i = 0; i < bufSize; ++i) {
-		if (readByte(buf[i]) != 0) {
+	if (remaining() < (int64_t)bufSize) {
+		return -1;
+	}
+	while (bufSize > 0u) {
+		if (_pos >= _bufferOffset && _pos < _bufferOffset + _bufferSize) {
+			const size_t n = (size_t)core_min((int64_t)bufSize, _bufferOffset + _bufferSize - _pos);
+			memcpy(buf, _buffer + (_pos - _bufferOffset), n);
+			buf += n;
+			bufSize -= n;
+			_pos += (int64_t)n;
+			continue;
+		}
+		// large reads bypass the buffer
+		const size_t n = bufSize >= _bufferCapacity ? bufSize : 1u;
+		if (peekSlow(buf, n) != 0) {
 			return -1;
 		}
+		buf += n;
+		bufSize -= n;
+		_pos += (int64_t)n;
 	}
 	return 0;
 }
@@ -239,6 +304,7 @@ int FileStream::readLong(uint64_t& val) {
 }
 
 bool FileStream::addByte(uint8_t val) {
+	invalidateReadBuffer();
 	SDL_RWseek(_rwops, _pos, RW_SEEK_SET);
 	if (SDL_RWwrite(_rwops, &val, 1, 1) != 1) {
 		return false;
@@ -251,6 +317,7 @@ bool FileStream::addByte(uint8_t val) {
 }
 
 bool FileStream::append(const uint8_t *buf, size_t size) {
+	invalidateReadBuffer();
 	SDL_RWseek(_rwops, _pos, RW_SEEK_SET);
 	size_t completeBytesWritten = 0;
 	int32_t bytesWritten = 1;
@@ -10,7 +10,9 @@
 #include <SDL_rwops.h>
 #include "core/Common.h"
 #include "core/SharedPtr.h"
+#include "core/NonCopyable.h"
 #include <limits.h>
+#include <string.h>
 
 namespace io {
 
@@ -19,19 +21,60 @@ typedef core::SharedPtr<File> FilePtr;
 
 /**
  * @brief Little endian file stream
+ *
+ * Reading is done from a read buffer that is only refilled if the requested bytes are not part of it - so
+ * reading or peeking single values doesn't seek and read on the @c SDL_RWops each time. Memory streams
+ * are read directly from their memory without any copy.
+ *
+ * @sa setDefaultReadBufferSize()
  */
-class FileStream {
+class FileStream : public core::NonCopyable {
 private:
 	int64_t _pos = 0;
 	int64_t _size = 0;
 	mutable SDL_RWops *_rwops;
 
+	// the read buffer holds the bytes [_bufferOffset, _bufferOffset + _bufferSize) of the stream
+	mutable uint8_t *_buffer = nullptr;
+	mutable int64_t _bufferOffset = 0;
+	mutable int64_t _bufferSize = 0;
+	// 0 means unbuffered - every read hits the rwops
+	mutable size_t _bufferCapacity;
+	// false if the buffer is the memory of a memory rwops
+	bool _ownsBuffer = true;
+
+	/**
+	 * @brief Reads from the rwops or refills the read buffer if the bytes are not part of the buffer
+	 */
+	int peekSlow(void *buf, size_t bufSize) const;
+	/**
+	 * @brief Seeks to the given position and reads from the rwops
+	 * @return The amount of bytes that were read
+	 */
+	size_t readRaw(int64_t pos, uint8_t *buf, size_t bufSize) const;
+
+	inline void invalidateReadBuffer() {
+		if (_ownsBuffer) {
+			_bufferSize = 0;
+		}
+	}
+
 public:
+	static constexpr size_t DefaultReadBufferSize = 64u * 1024u;
+
 	FileStream(File* file);
 	FileStream(const FilePtr& file) : FileStream(file.get()) {}
 	FileStream(SDL_RWops* rwops);
 	virtual ~FileStream();
 
+	/**
+	 * @brief Specifies the read buffer size for streams that are created after this call
+	 * @param[in] size The size in bytes - @c 0 disables the read buffer and every read will
+	 * seek and read on the rwops
+	 * @note This is mainly for benchmarking against the unbuffered reading
+	 */
+	static void setDefaultReadBufferSize(size_t size);
+
 	inline int64_t remaining() const {
 		return _size - _pos;
 	}
@@ -58,27 +101,16 @@ public:
 		if (remaining() < (int64_t)bufSize) {
 			return -1;
 		}
-		uint8_t buf[bufSize];
-		SDL_RWseek(_rwops, _pos, RW_SEEK_SET);
-		uint8_t *b = buf;
-
-		size_t completeBytesRead = 0;
-		size_t bytesRead = 1;
-		while (completeBytesRead < bufSize && bytesRead != 0) {
-			bytesRead = SDL_RWread(_rwops, b, 1, (bufSize - completeBytesRead));
-			b += bytesRead;
-			completeBytesRead += bytesRead;
-		}
-		if (completeBytesRead != bufSize) {
-			return -1;
+		if (_pos >= _bufferOffset && _pos + (int64_t)bufSize <= _bufferOffset + _bufferSize) {
+			memcpy(&val, _buffer + (_pos - _bufferOffset), bufSize);
+			return 0;
 		}
-		const Ret *word = (const Ret*) (void*) buf;
-		val = *word;
-		return 0;
+		return peekSlow(&val, bufSize);
 	}
 
 	template<class Type>
 	inline bool write(Type val) {
+		invalidateReadBuffer();
 		SDL_RWseek(_rwops, _pos, RW_SEEK_SET);
 		const size_t bufSize = sizeof(Type);
 		uint8_t buf[bufSize];
@@ -394,6 +394,12 @@ bool Filesystem::pushDir(const core::String& directory) {
 	return true;
 }
 
+io::FilePtr Filesystem::openMemory(const core::String& filename, const void* buffer, size_t size) {
+	// SDL_RWFromConstMem() would set the sdl error for an empty buffer
+	SDL_RWops* rwops = size == 0u ? nullptr : SDL_RWFromConstMem(buffer, (int)size);
+	return core::make_shared<io::File>(filename, rwops);
+}
+
 io::FilePtr Filesystem::open(const core::String& filename, FileMode mode) const {
 	if (mode == FileMode::Write) {
 		Log::debug("Use absolute path to write file %s", filename.c_str());
@@ -119,6 +119,13 @@ public:
 	bool pushDir(const core::String& directory);
 
 	io::FilePtr open(const core::String& filename, FileMode mode = FileMode::Read) const;
+	/**
+	 * @brief Wraps the given memory into a read only file
+	 * @param[in] filename The name of the file - e.g. the extension is used to detect the file format
+	 * @note The memory must stay valid as long as the file is used. The file can't get reopened.
+	 * @return An invalid file if the memory is empty
+	 */
+	static io::FilePtr openMemory(const core::String& filename, const void* buffer, size_t size);
 
 	core::String load(CORE_FORMAT_STRING const char *filename, ...) CORE_PRINTF_VARARG_FUNC(2);
 
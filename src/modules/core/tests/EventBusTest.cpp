@@ -4,6 +4,9 @@
 
 #include "core/tests/AbstractTest.h"
 #include "core/EventBus.h"
+#include <atomic>
+#include <thread>
+#include <vector>
 
 namespace core {
 
@@ -72,6 +75,147 @@ TEST_F(EventBusTest, testSubscribeAndQueuePendingLeft) {
 	ASSERT_EQ(1, handler.getCount()) << "Expected the handler to be notified once";
 }
 
+EVENTBUSPAYLOADEVENT(OrderEvent, int);
+EVENTBUSPAYLOADEVENT(OtherOrderEvent, int);
+
+class OrderHandlerTest: public IEventBusHandler<OrderEvent>, public IEventBusHandler<OtherOrderEvent> {
+public:
+	std::vector<int> order;
+
+	void onEvent(const OrderEvent& e) override {
+		order.push_back(e.get());
+	}
+
+	void onEvent(const OtherOrderEvent& e) override {
+		order.push_back(e.get());
+	}
+};
+
+TEST_F(EventBusTest, testQueueOrder) {
+	EventBus eventBus(64, 2);
+	OrderHandlerTest handler;
+	eventBus.subscribe<OrderEvent>(handler);
+	eventBus.subscribe<OtherOrderEvent>(handler);
+	const int n = 100;
+	for (int i = 0; i < n; ++i) {
+		if (i % 3 == 0) {
+			eventBus.enqueue(std::make_shared<OrderEvent>(i));
+		} else if (i % 3 == 1) {
+			eventBus.enqueue(OtherOrderEvent(i));
+		} else {
+			eventBus.enqueue(OrderEvent(i));
+		}
+	}
+	ASSERT_EQ(n, eventBus.size());
+	ASSERT_EQ(0, eventBus.update());
+	ASSERT_EQ((size_t)n, handler.order.size());
+	for (int i = 0; i < n; ++i) {
+		EXPECT_EQ(i, handler.order[i]) << "Events were not delivered in the order they were enqueued";
+	}
+}
+
+class ReenqueueHandlerTest: public IEventBusHandler<OrderEvent> {
+private:
+	EventBus& _eventBus;
+public:
+	int count = 0;
+
+	ReenqueueHandlerTest(EventBus& eventBus) : _eventBus(eventBus) {}
+
+	void onEvent(const OrderEvent& e) override {
+		++count;
+		if (e.get() > 0) {
+			// this might grow the queue while the event is handled
+			_eventBus.enqueue(OrderEvent(e.get() - 1));
+			_eventBus.enqueue(OrderEvent(0));
+		}
+	}
+};
+
+TEST_F(EventBusTest, testEnqueueFromHandler) {
+	EventBus eventBus(64, 1);
+	ReenqueueHandlerTest handler(eventBus);
+	eventBus.subscribe(handler);
+	eventBus.enqueue(OrderEvent(10));
+	ASSERT_EQ(0, eventBus.update());
+	ASSERT_EQ(21, handler.count);
+}
+
+class UnsubscribeHandlerTest: public CountHandlerTest<TestEvent> {
+private:
+	EventBus& _eventBus;
+public:
+	UnsubscribeHandlerTest(EventBus& eventBus) : _eventBus(eventBus) {}
+
+	void onEvent(const TestEvent& e) override {
+		CountHandlerTest<TestEvent>::onEvent(e);
+		_eventBus.unsubscribe(*this);
+	}
+};
+
+TEST_F(EventBusTest, testUnsubscribeFromHandler) {
+	EventBus eventBus;
+	UnsubscribeHandlerTest handler(eventBus);
+	TestEvent event;
+	eventBus.subscribe(handler);
+	ASSERT_EQ(1, eventBus.publish(event));
+	ASSERT_EQ(0, eventBus.publish(event)) << "Expected the handler to be unsubscribed";
+	ASSERT_EQ(1, handler.getCount());
+}
+
+/**
+ * @brief Detects notifications after the handler was destroyed
+ */
+class AliveHandlerTest: public IEventBusHandler<TestEvent> {
+private:
+	static constexpr uint32_t Alive = 0xA11FEu;
+	volatile uint32_t _alive = Alive;
+	std::atomic_int& _errors;
+public:
+	AliveHandlerTest(std::atomic_int& errors) : _errors(errors) {
+	}
+
+	~AliveHandlerTest() {
+		_alive = 0u;
+	}
+
+	void onEvent(const TestEvent&) override {
+		// widen the window for a concurrent unsubscribe
+		std::this_thread::yield();
+		if (_alive != Alive) {
+			++_errors;
+		}
+	}
+};
+
+TEST_F(EventBusTest, testUnsubscribeWhilePublishing) {
+	EventBus eventBus;
+	std::atomic_bool running { true };
+	std::atomic_int errors { 0 };
+	std::vector<std::thread> publishers;
+	for (int i = 0; i < 2; ++i) {
+		publishers.emplace_back([&] () {
+			TestEvent event;
+			while (running) {
+				eventBus.publish(event);
+			}
+		});
+	}
+	for (int i = 0; i < 500; ++i) {
+		AliveHandlerTest* handler = new AliveHandlerTest(errors);
+		eventBus.subscribe(*handler);
+		std::this_thread::yield();
+		ASSERT_EQ(1, eventBus.unsubscribe(*handler));
+		// no other thread may notify the handler once unsubscribe() returned
+		delete handler;
+	}
+	running = false;
+	for (std::thread& t : publishers) {
+		t.join();
+	}
+	EXPECT_EQ(0, errors.load());
+}
+
 TEST_F(EventBusTest, DISABLED_testMassSubscribeAndPublish_10000000) {
 	EventBus eventBus;
 	HandlerTest handler;
@@ -10,6 +10,11 @@
 namespace io {
 
 class FileStreamTest : public core::AbstractTest {
+public:
+	void TearDown() override {
+		FileStream::setDefaultReadBufferSize(FileStream::DefaultReadBufferSize);
+		core::AbstractTest::TearDown();
+	}
 };
 
 TEST_F(FileStreamTest, testFileStreamRead) {
@@ -70,4 +75,88 @@ TEST_F(FileStreamTest, testFileStreamWrite) {
 	EXPECT_EQ(8l, file->length());
 }
 
+TEST_F(FileStreamTest, testReadBufferBoundaries) {
+	uint8_t data[64];
+	for (int i = 0; i < (int)sizeof(data); ++i) {
+		data[i] = (uint8_t)i;
+	}
+	const io::FilesystemPtr& fs = io::filesystem();
+	const core::String path = fs->homePath() + "/filestream-buffertest";
+	const FilePtr& file = fs->open(path, io::FileMode::Write);
+	ASSERT_TRUE(file->validHandle());
+	ASSERT_EQ((long)sizeof(data), file->write(data, sizeof(data)));
+	file->close();
+
+	// the values are crossing the boundaries of the read buffer
+	for (size_t bufferSize : {0u, 3u, 7u, 64u}) {
+		FileStream::setDefaultReadBufferSize(bufferSize);
+		const FilePtr& readFile = fs->open(path);
+		FileStream stream(readFile.get());
+		uint8_t b;
+		ASSERT_EQ(0, stream.readByte(b));
+		EXPECT_EQ(0u, b);
+		uint32_t i32;
+		ASSERT_EQ(0, stream.peekInt(i32));
+		EXPECT_EQ(0x04030201u, i32) << "buffer size " << bufferSize;
+		ASSERT_EQ(0, stream.readInt(i32));
+		EXPECT_EQ(0x04030201u, i32) << "buffer size " << bufferSize;
+		uint8_t buf[20];
+		ASSERT_EQ(0, stream.readBuf(buf, sizeof(buf)));
+		for (int i = 0; i < (int)sizeof(buf); ++i) {
+			ASSERT_EQ(5 + i, buf[i]) << "buffer size " << bufferSize;
+		}
+		EXPECT_EQ(0, stream.seek(2));
+		uint16_t i16;
+		ASSERT_EQ(0, stream.readShort(i16));
+		EXPECT_EQ(0x0302u, i16) << "buffer size " << bufferSize;
+		EXPECT_EQ(56, stream.skip(52));
+		uint64_t i64;
+		ASSERT_EQ(0, stream.readLong(i64));
+		EXPECT_EQ(0x3f3e3d3c3b3a3938ull, i64) << "buffer size " << bufferSize;
+		EXPECT_EQ(0, stream.remaining());
+		EXPECT_NE(0, stream.readByte(b));
+	}
+}
+
+TEST_F(FileStreamTest, testWriteInvalidatesReadBuffer) {
+	const io::FilesystemPtr& fs = io::filesystem();
+	const core::String path = fs->homePath() + "/filestream-writereadtest";
+	SDL_RWops *rwops = SDL_RWFromFile(path.c_str(), "w+b");
+	ASSERT_NE(nullptr, rwops);
+	{
+		FileStream stream(rwops);
+		EXPECT_TRUE(stream.addInt(1));
+		EXPECT_TRUE(stream.addInt(2));
+		EXPECT_EQ(0, stream.seek(0));
+		uint32_t val;
+		EXPECT_EQ(0, stream.readInt(val));
+		EXPECT_EQ(1u, val);
+		EXPECT_EQ(0, stream.seek(0));
+		EXPECT_TRUE(stream.addInt(3));
+		EXPECT_EQ(0, stream.seek(0));
+		EXPECT_EQ(0, stream.readInt(val));
+		EXPECT_EQ(3u, val);
+		EXPECT_EQ(0, stream.readInt(val));
+		EXPECT_EQ(2u, val);
+	}
+	SDL_RWclose(rwops);
+}
+
+TEST_F(FileStreamTest, testMemoryStream) {
+	uint8_t data[] = {1, 0, 0, 0, 2, 0};
+	SDL_RWops *rwops = SDL_RWFromMem(data, sizeof(data));
+	ASSERT_NE(nullptr, rwops);
+	{
+		FileStream stream(rwops);
+		uint32_t i32;
+		EXPECT_EQ(0, stream.readInt(i32));
+		EXPECT_EQ(1u, i32);
+		uint16_t i16;
+		EXPECT_EQ(0, stream.readShort(i16));
+		EXPECT_EQ(2u, i16);
+		EXPECT_NE(0, stream.readShort(i16));
+	}
+	SDL_RWclose(rwops);
+}
+
 }
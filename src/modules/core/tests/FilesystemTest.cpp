@@ -147,4 +147,15 @@ TEST_F(FilesystemTest, testCreateDirNonRecursiveFail) {
 	fs.shutdown();
 }
 
+TEST_F(FilesystemTest, testOpenMemory) {
+	const char content[] = "content";
+	const io::FilePtr& file = io::Filesystem::openMemory("dir/memory.vox", content, sizeof(content) - 1);
+	ASSERT_TRUE(file->exists());
+	EXPECT_EQ("vox", file->extension());
+	EXPECT_EQ("memory", file->fileName());
+	EXPECT_EQ(7l, file->length());
+	EXPECT_EQ("content", file->load());
+	EXPECT_FALSE(io::Filesystem::openMemory("empty.vox", content, 0u)->exists());
+}
+
 }
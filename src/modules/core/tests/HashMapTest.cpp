@@ -0,0 +1,241 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/collection/HashMap.h"
+#include "core/String.h"
+#include "core/SharedPtr.h"
+
+namespace core {
+
+TEST(OpenHashMapTest, testPutGet) {
+	core::HashMap<int64_t, int64_t, std::hash<int64_t>> map;
+	map.put(1, 1);
+	map.put(1, 2);
+	map.put(2, 1);
+	map.put(3, 1337);
+	int64_t value;
+	EXPECT_TRUE(map.get(1, value));
+	EXPECT_EQ(2, value);
+	EXPECT_TRUE(map.get(2, value));
+	EXPECT_EQ(1, value);
+	EXPECT_TRUE(map.get(3, value));
+	EXPECT_EQ(1337, value);
+	EXPECT_FALSE(map.get(4, value));
+	EXPECT_EQ(3u, map.size());
+}
+
+TEST(OpenHashMapTest, testGrow) {
+	core::HashMap<int64_t, int64_t> map;
+	EXPECT_EQ(0u, map.capacity());
+	for (int64_t i = 0; i < 100000; ++i) {
+		map.put(i, i * 2);
+	}
+	EXPECT_EQ(100000u, map.size());
+	EXPECT_GE(map.capacity(), map.size());
+	int64_t value;
+	for (int64_t i = 0; i < 100000; ++i) {
+		ASSERT_TRUE(map.get(i, value)) << "key " << i;
+		EXPECT_EQ(i * 2, value);
+	}
+	EXPECT_FALSE(map.hasKey(100000));
+}
+
+TEST(OpenHashMapTest, testReserve) {
+	core::HashMap<int64_t, int64_t> map(1000);
+	const size_t capacity = map.capacity();
+	EXPECT_GE(capacity, 1000u);
+	for (int64_t i = 0; i < 1000; ++i) {
+		map.put(i, i);
+	}
+	EXPECT_EQ(capacity, map.capacity());
+}
+
+TEST(OpenHashMapTest, testRemove) {
+	core::HashMap<int64_t, int64_t> map;
+	for (int64_t i = 0; i < 1024; ++i) {
+		map.put(i, i);
+	}
+	for (int64_t i = 0; i < 1024; i += 2) {
+		EXPECT_TRUE(map.remove(i));
+	}
+	EXPECT_FALSE(map.remove(0));
+	EXPECT_EQ(512u, map.size());
+	for (int64_t i = 0; i < 1024; ++i) {
+		EXPECT_EQ(i % 2 == 1, map.hasKey(i)) << "key " << i;
+	}
+}
+
+TEST(OpenHashMapTest, testRemoveReinsert) {
+	// the deleted slots must be reused or cleaned up - the capacity must not grow
+	core::HashMap<int64_t, int64_t> map;
+	for (int64_t i = 0; i < 64; ++i) {
+		map.put(i, i);
+	}
+	const size_t capacity = map.capacity();
+	for (int64_t n = 0; n < 100; ++n) {
+		for (int64_t i = 0; i < 64; ++i) {
+			EXPECT_TRUE(map.remove(n * 64 + i));
+			map.put((n + 1) * 64 + i, i);
+		}
+	}
+	EXPECT_EQ(64u, map.size());
+	EXPECT_EQ(capacity, map.capacity());
+}
+
+TEST(OpenHashMapTest, testClear) {
+	core::HashMap<int64_t, int64_t> map;
+	for (int64_t i = 0; i < 16; ++i) {
+		map.put(i, i);
+	}
+	EXPECT_EQ(16u, map.size());
+	EXPECT_FALSE(map.empty());
+	map.clear();
+	EXPECT_EQ(0u, map.size());
+	EXPECT_TRUE(map.empty());
+	EXPECT_EQ(map.begin(), map.end());
+	EXPECT_FALSE(map.hasKey(1));
+}
+
+TEST(OpenHashMapTest, testFind) {
+	core::HashMap<int64_t, int64_t> map;
+	for (int64_t i = 0; i < 1024; i += 2) {
+		map.put(i, i);
+	}
+	auto iter = map.find(2);
+	EXPECT_NE(map.end(), iter);
+	EXPECT_EQ(2, iter->value);
+	EXPECT_EQ(map.end(), map.find(1));
+}
+
+TEST(OpenHashMapTest, testFirstSecond) {
+	core::HashMap<int64_t, int64_t> map;
+	map.put(1, 2);
+	// the references are bound to the slot the entry was moved to by the rehash
+	for (int64_t i = 10; i < 1024; ++i) {
+		map.put(i, i);
+	}
+	map.put(1, 3);
+	auto iter = map.find(1);
+	ASSERT_NE(map.end(), iter);
+	EXPECT_EQ(1, iter->first);
+	EXPECT_EQ(3, iter->second);
+	for (auto entry : map) {
+		EXPECT_EQ(entry->key, entry->first);
+		EXPECT_EQ(entry->value, entry->second);
+	}
+}
+
+TEST(OpenHashMapTest, testIterator) {
+	core::HashMap<int64_t, int64_t> map;
+	EXPECT_EQ(map.begin(), map.end());
+	EXPECT_EQ(map.end(), map.find(42));
+	map.put(1, 1);
+	EXPECT_NE(map.begin(), map.end());
+	EXPECT_EQ(++map.begin(), map.end());
+}
+
+TEST(OpenHashMapTest, testIterateRangeBased) {
+	core::HashMap<int64_t, int64_t> map;
+	for (int64_t i = 0; i < 1024; i += 2) {
+		map.put(i, i);
+	}
+	int cnt = 0;
+	for (auto iter : map) {
+		EXPECT_EQ(iter->key, iter->value);
+		++cnt;
+	}
+	EXPECT_EQ(512, cnt);
+}
+
+TEST(OpenHashMapTest, testEraseWhileIterating) {
+	core::HashMap<int64_t, int64_t> map;
+	for (int64_t i = 0; i < 1024; ++i) {
+		map.put(i, i);
+	}
+	int cnt = 0;
+	for (auto iter = map.begin(); iter != map.end(); ++iter) {
+		if (iter->key % 2 == 0) {
+			map.erase(iter);
+		}
+		++cnt;
+	}
+	EXPECT_EQ(1024, cnt);
+	EXPECT_EQ(512u, map.size());
+	for (auto iter : map) {
+		EXPECT_EQ(1, iter->key % 2);
+	}
+}
+
+TEST(OpenHashMapTest, testStringSharedPtr) {
+	core::HashMap<core::String, core::SharedPtr<core::String>, core::StringHash> map;
+	auto foobar = core::SharedPtr<core::String>::create("foobar");
+	map.put("foobar", foobar);
+	map.emplace("barfoo", core::SharedPtr<core::String>::create("barfoo"));
+	EXPECT_EQ(2, (int)*foobar.refCnt());
+	map.put("foobar", core::SharedPtr<core::String>::create("barfoo"));
+	EXPECT_EQ(1, (int)*foobar.refCnt());
+	for (int i = 0; i < 100; ++i) {
+		map.put(core::String::format("key%i", i), foobar);
+	}
+	EXPECT_EQ(101, (int)*foobar.refCnt());
+	EXPECT_TRUE(map.remove("key0"));
+	EXPECT_EQ(100, (int)*foobar.refCnt());
+	map.clear();
+	EXPECT_EQ(1, (int)*foobar.refCnt());
+}
+
+namespace {
+// every map gets its own seed - like a randomized hasher
+struct SeededHasher {
+	static int seeds;
+	size_t seed;
+	SeededHasher() : seed((size_t)++seeds * 0x9E3779B97F4A7C15ull) {
+	}
+	size_t operator()(int64_t key) const {
+		return std::hash<int64_t>()(key) ^ seed;
+	}
+};
+int SeededHasher::seeds = 0;
+}
+
+TEST(OpenHashMapTest, testMoveAssignStatefulHasher) {
+	core::HashMap<int64_t, int64_t, SeededHasher> map;
+	for (int64_t i = 0; i < 1000; ++i) {
+		map.put(i, i * 2);
+	}
+	core::HashMap<int64_t, int64_t, SeededHasher> map2;
+	map2 = std::move(map);
+	ASSERT_EQ(1000u, map2.size());
+	int64_t value;
+	for (int64_t i = 0; i < 1000; ++i) {
+		ASSERT_TRUE(map2.get(i, value)) << "key " << i;
+		EXPECT_EQ(i * 2, value);
+	}
+	// the moved from map is still usable
+	map.put(1, 1);
+	EXPECT_TRUE(map.get(1, value));
+	EXPECT_FALSE(map.get(2, value));
+}
+
+TEST(OpenHashMapTest, testCopyAndMove) {
+	core::HashMap<core::String, int, core::StringHash> map{{"foo", 1}, {"bar", 2}};
+	auto map2 = map;
+	map2.put("baz", 3);
+	EXPECT_EQ(2u, map.size());
+	EXPECT_EQ(3u, map2.size());
+	map2 = map;
+	EXPECT_EQ(2u, map2.size());
+	core::HashMap<core::String, int, core::StringHash> map3(std::move(map2));
+	EXPECT_EQ(2u, map3.size());
+	EXPECT_EQ(0u, map2.size());
+	int value = 0;
+	EXPECT_TRUE(map3.get("bar", value));
+	EXPECT_EQ(2, value);
+	map2 = std::move(map3);
+	EXPECT_TRUE(map2.get("foo", value));
+	EXPECT_EQ(1, value);
+}
+
+}
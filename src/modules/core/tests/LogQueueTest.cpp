@@ -0,0 +1,106 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "core/LogQueue.h"
+#include "core/concurrent/Lock.h"
+#include <SDL_log.h>
+#include <atomic>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+namespace core {
+
+class LogQueueTest : public core::AbstractTest {
+protected:
+	static bool push(LogQueue& queue, uint32_t id, const char *msg, ...) {
+		va_list args;
+		va_start(args, msg);
+		const bool pushed = queue.push(SDL_LOG_PRIORITY_INFO, id, msg, args);
+		va_end(args);
+		return pushed;
+	}
+};
+
+TEST_F(LogQueueTest, testOrderPerThread) {
+	const int threads = 4;
+	const int messages = 2000;
+	// the last message number per thread - the sink is only called from the drain thread
+	std::vector<int> last(threads, -1);
+	int received = 0;
+	bool ordered = true;
+	LogQueue queue([&] (int priority, uint32_t id, const char *message) {
+		const int n = atoi(message);
+		if (n != last[id] + 1) {
+			ordered = false;
+		}
+		last[id] = n;
+		++received;
+	});
+	ASSERT_TRUE(queue.init());
+	std::vector<std::thread> producers;
+	for (int t = 0; t < threads; ++t) {
+		producers.emplace_back([&queue, t] () {
+			for (int i = 0; i < messages; ++i) {
+				while (!push(queue, (uint32_t)t, "%i", i)) {
+					// the ring is full - wait for the drain thread
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+	for (std::thread& t : producers) {
+		t.join();
+	}
+	queue.flush();
+	EXPECT_TRUE(ordered) << "The messages of a thread were not delivered in order";
+	EXPECT_EQ(threads * messages, received);
+	for (int t = 0; t < threads; ++t) {
+		EXPECT_EQ(messages - 1, last[t]);
+	}
+	queue.shutdown();
+}
+
+TEST_F(LogQueueTest, testFlushOnShutdown) {
+	int received = 0;
+	LogQueue queue([&] (int priority, uint32_t id, const char *message) {
+		++received;
+	});
+	ASSERT_TRUE(queue.init());
+	for (int i = 0; i < 100; ++i) {
+		ASSERT_TRUE(push(queue, 0u, "message %i", i));
+	}
+	queue.shutdown();
+	EXPECT_EQ(100, received);
+	EXPECT_FALSE(push(queue, 0u, "not running anymore"));
+}
+
+TEST_F(LogQueueTest, testOverflow) {
+	core_trace_mutex(core::Lock, sinkLock, "LogQueueTest");
+	std::atomic_int received { 0 };
+	LogQueue queue([&] (int priority, uint32_t id, const char *message) {
+		// block the drain thread until the producer is done
+		core::ScopedLock<core::Lock> lock(sinkLock);
+		++received;
+	}, 1024u);
+	ASSERT_TRUE(queue.init());
+	int pushed = 0;
+	const int messages = 1000;
+	{
+		core::ScopedLock<core::Lock> lock(sinkLock);
+		for (int i = 0; i < messages; ++i) {
+			if (push(queue, 0u, "overflow message %i", i)) {
+				++pushed;
+			}
+		}
+	}
+	queue.flush();
+	EXPECT_LT(pushed, messages) << "Expected the ring buffer to overflow";
+	EXPECT_EQ(pushed, received);
+	EXPECT_EQ((uint64_t)(messages - pushed), queue.dropped());
+	queue.shutdown();
+}
+
+}
@@ -0,0 +1,160 @@
+/**
+ * @file
+ */
+
+#include "AbstractTest.h"
+#include "core/OffsetAllocator.h"
+#include <random>
+#include <vector>
+
+namespace core {
+
+class OffsetAllocatorTest: public AbstractTest {
+protected:
+	/**
+	 * @brief Checks that the allocations don't overlap and are inside of the address space
+	 */
+	void validate(const OffsetAllocator& allocator, const std::vector<OffsetAllocator::Handle>& handles) const {
+		std::vector<std::pair<uint32_t, uint32_t>> ranges;
+		uint32_t used = 0u;
+		for (OffsetAllocator::Handle handle : handles) {
+			ASSERT_TRUE(allocator.valid(handle));
+			ranges.emplace_back(allocator.offset(handle), allocator.size(handle));
+			used += allocator.size(handle);
+		}
+		std::sort(ranges.begin(), ranges.end());
+		for (size_t i = 1; i < ranges.size(); ++i) {
+			ASSERT_LE(ranges[i - 1].first + ranges[i - 1].second, ranges[i].first) << "Allocations are overlapping";
+		}
+		if (!ranges.empty()) {
+			ASSERT_LE(ranges.back().first + ranges.back().second, allocator.capacity());
+		}
+		ASSERT_EQ(used, allocator.used());
+		ASSERT_EQ((uint32_t)handles.size(), allocator.allocations());
+	}
+};
+
+TEST_F(OffsetAllocatorTest, testAllocate) {
+	OffsetAllocator allocator(1024u);
+	const OffsetAllocator::Handle a = allocator.allocate(100u);
+	const OffsetAllocator::Handle b = allocator.allocate(200u);
+	ASSERT_NE(OffsetAllocator::InvalidHandle, a);
+	ASSERT_NE(OffsetAllocator::InvalidHandle, b);
+	EXPECT_EQ(0u, allocator.offset(a));
+	EXPECT_EQ(100u, allocator.offset(b));
+	EXPECT_EQ(300u, allocator.used());
+	EXPECT_EQ(724u, allocator.freeSpace());
+	EXPECT_EQ(724u, allocator.largestFreeRegion());
+	EXPECT_EQ(2u, allocator.allocations());
+	EXPECT_EQ(OffsetAllocator::InvalidHandle, allocator.allocate(0u));
+	EXPECT_EQ(OffsetAllocator::InvalidHandle, allocator.allocate(1000u));
+}
+
+TEST_F(OffsetAllocatorTest, testFreeMerge) {
+	OffsetAllocator allocator(300u);
+	const OffsetAllocator::Handle a = allocator.allocate(100u);
+	const OffsetAllocator::Handle b = allocator.allocate(100u);
+	const OffsetAllocator::Handle c = allocator.allocate(100u);
+	EXPECT_EQ(0u, allocator.freeSpace());
+	EXPECT_EQ(OffsetAllocator::InvalidHandle, allocator.allocate(1u));
+	allocator.free(a);
+	allocator.free(c);
+	EXPECT_EQ(200u, allocator.freeSpace());
+	EXPECT_EQ(100u, allocator.largestFreeRegion());
+	EXPECT_GT(allocator.fragmentation(), 0.0f);
+	// no region is big enough
+	EXPECT_EQ(OffsetAllocator::InvalidHandle, allocator.allocate(150u));
+	allocator.free(b);
+	EXPECT_FALSE(allocator.valid(b));
+	EXPECT_EQ(300u, allocator.largestFreeRegion());
+	EXPECT_FLOAT_EQ(0.0f, allocator.fragmentation());
+	const OffsetAllocator::Handle d = allocator.allocate(300u);
+	ASSERT_NE(OffsetAllocator::InvalidHandle, d);
+	EXPECT_EQ(0u, allocator.offset(d));
+}
+
+TEST_F(OffsetAllocatorTest, testDefragment) {
+	OffsetAllocator allocator(1000u);
+	std::vector<OffsetAllocator::Handle> handles;
+	for (int i = 0; i < 10; ++i) {
+		handles.push_back(allocator.allocate(100u));
+	}
+	// free every second allocation
+	std::vector<OffsetAllocator::Handle> remaining;
+	for (int i = 0; i < 10; ++i) {
+		if (i % 2 == 0) {
+			allocator.free(handles[i]);
+		} else {
+			remaining.push_back(handles[i]);
+		}
+	}
+	EXPECT_EQ(500u, allocator.freeSpace());
+	EXPECT_EQ(100u, allocator.largestFreeRegion());
+	EXPECT_EQ(OffsetAllocator::InvalidHandle, allocator.allocate(200u));
+
+	uint32_t reported = 0u;
+	uint32_t lastOffset = 0u;
+	const uint32_t moved = allocator.defragment([&] (OffsetAllocator::Handle handle, uint32_t oldOffset, uint32_t newOffset, uint32_t size) {
+		EXPECT_LE(newOffset, oldOffset);
+		EXPECT_EQ(lastOffset, newOffset);
+		EXPECT_EQ(100u, size);
+		lastOffset += size;
+		++reported;
+	});
+	EXPECT_EQ(5u, reported);
+	EXPECT_EQ(5u, moved);
+	validate(allocator, remaining);
+	EXPECT_EQ(500u, allocator.largestFreeRegion());
+	const OffsetAllocator::Handle big = allocator.allocate(500u);
+	ASSERT_NE(OffsetAllocator::InvalidHandle, big);
+	EXPECT_EQ(500u, allocator.offset(big));
+}
+
+TEST_F(OffsetAllocatorTest, testGrow) {
+	OffsetAllocator allocator(100u);
+	const OffsetAllocator::Handle a = allocator.allocate(100u);
+	ASSERT_NE(OffsetAllocator::InvalidHandle, a);
+	EXPECT_FALSE(allocator.grow(50u));
+	ASSERT_TRUE(allocator.grow(200u));
+	const OffsetAllocator::Handle b = allocator.allocate(60u);
+	ASSERT_NE(OffsetAllocator::InvalidHandle, b);
+	EXPECT_EQ(100u, allocator.offset(b));
+	// the free region at the end is extended
+	ASSERT_TRUE(allocator.grow(300u));
+	EXPECT_EQ(140u, allocator.largestFreeRegion());
+	EXPECT_EQ(OffsetAllocator::InvalidHandle, allocator.allocate(141u));
+	EXPECT_NE(OffsetAllocator::InvalidHandle, allocator.allocate(140u));
+}
+
+TEST_F(OffsetAllocatorTest, testRandomChurn) {
+	OffsetAllocator allocator(1u << 20);
+	std::mt19937 engine(42);
+	std::uniform_int_distribution<uint32_t> sizeDist(1u, 4096u);
+	std::vector<OffsetAllocator::Handle> handles;
+	for (int i = 0; i < 5000; ++i) {
+		if (!handles.empty() && (engine() % 3u == 0u)) {
+			const size_t index = engine() % handles.size();
+			allocator.free(handles[index]);
+			handles[index] = handles.back();
+			handles.pop_back();
+			continue;
+		}
+		const OffsetAllocator::Handle handle = allocator.allocate(sizeDist(engine));
+		if (handle == OffsetAllocator::InvalidHandle) {
+			allocator.defragment([] (OffsetAllocator::Handle, uint32_t, uint32_t, uint32_t) {});
+			continue;
+		}
+		handles.push_back(handle);
+		if (i % 500 == 0) {
+			validate(allocator, handles);
+		}
+	}
+	validate(allocator, handles);
+	for (OffsetAllocator::Handle handle : handles) {
+		allocator.free(handle);
+	}
+	EXPECT_EQ(0u, allocator.used());
+	EXPECT_EQ(allocator.capacity(), allocator.largestFreeRegion());
+}
+
+}
@@ -0,0 +1,109 @@
+/**
+ * @file
+ */
+
+#include "AbstractTest.h"
+#include "core/PaletteQuantizer.h"
+#include "core/Color.h"
+#include <random>
+#include <vector>
+
+namespace core {
+
+class PaletteQuantizerTest: public AbstractTest {
+protected:
+	std::mt19937 _engine { 42 };
+
+	std::vector<glm::vec4> randomColors(int amount, bool eightBit) {
+		std::uniform_int_distribution<int> byteDist(0, 255);
+		std::uniform_real_distribution<float> floatDist(0.0f, 1.0f);
+		std::vector<glm::vec4> colors;
+		colors.reserve(amount);
+		for (int i = 0; i < amount; ++i) {
+			if (eightBit) {
+				colors.push_back(core::Color::fromRGBA(byteDist(_engine), byteDist(_engine), byteDist(_engine), 255));
+			} else {
+				colors.emplace_back(floatDist(_engine), floatDist(_engine), floatDist(_engine), 1.0f);
+			}
+		}
+		return colors;
+	}
+
+	void checkSame(const std::vector<glm::vec4>& palette, const std::vector<glm::vec4>& colors) {
+		const PaletteQuantizer quantizer(palette);
+		std::vector<int> indices(colors.size());
+		quantizer.getClosestMatches(colors.data(), (int)colors.size(), indices.data());
+		for (size_t i = 0; i < colors.size(); ++i) {
+			const int expected = core::Color::getClosestMatch(colors[i], palette);
+			ASSERT_EQ(expected, quantizer.getClosestMatch(colors[i])) << "color " << i << " with palette size " << palette.size();
+			// the second lookup is served by the cache for 8 bit colors
+			ASSERT_EQ(expected, quantizer.getClosestMatch(colors[i])) << "color " << i << " with palette size " << palette.size();
+			ASSERT_EQ(expected, indices[i]) << "color " << i << " with palette size " << palette.size();
+		}
+	}
+};
+
+TEST_F(PaletteQuantizerTest, testEmpty) {
+	const PaletteQuantizer quantizer;
+	EXPECT_TRUE(quantizer.empty());
+	EXPECT_EQ(-1, quantizer.getClosestMatch(glm::vec4(1.0f)));
+}
+
+TEST_F(PaletteQuantizerTest, testExactMatch) {
+	const glm::vec4 color(0.5f, 0.5f, 0.5f, 1.0f);
+	const std::vector<glm::vec4> colors {
+		glm::vec4(1.0f, 1.0f, 1.0f, 1.0f),
+		glm::vec4(0.5f, 0.5f, 0.1f, 1.0f),
+		glm::vec4(0.5f, 0.5f, 0.4f, 1.0f),
+		color,
+		glm::vec4(0.4f, 0.4f, 0.4f, 1.0f),
+		glm::vec4(0.3f, 0.3f, 0.3f, 1.0f),
+		glm::vec4(0.2f, 0.2f, 0.2f, 1.0f)
+	};
+	const PaletteQuantizer quantizer(colors);
+	EXPECT_EQ(7, quantizer.size());
+	EXPECT_EQ(3, quantizer.getClosestMatch(color));
+}
+
+TEST_F(PaletteQuantizerTest, testDuplicatedEntries) {
+	// equal distances must resolve to the first entry - like the linear search does
+	std::vector<glm::vec4> palette = randomColors(64, true);
+	const std::vector<glm::vec4> copy = palette;
+	palette.insert(palette.end(), copy.begin(), copy.end());
+	palette.push_back(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	palette.push_back(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	checkSame(palette, palette);
+}
+
+TEST_F(PaletteQuantizerTest, testSameAsColorClosestMatch) {
+	const int paletteSizes[] = {1, 3, 4, 7, 256};
+	for (int paletteSize : paletteSizes) {
+		const std::vector<glm::vec4>& palette = randomColors(paletteSize, true);
+		checkSame(palette, randomColors(2000, true));
+		checkSame(palette, randomColors(2000, false));
+	}
+}
+
+TEST_F(PaletteQuantizerTest, testGrays) {
+	// gray values have no hue and no saturation
+	std::vector<glm::vec4> palette;
+	std::vector<glm::vec4> colors;
+	for (int i = 0; i < 256; ++i) {
+		palette.push_back(core::Color::fromRGBA(i, i, i, 255));
+		colors.push_back(core::Color::fromRGBA(i, 255 - i, i, 255));
+		colors.push_back(core::Color::fromRGBA(i, i, i, 255));
+	}
+	checkSame(palette, colors);
+}
+
+TEST_F(PaletteQuantizerTest, testChangePalette) {
+	PaletteQuantizer quantizer(randomColors(16, true));
+	const glm::vec4 color = core::Color::fromRGBA(10, 200, 30, 255);
+	quantizer.getClosestMatch(color);
+	// the cached result of the old palette must not be used
+	const std::vector<glm::vec4>& palette = randomColors(32, true);
+	quantizer.setPalette(palette);
+	EXPECT_EQ(core::Color::getClosestMatch(color, palette), quantizer.getClosestMatch(color));
+}
+
+}
@@ -5,6 +5,8 @@
 #include "AbstractTest.h"
 #include "core/concurrent/ThreadPool.h"
 #include "core/concurrent/Atomic.h"
+#include "core/concurrent/TaskGroup.h"
+#include <vector>
 
 namespace core {
 
@@ -43,4 +45,89 @@ TEST_F(ThreadPoolTest, testMultiplePush) {
 	ASSERT_EQ(x, _count) << "Not all threads were executed";
 }
 
+TEST_F(ThreadPoolTest, testSchedule) {
+	const int x = 1000;
+	core::ThreadPool pool(2);
+	pool.init();
+	for (int i = 0; i < x; ++i) {
+		ASSERT_TRUE(pool.schedule([this] () {
+			++_count;
+		}));
+	}
+	pool.shutdown(true);
+	ASSERT_EQ(x, _count) << "Not all tasks were executed";
+	ASSERT_FALSE(pool.schedule([] () {})) << "The pool is already shut down";
+}
+
+TEST_F(ThreadPoolTest, testTaskInlineAndHeap) {
+	int inlineValue = 0;
+	int heapValue = 0;
+	uint8_t big[256] = { 1 };
+	core::ThreadPool::Task inlineTask([&inlineValue] () {
+		inlineValue = 1;
+	});
+	core::ThreadPool::Task heapTask([&heapValue, big] () {
+		heapValue = big[0] + 1;
+	});
+	core::ThreadPool::Task moved(std::move(heapTask));
+	ASSERT_FALSE((bool)heapTask);
+	ASSERT_TRUE((bool)moved);
+	inlineTask();
+	moved();
+	EXPECT_EQ(1, inlineValue);
+	EXPECT_EQ(2, heapValue);
+}
+
+TEST_F(ThreadPoolTest, testTaskGroup) {
+	const int x = 1000;
+	core::ThreadPool pool(2);
+	pool.init();
+	core::TaskGroup group(pool);
+	for (int i = 0; i < x; ++i) {
+		group.spawn([this] () {
+			++_count;
+		});
+	}
+	group.wait();
+	ASSERT_EQ(x, _count) << "Not all tasks were executed";
+}
+
+static void forkJoin(core::ThreadPool& pool, core::AtomicInt& leaves, int depth) {
+	if (depth == 0) {
+		++leaves;
+		return;
+	}
+	core::TaskGroup group(pool);
+	group.spawn([&pool, &leaves, depth] () {
+		forkJoin(pool, leaves, depth - 1);
+	});
+	group.spawn([&pool, &leaves, depth] () {
+		forkJoin(pool, leaves, depth - 1);
+	});
+	group.wait();
+}
+
+TEST_F(ThreadPoolTest, testNestedTaskGroup) {
+	// the tasks are waiting for their children within the workers
+	core::ThreadPool pool(2);
+	pool.init();
+	forkJoin(pool, _count, 10);
+	ASSERT_EQ(1024, _count);
+}
+
+TEST_F(ThreadPoolTest, testParallelFor) {
+	const int x = 10000;
+	std::vector<int> visited(x, 0);
+	core::ThreadPool pool(3);
+	pool.init();
+	core::parallelFor(pool, 0, x, [&visited] (int start, int end) {
+		for (int i = start; i < end; ++i) {
+			++visited[i];
+		}
+	});
+	for (int i = 0; i < x; ++i) {
+		ASSERT_EQ(1, visited[i]) << "Index " << i << " was visited " << visited[i] << " times";
+	}
+}
+
 }
@@ -0,0 +1,140 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "core/TraceRecorder.h"
+#include "core/Trace.h"
+#include <map>
+#include <thread>
+#include <vector>
+
+namespace core {
+
+class TraceRecorderTest : public core::AbstractTest {
+};
+
+TEST_F(TraceRecorderTest, testNestingAcrossThreads) {
+	const int threads = 4;
+	const int loops = 100;
+	TraceRecorder recorder;
+	std::vector<std::thread> workers;
+	for (int t = 0; t < threads; ++t) {
+		workers.emplace_back([&recorder] () {
+			recorder.threadName("worker");
+			for (int i = 0; i < loops; ++i) {
+				recorder.begin("Outer");
+				for (int j = 0; j < 3; ++j) {
+					recorder.begin("Inner");
+					recorder.begin("Leaf");
+					recorder.end();
+					recorder.end();
+				}
+				recorder.end();
+			}
+		});
+	}
+	for (std::thread& t : workers) {
+		t.join();
+	}
+
+	std::map<uint32_t, std::vector<TraceRecorder::Scope>> scopes;
+	recorder.visit(3600.0, [&] (const TraceRecorder::Scope& scope) {
+		EXPECT_STREQ("worker", scope.threadName);
+		EXPECT_LE(scope.beginMicros, scope.endMicros);
+		scopes[scope.threadId].push_back(scope);
+	});
+	ASSERT_EQ(threads, (int)scopes.size());
+	for (const auto& e : scopes) {
+		const std::vector<TraceRecorder::Scope>& s = e.second;
+		ASSERT_EQ(loops * 7, (int)s.size());
+		// the scopes are visited in the order they ended - the parent ends after its children
+		for (size_t i = 0; i < s.size(); ++i) {
+			const TraceRecorder::Scope& scope = s[i];
+			if (!SDL_strcmp(scope.name, "Outer")) {
+				EXPECT_EQ(0, scope.depth);
+				continue;
+			}
+			const int expectedDepth = !SDL_strcmp(scope.name, "Inner") ? 1 : 2;
+			EXPECT_EQ(expectedDepth, scope.depth) << scope.name;
+			size_t parent = i + 1;
+			while (parent < s.size() && s[parent].depth != expectedDepth - 1) {
+				++parent;
+			}
+			ASSERT_LT(parent, s.size()) << "No parent for " << scope.name;
+			EXPECT_LE(s[parent].beginMicros, scope.beginMicros);
+			EXPECT_GE(s[parent].endMicros, scope.endMicros);
+		}
+	}
+}
+
+TEST_F(TraceRecorderTest, testOverwrittenEvents) {
+	TraceRecorder recorder(16u);
+	recorder.begin("Outer");
+	for (int i = 0; i < 100; ++i) {
+		recorder.begin("Inner");
+		recorder.end();
+	}
+	recorder.end();
+	int outer = 0;
+	int inner = 0;
+	recorder.visit(3600.0, [&] (const TraceRecorder::Scope& scope) {
+		if (!SDL_strcmp(scope.name, "Outer")) {
+			++outer;
+		} else {
+			EXPECT_EQ(0, scope.depth);
+			++inner;
+		}
+	});
+	// the begin event of the outer scope was overwritten
+	EXPECT_EQ(0, outer);
+	EXPECT_EQ(7, inner);
+}
+
+TEST_F(TraceRecorderTest, testOpenScope) {
+	TraceRecorder recorder;
+	recorder.begin("Open");
+	recorder.begin("Closed");
+	recorder.end();
+	std::vector<TraceRecorder::Scope> scopes;
+	recorder.visit(3600.0, [&] (const TraceRecorder::Scope& scope) {
+		scopes.push_back(scope);
+	});
+	ASSERT_EQ(2u, scopes.size());
+	EXPECT_STREQ("Closed", scopes[0].name);
+	EXPECT_EQ(1, scopes[0].depth);
+	EXPECT_STREQ("Open", scopes[1].name);
+	EXPECT_EQ(0, scopes[1].depth);
+	EXPECT_GE(scopes[1].endMicros, scopes[0].endMicros);
+}
+
+TEST_F(TraceRecorderTest, testChromeTrace) {
+	TraceRecorder recorder;
+	recorder.threadName("main \"thread\"");
+	recorder.begin("Scope");
+	recorder.end();
+	const core::String& json = recorder.chromeTrace(3600.0);
+	EXPECT_NE(nullptr, SDL_strstr(json.c_str(), "\"traceEvents\":[")) << json.c_str();
+	EXPECT_NE(nullptr, SDL_strstr(json.c_str(), "\"name\":\"Scope\",\"ph\":\"X\"")) << json.c_str();
+	EXPECT_NE(nullptr, SDL_strstr(json.c_str(), "\"args\":{\"name\":\"main \\\"thread\\\"\"}")) << json.c_str();
+}
+
+#ifndef TRACY_ENABLE
+TEST_F(TraceRecorderTest, testTraceScoped) {
+	TraceRecorder recorder;
+	TraceRecorder* old = core::traceRecorderSet(&recorder);
+	{
+		core_trace_scoped(TraceRecorderTestScope);
+	}
+	core::traceRecorderSet(old);
+	int found = 0;
+	recorder.visit(3600.0, [&] (const TraceRecorder::Scope& scope) {
+		if (!SDL_strcmp(scope.name, "TraceRecorderTestScope")) {
+			++found;
+		}
+	});
+	EXPECT_EQ(1, found);
+}
+#endif
+
+}
@@ -70,6 +70,20 @@ void ClientEntity::setPosition(const glm::vec3& position) {
 	core_assert(!glm::any(glm::isnan(_position)));
 }
 
+void ClientEntity::interpolate(double renderMillis, double maxExtrapolationMillis) {
+	if (_snapshots.empty()) {
+		return;
+	}
+	glm::vec3 position;
+	float orientation;
+	if (_snapshots.sample(renderMillis, maxExtrapolationMillis, position, orientation) == EntitySnapshotBuffer::SampleResult::None) {
+		return;
+	}
+	_snapshots.prune(renderMillis);
+	setPosition(position);
+	setOrientation(orientation);
+}
+
 uint32_t ClientEntity::bindVertexBuffers(const shader::SkeletonShader& chrShader) {
 	if (_vbo.attributes() == 0) {
 		_vbo.addAttribute(chrShader.getPosAttribute(_vertices, &animation::Vertex::pos));
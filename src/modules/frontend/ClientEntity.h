@@ -14,6 +14,7 @@
 #include "core/collection/Array.h"
 #include "core/collection/StringMap.h"
 #include "SkeletonShaderConstants.h"
+#include "EntitySnapshotBuffer.h"
 #include "core/SharedPtr.h"
 #include <memory>
 
@@ -47,6 +48,7 @@ private:
 	int32_t _vertices = -1;
 	int32_t _indices = -1;
 	core::StringMap<core::String> _userinfo;
+	EntitySnapshotBuffer _snapshots;
 public:
 	ClientEntity(const stock::StockDataProviderPtr& provider, const animation::AnimationCachePtr& animationCache,
 			ClientEntityId id, network::EntityType type, const glm::vec3& pos, float orientation);
@@ -60,6 +62,18 @@ public:
 	float orientation() const;
 	void userinfo(const core::String& key, const core::String& value);
 
+	/**
+	 * @brief Queues a server state of the entity - the position and orientation are taken from the queued states
+	 * in @c interpolate()
+	 */
+	bool addSnapshot(const EntitySnapshot& snapshot);
+	/**
+	 * @brief Sets the position and orientation to the state at the given server time
+	 * @param[in] renderMillis The server time to render the entity at
+	 * @param[in] maxExtrapolationMillis The max time the movement is continued if no newer state is available
+	 */
+	void interpolate(double renderMillis, double maxExtrapolationMillis);
+
 	const glm::mat4& modelMatrix() const;
 	const core::Array<glm::mat4, shader::SkeletonShaderConstants::getMaxBones()> bones() const;
 
@@ -124,6 +138,10 @@ inline void ClientEntity::setOrientation(float orientation) {
 	_orientation = orientation;
 }
 
+inline bool ClientEntity::addSnapshot(const EntitySnapshot& snapshot) {
+	return _snapshots.add(snapshot);
+}
+
 inline const glm::vec3& ClientEntity::position() const {
 	return _position;
 }
@@ -3,6 +3,7 @@
  */
 
 #include "EntityMgr.h"
+#include "core/GameConfig.h"
 
 namespace frontend {
 
@@ -10,14 +11,32 @@ EntityMgr::EntityMgr() :
 		_visibleEntities(1024) {
 }
 
+void EntityMgr::construct() {
+	_interpolationDelay = core::Var::get(cfg::ClientInterpolationDelay, "300");
+	_maxExtrapolation = core::Var::get(cfg::ClientMaxExtrapolation, "250");
+}
+
 void EntityMgr::reset() {
 	_entities.clear();
+	_serverClock.reset();
+	_localMillis = 0.0;
 }
 
 void EntityMgr::update(double deltaFrameSeconds, const video::Camera& camera) {
 	_visibleEntities.clear();
+	_localMillis += deltaFrameSeconds * 1000.0;
+	const bool interpolate = _serverClock.synced() && _interpolationDelay && _maxExtrapolation;
+	double renderMillis = 0.0;
+	double maxExtrapolationMillis = 0.0;
+	if (interpolate) {
+		renderMillis = _serverClock.serverMillis(_localMillis) - _interpolationDelay->floatVal();
+		maxExtrapolationMillis = _maxExtrapolation->floatVal();
+	}
 	for (const auto& e : _entities) {
 		const frontend::ClientEntityPtr& ent = e->value;
+		if (interpolate) {
+			ent->interpolate(renderMillis, maxExtrapolationMillis);
+		}
 		ent->update(deltaFrameSeconds);
 		// note, that the aabb does not include the orientation - that should be kept in mind here.
 		// a particular rotation could lead to an entity getting culled even though it should still
@@ -49,6 +68,15 @@ bool EntityMgr::addEntity(const frontend::ClientEntityPtr& entity) {
 	return true;
 }
 
+bool EntityMgr::addSnapshot(frontend::ClientEntityId id, const EntitySnapshot& snapshot) {
+	auto i = _entities.find(id);
+	if (i == _entities.end()) {
+		return false;
+	}
+	_serverClock.update(snapshot.serverMillis, _localMillis);
+	return i->second->addSnapshot(snapshot);
+}
+
 bool EntityMgr::removeEntity(frontend::ClientEntityId id) {
 	auto i = _entities.find(id);
 	if (i == _entities.end()) {
@@ -7,6 +7,8 @@
 #include "core/collection/Map.h"
 #include "core/collection/List.h"
 #include "frontend/ClientEntity.h"
+#include "frontend/ServerClock.h"
+#include "core/Var.h"
 #include "video/Camera.h"
 
 namespace frontend {
@@ -16,10 +18,17 @@ private:
 	typedef core::Map<frontend::ClientEntityId, frontend::ClientEntityPtr, 128> Entities;
 	Entities _entities;
 	core::List<frontend::ClientEntity*> _visibleEntities;
+	ServerClock _serverClock;
+	// the local time that the server timestamps are compared to
+	double _localMillis = 0.0;
+	core::VarPtr _interpolationDelay;
+	core::VarPtr _maxExtrapolation;
 
 public:
 	EntityMgr();
 
+	void construct();
+
 	void update(double deltaFrameSeconds, const video::Camera& camera);
 
 	void reset();
@@ -27,10 +36,21 @@ public:
 	frontend::ClientEntityPtr getEntity(frontend::ClientEntityId id) const;
 	bool addEntity(const frontend::ClientEntityPtr &entity);
 	bool removeEntity(frontend::ClientEntityId id);
+	/**
+	 * @brief Queues the server state for the given entity - the entity is rendered at the server time
+	 * of the newest states minus the interpolation delay
+	 */
+	bool addSnapshot(frontend::ClientEntityId id, const EntitySnapshot& snapshot);
+
+	const ServerClock& serverClock() const;
 
 	const core::List<frontend::ClientEntity*>& visibleEntities() const;
 };
 
+inline const ServerClock& EntityMgr::serverClock() const {
+	return _serverClock;
+}
+
 inline const core::List<frontend::ClientEntity*>& EntityMgr::visibleEntities() const {
 	return _visibleEntities;
 }
@@ -0,0 +1,108 @@
+/**
+ * @file
+ */
+
+#include "EntitySnapshotBuffer.h"
+#include "core/Common.h"
+#include <glm/common.hpp>
+#include <glm/gtc/constants.hpp>
+
+namespace frontend {
+
+namespace {
+
+/**
+ * @brief Interpolates along the shorter arc of the two angles
+ */
+inline float mixOrientation(float from, float to, float t) {
+	float delta = glm::mod(to - from + glm::pi<float>(), glm::two_pi<float>());
+	if (delta < 0.0f) {
+		delta += glm::two_pi<float>();
+	}
+	delta -= glm::pi<float>();
+	return from + delta * t;
+}
+
+}
+
+bool EntitySnapshotBuffer::add(const EntitySnapshot& snapshot) {
+	// find the insert position from the back - most snapshots arrive in order
+	int index = _size;
+	while (index > 0 && _snapshots[index - 1].serverMillis > snapshot.serverMillis) {
+		--index;
+	}
+	if (index > 0 && _snapshots[index - 1].serverMillis == snapshot.serverMillis) {
+		return false;
+	}
+	if (_size == MaxSnapshots) {
+		if (index == 0) {
+			return false;
+		}
+		// drop the oldest snapshot
+		for (int i = 1; i < _size; ++i) {
+			_snapshots[i - 1] = _snapshots[i];
+		}
+		--_size;
+		--index;
+	}
+	for (int i = _size; i > index; --i) {
+		_snapshots[i] = _snapshots[i - 1];
+	}
+	_snapshots[index] = snapshot;
+	++_size;
+	return true;
+}
+
+EntitySnapshotBuffer::SampleResult EntitySnapshotBuffer::sample(double renderMillis, double maxExtrapolationMillis, glm::vec3& position, float& orientation) const {
+	if (_size == 0) {
+		return SampleResult::None;
+	}
+	const EntitySnapshot& oldest = _snapshots[0];
+	if (renderMillis <= oldest.serverMillis) {
+		position = oldest.position;
+		orientation = oldest.orientation;
+		return SampleResult::Oldest;
+	}
+	for (int i = 1; i < _size; ++i) {
+		const EntitySnapshot& to = _snapshots[i];
+		if (renderMillis > to.serverMillis) {
+			continue;
+		}
+		const EntitySnapshot& from = _snapshots[i - 1];
+		const float t = (float)((renderMillis - from.serverMillis) / (to.serverMillis - from.serverMillis));
+		position = glm::mix(from.position, to.position, t);
+		orientation = mixOrientation(from.orientation, to.orientation, t);
+		return SampleResult::Interpolated;
+	}
+	const EntitySnapshot& last = newest();
+	position = last.position;
+	orientation = last.orientation;
+	if (_size < 2) {
+		return SampleResult::Extrapolated;
+	}
+	// continue with the velocity between the last two snapshots
+	const EntitySnapshot& previous = _snapshots[_size - 2];
+	const double extrapolateMillis = core_min(renderMillis - last.serverMillis, maxExtrapolationMillis);
+	const glm::vec3& velocity = (last.position - previous.position) / (float)(last.serverMillis - previous.serverMillis);
+	position += velocity * (float)extrapolateMillis;
+	return SampleResult::Extrapolated;
+}
+
+void EntitySnapshotBuffer::prune(double renderMillis) {
+	// keep the last snapshot before the render time - it's needed to interpolate
+	int remove = 0;
+	while (remove + 1 < _size && _snapshots[remove + 1].serverMillis <= renderMillis) {
+		++remove;
+	}
+	// keep two snapshots for the extrapolation
+	remove = core_min(remove, _size - 2);
+	if (remove <= 0) {
+		return;
+	}
+	for (int i = remove; i < _size; ++i) {
+		_snapshots[i - remove] = _snapshots[i];
+	}
+	_size -= remove;
+}
+
+}
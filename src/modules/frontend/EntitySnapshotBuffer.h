@@ -0,0 +1,91 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include <glm/vec3.hpp>
+
+namespace frontend {
+
+/**
+ * @brief The state of an entity at the given server time
+ */
+struct EntitySnapshot {
+	double serverMillis = 0.0;
+	glm::vec3 position { 0.0f };
+	float orientation = 0.0f;
+};
+
+/**
+ * @brief The last received states of a remote entity ordered by their server time
+ *
+ * The entity is rendered at a point in time that lies behind the newest state - the state is interpolated between
+ * the two snapshots around that time. This hides jitter and lost updates as long as the render delay is bigger
+ * than the update interval of the server. If no newer snapshot is available, the movement is extrapolated for a
+ * short time.
+ */
+class EntitySnapshotBuffer {
+public:
+	static constexpr int MaxSnapshots = 32;
+
+	enum class SampleResult {
+		// no snapshot available
+		None,
+		// the time is before the oldest snapshot
+		Oldest,
+		Interpolated,
+		Extrapolated
+	};
+private:
+	// ordered by the server time - the oldest snapshot is at index 0
+	EntitySnapshot _snapshots[MaxSnapshots];
+	int _size = 0;
+public:
+	/**
+	 * @brief Adds the snapshot at the position of its server time - snapshots that arrive out of order are sorted in.
+	 * If the buffer is full, the oldest snapshot is dropped.
+	 * @return @c false if the snapshot is older than all buffered snapshots of a full buffer or a snapshot with
+	 * the same server time already exists.
+	 */
+	bool add(const EntitySnapshot& snapshot);
+
+	/**
+	 * @param[in] renderMillis The server time to get the state for
+	 * @param[in] maxExtrapolationMillis The max time the state is extrapolated beyond the newest snapshot
+	 * @param[out] position The position at the given time
+	 * @param[out] orientation The orientation at the given time - the orientation is not extrapolated
+	 */
+	SampleResult sample(double renderMillis, double maxExtrapolationMillis, glm::vec3& position, float& orientation) const;
+
+	/**
+	 * @brief Removes the snapshots that are no longer needed to sample the given time or any later time
+	 */
+	void prune(double renderMillis);
+
+	void clear();
+	int size() const;
+	bool empty() const;
+	/**
+	 * @note Only valid if the buffer is not empty
+	 */
+	const EntitySnapshot& newest() const;
+};
+
+inline void EntitySnapshotBuffer::clear() {
+	_size = 0;
+}
+
+inline int EntitySnapshotBuffer::size() const {
+	return _size;
+}
+
+inline bool EntitySnapshotBuffer::empty() const {
+	return _size == 0;
+}
+
+inline const EntitySnapshot& EntitySnapshotBuffer::newest() const {
+	return _snapshots[_size - 1];
+}
+
+}
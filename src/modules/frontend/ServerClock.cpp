@@ -0,0 +1,29 @@
+/**
+ * @file
+ */
+
+#include "ServerClock.h"
+
+namespace frontend {
+
+ServerClock::ServerClock(double drift) :
+		_drift(drift) {
+}
+
+void ServerClock::update(double serverMillis, double localMillis) {
+	const double sample = serverMillis - localMillis;
+	if (!_synced || sample > _offsetMillis) {
+		// a message with less latency than all the previous ones
+		_offsetMillis = sample;
+		_synced = true;
+		return;
+	}
+	_offsetMillis += (sample - _offsetMillis) * _drift;
+}
+
+void ServerClock::reset() {
+	_offsetMillis = 0.0;
+	_synced = false;
+}
+
+}
@@ -0,0 +1,64 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+namespace frontend {
+
+/**
+ * @brief Estimates the server time from the server timestamps of the received messages
+ *
+ * Every message gives a sample of the offset between the server and the local clock - reduced by the latency of
+ * the message. The estimate follows samples with a smaller latency immediately and drifts slowly towards samples
+ * with a higher latency. This way jitter doesn't move the estimate back and forth, but a changed latency or a
+ * drifting clock is still picked up.
+ */
+class ServerClock {
+private:
+	double _offsetMillis = 0.0;
+	bool _synced = false;
+	double _drift;
+public:
+	/**
+	 * @param drift The factor a sample with a higher latency is applied with
+	 */
+	ServerClock(double drift = 0.02);
+
+	/**
+	 * @param serverMillis The server time the message was sent at
+	 * @param localMillis The local time the message was received at
+	 */
+	void update(double serverMillis, double localMillis);
+
+	/**
+	 * @return The estimated server time for the given local time
+	 */
+	double serverMillis(double localMillis) const;
+
+	/**
+	 * @return The estimated offset of the server clock to the local clock - includes the latency of the connection
+	 */
+	double offsetMillis() const;
+
+	/**
+	 * @return @c false if no message was received yet
+	 */
+	bool synced() const;
+
+	void reset();
+};
+
+inline double ServerClock::serverMillis(double localMillis) const {
+	return localMillis + _offsetMillis;
+}
+
+inline double ServerClock::offsetMillis() const {
+	return _offsetMillis;
+}
+
+inline bool ServerClock::synced() const {
+	return _synced;
+}
+
+}
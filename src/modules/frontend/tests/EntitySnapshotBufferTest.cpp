@@ -0,0 +1,244 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "frontend/EntitySnapshotBuffer.h"
+#include "frontend/ServerClock.h"
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <random>
+
+namespace frontend {
+
+class EntitySnapshotBufferTest : public core::AbstractTest {
+protected:
+	static constexpr float Radius = 8.0f;
+	// radians per millisecond - the entity walks with 4 units per second
+	static constexpr float AngularSpeed = 0.0005f;
+
+	/**
+	 * @brief The entity walks on a circle around the origin and looks into the walking direction
+	 */
+	static EntitySnapshot path(double serverMillis) {
+		const float angle = (float)serverMillis * AngularSpeed;
+		EntitySnapshot snapshot;
+		snapshot.serverMillis = serverMillis;
+		snapshot.position = glm::vec3(glm::cos(angle) * Radius, 0.0f, glm::sin(angle) * Radius);
+		snapshot.orientation = glm::mod(angle + glm::half_pi<float>(), glm::two_pi<float>());
+		return snapshot;
+	}
+
+	static float angleDistance(float a, float b) {
+		const float delta = glm::abs(glm::mod(a - b, glm::two_pi<float>()));
+		return glm::min(delta, glm::two_pi<float>() - delta);
+	}
+
+	struct StreamResult {
+		float maxError = 0.0f;
+		// the max error of the frames that could be interpolated
+		float maxInterpolatedError = 0.0f;
+		// 99% of the frames have a smaller error
+		float percentileError = 0.0f;
+		float meanError = 0.0f;
+		// the error if the newest received state would be rendered
+		float meanNewestError = 0.0f;
+		float maxOrientationError = 0.0f;
+		int frames = 0;
+		int extrapolated = 0;
+		int oldest = 0;
+	};
+
+	/**
+	 * @brief Sends the states of the entity with the given update interval to a client that renders with 60 fps.
+	 * The messages have a random latency and get lost with the given probability.
+	 */
+	static StreamResult stream(double updateIntervalMillis, double minLatencyMillis, double jitterMillis, double lossProbability,
+			double interpolationDelayMillis, double maxExtrapolationMillis) {
+		std::mt19937 rnd(42);
+		std::uniform_real_distribution<double> jitter(0.0, jitterMillis);
+		std::bernoulli_distribution loss(lossProbability);
+		// the local clock of the client is not in sync with the server clock
+		const double localOffsetMillis = 123456.0;
+		const double durationMillis = 60000.0;
+
+		struct Message {
+			double arrivalLocalMillis;
+			EntitySnapshot snapshot;
+		};
+		std::vector<Message> messages;
+		for (double serverMillis = updateIntervalMillis; serverMillis < durationMillis; serverMillis += updateIntervalMillis) {
+			if (loss(rnd)) {
+				continue;
+			}
+			const double latency = minLatencyMillis + jitter(rnd);
+			messages.push_back(Message{serverMillis + localOffsetMillis + latency, path(serverMillis)});
+		}
+		std::sort(messages.begin(), messages.end(), [] (const Message& a, const Message& b) {
+			return a.arrivalLocalMillis < b.arrivalLocalMillis;
+		});
+
+		ServerClock clock;
+		EntitySnapshotBuffer buffer;
+		StreamResult result;
+		size_t next = 0;
+		std::vector<float> errors;
+		double errorSum = 0.0;
+		double newestErrorSum = 0.0;
+		const double frameMillis = 1000.0 / 60.0;
+		for (double local = localOffsetMillis; local < localOffsetMillis + durationMillis; local += frameMillis) {
+			for (; next < messages.size() && messages[next].arrivalLocalMillis <= local; ++next) {
+				clock.update(messages[next].snapshot.serverMillis, local);
+				buffer.add(messages[next].snapshot);
+			}
+			if (!clock.synced()) {
+				continue;
+			}
+			const double renderMillis = clock.serverMillis(local) - interpolationDelayMillis;
+			glm::vec3 position;
+			float orientation;
+			const EntitySnapshotBuffer::SampleResult sampleResult = buffer.sample(renderMillis, maxExtrapolationMillis, position, orientation);
+			const glm::vec3 newestPosition = buffer.newest().position;
+			buffer.prune(renderMillis);
+			// let the stream settle
+			if (local < localOffsetMillis + 2000.0) {
+				continue;
+			}
+			const EntitySnapshot& expected = path(renderMillis);
+			const float error = glm::distance(expected.position, position);
+			result.maxError = glm::max(result.maxError, error);
+			result.maxOrientationError = glm::max(result.maxOrientationError, angleDistance(expected.orientation, orientation));
+			errors.push_back(error);
+			errorSum += error;
+			newestErrorSum += glm::distance(expected.position, newestPosition);
+			if (sampleResult == EntitySnapshotBuffer::SampleResult::Interpolated) {
+				result.maxInterpolatedError = glm::max(result.maxInterpolatedError, error);
+			} else if (sampleResult == EntitySnapshotBuffer::SampleResult::Extrapolated) {
+				++result.extrapolated;
+			} else if (sampleResult == EntitySnapshotBuffer::SampleResult::Oldest) {
+				++result.oldest;
+			}
+			++result.frames;
+		}
+		std::sort(errors.begin(), errors.end());
+		result.percentileError = errors[errors.size() * 99 / 100];
+		result.meanError = (float)(errorSum / result.frames);
+		result.meanNewestError = (float)(newestErrorSum / result.frames);
+		return result;
+	}
+};
+
+TEST_F(EntitySnapshotBufferTest, testAdd) {
+	EntitySnapshotBuffer buffer;
+	EXPECT_TRUE(buffer.empty());
+	EXPECT_TRUE(buffer.add(path(100.0)));
+	EXPECT_TRUE(buffer.add(path(300.0)));
+	// arrived out of order
+	EXPECT_TRUE(buffer.add(path(200.0)));
+	EXPECT_FALSE(buffer.add(path(200.0))) << "Duplicated snapshots should get rejected";
+	EXPECT_EQ(3, buffer.size());
+	EXPECT_DOUBLE_EQ(300.0, buffer.newest().serverMillis);
+
+	glm::vec3 position;
+	float orientation;
+	EXPECT_EQ(EntitySnapshotBuffer::SampleResult::Interpolated, buffer.sample(150.0, 0.0, position, orientation));
+	// the interpolation follows the chord of the circle
+	EXPECT_LT(glm::distance(path(150.0).position, position), 0.01f);
+}
+
+TEST_F(EntitySnapshotBufferTest, testFull) {
+	EntitySnapshotBuffer buffer;
+	for (int i = 0; i < EntitySnapshotBuffer::MaxSnapshots + 10; ++i) {
+		EXPECT_TRUE(buffer.add(path(100.0 * (i + 1))));
+	}
+	EXPECT_EQ(EntitySnapshotBuffer::MaxSnapshots, buffer.size());
+	EXPECT_FALSE(buffer.add(path(50.0))) << "A snapshot that is older than all buffered snapshots should get rejected";
+	glm::vec3 position;
+	float orientation;
+	EXPECT_EQ(EntitySnapshotBuffer::SampleResult::Oldest, buffer.sample(100.0, 0.0, position, orientation));
+	EXPECT_EQ(path(1100.0).position, position) << "The oldest snapshots should have been dropped";
+}
+
+TEST_F(EntitySnapshotBufferTest, testSampleEmpty) {
+	EntitySnapshotBuffer buffer;
+	glm::vec3 position(1.0f);
+	float orientation = 1.0f;
+	EXPECT_EQ(EntitySnapshotBuffer::SampleResult::None, buffer.sample(100.0, 100.0, position, orientation));
+	EXPECT_EQ(glm::vec3(1.0f), position);
+}
+
+TEST_F(EntitySnapshotBufferTest, testOrientationShortestArc) {
+	EntitySnapshotBuffer buffer;
+	const float from = glm::two_pi<float>() - 0.1f;
+	buffer.add(EntitySnapshot{100.0, glm::vec3(0.0f), from});
+	buffer.add(EntitySnapshot{200.0, glm::vec3(0.0f), 0.1f});
+	glm::vec3 position;
+	float orientation;
+	ASSERT_EQ(EntitySnapshotBuffer::SampleResult::Interpolated, buffer.sample(150.0, 0.0, position, orientation));
+	EXPECT_LT(angleDistance(0.0f, orientation), 0.001f) << "Should not turn around the long way";
+}
+
+TEST_F(EntitySnapshotBufferTest, testExtrapolationLimit) {
+	EntitySnapshotBuffer buffer;
+	buffer.add(EntitySnapshot{100.0, glm::vec3(0.0f), 0.0f});
+	buffer.add(EntitySnapshot{200.0, glm::vec3(1.0f, 0.0f, 0.0f), 0.0f});
+	glm::vec3 position;
+	float orientation;
+	ASSERT_EQ(EntitySnapshotBuffer::SampleResult::Extrapolated, buffer.sample(250.0, 200.0, position, orientation));
+	EXPECT_NEAR(1.5f, position.x, 0.001f);
+	// the updates stopped - the entity should not walk away
+	ASSERT_EQ(EntitySnapshotBuffer::SampleResult::Extrapolated, buffer.sample(10000.0, 200.0, position, orientation));
+	EXPECT_NEAR(3.0f, position.x, 0.001f);
+}
+
+TEST_F(EntitySnapshotBufferTest, testPrune) {
+	EntitySnapshotBuffer buffer;
+	for (int i = 1; i <= 10; ++i) {
+		buffer.add(path(100.0 * i));
+	}
+	buffer.prune(450.0);
+	EXPECT_EQ(7, buffer.size()) << "The snapshot before the render time is needed for the interpolation";
+	glm::vec3 position;
+	float orientation;
+	EXPECT_EQ(EntitySnapshotBuffer::SampleResult::Interpolated, buffer.sample(450.0, 0.0, position, orientation));
+	buffer.prune(5000.0);
+	EXPECT_EQ(2, buffer.size()) << "The last two snapshots are needed for the extrapolation";
+}
+
+TEST_F(EntitySnapshotBufferTest, testJitteredStream) {
+	// 200ms updates with 50 to 110ms latency
+	const StreamResult& result = stream(200.0, 50.0, 60.0, 0.0, 300.0, 250.0);
+	ASSERT_GT(result.frames, 0);
+	EXPECT_EQ(0, result.oldest);
+	EXPECT_EQ(0, result.extrapolated) << "The interpolation delay covers the update interval and the jitter";
+	EXPECT_LT(result.maxError, 0.05f);
+	EXPECT_LT(result.maxOrientationError, 0.01f);
+}
+
+TEST_F(EntitySnapshotBufferTest, testLossyJitteredStream) {
+	// 200ms updates with 50 to 110ms latency and 20% packet loss
+	const StreamResult& result = stream(200.0, 50.0, 60.0, 0.2, 300.0, 250.0);
+	ASSERT_GT(result.frames, 0);
+	EXPECT_EQ(0, result.oldest);
+	EXPECT_GT(result.extrapolated, 0) << "Consecutive lost packets should have been extrapolated";
+	EXPECT_LT(result.extrapolated, result.frames / 5);
+	// the interpolation follows the chord of the circle - that gets longer with every lost packet
+	EXPECT_LT(result.maxInterpolatedError, 0.3f);
+	// only a burst of lost packets that is longer than the extrapolation limit gives a bigger error
+	EXPECT_LT(result.percentileError, 0.5f);
+	EXPECT_LT(result.meanError, 0.05f);
+	EXPECT_LT(result.maxOrientationError, 0.5f);
+	EXPECT_LT(result.meanError * 10.0f, result.meanNewestError) << "Rendering the interpolated states should be much smoother than the newest state";
+}
+
+TEST_F(EntitySnapshotBufferTest, testLowFrequencyStream) {
+	// the server sends only 5 updates per second, but the latency is bad and a third of the packets get lost
+	const StreamResult& result = stream(200.0, 100.0, 150.0, 0.33, 400.0, 300.0);
+	ASSERT_GT(result.frames, 0);
+	EXPECT_EQ(0, result.oldest);
+	EXPECT_LT(result.maxInterpolatedError, 0.3f);
+	EXPECT_LT(result.percentileError, 1.0f);
+	EXPECT_LT(result.meanError, 0.1f);
+}
+
+}
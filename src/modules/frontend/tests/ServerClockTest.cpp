@@ -0,0 +1,67 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "frontend/ServerClock.h"
+#include <random>
+
+namespace frontend {
+
+class ServerClockTest : public core::AbstractTest {
+};
+
+TEST_F(ServerClockTest, testUnsynced) {
+	ServerClock clock;
+	EXPECT_FALSE(clock.synced());
+	clock.update(1000.0, 50.0);
+	EXPECT_TRUE(clock.synced());
+	EXPECT_DOUBLE_EQ(950.0, clock.offsetMillis());
+	EXPECT_DOUBLE_EQ(1050.0, clock.serverMillis(100.0));
+	clock.reset();
+	EXPECT_FALSE(clock.synced());
+}
+
+TEST_F(ServerClockTest, testFollowLowerLatency) {
+	ServerClock clock;
+	clock.update(1000.0, 100.0);
+	// this message had less latency
+	clock.update(1100.0, 150.0);
+	EXPECT_DOUBLE_EQ(950.0, clock.offsetMillis());
+}
+
+TEST_F(ServerClockTest, testJitter) {
+	std::mt19937 rnd(42);
+	std::uniform_real_distribution<double> jitter(0.0, 80.0);
+	const double localOffsetMillis = -5000.0;
+	const double minLatencyMillis = 40.0;
+	ServerClock clock;
+	for (double serverMillis = 0.0; serverMillis < 30000.0; serverMillis += 100.0) {
+		const double latency = minLatencyMillis + jitter(rnd);
+		const double local = serverMillis + localOffsetMillis + latency;
+		clock.update(serverMillis, local);
+		// the server time at the time the message arrived
+		const double serverNowMillis = serverMillis + latency;
+		const double estimatedMillis = clock.serverMillis(local);
+		// the estimate can't see the latency, but it must not run ahead of the server
+		ASSERT_LE(estimatedMillis, serverNowMillis - minLatencyMillis + 0.001);
+		ASSERT_GE(estimatedMillis, serverMillis - 0.001);
+	}
+	// the offset stays close to the message with the least latency
+	EXPECT_NEAR(-localOffsetMillis - minLatencyMillis, clock.offsetMillis(), 10.0);
+}
+
+TEST_F(ServerClockTest, testLatencyIncrease) {
+	ServerClock clock;
+	for (double serverMillis = 0.0; serverMillis < 1000.0; serverMillis += 100.0) {
+		clock.update(serverMillis, serverMillis + 20.0);
+	}
+	EXPECT_DOUBLE_EQ(-20.0, clock.offsetMillis());
+	// the route changed - all messages have a higher latency now
+	for (double serverMillis = 1000.0; serverMillis < 60000.0; serverMillis += 100.0) {
+		clock.update(serverMillis, serverMillis + 120.0);
+	}
+	EXPECT_NEAR(-120.0, clock.offsetMillis(), 1.0);
+}
+
+}
@@ -5,10 +5,14 @@
 #include "Frustum.h"
 #include "core/Trace.h"
 #include "core/Assert.h"
+#include "core/Common.h"
 #include "core/GLM.h"
 #include "math/AABB.h"
 #include <glm/gtc/matrix_access.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
 
 namespace math {
 
@@ -226,4 +230,85 @@ bool Frustum::isVisible(const glm::vec3& eye, float orientation, const glm::vec3
 	return delta <= fieldOfView;
 }
 
+SIMDFrustum::SIMDFrustum(const Frustum& frustum) {
+	for (int i = 0; i < Lanes; ++i) {
+		if (i >= FRUSTUM_PLANES_MAX) {
+			_normalX[i] = _normalY[i] = _normalZ[i] = 0.0f;
+			_dist[i] = 1.0f;
+			continue;
+		}
+		const Plane& p = frustum[i];
+		_normalX[i] = p.norm().x;
+		_normalY[i] = p.norm().y;
+		_normalZ[i] = p.norm().z;
+		_dist[i] = p.dist();
+	}
+}
+
+// the distance of the positive vertex is the sum of the max products per axis - the negative vertex
+// uses the min products. This avoids the per plane branches of Frustum::test()
+#if defined(__SSE__)
+
+FrustumResult SIMDFrustum::test(const glm::vec3& mins, const glm::vec3& maxs) const {
+	const __m128 minX = _mm_set1_ps(mins.x);
+	const __m128 minY = _mm_set1_ps(mins.y);
+	const __m128 minZ = _mm_set1_ps(mins.z);
+	const __m128 maxX = _mm_set1_ps(maxs.x);
+	const __m128 maxY = _mm_set1_ps(maxs.y);
+	const __m128 maxZ = _mm_set1_ps(maxs.z);
+	const __m128 zero = _mm_setzero_ps();
+	int outside = 0;
+	int intersect = 0;
+	for (int i = 0; i < Lanes; i += 4) {
+		const __m128 nx = _mm_load_ps(&_normalX[i]);
+		const __m128 ny = _mm_load_ps(&_normalY[i]);
+		const __m128 nz = _mm_load_ps(&_normalZ[i]);
+		const __m128 d = _mm_load_ps(&_dist[i]);
+		const __m128 x0 = _mm_mul_ps(nx, minX);
+		const __m128 x1 = _mm_mul_ps(nx, maxX);
+		const __m128 y0 = _mm_mul_ps(ny, minY);
+		const __m128 y1 = _mm_mul_ps(ny, maxY);
+		const __m128 z0 = _mm_mul_ps(nz, minZ);
+		const __m128 z1 = _mm_mul_ps(nz, maxZ);
+		const __m128 positive = _mm_add_ps(_mm_add_ps(_mm_max_ps(x0, x1), _mm_max_ps(y0, y1)), _mm_add_ps(_mm_max_ps(z0, z1), d));
+		const __m128 negative = _mm_add_ps(_mm_add_ps(_mm_min_ps(x0, x1), _mm_min_ps(y0, y1)), _mm_add_ps(_mm_min_ps(z0, z1), d));
+		outside |= _mm_movemask_ps(_mm_cmplt_ps(positive, zero));
+		intersect |= _mm_movemask_ps(_mm_cmplt_ps(negative, zero));
+	}
+	if (outside != 0) {
+		return FrustumResult::Outside;
+	}
+	if (intersect != 0) {
+		return FrustumResult::Intersect;
+	}
+	return FrustumResult::Inside;
+}
+
+#else
+
+FrustumResult SIMDFrustum::test(const glm::vec3& mins, const glm::vec3& maxs) const {
+	FrustumResult result = FrustumResult::Inside;
+	for (int i = 0; i < FRUSTUM_PLANES_MAX; ++i) {
+		const float x0 = _normalX[i] * mins.x;
+		const float x1 = _normalX[i] * maxs.x;
+		const float y0 = _normalY[i] * mins.y;
+		const float y1 = _normalY[i] * maxs.y;
+		const float z0 = _normalZ[i] * mins.z;
+		const float z1 = _normalZ[i] * maxs.z;
+		if (core_max(x0, x1) + core_max(y0, y1) + core_max(z0, z1) + _dist[i] < 0.0f) {
+			return FrustumResult::Outside;
+		}
+		if (core_min(x0, x1) + core_min(y0, y1) + core_min(z0, z1) + _dist[i] < 0.0f) {
+			result = FrustumResult::Intersect;
+		}
+	}
+	return result;
+}
+
+#endif
+
+bool SIMDFrustum::isVisible(const glm::vec3& mins, const glm::vec3& maxs) const {
+	return test(mins, maxs) != FrustumResult::Outside;
+}
+
 }
@@ -86,6 +86,33 @@ public:
 	static bool isVisible(const glm::vec3& eye, float orientation, const glm::vec3& target, float fieldOfView);
 };
 
+/**
+ * @brief The planes of a frustum in a structure of arrays layout. This allows to test an AABB against
+ * all planes at once (sse). Useful if a lot of AABBs are tested against the same frustum - like
+ * for the nodes of a spatial tree.
+ * @note The planes are copied - the instance must be recreated if the frustum changes.
+ */
+class SIMDFrustum {
+private:
+	static constexpr int Lanes = 8;
+	// the unused lanes have a zero normal and a positive distance - they never reject an AABB
+	alignas(16) float _normalX[Lanes];
+	alignas(16) float _normalY[Lanes];
+	alignas(16) float _normalZ[Lanes];
+	alignas(16) float _dist[Lanes];
+public:
+	SIMDFrustum(const Frustum& frustum);
+
+	/**
+	 * @sa Frustum::test()
+	 */
+	FrustumResult test(const glm::vec3& mins, const glm::vec3& maxs) const;
+	/**
+	 * @sa Frustum::isVisible()
+	 */
+	bool isVisible(const glm::vec3& mins, const glm::vec3& maxs) const;
+};
+
 inline Plane& Frustum::plane(FrustumPlanes frustumPlane) {
 	return _planes[(int)frustumPlane];
 }
@@ -0,0 +1,338 @@
+/**
+ * @file
+ */
+
+#include "OcclusionBuffer.h"
+#include "core/Assert.h"
+#include "core/Common.h"
+#include "core/Trace.h"
+#include <glm/common.hpp>
+#include <glm/vec2.hpp>
+#include <algorithm>
+#include <cfloat>
+
+namespace math {
+
+namespace {
+
+// the corners of the faces in counter clockwise order - seen from the outside of the box.
+// the corner index bits are x (1), y (2) and z (4)
+static const int FaceCorners[6][4] = {
+	{0, 4, 6, 2}, {1, 3, 7, 5},
+	{0, 1, 5, 4}, {2, 6, 7, 3},
+	{0, 2, 3, 1}, {4, 5, 7, 6}
+};
+
+inline glm::vec3 corner(const glm::vec3& mins, const glm::vec3& maxs, int index) {
+	return glm::vec3((index & 1) ? maxs.x : mins.x, (index & 2) ? maxs.y : mins.y, (index & 4) ? maxs.z : mins.z);
+}
+
+/**
+ * @return The signed distance to the near plane in clip space - negative values are in front of the near plane
+ */
+inline float nearDistance(const glm::vec4& v) {
+	return v.z + v.w;
+}
+
+// a quad that is clipped against the near plane has at most 5 vertices
+static constexpr int MaxHullVertices = 6 * 5;
+
+/**
+ * @brief Clips the polygon against the near plane
+ * @return The amount of vertices that were written to @c out
+ */
+int clipNearPlane(const glm::vec4* vertices, int amount, glm::vec4* out) {
+	int clippedAmount = 0;
+	for (int i = 0; i < amount; ++i) {
+		const glm::vec4& current = vertices[i];
+		const glm::vec4& next = vertices[(i + 1) % amount];
+		const float currentDistance = nearDistance(current);
+		const float nextDistance = nearDistance(next);
+		if (currentDistance >= 0.0f) {
+			out[clippedAmount++] = current;
+		}
+		if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f)) {
+			const float t = currentDistance / (currentDistance - nextDistance);
+			out[clippedAmount++] = glm::mix(current, next, t);
+		}
+	}
+	return clippedAmount;
+}
+
+/**
+ * @brief Calculates the farthest depth of the polygon plane over the area of a texel
+ * @param[out] plane The depth at texel @c (x,y) is @c plane.x+plane.y*x+plane.z*y
+ * @return @c false if the convex polygon is back facing or degenerated
+ */
+bool frontFacePlane(const glm::dvec3* v, int amount, glm::dvec3& plane) {
+	// use the largest triangle of the fan for the best precision
+	double area = 0.0;
+	int index = 0;
+	for (int i = 1; i < amount - 1; ++i) {
+		const double a = (v[i].x - v[0].x) * (v[i + 1].y - v[0].y) - (v[i + 1].x - v[0].x) * (v[i].y - v[0].y);
+		if (a > area) {
+			area = a;
+			index = i;
+		}
+	}
+	if (area <= 0.0) {
+		return false;
+	}
+	const glm::dvec3& v0 = v[0];
+	const glm::dvec3& v1 = v[index];
+	const glm::dvec3& v2 = v[index + 1];
+	const double dzdx = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+	const double dzdy = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+	plane.x = v0.z - dzdx * v0.x - dzdy * v0.y + 0.5 * (glm::abs(dzdx) + glm::abs(dzdy));
+	plane.y = dzdx;
+	plane.z = dzdy;
+	return true;
+}
+
+inline double cross(const glm::dvec3& o, const glm::dvec3& a, const glm::dvec3& b) {
+	return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+/**
+ * @brief Replaces the given points with their convex hull in counter clockwise order
+ * @return The amount of hull vertices
+ */
+int convexHull(glm::dvec3* points, int amount) {
+	std::sort(points, points + amount, [] (const glm::dvec3& a, const glm::dvec3& b) {
+		return a.x < b.x || (a.x == b.x && a.y < b.y);
+	});
+	glm::dvec3 hull[MaxHullVertices * 2];
+	int n = 0;
+	for (int i = 0; i < amount; ++i) {
+		while (n >= 2 && cross(hull[n - 2], hull[n - 1], points[i]) <= 0.0) {
+			--n;
+		}
+		hull[n++] = points[i];
+	}
+	const int lower = n + 1;
+	for (int i = amount - 2; i >= 0; --i) {
+		while (n >= lower && cross(hull[n - 2], hull[n - 1], points[i]) <= 0.0) {
+			--n;
+		}
+		hull[n++] = points[i];
+	}
+	// the last vertex is the first one
+	n = core_max(0, n - 1);
+	std::copy(hull, hull + n, points);
+	return n;
+}
+
+}
+
+OcclusionBuffer::OcclusionBuffer(int width, int height) {
+	core_assert(width > 0 && height > 0);
+	for (;;) {
+		_levels.push_back(Level{width, height, std::vector<float>((size_t)width * height, FLT_MAX)});
+		if (width == 1 && height == 1) {
+			break;
+		}
+		width = core_max(1, (width + 1) / 2);
+		height = core_max(1, (height + 1) / 2);
+	}
+}
+
+void OcclusionBuffer::clear(const glm::mat4& viewProjection) {
+	_viewProjection = viewProjection;
+	_occluders = 0;
+	std::vector<float>& depth = _levels[0].depth;
+	std::fill(depth.begin(), depth.end(), FLT_MAX);
+	_dirty = true;
+}
+
+void OcclusionBuffer::rasterizeConvex(const glm::dvec3* hull, int amount, const glm::dvec3* planes, int planeAmount, double maxZ) {
+	const Level& level = _levels[0];
+	double minY = hull[0].y, maxY = hull[0].y;
+	double edgeX[MaxHullVertices], edgeY[MaxHullVertices];
+	for (int i = 0; i < amount; ++i) {
+		const int next = (i + 1) % amount;
+		edgeX[i] = hull[next].x - hull[i].x;
+		edgeY[i] = hull[next].y - hull[i].y;
+		minY = core_min(minY, hull[i].y);
+		maxY = core_max(maxY, hull[i].y);
+	}
+	const int startY = core_max(0, (int)glm::ceil(minY));
+	const int endY = core_min(level.height, (int)glm::floor(maxY));
+	float* depth = _levels[0].depth.data();
+	for (int py = startY; py < endY; ++py) {
+		// the span of texels on this row that are completely inside of all edges - the edges are
+		// evaluated at the upper and the lower border of the row
+		double spanStart = 0.0;
+		double spanEnd = level.width;
+		for (int i = 0; i < amount; ++i) {
+			const double e0 = edgeX[i] * (py - hull[i].y);
+			const double e1 = edgeX[i] * (py + 1.0 - hull[i].y);
+			if (edgeY[i] == 0.0) {
+				if (e0 < 0.0 || e1 < 0.0) {
+					spanStart = spanEnd + 1.0;
+				}
+				continue;
+			}
+			const double bound0 = hull[i].x + e0 / edgeY[i];
+			const double bound1 = hull[i].x + e1 / edgeY[i];
+			if (edgeY[i] > 0.0) {
+				spanEnd = core_min(spanEnd, core_min(bound0, bound1));
+			} else {
+				spanStart = core_max(spanStart, core_max(bound0, bound1));
+			}
+		}
+		const int startX = (int)glm::ceil(spanStart);
+		const int endX = (int)glm::floor(spanEnd);
+		const double cy = py + 0.5;
+		float* row = depth + py * level.width;
+		for (int px = startX; px < endX; ++px) {
+			const double cx = px + 0.5;
+			// the front of a convex body is the farthest of its front face planes
+			double texelZ = -DBL_MAX;
+			for (int i = 0; i < planeAmount; ++i) {
+				texelZ = core_max(texelZ, planes[i].x + planes[i].y * cx + planes[i].z * cy);
+			}
+			const float value = (float)core_min(texelZ, maxZ);
+			if (value < row[px]) {
+				row[px] = value;
+			}
+		}
+	}
+}
+
+void OcclusionBuffer::addOccluder(const glm::vec3& mins, const glm::vec3& maxs) {
+	glm::vec4 clip[8];
+	int behindNearPlane = 0;
+	int outside[4] = {0, 0, 0, 0};
+	for (int i = 0; i < 8; ++i) {
+		clip[i] = _viewProjection * glm::vec4(corner(mins, maxs, i), 1.0f);
+		const glm::vec4& v = clip[i];
+		if (nearDistance(v) < 0.0f) {
+			++behindNearPlane;
+		}
+		outside[0] += v.x < -v.w;
+		outside[1] += v.x > v.w;
+		outside[2] += v.y < -v.w;
+		outside[3] += v.y > v.w;
+	}
+	if (behindNearPlane == 8 || outside[0] == 8 || outside[1] == 8 || outside[2] == 8 || outside[3] == 8) {
+		return;
+	}
+	++_occluders;
+	_dirty = true;
+
+	const Level& level = _levels[0];
+	const glm::dvec2 halfSize(level.width * 0.5, level.height * 0.5);
+	// the screen space vertices of the box after clipping it against the near plane
+	glm::dvec3 points[MaxHullVertices];
+	int pointAmount = 0;
+	// the farthest depth of each front face over a texel area: z = x + y * texelX + z * texelY
+	glm::dvec3 planes[6];
+	int planeAmount = 0;
+	double maxZ = -DBL_MAX;
+	for (int face = 0; face < 6; ++face) {
+		const glm::vec4 quad[4] = {clip[FaceCorners[face][0]], clip[FaceCorners[face][1]], clip[FaceCorners[face][2]], clip[FaceCorners[face][3]]};
+		glm::vec4 clipped[8];
+		const int amount = behindNearPlane == 0 ? 4 : clipNearPlane(quad, 4, clipped);
+		const glm::vec4* polygon = behindNearPlane == 0 ? quad : clipped;
+		glm::dvec3 screen[8];
+		for (int i = 0; i < amount; ++i) {
+			const glm::vec4& v = polygon[i];
+			const double invW = 1.0 / (double)v.w;
+			screen[i] = glm::dvec3(((double)v.x * invW + 1.0) * halfSize.x, ((double)v.y * invW + 1.0) * halfSize.y, (double)v.z * invW);
+			points[pointAmount++] = screen[i];
+		}
+		glm::dvec3 plane;
+		if (!frontFacePlane(screen, amount, plane)) {
+			continue;
+		}
+		planes[planeAmount++] = plane;
+		for (int i = 0; i < amount; ++i) {
+			maxZ = core_max(maxZ, screen[i].z);
+		}
+	}
+	if (planeAmount == 0) {
+		return;
+	}
+	// the front faces of the box cover its silhouette - only the texels that are completely inside of it
+	// are written to never hide anything that is visible through a gap
+	const int hullAmount = convexHull(points, pointAmount);
+	if (hullAmount < 3) {
+		return;
+	}
+	rasterizeConvex(points, hullAmount, planes, planeAmount, maxZ);
+}
+
+void OcclusionBuffer::buildHierarchy() {
+	core_trace_scoped(OcclusionBufferHierarchy);
+	for (size_t i = 1; i < _levels.size(); ++i) {
+		const Level& src = _levels[i - 1];
+		Level& dst = _levels[i];
+		for (int y = 0; y < dst.height; ++y) {
+			const int sy0 = y * 2;
+			const int sy1 = core_min(sy0 + 1, src.height - 1);
+			for (int x = 0; x < dst.width; ++x) {
+				const int sx0 = x * 2;
+				const int sx1 = core_min(sx0 + 1, src.width - 1);
+				const float* row0 = &src.depth[sy0 * src.width];
+				const float* row1 = &src.depth[sy1 * src.width];
+				const float farthest = core_max(core_max(row0[sx0], row0[sx1]), core_max(row1[sx0], row1[sx1]));
+				dst.depth[y * dst.width + x] = farthest;
+			}
+		}
+	}
+	_dirty = false;
+}
+
+bool OcclusionBuffer::isVisible(const glm::vec3& mins, const glm::vec3& maxs) {
+	if (_occluders == 0) {
+		return true;
+	}
+	if (_dirty) {
+		buildHierarchy();
+	}
+	const Level& base = _levels[0];
+	float minX = FLT_MAX, minY = FLT_MAX, nearestZ = FLT_MAX;
+	float maxX = -FLT_MAX, maxY = -FLT_MAX;
+	for (int i = 0; i < 8; ++i) {
+		const glm::vec4& v = _viewProjection * glm::vec4(corner(mins, maxs, i), 1.0f);
+		if (nearDistance(v) < 0.0f) {
+			return true;
+		}
+		const float invW = 1.0f / v.w;
+		const float sx = (v.x * invW + 1.0f) * 0.5f * (float)base.width;
+		const float sy = (v.y * invW + 1.0f) * 0.5f * (float)base.height;
+		minX = core_min(minX, sx);
+		maxX = core_max(maxX, sx);
+		minY = core_min(minY, sy);
+		maxY = core_max(maxY, sy);
+		nearestZ = core_min(nearestZ, v.z * invW);
+	}
+	if (maxX < 0.0f || maxY < 0.0f || minX >= (float)base.width || minY >= (float)base.height) {
+		return true;
+	}
+	int x0 = core_max(0, (int)glm::floor(minX));
+	int x1 = core_min(base.width - 1, (int)glm::floor(maxX));
+	int y0 = core_max(0, (int)glm::floor(minY));
+	int y1 = core_min(base.height - 1, (int)glm::floor(maxY));
+	// select the level where the rect covers at most 4x4 texels
+	size_t levelIndex = 0;
+	while ((x1 - x0 >= 4 || y1 - y0 >= 4) && levelIndex + 1 < _levels.size()) {
+		x0 >>= 1;
+		x1 >>= 1;
+		y0 >>= 1;
+		y1 >>= 1;
+		++levelIndex;
+	}
+	const Level& level = _levels[levelIndex];
+	for (int y = y0; y <= y1; ++y) {
+		const float* row = &level.depth[y * level.width];
+		for (int x = x0; x <= x1; ++x) {
+			if (row[x] >= nearestZ) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+}
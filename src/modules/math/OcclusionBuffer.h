@@ -0,0 +1,93 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+#include <vector>
+
+namespace math {
+
+/**
+ * @brief Low resolution software depth buffer for occlusion culling on the cpu
+ *
+ * Boxes that are completely solid are rasterized as occluders with the given view projection matrix.
+ * A hierarchy of the farthest depth values is built on top of the depth buffer - an AABB is occluded if
+ * its nearest point is behind the farthest depth value of every texel of the hierarchy level that it covers.
+ *
+ * @note The depth values are normalized device coordinates (OpenGL clip space conventions)
+ * @note The rasterization is conservative: an occluder only writes the texels that its silhouette covers
+ * completely - with the farthest depth value of the texel area.
+ */
+class OcclusionBuffer {
+private:
+	struct Level {
+		int width;
+		int height;
+		std::vector<float> depth;
+	};
+	std::vector<Level> _levels;
+	glm::mat4 _viewProjection { 1.0f };
+	int _occluders = 0;
+	bool _dirty = false;
+
+	/**
+	 * @param[in] hull The screen space vertices of the convex silhouette in counter clockwise order
+	 * @param[in] planes The depth planes of the front faces
+	 */
+	void rasterizeConvex(const glm::dvec3* hull, int amount, const glm::dvec3* planes, int planeAmount, double maxZ);
+	void buildHierarchy();
+public:
+	OcclusionBuffer(int width = 256, int height = 128);
+
+	/**
+	 * @brief Resets the depth buffer - all AABBs are visible until occluders are added
+	 */
+	void clear(const glm::mat4& viewProjection);
+
+	/**
+	 * @brief Rasterizes the faces of the given box that are facing the camera
+	 * @note The box must be completely solid - everything behind it is considered to be hidden
+	 */
+	void addOccluder(const glm::vec3& mins, const glm::vec3& maxs);
+
+	/**
+	 * @return @c false if the given AABB is completely hidden by the occluders, @c true otherwise. AABBs that
+	 * intersect the near plane or are outside of the depth buffer are always visible - the frustum test is up to
+	 * the caller.
+	 */
+	bool isVisible(const glm::vec3& mins, const glm::vec3& maxs);
+
+	/**
+	 * @return The depth value of the given texel of the full resolution level. @c FLT_MAX if no occluder covers it.
+	 */
+	float depth(int x, int y) const;
+
+	int width() const;
+	int height() const;
+	/**
+	 * @return The amount of occluders that were added since the last @c clear()
+	 */
+	int occluders() const;
+};
+
+inline int OcclusionBuffer::width() const {
+	return _levels[0].width;
+}
+
+inline int OcclusionBuffer::height() const {
+	return _levels[0].height;
+}
+
+inline int OcclusionBuffer::occluders() const {
+	return _occluders;
+}
+
+inline float OcclusionBuffer::depth(int x, int y) const {
+	const Level& level = _levels[0];
+	return level.depth[y * level.width + x];
+}
+
+}
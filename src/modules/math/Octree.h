@@ -5,8 +5,8 @@
 #pragma once
 
 #include <vector>
-#include <list>
 #include <algorithm>
+#include <stdint.h>
 #include "AABB.h"
 #include "Frustum.h"
 #include "core/Trace.h"
@@ -17,12 +17,19 @@ namespace math {
 extern math::AABB<int> computeAABB(const Frustum& area, const glm::vec3& gridSize);
 
 /**
+ * @brief Linear octree - the nodes and the items are stored in contiguous arrays.
+ *
+ * The eight children of a node are allocated as one block in morton order (x, y and z bit of the
+ * child index). The items are stored in one array and the items of a node are linked by index.
+ * Removing an item moves the last item into the free slot - there are no holes in the item array.
+ * The queries are visitor based and don't allocate memory.
+ *
  * @note Given NODE type must implement @c aabb() and return math::AABB<TYPE>
  */
 template<class NODE, typename TYPE = int>
 class Octree {
 public:
-	typedef typename std::list<NODE> Contents;
+	typedef typename std::vector<NODE> Contents;
 
 	class OctreeNode;
 	struct IOctreeListener {
@@ -30,283 +37,305 @@ public:
 		virtual void onNodeCreated(const OctreeNode& parent, const OctreeNode& child) const {}
 	};
 
-	class OctreeNode {
-		friend class Octree;
-	private:
-		/*
-		 * +Y                        +Z
-		 * |                         /
-		 * |                        /
-		 * |                       /
-		 * |                      /
-		 * |       O---------------O---------------O
-		 * |      /               /               /|
-		 * |     /       3       /       7       / |
-		 * |    /               /               /  |
-		 * |   O---------------O---------------O   |
-		 * |  /               /               /|   |
-		 * | /       2       /       6       / | 7 |
-		 * |/               /               /  |   O
-		 * O---------------O---------------O   |  /|
-		 * |               |               |   | / |
-		 * |               |               | 6 |/  |
-		 * |               |               |   O   |
-		 * |       2       |       6       |  /|   |
-		 * |               |               | / | 5 |
-		 * |               |               |/  |   O
-		 * O---------------O---------------O   |  /
-		 * |               |               |   | /
-		 * |               |               | 4 |/
-		 * |               |               |   O
-		 * |       0       |       4       |  /
-		 * |               |               | /
-		 * |               |               |/
-		 * O---------------O---------------O------------------+X
-		 */
-		static void split(const AABB<TYPE>& aabb, AABB<TYPE> (&result)[8]) {
-			const glm::tvec3<TYPE>& center = aabb.getCenter();
-			result[0] = AABB<TYPE>(aabb.mins(), center);
+private:
+	static constexpr int32_t InvalidIndex = -1;
+
+	struct Node {
+		AABB<TYPE> aabb;
+		int32_t parent;
+		// index of the first of the eight children - they are stored next to each other
+		int32_t children = InvalidIndex;
+		// head of the list of items that are stored in this node
+		int32_t items = InvalidIndex;
+		// amount of items in this node and all its children
+		int32_t count = 0;
+		int32_t depth;
+
+		Node(const AABB<TYPE>& _aabb, int32_t _parent, int32_t _depth) :
+				aabb(_aabb), parent(_parent), depth(_depth) {
+		}
+	};
 
-			glm::tvec3<TYPE> mins1(aabb.getLowerX(), aabb.getLowerY(), center.z);
-			glm::tvec3<TYPE> maxs1(center.x, center.y, aabb.getUpperZ());
-			result[1] = AABB<TYPE>(mins1, maxs1);
+	struct Item {
+		NODE value;
+		int32_t node;
+		int32_t prev;
+		int32_t next;
 
-			glm::tvec3<TYPE> mins2(aabb.getLowerX(), center.y, aabb.getLowerZ());
-			glm::tvec3<TYPE> maxs2(center.x, aabb.getUpperY(), center.z);
-			result[2] = AABB<TYPE>(mins2, maxs2);
+		Item(const NODE& _value, int32_t _node, int32_t _next) :
+				value(_value), node(_node), prev(InvalidIndex), next(_next) {
+		}
+	};
 
-			glm::tvec3<TYPE> mins3(aabb.getLowerX(), center.y, center.z);
-			glm::tvec3<TYPE> maxs3(center.x, aabb.getUpperY(), aabb.getUpperZ());
-			result[3] = AABB<TYPE>(mins3, maxs3);
+	/*
+	 * +Y                        +Z
+	 * |                         /
+	 * |                        /
+	 * |                       /
+	 * |                      /
+	 * |       O---------------O---------------O
+	 * |      /               /               /|
+	 * |     /       3       /       7       / |
+	 * |    /               /               /  |
+	 * |   O---------------O---------------O   |
+	 * |  /               /               /|   |
+	 * | /       2       /       6       / | 7 |
+	 * |/               /               /  |   O
+	 * O---------------O---------------O   |  /|
+	 * |               |               |   | / |
+	 * |               |               | 6 |/  |
+	 * |               |               |   O   |
+	 * |       2       |       6       |  /|   |
+	 * |               |               | / | 5 |
+	 * |               |               |/  |   O
+	 * O---------------O---------------O   |  /
+	 * |               |               |   | /
+	 * |               |               | 4 |/
+	 * |               |               |   O
+	 * |       0       |       4       |  /
+	 * |               |               | /
+	 * |               |               |/
+	 * O---------------O---------------O------------------+X
+	 */
+	static void split(const AABB<TYPE>& aabb, AABB<TYPE> (&result)[8]) {
+		const glm::tvec3<TYPE>& center = aabb.getCenter();
+		result[0] = AABB<TYPE>(aabb.mins(), center);
 
-			glm::tvec3<TYPE> mins4(center.x, aabb.getLowerY(), aabb.getLowerZ());
-			glm::tvec3<TYPE> maxs4(aabb.getUpperX(), center.y, center.z);
-			result[4] = AABB<TYPE>(mins4, maxs4);
+		glm::tvec3<TYPE> mins1(aabb.getLowerX(), aabb.getLowerY(), center.z);
+		glm::tvec3<TYPE> maxs1(center.x, center.y, aabb.getUpperZ());
+		result[1] = AABB<TYPE>(mins1, maxs1);
 
-			glm::tvec3<TYPE> mins5(center.x, aabb.getLowerY(), center.z);
-			glm::tvec3<TYPE> maxs5(aabb.getUpperX(), center.y, aabb.getUpperZ());
-			result[5] = AABB<TYPE>(mins5, maxs5);
+		glm::tvec3<TYPE> mins2(aabb.getLowerX(), center.y, aabb.getLowerZ());
+		glm::tvec3<TYPE> maxs2(center.x, aabb.getUpperY(), center.z);
+		result[2] = AABB<TYPE>(mins2, maxs2);
 
-			glm::tvec3<TYPE> mins6(center.x, center.y, aabb.getLowerZ());
-			glm::tvec3<TYPE> maxs6(aabb.getUpperX(), aabb.getUpperY(), center.z);
-			result[6] = AABB<TYPE>(mins6, maxs6);
+		glm::tvec3<TYPE> mins3(aabb.getLowerX(), center.y, center.z);
+		glm::tvec3<TYPE> maxs3(center.x, aabb.getUpperY(), aabb.getUpperZ());
+		result[3] = AABB<TYPE>(mins3, maxs3);
 
-			glm::tvec3<TYPE> mins7(center.x, center.y, center.z);
-			glm::tvec3<TYPE> maxs7(aabb.getUpperX(), aabb.getUpperY(), aabb.getUpperZ());
-			result[7] = AABB<TYPE>(mins7, maxs7);
-		}
+		glm::tvec3<TYPE> mins4(center.x, aabb.getLowerY(), aabb.getLowerZ());
+		glm::tvec3<TYPE> maxs4(aabb.getUpperX(), center.y, center.z);
+		result[4] = AABB<TYPE>(mins4, maxs4);
 
-		int _maxDepth;
-		int _depth;
-		const Octree* _octree;
-		const AABB<TYPE> _aabb;
-		Contents _contents;
-		std::vector<OctreeNode> _nodes;
+		glm::tvec3<TYPE> mins5(center.x, aabb.getLowerY(), center.z);
+		glm::tvec3<TYPE> maxs5(aabb.getUpperX(), center.y, aabb.getUpperZ());
+		result[5] = AABB<TYPE>(mins5, maxs5);
 
-		template<class FUNC>
-		inline void visit(FUNC&& func) const {
-			core_trace_scoped(OctreeNodeVisit);
-			func(*this);
-			for (const OctreeNode& node : _nodes) {
-				node.visit(func);
-			}
-		}
+		glm::tvec3<TYPE> mins6(center.x, center.y, aabb.getLowerZ());
+		glm::tvec3<TYPE> maxs6(aabb.getUpperX(), aabb.getUpperY(), center.z);
+		result[6] = AABB<TYPE>(mins6, maxs6);
 
-		void createNodes() {
-			core_trace_scoped(OctreeNodeCreateNodes);
-			if (_depth >= _maxDepth) {
-				return;
-			}
+		glm::tvec3<TYPE> mins7(center.x, center.y, center.z);
+		glm::tvec3<TYPE> maxs7(aabb.getUpperX(), aabb.getUpperY(), aabb.getUpperZ());
+		result[7] = AABB<TYPE>(mins7, maxs7);
+	}
 
-			const auto& _aabb = aabb();
-			const glm::tvec3<TYPE>& _aabbSize = _aabb.getWidth();
-			const constexpr glm::tvec3<TYPE> one((TYPE)1);
-			if (_aabbSize.x <= one.x && _aabbSize.y <= one.y && _aabbSize.z <= one.z) {
-				return;
-			}
 
-			AABB<TYPE> subareas[8];
-			split(_aabb, subareas);
-			_nodes.reserve(8);
-			for (size_t i = 0u; i < 8; ++i) {
-				_nodes.emplace_back(OctreeNode(subareas[i], _maxDepth, _depth + 1, _octree));
-				if (_octree->_listener != nullptr) {
-					_octree->_listener->onNodeCreated(*this, _nodes.back());
-				}
+	std::vector<Node> _nodes;
+	std::vector<Item> _items;
+	int _maxDepth;
+	// dirty flag can be used for query caches
+	bool _dirty = false;
+	const IOctreeListener* _listener = nullptr;
+
+	static inline AABB<TYPE> aabb(const typename std::remove_pointer<NODE>::type* item) {
+		return item->aabb();
+	}
+
+	static inline AABB<TYPE> aabb(const typename std::remove_pointer<NODE>::type& item) {
+		return item.aabb();
+	}
+
+	/**
+	 * @return The index of the child that fully contains the given area or @c -1 if the
+	 * area is spanning over the center of the node.
+	 * @note The lower half is preferred if the area is exactly on the center.
+	 */
+	static inline int childIndex(const AABB<TYPE>& nodeAABB, const AABB<TYPE>& area) {
+		const glm::tvec3<TYPE>& center = nodeAABB.getCenter();
+		int index = 0;
+		for (int i = 0; i < 3; ++i) {
+			const int bit = 4 >> i;
+			if (area.maxs()[i] <= center[i]) {
+				continue;
 			}
+			if (area.mins()[i] >= center[i]) {
+				index |= bit;
+				continue;
+			}
+			return InvalidIndex;
 		}
-	public:
-		static inline AABB<TYPE> aabb(const typename std::remove_pointer<NODE>::type* item) {
-			return item->aabb();
-		}
+		return index;
+	}
 
-		static inline AABB<TYPE> aabb(const typename std::remove_pointer<NODE>::type& item) {
-			return item.aabb();
+	bool createNodes(int32_t nodeIndex) {
+		core_trace_scoped(OctreeCreateNodes);
+		const Node& node = _nodes[nodeIndex];
+		if (node.depth >= _maxDepth) {
+			return false;
 		}
-
-		OctreeNode(const AABB<TYPE>& bounds, int maxDepth, int depth, const Octree* octree) :
-				_maxDepth(maxDepth), _depth(depth), _octree(octree), _aabb(bounds) {
+		const AABB<TYPE> nodeAABB = node.aabb;
+		const glm::tvec3<TYPE>& size = nodeAABB.getWidth();
+		const constexpr glm::tvec3<TYPE> one((TYPE)1);
+		if (size.x <= one.x && size.y <= one.y && size.z <= one.z) {
+			return false;
 		}
 
-		inline int depth() const {
-			return _depth;
+		AABB<TYPE> subareas[8];
+		split(nodeAABB, subareas);
+		const int32_t children = (int32_t)_nodes.size();
+		const int32_t depth = node.depth + 1;
+		// this might invalidate the node reference
+		for (int i = 0; i < 8; ++i) {
+			_nodes.emplace_back(subareas[i], nodeIndex, depth);
 		}
-
-		inline int count() const {
-			core_trace_scoped(OctreeNodeCount);
-			int count = 0;
-			for (const typename Octree<NODE, TYPE>::OctreeNode& node : _nodes) {
-				count += (int)node.count();
+		_nodes[nodeIndex].children = children;
+		if (_listener != nullptr) {
+			for (int i = 0; i < 8; ++i) {
+				_listener->onNodeCreated(OctreeNode(this, nodeIndex), OctreeNode(this, children + i));
 			}
-			count += _contents.size();
-			return count;
 		}
+		return true;
+	}
 
-		inline const AABB<TYPE>& aabb() const {
-			return _aabb;
+	void updateCount(int32_t nodeIndex, int32_t delta) {
+		while (nodeIndex != InvalidIndex) {
+			Node& node = _nodes[nodeIndex];
+			node.count += delta;
+			nodeIndex = node.parent;
 		}
+	}
 
-		inline const Contents& getContents() const {
-			return _contents;
+	void removeItem(int32_t itemIndex) {
+		Item& item = _items[itemIndex];
+		if (item.prev != InvalidIndex) {
+			_items[item.prev].next = item.next;
+		} else {
+			_nodes[item.node].items = item.next;
 		}
-
-		void getAllContents(Contents& results) const {
-			core_trace_scoped(OctreeNodeGetAllContents);
-			for (const typename Octree<NODE, TYPE>::OctreeNode& node : _nodes) {
-				if (node.isEmpty()) {
-					continue;
-				}
-				node.getAllContents(results);
-			}
-
-			// faster for list - but slower for vector
-			std::copy(_contents.begin(), _contents.end(), std::back_inserter(results));
+		if (item.next != InvalidIndex) {
+			_items[item.next].prev = item.prev;
 		}
-
-		bool remove(const NODE& item) {
-			core_trace_scoped(OctreeNodeRemove);
-			const AABB<TYPE>& area = aabb(item);
-			if (!aabb().containsAABB(area)) {
-				return false;
-			}
-			for (typename Octree<NODE, TYPE>::OctreeNode& node : _nodes) {
-				if (!node.remove(item)) {
-					continue;
-				}
-				return true;
+		updateCount(item.node, -1);
+
+		// move the last item into the free slot
+		const int32_t last = (int32_t)_items.size() - 1;
+		if (itemIndex != last) {
+			_items[itemIndex] = std::move(_items[last]);
+			const Item& moved = _items[itemIndex];
+			if (moved.prev != InvalidIndex) {
+				_items[moved.prev].next = itemIndex;
+			} else {
+				_nodes[moved.node].items = itemIndex;
 			}
-
-			typename Contents::iterator i = std::find(_contents.begin(), _contents.end(), item);
-			if (i == _contents.end()) {
-				return false;
+			if (moved.next != InvalidIndex) {
+				_items[moved.next].prev = itemIndex;
 			}
-			_contents.erase(i);
-			return true;
 		}
+		_items.pop_back();
+	}
 
-		bool insert(const NODE& item) {
-			core_trace_scoped(OctreeNodeInsert);
-			const AABB<TYPE>& area = aabb(item);
-			if (!aabb().containsAABB(area)) {
-				return false;
-			}
-
-			if (_nodes.empty()) {
-				createNodes();
-			}
-
-			for (typename Octree<NODE, TYPE>::OctreeNode& node : _nodes) {
-				if (!node.insert(item)) {
-					continue;
-				}
-				return true;
-			}
-
-			_contents.push_back(item);
-			return true;
+	template<class FUNC>
+	void visitNodeItems(int32_t nodeIndex, FUNC&& func) const {
+		for (int32_t i = _nodes[nodeIndex].items; i != InvalidIndex; i = _items[i].next) {
+			func(_items[i].value);
 		}
+	}
 
-		inline bool isLeaf() const {
-			return _nodes.empty();
+	template<class FUNC>
+	void visitAllItems(int32_t nodeIndex, FUNC&& func) const {
+		const Node& node = _nodes[nodeIndex];
+		if (node.count == 0) {
+			return;
 		}
-
-		inline bool hasContent() const {
-			return !_contents.empty();
+		visitNodeItems(nodeIndex, func);
+		if (node.children == InvalidIndex) {
+			return;
 		}
+		for (int i = 0; i < 8; ++i) {
+			visitAllItems(node.children + i, func);
+		}
+	}
 
-		inline bool isEmpty() const {
-			return isLeaf() && _contents.empty();
+	template<class FUNC>
+	void visitNodes(int32_t nodeIndex, FUNC&& func) const {
+		core_trace_scoped(OctreeNodeVisit);
+		func(OctreeNode(this, nodeIndex));
+		const int32_t children = _nodes[nodeIndex].children;
+		if (children == InvalidIndex) {
+			return;
+		}
+		for (int i = 0; i < 8; ++i) {
+			visitNodes(children + i, func);
 		}
+	}
 
-		void query(const AABB<TYPE>& queryArea, Contents& results) const {
-			core_trace_scoped(OctreeNodeQueryAABB);
-			for (const NODE& item : _contents) {
-				if (intersects(queryArea, aabb(item))) {
-					results.push_back(item);
-				}
+	template<class FUNC>
+	void queryNode(int32_t nodeIndex, const AABB<TYPE>& area, FUNC&& func) const {
+		const Node& node = _nodes[nodeIndex];
+		for (int32_t i = node.items; i != InvalidIndex; i = _items[i].next) {
+			if (intersects(area, aabb(_items[i].value))) {
+				func(_items[i].value);
 			}
-
-			for (const typename Octree<NODE, TYPE>::OctreeNode& node : _nodes) {
-				if (node.isEmpty()) {
-					continue;
-				}
-
-				const AABB<TYPE>& aabb = node.aabb();
-				if (aabb.containsAABB(queryArea)) {
-					node.query(queryArea, results);
-					// the queried area is completely part of the node - so no other node can be involved
-					break;
-				}
-
-				if (queryArea.containsAABB(aabb)) {
-					node.getAllContents(results);
-					// the whole node content is part of the query
-					continue;
-				}
-
-				if (intersects(aabb, queryArea)) {
-					node.query(queryArea, results);
-				}
+		}
+		if (node.children == InvalidIndex) {
+			return;
+		}
+		for (int i = 0; i < 8; ++i) {
+			const int32_t childIndex = node.children + i;
+			const Node& child = _nodes[childIndex];
+			if (child.count == 0) {
+				continue;
+			}
+			if (child.aabb.containsAABB(area)) {
+				queryNode(childIndex, area, func);
+				// the queried area is completely part of the node - so no other node can be involved
+				break;
+			}
+			if (area.containsAABB(child.aabb)) {
+				// the whole node content is part of the query
+				visitAllItems(childIndex, func);
+				continue;
+			}
+			if (intersects(child.aabb, area)) {
+				queryNode(childIndex, area, func);
 			}
 		}
+	}
 
-		void query(const Frustum& queryArea, const AABB<TYPE>& queryAreaAABB, Contents& results) const {
-			core_trace_scoped(OctreeNodeQueryFrustum);
-			for (const NODE& item : _contents) {
-				const auto& itemAABB = aabb(item);
-				if (queryArea.isVisible(itemAABB.mins(), itemAABB.maxs())) {
-					results.push_back(item);
-				}
+	template<class FUNC>
+	void queryNode(int32_t nodeIndex, const SIMDFrustum& area, const AABB<TYPE>& areaAABB, FUNC&& func) const {
+		const Node& node = _nodes[nodeIndex];
+		for (int32_t i = node.items; i != InvalidIndex; i = _items[i].next) {
+			const AABB<TYPE>& itemAABB = aabb(_items[i].value);
+			if (area.isVisible(itemAABB.mins(), itemAABB.maxs())) {
+				func(_items[i].value);
 			}
-
-			for (const typename Octree<NODE, TYPE>::OctreeNode& node : _nodes) {
-				if (node.isEmpty()) {
-					continue;
-				}
-
-				const AABB<TYPE>& aabb = node.aabb();
-				if (aabb.containsAABB(queryAreaAABB)) {
-					node.query(queryArea, queryAreaAABB, results);
-					// the queried area is completely part of the node - so no other node can be involved
-					break;
-				}
-
-				const FrustumResult result = queryArea.test(aabb.mins(), aabb.maxs());
-				if (FrustumResult::Intersect == result) {
-					// some children might be visible - but other nodes might also still contribute
-					node.query(queryArea, queryAreaAABB, results);
-				} else if (FrustumResult::Inside == result) {
-					// the whole node content is part of the query
-					node.getAllContents(results);
-				}
+		}
+		if (node.children == InvalidIndex) {
+			return;
+		}
+		for (int i = 0; i < 8; ++i) {
+			const int32_t childIndex = node.children + i;
+			const Node& child = _nodes[childIndex];
+			if (child.count == 0) {
+				continue;
+			}
+			if (child.aabb.containsAABB(areaAABB)) {
+				queryNode(childIndex, area, areaAABB, func);
+				// the queried area is completely part of the node - so no other node can be involved
+				break;
+			}
+			const FrustumResult result = area.test(child.aabb.mins(), child.aabb.maxs());
+			if (FrustumResult::Intersect == result) {
+				// some children might be visible - but other nodes might also still contribute
+				queryNode(childIndex, area, areaAABB, func);
+			} else if (FrustumResult::Inside == result) {
+				// the whole node content is part of the query
+				visitAllItems(childIndex, func);
 			}
 		}
-	};
-private:
-	OctreeNode _root;
-	// dirty flag can be used for query caches
-	bool _dirty = false;
-	const IOctreeListener* _listener = nullptr;
+	}
 
 	template<class VISITOR>
 	void visit(const Frustum& queryArea, const AABB<TYPE>& queryAABB, VISITOR&& visitor, const glm::vec<3, TYPE>& minSize) const {
@@ -316,12 +345,13 @@ private:
 		const TYPE maxX = mins.x + width.x;
 		const TYPE maxY = mins.y + width.y;
 		const TYPE maxZ = mins.z + width.z;
+		const SIMDFrustum frustum(queryArea);
 		glm::tvec3<TYPE> qmins;
 		for (qmins.x = mins.x; qmins.x < maxX; qmins.x += minSize.x) {
 			for (qmins.y = mins.y; qmins.y < maxY; qmins.y += minSize.y) {
 				for (qmins.z = mins.z; qmins.z < maxZ; qmins.z += minSize.z) {
 					const glm::tvec3<TYPE> qmaxs(qmins + minSize);
-					if (!queryArea.isVisible(qmins, qmaxs)) {
+					if (!frustum.isVisible(qmins, qmaxs)) {
 						continue;
 					}
 					if (!visitor(qmins, qmaxs)) {
@@ -333,47 +363,184 @@ private:
 	}
 
 public:
+	/**
+	 * @brief Lightweight view of a node of the octree - only valid as long as the octree isn't modified
+	 */
+	class OctreeNode {
+		friend class Octree;
+	private:
+		const Octree* _octree;
+		int32_t _index;
+
+		inline const Node& node() const {
+			return _octree->_nodes[_index];
+		}
+
+		OctreeNode(const Octree* octree, int32_t index) :
+				_octree(octree), _index(index) {
+		}
+	public:
+		inline int depth() const {
+			return node().depth;
+		}
+
+		/**
+		 * @return The amount of items in this node and all of its children
+		 */
+		inline int count() const {
+			return node().count;
+		}
+
+		inline const AABB<TYPE>& aabb() const {
+			return node().aabb;
+		}
+
+		/**
+		 * @brief Calls the given functor for all items that are stored in this node (not the children)
+		 */
+		template<class FUNC>
+		inline void visitContents(FUNC&& func) const {
+			_octree->visitNodeItems(_index, func);
+		}
+
+		/**
+		 * @return A copy of the items that are stored in this node (not the children)
+		 * @sa visitContents()
+		 */
+		Contents getContents() const {
+			Contents contents;
+			visitContents([&] (const NODE& item) {
+				contents.push_back(item);
+			});
+			return contents;
+		}
+
+		void getAllContents(Contents& results) const {
+			_octree->visitAllItems(_index, [&] (const NODE& item) {
+				results.push_back(item);
+			});
+		}
+
+		inline bool isLeaf() const {
+			return node().children == InvalidIndex;
+		}
+
+		inline bool hasContent() const {
+			return node().items != InvalidIndex;
+		}
+
+		inline bool isEmpty() const {
+			return isLeaf() && !hasContent();
+		}
+	};
+
 	Octree(const AABB<TYPE>& aabb, int maxDepth = 10) :
-			_root(aabb, maxDepth, 0, this) {
+			_maxDepth(maxDepth) {
+		_nodes.emplace_back(aabb, InvalidIndex, 0);
 	}
 
 	inline int count() const {
-		core_trace_scoped(OctreeCount);
-		return _root.count();
+		return _nodes[0].count;
 	}
 
-	inline bool insert(const NODE& item) {
+	bool insert(const NODE& item) {
 		core_trace_scoped(OctreeInsert);
-		if (_root.insert(item)) {
-			_dirty = true;
-			return true;
+		const AABB<TYPE>& area = aabb(item);
+		if (!_nodes[0].aabb.containsAABB(area)) {
+			return false;
 		}
-		return false;
+		int32_t nodeIndex = 0;
+		for (;;) {
+			++_nodes[nodeIndex].count;
+			if (_nodes[nodeIndex].children == InvalidIndex && !createNodes(nodeIndex)) {
+				break;
+			}
+			const Node& node = _nodes[nodeIndex];
+			const int child = childIndex(node.aabb, area);
+			if (child == InvalidIndex) {
+				break;
+			}
+			nodeIndex = node.children + child;
+		}
+		const int32_t itemIndex = (int32_t)_items.size();
+		Node& node = _nodes[nodeIndex];
+		_items.emplace_back(item, nodeIndex, node.items);
+		if (node.items != InvalidIndex) {
+			_items[node.items].prev = itemIndex;
+		}
+		node.items = itemIndex;
+		_dirty = true;
+		return true;
 	}
 
-	inline bool remove(const NODE& item) {
+	bool remove(const NODE& item) {
 		core_trace_scoped(OctreeRemove);
-		if (_root.remove(item)) {
-			_dirty = true;
-			return true;
+		const AABB<TYPE>& area = aabb(item);
+		if (!_nodes[0].aabb.containsAABB(area)) {
+			return false;
+		}
+		// the node of an item only depends on its bounds
+		int32_t nodeIndex = 0;
+		for (;;) {
+			const Node& node = _nodes[nodeIndex];
+			if (node.children == InvalidIndex) {
+				break;
+			}
+			const int child = childIndex(node.aabb, area);
+			if (child == InvalidIndex) {
+				break;
+			}
+			nodeIndex = node.children + child;
+		}
+		for (int32_t i = _nodes[nodeIndex].items; i != InvalidIndex; i = _items[i].next) {
+			if (_items[i].value == item) {
+				removeItem(i);
+				_dirty = true;
+				return true;
+			}
 		}
 		return false;
 	}
 
 	inline const AABB<TYPE>& aabb() const {
-		core_trace_scoped(OctreeAABB);
-		return _root.aabb();
+		return _nodes[0].aabb;
 	}
 
-	inline void query(const AABB<TYPE>& area, Contents& results) const {
+	/**
+	 * @brief Calls the given functor for each item that intersects the given area
+	 */
+	template<class FUNC>
+	inline void visitItems(const AABB<TYPE>& area, FUNC&& func) const {
 		core_trace_scoped(OctreeQuery);
-		_root.query(area, results);
+		if (_nodes[0].count == 0) {
+			return;
+		}
+		queryNode(0, area, func);
 	}
 
-	inline void query(const Frustum& area, Contents& results) const {
+	/**
+	 * @brief Calls the given functor for each item that is visible in the given frustum
+	 */
+	template<class FUNC>
+	inline void visitItems(const Frustum& area, FUNC&& func) const {
 		core_trace_scoped(OctreeQuery);
+		if (_nodes[0].count == 0) {
+			return;
+		}
 		const AABB<float>& areaAABB = area.aabb();
-		_root.query(area, AABB<TYPE>(areaAABB.mins(), areaAABB.maxs()), results);
+		queryNode(0, SIMDFrustum(area), AABB<TYPE>(areaAABB.mins(), areaAABB.maxs()), func);
+	}
+
+	inline void query(const AABB<TYPE>& area, Contents& results) const {
+		visitItems(area, [&] (const NODE& item) {
+			results.push_back(item);
+		});
+	}
+
+	inline void query(const Frustum& area, Contents& results) const {
+		visitItems(area, [&] (const NODE& item) {
+			results.push_back(item);
+		});
 	}
 
 	/**
@@ -395,7 +562,6 @@ public:
 	template<class VISITOR>
 	inline void visit(const glm::vec<3, TYPE>& mins, const glm::vec<3, TYPE>& maxs, VISITOR&& visitor, const glm::vec<3, TYPE>& minSize) {
 		core_trace_scoped(OctreeVisit);
-		const math::AABB<TYPE> aabb(mins, maxs);
 		glm::tvec3<TYPE> qmins;
 		for (qmins.x = mins.x; qmins.x < maxs.x; qmins.x += minSize.x) {
 			for (qmins.y = mins.y; qmins.y < maxs.y; qmins.y += minSize.y) {
@@ -415,9 +581,12 @@ public:
 
 	void clear() {
 		_dirty = true;
-		_root._contents.clear();
-		_root._nodes.clear();
-		_root._nodes.reserve(4);
+		_nodes.resize(1, _nodes[0]);
+		Node& root = _nodes[0];
+		root.children = InvalidIndex;
+		root.items = InvalidIndex;
+		root.count = 0;
+		_items.clear();
 	}
 
 	inline void markAsClean() {
@@ -431,12 +600,17 @@ public:
 	inline void getContents(Contents& results) const {
 		results.clear();
 		results.reserve(count());
-		_root.getAllContents(results);
+		for (const Item& item : _items) {
+			results.push_back(item.value);
+		}
 	}
 
+	/**
+	 * @brief Calls the given functor with an @c OctreeNode for all nodes of the tree (depth first)
+	 */
 	template<class FUNC>
-	void visit(FUNC&& func) {
-		_root.visit(func);
+	void visit(FUNC&& func) const {
+		visitNodes(0, func);
 	}
 };
 
@@ -5,246 +5,322 @@
 #pragma once
 
 #include <vector>
-#include <list>
-#include "core/collection/Array.h"
 #include <algorithm>
 #include <limits>
+#include <stdint.h>
 #include <glm/vec2.hpp>
 #include "Rect.h"
 #include "core/Trace.h"
 
 namespace math {
 
+/**
+ * @brief Linear quad tree - the nodes and the items are stored in contiguous arrays.
+ *
+ * The four children of a node are allocated as one block. The items of a node are linked by index
+ * and removing an item moves the last item into the free slot. The queries are visitor based and
+ * don't allocate memory.
+ *
+ * @note Given NODE type must implement @c getRect() and return math::Rect<TYPE>
+ */
 template<class NODE, typename TYPE>
 class QuadTree {
 public:
-	typedef std::list<NODE> Contents;
+	typedef typename std::vector<NODE> Contents;
 private:
-	class QuadTreeNode {
-		friend class QuadTree;
-	private:
-		static inline Rect<TYPE> rect(const typename std::remove_pointer<NODE>::type* item) {
-			return item->getRect();
-		}
-
-		static inline Rect<TYPE> rect(const typename std::remove_pointer<NODE>::type& item) {
-			return item.getRect();
+	static constexpr int32_t InvalidIndex = -1;
+
+	struct Node {
+		Rect<TYPE> rect;
+		int32_t parent;
+		// index of the first of the four children - they are stored next to each other
+		int32_t children = InvalidIndex;
+		// head of the list of items that are stored in this node
+		int32_t items = InvalidIndex;
+		// amount of items in this node and all its children
+		int32_t count = 0;
+		int32_t depth;
+
+		Node(const Rect<TYPE>& _rect, int32_t _parent, int32_t _depth) :
+				rect(_rect), parent(_parent), depth(_depth) {
 		}
+	};
 
-		const int _maxDepth;
-		int _depth;
-		const Rect<TYPE> _area;
-		Contents _contents;
-		std::vector<QuadTreeNode> _nodes;
-
-		QuadTreeNode(const Rect<TYPE>& bounds, int maxDepth, int depth) :
-				_maxDepth(maxDepth), _depth(depth), _area(bounds) {
-		}
+	struct Item {
+		NODE value;
+		int32_t node;
+		int32_t prev;
+		int32_t next;
 
-	public:
-		QuadTreeNode(QuadTreeNode&& node) :
-				_maxDepth(node._maxDepth), _depth(node._depth), _area(node._area),
-				_contents(std::move(node._contents)), _nodes(std::move(node._nodes)) {
+		Item(const NODE& _value, int32_t _node, int32_t _next) :
+				value(_value), node(_node), prev(InvalidIndex), next(_next) {
 		}
+	};
 
-		QuadTreeNode(const QuadTreeNode& node) :
-				_maxDepth(node._maxDepth), _depth(node._depth), _area(node._area),
-				_contents(node._contents), _nodes(node._nodes) {
-		}
+	std::vector<Node> _nodes;
+	std::vector<Item> _items;
+	int _maxDepth;
+	// dirty flag can be used for query caches
+	bool _dirty = false;
 
-	private:
-		static void split(const Rect<TYPE>& rect, Rect<TYPE> (&result)[4]) {
-			if (Rect<TYPE>::getMaxRect() == rect) {
-				// special case because the length would exceed the max possible value of TYPE
-				if (std::numeric_limits<TYPE>::is_signed) {
-					static const Rect<TYPE> maxSplit[4] = {
-						Rect<TYPE>(rect.getMinX(), rect.getMinZ(), 0, 0),
-						Rect<TYPE>(0, rect.getMinZ(), rect.getMaxX(), 0),
-						Rect<TYPE>(rect.getMinX(), 0, 0, rect.getMaxX()),
-						Rect<TYPE>(0, 0, rect.getMaxX(), rect.getMaxX())
-					};
-					result[0] = maxSplit[0];
-					result[1] = maxSplit[1];
-					result[2] = maxSplit[2];
-					result[3] = maxSplit[3];
-					return;
-				}
-			}
+	static inline Rect<TYPE> rect(const typename std::remove_pointer<NODE>::type* item) {
+		return item->getRect();
+	}
 
-			const TYPE lengthX = rect.getMaxX() - rect.getMinX();
-			const TYPE halfX = lengthX / (TYPE)2;
-			const TYPE lengthY = rect.getMaxZ() - rect.getMinZ();
-			const TYPE halfY = lengthY / (TYPE)2;
-			result[0] = Rect<TYPE>(rect.getMinX(), rect.getMinZ(), rect.getMinX() + halfX, rect.getMinZ() + halfY);
-			result[1] = Rect<TYPE>(rect.getMinX() + halfX, rect.getMinZ(), rect.getMaxX(), rect.getMinZ() + halfY);
-			result[2] = Rect<TYPE>(rect.getMinX(), rect.getMinZ() + halfY, rect.getMinX() + halfX, rect.getMaxZ());
-			result[3] = Rect<TYPE>(rect.getMinX() + halfX, rect.getMinZ() + halfY, rect.getMaxX(), rect.getMaxZ());
-		}
+	static inline Rect<TYPE> rect(const typename std::remove_pointer<NODE>::type& item) {
+		return item.getRect();
+	}
 
-		void createNodes() {
-			if (_depth >= _maxDepth) {
+	static void split(const Rect<TYPE>& rect, Rect<TYPE> (&result)[4]) {
+		if (Rect<TYPE>::getMaxRect() == rect) {
+			// special case because the length would exceed the max possible value of TYPE
+			if (std::numeric_limits<TYPE>::is_signed) {
+				static const Rect<TYPE> maxSplit[4] = {
+					Rect<TYPE>(rect.getMinX(), rect.getMinZ(), 0, 0),
+					Rect<TYPE>(0, rect.getMinZ(), rect.getMaxX(), 0),
+					Rect<TYPE>(rect.getMinX(), 0, 0, rect.getMaxX()),
+					Rect<TYPE>(0, 0, rect.getMaxX(), rect.getMaxX())
+				};
+				result[0] = maxSplit[0];
+				result[1] = maxSplit[1];
+				result[2] = maxSplit[2];
+				result[3] = maxSplit[3];
 				return;
 			}
+		}
 
-			const auto& rect = getRect();
-			const glm::tvec2<TYPE>& rectSize = rect.size();
-			const constexpr glm::tvec2<TYPE> one((TYPE)1);
-			if (rectSize.x <= one.x && rectSize.y <= one.y) {
-				return;
-			}
+		const TYPE lengthX = rect.getMaxX() - rect.getMinX();
+		const TYPE halfX = lengthX / (TYPE)2;
+		const TYPE lengthY = rect.getMaxZ() - rect.getMinZ();
+		const TYPE halfY = lengthY / (TYPE)2;
+		result[0] = Rect<TYPE>(rect.getMinX(), rect.getMinZ(), rect.getMinX() + halfX, rect.getMinZ() + halfY);
+		result[1] = Rect<TYPE>(rect.getMinX() + halfX, rect.getMinZ(), rect.getMaxX(), rect.getMinZ() + halfY);
+		result[2] = Rect<TYPE>(rect.getMinX(), rect.getMinZ() + halfY, rect.getMinX() + halfX, rect.getMaxZ());
+		result[3] = Rect<TYPE>(rect.getMinX() + halfX, rect.getMinZ() + halfY, rect.getMaxX(), rect.getMaxZ());
+	}
 
-			Rect<TYPE> subareas[4];
-			split(rect, subareas);
-			_nodes.reserve(4);
-			for (size_t i = 0; i < 4; ++i) {
-				_nodes.emplace_back(QuadTreeNode(subareas[i], _maxDepth, _depth + 1));
-			}
+	bool createNodes(int32_t nodeIndex) {
+		const Node& node = _nodes[nodeIndex];
+		if (node.depth >= _maxDepth) {
+			return false;
 		}
 
-		inline int count() const {
-			int count = 0;
-			for (const QuadTreeNode& node : _nodes) {
-				count += node.count();
-			}
-			count += (int)_contents.size();
-			return count;
+		const Rect<TYPE> nodeRect = node.rect;
+		const glm::tvec2<TYPE>& rectSize = nodeRect.size();
+		const constexpr glm::tvec2<TYPE> one((TYPE)1);
+		if (rectSize.x <= one.x && rectSize.y <= one.y) {
+			return false;
 		}
 
-		inline const Rect<TYPE>& getRect() const {
-			return _area;
+		Rect<TYPE> subareas[4];
+		split(nodeRect, subareas);
+		const int32_t children = (int32_t)_nodes.size();
+		const int32_t depth = node.depth + 1;
+		// this might invalidate the node reference
+		for (int i = 0; i < 4; ++i) {
+			_nodes.emplace_back(subareas[i], nodeIndex, depth);
 		}
+		_nodes[nodeIndex].children = children;
+		return true;
+	}
 
-		inline const Contents& getContents() const {
-			return _contents;
+	/**
+	 * @return The index of the child node that contains the given area or @c -1 if the area
+	 * doesn't fit into any of the children
+	 */
+	inline int32_t findChild(int32_t nodeIndex, const Rect<TYPE>& area) const {
+		const int32_t children = _nodes[nodeIndex].children;
+		if (children == InvalidIndex) {
+			return InvalidIndex;
 		}
-
-		void getAllContents(Contents& results) const {
-			for (const QuadTreeNode& node : _nodes) {
-				if (node.isEmpty()) {
-					continue;
-				}
-				node.getAllContents(results);
+		for (int32_t i = children; i < children + 4; ++i) {
+			if (_nodes[i].rect.contains(area)) {
+				return i;
 			}
+		}
+		return InvalidIndex;
+	}
 
-			// faster for list - but slower for vector
-			std::copy(_contents.begin(), _contents.end(), std::back_inserter(results));
+	void updateCount(int32_t nodeIndex, int32_t delta) {
+		while (nodeIndex != InvalidIndex) {
+			Node& node = _nodes[nodeIndex];
+			node.count += delta;
+			nodeIndex = node.parent;
 		}
+	}
 
-		bool remove(const NODE& item) {
-			const Rect<TYPE>& area = rect(item);
-			if (!getRect().contains(area)) {
-				return false;
+	void removeItem(int32_t itemIndex) {
+		Item& item = _items[itemIndex];
+		if (item.prev != InvalidIndex) {
+			_items[item.prev].next = item.next;
+		} else {
+			_nodes[item.node].items = item.next;
+		}
+		if (item.next != InvalidIndex) {
+			_items[item.next].prev = item.prev;
+		}
+		updateCount(item.node, -1);
+
+		// move the last item into the free slot
+		const int32_t last = (int32_t)_items.size() - 1;
+		if (itemIndex != last) {
+			_items[itemIndex] = std::move(_items[last]);
+			const Item& moved = _items[itemIndex];
+			if (moved.prev != InvalidIndex) {
+				_items[moved.prev].next = itemIndex;
+			} else {
+				_nodes[moved.node].items = itemIndex;
 			}
-			for (QuadTreeNode& node : _nodes) {
-				if (!node.remove(item)) {
-					continue;
-				}
-				return true;
+			if (moved.next != InvalidIndex) {
+				_items[moved.next].prev = itemIndex;
 			}
+		}
+		_items.pop_back();
+	}
 
-			auto i = std::find(_contents.begin(), _contents.end(), item);
-			if (i == _contents.end()) {
-				return false;
-			}
-			_contents.erase(i);
-			return true;
+	template<class FUNC>
+	void visitAllItems(int32_t nodeIndex, FUNC&& func) const {
+		const Node& node = _nodes[nodeIndex];
+		if (node.count == 0) {
+			return;
+		}
+		for (int32_t i = node.items; i != InvalidIndex; i = _items[i].next) {
+			func(_items[i].value);
 		}
+		if (node.children == InvalidIndex) {
+			return;
+		}
+		for (int i = 0; i < 4; ++i) {
+			visitAllItems(node.children + i, func);
+		}
+	}
 
-		bool insert(const NODE& item) {
-			const Rect<TYPE>& area = rect(item);
-			if (!getRect().contains(area)) {
-				return false;
+	template<class FUNC>
+	void queryNode(int32_t nodeIndex, const Rect<TYPE>& queryArea, FUNC&& func) const {
+		const Node& node = _nodes[nodeIndex];
+		for (int32_t i = node.items; i != InvalidIndex; i = _items[i].next) {
+			if (queryArea.intersectsWith(rect(_items[i].value))) {
+				func(_items[i].value);
 			}
-
-			if (_nodes.empty()) {
-				createNodes();
+		}
+		if (node.children == InvalidIndex) {
+			return;
+		}
+		for (int i = 0; i < 4; ++i) {
+			const int32_t childIndex = node.children + i;
+			const Node& child = _nodes[childIndex];
+			if (child.count == 0) {
+				continue;
 			}
 
-			for (QuadTreeNode& node : _nodes) {
-				if (!node.insert(item)) {
-					continue;
-				}
-				return true;
+			if (child.rect.contains(queryArea)) {
+				queryNode(childIndex, queryArea, func);
+				// the queried area is completely part of the node
+				break;
 			}
 
-			_contents.push_back(item);
-			return true;
-		}
-
-		inline bool isEmpty() const {
-			return _nodes.empty() && _contents.empty();
-		}
-
-		void query(const Rect<TYPE>& queryArea, Contents& results) const {
-			for (const NODE& item : _contents) {
-				const Rect<TYPE>& area = rect(item);
-				if (queryArea.intersectsWith(area)) {
-					results.push_back(item);
-				}
+			if (queryArea.contains(child.rect)) {
+				visitAllItems(childIndex, func);
+				// the whole node content is part of the query
+				continue;
 			}
 
-			for (const QuadTreeNode& node : _nodes) {
-				if (node.isEmpty()) {
-					continue;
-				}
-
-				if (node.getRect().contains(queryArea)) {
-					node.query(queryArea, results);
-					// the queried area is completely part of the node
-					break;
-				}
-
-				if (queryArea.contains(node.getRect())) {
-					node.getAllContents(results);
-					// the whole node content is part of the query
-					continue;
-				}
-
-				if (node.getRect().intersectsWith(queryArea)) {
-					node.query(queryArea, results);
-				}
+			if (child.rect.intersectsWith(queryArea)) {
+				queryNode(childIndex, queryArea, func);
 			}
 		}
-	};
+	}
 
-	QuadTreeNode _root;
-	// dirty flag can be used for query caches
-	bool _dirty;
 public:
 	QuadTree(const Rect<TYPE>& rectangle, int maxDepth = 10) :
-			_root(rectangle, maxDepth, 0), _dirty(false) {
+			_maxDepth(maxDepth) {
+		_nodes.emplace_back(rectangle, InvalidIndex, 0);
 	}
 
 	inline int count() const {
-		return _root.count();
+		return _nodes[0].count;
 	}
 
-	inline bool insert(const NODE& item) {
-		if (_root.insert(item)) {
-			_dirty = true;
-			return true;
+	bool insert(const NODE& item) {
+		core_trace_scoped(QuadTreeInsert);
+		const Rect<TYPE>& area = rect(item);
+		if (!_nodes[0].rect.contains(area)) {
+			return false;
 		}
-		return false;
+		int32_t nodeIndex = 0;
+		for (;;) {
+			++_nodes[nodeIndex].count;
+			if (_nodes[nodeIndex].children == InvalidIndex && !createNodes(nodeIndex)) {
+				break;
+			}
+			const int32_t child = findChild(nodeIndex, area);
+			if (child == InvalidIndex) {
+				break;
+			}
+			nodeIndex = child;
+		}
+		const int32_t itemIndex = (int32_t)_items.size();
+		Node& node = _nodes[nodeIndex];
+		_items.emplace_back(item, nodeIndex, node.items);
+		if (node.items != InvalidIndex) {
+			_items[node.items].prev = itemIndex;
+		}
+		node.items = itemIndex;
+		_dirty = true;
+		return true;
 	}
 
-	inline bool remove(const NODE& item) {
-		if (_root.remove(item)) {
-			_dirty = true;
-			return true;
+	bool remove(const NODE& item) {
+		core_trace_scoped(QuadTreeRemove);
+		const Rect<TYPE>& area = rect(item);
+		if (!_nodes[0].rect.contains(area)) {
+			return false;
+		}
+		// the node of an item only depends on its bounds
+		int32_t nodeIndex = 0;
+		for (;;) {
+			const int32_t child = findChild(nodeIndex, area);
+			if (child == InvalidIndex) {
+				break;
+			}
+			nodeIndex = child;
+		}
+		for (int32_t i = _nodes[nodeIndex].items; i != InvalidIndex; i = _items[i].next) {
+			if (_items[i].value == item) {
+				removeItem(i);
+				_dirty = true;
+				return true;
+			}
 		}
 		return false;
 	}
 
-	inline void query(const Rect<TYPE>& area, Contents& results) const {
+	/**
+	 * @brief Calls the given functor for each item that intersects the given area
+	 */
+	template<class FUNC>
+	inline void visitItems(const Rect<TYPE>& area, FUNC&& func) const {
 		core_trace_scoped(QuadTreeQuery);
-		_root.query(area, results);
+		if (_nodes[0].count == 0) {
+			return;
+		}
+		queryNode(0, area, func);
+	}
+
+	inline void query(const Rect<TYPE>& area, Contents& results) const {
+		visitItems(area, [&] (const NODE& item) {
+			results.push_back(item);
+		});
 	}
 
 	void clear() {
 		_dirty = true;
-		_root._contents.clear();
-		_root._nodes.clear();
-		_root._nodes.reserve(4);
+		_nodes.resize(1, _nodes[0]);
+		Node& root = _nodes[0];
+		root.children = InvalidIndex;
+		root.items = InvalidIndex;
+		root.count = 0;
+		_items.clear();
 	}
 
 	inline void markAsClean() {
@@ -258,7 +334,9 @@ public:
 	inline void getContents(Contents& results) const {
 		results.clear();
 		results.reserve(count());
-		_root.getAllContents(results);
+		for (const Item& item : _items) {
+			results.push_back(item.value);
+		}
 	}
 };
 
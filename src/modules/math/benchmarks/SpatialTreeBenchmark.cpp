@@ -0,0 +1,171 @@
+/**
+ * @file
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "math/Octree.h"
+#include "math/QuadTree.h"
+#include "math/Random.h"
+
+namespace {
+
+class OctreeItem {
+private:
+	math::AABB<int> _bounds;
+	int _id;
+public:
+	OctreeItem(const math::AABB<int>& bounds, int id) :
+			_bounds(bounds), _id(id) {
+	}
+
+	const math::AABB<int>& aabb() const {
+		return _bounds;
+	}
+
+	bool operator==(const OctreeItem& rhs) const {
+		return rhs._id == _id;
+	}
+};
+
+class QuadTreeItem {
+private:
+	math::RectFloat _bounds;
+	int _id;
+public:
+	QuadTreeItem(const math::RectFloat& bounds, int id) :
+			_bounds(bounds), _id(id) {
+	}
+
+	math::RectFloat getRect() const {
+		return _bounds;
+	}
+
+	bool operator==(const QuadTreeItem& rhs) const {
+		return rhs._id == _id;
+	}
+};
+
+const int TreeSize = 4096;
+const int ItemSize = 16;
+
+}
+
+class SpatialTreeBenchmark : public core::AbstractBenchmark {
+protected:
+	std::vector<OctreeItem> _octreeItems;
+	std::vector<QuadTreeItem> _quadTreeItems;
+public:
+	void SetUp(benchmark::State& state) override {
+		core::AbstractBenchmark::SetUp(state);
+		const int n = (int)state.range(0);
+		math::Random random(n);
+		_octreeItems.clear();
+		_quadTreeItems.clear();
+		_octreeItems.reserve(n);
+		_quadTreeItems.reserve(n);
+		for (int i = 0; i < n; ++i) {
+			const int x = random.random(0, TreeSize - ItemSize - 1);
+			const int y = random.random(0, TreeSize - ItemSize - 1);
+			const int z = random.random(0, TreeSize - ItemSize - 1);
+			_octreeItems.emplace_back(math::AABB<int>(x, y, z, x + ItemSize, y + ItemSize, z + ItemSize), i);
+			_quadTreeItems.emplace_back(math::RectFloat((float)x, (float)z, (float)(x + ItemSize), (float)(z + ItemSize)), i);
+		}
+	}
+};
+
+BENCHMARK_DEFINE_F(SpatialTreeBenchmark, OctreeInsert)(benchmark::State &state) {
+	for (auto _ : state) {
+		math::Octree<OctreeItem> octree({0, 0, 0, TreeSize, TreeSize, TreeSize});
+		for (const OctreeItem& item : _octreeItems) {
+			octree.insert(item);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * _octreeItems.size());
+}
+
+BENCHMARK_DEFINE_F(SpatialTreeBenchmark, OctreeQuery)(benchmark::State &state) {
+	math::Octree<OctreeItem> octree({0, 0, 0, TreeSize, TreeSize, TreeSize});
+	for (const OctreeItem& item : _octreeItems) {
+		octree.insert(item);
+	}
+	math::Octree<OctreeItem>::Contents contents;
+	contents.reserve(_octreeItems.size());
+	int64_t found = 0;
+	for (auto _ : state) {
+		for (const OctreeItem& item : _octreeItems) {
+			contents.clear();
+			octree.query(item.aabb(), contents);
+			found += (int64_t)contents.size();
+		}
+	}
+	benchmark::DoNotOptimize(found);
+	state.SetItemsProcessed(state.iterations() * _octreeItems.size());
+}
+
+BENCHMARK_DEFINE_F(SpatialTreeBenchmark, OctreeRemove)(benchmark::State &state) {
+	for (auto _ : state) {
+		state.PauseTiming();
+		math::Octree<OctreeItem> octree({0, 0, 0, TreeSize, TreeSize, TreeSize});
+		for (const OctreeItem& item : _octreeItems) {
+			octree.insert(item);
+		}
+		state.ResumeTiming();
+		for (const OctreeItem& item : _octreeItems) {
+			octree.remove(item);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * _octreeItems.size());
+}
+
+BENCHMARK_DEFINE_F(SpatialTreeBenchmark, QuadTreeInsert)(benchmark::State &state) {
+	for (auto _ : state) {
+		math::QuadTree<QuadTreeItem, float> quadTree(math::RectFloat(0.0f, 0.0f, (float)TreeSize, (float)TreeSize));
+		for (const QuadTreeItem& item : _quadTreeItems) {
+			quadTree.insert(item);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * _quadTreeItems.size());
+}
+
+BENCHMARK_DEFINE_F(SpatialTreeBenchmark, QuadTreeQuery)(benchmark::State &state) {
+	math::QuadTree<QuadTreeItem, float> quadTree(math::RectFloat(0.0f, 0.0f, (float)TreeSize, (float)TreeSize));
+	for (const QuadTreeItem& item : _quadTreeItems) {
+		quadTree.insert(item);
+	}
+	math::QuadTree<QuadTreeItem, float>::Contents contents;
+	contents.reserve(_quadTreeItems.size());
+	int64_t found = 0;
+	for (auto _ : state) {
+		for (const QuadTreeItem& item : _quadTreeItems) {
+			contents.clear();
+			quadTree.query(item.getRect(), contents);
+			found += (int64_t)contents.size();
+		}
+	}
+	benchmark::DoNotOptimize(found);
+	state.SetItemsProcessed(state.iterations() * _quadTreeItems.size());
+}
+
+BENCHMARK_DEFINE_F(SpatialTreeBenchmark, QuadTreeRemove)(benchmark::State &state) {
+	for (auto _ : state) {
+		state.PauseTiming();
+		math::QuadTree<QuadTreeItem, float> quadTree(math::RectFloat(0.0f, 0.0f, (float)TreeSize, (float)TreeSize));
+		for (const QuadTreeItem& item : _quadTreeItems) {
+			quadTree.insert(item);
+		}
+		state.ResumeTiming();
+		for (const QuadTreeItem& item : _quadTreeItems) {
+			quadTree.remove(item);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * _quadTreeItems.size());
+}
+
+BENCHMARK_REGISTER_F(SpatialTreeBenchmark, OctreeInsert)->RangeMultiplier(4)->Range(64, 16384);
+BENCHMARK_REGISTER_F(SpatialTreeBenchmark, OctreeQuery)->RangeMultiplier(4)->Range(64, 16384);
+BENCHMARK_REGISTER_F(SpatialTreeBenchmark, OctreeRemove)->RangeMultiplier(4)->Range(64, 16384);
+BENCHMARK_REGISTER_F(SpatialTreeBenchmark, QuadTreeInsert)->RangeMultiplier(4)->Range(64, 16384);
+BENCHMARK_REGISTER_F(SpatialTreeBenchmark, QuadTreeQuery)->RangeMultiplier(4)->Range(64, 16384);
+BENCHMARK_REGISTER_F(SpatialTreeBenchmark, QuadTreeRemove)->RangeMultiplier(4)->Range(64, 16384);
+
+BENCHMARK_MAIN();
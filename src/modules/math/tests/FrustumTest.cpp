@@ -160,4 +160,17 @@ TEST_F(FrustumTest, testOrthoFrustum) {
 	EXPECT_FALSE(frustum.isVisible(glm::ivec3(-66, -32, 64), glm::ivec3(-65, 0, 96)));
 }
 
+TEST_F(FrustumTest, testSIMDFrustum) {
+	const math::Frustum frustum(glm::ivec3(-64, -32, -32), glm::ivec3(64, 32, 96));
+	const math::SIMDFrustum simdFrustum(frustum);
+	for (int x = -96; x < 96; x += 16) {
+		for (int z = -64; z < 128; z += 16) {
+			const glm::vec3 mins(x, -8, z);
+			const glm::vec3 maxs(x + 24, 8, z + 24);
+			EXPECT_EQ(frustum.test(mins, maxs), simdFrustum.test(mins, maxs)) << glm::to_string(mins) << ", " << glm::to_string(maxs);
+			EXPECT_EQ(frustum.isVisible(mins, maxs), simdFrustum.isVisible(mins, maxs)) << glm::to_string(mins) << ", " << glm::to_string(maxs);
+		}
+	}
+}
+
 }
@@ -0,0 +1,110 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "math/OcclusionBuffer.h"
+#include "core/GLM.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <cfloat>
+
+namespace math {
+
+class OcclusionBufferTest : public core::AbstractTest {
+protected:
+	OcclusionBuffer _buffer { 128, 64 };
+
+	void SetUp() override {
+		core::AbstractTest::SetUp();
+		// looking from the origin along the negative z axis
+		lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+	}
+
+	void lookAt(const glm::vec3& eye, const glm::vec3& center) {
+		const glm::mat4& view = glm::lookAt(eye, center, glm::up);
+		const glm::mat4& projection = glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 500.0f);
+		_buffer.clear(projection * view);
+	}
+};
+
+TEST_F(OcclusionBufferTest, testEmpty) {
+	EXPECT_TRUE(_buffer.isVisible(glm::vec3(-1.0f, -1.0f, -20.0f), glm::vec3(1.0f, 1.0f, -18.0f)));
+	EXPECT_EQ(FLT_MAX, _buffer.depth(_buffer.width() / 2, _buffer.height() / 2));
+}
+
+TEST_F(OcclusionBufferTest, testWall) {
+	// a wall that covers the whole view
+	_buffer.addOccluder(glm::vec3(-100.0f, -100.0f, -11.0f), glm::vec3(100.0f, 100.0f, -10.0f));
+	EXPECT_EQ(1, _buffer.occluders());
+	EXPECT_LT(_buffer.depth(_buffer.width() / 2, _buffer.height() / 2), 1.0f);
+	// behind the wall
+	EXPECT_FALSE(_buffer.isVisible(glm::vec3(-1.0f, -1.0f, -20.0f), glm::vec3(1.0f, 1.0f, -18.0f)));
+	EXPECT_FALSE(_buffer.isVisible(glm::vec3(-50.0f, -5.0f, -200.0f), glm::vec3(50.0f, 5.0f, -100.0f)));
+	// in front of the wall
+	EXPECT_TRUE(_buffer.isVisible(glm::vec3(-1.0f, -1.0f, -8.0f), glm::vec3(1.0f, 1.0f, -6.0f)));
+	// intersects the wall
+	EXPECT_TRUE(_buffer.isVisible(glm::vec3(-1.0f, -1.0f, -12.0f), glm::vec3(1.0f, 1.0f, -9.0f)));
+	// intersects the near plane
+	EXPECT_TRUE(_buffer.isVisible(glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(1.0f, 1.0f, 1.0f)));
+}
+
+TEST_F(OcclusionBufferTest, testPartialOccluder) {
+	// covers the left half of the view
+	_buffer.addOccluder(glm::vec3(-100.0f, -100.0f, -11.0f), glm::vec3(0.0f, 100.0f, -10.0f));
+	EXPECT_FALSE(_buffer.isVisible(glm::vec3(-20.0f, -1.0f, -40.0f), glm::vec3(-10.0f, 1.0f, -30.0f)));
+	EXPECT_TRUE(_buffer.isVisible(glm::vec3(10.0f, -1.0f, -40.0f), glm::vec3(20.0f, 1.0f, -30.0f)));
+	// partially hidden boxes are visible
+	EXPECT_TRUE(_buffer.isVisible(glm::vec3(-10.0f, -1.0f, -40.0f), glm::vec3(10.0f, 1.0f, -30.0f)));
+}
+
+TEST_F(OcclusionBufferTest, testGap) {
+	// the world x coordinate at the distance of the walls for the given texel column
+	const float distance = 10.0f;
+	auto worldX = [&] (float texel) {
+		return (texel / (_buffer.width() * 0.5f) - 1.0f) * distance * glm::tan(glm::radians(30.0f)) * 2.0f;
+	};
+	// two walls with a gap of less than one texel between them - it doesn't contain any texel center
+	const int column = _buffer.width() / 2;
+	_buffer.addOccluder(glm::vec3(-100.0f, -100.0f, -distance - 1.0f), glm::vec3(worldX(column - 0.3f), 100.0f, -distance));
+	_buffer.addOccluder(glm::vec3(worldX(column + 0.3f), -100.0f, -distance - 1.0f), glm::vec3(100.0f, 100.0f, -distance));
+	EXPECT_EQ(FLT_MAX, _buffer.depth(column - 1, _buffer.height() / 2));
+	EXPECT_EQ(FLT_MAX, _buffer.depth(column, _buffer.height() / 2));
+	EXPECT_LT(_buffer.depth(column - 2, _buffer.height() / 2), 1.0f);
+	EXPECT_LT(_buffer.depth(column + 1, _buffer.height() / 2), 1.0f);
+	// a pole behind the walls that is visible through the gap
+	EXPECT_TRUE(_buffer.isVisible(glm::vec3(-0.05f, -1.0f, -40.0f), glm::vec3(0.05f, 1.0f, -30.0f)));
+	// but not behind one of the walls
+	EXPECT_FALSE(_buffer.isVisible(glm::vec3(-5.05f, -1.0f, -40.0f), glm::vec3(-4.95f, 1.0f, -30.0f)));
+}
+
+TEST_F(OcclusionBufferTest, testBackFacing) {
+	// only the faces towards the camera are rasterized - the depth is the front face of the box
+	_buffer.addOccluder(glm::vec3(-100.0f, -100.0f, -50.0f), glm::vec3(100.0f, 100.0f, -10.0f));
+	EXPECT_TRUE(_buffer.isVisible(glm::vec3(-1.0f, -1.0f, -9.5f), glm::vec3(1.0f, 1.0f, -9.0f)));
+	EXPECT_FALSE(_buffer.isVisible(glm::vec3(-1.0f, -1.0f, -60.0f), glm::vec3(1.0f, 1.0f, -55.0f)));
+}
+
+TEST_F(OcclusionBufferTest, testNearPlaneClipping) {
+	// the camera stands on the ground - the ground box intersects the near plane and hides everything below
+	lookAt(glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(0.0f, -1.0f, -10.0f));
+	_buffer.addOccluder(glm::vec3(-200.0f, -50.0f, -200.0f), glm::vec3(200.0f, 0.0f, 200.0f));
+	EXPECT_EQ(1, _buffer.occluders());
+	// underground
+	EXPECT_FALSE(_buffer.isVisible(glm::vec3(-5.0f, -20.0f, -30.0f), glm::vec3(5.0f, -10.0f, -20.0f)));
+	// above the ground
+	EXPECT_TRUE(_buffer.isVisible(glm::vec3(-5.0f, 0.5f, -30.0f), glm::vec3(5.0f, 5.0f, -20.0f)));
+}
+
+TEST_F(OcclusionBufferTest, testHillsAndValley) {
+	// a hill hides the valley behind it - but not the mountain that is higher than the hill
+	lookAt(glm::vec3(0.0f, 12.0f, 0.0f), glm::vec3(0.0f, 12.0f, -10.0f));
+	_buffer.addOccluder(glm::vec3(-200.0f, 0.0f, -40.0f), glm::vec3(200.0f, 20.0f, -30.0f));
+	EXPECT_FALSE(_buffer.isVisible(glm::vec3(-10.0f, 0.0f, -100.0f), glm::vec3(10.0f, 15.0f, -80.0f)));
+	EXPECT_TRUE(_buffer.isVisible(glm::vec3(-10.0f, 0.0f, -100.0f), glm::vec3(10.0f, 60.0f, -80.0f)));
+	// the hidden box is visible again once the occluders are cleared
+	lookAt(glm::vec3(0.0f, 12.0f, 0.0f), glm::vec3(0.0f, 12.0f, -10.0f));
+	EXPECT_EQ(0, _buffer.occluders());
+	EXPECT_TRUE(_buffer.isVisible(glm::vec3(-10.0f, 0.0f, -100.0f), glm::vec3(10.0f, 15.0f, -80.0f)));
+}
+
+}
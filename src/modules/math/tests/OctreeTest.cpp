@@ -122,6 +122,30 @@ TEST_F(OctreeTest, testRemove) {
 	EXPECT_EQ(1, octree.count())<<"Expected to have 0 entries in the octree";
 }
 
+TEST_F(OctreeTest, testRemoveMany) {
+	Octree<oc::Item, int> octree({0, 0, 0, 128, 128, 128});
+	int id = 0;
+	for (int i = 0; i < 128; i += 8) {
+		EXPECT_TRUE(octree.insert({{i, i, i, i + 4, i + 4, i + 4}, id++}));
+		// spans the center of the root node
+		EXPECT_TRUE(octree.insert({{60, i / 2, 60, 68, i / 2 + 4, 68}, id++}));
+	}
+	EXPECT_EQ(id, octree.count());
+	for (int i = 0, n = 0; i < 128; i += 8, n += 2) {
+		EXPECT_TRUE(octree.remove({{i, i, i, i + 4, i + 4, i + 4}, n}));
+		EXPECT_FALSE(octree.remove({{i, i, i, i + 4, i + 4, i + 4}, n})) << "Item " << n << " was already removed";
+	}
+	EXPECT_EQ(id / 2, octree.count());
+	Octree<oc::Item, int>::Contents contents;
+	octree.query({0, 0, 0, 128, 128, 128}, contents);
+	EXPECT_EQ((size_t)(id / 2), contents.size());
+	int visited = 0;
+	octree.visitItems({60, 1, 60, 68, 7, 68}, [&] (const oc::Item& item) {
+		++visited;
+	});
+	EXPECT_EQ(2, visited);
+}
+
 TEST_F(OctreeTest, testQuery) {
 	Octree<oc::Item, int> octree({0, 0, 0, 100, 100, 100}, 3);
 	{
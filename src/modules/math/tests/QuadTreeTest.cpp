@@ -48,6 +48,23 @@ TEST(QuadTreeTest, testRemove) {
 	EXPECT_EQ(0, quadTree.count())<<"Expected to have 0 entries in the quad tree";
 }
 
+TEST(QuadTreeTest, testRemoveMany) {
+	QuadTree<quad::Item, float> quadTree(RectFloat(0, 0, 128, 128));
+	for (int i = 0; i < 32; ++i) {
+		const float pos = (float)(i * 4);
+		EXPECT_TRUE(quadTree.insert(quad::Item(RectFloat(pos, pos, pos + 2.0f, pos + 2.0f), i)));
+	}
+	EXPECT_EQ(32, quadTree.count());
+	for (int i = 0; i < 32; i += 2) {
+		const float pos = (float)(i * 4);
+		EXPECT_TRUE(quadTree.remove(quad::Item(RectFloat(pos, pos, pos + 2.0f, pos + 2.0f), i)));
+	}
+	EXPECT_EQ(16, quadTree.count());
+	QuadTree<quad::Item, float>::Contents contents;
+	quadTree.query(RectFloat(0.0f, 0.0f, 64.0f, 64.0f), contents);
+	EXPECT_EQ(8u, contents.size());
+}
+
 TEST(QuadTreeTest, testMax) {
 	QuadTree<quad::Item, float> quadTree(RectFloat::getMaxRect());
 	EXPECT_EQ(0, quadTree.count())<< "Expected to have no entries in the quad tree";
@@ -20,7 +20,7 @@ void ClientNetwork::shutdown() {
 	Super::shutdown();
 }
 
-bool ClientNetwork::packetReceived(ENetEvent& event) {
+bool ClientNetwork::packetReceived(ENetEvent& event, const Connection& connection) {
 	flatbuffers::Verifier v(event.packet->data, event.packet->dataLength);
 
 	if (!VerifyServerMessageBuffer(v)) {
@@ -35,7 +35,7 @@ bool ClientNetwork::packetReceived(ENetEvent& event) {
 		return false;
 	}
 	Log::debug("Received %s", EnumNameServerMsgType(type));
-	handler->execute(event.peer, reinterpret_cast<const flatbuffers::Table*>(req->data()));
+	handler->execute(connection, event.peer->data, reinterpret_cast<const flatbuffers::Table*>(req->data()));
 	return true;
 }
 
@@ -88,7 +88,7 @@ void ClientNetwork::disconnect() {
 	const size_t peerCount = _client->peerCount;
 	for (size_t i = 0; i < peerCount; ++i) {
 		ENetPeer *peer = &_client->peers[i];
-		disconnectPeer(peer, DisconnectReason::Disconnect);
+		disconnectPeer(peerConnection(peer), DisconnectReason::Disconnect);
 	}
 }
 
@@ -138,6 +138,22 @@ bool ClientNetwork::isDisconnecting() const {
 			peer.state == ENET_PEER_STATE_ACKNOWLEDGING_DISCONNECT;
 }
 
+TrafficStats ClientNetwork::consumeTrafficStats() {
+	TrafficStats stats;
+	if (_client == nullptr) {
+		return stats;
+	}
+	stats.sentBytes = _client->totalSentData;
+	stats.receivedBytes = _client->totalReceivedData;
+	stats.sentPackets = _client->totalSentPackets;
+	stats.receivedPackets = _client->totalReceivedPackets;
+	_client->totalSentData = 0u;
+	_client->totalReceivedData = 0u;
+	_client->totalSentPackets = 0u;
+	_client->totalReceivedPackets = 0u;
+	return stats;
+}
+
 void ClientNetwork::update() {
 	core_trace_scoped(Network);
 	updateHost(_client);
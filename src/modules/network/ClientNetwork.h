@@ -8,6 +8,16 @@
 
 namespace network {
 
+/**
+ * @brief The traffic of the connection including the protocol overhead of enet
+ */
+struct TrafficStats {
+	uint32_t sentBytes = 0u;
+	uint32_t receivedBytes = 0u;
+	uint32_t sentPackets = 0u;
+	uint32_t receivedPackets = 0u;
+};
+
 class ClientNetwork : public Network {
 private:
 	ENetHost* _client = nullptr;
@@ -18,7 +28,7 @@ public:
 
 	ENetPeer* connect(uint16_t port, const core::String& hostname, int maxChannels = 1);
 	void disconnect();
-	bool packetReceived(ENetEvent& event) override;
+	bool packetReceived(ENetEvent& event, const Connection& connection) override;
 
 	bool isConnecting() const;
 	bool isConnected() const;
@@ -38,6 +48,11 @@ public:
 
 	void destroy();
 
+	/**
+	 * @return The traffic since the last call - the counters of the host are reset
+	 */
+	TrafficStats consumeTrafficStats();
+
 	void update();
 	void shutdown() override;
 };
@@ -0,0 +1,39 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+extern "C" {
+#include <enet/enet.h>
+}
+#include <stdint.h>
+
+namespace network {
+
+/**
+ * @brief The connection of a peer
+ *
+ * enet reuses the peer slots for new connections. The connect id and the address are recorded by the thread
+ * that services the host once the connection is established - they identify the connection for its whole
+ * lifetime. Unlike the fields of the @c ENetPeer they can be read from any thread.
+ */
+struct Connection {
+	ENetPeer* peer = nullptr;
+	uint32_t connectID = 0u;
+	ENetAddress address { 0u, 0u };
+
+	inline bool valid() const {
+		return peer != nullptr;
+	}
+
+	inline bool operator==(const Connection& other) const {
+		return peer == other.peer && connectID == other.connectID;
+	}
+
+	inline bool operator!=(const Connection& other) const {
+		return !(*this == other);
+	}
+};
+
+}
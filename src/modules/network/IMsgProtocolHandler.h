@@ -29,8 +29,8 @@ public:
 
 	virtual void execute(ATTACHMENTTYPE* attachment, const MSGTYPE* message) = 0;
 
-	virtual void execute(ENetPeer* peer, const void* message) override {
-		auto* attachment = getAttachment<ATTACHMENTTYPE>(peer);
+	virtual void execute(const Connection& connection, void* data, const void* message) override {
+		auto* attachment = getAttachment<ATTACHMENTTYPE>(data);
 		if (_needsAttachment && attachment == nullptr) {
 			::Log::error("No attachment yet for a message that needs one: %s", _msgType);
 			return;
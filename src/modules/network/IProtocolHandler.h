@@ -9,6 +9,7 @@ extern "C" {
 }
 #include <memory>
 #include <flatbuffers/flatbuffers.h>
+#include "Connection.h"
 #include "core/Common.h"
 
 namespace network {
@@ -21,8 +22,8 @@ namespace network {
 class IProtocolHandler {
 protected:
 	template<class ATTACHMENTTYPE>
-	inline ATTACHMENTTYPE* getAttachment(ENetPeer* peer) const {
-		return static_cast<ATTACHMENTTYPE*>(peer->data);
+	inline ATTACHMENTTYPE* getAttachment(void* attachment) const {
+		return static_cast<ATTACHMENTTYPE*>(attachment);
 	}
 
 	template<class MSGTYPE>
@@ -35,7 +36,10 @@ public:
 	virtual ~IProtocolHandler() {
 	}
 
-	virtual void execute(ENetPeer* peer, const void* message) = 0;
+	/**
+	 * @param[in] attachment The object that was attached to the connection - e.g. the user on the server side
+	 */
+	virtual void execute(const Connection& connection, void* attachment, const void* message) = 0;
 };
 
 typedef std::shared_ptr<IProtocolHandler> ProtocolHandlerPtr;
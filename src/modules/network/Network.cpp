@@ -37,14 +37,25 @@ bool Network::init() {
 	return true;
 }
 
-bool Network::disconnectPeer(ENetPeer *peer, DisconnectReason reason) {
+Connection Network::peerConnection(const ENetPeer* peer) {
+	Connection connection;
+	if (peer != nullptr) {
+		connection.peer = const_cast<ENetPeer*>(peer);
+		connection.connectID = peer->connectID;
+		connection.address = peer->address;
+	}
+	return connection;
+}
+
+bool Network::disconnectPeer(const Connection& connection, DisconnectReason reason) {
+	ENetPeer* peer = connection.peer;
 	if (peer == nullptr) {
 		return false;
 	}
-	Log::info("trying to disconnect peer: %u", peer->connectID);
+	Log::info("trying to disconnect peer: %u", connection.connectID);
 	enet_peer_disconnect(peer, core::enumVal(reason));
 	if (peer->state == ENET_PEER_STATE_DISCONNECTED) {
-		_eventBus->publish(DisconnectEvent(peer, reason));
+		_eventBus->publish(DisconnectEvent(connection, reason));
 	}
 	return true;
 }
@@ -56,34 +67,38 @@ void Network::updateHost(ENetHost* host) {
 	enet_host_flush(host);
 	ENetEvent event;
 	while (enet_host_service(host, &event, 0) > 0) {
-		core_trace_scoped(NetworkEventHandling);
-		switch (event.type) {
-		case ENET_EVENT_TYPE_CONNECT: {
-			core_trace_scoped(NetworkConnect);
-			Log::info("New connection event received");
-			_eventBus->publish(NewConnectionEvent(event.peer));
-			break;
-		}
-		case ENET_EVENT_TYPE_RECEIVE: {
-			core_trace_scoped(NetworkPacket);
-			Log::trace("Package received");
-			if (!packetReceived(event)) {
-				Log::error("Failure while receiving a package - disconnecting now...");
-				disconnectPeer(event.peer, DisconnectReason::ProtocolError);
-			}
-			enet_packet_destroy(event.packet);
-			break;
-		}
-		case ENET_EVENT_TYPE_DISCONNECT: {
-			core_trace_scoped(NetworkDisconnect);
-			Log::info("New disconnect event received");
-			_eventBus->publish(DisconnectEvent(event.peer, (DisconnectReason)event.data));
-			break;
-		}
-		case ENET_EVENT_TYPE_NONE: {
-			break;
-		}
+		handleEvent(event, peerConnection(event.peer));
+	}
+}
+
+void Network::handleEvent(ENetEvent& event, const Connection& connection) {
+	core_trace_scoped(NetworkEventHandling);
+	switch (event.type) {
+	case ENET_EVENT_TYPE_CONNECT: {
+		core_trace_scoped(NetworkConnect);
+		Log::info("New connection event received");
+		_eventBus->publish(NewConnectionEvent(connection));
+		break;
+	}
+	case ENET_EVENT_TYPE_RECEIVE: {
+		core_trace_scoped(NetworkPacket);
+		Log::trace("Package received");
+		if (!packetReceived(event, connection)) {
+			Log::error("Failure while receiving a package - disconnecting now...");
+			disconnectPeer(connection, DisconnectReason::ProtocolError);
 		}
+		enet_packet_destroy(event.packet);
+		break;
+	}
+	case ENET_EVENT_TYPE_DISCONNECT: {
+		core_trace_scoped(NetworkDisconnect);
+		Log::info("New disconnect event received");
+		_eventBus->publish(DisconnectEvent(connection, (DisconnectReason)event.data));
+		break;
+	}
+	case ENET_EVENT_TYPE_NONE: {
+		break;
+	}
 	}
 }
 
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include "Connection.h"
 #include "ProtocolHandlerRegistry.h"
 #include "IMsgProtocolHandler.h"
 #include "core/EventBus.h"
@@ -39,9 +40,19 @@ protected:
 	 * @return @c false if the package couldn't get deserialized properly or no handler is registered for the found message
 	 * @c true if everything went smooth.
 	 */
-	virtual bool packetReceived(ENetEvent& event) = 0;
-	bool disconnectPeer(ENetPeer *peer, DisconnectReason reason);
+	virtual bool packetReceived(ENetEvent& event, const Connection& connection) = 0;
+	virtual bool disconnectPeer(const Connection& connection, DisconnectReason reason);
+	/**
+	 * @brief Publishes the connection events and dispatches the received packets to the protocol handlers
+	 * @param[in] connection The connection of the event peer - recorded by the thread that serviced the host
+	 * @note The packet of a receive event is destroyed
+	 */
+	virtual void handleEvent(ENetEvent& event, const Connection& connection);
 	void updateHost(ENetHost* host);
+	/**
+	 * @note Reads the fields of the peer - only call this from the thread that services the host
+	 */
+	static Connection peerConnection(const ENetPeer* peer);
 public:
 	Network(const ProtocolHandlerRegistryPtr& protocolHandlerRegistry, const core::EventBusPtr& eventBus);
 	virtual ~Network();
@@ -51,6 +62,9 @@ public:
 
 	const ProtocolHandlerRegistryPtr& registry();
 
+	/**
+	 * @note The packet is destroyed if it couldn't get sent
+	 */
 	bool sendMessage(ENetPeer* peer, ENetPacket* packet, int channel = 0);
 };
 
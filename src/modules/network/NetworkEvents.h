@@ -11,7 +11,7 @@
 
 namespace network {
 
-EVENTBUSPAYLOADEVENT(NewConnectionEvent, ENetPeer*);
+EVENTBUSPAYLOADEVENT(NewConnectionEvent, Connection);
 
 /**
  * @brief This event is thrown if a client drops the connection.
@@ -21,24 +21,27 @@ EVENTBUSPAYLOADEVENT(NewConnectionEvent, ENetPeer*);
  */
 class DisconnectEvent: public core::IEventBusEvent {
 private:
-	ENetPeer* _peer;
+	Connection _connection;
 	DisconnectReason _reason;
 
-	DisconnectEvent(): _peer(nullptr), _reason(DisconnectReason::Unknown) {}
+	DisconnectEvent(): _reason(DisconnectReason::Unknown) {}
 
 public:
 	EVENTBUSTYPEID(DisconnectEvent)
 
-	DisconnectEvent(ENetPeer* peer, DisconnectReason reason) :
-			_peer(peer), _reason(reason) {
+	DisconnectEvent(const Connection& connection, DisconnectReason reason) :
+			_connection(connection), _reason(reason) {
 	}
 
 	inline DisconnectReason reason() const {
 		return _reason;
 	}
 
-	inline ENetPeer* peer() const {
-		return _peer;
+	/**
+	 * @note The peer slot might already be reused by a new connection - don't read the fields of the peer
+	 */
+	inline const Connection& connection() const {
+		return _connection;
 	}
 };
 
@@ -0,0 +1,91 @@
+/**
+ * @file
+ */
+
+#include "NetworkQueue.h"
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+namespace network {
+
+namespace {
+
+std::atomic<uint32_t> _queueIds { 0u };
+
+/**
+ * @brief The queues of the current thread - one for each outbound queue the thread has written to
+ */
+struct ThreadQueues {
+	std::vector<std::pair<uint32_t, std::shared_ptr<void>>> queues;
+	std::vector<std::function<void()>> onExit;
+
+	~ThreadQueues() {
+		for (const std::function<void()>& func : onExit) {
+			func();
+		}
+	}
+};
+
+thread_local ThreadQueues _threadQueues;
+
+}
+
+OutboundQueue::OutboundQueue(size_t queueSize) :
+		_queueSize(queueSize), _queueId(_queueIds.fetch_add(1u) + 1u) {
+}
+
+void OutboundQueue::init() {
+	_running = true;
+}
+
+void OutboundQueue::shutdown() {
+	_running = false;
+}
+
+OutboundQueue::Queue* OutboundQueue::threadQueue() {
+	for (const auto& e : _threadQueues.queues) {
+		if (e.first == _queueId) {
+			return &((ThreadQueue*)e.second.get())->queue;
+		}
+	}
+	ThreadQueuePtr queue = std::make_shared<ThreadQueue>(_queueSize);
+	{
+		core::ScopedLock<core::Lock> lock(_queuesLock);
+		_queues.push_back(queue);
+	}
+	_threadQueues.queues.emplace_back(_queueId, queue);
+	// the outbound queue keeps the thread queue alive until all commands are consumed
+	std::weak_ptr<ThreadQueue> weak = queue;
+	_threadQueues.onExit.emplace_back([weak] () {
+		if (ThreadQueuePtr q = weak.lock()) {
+			q->closed = true;
+		}
+	});
+	return &queue->queue;
+}
+
+bool OutboundQueue::push(const OutboundCommand& command) {
+	if (!_running) {
+		return false;
+	}
+	Queue* queue = threadQueue();
+	while (!queue->push(command)) {
+		if (!_running) {
+			return false;
+		}
+		// wait for the network thread
+		std::this_thread::yield();
+	}
+	return true;
+}
+
+void OutboundQueue::removeClosed(const ThreadQueuePtr& queue) {
+	core::ScopedLock<core::Lock> lock(_queuesLock);
+	auto i = std::find(_queues.begin(), _queues.end(), queue);
+	if (i != _queues.end()) {
+		_queues.erase(i);
+	}
+}
+
+}
@@ -0,0 +1,197 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/concurrent/Lock.h"
+#include "core/Trace.h"
+#include <enet/enet.h>
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace network {
+
+/**
+ * @brief Bounded lock free single producer/single consumer queue
+ *
+ * The capacity is rounded up to the next power of two.
+ */
+template<class T>
+class SPSCQueue {
+private:
+	std::vector<T> _items;
+	const size_t _mask;
+	// monotonic write and read positions
+	alignas(64) std::atomic<size_t> _head { 0u };
+	alignas(64) std::atomic<size_t> _tail { 0u };
+
+	static size_t powerOfTwo(size_t capacity) {
+		size_t n = 1u;
+		while (n < capacity) {
+			n <<= 1;
+		}
+		return n;
+	}
+public:
+	SPSCQueue(size_t capacity) :
+			_items(powerOfTwo(capacity)), _mask(_items.size() - 1u) {
+	}
+
+	/**
+	 * @note Only called by the producer thread
+	 * @return @c false if the queue is full
+	 */
+	bool push(const T& item) {
+		const size_t head = _head.load(std::memory_order_relaxed);
+		if (head - _tail.load(std::memory_order_acquire) >= _items.size()) {
+			return false;
+		}
+		_items[head & _mask] = item;
+		_head.store(head + 1u, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * @note Only called by the consumer thread
+	 * @return The amount of consumed items
+	 */
+	template<class FUNC>
+	int consume(FUNC&& func) {
+		size_t tail = _tail.load(std::memory_order_relaxed);
+		const size_t head = _head.load(std::memory_order_acquire);
+		int n = 0;
+		while (tail != head) {
+			func(_items[tail & _mask]);
+			++tail;
+			++n;
+			// free the slot for the producer as early as possible
+			_tail.store(tail, std::memory_order_release);
+		}
+		return n;
+	}
+
+	inline size_t size() const {
+		return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+	}
+
+	inline bool empty() const {
+		return size() == 0u;
+	}
+
+	inline bool full() const {
+		return size() >= _items.size();
+	}
+
+	inline size_t capacity() const {
+		return _items.size();
+	}
+};
+
+/**
+ * @brief Work item for the network thread - created by the threads that send messages
+ */
+struct OutboundCommand {
+	enum class Type : uint8_t {
+		Send, Broadcast, Disconnect
+	};
+	enum Flags : uint8_t {
+		// the last command for the packet - the producer holds a packet reference until this command is executed
+		Release = 1 << 0
+	};
+	ENetPeer* peer = nullptr;
+	ENetPacket* packet = nullptr;
+	// the peer slot might have been reused by a new connection since the command was queued
+	uint32_t connectID = 0u;
+	// channel or disconnect reason
+	uint32_t data = 0u;
+	Type type = Type::Send;
+	uint8_t flags = 0u;
+};
+
+/**
+ * @brief Multiple producer queue for the network thread
+ *
+ * Each producer thread writes into its own lock free single producer/single consumer queue. The order of
+ * the commands of one thread is kept - there is no order between the commands of different threads. If
+ * the queue of a thread is full, the producer waits for the network thread.
+ *
+ * @see core::LogQueue
+ */
+class OutboundQueue {
+private:
+	using Queue = SPSCQueue<OutboundCommand>;
+	struct ThreadQueue {
+		Queue queue;
+		// set if the producer thread exited
+		std::atomic_bool closed { false };
+
+		ThreadQueue(size_t size) : queue(size) {
+		}
+	};
+	using ThreadQueuePtr = std::shared_ptr<ThreadQueue>;
+
+	const size_t _queueSize;
+	// unique id of the queue - used to find the queue of the calling thread
+	const uint32_t _queueId;
+	std::atomic_bool _running { false };
+
+	core_trace_mutex(core::Lock, _queuesLock, "OutboundQueues");
+	std::vector<ThreadQueuePtr> _queues;
+	// only used by the consumer - reused to not allocate memory for each call
+	std::vector<ThreadQueuePtr> _consumeQueues;
+
+	Queue* threadQueue();
+	void removeClosed(const ThreadQueuePtr& queue);
+public:
+	/**
+	 * @param[in] queueSize The amount of commands each producer thread can queue
+	 */
+	OutboundQueue(size_t queueSize = 4096u);
+
+	void init();
+	/**
+	 * @brief New commands are rejected after this call - the queued ones can still be consumed
+	 */
+	void shutdown();
+
+	/**
+	 * @brief Adds the command to the queue of the calling thread. Waits for the consumer if the queue is full.
+	 * @return @c false if the queue is shut down
+	 */
+	bool push(const OutboundCommand& command);
+
+	/**
+	 * @note Only called by the consumer thread
+	 * @return The amount of consumed commands
+	 */
+	template<class FUNC>
+	int consume(FUNC&& func);
+
+	inline bool isRunning() const {
+		return _running;
+	}
+};
+
+template<class FUNC>
+int OutboundQueue::consume(FUNC&& func) {
+	core_trace_scoped(OutboundQueueConsume);
+	{
+		core::ScopedLock<core::Lock> lock(_queuesLock);
+		_consumeQueues = _queues;
+	}
+	int n = 0;
+	for (const ThreadQueuePtr& queue : _consumeQueues) {
+		n += queue->queue.consume(func);
+		// the producer thread is gone and everything was consumed
+		if (queue->closed && queue->queue.empty()) {
+			removeClosed(queue);
+		}
+	}
+	_consumeQueues.clear();
+	return n;
+}
+
+}
@@ -30,29 +30,24 @@ ServerMessageSender::ServerMessageSender(const ServerNetworkPtr& network, const
 		_network(network), _metric(metric) {
 }
 
-bool ServerMessageSender::sendServerMessage(ENetPeer* peer, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags) {
-	core_assert(peer != nullptr);
-	return sendServerMessage(&peer, 1, fbb, type, data, flags);
+bool ServerMessageSender::sendServerMessage(const Connection& connection, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags) {
+	core_assert(connection.valid());
+	return sendServerMessage(&connection, 1, fbb, type, data, flags);
 }
 
-bool ServerMessageSender::sendServerMessage(ENetPeer** peers, int numPeers, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags) {
+bool ServerMessageSender::sendServerMessage(const Connection* connections, int numPeers, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags) {
 	const char *msgType = network::EnumNameServerMsgType(type);
 	Log::debug(logid, "Send %s to %i peers", msgType, numPeers);
 	core_assert(numPeers > 0);
-	int sent = 0;
 	auto packet = createServerPacket(fbb, type, data, flags);
 	const metric::TagMap& tags {{"direction", "out"}, {"type", msgType}};
-	{
-		// TODO: lock
-		for (int i = 0; i < numPeers; ++i) {
-			if (!_network->sendMessage(peers[i], packet)) {
-				_metric->count("network_not_sent", 1, tags);
-				Log::trace(logid, "Could not send message of type %s to peer %i", msgType, i);
-			} else {
-				_metric->count("network_sent", 1, tags);
-				++sent;
-			}
-		}
+	const int sent = _network->send(connections, numPeers, packet);
+	if (sent > 0) {
+		_metric->count("network_sent", sent, tags);
+	}
+	if (sent < numPeers) {
+		_metric->count("network_not_sent", numPeers - sent, tags);
+		Log::trace(logid, "Could not send message of type %s to %i peers", msgType, numPeers - sent);
 	}
 	fbb.Clear();
 	return sent == numPeers;
@@ -61,13 +56,9 @@ bool ServerMessageSender::sendServerMessage(ENetPeer** peers, int numPeers, Flat
 bool ServerMessageSender::broadcastServerMessage(FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, int channel, uint32_t flags) {
 	const char *msgType = network::EnumNameServerMsgType(type);
 	Log::debug(logid, "Broadcast %s on channel %i", msgType, channel);
-	bool success = false;
-	{
-		// TODO: lock
-		success = _network->broadcast(createServerPacket(fbb, type, data, flags), channel);
-		const metric::TagMap& tags {{"direction", "broadcast"}, {"type", msgType}};
-		_metric->count("network_sent", 1, tags);
-	}
+	const bool success = _network->broadcast(createServerPacket(fbb, type, data, flags), channel);
+	const metric::TagMap& tags {{"direction", "broadcast"}, {"type", msgType}};
+	_metric->count("network_sent", 1, tags);
 	fbb.Clear();
 	return success;
 }
@@ -16,6 +16,9 @@ using namespace flatbuffers;
 
 /**
  * @brief Send messages from the server to the client(s)
+ *
+ * The messages can be sent from any thread if the network thread of the @c ServerNetwork is running.
+ * The @c FlatBufferBuilder instances must not be shared between the threads.
  */
 class ServerMessageSender {
 private:
@@ -28,16 +31,16 @@ public:
 	ENetPacket* createServerPacket(FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags);
 	ServerMessageSender(const ServerNetworkPtr& network, const metric::MetricPtr& metric);
 
-	bool sendServerMessage(ENetPeer* peer, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags = ENET_PACKET_FLAG_RELIABLE);
-	bool sendServerMessage(std::vector<ENetPeer*> peers, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags = ENET_PACKET_FLAG_RELIABLE);
-	bool sendServerMessage(ENetPeer** peers, int numPeers, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags = ENET_PACKET_FLAG_RELIABLE);
+	bool sendServerMessage(const Connection& connection, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags = ENET_PACKET_FLAG_RELIABLE);
+	bool sendServerMessage(const std::vector<Connection>& connections, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags = ENET_PACKET_FLAG_RELIABLE);
+	bool sendServerMessage(const Connection* connections, int numPeers, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags = ENET_PACKET_FLAG_RELIABLE);
 	bool broadcastServerMessage(FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, int channel = 0, uint32_t flags = ENET_PACKET_FLAG_RELIABLE);
 };
 
 typedef std::shared_ptr<ServerMessageSender> ServerMessageSenderPtr;
 
-inline bool ServerMessageSender::sendServerMessage(std::vector<ENetPeer*> peers, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags) {
-	return sendServerMessage(&peers.front(), peers.size(), fbb, type, data, flags);
+inline bool ServerMessageSender::sendServerMessage(const std::vector<Connection>& connections, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags) {
+	return sendServerMessage(&connections.front(), connections.size(), fbb, type, data, flags);
 }
 
 }
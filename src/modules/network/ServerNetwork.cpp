@@ -4,17 +4,46 @@
 
 #include "ClientMessages_generated.h"
 #include "ServerNetwork.h"
+#include "core/Assert.h"
 #include "core/Trace.h"
 #include "core/Log.h"
+#include "core/Enum.h"
+#include "core/concurrent/Concurrency.h"
 
 namespace network {
 
+namespace {
+
+// the max amount of received events that the network thread hands over to update()
+static constexpr size_t InboundQueueSize = 4096u;
+// the max time in millis the network thread waits for incoming packets before it sends the queued ones
+static constexpr enet_uint32 ServiceTimeoutMillis = 1u;
+
+/**
+ * @note Unlike @c Network::sendMessage() the packet is not destroyed on failure - it might be shared by several peers
+ */
+bool sendPacket(ENetPeer* peer, ENetPacket* packet, int channel) {
+	if (packet->dataLength >= peer->host->maximumPacketSize) {
+		Log::error("Packet is too big: %i - max allowed is %i", (int)packet->dataLength, (int)peer->host->maximumPacketSize);
+		return false;
+	}
+	return enet_peer_send(peer, channel, packet) == 0;
+}
+
+void releasePacket(ENetPacket* packet) {
+	if (--packet->referenceCount == 0) {
+		enet_packet_destroy(packet);
+	}
+}
+
+}
+
 ServerNetwork::ServerNetwork(const ProtocolHandlerRegistryPtr& protocolHandlerRegistry,
 		const core::EventBusPtr& eventBus, const metric::MetricPtr& metric) :
-		Super(protocolHandlerRegistry, eventBus), _metric(metric) {
+		Super(protocolHandlerRegistry, eventBus), _metric(metric), _inbound(InboundQueueSize) {
 }
 
-bool ServerNetwork::packetReceived(ENetEvent& event) {
+bool ServerNetwork::packetReceived(ENetEvent& event, const Connection& connection) {
 	flatbuffers::Verifier v(event.packet->data, event.packet->dataLength);
 
 	if (!VerifyClientMessageBuffer(v)) {
@@ -34,7 +63,7 @@ bool ServerNetwork::packetReceived(ENetEvent& event) {
 	_metric->count("network_packet_size", (int)event.packet->dataLength, tags);
 
 	Log::debug("Received %s", clientMsgType);
-	handler->execute(event.peer, reinterpret_cast<const flatbuffers::Table*>(req->data()));
+	handler->execute(connection, attachment(connection), reinterpret_cast<const flatbuffers::Table*>(req->data()));
 	return true;
 }
 
@@ -72,33 +101,323 @@ bool ServerNetwork::bind(uint16_t port, const core::String& hostname, int maxPee
 		return false;
 	}
 	enet_host_compress_with_range_coder(_server);
+	_peers = _server->peers;
+	_peerCount = _server->peerCount;
+	_hostConnections.assign(_peerCount, Connection());
+	_connections.assign(_peerCount, ConnectionSlot());
 	return true;
 }
 
-bool ServerNetwork::broadcast(ENetPacket* packet, int channel) {
+size_t ServerNetwork::slot(const ENetPeer* peer) const {
+	const size_t index = (size_t)(peer - _peers);
+	core_assert(index < _peerCount);
+	return index;
+}
+
+bool ServerNetwork::isConnected(const Connection& connection) {
+	return connection.peer != nullptr && connection.peer->connectID == connection.connectID;
+}
+
+ServerNetwork::InboundEvent ServerNetwork::capture(const ENetEvent& event) {
+	InboundEvent inbound;
+	inbound.event = event;
+	Connection& connection = _hostConnections[slot(event.peer)];
+	if (event.type == ENET_EVENT_TYPE_CONNECT) {
+		connection = peerConnection(event.peer);
+	}
+	inbound.connection = connection;
+	inbound.connection.peer = event.peer;
+	if (event.type == ENET_EVENT_TYPE_DISCONNECT) {
+		connection = Connection();
+	}
+	return inbound;
+}
+
+bool ServerNetwork::startThread() {
 	if (_server == nullptr) {
+		Log::error("The server socket must be bound before the network thread is started");
 		return false;
 	}
+	if (_threaded) {
+		return true;
+	}
+	_outbound.init();
+	_threaded = true;
+	_thread = std::thread([this] () {
+		run();
+	});
+	Log::info("Started the network thread");
+	return true;
+}
+
+void ServerNetwork::run() {
+	core::setThreadName("network");
+	ENetEvent event;
+	while (_threaded) {
+		core_trace_scoped(NetworkThread);
+		_outbound.consume([this] (OutboundCommand& command) {
+			execute(command);
+		});
+		enet_host_flush(_server);
+		while (!_pendingEvents.empty() && _inbound.push(_pendingEvents.front())) {
+			_pendingEvents.pop_front();
+		}
+		if (!_pendingEvents.empty()) {
+			// update() is behind - don't receive anything new until it caught up
+			std::this_thread::yield();
+			continue;
+		}
+		if (enet_host_service(_server, &event, ServiceTimeoutMillis) <= 0) {
+			continue;
+		}
+		queueEvent(capture(event));
+		while (_pendingEvents.empty() && enet_host_check_events(_server, &event) > 0) {
+			queueEvent(capture(event));
+		}
+	}
+}
+
+void ServerNetwork::queueEvent(const InboundEvent& event) {
+	if (!_pendingEvents.empty() || !_inbound.push(event)) {
+		_pendingEvents.push_back(event);
+	}
+}
+
+void ServerNetwork::execute(OutboundCommand& command) {
+	// the peer slot was reused by a new connection since the command was queued
+	const bool samePeer = isConnected(Connection{command.peer, command.connectID});
+	switch (command.type) {
+	case OutboundCommand::Type::Send:
+		if (samePeer) {
+			sendPacket(command.peer, command.packet, (int)command.data);
+		}
+		break;
+	case OutboundCommand::Type::Broadcast:
+		enet_host_broadcast(_server, (enet_uint8)command.data, command.packet);
+		break;
+	case OutboundCommand::Type::Disconnect:
+		if (!samePeer) {
+			break;
+		}
+		Log::info("trying to disconnect peer: %u", command.connectID);
+		if (command.peer->state == ENET_PEER_STATE_DISCONNECTED) {
+			ENetEvent event;
+			event.type = ENET_EVENT_TYPE_DISCONNECT;
+			event.peer = command.peer;
+			event.channelID = 0;
+			event.data = command.data;
+			event.packet = nullptr;
+			queueEvent(capture(event));
+		} else {
+			enet_peer_disconnect(command.peer, command.data);
+		}
+		break;
+	}
+	if (command.flags & OutboundCommand::Release) {
+		releasePacket(command.packet);
+	}
+}
+
+int ServerNetwork::send(const Connection* connections, int numConnections, ENetPacket* packet, int channel) {
+	if (packet == nullptr) {
+		return 0;
+	}
+	int last = -1;
+	for (int i = 0; i < numConnections; ++i) {
+		if (connections[i].valid()) {
+			last = i;
+		}
+	}
+	// the packet isn't known to enet or the network thread yet - so it's safe to modify the reference count
+	++packet->referenceCount;
+	if (last == -1) {
+		releasePacket(packet);
+		return 0;
+	}
+	if (!_threaded) {
+		int sent = 0;
+		// the host is serviced on this thread
+		for (int i = 0; i <= last; ++i) {
+			if (isConnected(connections[i]) && sendPacket(connections[i].peer, packet, channel)) {
+				++sent;
+			}
+		}
+		releasePacket(packet);
+		return sent;
+	}
+	int queued = 0;
+	for (int i = 0; i <= last; ++i) {
+		const Connection& connection = connections[i];
+		if (!connection.valid()) {
+			continue;
+		}
+		OutboundCommand command;
+		command.type = OutboundCommand::Type::Send;
+		command.peer = connection.peer;
+		command.connectID = connection.connectID;
+		command.packet = packet;
+		command.data = (uint32_t)channel;
+		// the network thread drops our reference after the last peer
+		command.flags = i == last ? OutboundCommand::Release : 0u;
+		if (!_outbound.push(command)) {
+			if (queued == 0) {
+				releasePacket(packet);
+			} else {
+				Log::error("The network thread was stopped while a packet was queued");
+			}
+			return queued;
+		}
+		++queued;
+	}
+	return queued;
+}
+
+bool ServerNetwork::sendMessage(const Connection& connection, ENetPacket* packet, int channel) {
+	return send(&connection, 1, packet, channel) == 1;
+}
+
+bool ServerNetwork::broadcast(ENetPacket* packet, int channel) {
 	if (packet == nullptr) {
 		return false;
 	}
+	if (_server == nullptr) {
+		if (packet->referenceCount == 0) {
+			enet_packet_destroy(packet);
+		}
+		return false;
+	}
 	Log::debug("Broadcasting a message on channel %i", channel);
-	enet_host_broadcast(_server, channel, packet);
+	if (!_threaded) {
+		enet_host_broadcast(_server, channel, packet);
+		return true;
+	}
+	++packet->referenceCount;
+	OutboundCommand command;
+	command.type = OutboundCommand::Type::Broadcast;
+	command.packet = packet;
+	command.data = (uint32_t)channel;
+	command.flags = OutboundCommand::Release;
+	if (!_outbound.push(command)) {
+		releasePacket(packet);
+		return false;
+	}
 	return true;
 }
 
+bool ServerNetwork::disconnectPeer(const Connection& connection, DisconnectReason reason) {
+	if (!connection.valid()) {
+		return false;
+	}
+	if (!_threaded) {
+		// the host is serviced on this thread
+		if (!isConnected(connection)) {
+			return false;
+		}
+		return Super::disconnectPeer(connection, reason);
+	}
+	OutboundCommand command;
+	command.type = OutboundCommand::Type::Disconnect;
+	command.peer = connection.peer;
+	command.connectID = connection.connectID;
+	command.data = core::enumVal(reason);
+	return _outbound.push(command);
+}
+
+void ServerNetwork::handleEvent(ENetEvent& event, const Connection& connection) {
+	ConnectionSlot& connectionSlot = _connections[slot(connection.peer)];
+	if (event.type == ENET_EVENT_TYPE_CONNECT) {
+		connectionSlot = ConnectionSlot();
+		connectionSlot.connection = connection;
+	}
+	Super::handleEvent(event, connection);
+	if (event.type == ENET_EVENT_TYPE_DISCONNECT && connectionSlot.connection == connection) {
+		connectionSlot = ConnectionSlot();
+	}
+}
+
+const ServerNetwork::ConnectionSlot* ServerNetwork::connectionSlot(const Connection& connection) const {
+	if (!connection.valid()) {
+		return nullptr;
+	}
+	const ConnectionSlot& connectionSlot = _connections[slot(connection.peer)];
+	if (connectionSlot.connection != connection) {
+		return nullptr;
+	}
+	return &connectionSlot;
+}
+
+Connection ServerNetwork::connection(const ENetPeer* peer) const {
+	if (peer == nullptr) {
+		return Connection();
+	}
+	return _connections[slot(peer)].connection;
+}
+
+bool ServerNetwork::setAttachment(const Connection& connection, void* attachment) {
+	if (this->connectionSlot(connection) == nullptr) {
+		return false;
+	}
+	_connections[slot(connection.peer)].attachment = attachment;
+	return true;
+}
+
+void* ServerNetwork::attachment(const Connection& connection) const {
+	const ConnectionSlot* connectionSlot = this->connectionSlot(connection);
+	if (connectionSlot == nullptr) {
+		return nullptr;
+	}
+	return connectionSlot->attachment;
+}
+
 void ServerNetwork::shutdown() {
+	if (_threaded.exchange(false)) {
+		_outbound.shutdown();
+		_thread.join();
+		// send the commands that were queued while the network thread stopped
+		_outbound.consume([this] (OutboundCommand& command) {
+			execute(command);
+		});
+		auto destroy = [] (InboundEvent& inbound) {
+			if (inbound.event.type == ENET_EVENT_TYPE_RECEIVE) {
+				enet_packet_destroy(inbound.event.packet);
+			}
+		};
+		_inbound.consume(destroy);
+		for (InboundEvent& inbound : _pendingEvents) {
+			destroy(inbound);
+		}
+		_pendingEvents.clear();
+		Log::info("Stopped the network thread");
+	}
 	if (_server != nullptr) {
 		enet_host_flush(_server);
 		enet_host_destroy(_server);
 	}
 	_server = nullptr;
+	_peers = nullptr;
+	_peerCount = 0u;
+	_hostConnections.clear();
+	_connections.clear();
 	Super::shutdown();
 }
 
 void ServerNetwork::update() {
 	core_trace_scoped(Network);
-	updateHost(_server);
+	if (_threaded) {
+		_inbound.consume([this] (InboundEvent& inbound) {
+			handleEvent(inbound.event, inbound.connection);
+		});
+		return;
+	}
+	if (_server == nullptr) {
+		return;
+	}
+	enet_host_flush(_server);
+	ENetEvent event;
+	while (enet_host_service(_server, &event, 0) > 0) {
+		InboundEvent inbound = capture(event);
+		handleEvent(inbound.event, inbound.connection);
+	}
 }
 
 }
@@ -5,28 +5,134 @@
 #pragma once
 
 #include "Network.h"
+#include "NetworkQueue.h"
 #include "core/metric/Metric.h"
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <vector>
 
 namespace network {
 
+/**
+ * @brief The server side of the network layer
+ *
+ * By default the host is serviced in @c update() on the calling thread. After @c startThread() a network
+ * thread owns the host: it sends the queued packets, receives the events and flushes the host. The packets
+ * can then be sent from any thread without locking - each thread writes into its own lock free queue. The
+ * received events are handed over to the protocol handlers and the event bus in @c update() - so they are
+ * still executed on the thread that calls @c update().
+ *
+ * Only the thread that services the host reads the fields of the peers. The peers are identified by their
+ * @c Connection everywhere else - a peer slot that is reused by a new connection doesn't receive the
+ * packets of the old connection.
+ */
 class ServerNetwork : public Network {
 private:
 	ENetHost* _server = nullptr;
+	// the peers of the host - only used to get the slot of a peer
+	ENetPeer* _peers = nullptr;
+	size_t _peerCount = 0u;
 	metric::MetricPtr _metric;
 	using Super = Network;
+
+	/**
+	 * @brief A received event together with the connection of the peer at the time it was received
+	 */
+	struct InboundEvent {
+		ENetEvent event;
+		Connection connection;
+	};
+
+	/**
+	 * @brief The connection of a peer slot as it's known to the thread that calls @c update()
+	 */
+	struct ConnectionSlot {
+		Connection connection;
+		void* attachment = nullptr;
+	};
+
+	std::thread _thread;
+	std::atomic_bool _threaded { false };
+	OutboundQueue _outbound;
+	// filled by the network thread - consumed in update()
+	SPSCQueue<InboundEvent> _inbound;
+	// only used by the network thread - the events that didn't fit into the inbound queue
+	std::deque<InboundEvent> _pendingEvents;
+	// only used by the thread that services the host - enet resets the peer before it returns the disconnect
+	// event, so the connection is recorded with the connect event
+	std::vector<Connection> _hostConnections;
+	// only used by the thread that calls update() - changed in the order of the received events
+	std::vector<ConnectionSlot> _connections;
+
+	void run();
+	void execute(OutboundCommand& command);
+	void queueEvent(const InboundEvent& event);
+	InboundEvent capture(const ENetEvent& event);
+	size_t slot(const ENetPeer* peer) const;
+	const ConnectionSlot* connectionSlot(const Connection& connection) const;
+	/**
+	 * @note Reads the fields of the peer - only call this from the thread that services the host
+	 */
+	static bool isConnected(const Connection& connection);
+protected:
+	bool disconnectPeer(const Connection& connection, DisconnectReason reason) override;
+	void handleEvent(ENetEvent& event, const Connection& connection) override;
 public:
 	ServerNetwork(const ProtocolHandlerRegistryPtr& protocolHandlerRegistry,
 			const core::EventBusPtr& eventBus, const metric::MetricPtr& metric);
 
 	bool bind(uint16_t port, const core::String& hostname = "", int maxPeers = 1024, int maxChannels = 1);
-	bool packetReceived(ENetEvent& event) override;
+	bool packetReceived(ENetEvent& event, const Connection& connection) override;
+
+	/**
+	 * @brief Hands the host over to the network thread
+	 * @note Must be called after @c bind() and from the thread that calls @c update()
+	 */
+	bool startThread();
+	bool isThreaded() const;
 
+	/**
+	 * @brief Sends the packet to all the given connections
+	 * @note The packet is destroyed if none of the peers references it
+	 * @return The amount of peers the packet was sent to - or queued for if the network thread is running
+	 */
+	int send(const Connection* connections, int numConnections, ENetPacket* packet, int channel = 0);
+	/**
+	 * @note The packet is destroyed if it couldn't get sent
+	 */
+	bool sendMessage(const Connection& connection, ENetPacket* packet, int channel = 0);
+	/**
+	 * @note The packet is destroyed if it couldn't get sent
+	 */
 	bool broadcast(ENetPacket* packet, int channel = 0);
 
+	/**
+	 * @return The current connection of the peer slot - invalid if the peer isn't connected
+	 * @note Only called from the thread that calls @c update()
+	 */
+	Connection connection(const ENetPeer* peer) const;
+	/**
+	 * @brief The attachment is handed over to the protocol handlers for the packets of the connection
+	 * @return @c false if the connection is already closed
+	 * @note Only called from the thread that calls @c update()
+	 */
+	bool setAttachment(const Connection& connection, void* attachment);
+	/**
+	 * @return The attachment of the connection - or @c nullptr if the connection is already closed
+	 * @note Only called from the thread that calls @c update() - the attachment is still available while
+	 * the @c DisconnectEvent is published
+	 */
+	void* attachment(const Connection& connection) const;
+
 	void update();
 	void shutdown() override;
 };
 
+inline bool ServerNetwork::isThreaded() const {
+	return _threaded;
+}
+
 typedef std::shared_ptr<ServerNetwork> ServerNetworkPtr;
 
 }
@@ -0,0 +1,128 @@
+/**
+ * @file
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "network/NetworkEvents.h"
+#include "network/ProtocolHandlerRegistry.h"
+#include "network/ServerNetwork.h"
+#include "ServerMessages_generated.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+class ServerNetworkBenchmark : public core::AbstractBenchmark, public core::IEventBusHandler<network::NewConnectionEvent> {
+protected:
+	static constexpr uint16_t Port = 11337u;
+	// the amount of messages that are sent to each peer in one tick
+	static constexpr int MessagesPerTick = 64;
+
+	core::EventBusPtr _eventBus;
+	network::ServerNetworkPtr _network;
+	std::vector<network::Connection> _peers;
+	std::thread _clientThread;
+	std::atomic_bool _stopClients { false };
+
+	/**
+	 * @brief Connects the clients and receives the messages on an own thread
+	 */
+	void startClients(int clients) {
+		_stopClients = false;
+		_clientThread = std::thread([this, clients] () {
+			ENetAddress address;
+			enet_address_set_host(&address, "127.0.0.1");
+			address.port = Port;
+			std::vector<ENetHost*> hosts;
+			for (int i = 0; i < clients; ++i) {
+				ENetHost* host = enet_host_create(nullptr, 1, 1, 0, 0);
+				enet_host_compress_with_range_coder(host);
+				enet_host_connect(host, &address, 1, 0);
+				hosts.push_back(host);
+			}
+			while (!_stopClients) {
+				for (ENetHost* host : hosts) {
+					ENetEvent event;
+					while (enet_host_service(host, &event, 0) > 0) {
+						if (event.type == ENET_EVENT_TYPE_RECEIVE) {
+							enet_packet_destroy(event.packet);
+						}
+					}
+				}
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			for (ENetHost* host : hosts) {
+				enet_host_destroy(host);
+			}
+		});
+	}
+
+	bool setup(bool threaded, int clients) {
+		_eventBus = std::make_shared<core::EventBus>();
+		_eventBus->subscribe<network::NewConnectionEvent>(*this);
+		const metric::MetricPtr& metric = std::make_shared<metric::Metric>();
+		_network = std::make_shared<network::ServerNetwork>(std::make_shared<network::ProtocolHandlerRegistry>(), _eventBus, metric);
+		if (!_network->init() || !_network->bind(Port, "127.0.0.1", clients)) {
+			return false;
+		}
+		if (threaded && !_network->startThread()) {
+			return false;
+		}
+		startClients(clients);
+		for (int i = 0; i < 10000 && (int)_peers.size() < clients; ++i) {
+			_network->update();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return (int)_peers.size() == clients;
+	}
+
+	void cleanup() {
+		_stopClients = true;
+		_clientThread.join();
+		_eventBus->unsubscribe<network::NewConnectionEvent>(*this);
+		_network->shutdown();
+		_peers.clear();
+		_network = network::ServerNetworkPtr();
+	}
+
+public:
+	void onEvent(const network::NewConnectionEvent& event) override {
+		_peers.push_back(event.get());
+	}
+};
+
+/**
+ * @brief The time the tick thread spends to send the messages of one tick and to update the network
+ * @param 0 @c 1 if the host is serviced by the network thread
+ * @param 1 the amount of connected peers
+ */
+BENCHMARK_DEFINE_F(ServerNetworkBenchmark, Tick)(benchmark::State& state) {
+	if (!setup(state.range(0) != 0, (int)state.range(1))) {
+		cleanup();
+		state.SkipWithError("Failed to connect the clients");
+		return;
+	}
+	// the packets are created without the ServerMessageSender to only measure the network layer
+	flatbuffers::FlatBufferBuilder fbb;
+	network::FinishServerMessageBuffer(fbb, network::CreateServerMessage(fbb, network::ServerMsgType::EntityRemove, network::CreateEntityRemove(fbb, 1).Union()));
+	for (auto _ : state) {
+		for (int i = 0; i < MessagesPerTick; ++i) {
+			_network->send(_peers.data(), (int)_peers.size(), enet_packet_create(fbb.GetBufferPointer(), fbb.GetSize(), 0u));
+		}
+		_network->update();
+	}
+	state.SetItemsProcessed(state.iterations() * MessagesPerTick * (int64_t)_peers.size());
+	cleanup();
+}
+
+static void tickArguments(benchmark::internal::Benchmark* b) {
+	for (int peers : {1, 8, 32}) {
+		for (int threaded : {0, 1}) {
+			b->Args({threaded, peers});
+		}
+	}
+}
+
+BENCHMARK_REGISTER_F(ServerNetworkBenchmark, Tick)->Apply(tickArguments)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,409 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "core/EventBus.h"
+#include "ClientMessages_generated.h"
+#include "network/NetworkEvents.h"
+#include "network/ProtocolHandlerRegistry.h"
+#include "network/ServerMessageSender.h"
+#include "network/ServerNetwork.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace network {
+
+class ServerNetworkTest:
+		public core::AbstractTest,
+		public core::IEventBusHandler<NewConnectionEvent>,
+		public core::IEventBusHandler<DisconnectEvent> {
+private:
+	using Super = core::AbstractTest;
+protected:
+	static constexpr int Clients = 4;
+	static constexpr int MaxSenders = 8;
+
+	/**
+	 * @brief Raw enet client - only used by the client thread
+	 */
+	struct TestClient {
+		ENetHost* host = nullptr;
+		// the next expected message sequence for each sender
+		int expected[MaxSenders] {};
+		int received[MaxSenders] {};
+		int outOfOrder = 0;
+		bool disconnected = false;
+	};
+
+	class TriggerActionHandler : public IProtocolHandler {
+	private:
+		ServerNetworkTest* _test;
+	public:
+		TriggerActionHandler(ServerNetworkTest* test) : _test(test) {
+		}
+
+		void execute(const Connection& connection, void* attachment, const void* message) override {
+			if (std::this_thread::get_id() != _test->_updateThread) {
+				++_test->_handlerWrongThread;
+			}
+			++_test->_handlerCalled;
+		}
+	};
+
+	core::EventBusPtr _eventBus;
+	ProtocolHandlerRegistryPtr _protocolHandlerRegistry;
+	ServerNetworkPtr _network;
+	ServerMessageSenderPtr _messageSender;
+	uint16_t _port = 0u;
+	const core::String _host = "127.0.0.1";
+
+	// only touched by the thread that calls update()
+	std::vector<Connection> _serverPeers;
+	int _disconnectEvents = 0;
+	std::thread::id _updateThread;
+	int _handlerCalled = 0;
+	int _handlerWrongThread = 0;
+
+	std::thread _clientThread;
+	std::atomic_bool _stopClients { false };
+	std::atomic_int _connectedClients { 0 };
+	std::atomic_int _disconnectedClients { 0 };
+	std::atomic_int _receivedMessages { 0 };
+	TestClient _clients[Clients];
+
+	static uint64_t messageId(int sender, int sequence) {
+		return ((uint64_t)sender << 32) | (uint32_t)sequence;
+	}
+
+	void onMessage(TestClient& client, ENetPacket* packet) {
+		flatbuffers::Verifier v(packet->data, packet->dataLength);
+		ASSERT_TRUE(VerifyServerMessageBuffer(v));
+		const ServerMessage* msg = GetServerMessage(packet->data);
+		ASSERT_EQ(ServerMsgType::EntityRemove, msg->data_type());
+		const uint64_t id = (uint64_t)msg->data_as_EntityRemove()->id();
+		const int sender = (int)(id >> 32);
+		const int sequence = (int)(id & 0xFFFFFFFFu);
+		ASSERT_LT(sender, MaxSenders);
+		// the order of the messages of one sender is kept
+		if (client.expected[sender] != sequence) {
+			++client.outOfOrder;
+		}
+		client.expected[sender] = sequence + 1;
+		++client.received[sender];
+		++_receivedMessages;
+	}
+
+	/**
+	 * @brief Connects the clients and services them on an own thread until @c stopClients() is called
+	 * @param[in] clientMessages The amount of messages each client sends after the connection was established
+	 * @param[in] invalidMessage Send a message that the server can't parse - this leads to a disconnect
+	 */
+	void startClients(int clientMessages, bool invalidMessage = false) {
+		_clientThread = std::thread([this, clientMessages, invalidMessage] () {
+			ENetAddress address;
+			enet_address_set_host(&address, _host.c_str());
+			address.port = _port;
+			for (TestClient& client : _clients) {
+				client.host = enet_host_create(nullptr, 1, 1, 0, 0);
+				ASSERT_NE(nullptr, client.host);
+				enet_host_compress_with_range_coder(client.host);
+				ASSERT_NE(nullptr, enet_host_connect(client.host, &address, 1, 0));
+			}
+			flatbuffers::FlatBufferBuilder fbb;
+			FinishClientMessageBuffer(fbb, CreateClientMessage(fbb, ClientMsgType::TriggerAction, CreateTriggerAction(fbb).Union()));
+			while (!_stopClients) {
+				for (TestClient& client : _clients) {
+					ENetEvent event;
+					while (enet_host_service(client.host, &event, 0) > 0) {
+						switch (event.type) {
+						case ENET_EVENT_TYPE_CONNECT:
+							for (int i = 0; i < clientMessages; ++i) {
+								enet_peer_send(event.peer, 0, enet_packet_create(fbb.GetBufferPointer(), fbb.GetSize(), ENET_PACKET_FLAG_RELIABLE));
+							}
+							if (invalidMessage) {
+								const uint8_t garbage[] = {1, 2, 3, 4};
+								enet_peer_send(event.peer, 0, enet_packet_create(garbage, sizeof(garbage), ENET_PACKET_FLAG_RELIABLE));
+							}
+							++_connectedClients;
+							break;
+						case ENET_EVENT_TYPE_RECEIVE:
+							onMessage(client, event.packet);
+							enet_packet_destroy(event.packet);
+							break;
+						case ENET_EVENT_TYPE_DISCONNECT:
+							client.disconnected = true;
+							++_disconnectedClients;
+							break;
+						case ENET_EVENT_TYPE_NONE:
+							break;
+						}
+					}
+				}
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			for (TestClient& client : _clients) {
+				enet_host_destroy(client.host);
+				client.host = nullptr;
+			}
+		});
+	}
+
+	void stopClients() {
+		if (!_clientThread.joinable()) {
+			return;
+		}
+		_stopClients = true;
+		_clientThread.join();
+	}
+
+	/**
+	 * @brief Calls @c update() until the condition is met
+	 */
+	bool updateUntil(const std::function<bool()>& condition, int timeoutMillis = 30000) {
+		const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMillis);
+		while (std::chrono::steady_clock::now() < end) {
+			_network->update();
+			if (condition()) {
+				return true;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return false;
+	}
+
+	bool connectClients(int clientMessages = 0, bool invalidMessage = false) {
+		startClients(clientMessages, invalidMessage);
+		return updateUntil([this] () {
+			return (int)_serverPeers.size() == Clients && _connectedClients == Clients;
+		});
+	}
+
+	/**
+	 * @brief Each sender thread sends the given amount of messages to all clients - the last senders broadcast their messages
+	 */
+	void sendConcurrently(int senders, int broadcasters, int messages) {
+		std::atomic_int failed { 0 };
+		std::atomic_int finished { 0 };
+		std::vector<std::thread> threads;
+		for (int s = 0; s < senders; ++s) {
+			threads.emplace_back([&, s] () {
+				flatbuffers::FlatBufferBuilder fbb;
+				const bool broadcast = s >= senders - broadcasters;
+				for (int i = 0; i < messages; ++i) {
+					const auto data = CreateEntityRemove(fbb, (int64_t)messageId(s, i)).Union();
+					bool success;
+					if (broadcast) {
+						success = _messageSender->broadcastServerMessage(fbb, ServerMsgType::EntityRemove, data);
+					} else {
+						success = _messageSender->sendServerMessage(_serverPeers.data(), (int)_serverPeers.size(), fbb, ServerMsgType::EntityRemove, data);
+					}
+					if (!success) {
+						++failed;
+					}
+				}
+				++finished;
+			});
+		}
+		const int expected = Clients * senders * messages;
+		// the update thread keeps handling the received client messages while the senders are busy
+		EXPECT_TRUE(updateUntil([&] () {
+			return finished == senders && _receivedMessages == expected;
+		})) << "received " << _receivedMessages << " of " << expected << " messages";
+		for (std::thread& t : threads) {
+			t.join();
+		}
+		EXPECT_EQ(0, failed.load());
+	}
+
+	void expectReceived(int senders, int messages) {
+		for (int c = 0; c < Clients; ++c) {
+			const TestClient& client = _clients[c];
+			EXPECT_EQ(0, client.outOfOrder) << "client " << c;
+			for (int s = 0; s < senders; ++s) {
+				EXPECT_EQ(messages, client.received[s]) << "client " << c << " sender " << s;
+			}
+		}
+	}
+
+public:
+	void SetUp() override {
+		_eventBus = std::make_shared<core::EventBus>();
+		_protocolHandlerRegistry = std::make_shared<ProtocolHandlerRegistry>();
+		const metric::MetricPtr& metric = std::make_shared<metric::Metric>();
+		_network = std::make_shared<ServerNetwork>(_protocolHandlerRegistry, _eventBus, metric);
+		_messageSender = std::make_shared<ServerMessageSender>(_network, metric);
+		_port = (uint16_t)(1025u + ((uintptr_t)this >> 4) % 60000u);
+		Super::SetUp();
+	}
+
+	void onEvent(const NewConnectionEvent& event) override {
+		_serverPeers.push_back(event.get());
+	}
+
+	void onEvent(const DisconnectEvent& event) override {
+		++_disconnectEvents;
+	}
+
+	bool onInitApp() override {
+		_eventBus->subscribe<NewConnectionEvent>(*this);
+		_eventBus->subscribe<DisconnectEvent>(*this);
+		_updateThread = std::this_thread::get_id();
+		if (!_network->init()) {
+			return false;
+		}
+		_protocolHandlerRegistry->registerHandler(EnumNameClientMsgType(ClientMsgType::TriggerAction), std::make_shared<TriggerActionHandler>(this));
+		return _network->bind(_port, _host);
+	}
+
+	void onCleanupApp() override {
+		stopClients();
+		_eventBus->unsubscribe<NewConnectionEvent>(*this);
+		_eventBus->unsubscribe<DisconnectEvent>(*this);
+		_network->shutdown();
+	}
+};
+
+TEST_F(ServerNetworkTest, testSendDirect) {
+	ASSERT_FALSE(_network->isThreaded());
+	ASSERT_TRUE(connectClients(10));
+	// a shared packet must survive a failed send to one of the peers
+	const int messages = 200;
+	_serverPeers.push_back(Connection());
+	flatbuffers::FlatBufferBuilder fbb;
+	for (int i = 0; i < messages; ++i) {
+		_messageSender->sendServerMessage(_serverPeers.data(), (int)_serverPeers.size(), fbb,
+				ServerMsgType::EntityRemove, CreateEntityRemove(fbb, (int64_t)messageId(0, i)).Union());
+	}
+	_serverPeers.pop_back();
+	EXPECT_TRUE(updateUntil([this] () {
+		return _receivedMessages == Clients * messages && _handlerCalled == Clients * 10;
+	}));
+	stopClients();
+	expectReceived(1, messages);
+	EXPECT_EQ(0, _handlerWrongThread);
+}
+
+TEST_F(ServerNetworkTest, testConcurrentSenders) {
+	ASSERT_TRUE(_network->startThread());
+	ASSERT_TRUE(_network->isThreaded());
+	const int clientMessages = 100;
+	ASSERT_TRUE(connectClients(clientMessages));
+	const int senders = MaxSenders;
+	const int messages = 500;
+	sendConcurrently(senders, 2, messages);
+	EXPECT_TRUE(updateUntil([this] () {
+		return _handlerCalled == Clients * clientMessages;
+	}));
+	stopClients();
+	expectReceived(senders, messages);
+	// the received messages are handled on the thread that calls update()
+	EXPECT_EQ(Clients * clientMessages, _handlerCalled);
+	EXPECT_EQ(0, _handlerWrongThread);
+}
+
+TEST_F(ServerNetworkTest, testDisconnectOnProtocolError) {
+	ASSERT_TRUE(_network->startThread());
+	ASSERT_TRUE(connectClients(0, true));
+	// the disconnect is executed by the network thread - the event is published in update()
+	EXPECT_TRUE(updateUntil([this] () {
+		return _disconnectedClients == Clients && _disconnectEvents == Clients;
+	})) << _disconnectedClients << " clients disconnected, " << _disconnectEvents << " disconnect events";
+	stopClients();
+}
+
+TEST_F(ServerNetworkTest, testShutdownWithQueuedPackets) {
+	ASSERT_TRUE(_network->startThread());
+	ASSERT_TRUE(connectClients());
+	flatbuffers::FlatBufferBuilder fbb;
+	for (int i = 0; i < 100; ++i) {
+		EXPECT_TRUE(_messageSender->sendServerMessage(_serverPeers.data(), (int)_serverPeers.size(), fbb,
+				ServerMsgType::EntityRemove, CreateEntityRemove(fbb, (int64_t)messageId(0, i)).Union()));
+	}
+	// the queued packets are released on shutdown - there must not be any leak
+	_network->shutdown();
+	EXPECT_FALSE(_network->isThreaded());
+	EXPECT_FALSE(_messageSender->broadcastServerMessage(fbb, ServerMsgType::EntityRemove, CreateEntityRemove(fbb, 0).Union()));
+}
+
+TEST_F(ServerNetworkTest, testReusedPeerSlot) {
+	ASSERT_TRUE(_network->startThread());
+	ENetAddress address;
+	enet_address_set_host(&address, _host.c_str());
+	address.port = _port;
+	TestClient first;
+	TestClient second;
+	for (TestClient* client : { &first, &second }) {
+		client->host = enet_host_create(nullptr, 1, 1, 0, 0);
+		ASSERT_NE(nullptr, client->host);
+		enet_host_compress_with_range_coder(client->host);
+	}
+	// the second client only expects the message that is sent to its own connection
+	second.expected[0] = 1;
+	// services the client - returns true if the given event type was received
+	auto service = [this] (TestClient& client, ENetEventType type) {
+		bool received = false;
+		ENetEvent event;
+		while (enet_host_service(client.host, &event, 0) > 0) {
+			if (event.type == ENET_EVENT_TYPE_RECEIVE) {
+				onMessage(client, event.packet);
+				enet_packet_destroy(event.packet);
+			}
+			received |= event.type == type;
+		}
+		return received;
+	};
+	auto serviceUntil = [&] (TestClient& client, ENetEventType type) {
+		for (int i = 0; i < 30000; ++i) {
+			if (service(client, type)) {
+				return true;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return false;
+	};
+
+	ENetPeer* firstPeer = enet_host_connect(first.host, &address, 1, 0);
+	ASSERT_NE(nullptr, firstPeer);
+	ASSERT_TRUE(updateUntil([&] () {
+		service(first, ENET_EVENT_TYPE_NONE);
+		return _serverPeers.size() == 1u;
+	}));
+	const Connection old = _serverPeers[0];
+	ASSERT_TRUE(_network->setAttachment(old, this));
+
+	// the network thread frees the peer slot and hands it over to the second client before update()
+	// handled the disconnect of the first one
+	enet_peer_disconnect_now(firstPeer, 0);
+	// give the network thread the time to reset the peer - a connect in the same service call would get another slot
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	ASSERT_NE(nullptr, enet_host_connect(second.host, &address, 1, 0));
+	ASSERT_TRUE(serviceUntil(second, ENET_EVENT_TYPE_CONNECT));
+	flatbuffers::FlatBufferBuilder fbb;
+	_messageSender->sendServerMessage(old, fbb, ServerMsgType::EntityRemove, CreateEntityRemove(fbb, (int64_t)messageId(0, 0)).Union());
+
+	ASSERT_TRUE(updateUntil([&] () {
+		service(second, ENET_EVENT_TYPE_NONE);
+		return _serverPeers.size() == 2u && _disconnectEvents == 1;
+	}));
+	const Connection current = _serverPeers[1];
+	ASSERT_EQ(old.peer, current.peer) << "the peer slot wasn't reused";
+	EXPECT_NE(old.connectID, current.connectID);
+	EXPECT_EQ(nullptr, _network->attachment(current));
+	EXPECT_EQ(nullptr, _network->attachment(old));
+
+	// the message for the first client must not reach the second one
+	EXPECT_TRUE(_messageSender->sendServerMessage(current, fbb, ServerMsgType::EntityRemove, CreateEntityRemove(fbb, (int64_t)messageId(0, 1)).Union()));
+	EXPECT_TRUE(serviceUntil(second, ENET_EVENT_TYPE_RECEIVE));
+	EXPECT_EQ(1, second.received[0]);
+	EXPECT_EQ(0, second.outOfOrder);
+
+	for (TestClient* client : { &first, &second }) {
+		enet_host_destroy(client->host);
+	}
+}
+
+}
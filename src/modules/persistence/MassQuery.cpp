@@ -39,13 +39,18 @@ void MassQuery::add(ISavable* savable) {
 		return;
 	}
 	for (const Model* m : models) {
-		if (m->shouldBeDeleted()) {
-			_delete.push_back(m);
-		} else {
-			_insertOrUpdate.push_back(m);
-		}
+		add(m);
 	}
-	if (_insertOrUpdate.size() + _delete.size() >= _commitSize) {
+}
+
+void MassQuery::add(const Model* model) {
+	core_assert(model != nullptr);
+	if (model->shouldBeDeleted()) {
+		_delete.push_back(model);
+	} else {
+		_insertOrUpdate.push_back(model);
+	}
+	if (size() >= _commitSize) {
 		commit();
 	}
 }
@@ -29,7 +29,16 @@ public:
 	~MassQuery();
 
 	void add(ISavable* savable);
+	/**
+	 * @note The model must stay valid until the query was committed
+	 */
+	void add(const Model* model);
+	size_t size() const;
 	void commit();
 };
 
+inline size_t MassQuery::size() const {
+	return _insertOrUpdate.size() + _delete.size();
+}
+
 }
@@ -29,6 +29,74 @@ Model::Model(const Meta* s) :
 Model::~Model() {
 }
 
+template<class T>
+static inline void assignValue(uint8_t* target, const uint8_t* source) {
+	*(T*)target = *(const T*)source;
+}
+
+template<class T>
+static inline void mergeValue(uint8_t* target, const uint8_t* source, bool accumulate) {
+	if (accumulate) {
+		*(T*)target = *(T*)target + *(const T*)source;
+	} else {
+		assignValue<T>(target, source);
+	}
+}
+
+bool Model::merge(const Model& newer) {
+	if (_s != newer._s) {
+		return false;
+	}
+	if (_flagToDelete || newer._flagToDelete) {
+		return false;
+	}
+	for (const Field& f : _s->_fields) {
+		if (!newer.isValid(f)) {
+			continue;
+		}
+		uint8_t* target = _membersPointer + f.offset;
+		const uint8_t* source = newer._membersPointer + f.offset;
+		// relative updates are only accumulated if both models carry a delta
+		const bool accumulate = f.updateOperator != Operator::SET && isValid(f) && !isNull(f) && !newer.isNull(f);
+		switch (f.type) {
+		case FieldType::PASSWORD:
+		case FieldType::TEXT:
+		case FieldType::STRING:
+			assignValue<core::String>(target, source);
+			break;
+		case FieldType::TIMESTAMP:
+			assignValue<Timestamp>(target, source);
+			break;
+		case FieldType::BLOB:
+			assignValue<Blob>(target, source);
+			break;
+		case FieldType::BOOLEAN:
+			assignValue<bool>(target, source);
+			break;
+		case FieldType::INT:
+			mergeValue<int32_t>(target, source, accumulate);
+			break;
+		case FieldType::SHORT:
+			mergeValue<int16_t>(target, source, accumulate);
+			break;
+		case FieldType::BYTE:
+			mergeValue<uint8_t>(target, source, accumulate);
+			break;
+		case FieldType::LONG:
+			mergeValue<int64_t>(target, source, accumulate);
+			break;
+		case FieldType::DOUBLE:
+			mergeValue<double>(target, source, accumulate);
+			break;
+		case FieldType::MAX:
+			break;
+		}
+		setIsNull(f, newer.isNull(f));
+		setValid(f, true);
+	}
+	return true;
+}
+
 const Field& Model::getField(const char* name) const {
 	if (name != nullptr && name[0] != '\0') {
 		for (auto i = _s->_fields.begin(); i != _s->_fields.end(); ++i) {
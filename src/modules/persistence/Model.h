@@ -67,6 +67,20 @@ public:
 	Model(const Meta* s);
 	virtual ~Model();
 
+	/**
+	 * @return A heap allocated copy of this model - including the delete flag. The caller takes the ownership.
+	 * @note Used to create immutable snapshots of dirty models that are handed over to another thread.
+	 */
+	virtual Model* clone() const = 0;
+
+	/**
+	 * @brief Merges the valid field values of the given (newer) model of the same table into this model.
+	 * Fields with a relative update @c Operator are accumulated, all other fields are just overwritten.
+	 * @note Deletes can't be merged - replace the model instead.
+	 * @return @c false if the given model is for a different table or one of the models is flagged for delete.
+	 */
+	bool merge(const Model& newer);
+
 	/**
 	 * @return The table name without schema
 	 * @see schema()
@@ -6,7 +6,10 @@
 #include "DBHandler.h"
 #include "MassQuery.h"
 #include "core/Common.h"
+#include "core/GameConfig.h"
+#include "core/TimeProvider.h"
 #include "core/Trace.h"
+#include "core/concurrent/Concurrency.h"
 
 namespace persistence {
 
@@ -14,6 +17,10 @@ PersistenceMgr::PersistenceMgr(const DBHandlerPtr& dbHandler) :
 		_lock("persistencemgr"), _dbHandler(dbHandler) {
 }
 
+PersistenceMgr::~PersistenceMgr() {
+	core_assert_msg(!_flusher.joinable(), "PersistenceMgr::shutdown() wasn't called");
+}
+
 bool PersistenceMgr::registerSavable(uint32_t fourcc, ISavable *savable) {
 	Log::trace(logid, "Register savable (fourcc: %u, savable: %p)", fourcc, savable);
 	core::ScopedWriteLock lock(_lock);
@@ -33,10 +40,12 @@ bool PersistenceMgr::unregisterSavable(uint32_t fourcc, ISavable *savable) {
 	auto s = i->second.find(savable);
 	if (s != i->second.end()) {
 		i->second.erase(s);
-		// make sure to persist the dirty state
-		MassQuery stmt = _dbHandler->massQuery();
-		stmt.add(savable);
-		stmt.commit();
+		// make sure to persist the dirty state - the snapshot is independent from the savable
+		std::vector<const Model*> models;
+		if (savable->getDirtyModels(models)) {
+			_queue.push(models);
+			wakeup();
+		}
 		Log::trace(logid, "Removed savable (fourcc: %u, savable: %p)", fourcc, savable);
 		return true;
 	}
@@ -45,30 +54,140 @@ bool PersistenceMgr::unregisterSavable(uint32_t fourcc, ISavable *savable) {
 }
 
 bool PersistenceMgr::init() {
+	_flushLatency = core::Var::get(cfg::DatabaseFlushLatency, "50");
+	if (_flusher.joinable()) {
+		return true;
+	}
+	_stop = false;
+	_flusher = std::thread([this] () {
+		const char *name = "PersistenceFlusher";
+		if (!core::setThreadName(name)) {
+			Log::warn(logid, "Failed to set thread name for the persistence flusher");
+		}
+		core_trace_thread(name);
+		flusherLoop();
+	});
 	return true;
 }
 
 void PersistenceMgr::shutdown() {
 	core_trace_scoped(PersistenceMgrShutdown);
+	if (_flusher.joinable()) {
+		_stop = true;
+		wakeup();
+		_flusher.join();
+	}
 	update(0l);
 	core::ScopedWriteLock lock(_lock);
 	_savables.clear();
 }
 
-void PersistenceMgr::update(long dt) {
-	core_trace_scoped(PersistenceMgrUpdate);
-	core::ScopedReadLock lock(_lock);
-	for (auto& collection : _savables) {
-		if (collection.second.empty()) {
-			continue;
+void PersistenceMgr::wakeup() {
+	core::ScopedLock lock(_wakeLock);
+	_wakeCondition.notify_one();
+}
+
+void PersistenceMgr::flusherLoop() {
+	while (!_stop) {
+		{
+			core::ScopedLock lock(_wakeLock);
+			if (!_stop && _queue.empty()) {
+				_wakeCondition.waitTimeout(_wakeLock, 1000);
+			}
+		}
+		while (!_stop) {
+			size_t batchSize;
+			{
+				core::ScopedLock lock(_statsLock);
+				batchSize = _batchSize;
+			}
+			const uint64_t start = core::TimeProvider::systemMillis();
+			if (flush(batchSize) == 0u) {
+				break;
+			}
+			const uint64_t duration = core::TimeProvider::systemMillis() - start;
+			const uint64_t target = (uint64_t)core_max(1, _flushLatency->intVal());
+			core::ScopedLock lock(_statsLock);
+			if (duration > target) {
+				_batchSize = core_max(MinBatchSize, _batchSize / 2u);
+			} else if (duration * 2u < target) {
+				_batchSize = core_min(MaxBatchSize, _batchSize * 2u);
+			}
+		}
+	}
+}
+
+size_t PersistenceMgr::flush(size_t amount) {
+	core_trace_scoped(PersistenceMgrFlush);
+	core::ScopedLock lock(_flushLock);
+	WriteBehindQueue::Models models;
+	models.reserve(amount);
+	const size_t n = _queue.pop(models, amount);
+	if (n == 0u) {
+		return 0u;
+	}
+	const uint64_t start = core::TimeProvider::systemMillis();
+	// the columns of a mass query are defined by the first model - so only models
+	// of the same table and with the same set of valid fields can share a query
+	std::unordered_map<core::String, std::vector<const Model*>, core::StringHash> groups;
+	for (const WriteBehindQueue::ModelPtr& m : models) {
+		core::String signature = m->tableName();
+		for (const Field& f : m->fields()) {
+			signature += m->isValid(f) ? '1' : '0';
 		}
+		groups[signature].push_back(m.get());
+	}
+	for (const auto& group : groups) {
 		MassQuery stmt = _dbHandler->massQuery();
-		for (ISavable *savable : collection.second) {
-			stmt.add(savable);
+		for (const Model* m : group.second) {
+			stmt.add(m);
 		}
 		stmt.commit();
 	}
-	Log::debug(logid, "Persisted dirty states of %i savables", (int)_savables.size());
+	const uint64_t duration = core::TimeProvider::systemMillis() - start;
+	{
+		core::ScopedLock statsLock(_statsLock);
+		_stats.flushed += n;
+		++_stats.flushes;
+		_stats.lastFlushMillis = duration;
+		_stats.maxFlushMillis = core_max(_stats.maxFlushMillis, duration);
+	}
+	Log::debug(logid, "Persisted %i dirty models in %i groups (%i ms)", (int)n, (int)groups.size(), (int)duration);
+	return n;
+}
+
+void PersistenceMgr::snapshot() {
+	core_trace_scoped(PersistenceMgrSnapshot);
+	std::vector<const Model*> models;
+	{
+		core::ScopedReadLock lock(_lock);
+		for (auto& collection : _savables) {
+			for (ISavable *savable : collection.second) {
+				models.clear();
+				if (!savable->getDirtyModels(models)) {
+					continue;
+				}
+				_queue.push(models);
+			}
+		}
+	}
+	wakeup();
+}
+
+void PersistenceMgr::update(long dt) {
+	core_trace_scoped(PersistenceMgrUpdate);
+	snapshot();
+	while (flush(MaxBatchSize) > 0u) {
+	}
+}
+
+PersistenceMgr::Stats PersistenceMgr::stats() const {
+	core::ScopedLock lock(_statsLock);
+	Stats stats = _stats;
+	stats.backlog = _queue.size();
+	stats.coalesced = _queue.coalesced();
+	stats.batchSize = _batchSize;
+	return stats;
 }
 
 }
@@ -6,10 +6,15 @@
 
 #include <memory>
 #include <map>
+#include <thread>
 #include <unordered_set>
 #include "ISavable.h"
 #include "DBHandler.h"
+#include "WriteBehindQueue.h"
 #include "core/IComponent.h"
+#include "core/Var.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ConditionVariable.h"
 #include "core/concurrent/ReadWriteLock.h"
 
 /**
@@ -20,30 +25,100 @@ namespace persistence {
 /**
  * @brief This class is responsible for calling the update mechanisms for the single components of each player.
  * It will collect all database actions in prepared statements to write delta values into the database.
+ *
+ * The dirty models are written behind: @c snapshot() is called at a tick boundary by the thread that owns the
+ * game state and queues immutable copies of the dirty models. A dedicated flusher thread coalesces updates for
+ * the same primary key and writes them via @c MassQuery in batches. The batch size is adjusted to stay below the
+ * flush latency that is configured by the @c cfg::DatabaseFlushLatency var.
+ *
  * @note Your @c ISavable instances must be registered and unregistered.
  */
 class PersistenceMgr : public core::IComponent {
+public:
+	struct Stats {
+		/**
+		 * @brief The amount of snapshots that are waiting to get flushed
+		 */
+		size_t backlog = 0u;
+		/**
+		 * @brief The amount of models that were written by the flushes
+		 */
+		uint64_t flushed = 0u;
+		/**
+		 * @brief The amount of dirty models that were merged into already queued snapshots
+		 */
+		uint64_t coalesced = 0u;
+		uint64_t flushes = 0u;
+		uint64_t lastFlushMillis = 0u;
+		uint64_t maxFlushMillis = 0u;
+		/**
+		 * @brief The current amount of models that are written by one flush
+		 */
+		size_t batchSize = 0u;
+	};
 private:
 	static constexpr uint32_t logid = Log::logid("PersistenceMgr");
+	static constexpr size_t MinBatchSize = 16u;
+	static constexpr size_t MaxBatchSize = 4096u;
 	using Savables = std::unordered_set<ISavable*>;
 	using Map = std::map<uint32_t, Savables>;
 	Map _savables;
 	core::ReadWriteLock _lock;
 	const DBHandlerPtr _dbHandler;
+
+	WriteBehindQueue _queue;
+	std::thread _flusher;
+	core::AtomicBool _stop { true };
+	core_trace_mutex(core::Lock, _wakeLock, "PersistenceMgrWake");
+	core::ConditionVariable _wakeCondition;
+	// serializes the flushes of the flusher thread and the blocking update() calls
+	core_trace_mutex(core::Lock, _flushLock, "PersistenceMgrFlush");
+	core::VarPtr _flushLatency;
+	// guards the batch size and the stats - never held while the models are written, so that
+	// stats() doesn't wait for the database
+	core_trace_mutex(core::Lock, _statsLock, "PersistenceMgrStats");
+	size_t _batchSize = 256u;
+	Stats _stats;
+
+	void flusherLoop();
+	/**
+	 * @return The amount of models that were written
+	 */
+	size_t flush(size_t amount);
+	void wakeup();
 public:
 	PersistenceMgr(const DBHandlerPtr& dbHandler);
-	virtual ~PersistenceMgr() {}
+	virtual ~PersistenceMgr();
 
 	virtual bool registerSavable(uint32_t fourcc, ISavable *savable);
+	/**
+	 * @note The dirty models of the savable are queued for the flusher, the models are not accessed anymore after this call.
+	 */
 	virtual bool unregisterSavable(uint32_t fourcc, ISavable *savable);
 
+	/**
+	 * @brief Starts the flusher thread
+	 */
 	bool init() override;
 	/**
+	 * @brief Stops the flusher thread and writes all pending dirty models.
 	 * @note You have to make sure, that the update is not called anymore and also not called currently.
 	 */
 	void shutdown() override;
 
+	/**
+	 * @brief Collects the dirty models of all registered @c ISavable instances and hands the snapshots
+	 * over to the flusher thread.
+	 * @note Call this from the thread that modifies the state of the savables - at the tick boundary.
+	 */
+	void snapshot();
+
+	/**
+	 * @brief Takes a @c snapshot() and blocks until all pending models are written.
+	 */
 	void update(long dt);
+
+	Stats stats() const;
 };
 
 typedef std::shared_ptr<PersistenceMgr> PersistenceMgrPtr;
@@ -0,0 +1,101 @@
+/**
+ * @file
+ */
+
+#include "WriteBehindQueue.h"
+#include "Model.h"
+#include "BindParam.h"
+#include "core/Assert.h"
+
+namespace persistence {
+
+bool WriteBehindQueue::key(const Model& model, core::String& out) {
+	const PrimaryKeys& primaryKeys = model.primaryKeys();
+	if (primaryKeys.empty()) {
+		return false;
+	}
+	BindParam params((int)primaryKeys.size());
+	for (const core::String& name : primaryKeys) {
+		const Field& f = model.getField(name);
+		if (f.name != name || !model.isValid(f) || model.isNull(f)) {
+			return false;
+		}
+		params.push(model, f);
+	}
+	out = model.schema();
+	out += ".";
+	out += model.tableName();
+	for (int i = 0; i < params.position; ++i) {
+		out += "|";
+		out += params.values[i];
+	}
+	return true;
+}
+
+bool WriteBehindQueue::push(const Model& model) {
+	core::String k;
+	const bool coalesce = key(model, k);
+	core::ScopedLock lock(_lock);
+	if (coalesce) {
+		auto i = _index.find(k);
+		if (i != _index.end()) {
+			Entry* e = i->second;
+			if (!e->model->merge(model)) {
+				// deletes are not merged - the newer state replaces the queued one
+				e->model.reset(model.clone());
+			}
+			++_coalesced;
+			return true;
+		}
+	}
+	Model* snapshot = model.clone();
+	core_assert(snapshot != nullptr);
+	_entries.push_back(Entry{k, ModelPtr(snapshot)});
+	if (coalesce) {
+		_index.insert(std::make_pair(k, &_entries.back()));
+	}
+	return false;
+}
+
+void WriteBehindQueue::push(const std::vector<const Model*>& models) {
+	for (const Model* m : models) {
+		push(*m);
+	}
+}
+
+size_t WriteBehindQueue::pop(Models& out, size_t amount) {
+	core::ScopedLock lock(_lock);
+	size_t n = 0u;
+	while (n < amount && !_entries.empty()) {
+		Entry& e = _entries.front();
+		if (!e.key.empty()) {
+			_index.erase(e.key);
+		}
+		out.emplace_back(std::move(e.model));
+		_entries.pop_front();
+		++n;
+	}
+	return n;
+}
+
+size_t WriteBehindQueue::size() const {
+	core::ScopedLock lock(_lock);
+	return _entries.size();
+}
+
+bool WriteBehindQueue::empty() const {
+	return size() == 0u;
+}
+
+uint64_t WriteBehindQueue::coalesced() const {
+	core::ScopedLock lock(_lock);
+	return _coalesced;
+}
+
+void WriteBehindQueue::clear() {
+	core::ScopedLock lock(_lock);
+	_index.clear();
+	_entries.clear();
+}
+
+}
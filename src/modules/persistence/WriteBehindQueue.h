@@ -0,0 +1,71 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Model.h"
+#include "core/String.h"
+#include "core/concurrent/Lock.h"
+#include "core/Trace.h"
+#include <deque>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+namespace persistence {
+
+/**
+ * @brief Thread safe queue of immutable @c Model snapshots that coalesces updates for the same primary key.
+ *
+ * The thread that owns the game state pushes the dirty models of the @c ISavable instances, the
+ * flusher thread of the @c PersistenceMgr pops them in batches. Pushing a model for a primary key that
+ * is already queued merges the values into the queued snapshot (see @c Model::merge()) - this way a hot
+ * row is only written once per flush and a mass query never contains the same key twice.
+ *
+ * @note Models without a (valid) primary key are never coalesced.
+ * @ingroup Persistence
+ */
+class WriteBehindQueue {
+public:
+	using ModelPtr = std::unique_ptr<Model>;
+	using Models = std::vector<ModelPtr>;
+private:
+	struct Entry {
+		core::String key;
+		ModelPtr model;
+	};
+	// references to deque elements stay valid when pushing to the back or popping from the front
+	std::deque<Entry> _entries;
+	std::unordered_map<core::String, Entry*, core::StringHash> _index;
+	core_trace_mutex(core::Lock, _lock, "WriteBehindQueue");
+	uint64_t _coalesced = 0u;
+
+	static bool key(const Model& model, core::String& out);
+public:
+	/**
+	 * @brief Creates a snapshot of the given model and queues it - or merges it into an already
+	 * queued snapshot for the same primary key.
+	 * @return @c true if the model was coalesced with an already queued snapshot
+	 */
+	bool push(const Model& model);
+	void push(const std::vector<const Model*>& models);
+
+	/**
+	 * @brief Moves up to @c amount snapshots in the order they were queued into the given vector.
+	 * @return The amount of snapshots that were added
+	 */
+	size_t pop(Models& out, size_t amount);
+
+	size_t size() const;
+	bool empty() const;
+
+	/**
+	 * @return The amount of pushed models that were merged into already queued snapshots
+	 */
+	uint64_t coalesced() const;
+
+	void clear();
+};
+
+}
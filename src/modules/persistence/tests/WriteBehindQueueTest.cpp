@@ -0,0 +1,106 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "persistence/WriteBehindQueue.h"
+#include "TestModels.h"
+
+namespace persistence {
+
+class WriteBehindQueueTest : public core::AbstractTest {
+protected:
+	db::TestModel create(int64_t id, int points) const {
+		db::TestModel mdl;
+		mdl.setId(id);
+		mdl.setName("foobar");
+		mdl.setPoints(points);
+		return mdl;
+	}
+};
+
+TEST_F(WriteBehindQueueTest, testCoalesce) {
+	WriteBehindQueue queue;
+	db::TestModel mdl = create(1, 1);
+	EXPECT_FALSE(queue.push(mdl));
+	mdl.setName("barfoo");
+	EXPECT_TRUE(queue.push(mdl));
+	EXPECT_FALSE(queue.push(create(2, 1)));
+	EXPECT_EQ(2u, queue.size());
+	EXPECT_EQ(1u, queue.coalesced());
+
+	WriteBehindQueue::Models models;
+	ASSERT_EQ(2u, queue.pop(models, 10));
+	EXPECT_TRUE(queue.empty());
+	const db::TestModel* first = (const db::TestModel*)models[0].get();
+	EXPECT_EQ(1, first->id());
+	EXPECT_EQ("barfoo", first->name());
+	const db::TestModel* second = (const db::TestModel*)models[1].get();
+	EXPECT_EQ(2, second->id());
+}
+
+TEST_F(WriteBehindQueueTest, testSnapshotIsImmutable) {
+	WriteBehindQueue queue;
+	db::TestModel mdl = create(1, 1);
+	queue.push(mdl);
+	mdl.setName("changed");
+	WriteBehindQueue::Models models;
+	ASSERT_EQ(1u, queue.pop(models, 10));
+	EXPECT_EQ("foobar", ((const db::TestModel*)models[0].get())->name());
+}
+
+TEST_F(WriteBehindQueueTest, testRelativeUpdatesAreAccumulated) {
+	WriteBehindQueue queue;
+	queue.push(create(1, 10));
+	queue.push(create(1, -3));
+	queue.push(create(1, 5));
+	WriteBehindQueue::Models models;
+	ASSERT_EQ(1u, queue.pop(models, 10));
+	const db::TestModel* mdl = (const db::TestModel*)models[0].get();
+	ASSERT_NE(nullptr, mdl->points());
+	EXPECT_EQ(12, *mdl->points());
+}
+
+TEST_F(WriteBehindQueueTest, testDeleteReplaces) {
+	WriteBehindQueue queue;
+	queue.push(create(1, 10));
+	db::TestModel del = create(1, 0);
+	del.flagForDelete();
+	EXPECT_TRUE(queue.push(del));
+	WriteBehindQueue::Models models;
+	ASSERT_EQ(1u, queue.pop(models, 10));
+	EXPECT_TRUE(models[0]->shouldBeDeleted());
+
+	// an insert after the delete replaces the delete again
+	queue.push(del);
+	queue.push(create(1, 10));
+	models.clear();
+	ASSERT_EQ(1u, queue.pop(models, 10));
+	EXPECT_FALSE(models[0]->shouldBeDeleted());
+	EXPECT_EQ(10, *((const db::TestModel*)models[0].get())->points());
+}
+
+TEST_F(WriteBehindQueueTest, testWithoutPrimaryKey) {
+	WriteBehindQueue queue;
+	db::TestModel mdl;
+	mdl.setName("foobar");
+	EXPECT_FALSE(queue.push(mdl));
+	EXPECT_FALSE(queue.push(mdl));
+	EXPECT_EQ(2u, queue.size());
+}
+
+TEST_F(WriteBehindQueueTest, testPopBatches) {
+	WriteBehindQueue queue;
+	for (int i = 0; i < 10; ++i) {
+		queue.push(create(i + 1, 1));
+	}
+	WriteBehindQueue::Models models;
+	EXPECT_EQ(4u, queue.pop(models, 4));
+	EXPECT_EQ(6u, queue.size());
+	// the key of a popped snapshot can be queued again
+	EXPECT_FALSE(queue.push(create(1, 1)));
+	EXPECT_EQ(7u, queue.pop(models, 100));
+	EXPECT_EQ(11u, models.size());
+}
+
+}
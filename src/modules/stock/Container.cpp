@@ -43,9 +43,6 @@ bool Container::add(const ItemPtr& item) {
 	if (!findSpace(item, x, y)) {
 		return false;
 	}
-	if (!canAdd(item, x, y)) {
-		return false;
-	}
 	return add(item, x, y);
 }
 
@@ -103,7 +100,14 @@ ItemPtr Container::get(uint8_t x, uint8_t y) const {
 		}
 		return _items.front().item;
 	}
+	// no need to check the items if the cell isn't occupied
+	if (_shape.isFree(x, y)) {
+		return ItemPtr();
+	}
 	for (const ContainerItem& item : _items) {
+		if (x < item.x || y < item.y || x - item.x >= ItemMaxWidth || y - item.y >= ItemMaxHeight) {
+			continue;
+		}
 		const ItemShape& shape = item.item->shape();
 		if (shape.isInShape(x - item.x, y - item.y)) {
 			return item.item;
@@ -123,18 +127,13 @@ bool Container::findSpace(const ItemPtr& item, uint8_t& targetX, uint8_t& target
 	if ((_flags & Single) != 0 && !_items.empty()) {
 		return false;
 	}
-	for (uint8_t y = 0; y < ContainerMaxHeight; ++y) {
-		for (uint8_t x = 0; x < ContainerMaxWidth; ++x) {
-			if (!canAdd(item, x, y)) {
-				continue;
-			}
-			targetX = x;
-			targetY = y;
-			return true;
-		}
+	if (item == nullptr) {
+		return false;
 	}
-
-	return false;
+	if ((_flags & Unique) != 0 && hasItemOfType(item->type())) {
+		return false;
+	}
+	return _shape.findFree(item->shape(), targetX, targetY, (_flags & BestFit) != 0);
 }
 
 }
@@ -34,6 +34,8 @@ public:
 	static constexpr uint32_t Single     = 1 << 1;
 	/** a scrollable container can hold as many items as wanted */
 	static constexpr uint32_t Scrollable = 1 << 2;
+	/** automatic placement searches the location where the item touches the most occupied cells */
+	static constexpr uint32_t BestFit    = 1 << 3;
 
 	/**
 	 * @param[in] flags Bitmask of flags to control the behavior of the container
@@ -53,6 +55,7 @@ public:
 
 	/**
 	 * @brief Find a free location in the container to place the given item at
+	 * @note The first free location is used - or the best fitting one for @c BestFit containers.
 	 * @param[out] x The x location to place the item
 	 * @param[out] y The y location to place the item
 	 * @return @c true if a free location was found, @c false otherwise
@@ -98,6 +101,7 @@ inline int Container::free() const {
 
 inline void Container::clear() {
 	_items.clear();
+	_shape.clearItems();
 }
 
 inline size_t Container::itemCount() const {
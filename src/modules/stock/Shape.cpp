@@ -4,9 +4,31 @@
 
 #include "Shape.h"
 #include "core/Assert.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 namespace stock {
 
+static inline int countBits(uint64_t bits) {
+#ifdef _MSC_VER
+	return (int)__popcnt64(bits);
+#else
+	return __builtin_popcountll(bits);
+#endif
+}
+
+static inline int lowestBit(uint64_t bits) {
+	core_assert(bits != 0u);
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, bits);
+	return (int)index;
+#else
+	return __builtin_ctzll(bits);
+#endif
+}
+
 bool ContainerShape::addRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
 	if (x + width >= ContainerMaxWidth) {
 		return false;
@@ -40,51 +62,101 @@ bool ContainerShape::isFree(const ItemShape& itemShape, uint8_t x, uint8_t y) co
 	if (!isInShape(x, y)) {
 		return false;
 	}
+	return ((freeColumns(itemShape, y) >> x) & (ContainerShapeType)1) != (ContainerShapeType)0;
+}
 
+ContainerShapeType ContainerShape::freeColumns(const ItemShape& itemShape, uint8_t y) const {
+	core_assert_always(y < ContainerMaxHeight);
 	const ItemShapeType shape = static_cast<ItemShapeType>(itemShape);
-	const uint8_t height = itemShape.height();
-	for (uint8_t row = 0; row < height; ++row) {
+	// the item is anchored at its upper left corner - this must be part of the container shape
+	ContainerShapeType columns = _containerShape[y];
+	for (uint8_t row = 0; row < ItemMaxHeight && columns != (ContainerShapeType)0; ++row) {
 		/* Result has to be limited to ContainerBitsPerRow - theoretically the ItemShapeType
 		 * can be smaller than the ContainerShapeType - so use the potentially larger one
 		 * here. */
-		const ContainerShapeType itemRow = (shape >> (row * ItemMaxWidth)) & ItemRowLength;
+		ContainerShapeType itemRow = (shape >> (row * ItemMaxWidth)) & ItemRowLength;
 		if (itemRow == (ContainerShapeType)0) {
 			continue;
 		}
-		const ContainerShapeType itemShapeTranslated = itemRow << x;
-
-		/* Check if shifting back is out of bounds - that means the item shape is out
-		 * of bounds at the given coordinates. */
-		if (itemShapeTranslated >> x != itemRow) {
-			return false;
+		if (y + row >= ContainerMaxHeight) {
+			return (ContainerShapeType)0;
 		}
-
-		if (y + row >= ContainerMaxHeight && itemRow > 0) {
-			return false;
+		const ContainerShapeType freeRow = _containerShape[y + row] & ~_itemShape[y + row];
+		/* Shift the free cells back by each set bit of the item row. A column stays set if all
+		 * the cells that are covered by the item row are free. The shift fills in zeros - that
+		 * removes the locations where the item would be out of bounds. */
+		for (int bit = 0; itemRow != (ContainerShapeType)0; ++bit, itemRow >>= 1) {
+			if ((itemRow & (ContainerShapeType)1) != (ContainerShapeType)0) {
+				columns &= freeRow >> bit;
+			}
 		}
+	}
+	return columns;
+}
 
-		if ((itemShapeTranslated & ~_containerShape[y + row]) != (ContainerShapeType)0) {
-			return false;
+int ContainerShape::contacts(ItemShapeType shape, uint8_t x, uint8_t y) const {
+	// the item rows at the given location - including one row above and below the item
+	ContainerShapeType placed[ItemMaxHeight + 2] {};
+	for (int row = 0; row < ItemMaxHeight; ++row) {
+		placed[row + 1] = ((shape >> (row * ItemMaxWidth)) & ItemRowLength) << x;
+	}
+	int contacts = 0;
+	for (int row = 0; row < ItemMaxHeight + 2; ++row) {
+		// the left container border
+		contacts += (int)(placed[row] & (ContainerShapeType)1);
+		ContainerShapeType neighbours = (placed[row] << 1) | (placed[row] >> 1);
+		if (row > 0) {
+			neighbours |= placed[row - 1];
 		}
-
-		if ((itemShapeTranslated & _itemShape[y + row]) != (ContainerShapeType)0) {
-			return false;
+		if (row < ItemMaxHeight + 1) {
+			neighbours |= placed[row + 1];
+		}
+		neighbours &= ~placed[row];
+		if (neighbours == (ContainerShapeType)0) {
+			continue;
+		}
+		const int containerRow = y + row - 1;
+		if (containerRow < 0 || containerRow >= ContainerMaxHeight) {
+			contacts += countBits(neighbours);
+			continue;
 		}
+		const ContainerShapeType freeRow = _containerShape[containerRow] & ~_itemShape[containerRow];
+		contacts += countBits(neighbours & ~freeRow);
 	}
+	return contacts;
+}
 
-	return true;
+bool ContainerShape::findFree(const ItemShape& itemShape, uint8_t& x, uint8_t& y, bool bestFit) const {
+	const ItemShapeType shape = static_cast<ItemShapeType>(itemShape);
+	int bestContacts = -1;
+	for (uint8_t row = 0; row < ContainerMaxHeight; ++row) {
+		ContainerShapeType columns = freeColumns(itemShape, row);
+		if (columns == (ContainerShapeType)0) {
+			continue;
+		}
+		if (!bestFit) {
+			x = (uint8_t)lowestBit(columns);
+			y = row;
+			return true;
+		}
+		for (; columns != (ContainerShapeType)0; columns &= columns - 1) {
+			const uint8_t column = (uint8_t)lowestBit(columns);
+			const int n = contacts(shape, column, row);
+			if (n <= bestContacts) {
+				continue;
+			}
+			bestContacts = n;
+			x = column;
+			y = row;
+		}
+	}
+	return bestContacts >= 0;
 }
 
 int ContainerShape::free() const {
 	int bitCounter = 0;
 	for (int row = 0; row < ContainerMaxHeight; ++row) {
-		for (uint8_t i = 0; i < ContainerBitsPerRow; ++i) {
-			if ((_containerShape[row] & ((ItemShapeType)1 << i)) != 0) {
-				if ((_itemShape[row] & ((ItemShapeType)1 << i)) == 0) {
-					++bitCounter;
-				}
-			}
-		}
+		bitCounter += countBits(_containerShape[row] & ~_itemShape[row]);
 	}
 	return bitCounter;
 }
@@ -92,11 +164,7 @@ int ContainerShape::free() const {
 int ContainerShape::size() const {
 	int bitCounter = 0;
 	for (int row = 0; row < ContainerMaxHeight; ++row) {
-		for (uint8_t i = 0; i < ContainerBitsPerRow; ++i) {
-			if ((_containerShape[row] & ((ItemShapeType)1 << i)) != 0) {
-				++bitCounter;
-			}
-		}
+		bitCounter += countBits(_containerShape[row]);
 	}
 	return bitCounter;
 }
@@ -131,13 +199,7 @@ ItemShapeType ItemShape::set(uint8_t x, uint8_t y) {
 }
 
 int ItemShape::size() const {
-	int bitCounter = 0;
-	for (uint8_t i = 0; i < ItemBits; ++i) {
-		if ((_shape & ((ItemShapeType)1 << i)) != 0) {
-			++bitCounter;
-		}
-	}
-	return bitCounter;
+	return countBits(_shape);
 }
 
 static inline constexpr uint64_t calcItemShapeHeightMask() {
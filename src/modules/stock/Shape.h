@@ -78,6 +78,11 @@ class ContainerShape {
 private:
 	ContainerShapeType _containerShape[ContainerMaxHeight] {};
 	ContainerShapeType _itemShape[ContainerMaxHeight] {};
+
+	/**
+	 * @return The amount of occupied cells or container borders that the item shape would touch
+	 */
+	int contacts(ItemShapeType shape, uint8_t x, uint8_t y) const;
 public:
 	constexpr ContainerShape() {}
 
@@ -104,11 +109,39 @@ public:
 
 	bool isFree(uint8_t x, uint8_t y) const;
 
+	/**
+	 * @brief Computes all the locations in the given row that the item shape can be placed at.
+	 * @return Bitmask with a bit set for each free x location
+	 * @note Each row of the item is tested against a whole container row at once.
+	 */
+	ContainerShapeType freeColumns(const ItemShape& shape, uint8_t y) const;
+
+	/**
+	 * @brief Find a free location for the given item shape.
+	 * @param[out] x The x location to place the item at
+	 * @param[out] y The y location to place the item at
+	 * @param[in] bestFit If @c false the first free location (row by row) is used - otherwise the
+	 * location where the item touches the most occupied cells or container borders.
+	 * @return @c false if the item doesn't fit into the container anymore
+	 */
+	bool findFree(const ItemShape& shape, uint8_t& x, uint8_t& y, bool bestFit = false) const;
+
+	/**
+	 * @brief Remove all item shapes from the container - the container shape itself is kept
+	 */
+	void clearItems();
+
 	int free() const;
 
 	int size() const;
 };
 
+inline void ContainerShape::clearItems() {
+	for (int row = 0; row < ContainerMaxHeight; ++row) {
+		_itemShape[row] = (ContainerShapeType)0;
+	}
+}
+
 inline bool ContainerShape::isInShape(uint8_t x, uint8_t y) const {
 	core_assert_always(y < ContainerMaxHeight && x < ContainerMaxWidth);
 	return (_containerShape[y] & ((ContainerShapeType)1 << x)) != 0;
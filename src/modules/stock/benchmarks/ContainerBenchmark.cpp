@@ -0,0 +1,64 @@
+/**
+ * @file
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "stock/Container.h"
+#include "stock/Item.h"
+#include "stock/ItemData.h"
+
+class ContainerBenchmark: public core::AbstractBenchmark {
+protected:
+	std::vector<stock::ItemData*> _itemData;
+	std::vector<stock::ItemPtr> _items;
+
+	void addItem(stock::ItemId id, uint8_t width, uint8_t height) {
+		stock::ItemData* data = new stock::ItemData(id, stock::ItemType::WEAPON);
+		data->setSize(width, height);
+		_itemData.push_back(data);
+		_items.push_back(std::make_shared<stock::Item>(*data));
+	}
+
+public:
+	bool onInitApp() override {
+		addItem(1, 1, 1);
+		addItem(2, 1, 2);
+		addItem(3, 2, 2);
+		addItem(4, 2, 3);
+		return true;
+	}
+
+	void onCleanupApp() override {
+		_items.clear();
+		for (stock::ItemData* data : _itemData) {
+			delete data;
+		}
+		_itemData.clear();
+	}
+};
+
+// fill a container of the max size until no item fits anymore - range 0 is first fit, 1 is best fit
+BENCHMARK_DEFINE_F(ContainerBenchmark, FillToCapacity) (benchmark::State& state) {
+	stock::ContainerShape shape;
+	shape.addRect(0, 0, stock::ContainerMaxWidth - 1, stock::ContainerMaxHeight - 1);
+	const uint32_t flags = state.range(0) == 0 ? 0u : stock::Container::BestFit;
+	stock::Container container;
+	int64_t added = 0;
+	int free = 0;
+	for (auto _ : state) {
+		container.init(shape, flags);
+		for (size_t i = _items.size(); i > 0; --i) {
+			while (container.add(_items[i - 1])) {
+				++added;
+			}
+		}
+		free = container.free();
+		container.clear();
+	}
+	state.SetItemsProcessed(added);
+	state.counters["free"] = free;
+}
+
+BENCHMARK_REGISTER_F(ContainerBenchmark, FillToCapacity)->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
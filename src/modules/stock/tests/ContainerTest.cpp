@@ -15,11 +15,12 @@ TEST_F(ContainerTest, testAddAndRemove) {
 	ContainerShape shape;
 	EXPECT_TRUE(shape.addRect(0, 1, 1, 1));
 	c.init(shape);
-	EXPECT_FALSE(c.add(_item1, 0, 0));
-	EXPECT_TRUE(c.add(_item1, 0, 1));
+	EXPECT_FALSE(c.add(_item1, 0, 1)) << "item1 is two rows high and doesn't fit into a single cell";
+	EXPECT_FALSE(c.add(_item2, 0, 0));
+	EXPECT_TRUE(c.add(_item2, 0, 1));
 	EXPECT_FALSE(c.add(_item2, 0, 0));
 	EXPECT_FALSE(c.add(_item2, 0, 1));
-	EXPECT_EQ(_item1, c.remove(0, 1));
+	EXPECT_EQ(_item2, c.remove(0, 1));
 	EXPECT_EQ(1, c.free());
 	EXPECT_TRUE(c.add(_item2, 0, 1));
 	EXPECT_EQ(1, c.size());
@@ -53,4 +54,42 @@ TEST_F(ContainerTest, testUnique) {
 	EXPECT_FALSE(c.add(_item2, 0, 1));
 }
 
+TEST_F(ContainerTest, testAutoPlacement) {
+	ContainerShape shape;
+	EXPECT_TRUE(shape.addRect(0, 0, 4, 2));
+	Container c;
+	c.init(shape);
+	// item1 is one column wide and two rows high
+	for (int i = 0; i < 4; ++i) {
+		EXPECT_TRUE(c.add(_item1)) << "Failed to add item " << i;
+	}
+	EXPECT_EQ(0, c.free());
+	EXPECT_FALSE(c.add(_item2));
+	EXPECT_EQ(_item1, c.get(3, 1));
+	c.clear();
+	EXPECT_EQ(8, c.free());
+	EXPECT_EQ(nullptr, c.get(3, 1));
+	EXPECT_TRUE(c.add(_item2, 0, 0));
+	uint8_t x;
+	uint8_t y;
+	EXPECT_TRUE(c.findSpace(_item1, x, y));
+	EXPECT_EQ(1, x);
+	EXPECT_EQ(0, y);
+}
+
+TEST_F(ContainerTest, testBestFit) {
+	ContainerShape shape;
+	EXPECT_TRUE(shape.addRect(0, 0, 8, 2));
+	Container c;
+	c.init(shape, Container::BestFit);
+	EXPECT_TRUE(c.add(_item2, 2, 1));
+	EXPECT_TRUE(c.add(_item2, 4, 1));
+	uint8_t x;
+	uint8_t y;
+	// the gap between the two items touches three occupied cells or borders
+	EXPECT_TRUE(c.findSpace(_item2, x, y));
+	EXPECT_EQ(3, x);
+	EXPECT_EQ(1, y);
+}
+
 }
@@ -283,6 +283,11 @@ extern bool setupRenderBuffer(TextureFormat format, int w, int h, int samples);
 extern Id bindRenderbuffer(Id handle);
 extern void bufferData(Id handle, BufferType type, BufferMode mode, const void* data, size_t size);
 extern void bufferSubData(Id handle, BufferType type, intptr_t offset, const void* data, size_t size);
+/**
+ * @brief Copies the given range of the source buffer into the target buffer on the gpu
+ * @note The ranges must not overlap if source and target are the same buffer
+ */
+extern void copyBufferSubData(Id source, Id target, intptr_t sourceOffset, intptr_t targetOffset, size_t size);
 /**
  * @return The size of the buffer object, measured in bytes.
  */
@@ -341,6 +346,10 @@ inline void drawElementsBaseVertex(Primitive mode, size_t numIndices, int baseIn
 	drawElementsBaseVertex(mode, numIndices, mapType<IndexType>(), sizeof(IndexType), baseIndex, baseVertex);
 }
 
+inline void drawElementsBaseVertex(Primitive mode, size_t numIndices, size_t indexSize, int baseIndex, int baseVertex) {
+	drawElementsBaseVertex(mode, numIndices, mapIndexTypeBySize(indexSize), indexSize, baseIndex, baseVertex);
+}
+
 inline bool hasFeature(Feature feature) {
 	return renderState().supports(feature);
 }
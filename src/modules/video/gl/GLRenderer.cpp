@@ -1232,6 +1232,25 @@ void bufferSubData(Id handle, BufferType type, intptr_t offset, const void* data
 	}
 }
 
+void copyBufferSubData(Id source, Id target, intptr_t sourceOffset, intptr_t targetOffset, size_t size) {
+	video_trace_scoped(CopyBufferSubData);
+	if (size == 0) {
+		return;
+	}
+	if (hasFeature(Feature::DirectStateAccess)) {
+		glCopyNamedBufferSubData((GLuint)source, (GLuint)target, (GLintptr)sourceOffset, (GLintptr)targetOffset, (GLsizeiptr)size);
+		checkError();
+		return;
+	}
+	// the copy targets are not part of the cached buffer bindings
+	glBindBuffer(GL_COPY_READ_BUFFER, (GLuint)source);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, (GLuint)target);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)sourceOffset, (GLintptr)targetOffset, (GLsizeiptr)size);
+	checkError();
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
 //TODO: use FrameBufferConfig
 void setupDepthCompareTexture(TextureType type, CompareFunc func, TextureCompareMode mode) {
 	video_trace_scoped(SetupDepthCompareTexture);
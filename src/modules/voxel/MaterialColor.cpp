@@ -7,6 +7,7 @@
 #include "core/Enum.h"
 #include "math/Random.h"
 #include "core/Color.h"
+#include "core/PaletteQuantizer.h"
 #include "core/GLM.h"
 #include "core/io/Filesystem.h"
 #include "core/StringUtil.h"
@@ -22,6 +23,7 @@ namespace voxel {
 class MaterialColor {
 private:
 	MaterialColorArray _materialColors;
+	core::PaletteQuantizer _quantizer;
 	core::Map<VoxelType, MaterialColorIndices, 8, EnumClassHash> _colorMapping;
 	bool _initialized = false;
 	bool _dirty = false;
@@ -52,6 +54,7 @@ public:
 			++paletteData;
 		}
 		Log::info("Set up %i material colors", (int)_materialColors.size());
+		_quantizer.setPalette(_materialColors);
 
 		if (_materialColors.size() != colors) {
 			return false;
@@ -144,6 +147,7 @@ public:
 
 	void shutdown() {
 		_materialColors.clear();
+		_quantizer.setPalette(_materialColors);
 		_colorMapping.clear();
 		_initialized = false;
 		_dirty = false;
@@ -163,6 +167,11 @@ public:
 		return _materialColors;
 	}
 
+	inline const core::PaletteQuantizer& getQuantizer() const {
+		core_assert_msg(_initialized, "Material colors are not yet initialized");
+		return _quantizer;
+	}
+
 	inline const MaterialColorIndices& getColorIndices(VoxelType type) const {
 		auto i = _colorMapping.find(type);
 		if (i == _colorMapping.end()) {
@@ -309,6 +318,10 @@ const MaterialColorArray& getMaterialColors() {
 	return getInstance().getColors();
 }
 
+const core::PaletteQuantizer& getMaterialColorQuantizer() {
+	return getInstance().getQuantizer();
+}
+
 const glm::vec4& getMaterialColor(const Voxel& voxel) {
 	return getMaterialColors()[voxel.getColor()];
 }
@@ -16,6 +16,10 @@ namespace math {
 class Random;
 }
 
+namespace core {
+class PaletteQuantizer;
+}
+
 namespace voxel {
 
 // this size must match the color uniform size in the shader
@@ -35,6 +39,11 @@ extern void materialColorMarkClean();
 extern bool materialColorChanged();
 extern const MaterialColorArray& getMaterialColors();
 extern const glm::vec4& getMaterialColor(const Voxel& voxel);
+/**
+ * @brief Maps colors onto the material colors - shared by all importers
+ * @see core::Color::getClosestMatch()
+ */
+extern const core::PaletteQuantizer& getMaterialColorQuantizer();
 
 extern bool createPalette(const image::ImagePtr& image, uint32_t *colorsBuffer, int colors);
 extern bool createPaletteFile(const image::ImagePtr& image, const char *paletteFile);
@@ -154,7 +154,7 @@ void PagedVolume::setVoxels(int32_t uXPos, int32_t uYPos, int32_t uZPos, int nx,
 				const uint16_t yOffset = static_cast<uint16_t>(y & _chunkMask);
 
 				ChunkPtr chunkPtr = chunk(chunkX, chunkY, chunkZ);
-				const int32_t n = core_min(left, int32_t(chunkPtr->_sideLength));
+				const int32_t n = core_min(left, int32_t(chunkPtr->_sideLength) - int32_t(yOffset));
 
 				chunkPtr->setVoxels(xOffset, yOffset, zOffset, array, n);
 				left -= n;
@@ -185,7 +185,7 @@ void PagedVolume::deleteOldestChunkIfNeeded() const {
 	ChunkMap::iterator oldestChunk = _chunks.end();
 	uint32_t oldestChunkTimestamp = _timestamper;
 	for (ChunkMap::iterator i = _chunks.begin(); i != _chunks.end(); ++i) {
-		const ChunkPtr& chunk = i->second;
+		const ChunkPtr& chunk = i->value;
 		if (chunk->_chunkLastAccessed < oldestChunkTimestamp) {
 			oldestChunkTimestamp = chunk->_chunkLastAccessed;
 			oldestChunk = i;
@@ -235,7 +235,7 @@ PagedVolume::ChunkPtr PagedVolume::chunk(int32_t chunkX, int32_t chunkY, int32_t
 		}
 		return chunk;
 	}
-	const ChunkPtr& chunk = i->second;
+	const ChunkPtr& chunk = i->value;
 	chunk->_chunkLastAccessed = ++_timestamper;
 	return chunk;
 }
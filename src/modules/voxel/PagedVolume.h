@@ -11,7 +11,7 @@
 #include "core/Assert.h"
 #include "core/concurrent/ReadWriteLock.h"
 #include "core/concurrent/Atomic.h"
-#include "core/collection/Map.h"
+#include "core/collection/HashMap.h"
 #include "core/SharedPtr.h"
 
 namespace voxel {
@@ -265,7 +265,7 @@ private:
 
 	uint32_t _chunkCountLimit = 0u;
 
-	typedef core::Map<glm::ivec3, ChunkPtr, 64, glm::hash<glm::ivec3>> ChunkMap;
+	typedef core::HashMap<glm::ivec3, ChunkPtr, glm::hash<glm::ivec3>> ChunkMap;
 	mutable ChunkMap _chunks;
 
 	// The size of the chunks
@@ -91,14 +91,15 @@ void PagedVolume::Chunk::setVoxels(uint32_t x, uint32_t z, const Voxel* values,
 void PagedVolume::Chunk::setVoxels(uint32_t x, uint32_t y, uint32_t z, const Voxel* values, int amount) {
 	// This code is not usually expected to be called by the user, with the exception of when implementing paging
 	// of uncompressed data. It's a performance critical code path
-	core_assert_msg(amount <= _sideLength, "Supplied amount exceeds chunk boundaries");
 	core_assert_msg(x < _sideLength, "Supplied x position is outside of the chunk");
 	core_assert_msg(y < _sideLength, "Supplied y position is outside of the chunk");
+	core_assert_msg((int)y + amount <= _sideLength, "Supplied amount exceeds chunk boundaries");
 	core_assert_msg(z < _sideLength, "Supplied z position is outside of the chunk");
 	core_assert_msg(_data, "No uncompressed data - chunk must be decompressed before accessing voxels.");
 
-	for (int i = y; i < amount; ++i) {
-		const uint32_t index = morton256_x[x] | morton256_y[i] | morton256_z[z];
+	const uint32_t xzIndex = morton256_x[x] | morton256_z[z];
+	for (int i = 0; i < amount; ++i) {
+		const uint32_t index = xzIndex | morton256_y[y + i];
 		_data[index] = values[i];
 	}
 	_dataModified = true;
@@ -88,8 +88,8 @@ bool PagedVolumeWrapper::setVoxels(int x, int y, int z, int nx, int nz, const Vo
 			const int fz = z + k;
 			int left = amount;
 			if (_validRegion.containsPoint(fx, y, fz)) {
-				// first part goes into the chunk
-				const int h = _validRegion.getHeightInVoxels();
+				// first part goes into the chunk - up to the upper boundary of the chunk
+				const int h = _validRegion.getUpperY() - y + 1;
 				_chunk->setVoxels(fx - _validRegion.getLowerX(), y - _validRegion.getLowerY(), fz - _validRegion.getLowerZ(), voxels, core_min(h, left));
 				left -= h;
 				if (left > 0) {
@@ -133,6 +133,12 @@ bool RawVolume::setVoxel(const glm::ivec3& pos, const Voxel& voxel) {
 	return true;
 }
 
+void RawVolume::accumulateBounds(const glm::ivec3& mins, const glm::ivec3& maxs) {
+	_mins = (glm::min)(_mins, mins);
+	_maxs = (glm::max)(_maxs, maxs);
+	_boundsValid = true;
+}
+
 /**
  * This function should probably be made internal...
  */
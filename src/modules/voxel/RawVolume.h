@@ -7,6 +7,7 @@
 #include "Voxel.h"
 #include "Region.h"
 #include "core/NonCopyable.h"
+#include "core/Assert.h"
 #include <glm/vec3.hpp>
 
 namespace voxel {
@@ -144,6 +145,21 @@ public:
 		return (const uint8_t*)_data;
 	}
 
+	/**
+	 * @brief Direct access to the voxel data for span based operations. The voxels along the x axis are
+	 * consecutive in memory - the row ends at the upper x of the region.
+	 * @note The position must be inside the region of the volume
+	 * @note Modifying the voxels via this pointer doesn't update the bounds - see @c accumulateBounds()
+	 */
+	inline Voxel* voxelRow(int32_t x, int32_t y, int32_t z);
+	inline const Voxel* voxelRow(int32_t x, int32_t y, int32_t z) const;
+
+	/**
+	 * @brief Extends the bounds of the modified voxels - needed after modifying the voxels via @c voxelRow()
+	 * @sa mins(), maxs()
+	 */
+	void accumulateBounds(const glm::ivec3& mins, const glm::ivec3& maxs);
+
 	/**
 	 * @brief Shift the region of the volume by the given coordinates
 	 */
@@ -210,6 +226,18 @@ inline int32_t RawVolume::depth() const {
 	return _region.getDepthInVoxels();
 }
 
+inline const Voxel* RawVolume::voxelRow(int32_t x, int32_t y, int32_t z) const {
+	core_assert(_region.containsPoint(x, y, z));
+	const glm::ivec3& lowerCorner = _region.getLowerCorner();
+	return _data + (x - lowerCorner.x) + (y - lowerCorner.y) * width() + (z - lowerCorner.z) * width() * height();
+}
+
+inline Voxel* RawVolume::voxelRow(int32_t x, int32_t y, int32_t z) {
+	core_assert(_region.containsPoint(x, y, z));
+	const glm::ivec3& lowerCorner = _region.getLowerCorner();
+	return _data + (x - lowerCorner.x) + (y - lowerCorner.y) * width() + (z - lowerCorner.z) * width() * height();
+}
+
 inline glm::ivec3 RawVolume::mins() const {
 	if (!_boundsValid) {
 		return _region.getLowerCorner();
@@ -63,6 +63,29 @@ TEST_F(PolyVoxTest, testChunkPos) {
 	EXPECT_EQ(_volData.chunkPos(length, length, length), glm::ivec3(1, 1, 1));
 }
 
+TEST_F(PolyVoxTest, testSetVoxelsWithYOffset) {
+	// the column starts inside of the chunk of the wrapper and continues in the chunk above
+	Voxel voxels[100];
+	for (int i = 0; i < lengthof(voxels); ++i) {
+		voxels[i] = createVoxel(i % 2 == 0 ? VoxelType::Rock : VoxelType::Dirt, 0);
+	}
+	const int startY = 10;
+	ASSERT_TRUE(_ctx.setVoxels(5, startY, 5, voxels, lengthof(voxels)));
+	for (int y = 0; y < startY; ++y) {
+		ASSERT_EQ(VoxelType::Air, _volData.voxel(5, y, 5).getMaterial()) << "Unexpected voxel at y " << y;
+	}
+	for (int i = 0; i < lengthof(voxels); ++i) {
+		ASSERT_EQ(voxels[i].getMaterial(), _volData.voxel(5, startY + i, 5).getMaterial()) << "Wrong voxel at y " << startY + i;
+	}
+	ASSERT_EQ(VoxelType::Air, _volData.voxel(5, startY + lengthof(voxels), 5).getMaterial());
+
+	// the paged volume must respect the offset inside of the chunks, too
+	_volData.setVoxels(6, startY, 6, 1, 1, voxels, lengthof(voxels));
+	for (int i = 0; i < lengthof(voxels); ++i) {
+		ASSERT_EQ(voxels[i].getMaterial(), _volData.voxel(6, startY + i, 6).getMaterial()) << "Wrong voxel at y " << startY + i;
+	}
+}
+
 TEST_F(PolyVoxTest, testSamplerPeekWithMovingX) {
 	PagedVolume::Sampler sampler(&_volData);
 	sampler.setPosition(0, 1, 1);
@@ -43,8 +43,6 @@ bool CubFormat::loadGroups(const io::FilePtr& file, VoxelVolumes& volumes) {
 
 	// TODO: support loading own palette
 
-	const MaterialColorArray& materialColors = getMaterialColors();
-
 	for (uint32_t h = 0u; h < height; ++h) {
 		for (uint32_t d = 0u; d < depth; ++d) {
 			for (uint32_t w = 0u; w < width; ++w) {
@@ -57,7 +55,7 @@ bool CubFormat::loadGroups(const io::FilePtr& file, VoxelVolumes& volumes) {
 					continue;
 				}
 				const glm::vec4& color = core::Color::fromRGBA(r, g, b, 255);
-				const int index = core::Color::getClosestMatch(color, materialColors);
+				const int index = findClosestIndex(color);
 				const voxel::Voxel& voxel = voxel::createVoxel(voxel::VoxelType::Generic, index);
 				// we have to flip depth with height for our own coordinate system
 				volume->setVoxel(w, h, d, voxel);
@@ -79,7 +79,6 @@ bool KV6Format::loadGroups(const io::FilePtr& file, VoxelVolumes& volumes) {
 			if (palMagic == FourCC('S','P','a','l')) {
 				_paletteSize = 256;
 				_palette.resize(_paletteSize);
-				const MaterialColorArray& materialColors = getMaterialColors();
 				for (size_t i = 0; i < _paletteSize; ++i) {
 					uint8_t r, g, b;
 					wrap(stream.readByte(b))
@@ -91,7 +90,7 @@ bool KV6Format::loadGroups(const io::FilePtr& file, VoxelVolumes& volumes) {
 					const uint8_t nb = glm::clamp((uint32_t)glm::round((b * 255) / 63.0f), 0u, 255u);
 
 					const glm::vec4& color = core::Color::fromRGBA(nr, ng, nb, 255);
-					const int index = core::Color::getClosestMatch(color, materialColors);
+					const int index = findClosestIndex(color);
 					_palette[i] = index;
 				}
 			}
@@ -4,6 +4,7 @@
 
 #include "MeshCache.h"
 #include "core/GLM.h"
+#include "core/GameConfig.h"
 #include "core/StringUtil.h"
 #include "voxelformat/Loader.h"
 #include "voxelformat/VoxFileFormat.h"
@@ -15,25 +16,70 @@
 
 namespace voxelformat {
 
+MeshCache::MeshCache(size_t threads) :
+		_threadPool(core_max((size_t)1u, threads), "MeshCache") {
+}
+
 MeshCache::~MeshCache() {
 	core_assert_msg(_initCalls == 0, "MeshCache wasn't shut down properly: %i", _initCalls);
 }
 
-voxel::Mesh& MeshCache::cacheEntry(const char *fullPath) {
+MeshCache::Entry& MeshCache::cacheEntry(const char *fullPath) {
 	auto i = _meshes.find(fullPath);
 	if (i == _meshes.end()) {
-		voxel::Mesh* mesh = new voxel::Mesh();
-		_meshes.put(fullPath, mesh);
+		Entry* entry = new Entry();
+		_meshes.put(fullPath, entry);
 		Log::debug("New mesh cache entry for path %s", fullPath);
-		return *mesh;
+		return *entry;
 	}
 	return *i->second;
 }
 
+void MeshCache::touch(Entry& entry) {
+	if (entry.inLRU) {
+		_lru.splice(_lru.end(), _lru, entry.lru);
+	}
+}
+
+void MeshCache::setLoaded(const char *fullPath, Entry& entry, voxel::Mesh* mesh) {
+	_memoryUsage -= entry.bytes;
+	delete entry.mesh;
+	entry.mesh = mesh;
+	if (mesh == nullptr) {
+		entry.state = State::Failed;
+		entry.bytes = 0u;
+		if (entry.inLRU) {
+			_lru.erase(entry.lru);
+			entry.inLRU = false;
+		}
+		return;
+	}
+	entry.state = State::Loaded;
+	entry.bytes = mesh->size();
+	_memoryUsage += entry.bytes;
+	if (entry.inLRU) {
+		touch(entry);
+	} else {
+		entry.lru = _lru.insert(_lru.end(), fullPath);
+		entry.inLRU = true;
+	}
+}
+
+void MeshCache::deleteEntry(Entry* entry) {
+	_memoryUsage -= entry->bytes;
+	if (entry->inLRU) {
+		_lru.erase(entry->lru);
+	}
+	delete entry->mesh;
+	delete entry;
+}
+
 bool MeshCache::removeMesh(const char *fullPath) {
+	core::ScopedLock lock(_mutex);
 	auto i = _meshes.find(fullPath);
 	if (i != _meshes.end()) {
-		delete i->second;
+		// a background load that is still running is dropped in update()
+		deleteEntry(i->second);
 		_meshes.erase(i);
 		return true;
 	}
@@ -41,27 +87,201 @@ bool MeshCache::removeMesh(const char *fullPath) {
 }
 
 const voxel::Mesh* MeshCache::getMesh(const char *fullPath) {
-	voxel::Mesh &cachedMesh = cacheEntry(fullPath);
-	if (cachedMesh.getNoOfVertices() > 0) {
-		return &cachedMesh;
+	{
+		core::ScopedLock lock(_mutex);
+		Entry& entry = cacheEntry(fullPath);
+		touch(entry);
+		if (entry.state == State::Loaded) {
+			return entry.mesh;
+		}
+	}
+	// not loaded, failed before or still loading in the background - the caller needs the mesh now. The
+	// lock is not held while loading - the entry might have been changed or removed in the meantime.
+	voxel::Mesh* mesh = new voxel::Mesh();
+	if (!loadMesh(findFile(fullPath), fullPath, *mesh)) {
+		delete mesh;
+		mesh = nullptr;
 	}
-	if (loadMesh(fullPath, cachedMesh)) {
-		return &cachedMesh;
+	core::ScopedLock lock(_mutex);
+	Entry& entry = cacheEntry(fullPath);
+	if (entry.state == State::Loaded) {
+		// another thread was faster
+		delete mesh;
+		return entry.mesh;
 	}
+	if (mesh == nullptr) {
+		if (entry.state != State::Loading) {
+			setLoaded(fullPath, entry, nullptr);
+		}
+		return nullptr;
+	}
+	setLoaded(fullPath, entry, mesh);
+	return mesh;
+}
+
+const voxel::Mesh* MeshCache::requestMesh(const char *fullPath, const ReadyCallback& callback) {
+	core::ScopedLock lock(_mutex);
+	Entry& entry = cacheEntry(fullPath);
+	touch(entry);
+	switch (entry.state) {
+	case State::Loaded:
+		return entry.mesh;
+	case State::Failed:
+		return nullptr;
+	case State::Loading:
+		if (callback) {
+			entry.callbacks.push_back(callback);
+		}
+		return nullptr;
+	case State::Unknown:
+		break;
+	}
+	if (_initCalls <= 0) {
+		Log::error("MeshCache is not initialized - can't load %s", fullPath);
+		return nullptr;
+	}
+	entry.state = State::Loading;
+	if (callback) {
+		entry.callbacks.push_back(callback);
+	}
+	const core::String path(fullPath);
+	// opening the files that don't exist sets the sdl error - the error buffers of the pool threads are never freed
+	const io::FilePtr& file = findFile(fullPath);
+	if (!file) {
+		_results.push_back(Result{path, nullptr});
+		return nullptr;
+	}
+	_threadPool.schedule([this, path, file] () {
+		voxel::Mesh* mesh = new voxel::Mesh();
+		if (!loadMesh(file, path.c_str(), *mesh)) {
+			delete mesh;
+			mesh = nullptr;
+		}
+		core::ScopedLock lock(_mutex);
+		_results.push_back(Result{path, mesh});
+	});
 	return nullptr;
 }
 
-bool MeshCache::loadMesh(const char* fullPath, voxel::Mesh& mesh) {
-	Log::debug("Loading volume from %s", fullPath);
-	const io::FilesystemPtr& fs = io::filesystem();
-	io::FilePtr file;
+MeshCache::State MeshCache::state(const char *fullPath) const {
+	core::ScopedLock lock(_mutex);
+	auto i = _meshes.find(fullPath);
+	if (i == _meshes.end()) {
+		return State::Unknown;
+	}
+	return i->second->state;
+}
 
+void MeshCache::update() {
+	core_trace_scoped(MeshCacheUpdate);
+	if (_memoryBudgetVar && _memoryBudgetVar->isDirty()) {
+		setMemoryBudget((size_t)core_max(0, _memoryBudgetVar->intVal()) * 1024u);
+		_memoryBudgetVar->markClean();
+	}
+
+	struct Ready {
+		core::String fullPath;
+		const voxel::Mesh* mesh;
+		std::vector<ReadyCallback> callbacks;
+	};
+	std::vector<Ready> ready;
+	{
+		core::ScopedLock lock(_mutex);
+		for (Result& result : _results) {
+			auto i = _meshes.find(result.fullPath);
+			if (i == _meshes.end()) {
+				// removed while it was loading
+				delete result.mesh;
+				continue;
+			}
+			Entry& entry = *i->second;
+			if (entry.state == State::Loading) {
+				setLoaded(result.fullPath.c_str(), entry, result.mesh);
+			} else {
+				// getMesh() was faster
+				delete result.mesh;
+			}
+			if (!entry.callbacks.empty()) {
+				ready.push_back(Ready{result.fullPath, entry.mesh, std::move(entry.callbacks)});
+				entry.callbacks.clear();
+				entry.pinned = true;
+			}
+		}
+		_results.clear();
+		evict();
+		for (const Ready& r : ready) {
+			auto i = _meshes.find(r.fullPath);
+			if (i != _meshes.end()) {
+				i->second->pinned = false;
+			}
+		}
+	}
+
+	// without the lock - the callbacks may request other meshes
+	for (const Ready& r : ready) {
+		for (const ReadyCallback& callback : r.callbacks) {
+			callback(r.fullPath.c_str(), r.mesh);
+		}
+	}
+}
+
+void MeshCache::evict() {
+	if (_memoryBudget == 0u) {
+		return;
+	}
+	for (auto lru = _lru.begin(); lru != _lru.end() && _memoryUsage > _memoryBudget;) {
+		auto i = _meshes.find(*lru);
+		core_assert(i != _meshes.end());
+		Entry* entry = i->second;
+		if (entry->pinned) {
+			++lru;
+			continue;
+		}
+		Log::debug("Evict mesh %s from the cache (%i bytes)", lru->c_str(), (int)entry->bytes);
+		// deleting the entry removes it from the lru list
+		++lru;
+		deleteEntry(entry);
+		_meshes.erase(i);
+	}
+}
+
+void MeshCache::setMemoryBudget(size_t bytes) {
+	core::ScopedLock lock(_mutex);
+	_memoryBudget = bytes;
+}
+
+size_t MeshCache::memoryBudget() const {
+	core::ScopedLock lock(_mutex);
+	return _memoryBudget;
+}
+
+size_t MeshCache::memoryUsage() const {
+	core::ScopedLock lock(_mutex);
+	return _memoryUsage;
+}
+
+size_t MeshCache::size() const {
+	core::ScopedLock lock(_mutex);
+	return _meshes.size();
+}
+
+io::FilePtr MeshCache::findFile(const char* fullPath) const {
+	const io::FilesystemPtr& fs = io::filesystem();
 	for (const char **ext = SUPPORTED_VOXEL_FORMATS_LOAD_LIST; *ext; ++ext) {
-		file = fs->open(core::string::format("%s.%s", fullPath, *ext));
+		const io::FilePtr& file = fs->open(core::string::format("%s.%s", fullPath, *ext));
 		if (file->exists()) {
-			break;
+			return file;
 		}
 	}
+	Log::error("Failed to find a supported model for %s", fullPath);
+	return io::FilePtr();
+}
+
+bool MeshCache::loadMesh(const io::FilePtr& file, const char* fullPath, voxel::Mesh& mesh) const {
+	if (!file) {
+		return false;
+	}
+	Log::debug("Loading volume from %s", file->name().c_str());
 	voxel::VoxelVolumes volumes;
 	if (!voxelformat::loadVolumeFormat(file, volumes)) {
 		Log::error("Failed to load %s", file->name().c_str());
@@ -88,6 +308,14 @@ bool MeshCache::loadMesh(const char* fullPath, voxel::Mesh& mesh) {
 
 bool MeshCache::init() {
 	++_initCalls;
+	if (_initCalls == 1) {
+		_memoryBudgetVar = core::Var::get(cfg::VoxformatMeshCacheBudget, "0", -1, "The memory budget of the mesh cache in kilobytes - 0 is unlimited");
+		if (_memoryBudgetVar->intVal() > 0) {
+			setMemoryBudget((size_t)_memoryBudgetVar->intVal() * 1024u);
+		}
+		_memoryBudgetVar->markClean();
+		_threadPool.init();
+	}
 	return true;
 }
 
@@ -99,10 +327,20 @@ void MeshCache::shutdown() {
 	if (_initCalls > 0) {
 		return;
 	}
+	// the pending requests are dropped
+	_threadPool.shutdown();
+	_memoryBudgetVar = core::VarPtr();
+	core::ScopedLock lock(_mutex);
+	for (const Result& result : _results) {
+		delete result.mesh;
+	}
+	_results.clear();
 	for (const auto & e : _meshes) {
-		delete e->value;
+		deleteEntry(e->value);
 	}
 	_meshes.clear();
+	_lru.clear();
+	_memoryUsage = 0u;
 }
 
 }
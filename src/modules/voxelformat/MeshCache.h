@@ -7,25 +7,126 @@
 #include "voxel/Mesh.h"
 #include "core/IComponent.h"
 #include "core/StringUtil.h"
+#include "core/Var.h"
 #include "core/collection/StringMap.h"
+#include "core/io/File.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ThreadPool.h"
+#include "core/Trace.h"
+#include <functional>
+#include <list>
 #include <memory>
+#include <vector>
 
 namespace voxelformat {
 
 /**
  * @brief Cache @c voxel::Mesh instances by their name
+ *
+ * @c getMesh() loads the volume and extracts the mesh on the calling thread. @c requestMesh() does the
+ * same on a thread pool - the result is handed out in @c update(), either to the given callback or by
+ * polling @c requestMesh() or @c state(). Requests for a path that is already loading are merged.
+ *
+ * If a memory budget is set, @c update() evicts the least recently used meshes until the cache fits
+ * into the budget again. The mesh pointers that were handed out stay valid until the next @c update() -
+ * users that keep the pointers longer must not call @c update() or set a budget. The meshes that are
+ * handed out to the callbacks are not evicted in the same @c update() - so the cache might exceed the
+ * budget until the next one.
  */
 class MeshCache : public core::IComponent {
+public:
+	enum class State {
+		Unknown, Loading, Loaded, Failed
+	};
+	/**
+	 * @brief Called from @c update() once the mesh was loaded - the mesh is @c nullptr if loading failed
+	 */
+	using ReadyCallback = std::function<void(const char *fullPath, const voxel::Mesh* mesh)>;
 protected:
-	core::StringMap<voxel::Mesh*> _meshes;
+	using LRUList = std::list<core::String>;
+	struct Entry {
+		voxel::Mesh* mesh = nullptr;
+		State state = State::Unknown;
+		size_t bytes = 0u;
+		std::vector<ReadyCallback> callbacks;
+		// position in the lru list - only loaded meshes are part of it
+		LRUList::iterator lru;
+		bool inLRU = false;
+		// handed out to the callbacks in this update() - not evicted before the next one
+		bool pinned = false;
+	};
+	struct Result {
+		core::String fullPath;
+		voxel::Mesh* mesh;
+	};
+	core::StringMap<Entry*> _meshes;
+	// the meshes that were extracted in the background but are not yet handed over to the cache
+	std::vector<Result> _results;
+	core_trace_mutex(core::Lock, _mutex, "MeshCache");
+	core::ThreadPool _threadPool;
+	core::VarPtr _memoryBudgetVar;
+	// 0 means unlimited
+	size_t _memoryBudget = 0u;
+	size_t _memoryUsage = 0u;
+	// the paths of the loaded meshes - the least recently used one first
+	LRUList _lru;
 	int _initCalls = 0;
 
-	voxel::Mesh& cacheEntry(const char *fullPath);
-	bool loadMesh(const char* fullPath, voxel::Mesh& mesh);
+	Entry& cacheEntry(const char *fullPath);
+	void touch(Entry& entry);
+	void setLoaded(const char *fullPath, Entry& entry, voxel::Mesh* mesh);
+	void deleteEntry(Entry* entry);
+	void evict();
+	/**
+	 * @brief Opens the model of the given path with the first supported extension
+	 * @note Must be called on the requesting thread - opening a file that doesn't exist sets the sdl error
+	 * @return An empty pointer if there is no such model
+	 */
+	io::FilePtr findFile(const char* fullPath) const;
+	bool loadMesh(const io::FilePtr& file, const char* fullPath, voxel::Mesh& mesh) const;
 public:
+	/**
+	 * @param[in] threads The amount of threads that load the meshes for @c requestMesh()
+	 */
+	MeshCache(size_t threads = 1u);
 	~MeshCache();
+	/**
+	 * @brief Loads the mesh on the calling thread if it isn't cached yet
+	 * @note The cache is not locked while the mesh is loaded - concurrent calls for the same path might load it
+	 * more than once
+	 */
 	const voxel::Mesh* getMesh(const char *fullPath);
+	/**
+	 * @brief Loads the mesh in the background if it isn't cached yet
+	 * @param[in] callback Optional callback that is executed in @c update() once the mesh is available. If
+	 * the mesh is already cached, the callback is not called.
+	 * @return The mesh if it's already cached or @c nullptr if it's loading or failed to load.
+	 */
+	const voxel::Mesh* requestMesh(const char *fullPath, const ReadyCallback& callback = ReadyCallback());
+	State state(const char *fullPath) const;
 	bool removeMesh(const char *fullPath);
+
+	/**
+	 * @brief Hands the background loaded meshes over to the cache, executes the callbacks and evicts
+	 * meshes if the memory budget is exceeded.
+	 */
+	void update();
+
+	/**
+	 * @param[in] bytes The memory that the cached meshes may use - @c 0 means unlimited.
+	 * The budget is applied in the next @c update().
+	 */
+	void setMemoryBudget(size_t bytes);
+	size_t memoryBudget() const;
+	/**
+	 * @return The memory of the loaded meshes
+	 */
+	size_t memoryUsage() const;
+	/**
+	 * @return The amount of cache entries - this includes the meshes that are loading or failed to load
+	 */
+	size_t size() const;
+
 	bool init() override;
 	void shutdown() override;
 };
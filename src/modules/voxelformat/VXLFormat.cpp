@@ -362,11 +362,10 @@ bool VXLFormat::readHeader(io::FileStream& stream, vxl_mdl& mdl) {
 
 	if (valid) {
 		// convert to our palette
-		const MaterialColorArray& materialColors = getMaterialColors();
 		for (uint32_t i = 0; i < _paletteSize; ++i) {
 			const uint8_t *p = hdr.palette[i];
 			const glm::vec4& color = core::Color::fromRGBA(p[0], p[1], p[2], 0xff);
-			const int index = core::Color::getClosestMatch(color, materialColors);
+			const int index = findClosestIndex(color);
 			_palette[i] = index;
 		}
 	} else {
@@ -7,7 +7,7 @@
 #include "Loader.h"
 #include "core/Common.h"
 #include "core/Log.h"
-#include "core/Color.h"
+#include "core/PaletteQuantizer.h"
 #include <limits>
 
 namespace voxel {
@@ -31,9 +31,7 @@ glm::vec4 VoxFileFormat::findClosestMatch(const glm::vec4& color) const {
 }
 
 uint8_t VoxFileFormat::findClosestIndex(const glm::vec4& color) const {
-	const voxel::MaterialColorArray& materialColors = voxel::getMaterialColors();
-	//materialColors.erase(materialColors.begin());
-	return core::Color::getClosestMatch(color, materialColors);
+	return voxel::getMaterialColorQuantizer().getClosestMatch(color);
 }
 
 RawVolume* VoxFileFormat::merge(const VoxelVolumes& volumes) const {
@@ -387,11 +387,10 @@ void VoxFormat::initPalette() {
 	_palette.resize(paletteSize);
 	_paletteSize = paletteSize;
 	// convert to our palette
-	const MaterialColorArray& materialColors = getMaterialColors();
 	for (int i = 0; i < paletteSize; ++i) {
 		const uint32_t p = palette[i];
 		const glm::vec4& color = core::Color::fromRGBA(p);
-		const int index = core::Color::getClosestMatch(color, materialColors);
+		const int index = findClosestIndex(color);
 		_palette[i] = index;
 	}
 }
@@ -435,7 +434,7 @@ bool VoxFormat::loadChunk_RGBA(io::FileStream& stream, const ChunkHeader& header
 		uint32_t rgba;
 		wrap(stream.readInt(rgba))
 		const glm::vec4& color = core::Color::fromRGBA(rgba);
-		const int index = core::Color::getClosestMatch(color, materialColors);
+		const int index = findClosestIndex(color);
 		Log::trace("rgba %x, r: %f, g: %f, b: %f, a: %f, index: %i, r2: %f, g2: %f, b2: %f, a2: %f",
 				rgba, color.r, color.g, color.b, color.a, index, materialColors[index].r, materialColors[index].g, materialColors[index].b, materialColors[index].a);
 		_palette[i + 1] = (uint8_t)index;
@@ -0,0 +1,172 @@
+/**
+ * @file
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "core/io/FileStream.h"
+#include "core/io/Filesystem.h"
+#include "voxel/MaterialColor.h"
+#include "voxel/RawVolume.h"
+#include "voxelformat/BinVoxFormat.h"
+#include "voxelformat/CubFormat.h"
+#include "voxelformat/KV6Format.h"
+#include "voxelformat/KVXFormat.h"
+#include "voxelformat/QBFormat.h"
+#include "voxelformat/QBTFormat.h"
+#include "voxelformat/VoxFormat.h"
+#include "voxelformat/VXLFormat.h"
+#include "voxelformat/VXMFormat.h"
+#include <glm/geometric.hpp>
+#include <memory>
+#include <stdio.h>
+
+namespace {
+
+// edge length of the generated volumes for the formats that can be saved
+static constexpr int VolumeSize = 64;
+
+/**
+ * @return The amount of read syscalls of this process or @c -1 if not supported
+ */
+int64_t readSyscalls() {
+#ifdef __linux__
+	FILE *f = fopen("/proc/self/io", "r");
+	if (f == nullptr) {
+		return -1;
+	}
+	char line[128];
+	long long syscr = -1;
+	while (fgets(line, sizeof(line), f) != nullptr) {
+		if (sscanf(line, "syscr: %lld", &syscr) == 1) {
+			break;
+		}
+	}
+	fclose(f);
+	return (int64_t)syscr;
+#else
+	return -1;
+#endif
+}
+
+}
+
+class VoxFormatBenchmark : public core::AbstractBenchmark {
+protected:
+	bool onInitApp() override {
+		return voxel::initDefaultMaterialColors();
+	}
+
+	void onCleanupApp() override {
+		io::FileStream::setDefaultReadBufferSize(io::FileStream::DefaultReadBufferSize);
+	}
+
+	/**
+	 * @brief Saves a sphere with the given format into the home path if the file doesn't exist yet
+	 */
+	core::String generate(voxel::VoxFileFormat& format, const char *extension) const {
+		const io::FilesystemPtr& fs = io::filesystem();
+		const core::String filename = core::String::format("%s/voxformatbenchmark-%i.%s", fs->homePath().c_str(), VolumeSize, extension);
+		if (fs->open(filename)->exists()) {
+			return filename;
+		}
+		voxel::RawVolume volume(voxel::Region(0, VolumeSize - 1));
+		const voxel::Region& region = volume.region();
+		const glm::vec3 center(region.getCenter());
+		const float radius = (float)VolumeSize / 2.0f;
+		for (int x = 0; x < VolumeSize; ++x) {
+			for (int y = 0; y < VolumeSize; ++y) {
+				for (int z = 0; z < VolumeSize; ++z) {
+					if (glm::length(glm::vec3(x, y, z) - center) <= radius) {
+						volume.setVoxel(x, y, z, voxel::createColorVoxel(voxel::VoxelType::Generic, (x + y + z) % 16));
+					}
+				}
+			}
+		}
+		if (!format.save(&volume, fs->open(filename, io::FileMode::Write))) {
+			return "";
+		}
+		return filename;
+	}
+
+	/**
+	 * @param state The first argument selects the read buffer of the streams - @c 0 is unbuffered
+	 */
+	void load(benchmark::State& state, voxel::VoxFileFormat& format, const core::String& filename) const {
+		if (filename.empty()) {
+			state.SkipWithError("Failed to generate the file");
+			return;
+		}
+		io::FileStream::setDefaultReadBufferSize(state.range(0) == 0 ? 0u : io::FileStream::DefaultReadBufferSize);
+		const int64_t syscallsStart = readSyscalls();
+		for (auto _ : state) {
+			std::unique_ptr<voxel::RawVolume> volume(format.load(io::filesystem()->open(filename)));
+			if (!volume) {
+				state.SkipWithError("Failed to load the file");
+				break;
+			}
+		}
+		const int64_t syscallsEnd = readSyscalls();
+		if (syscallsStart >= 0 && syscallsEnd >= 0 && state.iterations() > 0) {
+			state.counters["read_syscalls"] = (double)(syscallsEnd - syscallsStart) / (double)state.iterations();
+		}
+		io::FileStream::setDefaultReadBufferSize(io::FileStream::DefaultReadBufferSize);
+	}
+};
+
+BENCHMARK_DEFINE_F(VoxFormatBenchmark, Vox)(benchmark::State &state) {
+	voxel::VoxFormat f;
+	load(state, f, generate(f, "vox"));
+}
+
+BENCHMARK_DEFINE_F(VoxFormatBenchmark, QB)(benchmark::State &state) {
+	voxel::QBFormat f;
+	load(state, f, generate(f, "qb"));
+}
+
+BENCHMARK_DEFINE_F(VoxFormatBenchmark, QBT)(benchmark::State &state) {
+	voxel::QBTFormat f;
+	load(state, f, generate(f, "qbt"));
+}
+
+BENCHMARK_DEFINE_F(VoxFormatBenchmark, Cub)(benchmark::State &state) {
+	voxel::CubFormat f;
+	load(state, f, generate(f, "cub"));
+}
+
+BENCHMARK_DEFINE_F(VoxFormatBenchmark, VXL)(benchmark::State &state) {
+	voxel::VXLFormat f;
+	load(state, f, generate(f, "vxl"));
+}
+
+BENCHMARK_DEFINE_F(VoxFormatBenchmark, BinVox)(benchmark::State &state) {
+	voxel::BinVoxFormat f;
+	load(state, f, generate(f, "binvox"));
+}
+
+// there is no writer for these formats - the reference models of the tests are used
+BENCHMARK_DEFINE_F(VoxFormatBenchmark, KV6)(benchmark::State &state) {
+	voxel::KV6Format f;
+	load(state, f, "test.kv6");
+}
+
+BENCHMARK_DEFINE_F(VoxFormatBenchmark, KVX)(benchmark::State &state) {
+	voxel::KVXFormat f;
+	load(state, f, "test.kvx");
+}
+
+BENCHMARK_DEFINE_F(VoxFormatBenchmark, VXM)(benchmark::State &state) {
+	voxel::VXMFormat f;
+	load(state, f, "test.vxm");
+}
+
+BENCHMARK_REGISTER_F(VoxFormatBenchmark, Vox)->ArgName("buffered")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxFormatBenchmark, QB)->ArgName("buffered")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxFormatBenchmark, QBT)->ArgName("buffered")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxFormatBenchmark, Cub)->ArgName("buffered")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxFormatBenchmark, VXL)->ArgName("buffered")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxFormatBenchmark, BinVox)->ArgName("buffered")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxFormatBenchmark, KV6)->ArgName("buffered")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxFormatBenchmark, KVX)->ArgName("buffered")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxFormatBenchmark, VXM)->ArgName("buffered")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,248 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxFormatTest.h"
+#include "voxelformat/MeshCache.h"
+#include "voxelformat/QBFormat.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace voxelformat {
+
+class MeshCacheTest: public voxel::AbstractVoxFormatTest {
+protected:
+	class TestMeshCache : public MeshCache {
+	public:
+		using MeshCache::MeshCache;
+
+		size_t pendingResults() const {
+			core::ScopedLock lock(_mutex);
+			return _results.size();
+		}
+	};
+	TestMeshCache _cache { 4u };
+
+	/**
+	 * @brief Writes a single layer model with the given edge length - the path is given without extension
+	 */
+	void writeModel(const char *fullPath, int size) {
+		voxel::RawVolume volume(voxel::Region(0, size - 1));
+		for (int i = 0; i < size; ++i) {
+			volume.setVoxel(i, i, i, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		}
+		voxel::QBFormat f;
+		ASSERT_TRUE(f.save(&volume, open(core::string::format("%s.qb", fullPath), io::FileMode::Write)));
+	}
+
+	/**
+	 * @brief The cache only supports models with one layer - this one fails to load
+	 */
+	void writeMultipleLayerModel(const char *fullPath) {
+		voxel::RawVolume layer1(voxel::Region(0, 0));
+		voxel::RawVolume layer2(voxel::Region(0, 0));
+		layer1.setVoxel(0, 0, 0, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		layer2.setVoxel(0, 0, 0, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		voxel::VoxelVolumes volumes;
+		volumes.push_back(voxel::VoxelVolume(&layer1));
+		volumes.push_back(voxel::VoxelVolume(&layer2));
+		voxel::QBFormat f;
+		ASSERT_TRUE(f.saveGroups(volumes, open(core::string::format("%s.qb", fullPath), io::FileMode::Write)));
+	}
+
+public:
+	void SetUp() override {
+		voxel::AbstractVoxFormatTest::SetUp();
+		writeModel("meshcache-small", 4);
+		writeModel("meshcache-big", 16);
+		writeMultipleLayerModel("meshcache-layers");
+		ASSERT_TRUE(_cache.init());
+	}
+
+	void TearDown() override {
+		_cache.shutdown();
+		voxel::AbstractVoxFormatTest::TearDown();
+	}
+
+	/**
+	 * @brief Calls @c update() until the given mesh is no longer loading
+	 */
+	MeshCache::State waitForMesh(MeshCache& cache, const char *fullPath) {
+		for (int i = 0; i < 5000; ++i) {
+			cache.update();
+			const MeshCache::State state = cache.state(fullPath);
+			if (state != MeshCache::State::Loading) {
+				return state;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return MeshCache::State::Loading;
+	}
+};
+
+TEST_F(MeshCacheTest, testGetMesh) {
+	MeshCache& cache = _cache;
+	const voxel::Mesh* mesh = cache.getMesh("meshcache-small");
+	ASSERT_NE(nullptr, mesh);
+	EXPECT_GT(mesh->getNoOfVertices(), 0u);
+	EXPECT_EQ(mesh, cache.getMesh("meshcache-small"));
+	EXPECT_EQ(mesh, cache.requestMesh("meshcache-small"));
+	EXPECT_EQ(MeshCache::State::Loaded, cache.state("meshcache-small"));
+	EXPECT_GT(cache.memoryUsage(), 0u);
+	EXPECT_TRUE(cache.removeMesh("meshcache-small"));
+	EXPECT_EQ(0u, cache.memoryUsage());
+}
+
+TEST_F(MeshCacheTest, testRequestMesh) {
+	MeshCache& cache = _cache;
+	int called = 0;
+	const voxel::Mesh* readyMesh = nullptr;
+	EXPECT_EQ(nullptr, cache.requestMesh("meshcache-small", [&] (const char *fullPath, const voxel::Mesh* mesh) {
+		EXPECT_STREQ("meshcache-small", fullPath);
+		readyMesh = mesh;
+		++called;
+	}));
+	ASSERT_EQ(MeshCache::State::Loaded, waitForMesh(cache, "meshcache-small"));
+	EXPECT_EQ(1, called);
+	ASSERT_NE(nullptr, readyMesh);
+	EXPECT_EQ(readyMesh, cache.requestMesh("meshcache-small"));
+	EXPECT_EQ(readyMesh, cache.getMesh("meshcache-small"));
+}
+
+TEST_F(MeshCacheTest, testConcurrentRequestsForTheSamePath) {
+	TestMeshCache& cache = _cache;
+	const int threads = 8;
+	std::atomic_int called { 0 };
+	std::vector<std::thread> requests;
+	for (int i = 0; i < threads; ++i) {
+		requests.emplace_back([&] () {
+			cache.requestMesh("meshcache-small", [&] (const char *fullPath, const voxel::Mesh* mesh) {
+				EXPECT_NE(nullptr, mesh);
+				++called;
+			});
+		});
+	}
+	for (std::thread& t : requests) {
+		t.join();
+	}
+	EXPECT_EQ(1u, cache.size());
+	EXPECT_EQ(MeshCache::State::Loading, cache.state("meshcache-small"));
+	// the requests were merged - only one mesh is loaded
+	for (int i = 0; i < 5000 && cache.pendingResults() == 0u; ++i) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	EXPECT_EQ(1u, cache.pendingResults());
+	ASSERT_EQ(MeshCache::State::Loaded, waitForMesh(cache, "meshcache-small"));
+	EXPECT_EQ(threads, called.load());
+}
+
+TEST_F(MeshCacheTest, testRequestFailed) {
+	MeshCache& cache = _cache;
+	bool called = false;
+	cache.requestMesh("meshcache-layers", [&] (const char *fullPath, const voxel::Mesh* mesh) {
+		EXPECT_EQ(nullptr, mesh);
+		called = true;
+	});
+	EXPECT_EQ(MeshCache::State::Failed, waitForMesh(cache, "meshcache-layers"));
+	EXPECT_TRUE(called);
+	EXPECT_EQ(0u, cache.memoryUsage());
+}
+
+TEST_F(MeshCacheTest, testMissingModel) {
+	MeshCache& cache = _cache;
+	EXPECT_EQ(nullptr, cache.getMesh("meshcache-missing"));
+	EXPECT_EQ(MeshCache::State::Failed, cache.state("meshcache-missing"));
+	EXPECT_TRUE(cache.removeMesh("meshcache-missing"));
+	// the missing file is detected by the requesting thread - the callback is still executed in update()
+	bool called = false;
+	cache.requestMesh("meshcache-missing", [&] (const char *fullPath, const voxel::Mesh* mesh) {
+		EXPECT_EQ(nullptr, mesh);
+		called = true;
+	});
+	EXPECT_FALSE(called);
+	EXPECT_EQ(MeshCache::State::Failed, waitForMesh(cache, "meshcache-missing"));
+	EXPECT_TRUE(called);
+}
+
+TEST_F(MeshCacheTest, testRemoveWhileLoading) {
+	MeshCache& cache = _cache;
+	bool called = false;
+	cache.requestMesh("meshcache-small", [&] (const char *fullPath, const voxel::Mesh* mesh) {
+		called = true;
+	});
+	EXPECT_TRUE(cache.removeMesh("meshcache-small"));
+	EXPECT_EQ(MeshCache::State::Unknown, waitForMesh(cache, "meshcache-small"));
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	cache.update();
+	EXPECT_FALSE(called);
+	EXPECT_EQ(0u, cache.size());
+	EXPECT_EQ(0u, cache.memoryUsage());
+}
+
+TEST_F(MeshCacheTest, testEviction) {
+	MeshCache& cache = _cache;
+	ASSERT_NE(nullptr, cache.getMesh("meshcache-small"));
+	const size_t smallSize = cache.memoryUsage();
+	ASSERT_NE(nullptr, cache.getMesh("meshcache-big"));
+	const size_t bigSize = cache.memoryUsage() - smallSize;
+	ASSERT_GT(bigSize, 0u);
+	EXPECT_EQ(2u, cache.size());
+
+	// no eviction without a budget
+	cache.update();
+	EXPECT_EQ(2u, cache.size());
+
+	// the least recently used mesh is evicted
+	ASSERT_NE(nullptr, cache.getMesh("meshcache-small"));
+	cache.setMemoryBudget(smallSize + bigSize - 1u);
+	cache.update();
+	EXPECT_EQ(1u, cache.size());
+	EXPECT_EQ(MeshCache::State::Unknown, cache.state("meshcache-big"));
+	EXPECT_EQ(MeshCache::State::Loaded, cache.state("meshcache-small"));
+	EXPECT_EQ(smallSize, cache.memoryUsage());
+
+	// loading it again evicts the other one
+	ASSERT_NE(nullptr, cache.getMesh("meshcache-big"));
+	EXPECT_EQ(smallSize + bigSize, cache.memoryUsage());
+	cache.update();
+	EXPECT_EQ(1u, cache.size());
+	EXPECT_EQ(MeshCache::State::Unknown, cache.state("meshcache-small"));
+	EXPECT_EQ(bigSize, cache.memoryUsage());
+
+	// a budget below a single mesh evicts everything
+	cache.setMemoryBudget(1u);
+	cache.update();
+	EXPECT_EQ(0u, cache.size());
+	EXPECT_EQ(0u, cache.memoryUsage());
+}
+
+TEST_F(MeshCacheTest, testEvictionWithCallback) {
+	MeshCache& cache = _cache;
+	// a budget below a single mesh - but the mesh must stay valid for the callback
+	cache.setMemoryBudget(1u);
+	bool called = false;
+	size_t vertices = 0u;
+	MeshCache::State stateInCallback = MeshCache::State::Unknown;
+	cache.requestMesh("meshcache-small", [&] (const char *fullPath, const voxel::Mesh* mesh) {
+		ASSERT_NE(nullptr, mesh);
+		vertices = mesh->getNoOfVertices();
+		stateInCallback = cache.state(fullPath);
+		called = true;
+	});
+	for (int i = 0; i < 5000 && !called; ++i) {
+		cache.update();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	ASSERT_TRUE(called);
+	EXPECT_GT(vertices, 0u);
+	EXPECT_EQ(MeshCache::State::Loaded, stateInCallback);
+	// the mesh that was handed out survives the update() that called the callback
+	EXPECT_EQ(MeshCache::State::Loaded, cache.state("meshcache-small"));
+	cache.update();
+	EXPECT_EQ(MeshCache::State::Unknown, cache.state("meshcache-small"));
+	EXPECT_EQ(0u, cache.memoryUsage());
+}
+
+}
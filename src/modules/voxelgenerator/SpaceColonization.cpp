@@ -4,6 +4,7 @@
 
 #include "SpaceColonization.h"
 
+#include <algorithm>
 #include <functional>
 
 namespace voxelgenerator {
@@ -25,6 +26,45 @@ void Branch::reset() {
 	_growDirection = _originalGrowDirection;
 }
 
+static inline uint64_t branchOrder(size_t bucket, uint32_t sequence) {
+	// the map iterates the buckets in ascending order and the entries of a bucket in insertion order
+	return ((uint64_t)bucket << 32) | (uint64_t)sequence;
+}
+
+glm::ivec3 BranchGrid::cell(const glm::vec3& position) const {
+	return glm::ivec3(glm::floor(position / _cellSize));
+}
+
+void BranchGrid::init(float radius) {
+	clear();
+	_cellSize = core_max(1.0f, glm::ceil(radius));
+}
+
+void BranchGrid::clear() {
+	_cells.clear();
+	_size = 0u;
+}
+
+void BranchGrid::add(Branch* branch, uint64_t order) {
+	_cells[cell(branch->_position)].push_back(Entry{branch, order});
+	++_size;
+}
+
+void BranchGrid::query(const glm::vec3& position, std::vector<Entry>& entries) const {
+	const glm::ivec3& c = cell(position);
+	for (int x = c.x - 1; x <= c.x + 1; ++x) {
+		for (int y = c.y - 1; y <= c.y + 1; ++y) {
+			for (int z = c.z - 1; z <= c.z + 1; ++z) {
+				auto i = _cells.find(glm::ivec3(x, y, z));
+				if (i == _cells.end()) {
+					continue;
+				}
+				entries.insert(entries.end(), i->second.begin(), i->second.end());
+			}
+		}
+	}
+}
+
 SpaceColonization::SpaceColonization(const glm::ivec3& position, int branchLength,
 	int attractionPointWidth, int attractionPointHeight, int attractionPointDepth, float branchSize,
 	int seed, int minDistance, int maxDistance, int attractionPointCount) :
@@ -32,8 +72,12 @@ SpaceColonization::SpaceColonization(const glm::ivec3& position, int branchLengt
 		_attractionPointDepth(attractionPointDepth), _attractionPointHeight(attractionPointHeight),
 		_minDistance2(minDistance * minDistance), _maxDistance2(maxDistance * maxDistance),
 		_branchLength(branchLength), _branchSize(branchSize), _random(seed) {
+	// the distances are rounded before they are compared - the grid must cover the rounding, too
+	const int maxDistance2 = core_max(_minDistance2, _maxDistance2);
+	_branchGrid.init(glm::sqrt((float)maxDistance2 + 1.0f));
+
 	_root = new Branch(nullptr, _position, glm::up, _branchSize);
-	_branches.put(_root->_position, _root);
+	addBranch(_root);
 
 	fillAttractionPoints();
 }
@@ -44,9 +88,59 @@ SpaceColonization::~SpaceColonization() {
 	}
 	_root = nullptr;
 	_branches.clear();
+	_branchGrid.clear();
 	_attractionPoints.clear();
 }
 
+void SpaceColonization::addBranch(Branch* branch) {
+	const size_t bucket = glm::hash<glm::vec3>()(branch->_position) % BranchBuckets;
+	_branches.put(branch->_position, branch);
+	_branchGrid.add(branch, branchOrder(bucket, _branchSequence++));
+}
+
+void SpaceColonization::indexBranches() {
+	_branchGrid.clear();
+	_branchSequence = 0u;
+	for (auto e : _branches) {
+		// the key and not the branch position - the position might have been modified after the insertion
+		const size_t bucket = glm::hash<glm::vec3>()(e->key) % BranchBuckets;
+		_branchGrid.add(e->value, branchOrder(bucket, _branchSequence++));
+	}
+}
+
+bool SpaceColonization::closestBranch(AttractionPoint& attractionPoint, Branch* first) {
+	_candidates.clear();
+	_branchGrid.query(attractionPoint._position, _candidates);
+
+	// only keep the branches in range - and stop if the attraction point was reached by a branch
+	size_t n = 0u;
+	for (const BranchGrid::Entry& entry : _candidates) {
+		if (entry.branch == first) {
+			continue;
+		}
+		const float length2 = (float) glm::round(glm::distance2(entry.branch->_position, attractionPoint._position));
+		if (length2 <= _minDistance2) {
+			return false;
+		}
+		if (length2 <= _maxDistance2) {
+			_candidates[n++] = entry;
+		}
+	}
+	_candidates.resize(n);
+	std::sort(_candidates.begin(), _candidates.end(), [] (const BranchGrid::Entry& lhs, const BranchGrid::Entry& rhs) {
+		return lhs.order < rhs.order;
+	});
+
+	attractionPoint._closestBranch = first;
+	for (const BranchGrid::Entry& entry : _candidates) {
+		const float length2 = (float) glm::round(glm::distance2(entry.branch->_position, attractionPoint._position));
+		if (glm::distance2(attractionPoint._closestBranch->_position, attractionPoint._position) > length2) {
+			attractionPoint._closestBranch = entry.branch;
+		}
+	}
+	return true;
+}
+
 void SpaceColonization::fillAttractionPoints() {
 	const float radius = (std::max)({_attractionPointHeight, _attractionPointDepth, _attractionPointWidth}) / 2.0f;
 	const glm::ivec3 mins(_position.x - (_attractionPointWidth / 2), _position.y, _position.z - (_attractionPointDepth / 2));
@@ -91,49 +185,32 @@ bool SpaceColonization::step() {
 		return false;
 	}
 
-	// process the attraction points
-	for (auto pi = _attractionPoints.begin(); pi != _attractionPoints.end();) {
-		bool attractionPointRemoved = false;
-		AttractionPoint& attractionPoint = *pi;
-
-		attractionPoint._closestBranch = nullptr;
-
-		// Find the nearest branch for this attraction point
-		for (auto bi = _branches.begin(); bi != _branches.end(); ++bi) {
-			Branch* branch = bi->second;
-			const float length2 = (float) glm::round(glm::distance2(branch->_position, attractionPoint._position));
-
-			// Min attraction point distance reached, we remove it
-			if (attractionPoint._closestBranch == nullptr) {
-				attractionPoint._closestBranch = branch;
-			} else if (length2 <= _minDistance2) {
-				pi = _attractionPoints.erase(pi);
-				attractionPointRemoved = true;
-				break;
-			} else if (length2 <= _maxDistance2) {
-				// branch in range, determine if it is the nearest
-				if (glm::distance2(attractionPoint._closestBranch->_position, attractionPoint._position) > length2) {
-					attractionPoint._closestBranch = branch;
-				}
-			}
-		}
+	if (_branchGrid.size() != _branches.size()) {
+		indexBranches();
+	}
 
-		// if the attraction point was removed, skip
-		if (attractionPointRemoved) {
+	// process the attraction points - the removed ones are compacted away without changing the order
+	Branch* first = _branches.begin()->value;
+	size_t remaining = 0u;
+	for (size_t i = 0u; i < _attractionPoints.size(); ++i) {
+		AttractionPoint& attractionPoint = _attractionPoints[i];
+		// Min attraction point distance reached, we remove it
+		if (!closestBranch(attractionPoint, first)) {
 			continue;
 		}
 
-		++pi;
-
-		// Set the grow parameters on all the closest branches that are in range
-		if (attractionPoint._closestBranch == nullptr) {
-			continue;
-		}
+		// Set the grow parameters on the closest branch
 		const glm::vec3& dir = glm::normalize(attractionPoint._position - attractionPoint._closestBranch->_position);
 		// add to grow direction of branch
 		attractionPoint._closestBranch->_growDirection += dir;
 		++attractionPoint._closestBranch->_attractionPointInfluence;
+
+		if (remaining != i) {
+			_attractionPoints[remaining] = attractionPoint;
+		}
+		++remaining;
 	}
+	_attractionPoints.erase(_attractionPoints.begin() + remaining, _attractionPoints.end());
 
 	// Generate the new branches
 	std::vector<Branch*> newBranches;
@@ -173,7 +250,7 @@ bool SpaceColonization::step() {
 			delete branch;
 			continue;
 		}
-		_branches.put(branch->_position, branch);
+		addBranch(branch);
 		branchAdded = true;
 	}
 	newBranches.clear();
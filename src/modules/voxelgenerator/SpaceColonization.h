@@ -9,6 +9,8 @@
 #include "core/Log.h"
 #include "core/GLM.h"
 #include "core/collection/Map.h"
+#include <unordered_map>
+#include <vector>
 
 namespace voxelgenerator {
 namespace tree {
@@ -36,6 +38,42 @@ struct Branch {
 	void reset();
 };
 
+/**
+ * @brief Uniform grid over the branches for the attraction point queries
+ *
+ * The cell size is at least the query radius - all branches in range of a position are in the 27 cells around it.
+ */
+class BranchGrid {
+public:
+	struct Entry {
+		Branch* branch;
+		/**
+		 * The position of the branch in the iteration order of the branch map. The closest branch search
+		 * depends on this order for equally distant branches.
+		 */
+		uint64_t order;
+	};
+private:
+	using Cells = std::unordered_map<glm::ivec3, std::vector<Entry>, glm::hash<glm::ivec3>>;
+	Cells _cells;
+	float _cellSize = 1.0f;
+	size_t _size = 0u;
+
+	glm::ivec3 cell(const glm::vec3& position) const;
+public:
+	void init(float radius);
+	void clear();
+	void add(Branch* branch, uint64_t order);
+	/**
+	 * @brief Appends all branches of the cells around the given position - the caller has to check the distance
+	 */
+	void query(const glm::vec3& position, std::vector<Entry>& entries) const;
+
+	inline size_t size() const {
+		return _size;
+	}
+};
+
 /**
  * @brief Space colonization algorithm
  *
@@ -59,15 +97,39 @@ protected:
 	Branch *_root;
 	using AttractionPoints = std::vector<AttractionPoint>;
 	AttractionPoints _attractionPoints;
-	using Branches = core::Map<glm::vec3, Branch*, 64, glm::hash<glm::vec3>>;
+	static constexpr size_t BranchBuckets = 64;
+	using Branches = core::Map<glm::vec3, Branch*, BranchBuckets, glm::hash<glm::vec3>>;
 	Branches _branches;
 	math::Random _random;
 
+	BranchGrid _branchGrid;
+	uint32_t _branchSequence = 0u;
+	std::vector<BranchGrid::Entry> _candidates;
+
 	/**
 	 * Generate the attraction points for the crown
 	 */
 	void fillAttractionPoints();
 
+	/**
+	 * @brief Adds the branch to the map and to the spatial index
+	 */
+	void addBranch(Branch* branch);
+	/**
+	 * @brief (Re-)builds the spatial index from the branch map - e.g. after a subclass added the trunk
+	 */
+	void indexBranches();
+	/**
+	 * @brief Finds the branch that the attraction point is influencing
+	 *
+	 * This is the same as scanning the branch map in iteration order: the first branch is always taken
+	 * as a start, every other branch in the kill distance removes the point and every other branch in the
+	 * attraction distance that is closer replaces the current one.
+	 *
+	 * @return @c false if the attraction point was reached and must be removed
+	 */
+	bool closestBranch(AttractionPoint& attractionPoint, Branch* first);
+
 	template<class Volume, class Voxel, class Size>
 	void generateLeaves_r(Volume& volume, const Voxel& voxel, Branch* branch, const Size& size) const {
 		if (branch->_children.empty()) {
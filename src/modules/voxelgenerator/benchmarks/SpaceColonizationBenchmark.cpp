@@ -0,0 +1,49 @@
+/**
+ * @file
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "voxelgenerator/SpaceColonization.h"
+#include "voxelgenerator/TreeGenerator.h"
+
+class SpaceColonizationBenchmark : public core::AbstractBenchmark {
+};
+
+/**
+ * @param 0 the size of the crown
+ * @param 1 the amount of attraction points
+ */
+BENCHMARK_DEFINE_F(SpaceColonizationBenchmark, Grow)(benchmark::State& state) {
+	const int size = (int)state.range(0);
+	const int attractionPoints = (int)state.range(1);
+	int seed = 0;
+	for (auto _ : state) {
+		voxelgenerator::tree::SpaceColonization tree(glm::ivec3(0), 4, size, size, size, 4.0f, ++seed, 6, 10, attractionPoints);
+		tree.grow();
+	}
+}
+
+/**
+ * @param 0 the size of the crown - the tree uses the default amount of attraction points
+ */
+BENCHMARK_DEFINE_F(SpaceColonizationBenchmark, GrowTree)(benchmark::State& state) {
+	const int size = (int)state.range(0);
+	int seed = 0;
+	for (auto _ : state) {
+		voxelgenerator::tree::Tree tree(glm::ivec3(0), 16, 4, size, size, size, 5.0f, ++seed, 0.8f);
+		tree.grow();
+	}
+}
+
+static void crownArguments(benchmark::internal::Benchmark* b) {
+	for (int size : {32, 64, 128}) {
+		for (int attractionPoints : {400, 1600, 3200}) {
+			b->Args({size, attractionPoints});
+		}
+	}
+}
+
+BENCHMARK_REGISTER_F(SpaceColonizationBenchmark, Grow)->Apply(crownArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(SpaceColonizationBenchmark, GrowTree)->Arg(32)->Arg(64)->Arg(128)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,154 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "voxelgenerator/SpaceColonization.h"
+#include "voxelgenerator/TreeGenerator.h"
+
+namespace voxelgenerator {
+namespace tree {
+
+/**
+ * Exposes the state of the algorithm and adds the linear branch scan that the spatial index replaced as reference
+ */
+template<class BASE>
+class TestSpaceColonization : public BASE {
+public:
+	using Super = BASE;
+	using Super::Super;
+
+	const typename Super::Branches& branches() const {
+		return this->_branches;
+	}
+
+	const typename Super::AttractionPoints& attractionPoints() const {
+		return this->_attractionPoints;
+	}
+
+	void growLinear() {
+		int n = 100;
+		while (stepLinear() && --n > 0) {
+		}
+	}
+
+	bool stepLinear() {
+		if (this->_attractionPoints.empty()) {
+			return false;
+		}
+		for (auto pi = this->_attractionPoints.begin(); pi != this->_attractionPoints.end();) {
+			bool attractionPointRemoved = false;
+			AttractionPoint& attractionPoint = *pi;
+			attractionPoint._closestBranch = nullptr;
+			for (auto bi = this->_branches.begin(); bi != this->_branches.end(); ++bi) {
+				Branch* branch = bi->second;
+				const float length2 = (float) glm::round(glm::distance2(branch->_position, attractionPoint._position));
+				if (attractionPoint._closestBranch == nullptr) {
+					attractionPoint._closestBranch = branch;
+				} else if (length2 <= this->_minDistance2) {
+					pi = this->_attractionPoints.erase(pi);
+					attractionPointRemoved = true;
+					break;
+				} else if (length2 <= this->_maxDistance2) {
+					if (glm::distance2(attractionPoint._closestBranch->_position, attractionPoint._position) > length2) {
+						attractionPoint._closestBranch = branch;
+					}
+				}
+			}
+			if (attractionPointRemoved) {
+				continue;
+			}
+			++pi;
+			const glm::vec3& dir = glm::normalize(attractionPoint._position - attractionPoint._closestBranch->_position);
+			attractionPoint._closestBranch->_growDirection += dir;
+			++attractionPoint._closestBranch->_attractionPointInfluence;
+		}
+
+		std::vector<Branch*> newBranches;
+		for (auto e : this->_branches) {
+			Branch* branch = e->value;
+			if (branch->_attractionPointInfluence <= 0) {
+				continue;
+			}
+			const glm::vec3& avgDirection = branch->_growDirection / (float)branch->_attractionPointInfluence;
+			const glm::vec3& branchPos = branch->_position + avgDirection * (float)this->_branchLength;
+			newBranches.push_back(new Branch(branch, branchPos, avgDirection, branch->_size * this->_branchSizeFactor));
+			branch->reset();
+		}
+		if (newBranches.empty()) {
+			return false;
+		}
+		bool branchAdded = false;
+		for (Branch* branch : newBranches) {
+			if (this->_branches.find(branch->_position) != this->_branches.end()) {
+				auto& c = branch->_parent->_children;
+				c.erase(std::find(c.begin(), c.end(), branch));
+				delete branch;
+				continue;
+			}
+			this->_branches.put(branch->_position, branch);
+			branchAdded = true;
+		}
+		return branchAdded;
+	}
+};
+
+class SpaceColonizationTest: public core::AbstractTest {
+protected:
+	template<class T>
+	void expectEqual(const T& indexed, const T& linear) {
+		ASSERT_EQ(linear.branches().size(), indexed.branches().size());
+		ASSERT_EQ(linear.attractionPoints().size(), indexed.attractionPoints().size());
+		auto li = linear.branches().begin();
+		for (auto ii = indexed.branches().begin(); ii != indexed.branches().end(); ++ii, ++li) {
+			const Branch* a = ii->value;
+			const Branch* b = li->value;
+			// bitwise - not only nearly equal
+			ASSERT_EQ(0, memcmp(&a->_position, &b->_position, sizeof(a->_position)));
+			ASSERT_EQ(0, memcmp(&a->_growDirection, &b->_growDirection, sizeof(a->_growDirection)));
+			ASSERT_EQ(a->_size, b->_size);
+			ASSERT_EQ(a->_children.size(), b->_children.size());
+			ASSERT_EQ(a->_parent == nullptr, b->_parent == nullptr);
+			if (a->_parent != nullptr) {
+				ASSERT_EQ(a->_parent->_position, b->_parent->_position);
+			}
+		}
+		for (size_t i = 0; i < linear.attractionPoints().size(); ++i) {
+			ASSERT_EQ(linear.attractionPoints()[i]._position, indexed.attractionPoints()[i]._position);
+		}
+	}
+};
+
+TEST_F(SpaceColonizationTest, testSameAsLinearScan) {
+	for (int seed = 0; seed < 8; ++seed) {
+		const int size = 20 + seed * 8;
+		TestSpaceColonization<SpaceColonization> indexed(glm::ivec3(0), 4, size, size, size, 4.0f, seed, 6, 10, 100 + seed * 150);
+		TestSpaceColonization<SpaceColonization> linear(glm::ivec3(0), 4, size, size, size, 4.0f, seed, 6, 10, 100 + seed * 150);
+		indexed.grow();
+		linear.growLinear();
+		EXPECT_GT(indexed.branches().size(), 1u) << "seed " << seed;
+		expectEqual(indexed, linear);
+	}
+}
+
+TEST_F(SpaceColonizationTest, testTreeSameAsLinearScan) {
+	for (int seed = 0; seed < 8; ++seed) {
+		const int size = 24 + seed * 6;
+		TestSpaceColonization<Tree> indexed(glm::ivec3(-10, 5, 30), 12, 4, size, size, size, 5.0f, seed, 0.8f);
+		TestSpaceColonization<Tree> linear(glm::ivec3(-10, 5, 30), 12, 4, size, size, size, 5.0f, seed, 0.8f);
+		indexed.grow();
+		linear.growLinear();
+		expectEqual(indexed, linear);
+	}
+}
+
+TEST_F(SpaceColonizationTest, testKillDistanceLargerThanAttractionDistance) {
+	TestSpaceColonization<SpaceColonization> indexed(glm::ivec3(0), 3, 32, 32, 32, 4.0f, 1, 12, 5, 300);
+	TestSpaceColonization<SpaceColonization> linear(glm::ivec3(0), 3, 32, 32, 32, 4.0f, 1, 12, 5, 300);
+	indexed.grow();
+	linear.growLinear();
+	expectEqual(indexed, linear);
+}
+
+}
+}
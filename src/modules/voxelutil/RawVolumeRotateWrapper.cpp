@@ -17,7 +17,7 @@ RawVolumeRotateWrapper::RawVolumeRotateWrapper(const voxel::RawVolume *volume, m
 		_region.setUpperZ(srcRegion.getUpperX());
 	} else if (axis == math::Axis::X) {
 		_region.setLowerY(srcRegion.getLowerZ());
-		_region.setLowerZ(srcRegion.getLowerX());
+		_region.setLowerZ(srcRegion.getLowerY());
 		_region.setUpperY(srcRegion.getUpperZ());
 		_region.setUpperZ(srcRegion.getUpperY());
 	} else if (axis == math::Axis::Z) {
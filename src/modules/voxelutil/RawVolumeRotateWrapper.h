@@ -2,6 +2,8 @@
  * @file
  */
 
+#pragma once
+
 #include "voxel/Region.h"
 #include "voxel/RawVolume.h"
 #include "math/Axis.h"
@@ -6,6 +6,7 @@
 
 #include "voxel/RawVolume.h"
 #include "VolumeMerger.h"
+#include "VolumeSpans.h"
 #include "core/Common.h"
 
 namespace voxel {
@@ -21,52 +22,61 @@ struct CropSkipEmpty {
 
 /**
  * @brief Resizes a volume to cut off empty parts
+ * @param[in] threadPool Optional thread pool to copy big volumes in parallel
  */
 template<class CropSkipCondition = CropSkipEmpty>
-RawVolume* cropVolume(const RawVolume* volume, const glm::ivec3& mins, const glm::ivec3& maxs, CropSkipCondition condition = CropSkipCondition()) {
+RawVolume* cropVolume(const RawVolume* volume, const glm::ivec3& mins, const glm::ivec3& maxs, CropSkipCondition condition = CropSkipCondition(), core::ThreadPool* threadPool = nullptr) {
 	core_trace_scoped(CropRawVolume);
 	const voxel::Region newRegion(mins, maxs);
 	if (!newRegion.isValid()) {
 		return nullptr;
 	}
 	voxel::RawVolume* newVolume = new voxel::RawVolume(newRegion);
-	voxel::mergeVolumes(newVolume, volume, newRegion, voxel::Region(mins, maxs));
+	voxel::mergeVolumes(newVolume, volume, newRegion, voxel::Region(mins, maxs), MergeSkipEmpty(), threadPool);
 	return newVolume;
 }
 
 /**
  * @brief Resizes a volume to cut off empty parts
+ * @param[in] threadPool Optional thread pool to scan and copy big volumes in parallel
  */
 template<class CropSkipCondition = CropSkipEmpty>
-RawVolume* cropVolume(const RawVolume* volume, CropSkipCondition condition = CropSkipCondition()) {
+RawVolume* cropVolume(const RawVolume* volume, CropSkipCondition condition = CropSkipCondition(), core::ThreadPool* threadPool = nullptr) {
 	core_trace_scoped(CropRawVolume);
-	const glm::ivec3& mins = volume->mins();
-	const glm::ivec3& maxs = volume->maxs();
-	glm::ivec3 newMins((std::numeric_limits<int>::max)() / 2);
-	glm::ivec3 newMaxs((std::numeric_limits<int>::min)() / 2);
-	voxel::RawVolume::Sampler volumeSampler(volume);
-	for (int32_t z = mins.z; z <= maxs.z; ++z) {
-		for (int32_t y = mins.y; y <= maxs.y; ++y) {
-			for (int32_t x = mins.x; x <= maxs.x; ++x) {
-				volumeSampler.setPosition(x, y, z);
-				const voxel::Voxel& voxel = volumeSampler.voxel();
-				if (condition(voxel)) {
-					continue;
+	voxel::Region region(volume->mins(), volume->maxs());
+	region.cropTo(volume->region());
+	if (!region.isValid()) {
+		return nullptr;
+	}
+	const glm::ivec3& mins = region.getLowerCorner();
+	const glm::ivec3& maxs = region.getUpperCorner();
+	const int width = region.getWidthInVoxels();
+	// the stats are used to collect the bounding box of the voxels that are not skipped
+	const voxelutil::SpanStats& stats = voxelutil::forEachSlab(region, threadPool, [&] (int lowerZ, int upperZ, voxelutil::SpanStats& slabStats) {
+		for (int32_t z = lowerZ; z <= upperZ; ++z) {
+			for (int32_t y = mins.y; y <= maxs.y; ++y) {
+				const voxel::Voxel* row = volume->voxelRow(mins.x, y, z);
+				int first = -1;
+				int last = -1;
+				for (int i = 0; i < width; ++i) {
+					if (condition(row[i])) {
+						continue;
+					}
+					if (first == -1) {
+						first = i;
+					}
+					last = i;
+				}
+				if (first != -1) {
+					slabStats.add(mins.x + first, mins.x + last, y, z, last - first + 1);
 				}
-				newMins.x = core_min(newMins.x, x);
-				newMins.y = core_min(newMins.y, y);
-				newMins.z = core_min(newMins.z, z);
-
-				newMaxs.x = core_max(newMaxs.x, x);
-				newMaxs.y = core_max(newMaxs.y, y);
-				newMaxs.z = core_max(newMaxs.z, z);
 			}
 		}
-	}
-	if (newMaxs.z == (std::numeric_limits<int>::min)() / 2) {
+	});
+	if (!stats.modified()) {
 		return nullptr;
 	}
-	return cropVolume(volume, newMins, newMaxs, condition);
+	return cropVolume(volume, stats.mins, stats.maxs, condition, threadPool);
 }
 
 }
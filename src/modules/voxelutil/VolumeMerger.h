@@ -5,8 +5,10 @@
 #pragma once
 
 #include "voxel/RawVolume.h"
+#include "VolumeSpans.h"
 #include "core/Trace.h"
 #include "core/Assert.h"
+#include <type_traits>
 #include <vector>
 
 namespace voxel {
@@ -20,9 +22,19 @@ struct MergeSkipEmpty {
 	}
 };
 
+/**
+ * @brief Will merge all voxels - including air. Allows to copy whole spans.
+ */
+struct MergeAll {
+	inline bool operator() (const voxel::Voxel&) const {
+		return true;
+	}
+};
+
 /**
  * @note This version can deal with source volumes that are smaller or equal sized to the destination volume
  * @note The given merge condition function must return false for voxels that should be skipped.
+ * @return The amount of modified voxels - voxels that already have the merged value are not counted
  * @sa MergeSkipEmpty
  */
 template<typename MergeCondition = MergeSkipEmpty, class Volume1, class Volume2>
@@ -42,6 +54,10 @@ int mergeVolumes(Volume1* destination, const Volume2* source, const Region& dest
 				if (!destReg.containsPoint(destX, destY, destZ)) {
 					continue;
 				}
+				// the wrappers report every placed voxel - not only the modified ones
+				if (destination->voxel(destX, destY, destZ).isSame(voxel)) {
+					continue;
+				}
 				if (destination->setVoxel(destX, destY, destZ, voxel)) {
 					++cnt;
 				}
@@ -51,6 +67,71 @@ int mergeVolumes(Volume1* destination, const Volume2* source, const Region& dest
 	return cnt;
 }
 
+/**
+ * @brief Span based version for raw volumes - see the generic @c mergeVolumes() version above
+ *
+ * The regions are clipped once and the voxels are merged row by row. Merging with @c MergeAll copies
+ * whole rows. Big regions are split into slabs along the z axis and merged in the given thread pool.
+ *
+ * @param[in] threadPool Optional thread pool to merge big regions in parallel
+ * @return The amount of modified voxels
+ */
+template<typename MergeCondition = MergeSkipEmpty>
+int mergeVolumes(RawVolume* destination, const RawVolume* source, const Region& destReg, const Region& sourceReg, MergeCondition mergeCondition = MergeCondition(), core::ThreadPool* threadPool = nullptr) {
+	core_trace_scoped(MergeRawVolumeSpans);
+	const glm::ivec3 offset = destReg.getLowerCorner() - sourceReg.getLowerCorner();
+	Region destClipped = destReg;
+	destClipped.cropTo(destination->region());
+	destClipped.shift(-offset);
+	Region srcClipped = sourceReg;
+	srcClipped.cropTo(destClipped);
+	if (!srcClipped.isValid()) {
+		return 0;
+	}
+	if (!source->region().containsRegion(srcClipped)) {
+		// voxels outside of the source volume are using the border value - let the generic version deal with it
+		return mergeVolumes<MergeCondition, RawVolume, RawVolume>(destination, source, destReg, sourceReg, mergeCondition);
+	}
+	const int lowerX = srcClipped.getLowerX();
+	const int width = srcClipped.getWidthInVoxels();
+	const voxelutil::SpanStats& stats = voxelutil::forEachSlab(srcClipped, threadPool, [&] (int lowerZ, int upperZ, voxelutil::SpanStats& slabStats) {
+		for (int32_t z = lowerZ; z <= upperZ; ++z) {
+			const int destZ = z + offset.z;
+			for (int32_t y = srcClipped.getLowerY(); y <= srcClipped.getUpperY(); ++y) {
+				const int destY = y + offset.y;
+				const int destX = lowerX + offset.x;
+				const Voxel* src = source->voxelRow(lowerX, y, z);
+				Voxel* dest = destination->voxelRow(destX, destY, destZ);
+				if constexpr (std::is_same<MergeCondition, MergeAll>::value) {
+					voxelutil::copySpan(dest, src, width, destX, destY, destZ, slabStats);
+					continue;
+				}
+				int first = -1;
+				int last = -1;
+				int modified = 0;
+				for (int i = 0; i < width; ++i) {
+					const Voxel& voxel = src[i];
+					if (!mergeCondition(voxel)) {
+						continue;
+					}
+					if (dest[i].isSame(voxel)) {
+						continue;
+					}
+					dest[i] = voxel;
+					if (first == -1) {
+						first = i;
+					}
+					last = i;
+					++modified;
+				}
+				slabStats.add(destX + first, destX + last, destY, destZ, modified);
+			}
+		}
+	});
+	stats.apply(*destination);
+	return stats.count;
+}
+
 /**
  * The given merge condition function must return false for voxels that should be skipped.
  * @sa MergeSkipEmpty
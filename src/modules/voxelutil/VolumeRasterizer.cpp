@@ -0,0 +1,238 @@
+/**
+ * @file
+ */
+
+#include "VolumeRasterizer.h"
+#include "core/Assert.h"
+#include "core/Common.h"
+#include "core/Trace.h"
+#include "core/concurrent/TaskGroup.h"
+#include "voxel/MaterialColor.h"
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+#include <glm/vector_relational.hpp>
+#include <float.h>
+
+namespace voxelutil {
+
+struct VolumeRasterizer::View {
+	glm::vec3 center;
+	glm::vec3 right;
+	glm::vec3 up;
+	glm::vec3 forward;
+	// the voxel bounds of the traced area
+	glm::ivec3 lower;
+	glm::ivec3 upper;
+	glm::vec3 mins;
+	glm::vec3 maxs;
+	// world units per pixel
+	float scale;
+	// distance of the ray origins to the center - outside of the volume
+	float distance;
+	int width;
+	int height;
+};
+
+VolumeRasterizer::VolumeRasterizer(size_t threads) :
+		_threadPool(core_max((size_t)1u, threads), "rasterizer") {
+	setViewDirection(glm::vec3(1.0f, -1.0f, 1.0f));
+	setLightDirection(glm::vec3(0.4f, -1.0f, 0.7f));
+}
+
+void VolumeRasterizer::init() {
+	_threadPool.init();
+	_initialized = true;
+}
+
+void VolumeRasterizer::shutdown() {
+	_threadPool.shutdown(true);
+	_initialized = false;
+}
+
+void VolumeRasterizer::setViewDirection(const glm::vec3& direction) {
+	_viewDirection = glm::normalize(direction);
+}
+
+void VolumeRasterizer::setLightDirection(const glm::vec3& direction) {
+	_lightDirection = glm::normalize(direction);
+}
+
+uint32_t VolumeRasterizer::trace(const voxel::RawVolume& volume, const View& view, const glm::vec3& origin) const {
+	const glm::vec3& direction = view.forward;
+	const glm::vec3& mins = view.mins;
+	const glm::vec3& maxs = view.maxs;
+	const glm::ivec3& lower = view.lower;
+	const glm::ivec3& upper = view.upper;
+
+	// slab test against the bounds of the volume - remember the axis of the entry face
+	float tmin = 0.0f;
+	float tmax = FLT_MAX;
+	int axis = 0;
+	glm::vec3 invDir;
+	for (int i = 0; i < 3; ++i) {
+		if (glm::abs(direction[i]) < 1e-6f) {
+			if (origin[i] < mins[i] || origin[i] >= maxs[i]) {
+				return 0u;
+			}
+			invDir[i] = FLT_MAX;
+			continue;
+		}
+		invDir[i] = 1.0f / direction[i];
+		float t0 = (mins[i] - origin[i]) * invDir[i];
+		float t1 = (maxs[i] - origin[i]) * invDir[i];
+		if (t0 > t1) {
+			std::swap(t0, t1);
+		}
+		if (t0 > tmin) {
+			tmin = t0;
+			axis = i;
+		}
+		tmax = core_min(tmax, t1);
+		if (tmin > tmax) {
+			return 0u;
+		}
+	}
+
+	const glm::vec3 entry = origin + direction * (tmin + 1e-4f);
+	glm::ivec3 cell = glm::clamp(glm::ivec3(glm::floor(entry)), lower, upper);
+	glm::ivec3 step;
+	glm::vec3 tDelta;
+	glm::vec3 tNext;
+	for (int i = 0; i < 3; ++i) {
+		if (invDir[i] == FLT_MAX) {
+			step[i] = 0;
+			tDelta[i] = FLT_MAX;
+			tNext[i] = FLT_MAX;
+			continue;
+		}
+		step[i] = direction[i] > 0.0f ? 1 : -1;
+		tDelta[i] = glm::abs(invDir[i]);
+		const float boundary = (float)(step[i] > 0 ? cell[i] + 1 : cell[i]);
+		tNext[i] = (boundary - origin[i]) * invDir[i];
+	}
+
+	for (;;) {
+		const voxel::Voxel& voxel = volume.voxel(cell);
+		if (!voxel::isAir(voxel.getMaterial())) {
+			break;
+		}
+		if (tNext.x < tNext.y && tNext.x < tNext.z) {
+			axis = 0;
+		} else if (tNext.y < tNext.z) {
+			axis = 1;
+		} else {
+			axis = 2;
+		}
+		cell[axis] += step[axis];
+		if (cell[axis] < lower[axis] || cell[axis] > upper[axis]) {
+			return 0u;
+		}
+		tNext[axis] += tDelta[axis];
+	}
+
+	// the face that was hit points against the ray direction
+	glm::ivec3 normal(0);
+	normal[axis] = direction[axis] > 0.0f ? -1 : 1;
+
+	// ambient occlusion - count the solid neighbours of the air cell in front of the face
+	const glm::ivec3 front = cell + normal;
+	const int a = (axis + 1) % 3;
+	const int b = (axis + 2) % 3;
+	float occlusion = 0.0f;
+	for (int da = -1; da <= 1; ++da) {
+		for (int db = -1; db <= 1; ++db) {
+			if (da == 0 && db == 0) {
+				continue;
+			}
+			glm::ivec3 pos = front;
+			pos[a] += da;
+			pos[b] += db;
+			if (voxel::isAir(volume.voxel(pos).getMaterial())) {
+				continue;
+			}
+			// corners occlude less than the edges
+			occlusion += (da != 0 && db != 0) ? 0.5f : 1.0f;
+		}
+	}
+	const float ao = 1.0f - occlusion / 6.0f * 0.5f;
+	const float diffuse = core_max(0.0f, -glm::dot(glm::vec3(normal), _lightDirection));
+	const float light = (_ambient + (1.0f - _ambient) * diffuse) * ao;
+
+	const glm::vec4& color = voxel::getMaterialColor(volume.voxel(cell));
+	const glm::vec3 rgb = glm::clamp(glm::vec3(color) * light, 0.0f, 1.0f) * 255.0f;
+	return (uint32_t)rgb.r | ((uint32_t)rgb.g << 8) | ((uint32_t)rgb.b << 16) | (255u << 24);
+}
+
+void VolumeRasterizer::renderTile(const voxel::RawVolume& volume, const View& view, int tileX, int tileY, uint8_t *rgba) const {
+	core_trace_scoped(VolumeRasterizerTile);
+	const int endX = core_min(tileX + _tileSize, view.width);
+	const int endY = core_min(tileY + _tileSize, view.height);
+	const glm::vec3 base = view.center - view.forward * view.distance;
+	for (int y = tileY; y < endY; ++y) {
+		const float v = ((float)view.height * 0.5f - (float)y - 0.5f) * view.scale;
+		uint8_t *row = rgba + ((size_t)y * view.width + tileX) * 4u;
+		for (int x = tileX; x < endX; ++x) {
+			const float u = ((float)x + 0.5f - (float)view.width * 0.5f) * view.scale;
+			const glm::vec3 origin = base + view.right * u + view.up * v;
+			const uint32_t color = trace(volume, view, origin);
+			*row++ = (uint8_t)(color & 0xFF);
+			*row++ = (uint8_t)((color >> 8) & 0xFF);
+			*row++ = (uint8_t)((color >> 16) & 0xFF);
+			*row++ = (uint8_t)((color >> 24) & 0xFF);
+		}
+	}
+}
+
+bool VolumeRasterizer::render(const voxel::RawVolume& volume, int width, int height, std::vector<uint8_t>& rgba) {
+	core_trace_scoped(VolumeRasterizerRender);
+	core_assert_msg(_initialized, "VolumeRasterizer::init() wasn't called");
+	if (!_initialized || width <= 0 || height <= 0) {
+		return false;
+	}
+	const voxel::Region& region = volume.region();
+
+	View view;
+	view.width = width;
+	view.height = height;
+	view.forward = _viewDirection;
+	const glm::vec3 worldUp = glm::abs(view.forward.y) > 0.999f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+	view.right = glm::normalize(glm::cross(view.forward, worldUp));
+	view.up = glm::cross(view.right, view.forward);
+	// only trace the area where voxels are set
+	view.lower = glm::max(volume.mins(), region.getLowerCorner());
+	view.upper = glm::min(volume.maxs(), region.getUpperCorner());
+	if (glm::any(glm::greaterThan(view.lower, view.upper))) {
+		view.lower = region.getLowerCorner();
+		view.upper = region.getUpperCorner();
+	}
+	view.mins = glm::vec3(view.lower);
+	view.maxs = glm::vec3(view.upper) + 1.0f;
+	view.center = (view.mins + view.maxs) * 0.5f;
+	view.distance = glm::length(view.maxs - view.mins) + 1.0f;
+
+	// fit the projected corners of the volume into the image
+	float extentRight = 0.0f;
+	float extentUp = 0.0f;
+	for (int i = 0; i < 8; ++i) {
+		const glm::vec3 corner((i & 1) ? view.maxs.x : view.mins.x, (i & 2) ? view.maxs.y : view.mins.y, (i & 4) ? view.maxs.z : view.mins.z);
+		const glm::vec3 d = corner - view.center;
+		extentRight = core_max(extentRight, glm::abs(glm::dot(d, view.right)));
+		extentUp = core_max(extentUp, glm::abs(glm::dot(d, view.up)));
+	}
+	view.scale = core_max(extentRight * 2.0f / (float)width, extentUp * 2.0f / (float)height) * 1.05f;
+
+	rgba.resize((size_t)width * height * 4u);
+	uint8_t *pixels = rgba.data();
+	core::TaskGroup group(_threadPool);
+	for (int y = 0; y < height; y += _tileSize) {
+		for (int x = 0; x < width; x += _tileSize) {
+			group.spawn([this, &volume, &view, x, y, pixels] () {
+				renderTile(volume, view, x, y, pixels);
+			});
+		}
+	}
+	group.wait();
+	return true;
+}
+
+}
@@ -0,0 +1,56 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/concurrent/ThreadPool.h"
+#include "voxel/RawVolume.h"
+#include <glm/vec3.hpp>
+#include <vector>
+
+namespace voxelutil {
+
+/**
+ * @brief Renders a volume on the cpu - no graphics context is needed
+ *
+ * A ray is cast for each pixel of an orthographic view and walks the voxel grid (3d dda) until a solid
+ * voxel is hit. The color is taken from the @c MaterialColor palette and shaded by a directional light
+ * and per-face ambient occlusion. The image is split into tiles that are rendered by a thread pool.
+ *
+ * @note The material colors must be initialized.
+ */
+class VolumeRasterizer {
+private:
+	core::ThreadPool _threadPool;
+	glm::vec3 _viewDirection;
+	glm::vec3 _lightDirection;
+	float _ambient = 0.4f;
+	int _tileSize = 32;
+	bool _initialized = false;
+
+	struct View;
+	void renderTile(const voxel::RawVolume& volume, const View& view, int tileX, int tileY, uint8_t *rgba) const;
+	uint32_t trace(const voxel::RawVolume& volume, const View& view, const glm::vec3& origin) const;
+public:
+	VolumeRasterizer(size_t threads = 1u);
+
+	void init();
+	void shutdown();
+
+	/**
+	 * @param[in] direction The direction the camera is looking at the volume. The default is the
+	 * same diagonal view that the thumbnailer uses.
+	 */
+	void setViewDirection(const glm::vec3& direction);
+	void setLightDirection(const glm::vec3& direction);
+
+	/**
+	 * @brief Renders the given volume - the volume is scaled to fit into the image
+	 * @param[out] rgba The pixels of the image (4 bytes per pixel), pixels that don't hit a voxel are transparent.
+	 * The first row is the top of the image.
+	 */
+	bool render(const voxel::RawVolume& volume, int width, int height, std::vector<uint8_t>& rgba);
+};
+
+}
@@ -0,0 +1,185 @@
+/**
+ * @file
+ */
+
+#include "VolumeRescaler.h"
+#include "VolumeSpans.h"
+#include "core/Trace.h"
+#include <vector>
+
+namespace voxel {
+
+void rescaleVolume(const RawVolume& sourceVolume, const Region& sourceRegion, RawVolume& destVolume, const Region& destRegion, core::ThreadPool* threadPool) {
+	core_trace_scoped(RescaleRawVolume);
+	const MaterialColorArray& colors = getMaterialColors();
+	const core::PaletteQuantizer& quantizer = getMaterialColorQuantizer();
+	const Region& srcVolumeRegion = sourceVolume.region();
+	const int32_t width = destRegion.getWidthInVoxels();
+	const glm::ivec3& srcLower = sourceRegion.getLowerCorner();
+	const glm::ivec3& dstLower = destRegion.getLowerCorner();
+
+	// the valid source x range of the children - the child rows are clipped against the source volume
+	const int32_t srcLowerX = core_max(srcLower.x, srcVolumeRegion.getLowerX());
+	const int32_t srcUpperX = core_min(srcLower.x + width * 2 - 1, srcVolumeRegion.getUpperX());
+
+	// First of all we iterate over all destination voxels and compute their color as the
+	// avg of the colors of the eight corresponding voxels in the higher resolution version.
+	voxelutil::SpanStats stats = voxelutil::forEachSlab(destRegion, threadPool, [&] (int lowerZ, int upperZ, voxelutil::SpanStats& slabStats) {
+		std::vector<Voxel> row((size_t)width);
+		for (int32_t dstZ = lowerZ; dstZ <= upperZ; ++dstZ) {
+			const int32_t z = dstZ - dstLower.z;
+			for (int32_t dstY = destRegion.getLowerY(); dstY <= destRegion.getUpperY(); ++dstY) {
+				const int32_t y = dstY - dstLower.y;
+				// the four child rows (y and z) that contribute to the destination row
+				const Voxel* childRows[4];
+				int childRowCount = 0;
+				for (int32_t childZ = 0; childZ < 2; ++childZ) {
+					for (int32_t childY = 0; childY < 2; ++childY) {
+						const int32_t srcY = srcLower.y + y * 2 + childY;
+						const int32_t srcZ = srcLower.z + z * 2 + childZ;
+						if (srcLowerX > srcUpperX || !srcVolumeRegion.containsPointInY(srcY) || !srcVolumeRegion.containsPointInZ(srcZ)) {
+							continue;
+						}
+						childRows[childRowCount++] = sourceVolume.voxelRow(srcLowerX, srcY, srcZ);
+					}
+				}
+				bool solid = false;
+				for (int32_t x = 0; x < width; ++x) {
+					float solidVoxels = 0.0f;
+					float avgOf8Red = 0.0f;
+					float avgOf8Green = 0.0f;
+					float avgOf8Blue = 0.0f;
+					// same order as the generic version to get the same float results
+					for (int i = 0; i < childRowCount; ++i) {
+						for (int32_t childX = 0; childX < 2; ++childX) {
+							const int32_t srcX = srcLower.x + x * 2 + childX;
+							if (srcX < srcLowerX || srcX > srcUpperX) {
+								continue;
+							}
+							const Voxel& child = childRows[i][srcX - srcLowerX];
+							if (isBlocked(child.getMaterial())) {
+								++solidVoxels;
+								const glm::vec4& color = colors[child.getColor()];
+								avgOf8Red += color.r;
+								avgOf8Green += color.g;
+								avgOf8Blue += color.b;
+							}
+						}
+					}
+
+					// We only make a voxel solid if the eight corresponding voxels are also all solid. This
+					// means that higher LOD meshes actually shrink away which ensures cracks aren't visible.
+					if (solidVoxels >= 7.0f) {
+						const glm::vec4 avgColor(avgOf8Red / solidVoxels, avgOf8Green / solidVoxels, avgOf8Blue / solidVoxels, 1.0f);
+						const int index = quantizer.getClosestMatch(avgColor);
+						row[x] = createVoxel(VoxelType::Generic, index);
+						solid = true;
+					} else {
+						row[x] = Voxel();
+					}
+				}
+				Voxel* dest = destVolume.voxelRow(dstLower.x, dstY, dstZ);
+				if (solid) {
+					voxelutil::copySpan(dest, row.data(), width, dstLower.x, dstY, dstZ, slabStats);
+				} else {
+					voxelutil::fillSpan(dest, Voxel(), width, dstLower.x, dstY, dstZ, slabStats);
+				}
+			}
+		}
+	});
+
+	// At this point the results are usable, but we have a problem with thin structures disappearing.
+	// The voxels on a material-air boundary get their color recomputed from a larger neighbourhood
+	// (see the generic version). Only the colors are modified here - the materials that are checked
+	// for the boundaries stay the same - so the slabs can be processed in parallel.
+	stats.add(voxelutil::forEachSlab(destRegion, threadPool, [&] (int lowerZ, int upperZ, voxelutil::SpanStats& slabStats) {
+		RawVolume::Sampler srcSampler(sourceVolume);
+		RawVolume::Sampler dstSampler(destVolume);
+		for (int32_t dstZ = lowerZ; dstZ <= upperZ; ++dstZ) {
+			for (int32_t dstY = destRegion.getLowerY(); dstY <= destRegion.getUpperY(); ++dstY) {
+				Voxel* dest = destVolume.voxelRow(dstLower.x, dstY, dstZ);
+				for (int32_t x = 0; x < width; ++x) {
+					// Skip empty voxels
+					if (dest[x].getMaterial() == VoxelType::Air) {
+						continue;
+					}
+					const glm::ivec3 curPos(x, dstY - dstLower.y, dstZ - dstLower.z);
+					const glm::ivec3 dstPos = dstLower + curPos;
+					dstSampler.setPosition(dstPos);
+					// Only process voxels on a material-air boundary.
+					if (dstSampler.peekVoxel0px0py1nz().getMaterial() != VoxelType::Air && dstSampler.peekVoxel0px0py1pz().getMaterial() != VoxelType::Air
+							&& dstSampler.peekVoxel0px1ny0pz().getMaterial() != VoxelType::Air && dstSampler.peekVoxel0px1py0pz().getMaterial() != VoxelType::Air
+							&& dstSampler.peekVoxel1nx0py0pz().getMaterial() != VoxelType::Air && dstSampler.peekVoxel1px0py0pz().getMaterial() != VoxelType::Air) {
+						continue;
+					}
+					const glm::ivec3 srcPos = srcLower + curPos * 2;
+
+					float totalRed = 0.0f;
+					float totalGreen = 0.0f;
+					float totalBlue = 0.0f;
+					float totalExposedFaces = 0.0f;
+
+					// Look at the 64 (4x4x4) children
+					for (int32_t childZ = -1; childZ < 3; childZ++) {
+						for (int32_t childY = -1; childY < 3; childY++) {
+							for (int32_t childX = -1; childX < 3; childX++) {
+								srcSampler.setPosition(srcPos + glm::ivec3(childX, childY, childZ));
+
+								const Voxel& child = srcSampler.voxel();
+								if (child.getMaterial() == VoxelType::Air) {
+									continue;
+								}
+
+								// For each small voxel, count the exposed faces and use this
+								// to determine the importance of the color contribution.
+								float exposedFaces = 0.0f;
+								if (srcSampler.peekVoxel0px0py1nz().getMaterial() == VoxelType::Air) {
+									++exposedFaces;
+								}
+								if (srcSampler.peekVoxel0px0py1pz().getMaterial() == VoxelType::Air) {
+									++exposedFaces;
+								}
+								if (srcSampler.peekVoxel0px1ny0pz().getMaterial() == VoxelType::Air) {
+									++exposedFaces;
+								}
+								if (srcSampler.peekVoxel0px1py0pz().getMaterial() == VoxelType::Air) {
+									++exposedFaces;
+								}
+								if (srcSampler.peekVoxel1nx0py0pz().getMaterial() == VoxelType::Air) {
+									++exposedFaces;
+								}
+								if (srcSampler.peekVoxel1px0py0pz().getMaterial() == VoxelType::Air) {
+									++exposedFaces;
+								}
+
+								const glm::vec4& color = colors[child.getColor()];
+								totalRed += color.r * exposedFaces;
+								totalGreen += color.g * exposedFaces;
+								totalBlue += color.b * exposedFaces;
+
+								totalExposedFaces += exposedFaces;
+							}
+						}
+					}
+
+					// Avoid divide by zero if there were no exposed faces.
+					if (totalExposedFaces <= 0.01f) {
+						++totalExposedFaces;
+					}
+
+					const glm::vec4 avgColor(totalRed / totalExposedFaces, totalGreen / totalExposedFaces, totalBlue / totalExposedFaces, 1.0f);
+					const int index = quantizer.getClosestMatch(avgColor);
+					// the first pass only produces generic voxels - the material isn't touched as it is read
+					// by the boundary checks of the neighbouring slabs
+					if (dest[x].getColor() != (uint8_t)index) {
+						dest[x].setColor((uint8_t)index);
+						slabStats.add(dstPos.x, dstPos.x, dstPos.y, dstPos.z, 1);
+					}
+				}
+			}
+		}
+	}));
+	stats.apply(destVolume);
+}
+
+}
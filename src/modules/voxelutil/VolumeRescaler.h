@@ -4,10 +4,16 @@
 #pragma once
 
 #include "core/Common.h"
-#include "core/Color.h"
+#include "core/PaletteQuantizer.h"
+#include "core/Trace.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Voxel.h"
 #include "voxel/Region.h"
+#include "voxel/RawVolume.h"
+
+namespace core {
+class ThreadPool;
+}
 
 namespace voxel {
 
@@ -25,6 +31,7 @@ void rescaleVolume(const SourceVolume& sourceVolume, const Region& sourceRegion,
 	typename SourceVolume::Sampler srcSampler(sourceVolume);
 
 	const MaterialColorArray& colors = getMaterialColors();
+	const core::PaletteQuantizer& quantizer = getMaterialColorQuantizer();
 
 	const int32_t depth = destRegion.getDepthInVoxels();
 	const int32_t height = destRegion.getHeightInVoxels();
@@ -66,7 +73,7 @@ void rescaleVolume(const SourceVolume& sourceVolume, const Region& sourceRegion,
 				// means that higher LOD meshes actually shrink away which ensures cracks aren't visible.
 				if (solidVoxels >= 7.0f) {
 					const glm::vec4 avgColor(avgOf8Red / solidVoxels, avgOf8Green / solidVoxels, avgOf8Blue / solidVoxels, 1.0f);
-					const int index = core::Color::getClosestMatch(avgColor, colors);
+					const int index = quantizer.getClosestMatch(avgColor);
 					Voxel voxel = createVoxel(VoxelType::Generic, index);
 					destVolume.setVoxel(dstPos, voxel);
 				} else {
@@ -158,7 +165,7 @@ void rescaleVolume(const SourceVolume& sourceVolume, const Region& sourceRegion,
 				}
 
 				const glm::vec4 avgColor(totalRed / totalExposedFaces, totalGreen / totalExposedFaces, totalBlue / totalExposedFaces, 1.0f);
-				const int index = core::Color::getClosestMatch(avgColor, colors);
+				const int index = quantizer.getClosestMatch(avgColor);
 				const Voxel voxel = createVoxel(VoxelType::Generic, index);
 				destVolume.setVoxel(dstPos, voxel);
 			}
@@ -171,4 +178,15 @@ void rescaleVolume(const SourceVolume& sourceVolume, DestVolume& destVolume) {
 	rescaleVolume(sourceVolume, sourceVolume.region(), destVolume, destVolume.region());
 }
 
+/**
+ * @brief Span based version of @c rescaleVolume() for raw volumes with the same result as the generic version.
+ * The child voxels are read row by row and big regions are split into slabs along the z axis.
+ * @param[in] threadPool Optional thread pool to rescale big volumes in parallel
+ */
+extern void rescaleVolume(const RawVolume& sourceVolume, const Region& sourceRegion, RawVolume& destVolume, const Region& destRegion, core::ThreadPool* threadPool = nullptr);
+
+inline void rescaleVolume(const RawVolume& sourceVolume, RawVolume& destVolume, core::ThreadPool* threadPool = nullptr) {
+	rescaleVolume(sourceVolume, sourceVolume.region(), destVolume, destVolume.region(), threadPool);
+}
+
 }
@@ -3,10 +3,13 @@
  */
 
 #include "VolumeRotator.h"
+#include "VolumeSpans.h"
 #include "voxel/RawVolume.h"
 #include "math/AABB.h"
 #include "core/GLM.h"
 #include "core/Assert.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/euler_angles.hpp>
 
@@ -77,7 +80,8 @@ RawVolume* rotateVolume(const RawVolume* source, const glm::vec3& angles, const
 	return destination;
 }
 
-RawVolume* rotateAxis(const RawVolume* source, math::Axis axis) {
+RawVolume* rotateAxis(const RawVolume* source, math::Axis axis, core::ThreadPool* threadPool) {
+	core_trace_scoped(RotateAxis);
 	const voxel::Region& srcRegion = source->region();
 	voxel::Region destRegion = srcRegion;
 	if (axis == math::Axis::Y) {
@@ -87,7 +91,7 @@ RawVolume* rotateAxis(const RawVolume* source, math::Axis axis) {
 		destRegion.setUpperZ(srcRegion.getUpperX());
 	} else if (axis == math::Axis::X) {
 		destRegion.setLowerY(srcRegion.getLowerZ());
-		destRegion.setLowerZ(srcRegion.getLowerX());
+		destRegion.setLowerZ(srcRegion.getLowerY());
 		destRegion.setUpperY(srcRegion.getUpperZ());
 		destRegion.setUpperZ(srcRegion.getUpperY());
 	} else {
@@ -98,82 +102,78 @@ RawVolume* rotateAxis(const RawVolume* source, math::Axis axis) {
 	}
 	core_assert(destRegion.isValid());
 	RawVolume* destination = new RawVolume(destRegion);
-	RawVolume::Sampler destSampler(destination);
-	RawVolume::Sampler srcSampler(source);
-
-	for (int32_t z = srcRegion.getLowerZ(); z <= srcRegion.getUpperZ(); ++z) {
-		for (int32_t y = srcRegion.getLowerY(); y <= srcRegion.getUpperY(); ++y) {
-			for (int32_t x = srcRegion.getLowerX(); x <= srcRegion.getUpperX(); ++x) {
-				srcSampler.setPosition(x, y, z);
-				const Voxel& v = srcSampler.voxel();
-				glm::ivec3 pos(x, y, z);
+	const int lowerX = destRegion.getLowerX();
+	const int width = destRegion.getWidthInVoxels();
+	// the rotation swaps two axes - the rows of the destination are gathered with a fixed stride from the source
+	int stride;
+	if (axis == math::Axis::X) {
+		stride = 1;
+	} else if (axis == math::Axis::Y) {
+		stride = source->width() * source->height();
+	} else {
+		stride = source->width();
+	}
+	voxelutil::forEachSlab(destRegion, threadPool, [&] (int lowerZ, int upperZ, voxelutil::SpanStats&) {
+		for (int32_t z = lowerZ; z <= upperZ; ++z) {
+			for (int32_t y = destRegion.getLowerY(); y <= destRegion.getUpperY(); ++y) {
+				Voxel* dest = destination->voxelRow(lowerX, y, z);
+				const Voxel* src;
 				if (axis == math::Axis::X) {
-					const int tmp = pos.y;
-					pos.y = pos.z;
-					pos.z = tmp;
-				} else if (axis == math::Axis::Y) {
-					const int tmp = pos.x;
-					pos.x = pos.z;
-					pos.z = tmp;
+					src = source->voxelRow(lowerX, z, y);
+					core_memcpy((void*)dest, (const void*)src, width * sizeof(Voxel));
+					continue;
+				}
+				if (axis == math::Axis::Y) {
+					src = source->voxelRow(z, y, lowerX);
 				} else {
-					const int tmp = pos.x;
-					pos.x = pos.y;
-					pos.y = tmp;
+					src = source->voxelRow(y, lowerX, z);
+				}
+				for (int i = 0; i < width; ++i) {
+					dest[i] = *src;
+					src += stride;
 				}
-				core_assert_always(destSampler.setPosition(pos));
-				core_assert_always(destSampler.setVoxel(v));
 			}
 		}
-	}
+	});
+	// every voxel of the destination was written
+	destination->accumulateBounds(destRegion.getLowerCorner(), destRegion.getUpperCorner());
 	return destination;
 }
 
-RawVolume* mirrorAxis(const RawVolume* source, math::Axis axis) {
+RawVolume* mirrorAxis(const RawVolume* source, math::Axis axis, core::ThreadPool* threadPool) {
+	core_trace_scoped(MirrorAxis);
+	if (axis != math::Axis::X && axis != math::Axis::Y && axis != math::Axis::Z) {
+		return new RawVolume(source);
+	}
 	const voxel::Region& srcRegion = source->region();
-	RawVolume* destination = new RawVolume(source);
-	RawVolume::Sampler destSampler(destination);
-	RawVolume::Sampler srcSampler(source);
+	RawVolume* destination = new RawVolume(srcRegion);
+	destination->setBorderValue(source->borderValue());
 
 	const glm::ivec3& mins = srcRegion.getLowerCorner();
 	const glm::ivec3& maxs = srcRegion.getUpperCorner();
+	const int width = srcRegion.getWidthInVoxels();
 
-	if (axis == math::Axis::X) {
-		for (int32_t z = mins.z; z <= maxs.z; ++z) {
+	voxelutil::forEachSlab(srcRegion, threadPool, [&] (int lowerZ, int upperZ, voxelutil::SpanStats&) {
+		for (int32_t z = lowerZ; z <= upperZ; ++z) {
 			for (int32_t y = mins.y; y <= maxs.y; ++y) {
-				srcSampler.setPosition(mins.x, y, z);
-				destSampler.setPosition(maxs.x, y, z);
-				for (int32_t x = mins.x; x <= maxs.x; ++x) {
-					destSampler.setVoxel(srcSampler.voxel());
-					srcSampler.movePositiveX();
-					destSampler.moveNegativeX();
-				}
-			}
-		}
-	} else if (axis == math::Axis::Y) {
-		for (int32_t z = mins.z; z <= maxs.z; ++z) {
-			for (int32_t x = mins.x; x <= maxs.x; ++x) {
-				srcSampler.setPosition(x, mins.y, z);
-				destSampler.setPosition(x, maxs.y, z);
-				for (int32_t y = mins.y; y <= maxs.y; ++y) {
-					destSampler.setVoxel(srcSampler.voxel());
-					srcSampler.movePositiveY();
-					destSampler.moveNegativeY();
-				}
-			}
-		}
-	} else if (axis == math::Axis::Z) {
-		for (int32_t y = mins.y; y <= maxs.y; ++y) {
-			for (int32_t x = mins.x; x <= maxs.x; ++x) {
-				srcSampler.setPosition(x, y, mins.z);
-				destSampler.setPosition(x, y, maxs.z);
-				for (int32_t z = mins.z; z <= maxs.z; ++z) {
-					destSampler.setVoxel(srcSampler.voxel());
-					srcSampler.movePositiveZ();
-					destSampler.moveNegativeZ();
+				Voxel* dest = destination->voxelRow(mins.x, y, z);
+				if (axis == math::Axis::X) {
+					const Voxel* src = source->voxelRow(mins.x, y, z);
+					for (int i = 0; i < width; ++i) {
+						dest[i] = src[width - 1 - i];
+					}
+				} else if (axis == math::Axis::Y) {
+					const Voxel* src = source->voxelRow(mins.x, maxs.y - (y - mins.y), z);
+					core_memcpy((void*)dest, (const void*)src, width * sizeof(Voxel));
+				} else {
+					const Voxel* src = source->voxelRow(mins.x, y, maxs.z - (z - mins.z));
+					core_memcpy((void*)dest, (const void*)src, width * sizeof(Voxel));
 				}
 			}
 		}
-	}
+	});
+	// every voxel of the destination was written
+	destination->accumulateBounds(mins, maxs);
 	return destination;
 }
 
@@ -8,6 +8,10 @@
 #include <glm/vec3.hpp>
 #include "math/Axis.h"
 
+namespace core {
+class ThreadPool;
+}
+
 namespace voxel {
 
 class RawVolume;
@@ -20,11 +24,13 @@ extern RawVolume* rotateVolume(const RawVolume* source, const glm::vec3& angles,
 /**
  * @brief Rotate the given volume on the given axis by 90 degree. This method does not lose any voxels
  * @note The volume size might differ
+ * @param[in] threadPool Optional thread pool to rotate big volumes in parallel
  */
-extern RawVolume* rotateAxis(const RawVolume* source, math::Axis axis);
+extern RawVolume* rotateAxis(const RawVolume* source, math::Axis axis, core::ThreadPool* threadPool = nullptr);
 /**
  * @brief Mirrors the given volume on the given axis
+ * @param[in] threadPool Optional thread pool to mirror big volumes in parallel
  */
-extern RawVolume* mirrorAxis(const RawVolume* source, math::Axis axis);
+extern RawVolume* mirrorAxis(const RawVolume* source, math::Axis axis, core::ThreadPool* threadPool = nullptr);
 
 }
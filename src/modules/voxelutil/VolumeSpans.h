@@ -0,0 +1,167 @@
+/**
+ * @file
+ * @brief Building blocks for span based volume operations
+ *
+ * The voxels of a @c voxel::RawVolume are consecutive along the x axis. The operations in here work on
+ * whole x rows (spans) instead of single voxels and split big regions into slabs along the z axis that
+ * are processed in parallel.
+ */
+
+#pragma once
+
+#include "voxel/RawVolume.h"
+#include "core/concurrent/TaskGroup.h"
+#include "core/StandardLib.h"
+#include "core/Common.h"
+#include <glm/common.hpp>
+#include <limits>
+#include <vector>
+#include <string.h>
+
+namespace voxelutil {
+
+/**
+ * @brief Volumes with less voxels than this are processed in the calling thread
+ */
+static constexpr int ParallelSpanThreshold = 64 * 64 * 64;
+
+/**
+ * @brief The amount and the bounding box of the voxels that were modified by span operations
+ */
+struct SpanStats {
+	int count = 0;
+	glm::ivec3 mins { (std::numeric_limits<int>::max)() / 2 };
+	glm::ivec3 maxs { (std::numeric_limits<int>::min)() / 2 };
+
+	/**
+	 * @brief Add the modified voxels of the given inclusive x range
+	 */
+	inline void add(int lowerX, int upperX, int y, int z, int amount) {
+		if (amount <= 0) {
+			return;
+		}
+		count += amount;
+		mins = (glm::min)(mins, glm::ivec3(lowerX, y, z));
+		maxs = (glm::max)(maxs, glm::ivec3(upperX, y, z));
+	}
+
+	inline void add(const SpanStats& other) {
+		count += other.count;
+		mins = (glm::min)(mins, other.mins);
+		maxs = (glm::max)(maxs, other.maxs);
+	}
+
+	inline bool modified() const {
+		return mins.x <= maxs.x;
+	}
+
+	/**
+	 * @brief Extends the bounds of the given volume by the modified voxels
+	 */
+	inline void apply(voxel::RawVolume& volume) const {
+		if (modified()) {
+			volume.accumulateBounds(mins, maxs);
+		}
+	}
+};
+
+/**
+ * @brief Splits the z range of the region into slabs and executes them in the given thread pool
+ * @param[in] func The functor that is called with the inclusive z range of the slab and the stats of
+ * the slab: @c func(lowerZ, upperZ, stats). The slabs don't overlap - so different slabs may write
+ * different rows of the same volume.
+ * @param[in] threadPool If this is @c nullptr or the region is smaller than @c ParallelSpanThreshold
+ * the slabs are executed in the calling thread.
+ * @return The merged stats of all slabs
+ */
+template<class F>
+SpanStats forEachSlab(const voxel::Region& region, core::ThreadPool* threadPool, const F& func) {
+	const int lowerZ = region.getLowerZ();
+	const int depth = region.getDepthInVoxels();
+	SpanStats stats;
+	if (threadPool == nullptr || threadPool->size() <= 1u || depth <= 1
+		|| (int64_t)region.getWidthInVoxels() * region.getHeightInVoxels() * depth < ParallelSpanThreshold) {
+		func(lowerZ, region.getUpperZ(), stats);
+		return stats;
+	}
+	const int slabCount = core_min(depth, (int)threadPool->size() * 4);
+	const int slabDepth = (depth + slabCount - 1) / slabCount;
+	std::vector<SpanStats> slabStats((size_t)slabCount);
+	core::TaskGroup group(*threadPool);
+	for (int i = 0; i < slabCount; ++i) {
+		const int slabLowerZ = lowerZ + i * slabDepth;
+		const int slabUpperZ = core_min(region.getUpperZ(), slabLowerZ + slabDepth - 1);
+		if (slabLowerZ > slabUpperZ) {
+			break;
+		}
+		SpanStats* slab = &slabStats[i];
+		group.spawn([&func, slabLowerZ, slabUpperZ, slab] () {
+			func(slabLowerZ, slabUpperZ, *slab);
+		});
+	}
+	group.wait();
+	for (const SpanStats& slab : slabStats) {
+		stats.add(slab);
+	}
+	return stats;
+}
+
+/**
+ * @brief Copies the source span into the destination span
+ * @return The amount of modified voxels - the stats are updated with the modified range
+ */
+inline int copySpan(voxel::Voxel* dest, const voxel::Voxel* src, int amount, int x, int y, int z, SpanStats& stats) {
+	if (memcmp((const void*)dest, (const void*)src, amount * sizeof(voxel::Voxel)) == 0) {
+		return 0;
+	}
+	int first = -1;
+	int last = -1;
+	int modified = 0;
+	for (int i = 0; i < amount; ++i) {
+		if (dest[i].isSame(src[i])) {
+			continue;
+		}
+		if (first == -1) {
+			first = i;
+		}
+		last = i;
+		++modified;
+	}
+	core_memcpy((void*)dest, (const void*)src, amount * sizeof(voxel::Voxel));
+	stats.add(x + first, x + last, y, z, modified);
+	return modified;
+}
+
+/**
+ * @brief Sets all voxels of the span to the given voxel
+ * @return The amount of modified voxels - the stats are updated with the modified range
+ */
+inline int fillSpan(voxel::Voxel* dest, const voxel::Voxel& voxel, int amount, int x, int y, int z, SpanStats& stats) {
+	int first = -1;
+	int last = -1;
+	int modified = 0;
+	for (int i = 0; i < amount; ++i) {
+		if (dest[i].isSame(voxel)) {
+			continue;
+		}
+		if (first == -1) {
+			first = i;
+		}
+		last = i;
+		++modified;
+	}
+	if (modified == 0) {
+		return 0;
+	}
+	if (voxel.isSame(voxel::Voxel())) {
+		core_memset((void*)dest, 0, amount * sizeof(voxel::Voxel));
+	} else {
+		for (int i = 0; i < amount; ++i) {
+			dest[i] = voxel;
+		}
+	}
+	stats.add(x + first, x + last, y, z, modified);
+	return modified;
+}
+
+}
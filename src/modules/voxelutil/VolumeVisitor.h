@@ -39,4 +39,32 @@ int visitVolume(const Volume& volume, Visitor&& visitor, Condition condition = C
 	return cnt;
 }
 
+/**
+ * @brief Span based version for raw volumes that walks the voxel rows directly instead of looking up every
+ * single voxel.
+ * @note The visitor is called in the calling thread in the same order as for the generic version
+ */
+template<class Visitor, typename Condition = SkipEmpty>
+int visitVolume(const voxel::RawVolume& volume, Visitor&& visitor, Condition condition = Condition()) {
+	core_trace_scoped(VisitRawVolume);
+	const voxel::Region& region = volume.region();
+	const int32_t lowerX = region.getLowerX();
+	const int32_t width = region.getWidthInVoxels();
+	int cnt = 0;
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			const voxel::Voxel* row = volume.voxelRow(lowerX, y, z);
+			for (int32_t i = 0; i < width; ++i) {
+				const voxel::Voxel& voxel = row[i];
+				if (!condition(voxel)) {
+					continue;
+				}
+				visitor(lowerX + i, y, z, voxel);
+				++cnt;
+			}
+		}
+	}
+	return cnt;
+}
+
 }
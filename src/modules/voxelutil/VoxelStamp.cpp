@@ -0,0 +1,38 @@
+/**
+ * @file
+ */
+
+#include "VoxelStamp.h"
+#include "RawVolumeRotateWrapper.h"
+#include "voxel/RawVolume.h"
+#include "core/Trace.h"
+
+namespace voxelutil {
+
+VoxelStamp::VoxelStamp(const voxel::RawVolume* volume, math::Axis axis) {
+	core_trace_scoped(VoxelStampCreate);
+	const RawVolumeRotateWrapper wrapper(volume, axis);
+	_region = wrapper.region();
+	const glm::ivec3& mins = _region.getLowerCorner();
+	const glm::ivec3& maxs = _region.getUpperCorner();
+	for (int x = mins.x; x <= maxs.x; ++x) {
+		for (int z = mins.z; z <= maxs.z; ++z) {
+			int runIndex = -1;
+			for (int y = mins.y; y <= maxs.y; ++y) {
+				const voxel::Voxel& voxel = wrapper.voxel(x, y, z);
+				if (voxel::isAir(voxel.getMaterial())) {
+					runIndex = -1;
+					continue;
+				}
+				if (runIndex == -1) {
+					runIndex = (int)_runs.size();
+					_runs.push_back(Run{x, y, z, 0, (int)_voxels.size()});
+				}
+				_voxels.push_back(voxel);
+				++_runs[runIndex].length;
+			}
+		}
+	}
+}
+
+}
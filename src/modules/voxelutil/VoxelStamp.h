@@ -0,0 +1,132 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "voxel/Region.h"
+#include "voxel/Voxel.h"
+#include "math/Axis.h"
+#include <vector>
+#include <stdint.h>
+
+namespace voxel {
+class RawVolume;
+}
+
+namespace voxelutil {
+
+/**
+ * @brief Sparse copy of the solid voxels of a volume that can be placed into other volumes.
+ *
+ * The solid voxels are stored as vertical runs - one run is a consecutive column segment of
+ * non-air voxels. Placing the stamp only touches the solid voxels and writes each run as a
+ * whole via @c setVoxels() instead of visiting every voxel of the bounding box.
+ *
+ * @note The rotation is baked into the stamp - create one stamp per rotation that you need.
+ * @sa RawVolumeRotateWrapper
+ */
+class VoxelStamp {
+public:
+	struct Run {
+		int x;
+		int y;
+		int z;
+		int length;
+		/** index of the first voxel of the run in the voxel buffer */
+		int offset;
+	};
+private:
+	voxel::Region _region = voxel::Region::InvalidRegion;
+	std::vector<Run> _runs;
+	std::vector<voxel::Voxel> _voxels;
+public:
+	/**
+	 * @param[in] volume The source volume - all non-air voxels are part of the stamp
+	 * @param[in] axis The rotation that is applied to the volume - see @c RawVolumeRotateWrapper
+	 */
+	VoxelStamp(const voxel::RawVolume* volume, math::Axis axis = math::Axis::None);
+
+	/**
+	 * @return The (rotated) region of the source volume
+	 */
+	const voxel::Region& region() const;
+	const std::vector<Run>& runs() const;
+	/**
+	 * @return The amount of solid voxels in the stamp
+	 */
+	size_t size() const;
+	bool empty() const;
+
+	/**
+	 * @brief Writes the solid voxels into the given volume at the given offset. Everything outside of the
+	 * region of the target volume is clipped.
+	 * @param[out] target Any volume (wrapper) that offers @c region() and
+	 * @c setVoxels(x, y, z, nx, nz, voxels, amount) with the voxels given along the y axis
+	 * @param[in] pos The offset that is added to the stamp region
+	 * @return The amount of voxels that were written
+	 */
+	template<class Volume>
+	int place(Volume& target, const glm::ivec3& pos) const;
+};
+
+inline const voxel::Region& VoxelStamp::region() const {
+	return _region;
+}
+
+inline const std::vector<VoxelStamp::Run>& VoxelStamp::runs() const {
+	return _runs;
+}
+
+inline size_t VoxelStamp::size() const {
+	return _voxels.size();
+}
+
+inline bool VoxelStamp::empty() const {
+	return _voxels.empty();
+}
+
+template<class Volume>
+int VoxelStamp::place(Volume& target, const glm::ivec3& pos) const {
+	if (_runs.empty()) {
+		return 0;
+	}
+	const voxel::Region& targetRegion = target.region();
+	const glm::ivec3& targetMins = targetRegion.getLowerCorner();
+	const glm::ivec3& targetMaxs = targetRegion.getUpperCorner();
+	const glm::ivec3 mins = _region.getLowerCorner() + pos;
+	const glm::ivec3 maxs = _region.getUpperCorner() + pos;
+	if (maxs.x < targetMins.x || mins.x > targetMaxs.x
+	 || maxs.y < targetMins.y || mins.y > targetMaxs.y
+	 || maxs.z < targetMins.z || mins.z > targetMaxs.z) {
+		return 0;
+	}
+	int written = 0;
+	for (const Run& run : _runs) {
+		const int x = pos.x + run.x;
+		const int z = pos.z + run.z;
+		if (x < targetMins.x || x > targetMaxs.x || z < targetMins.z || z > targetMaxs.z) {
+			continue;
+		}
+		int y = pos.y + run.y;
+		int length = run.length;
+		int offset = run.offset;
+		if (y < targetMins.y) {
+			const int skip = targetMins.y - y;
+			y += skip;
+			length -= skip;
+			offset += skip;
+		}
+		if (y + length - 1 > targetMaxs.y) {
+			length = targetMaxs.y - y + 1;
+		}
+		if (length <= 0) {
+			continue;
+		}
+		target.setVoxels(x, y, z, 1, 1, &_voxels[offset], length);
+		written += length;
+	}
+	return written;
+}
+
+}
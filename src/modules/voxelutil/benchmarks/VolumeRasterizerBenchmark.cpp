@@ -0,0 +1,50 @@
+/**
+ * @file
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "core/concurrent/Concurrency.h"
+#include "voxel/MaterialColor.h"
+#include "voxel/RawVolume.h"
+#include "voxelutil/VolumeRasterizer.h"
+#include <glm/geometric.hpp>
+
+class VolumeRasterizerBenchmark : public core::AbstractBenchmark {
+public:
+	void fill(voxel::RawVolume* v) const {
+		const voxel::Region& region = v->region();
+		const glm::vec3 center(region.getCenter());
+		const float radius = (float)region.getWidthInVoxels() / 2.0f;
+		for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+					if (glm::length(glm::vec3(x, y, z) - center) <= radius) {
+						v->setVoxel(x, y, z, voxel::createColorVoxel(voxel::VoxelType::Generic, (x + y + z) % 16));
+					}
+				}
+			}
+		}
+	}
+
+	bool onInitApp() override {
+		return voxel::initDefaultMaterialColors();
+	}
+};
+
+// thumbnails per second for a sphere of the given volume size at a thumbnail size of 128x128
+BENCHMARK_DEFINE_F(VolumeRasterizerBenchmark, Render)(benchmark::State &state) {
+	voxel::RawVolume volume(voxel::Region(0, (int)state.range(0) - 1));
+	fill(&volume);
+	voxelutil::VolumeRasterizer rasterizer(core::cpus());
+	rasterizer.init();
+	std::vector<uint8_t> rgba;
+	for (auto _ : state) {
+		rasterizer.render(volume, 128, 128, rgba);
+	}
+	rasterizer.shutdown();
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_REGISTER_F(VolumeRasterizerBenchmark, Render)->RangeMultiplier(2)->Range(16, 256)->UseRealTime();
+
+BENCHMARK_MAIN();
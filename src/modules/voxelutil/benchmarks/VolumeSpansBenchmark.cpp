@@ -0,0 +1,163 @@
+/**
+ * @file
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "core/concurrent/Concurrency.h"
+#include "core/concurrent/ThreadPool.h"
+#include "voxel/MaterialColor.h"
+#include "voxel/RawVolume.h"
+#include "voxel/RawVolumeWrapper.h"
+#include "voxelutil/VolumeMerger.h"
+#include "voxelutil/VolumeRescaler.h"
+#include "voxelutil/VolumeRotator.h"
+#include "voxelutil/VolumeVisitor.h"
+#include <glm/geometric.hpp>
+#include <memory>
+
+namespace {
+
+// edge length of the volumes
+static constexpr int VolumeSize = 256;
+
+enum Mode {
+	// the generic per voxel implementation
+	PerVoxel = 0,
+	Spans = 1,
+	// span based and split into slabs that are executed in a thread pool
+	SpansParallel = 2
+};
+
+/**
+ * @brief The per voxel implementation of @c voxel::rotateAxis() as reference
+ */
+voxel::RawVolume* rotateAxisPerVoxel(const voxel::RawVolume* source) {
+	const voxel::Region& srcRegion = source->region();
+	voxel::Region destRegion = srcRegion;
+	destRegion.setLowerX(srcRegion.getLowerZ());
+	destRegion.setLowerZ(srcRegion.getLowerX());
+	destRegion.setUpperX(srcRegion.getUpperZ());
+	destRegion.setUpperZ(srcRegion.getUpperX());
+	voxel::RawVolume* destination = new voxel::RawVolume(destRegion);
+	voxel::RawVolume::Sampler destSampler(destination);
+	voxel::RawVolume::Sampler srcSampler(source);
+	for (int32_t z = srcRegion.getLowerZ(); z <= srcRegion.getUpperZ(); ++z) {
+		for (int32_t y = srcRegion.getLowerY(); y <= srcRegion.getUpperY(); ++y) {
+			for (int32_t x = srcRegion.getLowerX(); x <= srcRegion.getUpperX(); ++x) {
+				srcSampler.setPosition(x, y, z);
+				destSampler.setPosition(z, y, x);
+				destSampler.setVoxel(srcSampler.voxel());
+			}
+		}
+	}
+	return destination;
+}
+
+}
+
+class VolumeSpansBenchmark : public core::AbstractBenchmark {
+protected:
+	std::unique_ptr<voxel::RawVolume> _volume;
+	std::unique_ptr<core::ThreadPool> _threadPool;
+
+	bool onInitApp() override {
+		if (!voxel::initDefaultMaterialColors()) {
+			return false;
+		}
+		_threadPool = std::make_unique<core::ThreadPool>(core::cpus(), "VolumeSpans");
+		_threadPool->init();
+		// a sphere with a hollow core - so there are full rows, partial rows and empty rows
+		_volume = std::make_unique<voxel::RawVolume>(voxel::Region(0, VolumeSize - 1));
+		const voxel::Region& region = _volume->region();
+		const glm::vec3 center(region.getCenter());
+		const float radius = (float)VolumeSize / 2.0f;
+		for (int z = 0; z < VolumeSize; ++z) {
+			for (int y = 0; y < VolumeSize; ++y) {
+				for (int x = 0; x < VolumeSize; ++x) {
+					const float distance = glm::length(glm::vec3(x, y, z) - center);
+					if (distance <= radius && distance >= radius / 2.0f) {
+						_volume->setVoxel(x, y, z, voxel::createColorVoxel(voxel::VoxelType::Generic, (x + y + z) % 16));
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	void onCleanupApp() override {
+		_volume.reset();
+		if (_threadPool) {
+			_threadPool->shutdown(true);
+			_threadPool.reset();
+		}
+	}
+
+	core::ThreadPool* threadPool(const benchmark::State &state) const {
+		return state.range(0) == SpansParallel ? _threadPool.get() : nullptr;
+	}
+
+	void voxelsProcessed(benchmark::State &state) const {
+		state.SetItemsProcessed(state.iterations() * (int64_t)VolumeSize * VolumeSize * VolumeSize);
+	}
+};
+
+BENCHMARK_DEFINE_F(VolumeSpansBenchmark, Merge)(benchmark::State &state) {
+	voxel::RawVolume destination(_volume->region());
+	const voxel::Region& region = _volume->region();
+	for (auto _ : state) {
+		destination.clear();
+		if (state.range(0) == PerVoxel) {
+			voxel::mergeVolumes<voxel::MergeSkipEmpty, voxel::RawVolume, voxel::RawVolume>(&destination, _volume.get(), region, region);
+		} else {
+			voxel::mergeVolumes(&destination, _volume.get(), region, region, voxel::MergeSkipEmpty(), threadPool(state));
+		}
+	}
+	voxelsProcessed(state);
+}
+
+BENCHMARK_DEFINE_F(VolumeSpansBenchmark, Visit)(benchmark::State &state) {
+	int64_t cnt = 0;
+	const voxel::RawVolumeWrapper wrapper(_volume.get());
+	auto visitor = [&cnt] (int, int, int, const voxel::Voxel& voxel) {
+		cnt += voxel.getColor();
+	};
+	for (auto _ : state) {
+		if (state.range(0) == PerVoxel) {
+			voxelutil::visitVolume(wrapper, visitor);
+		} else {
+			voxelutil::visitVolume(*_volume, visitor);
+		}
+	}
+	benchmark::DoNotOptimize(cnt);
+	voxelsProcessed(state);
+}
+
+BENCHMARK_DEFINE_F(VolumeSpansBenchmark, Rescale)(benchmark::State &state) {
+	voxel::RawVolume destination(voxel::Region(0, VolumeSize / 2 - 1));
+	for (auto _ : state) {
+		if (state.range(0) == PerVoxel) {
+			voxel::rescaleVolume<voxel::RawVolume, voxel::RawVolume>(*_volume, destination);
+		} else {
+			voxel::rescaleVolume(*_volume, destination, threadPool(state));
+		}
+	}
+	voxelsProcessed(state);
+}
+
+BENCHMARK_DEFINE_F(VolumeSpansBenchmark, Rotate)(benchmark::State &state) {
+	for (auto _ : state) {
+		std::unique_ptr<voxel::RawVolume> rotated;
+		if (state.range(0) == PerVoxel) {
+			rotated.reset(rotateAxisPerVoxel(_volume.get()));
+		} else {
+			rotated.reset(voxel::rotateAxis(_volume.get(), math::Axis::Y, threadPool(state)));
+		}
+		benchmark::DoNotOptimize(rotated.get());
+	}
+	voxelsProcessed(state);
+}
+
+BENCHMARK_REGISTER_F(VolumeSpansBenchmark, Merge)->ArgName("mode")->Arg(PerVoxel)->Arg(Spans)->Arg(SpansParallel)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_REGISTER_F(VolumeSpansBenchmark, Visit)->ArgName("mode")->Arg(PerVoxel)->Arg(Spans)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_REGISTER_F(VolumeSpansBenchmark, Rescale)->ArgName("mode")->Arg(PerVoxel)->Arg(Spans)->Arg(SpansParallel)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_REGISTER_F(VolumeSpansBenchmark, Rotate)->ArgName("mode")->Arg(PerVoxel)->Arg(Spans)->Arg(SpansParallel)->Unit(benchmark::kMillisecond)->UseRealTime();
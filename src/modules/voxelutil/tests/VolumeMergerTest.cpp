@@ -4,6 +4,7 @@
 
 #include "voxel/tests/AbstractVoxelTest.h"
 #include "voxelutil/VolumeMerger.h"
+#include "voxel/RawVolumeWrapper.h"
 
 namespace voxel {
 
@@ -57,4 +58,22 @@ TEST_F(VolumeMergerTest, testOffsets) {
 	ASSERT_EQ(smallVolume.voxel(regionSmall.getUpperCorner()), createVoxel(voxel::VoxelType::Grass, 0)) << smallVolume << ", " << bigVolume;
 }
 
+TEST_F(VolumeMergerTest, testModifiedCount) {
+	const voxel::Region region(0, 3);
+	voxel::RawVolume source(region);
+	ASSERT_TRUE(source.setVoxel(1, 1, 1, createVoxel(voxel::VoxelType::Grass, 0)));
+	ASSERT_TRUE(source.setVoxel(2, 2, 2, createVoxel(voxel::VoxelType::Rock, 0)));
+	voxel::RawVolume raw(region);
+	voxel::RawVolume wrapped(region);
+	voxel::RawVolumeWrapper wrapper(&wrapped);
+	// both versions count the modified voxels - no matter what the destination returns for setVoxel()
+	EXPECT_EQ(2, voxel::mergeVolumes(&raw, &source, region, region));
+	EXPECT_EQ(2, voxel::mergeVolumes(&wrapper, &source, region, region));
+	EXPECT_EQ(0, voxel::mergeVolumes(&raw, &source, region, region));
+	EXPECT_EQ(0, voxel::mergeVolumes(&wrapper, &source, region, region));
+	// merging the air voxels doesn't modify anything either
+	EXPECT_EQ(0, voxel::mergeVolumes(&raw, &source, region, region, voxel::MergeAll()));
+	EXPECT_EQ(0, voxel::mergeVolumes(&wrapper, &source, region, region, voxel::MergeAll()));
+}
+
 }
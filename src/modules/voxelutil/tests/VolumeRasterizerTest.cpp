@@ -0,0 +1,60 @@
+/**
+ * @file
+ */
+
+#include "voxel/tests/AbstractVoxelTest.h"
+#include "voxelutil/VolumeRasterizer.h"
+
+namespace voxelutil {
+
+class VolumeRasterizerTest: public voxel::AbstractVoxelTest {
+protected:
+	const uint8_t* pixel(const std::vector<uint8_t>& rgba, int width, int x, int y) const {
+		return &rgba[((size_t)y * width + x) * 4u];
+	}
+};
+
+TEST_F(VolumeRasterizerTest, testEmptyVolume) {
+	voxel::RawVolume volume(voxel::Region(0, 7));
+	VolumeRasterizer rasterizer(2);
+	rasterizer.init();
+	std::vector<uint8_t> rgba;
+	ASSERT_TRUE(rasterizer.render(volume, 64, 48, rgba));
+	ASSERT_EQ(64u * 48u * 4u, rgba.size());
+	for (size_t i = 3; i < rgba.size(); i += 4) {
+		ASSERT_EQ(0u, rgba[i]) << "Expected transparent pixels for an empty volume";
+	}
+	rasterizer.shutdown();
+}
+
+TEST_F(VolumeRasterizerTest, testFilledVolume) {
+	const voxel::Region region(0, 7);
+	voxel::RawVolume volume(region);
+	const voxel::Voxel voxel = voxel::createColorVoxel(voxel::VoxelType::Generic, 1);
+	for (int x = 0; x <= 7; ++x) {
+		for (int y = 0; y <= 7; ++y) {
+			for (int z = 0; z <= 7; ++z) {
+				volume.setVoxel(x, y, z, voxel);
+			}
+		}
+	}
+	VolumeRasterizer rasterizer(2);
+	rasterizer.init();
+	const int size = 100;
+	std::vector<uint8_t> rgba;
+	ASSERT_TRUE(rasterizer.render(volume, size, size, rgba));
+	// the volume is fit into the image - the center is covered, the corners are not
+	EXPECT_EQ(255u, pixel(rgba, size, size / 2, size / 2)[3]);
+	EXPECT_EQ(0u, pixel(rgba, size, 0, 0)[3]);
+	EXPECT_EQ(0u, pixel(rgba, size, size - 1, size - 1)[3]);
+
+	// the top face is lit by the light from above and brighter than the side faces
+	const uint8_t* top = pixel(rgba, size, size / 2, size / 4);
+	const uint8_t* side = pixel(rgba, size, size / 2, size * 3 / 4);
+	ASSERT_EQ(255u, top[3]);
+	ASSERT_EQ(255u, side[3]);
+	EXPECT_GT(top[0] + top[1] + top[2], side[0] + side[1] + side[2]);
+	rasterizer.shutdown();
+}
+
+}
@@ -0,0 +1,215 @@
+/**
+ * @file
+ */
+
+#include "voxel/tests/AbstractVoxelTest.h"
+#include "voxel/RawVolumeWrapper.h"
+#include "voxelutil/VolumeSpans.h"
+#include "voxelutil/VolumeMerger.h"
+#include "voxelutil/VolumeVisitor.h"
+#include "voxelutil/VolumeRescaler.h"
+#include "voxelutil/VolumeRotator.h"
+#include "voxelutil/VolumeCropper.h"
+#include "core/concurrent/ThreadPool.h"
+#include <memory>
+#include <vector>
+
+namespace voxel {
+
+class VolumeSpansTest: public AbstractVoxelTest {
+protected:
+	// big enough to be split into slabs
+	const voxel::Region _bigRegion { glm::ivec3(-5, 0, -3), glm::ivec3(74, 49, 76) };
+	std::unique_ptr<core::ThreadPool> _threadPool;
+
+	void SetUp() override {
+		AbstractVoxelTest::SetUp();
+		_threadPool = std::make_unique<core::ThreadPool>(4, "VolumeSpansTest");
+		_threadPool->init();
+	}
+
+	void TearDown() override {
+		_threadPool->shutdown(true);
+		_threadPool.reset();
+		AbstractVoxelTest::TearDown();
+	}
+
+	void fill(voxel::RawVolume& volume) {
+		const voxel::Region& region = volume.region();
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					if (_random.random(0, 2) == 0) {
+						continue;
+					}
+					volume.setVoxel(x, y, z, createVoxel(VoxelType::Generic, _random.random(0, 255)));
+				}
+			}
+		}
+	}
+
+	::testing::AssertionResult same(const voxel::RawVolume& expected, const voxel::RawVolume& volume) const {
+		if (expected.region() != volume.region()) {
+			return ::testing::AssertionFailure() << "regions differ " << expected.region() << " and " << volume.region();
+		}
+		const voxel::Region& region = expected.region();
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					const voxel::Voxel& v1 = expected.voxel(x, y, z);
+					const voxel::Voxel& v2 = volume.voxel(x, y, z);
+					if (!v1.isSame(v2)) {
+						return ::testing::AssertionFailure() << "voxel differs at " << x << ":" << y << ":" << z << " " << v1 << " " << v2;
+					}
+				}
+			}
+		}
+		if (expected.mins() != volume.mins() || expected.maxs() != volume.maxs()) {
+			return ::testing::AssertionFailure() << "bounds differ " << glm::to_string(expected.mins()) << " - " << glm::to_string(expected.maxs())
+					<< " and " << glm::to_string(volume.mins()) << " - " << glm::to_string(volume.maxs());
+		}
+		return ::testing::AssertionSuccess();
+	}
+};
+
+TEST_F(VolumeSpansTest, testForEachSlab) {
+	std::vector<int> visited(_bigRegion.getDepthInVoxels(), 0);
+	const voxelutil::SpanStats& stats = voxelutil::forEachSlab(_bigRegion, _threadPool.get(), [&] (int lowerZ, int upperZ, voxelutil::SpanStats& slabStats) {
+		for (int z = lowerZ; z <= upperZ; ++z) {
+			++visited[z - _bigRegion.getLowerZ()];
+			slabStats.add(0, 1, 0, z, 2);
+		}
+	});
+	for (int v : visited) {
+		EXPECT_EQ(1, v);
+	}
+	EXPECT_EQ(_bigRegion.getDepthInVoxels() * 2, stats.count);
+	EXPECT_EQ(_bigRegion.getLowerZ(), stats.mins.z);
+	EXPECT_EQ(_bigRegion.getUpperZ(), stats.maxs.z);
+}
+
+TEST_F(VolumeSpansTest, testMerge) {
+	voxel::RawVolume source(_bigRegion);
+	fill(source);
+	// the destination is partially outside of the destination volume
+	const voxel::Region destVolumeRegion(glm::ivec3(0), glm::ivec3(63));
+	const voxel::Region destRegion(glm::ivec3(10, -4, 3), glm::ivec3(10, -4, 3) + _bigRegion.getDimensionsInCells());
+	voxel::RawVolume expected(destVolumeRegion);
+	voxel::RawVolume merged(destVolumeRegion);
+	voxel::Region clipped = destRegion;
+	clipped.cropTo(destVolumeRegion);
+	const voxel::Region srcRegion(clipped.getLowerCorner() - destRegion.getLowerCorner() + _bigRegion.getLowerCorner(),
+			clipped.getUpperCorner() - destRegion.getLowerCorner() + _bigRegion.getLowerCorner());
+	const int expectedCnt = voxel::mergeVolumes<MergeSkipEmpty, RawVolume, RawVolume>(&expected, &source, clipped, srcRegion);
+	EXPECT_EQ(expectedCnt, voxel::mergeVolumes(&merged, &source, destRegion, _bigRegion, MergeSkipEmpty(), _threadPool.get()));
+	EXPECT_TRUE(same(expected, merged));
+	// nothing changes on a second merge
+	EXPECT_EQ(0, voxel::mergeVolumes(&merged, &source, destRegion, _bigRegion, MergeSkipEmpty(), _threadPool.get()));
+}
+
+TEST_F(VolumeSpansTest, testMergeAll) {
+	voxel::RawVolume source(_bigRegion);
+	fill(source);
+	voxel::RawVolume expected(_bigRegion);
+	voxel::RawVolume merged(_bigRegion);
+	expected.setVoxel(_bigRegion.getCenter(), createVoxel(VoxelType::Rock, 1));
+	merged.setVoxel(_bigRegion.getCenter(), createVoxel(VoxelType::Rock, 1));
+	const int expectedCnt = voxel::mergeVolumes<MergeAll, RawVolume, RawVolume>(&expected, &source, _bigRegion, _bigRegion);
+	EXPECT_EQ(expectedCnt, voxel::mergeVolumes(&merged, &source, _bigRegion, _bigRegion, MergeAll(), _threadPool.get()));
+	EXPECT_TRUE(same(expected, merged));
+}
+
+TEST_F(VolumeSpansTest, testVisit) {
+	voxel::RawVolume volume(_bigRegion);
+	fill(volume);
+	std::vector<glm::ivec3> expected;
+	std::vector<glm::ivec3> visited;
+	const voxel::RawVolumeWrapper wrapper(&volume);
+	const int expectedCnt = voxelutil::visitVolume(wrapper, [&] (int x, int y, int z, const voxel::Voxel&) {
+		expected.emplace_back(x, y, z);
+	});
+	EXPECT_EQ(expectedCnt, voxelutil::visitVolume(volume, [&] (int x, int y, int z, const voxel::Voxel&) {
+		visited.emplace_back(x, y, z);
+	}));
+	EXPECT_EQ(expected, visited);
+}
+
+TEST_F(VolumeSpansTest, testRescale) {
+	voxel::RawVolume source(_bigRegion);
+	fill(source);
+	const voxel::Region destRegion(_bigRegion.getLowerCorner(), _bigRegion.getLowerCorner() + _bigRegion.getDimensionsInCells() / 2);
+	voxel::RawVolume expected(destRegion);
+	voxel::RawVolume rescaled(destRegion);
+	voxel::rescaleVolume<RawVolume, RawVolume>(source, _bigRegion, expected, destRegion);
+	voxel::rescaleVolume(source, rescaled, _threadPool.get());
+	EXPECT_TRUE(same(expected, rescaled));
+}
+
+TEST_F(VolumeSpansTest, testRotateAxis) {
+	const voxel::Region region(glm::ivec3(-2, 3, 1), glm::ivec3(5, 7, 11));
+	voxel::RawVolume source(region);
+	fill(source);
+	const math::Axis axes[] = {math::Axis::X, math::Axis::Y, math::Axis::Z};
+	for (math::Axis axis : axes) {
+		std::unique_ptr<voxel::RawVolume> rotated(voxel::rotateAxis(&source, axis, _threadPool.get()));
+		ASSERT_NE(nullptr, rotated);
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					glm::ivec3 pos(x, y, z);
+					if (axis == math::Axis::X) {
+						pos = glm::ivec3(x, z, y);
+					} else if (axis == math::Axis::Y) {
+						pos = glm::ivec3(z, y, x);
+					} else {
+						pos = glm::ivec3(y, x, z);
+					}
+					ASSERT_TRUE(source.voxel(x, y, z).isSame(rotated->voxel(pos))) << "axis " << (int)axis << " at " << glm::to_string(pos);
+				}
+			}
+		}
+	}
+}
+
+TEST_F(VolumeSpansTest, testMirrorAxis) {
+	voxel::RawVolume source(_bigRegion);
+	fill(source);
+	const glm::ivec3& mins = _bigRegion.getLowerCorner();
+	const glm::ivec3& maxs = _bigRegion.getUpperCorner();
+	const math::Axis axes[] = {math::Axis::X, math::Axis::Y, math::Axis::Z};
+	for (math::Axis axis : axes) {
+		std::unique_ptr<voxel::RawVolume> mirrored(voxel::mirrorAxis(&source, axis, _threadPool.get()));
+		ASSERT_NE(nullptr, mirrored);
+		for (int z = mins.z; z <= maxs.z; ++z) {
+			for (int y = mins.y; y <= maxs.y; ++y) {
+				for (int x = mins.x; x <= maxs.x; ++x) {
+					glm::ivec3 pos(x, y, z);
+					if (axis == math::Axis::X) {
+						pos.x = maxs.x - (x - mins.x);
+					} else if (axis == math::Axis::Y) {
+						pos.y = maxs.y - (y - mins.y);
+					} else {
+						pos.z = maxs.z - (z - mins.z);
+					}
+					ASSERT_TRUE(source.voxel(x, y, z).isSame(mirrored->voxel(pos))) << "axis " << (int)axis << " at " << glm::to_string(pos);
+				}
+			}
+		}
+	}
+}
+
+TEST_F(VolumeSpansTest, testCrop) {
+	voxel::RawVolume volume(_bigRegion);
+	volume.setVoxel(3, 4, 5, createVoxel(VoxelType::Rock, 1));
+	volume.setVoxel(40, 7, 60, createVoxel(VoxelType::Rock, 2));
+	// the bounds of the volume are bigger than the box of the solid voxels
+	volume.setVoxel(0, 0, 0, createVoxel(VoxelType::Rock, 2));
+	volume.setVoxel(0, 0, 0, voxel::Voxel());
+	std::unique_ptr<voxel::RawVolume> cropped(voxel::cropVolume(&volume, CropSkipEmpty(), _threadPool.get()));
+	ASSERT_NE(nullptr, cropped);
+	EXPECT_EQ(glm::ivec3(3, 4, 5), cropped->region().getLowerCorner());
+	EXPECT_EQ(glm::ivec3(40, 7, 60), cropped->region().getUpperCorner());
+	EXPECT_TRUE(cropped->voxel(40, 7, 60).isSame(createVoxel(VoxelType::Rock, 2)));
+}
+
+}
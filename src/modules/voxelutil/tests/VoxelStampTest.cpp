@@ -0,0 +1,103 @@
+/**
+ * @file
+ */
+
+#include "voxel/tests/AbstractVoxelTest.h"
+#include "voxel/RawVolumeWrapper.h"
+#include "voxelutil/VoxelStamp.h"
+#include "voxelutil/RawVolumeRotateWrapper.h"
+
+namespace voxel {
+
+class VoxelStampTest: public AbstractVoxelTest {
+protected:
+	/**
+	 * @brief Fills a volume with columns of different height and some holes in the columns
+	 */
+	void fill(voxel::RawVolume& volume) const {
+		const voxel::Region& region = volume.region();
+		for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+			for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+				const int height = (x * 3 + z) % region.getHeightInVoxels();
+				for (int y = region.getLowerY(); y < region.getLowerY() + height; ++y) {
+					if ((x + y + z) % 5 == 0) {
+						continue;
+					}
+					volume.setVoxel(x, y, z, createVoxel(VoxelType::Leaf, (x + y + z) % 16));
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Reference implementation that copies voxel by voxel
+	 */
+	void copy(voxel::RawVolume& target, const voxelutil::RawVolumeRotateWrapper& source, const glm::ivec3& pos) const {
+		const voxel::Region& region = source.region();
+		const voxel::Region& targetRegion = target.region();
+		for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+					const glm::ivec3 p(pos.x + x, pos.y + y, pos.z + z);
+					if (!targetRegion.containsPoint(p)) {
+						continue;
+					}
+					const voxel::Voxel& voxel = source.voxel(x, y, z);
+					if (voxel::isAir(voxel.getMaterial())) {
+						continue;
+					}
+					target.setVoxel(p, voxel);
+				}
+			}
+		}
+	}
+};
+
+TEST_F(VoxelStampTest, testRuns) {
+	voxel::RawVolume volume(voxel::Region(0, 3));
+	volume.setVoxel(1, 0, 1, createVoxel(VoxelType::Wood, 0));
+	volume.setVoxel(1, 1, 1, createVoxel(VoxelType::Wood, 0));
+	volume.setVoxel(1, 3, 1, createVoxel(VoxelType::Leaf, 0));
+	volume.setVoxel(2, 3, 2, createVoxel(VoxelType::Leaf, 0));
+	const voxelutil::VoxelStamp stamp(&volume);
+	EXPECT_EQ(4u, stamp.size());
+	ASSERT_EQ(3u, stamp.runs().size());
+	EXPECT_EQ(2, stamp.runs()[0].length);
+	EXPECT_EQ(0, stamp.runs()[0].y);
+	EXPECT_EQ(1, stamp.runs()[1].length);
+	EXPECT_EQ(3, stamp.runs()[1].y);
+	EXPECT_EQ(volume.region(), stamp.region());
+}
+
+TEST_F(VoxelStampTest, testEmpty) {
+	voxel::RawVolume volume(voxel::Region(0, 3));
+	const voxelutil::VoxelStamp stamp(&volume);
+	EXPECT_TRUE(stamp.empty());
+	voxel::RawVolume target(voxel::Region(0, 7));
+	voxel::RawVolumeWrapper wrapper(&target);
+	EXPECT_EQ(0, stamp.place(wrapper, glm::ivec3(0)));
+}
+
+TEST_F(VoxelStampTest, testPlaceMatchesRotatedCopy) {
+	voxel::RawVolume volume(voxel::Region(glm::ivec3(-2, 0, -3), glm::ivec3(4, 9, 2)));
+	fill(volume);
+	const math::Axis axes[] = {math::Axis::None, math::Axis::X, math::Axis::Y, math::Axis::Z};
+	// the offsets move the stamp partially out of the target region in all directions
+	const glm::ivec3 offsets[] = {glm::ivec3(8), glm::ivec3(0), glm::ivec3(-3, 2, 14), glm::ivec3(13, -4, 1), glm::ivec3(100)};
+	const voxel::Region targetRegion(0, 15);
+	for (math::Axis axis : axes) {
+		const voxelutil::VoxelStamp stamp(&volume, axis);
+		const voxelutil::RawVolumeRotateWrapper rotateWrapper(&volume, axis);
+		EXPECT_EQ(rotateWrapper.region(), stamp.region());
+		for (const glm::ivec3& offset : offsets) {
+			voxel::RawVolume expected(targetRegion);
+			copy(expected, rotateWrapper, offset);
+			voxel::RawVolume placed(targetRegion);
+			voxel::RawVolumeWrapper wrapper(&placed);
+			stamp.place(wrapper, offset);
+			EXPECT_TRUE(expected == placed) << "axis " << (int)axis << ", offset " << glm::to_string(offset);
+		}
+	}
+}
+
+}
@@ -50,6 +50,8 @@ bool TreeVolumeCache::init() {
 void TreeVolumeCache::shutdown() {
 	_volumeCache = voxelformat::VolumeCachePtr();
 	_treeTypeCount.clear();
+	core::ScopedLock lock(_stampMutex);
+	_stamps.clear();
 }
 
 voxel::RawVolume* TreeVolumeCache::loadTree(const glm::ivec3& treePos, const char *treeType) {
@@ -69,4 +71,31 @@ voxel::RawVolume* TreeVolumeCache::loadTree(const glm::ivec3& treePos, const cha
 	return _volumeCache->loadVolume(filename);
 }
 
-}
\ No newline at end of file
+const voxelutil::VoxelStamp* TreeVolumeCache::loadTreeStamp(const glm::ivec3& treePos, const char *treeType, math::Axis axis) {
+	const voxel::RawVolume* v = loadTree(treePos, treeType);
+	if (v == nullptr) {
+		return nullptr;
+	}
+	int rotation = 0;
+	if (axis == math::Axis::X) {
+		rotation = 1;
+	} else if (axis == math::Axis::Y) {
+		rotation = 2;
+	} else if (axis == math::Axis::Z) {
+		rotation = 3;
+	}
+	core::ScopedLock lock(_stampMutex);
+	auto i = _stamps.find(v);
+	if (i == _stamps.end()) {
+		_stamps.put(v, Stamps());
+		i = _stamps.find(v);
+	}
+	std::shared_ptr<voxelutil::VoxelStamp>& stamp = i->value.rotations[rotation];
+	if (!stamp) {
+		stamp = std::make_shared<voxelutil::VoxelStamp>(v, axis);
+		Log::debug("Created stamp for %s tree with %i runs and %i voxels", treeType, (int)stamp->runs().size(), (int)stamp->size());
+	}
+	return stamp.get();
+}
+
+}
@@ -5,8 +5,14 @@
 #pragma once
 
 #include "voxelformat/VolumeCache.h"
+#include "voxelutil/VoxelStamp.h"
 #include "core/collection/StringMap.h"
+#include "core/collection/HashMap.h"
+#include "core/concurrent/Lock.h"
+#include "core/Trace.h"
+#include "math/Axis.h"
 #include <glm/fwd.hpp>
+#include <memory>
 
 namespace voxelworld {
 
@@ -15,6 +21,13 @@ private:
 	core::StringMap<int> _treeTypeCount;
 
 	voxelformat::VolumeCachePtr _volumeCache;
+
+	// one stamp per rotation (none, x, y, z) of a tree volume
+	struct Stamps {
+		std::shared_ptr<voxelutil::VoxelStamp> rotations[4];
+	};
+	core::HashMap<const voxel::RawVolume*, Stamps, std::hash<const voxel::RawVolume*>> _stamps;
+	core_trace_mutex(core::Lock, _stampMutex, "TreeVolumeCache");
 public:
 	TreeVolumeCache(const voxelformat::VolumeCachePtr& volumeCache);
 
@@ -30,6 +43,14 @@ public:
 	 * @return voxel::RawVolume or @c nullptr if no tree volume was found for the given tree type.
 	 */
 	voxel::RawVolume* loadTree(const glm::ivec3& treePos, const char *treeType);
+
+	/**
+	 * @brief Same as @c loadTree() but returns the sparse stamp of the tree volume that is rotated by
+	 * the given axis. The stamps are created once per volume and rotation.
+	 * @return voxelutil::VoxelStamp or @c nullptr if no tree volume was found for the given tree type.
+	 * The cache keeps the ownership.
+	 */
+	const voxelutil::VoxelStamp* loadTreeStamp(const glm::ivec3& treePos, const char *treeType, math::Axis axis);
 };
 
 }
\ No newline at end of file
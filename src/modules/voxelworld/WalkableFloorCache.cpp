@@ -0,0 +1,298 @@
+/**
+ * @file
+ */
+
+#include "WalkableFloorCache.h"
+#include "core/Assert.h"
+#include "core/Common.h"
+
+namespace voxelworld {
+
+WalkableFloorCache::WalkableFloorCache(size_t maxTiles) :
+		_maxTiles(core_max(maxTiles, (size_t)1u)) {
+}
+
+void WalkableFloorCache::init(int tileSideLength) {
+	core_assert_msg(tileSideLength > 0 && (tileSideLength & (tileSideLength - 1)) == 0, "Tile side length must be a power of two");
+	core::ScopedLock lock(_lock);
+	_tiles.clear();
+	_tileSideLength = tileSideLength;
+	_tileSideLengthPower = 0;
+	while ((1 << _tileSideLengthPower) < tileSideLength) {
+		++_tileSideLengthPower;
+	}
+}
+
+void WalkableFloorCache::shutdown() {
+	clear();
+}
+
+void WalkableFloorCache::clear() {
+	core::ScopedLock lock(_lock);
+	_tiles.clear();
+}
+
+size_t WalkableFloorCache::tiles() const {
+	core::ScopedLock lock(_lock);
+	return _tiles.size();
+}
+
+bool WalkableFloorCache::hasTile(int x, int z) const {
+	core::ScopedLock lock(_lock);
+	return _tiles.hasKey(tileKey(x, z));
+}
+
+uint64_t WalkableFloorCache::tileKey(int x, int z) const {
+	// arithmetic shift - rounds towards negative infinity
+	const int32_t tileX = x >> _tileSideLengthPower;
+	const int32_t tileZ = z >> _tileSideLengthPower;
+	return ((uint64_t)(uint32_t)tileX << 32) | (uint64_t)(uint32_t)tileZ;
+}
+
+int WalkableFloorCache::columnIndex(int x, int z) const {
+	const int mask = _tileSideLength - 1;
+	return (z & mask) * _tileSideLength + (x & mask);
+}
+
+void WalkableFloorCache::Tile::setColumn(int index, const std::vector<Surface>& columnSurfaces) {
+	const uint32_t amount = (uint32_t)columnSurfaces.size();
+	if (amount <= counts[index]) {
+		// reuse the slots of the column
+		unused += counts[index] - amount;
+	} else {
+		unused += counts[index];
+		offsets[index] = (uint32_t)surfaces.size();
+		surfaces.resize(surfaces.size() + amount);
+	}
+	counts[index] = (uint8_t)amount;
+	for (uint32_t i = 0u; i < amount; ++i) {
+		surfaces[offsets[index] + i] = columnSurfaces[i];
+	}
+	if (unused <= surfaces.size() / 2) {
+		return;
+	}
+	// compact the surfaces if more than half of them are no longer referenced
+	std::vector<Surface> compacted;
+	compacted.reserve(surfaces.size() - unused);
+	for (size_t i = 0u; i < counts.size(); ++i) {
+		const uint32_t offset = offsets[i];
+		offsets[i] = (uint32_t)compacted.size();
+		compacted.insert(compacted.end(), surfaces.begin() + offset, surfaces.begin() + offset + counts[i]);
+	}
+	surfaces = std::move(compacted);
+	unused = 0u;
+}
+
+template<class VoxelAt>
+void WalkableFloorCache::collectSurfaces(const VoxelAt& voxelAt, std::vector<Surface>& surfaces) {
+	surfaces.clear();
+	int lower = -1;
+	voxel::Voxel previous;
+	for (int y = 0; y <= voxel::MAX_HEIGHT; ++y) {
+		const voxel::Voxel& voxel = voxelAt(y);
+		const bool solid = !voxel::isEnterable(voxel.getMaterial());
+		if (solid && lower == -1) {
+			lower = y;
+		} else if (!solid && lower != -1) {
+			surfaces.push_back(Surface{(uint8_t)lower, (uint8_t)(y - 1), previous, voxel});
+			lower = -1;
+		}
+		previous = voxel;
+	}
+	if (lower != -1) {
+		// there is no walkable voxel above this run in the height range
+		surfaces.push_back(Surface{(uint8_t)lower, (uint8_t)voxel::MAX_HEIGHT, previous, voxel::Voxel()});
+	}
+}
+
+void WalkableFloorCache::collectSurfaces(voxel::PagedVolume::Sampler& sampler, int x, int z, std::vector<Surface>& surfaces) {
+	sampler.setPosition(x, 0, z);
+	collectSurfaces([&sampler] (int y) {
+		if (y > 0) {
+			sampler.movePositiveY();
+		}
+		return sampler.voxel();
+	}, surfaces);
+}
+
+void WalkableFloorCache::putTile(uint64_t key, const TilePtr& tile) {
+	tile->lastAccessed = ++_timestamper;
+	_tiles.put(key, tile);
+	if (_tiles.size() <= _maxTiles) {
+		return;
+	}
+	auto oldest = _tiles.end();
+	for (auto i = _tiles.begin(); i != _tiles.end(); ++i) {
+		if (oldest == _tiles.end() || i->value->lastAccessed < oldest->value->lastAccessed) {
+			oldest = i;
+		}
+	}
+	_tiles.erase(oldest);
+}
+
+void WalkableFloorCache::onPageIn(const voxel::PagedVolume::PagerContext& ctx) {
+	const voxel::Region& region = ctx.region;
+	if (_tileSideLength <= 0) {
+		return;
+	}
+	if (region.getLowerY() > 0 || region.getUpperY() < voxel::MAX_HEIGHT) {
+		if (region.getLowerY() > voxel::MAX_HEIGHT || region.getUpperY() < 0) {
+			return;
+		}
+		// the surfaces of chunks that don't cover the whole height are collected on the next query - the
+		// chunk might have been paged out before and the cached tile might no longer match the chunk data
+		core::ScopedLock lock(_lock);
+		_tiles.remove(tileKey(region.getLowerX(), region.getLowerZ()));
+		return;
+	}
+	core_assert(region.getWidthInVoxels() == _tileSideLength);
+	core_trace_scoped(WalkableFloorCachePageIn);
+	const voxel::PagedVolume::Chunk* chunk = ctx.chunk.get();
+	const int lowerY = region.getLowerY();
+	TilePtr tile = std::make_shared<Tile>();
+	const int columns = _tileSideLength * _tileSideLength;
+	tile->offsets.resize(columns);
+	tile->counts.resize(columns);
+	std::vector<Surface> columnSurfaces;
+	for (int z = 0; z < _tileSideLength; ++z) {
+		for (int x = 0; x < _tileSideLength; ++x) {
+			collectSurfaces([=] (int y) -> const voxel::Voxel& {
+				return chunk->voxel(x, y - lowerY, z);
+			}, columnSurfaces);
+			const int index = z * _tileSideLength + x;
+			tile->offsets[index] = (uint32_t)tile->surfaces.size();
+			tile->counts[index] = (uint8_t)columnSurfaces.size();
+			tile->surfaces.insert(tile->surfaces.end(), columnSurfaces.begin(), columnSurfaces.end());
+		}
+	}
+	core::ScopedLock lock(_lock);
+	putTile(tileKey(region.getLowerX(), region.getLowerZ()), tile);
+}
+
+void WalkableFloorCache::cacheTile(const voxel::PagedVolume* volume, int x, int z) {
+	core_assert(_tileSideLength > 0);
+	core_trace_scoped(WalkableFloorCacheTile);
+	const int mask = _tileSideLength - 1;
+	const int lowerX = x & ~mask;
+	const int lowerZ = z & ~mask;
+	const int columns = _tileSideLength * _tileSideLength;
+	voxel::PagedVolume::Sampler sampler(volume);
+	std::vector<Surface> columnSurfaces;
+	for (int attempt = 0; attempt < MaxReadAttempts; ++attempt) {
+		uint32_t version;
+		{
+			core::ScopedLock lock(_lock);
+			version = _version;
+		}
+		TilePtr tile = std::make_shared<Tile>();
+		tile->offsets.resize(columns);
+		tile->counts.resize(columns);
+		for (int tz = 0; tz < _tileSideLength; ++tz) {
+			for (int tx = 0; tx < _tileSideLength; ++tx) {
+				collectSurfaces(sampler, lowerX + tx, lowerZ + tz, columnSurfaces);
+				const int index = tz * _tileSideLength + tx;
+				tile->offsets[index] = (uint32_t)tile->surfaces.size();
+				tile->counts[index] = (uint8_t)columnSurfaces.size();
+				tile->surfaces.insert(tile->surfaces.end(), columnSurfaces.begin(), columnSurfaces.end());
+			}
+		}
+		core::ScopedLock lock(_lock);
+		// a column that was modified while the volume was read might not be part of the tile
+		if (version == _version) {
+			putTile(tileKey(x, z), tile);
+			return;
+		}
+	}
+	// the tile is not cached - the next query tries again
+}
+
+void WalkableFloorCache::updateColumn(const voxel::PagedVolume* volume, int x, int z) {
+	const uint64_t key = tileKey(x, z);
+	uint32_t version;
+	{
+		core::ScopedLock lock(_lock);
+		// the tiles that are read from the volume right now must notice the modification - even if
+		// they are not cached yet
+		version = ++_version;
+		if (!_tiles.hasKey(key)) {
+			return;
+		}
+	}
+	voxel::PagedVolume::Sampler sampler(volume);
+	std::vector<Surface> columnSurfaces;
+	for (int attempt = 0; attempt < MaxReadAttempts; ++attempt) {
+		collectSurfaces(sampler, x, z, columnSurfaces);
+		core::ScopedLock lock(_lock);
+		auto i = _tiles.find(key);
+		if (i == _tiles.end()) {
+			return;
+		}
+		// another update might have read this column before us but would overwrite our surfaces
+		if (version == _version) {
+			i->value->setColumn(columnIndex(x, z), columnSurfaces);
+			return;
+		}
+		version = _version;
+	}
+	// the tile is collected again on the next query
+	core::ScopedLock lock(_lock);
+	_tiles.remove(key);
+}
+
+void WalkableFloorCache::updateRegion(const voxel::PagedVolume* volume, const voxel::Region& region) {
+	if (region.getLowerY() > voxel::MAX_HEIGHT || region.getUpperY() < 0) {
+		return;
+	}
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+			updateColumn(volume, x, z);
+		}
+	}
+}
+
+bool WalkableFloorCache::findWalkableFloor(const glm::ivec3& position, int maxDistanceUpwards, voxelutil::FloorTraceResult& result) {
+	if (position.y < 0 || position.y > voxel::MAX_HEIGHT) {
+		return false;
+	}
+	core::ScopedLock lock(_lock);
+	if (_tileSideLength <= 0) {
+		return false;
+	}
+	auto i = _tiles.find(tileKey(position.x, position.z));
+	if (i == _tiles.end()) {
+		return false;
+	}
+	Tile* tile = i->value.get();
+	tile->lastAccessed = ++_timestamper;
+	const int index = columnIndex(position.x, position.z);
+	const Surface* surfaces = tile->surfaces.data() + tile->offsets[index];
+	const int amount = tile->counts[index];
+	const Surface* below = nullptr;
+	for (int s = 0; s < amount; ++s) {
+		const Surface& surface = surfaces[s];
+		if (surface.lower > position.y) {
+			break;
+		}
+		if (surface.upper < position.y) {
+			below = &surface;
+			continue;
+		}
+		// the position is inside of the solid run - the walkable level is above the run
+		const int maxDistance = core_min(maxDistanceUpwards, voxel::MAX_HEIGHT - position.y);
+		if (surface.upper < voxel::MAX_HEIGHT && surface.upper + 1 - position.y <= maxDistance) {
+			result = voxelutil::FloorTraceResult(surface.upper + 1, surface.above);
+		} else {
+			result = voxelutil::FloorTraceResult();
+		}
+		return true;
+	}
+	// the position is enterable - the walkable level is on top of the next run below
+	if (below != nullptr) {
+		result = voxelutil::FloorTraceResult(below->upper + 1, below->top);
+	} else {
+		result = voxelutil::FloorTraceResult();
+	}
+	return true;
+}
+
+}
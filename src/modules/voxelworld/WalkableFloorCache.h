@@ -0,0 +1,138 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "voxel/PagedVolume.h"
+#include "voxel/Constants.h"
+#include "voxelutil/FloorTraceResult.h"
+#include "core/collection/HashMap.h"
+#include "core/concurrent/Lock.h"
+#include "core/NonCopyable.h"
+#include "core/Trace.h"
+#include <glm/vec3.hpp>
+#include <memory>
+#include <vector>
+#include <stdint.h>
+
+namespace voxelworld {
+
+/**
+ * @brief Caches the walkable floor levels of the world columns
+ *
+ * For every x/z column the solid (not enterable) voxel runs between @c 0 and @c voxel::MAX_HEIGHT are
+ * stored together with the voxels that @c voxelutil::findWalkableFloor() would return. The top of each
+ * run is a floor level. A floor query is answered from these runs without touching the volume and gives
+ * the same result as tracing through the volume.
+ *
+ * The columns are grouped into tiles with the side length of the volume chunks. A tile is filled as soon as
+ * a chunk that covers the whole height range is paged in (see @c onPageIn()) or lazily on the first query for
+ * smaller chunks. Modified voxels must be reported by @c updateColumn() to keep the cache valid.
+ *
+ * @note All methods are thread safe. Methods that read the volume don't hold the lock of the cache
+ * while doing so - the volume locks are always acquired before the cache lock.
+ */
+class WalkableFloorCache : public core::NonCopyable {
+public:
+	/**
+	 * @brief A run of solid voxels in a column - the walkable floor level is @c upper + 1
+	 */
+	struct Surface {
+		uint8_t lower;
+		uint8_t upper;
+		/** the voxel at @c upper - returned for traces that start above the surface */
+		voxel::Voxel top;
+		/** the voxel at @c upper + 1 - returned for traces that start inside the run */
+		voxel::Voxel above;
+	};
+	static_assert(voxel::MAX_HEIGHT <= 255, "The surface levels don't fit into 8 bit");
+
+private:
+	struct Tile {
+		// the start of the surfaces of each column in the surfaces vector
+		std::vector<uint32_t> offsets;
+		std::vector<uint8_t> counts;
+		std::vector<Surface> surfaces;
+		// surfaces that are no longer referenced because a column was updated
+		uint32_t unused = 0u;
+		uint32_t lastAccessed = 0u;
+
+		void setColumn(int index, const std::vector<Surface>& columnSurfaces);
+	};
+	typedef std::shared_ptr<Tile> TilePtr;
+
+	int _tileSideLength = 0;
+	int _tileSideLengthPower = 0;
+	size_t _maxTiles;
+	uint32_t _timestamper = 0u;
+	/**
+	 * @brief Increased by every @c updateColumn() call - the tiles and columns that were read from the volume
+	 * are only stored if no column was modified in the meantime
+	 */
+	uint32_t _version = 0u;
+	static constexpr int MaxReadAttempts = 4;
+	core::HashMap<uint64_t, TilePtr, std::hash<uint64_t>> _tiles;
+	core_trace_mutex(core::Lock, _lock, "WalkableFloorCache");
+
+	uint64_t tileKey(int x, int z) const;
+	int columnIndex(int x, int z) const;
+	void putTile(uint64_t key, const TilePtr& tile);
+
+	/**
+	 * @brief Collects the surfaces of a single column
+	 * @param voxelAt Functor that returns the voxel at the given height of the column
+	 */
+	template<class VoxelAt>
+	static void collectSurfaces(const VoxelAt& voxelAt, std::vector<Surface>& surfaces);
+	static void collectSurfaces(voxel::PagedVolume::Sampler& sampler, int x, int z, std::vector<Surface>& surfaces);
+
+public:
+	/**
+	 * @param maxTiles The least recently used tiles are removed if there are more tiles than this
+	 */
+	WalkableFloorCache(size_t maxTiles = 64u);
+
+	/**
+	 * @param tileSideLength The side length of the volume chunks - must be a power of two
+	 */
+	void init(int tileSideLength);
+	void shutdown();
+
+	/**
+	 * @brief Fills the tile of the paged in chunk if the chunk covers all floor levels
+	 * @note Called by the volume pager after the chunk data was created or loaded
+	 */
+	void onPageIn(const voxel::PagedVolume::PagerContext& ctx);
+
+	/**
+	 * @brief Fills the tile that contains the given column by reading the volume
+	 * @note The tile is not cached if columns are modified while reading the volume several times in a row
+	 */
+	void cacheTile(const voxel::PagedVolume* volume, int x, int z);
+
+	/**
+	 * @brief Updates a single column of an already cached tile after the voxels of the column were modified
+	 * @note Must be called for every modification - also for columns of tiles that aren't cached
+	 */
+	void updateColumn(const voxel::PagedVolume* volume, int x, int z);
+
+	/**
+	 * @brief Updates all columns of the given region
+	 */
+	void updateRegion(const voxel::PagedVolume* volume, const voxel::Region& region);
+
+	/**
+	 * @brief Same as @c voxelutil::findWalkableFloor() but only uses the cached surfaces
+	 * @param[out] result The floor trace result if the column is cached
+	 * @return @c false if the column isn't cached or the position is outside of the height range
+	 * of the cache - the result is untouched in this case.
+	 */
+	bool findWalkableFloor(const glm::ivec3& position, int maxDistanceUpwards, voxelutil::FloorTraceResult& result);
+
+	bool hasTile(int x, int z) const;
+	size_t tiles() const;
+	void clear();
+};
+
+}
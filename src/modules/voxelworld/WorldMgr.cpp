@@ -17,6 +17,26 @@
 
 namespace voxelworld {
 
+class WorldMgr::FloorCachePager : public voxel::PagedVolume::Pager {
+private:
+	voxel::PagedVolume::Pager* _pager;
+	WalkableFloorCache& _floorCache;
+public:
+	FloorCachePager(voxel::PagedVolume::Pager* pager, WalkableFloorCache& floorCache) :
+			_pager(pager), _floorCache(floorCache) {
+	}
+
+	bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+		const bool modified = _pager->pageIn(ctx);
+		_floorCache.onPageIn(ctx);
+		return modified;
+	}
+
+	void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+		_pager->pageOut(chunk);
+	}
+};
+
 WorldMgr::WorldMgr(const voxel::PagedVolume::PagerPtr& pager) :
 		_pager(pager), _random(_seed) {
 }
@@ -38,6 +58,7 @@ glm::ivec3 WorldMgr::randomPos() const {
 
 void WorldMgr::reset() {
 	_volumeData->flushAll();
+	_floorCache.clear();
 }
 
 void WorldMgr::setSeed(unsigned int seed) {
@@ -52,19 +73,39 @@ voxel::PagedVolume::Sampler WorldMgr::sampler() {
 }
 
 bool WorldMgr::init(uint32_t volumeMemoryMegaBytes, uint16_t chunkSideLength) {
-	_volumeData = new voxel::PagedVolume(_pager.get(), volumeMemoryMegaBytes * 1024 * 1024, chunkSideLength);
+	_floorCache.init(chunkSideLength);
+	_floorCachePager = std::make_unique<FloorCachePager>(_pager.get(), _floorCache);
+	_volumeData = new voxel::PagedVolume(_floorCachePager.get(), volumeMemoryMegaBytes * 1024 * 1024, chunkSideLength);
 	return true;
 }
 
 void WorldMgr::shutdown() {
 	delete _volumeData;
 	_volumeData = nullptr;
+	_floorCachePager.reset();
+	_floorCache.shutdown();
 }
 
 voxelutil::FloorTraceResult WorldMgr::findWalkableFloor(const glm::ivec3& position, int maxDistanceUpwards) const {
 	core_assert_msg(_volumeData != nullptr, "WorldMgr is not initialized");
+	voxelutil::FloorTraceResult result;
+	if (_floorCache.findWalkableFloor(position, maxDistanceUpwards, result)) {
+		return result;
+	}
+	if (position.y >= 0 && position.y <= voxel::MAX_HEIGHT) {
+		_floorCache.cacheTile(_volumeData, position.x, position.z);
+		if (_floorCache.findWalkableFloor(position, maxDistanceUpwards, result)) {
+			return result;
+		}
+	}
 	voxel::PagedVolume::Sampler sampler(_volumeData);
 	return voxelutil::findWalkableFloor(&sampler, position, maxDistanceUpwards);
 }
 
+void WorldMgr::setVoxel(const glm::ivec3& position, const voxel::Voxel& voxel) {
+	core_assert_msg(_volumeData != nullptr, "WorldMgr is not initialized");
+	_volumeData->setVoxel(position, voxel);
+	_floorCache.updateColumn(_volumeData, position.x, position.z);
+}
+
 }
@@ -11,6 +11,7 @@
 #include "voxelutil/Raycast.h"
 #include "voxelutil/FloorTraceResult.h"
 #include "voxelformat/VolumeCache.h"
+#include "WalkableFloorCache.h"
 #include "voxel/Constants.h"
 #include "core/GLM.h"
 #include "math/Random.h"
@@ -44,9 +45,16 @@ public:
 	/**
 	 * @sa voxelutil::FloorTraceResult
 	 * @return The y component for the given x and z coordinates that is walkable - or @c NO_FLOOR_FOUND.
+	 * @note The floor levels are answered by the @c WalkableFloorCache - the volume is only sampled for
+	 * columns that aren't cached yet.
 	 */
 	voxelutil::FloorTraceResult findWalkableFloor(const glm::ivec3& position, int maxDistanceUpwards = voxel::MAX_HEIGHT) const;
 
+	/**
+	 * @brief Modifies the world and keeps the cached floor levels up to date
+	 */
+	void setVoxel(const glm::ivec3& position, const voxel::Voxel& voxel);
+
 	bool init(uint32_t volumeMemoryMegaBytes = 1024, uint16_t chunkSideLength = 256);
 	void shutdown();
 	void reset();
@@ -64,9 +72,11 @@ public:
 
 	voxel::PagedVolume::Sampler sampler();
 	voxel::PagedVolume *volumeData();
+	const WalkableFloorCache& floorCache() const;
 
 private:
 	friend class WorldMgrTest;
+	class FloorCachePager;
 
 	/**
 	 * @brief Cuts the given world coordinate down to chunk tile vectors
@@ -74,7 +84,10 @@ private:
 	glm::ivec3 chunkPos(const glm::ivec3& pos) const;
 
 	voxel::PagedVolume::PagerPtr _pager;
+	// forwards to _pager and fills the floor cache for the paged in chunks
+	std::unique_ptr<FloorCachePager> _floorCachePager;
 	voxel::PagedVolume *_volumeData = nullptr;
+	mutable WalkableFloorCache _floorCache;
 	mutable std::mt19937 _engine;
 	long _seed = 0l;
 
@@ -93,6 +106,10 @@ inline glm::ivec3 WorldMgr::chunkPos(const glm::ivec3& pos) const {
 	return glm::ivec3(x, y, z);
 }
 
+inline const WalkableFloorCache& WorldMgr::floorCache() const {
+	return _floorCache;
+}
+
 inline bool WorldMgr::created() const {
 	return _seed != 0;
 }
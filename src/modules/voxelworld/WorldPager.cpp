@@ -254,36 +254,11 @@ void WorldPager::placeTrees(voxel::PagedVolume::PagerContext& pagerCtx) {
 			}
 			const char *treeType = treeTypes[treeTypeIndex++];
 			treeTypeIndex %= treeTypeSize;
-			const voxel::RawVolume* v = _volumeCache.loadTree(treePos, treeType);
-			if (v == nullptr) {
+			const voxelutil::VoxelStamp* stamp = _volumeCache.loadTreeStamp(treePos, treeType, axes[positionIndex % axesSize]);
+			if (stamp == nullptr) {
 				continue;
 			}
-			const voxelutil::RawVolumeRotateWrapper rotateWrapper(v, axes[positionIndex % axesSize]);
-			addVolumeToPosition(chunkWrapper, rotateWrapper, treePos);
-		}
-	}
-}
-
-void WorldPager::addVolumeToPosition(voxel::PagedVolumeWrapper& target, const voxelutil::RawVolumeRotateWrapper& source, const glm::ivec3& pos) {
-	const voxel::Region& region = source.region();
-	const glm::ivec3& mins = region.getLowerCorner();
-	const glm::ivec3& maxs = region.getUpperCorner();
-	const voxel::Region& targetRegion = target.region();
-	for (int x = mins.x; x <= maxs.x; ++x) {
-		const int nx = pos.x + x;
-		for (int y = mins.y; y <= maxs.y; ++y) {
-			const int ny = pos.y + y;
-			for (int z = mins.z; z <= maxs.z; ++z) {
-				const int nz = pos.z + z;
-				if (!targetRegion.containsPoint(nx, ny, nz)) {
-					continue;
-				}
-				const voxel::Voxel& voxel = source.voxel(x, y, z);
-				if (voxel::isAir(voxel.getMaterial())) {
-					continue;
-				}
-				target.setVoxel(nx, ny, nz, voxel);
-			}
+			stamp->place(chunkWrapper, treePos);
 		}
 	}
 }
@@ -14,7 +14,6 @@
 #include "core/SharedPtr.h"
 #include "ChunkPersister.h"
 #include "TreeVolumeCache.h"
-#include "voxelutil/RawVolumeRotateWrapper.h"
 
 namespace voxel {
 class PagedVolumeWrapper;
@@ -43,7 +42,6 @@ private:
 
 	void createWorld(voxel::PagedVolumeWrapper& volume) const;
 	void placeTrees(voxel::PagedVolume::PagerContext& pagerCtx);
-	void addVolumeToPosition(voxel::PagedVolumeWrapper& target, const voxelutil::RawVolumeRotateWrapper& source, const glm::ivec3& pos);
 
 	int terrainHeight(int x, int minsY, int z) const;
 	int terrainHeight(int x, int minsY, int z, float n) const;
@@ -27,22 +27,55 @@ public:
 	}
 };
 
-BENCHMARK_DEFINE_F(PagedVolumeBenchmark, pageIn) (benchmark::State& state) {
-	voxelworld::WorldPager pager(_volumeCache, std::make_shared<voxelworld::ChunkPersister>());
+namespace {
+
+/**
+ * A single grass biome for all heights with a high tree density - all tree types are placed.
+ */
+static const char *ForestBiomesLua = R"(
+function initBiomes()
+  local forest = biomeMgr.addBiome(0, 255, 0.5, 0.5, "Grass", false, 8)
+  forest:addTree("pine")
+  forest:addTree("fir")
+  forest:addTree("deciduous")
+  forest:addTree("bush")
+  biomeMgr.setDefault(forest)
+end
+
+function initCities()
+end
+)";
+
+}
+
+static void pageIn(benchmark::State& state, const voxelformat::VolumeCachePtr& volumeCache, const core::String& luaBiomes) {
+	voxelworld::WorldPager pager(volumeCache, std::make_shared<voxelworld::ChunkPersister>());
 	pager.setSeed(0l);
 	int chunkSize = 256;
 	voxel::PagedVolume volumeData(&pager, 1024 * 1024 * 1024, chunkSize);
 	const io::FilesystemPtr& filesystem = io::filesystem();
 	const core::String& luaParameters = filesystem->load("worldparams.lua");
-	const core::String& luaBiomes = filesystem->load("biomes.lua");
-	pager.init(&volumeData, luaParameters, luaBiomes);
+	if (!pager.init(&volumeData, luaParameters, luaBiomes)) {
+		state.SkipWithError("Failed to initialize the world pager");
+		return;
+	}
 	int i = 0;
 	while (state.KeepRunning()) {
 		volumeData.voxel(chunkSize * i, 0, 0);
 		++i;
 	}
+	pager.shutdown();
+}
+
+BENCHMARK_DEFINE_F(PagedVolumeBenchmark, pageIn) (benchmark::State& state) {
+	pageIn(state, _volumeCache, io::filesystem()->load("biomes.lua"));
+}
+
+BENCHMARK_DEFINE_F(PagedVolumeBenchmark, pageInForest) (benchmark::State& state) {
+	pageIn(state, _volumeCache, ForestBiomesLua);
 }
 
 BENCHMARK_REGISTER_F(PagedVolumeBenchmark, pageIn);
+BENCHMARK_REGISTER_F(PagedVolumeBenchmark, pageInForest);
 
 BENCHMARK_MAIN();
@@ -0,0 +1,94 @@
+/**
+ * @file
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "voxelworld/WorldMgr.h"
+#include "voxelworld/WorldPager.h"
+#include "voxelutil/FloorTrace.h"
+#include "voxelformat/VolumeCache.h"
+#include "math/Random.h"
+#include <memory>
+#include <vector>
+
+namespace {
+
+enum Mode {
+	// trace through the paged volume
+	Trace = 0,
+	// answered by the walkable floor cache of the world manager
+	Cached = 1
+};
+
+static constexpr int QueryPositions = 4096;
+
+}
+
+class WalkableFloorCacheBenchmark : public core::AbstractBenchmark {
+protected:
+	voxelformat::VolumeCachePtr _volumeCache;
+	core::SharedPtr<voxelworld::WorldPager> _pager;
+	std::unique_ptr<voxelworld::WorldMgr> _world;
+	std::vector<glm::ivec3> _positions;
+
+	bool onInitApp() override {
+		if (!voxel::initDefaultMaterialColors()) {
+			return false;
+		}
+		_volumeCache = std::make_shared<voxelformat::VolumeCache>();
+		if (!_volumeCache->init()) {
+			return false;
+		}
+		_pager = core::make_shared<voxelworld::WorldPager>(_volumeCache, std::make_shared<voxelworld::ChunkPersister>());
+		_pager->setSeed(1u);
+		_world = std::make_unique<voxelworld::WorldMgr>(_pager);
+		if (!_world->init()) {
+			return false;
+		}
+		const io::FilesystemPtr& filesystem = io::filesystem();
+		if (!_pager->init(_world->volumeData(), filesystem->load("worldparams.lua"), filesystem->load("biomes.lua"))) {
+			return false;
+		}
+		// the same area as voxelworld::WorldMgr::randomPos() - the chunks are paged in here already
+		math::Random random(1u);
+		_positions.reserve(QueryPositions);
+		for (int i = 0; i < QueryPositions; ++i) {
+			const glm::ivec3 pos(random.random(-100, 100), random.random(0, voxel::MAX_HEIGHT), random.random(-100, 100));
+			_world->findWalkableFloor(pos);
+			_positions.push_back(pos);
+		}
+		return true;
+	}
+
+	void onCleanupApp() override {
+		// the pager flushes the volume of the world
+		if (_pager) {
+			_pager->shutdown();
+		}
+		if (_world) {
+			_world->shutdown();
+			_world.reset();
+		}
+		_pager = core::SharedPtr<voxelworld::WorldPager>();
+		if (_volumeCache) {
+			_volumeCache->shutdown();
+		}
+	}
+};
+
+BENCHMARK_DEFINE_F(WalkableFloorCacheBenchmark, FindWalkableFloor)(benchmark::State &state) {
+	int64_t heightLevels = 0;
+	for (auto _ : state) {
+		for (const glm::ivec3& pos : _positions) {
+			if (state.range(0) == Trace) {
+				heightLevels += voxelutil::findWalkableFloor(_world->volumeData(), pos, voxel::MAX_HEIGHT).heightLevel;
+			} else {
+				heightLevels += _world->findWalkableFloor(pos).heightLevel;
+			}
+		}
+	}
+	benchmark::DoNotOptimize(heightLevels);
+	state.SetItemsProcessed(state.iterations() * (int64_t)_positions.size());
+}
+
+BENCHMARK_REGISTER_F(WalkableFloorCacheBenchmark, FindWalkableFloor)->ArgName("mode")->Arg(Trace)->Arg(Cached);
@@ -0,0 +1,200 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "voxelworld/WorldMgr.h"
+#include "voxelworld/WalkableFloorCache.h"
+#include "voxelutil/FloorTrace.h"
+#include "voxel/Constants.h"
+#include "voxel/Voxel.h"
+#include <glm/trigonometric.hpp>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace voxelworld {
+
+namespace {
+
+inline int positiveModulo(int value, int m) {
+	return ((value % m) + m) % m;
+}
+
+/**
+ * @brief Terrain with caves, water, overhangs and pillars that reach the top of the height range
+ */
+inline int terrainHeight(int x, int z) {
+	return 40 + (int)(20.0f * glm::sin((float)x * 0.11f) * glm::cos((float)z * 0.07f));
+}
+
+voxel::Voxel terrainVoxel(int x, int y, int z, int height) {
+	const uint8_t color = (uint8_t)positiveModulo(y, 8);
+	if (y <= height) {
+		if (y > 10 && y < height - 5 && positiveModulo(x * 7 + z * 13 + y * 3, 23) < 3) {
+			return voxel::Voxel();
+		}
+		return voxel::createVoxel(y < height - 3 ? voxel::VoxelType::Rock : voxel::VoxelType::Grass, color);
+	}
+	if (y <= 32) {
+		return voxel::createVoxel(voxel::VoxelType::Water, color);
+	}
+	if (y >= 80 && y <= 83 && positiveModulo(x + z, 5) != 0) {
+		return voxel::createVoxel(voxel::VoxelType::Leaf, color);
+	}
+	if (positiveModulo(x, 17) == 0 && positiveModulo(z, 13) == 0) {
+		return voxel::createVoxel(voxel::VoxelType::Wood, color);
+	}
+	return voxel::Voxel();
+}
+
+class TerrainPager : public voxel::PagedVolume::Pager {
+public:
+	bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+		const voxel::Region& region = ctx.region;
+		if (region.getLowerY() > voxel::MAX_HEIGHT || region.getUpperY() < 0) {
+			return false;
+		}
+		const int height = region.getHeightInVoxels();
+		std::vector<voxel::Voxel> column(height);
+		for (int z = 0; z < region.getDepthInVoxels(); ++z) {
+			for (int x = 0; x < region.getWidthInVoxels(); ++x) {
+				const int worldX = region.getLowerX() + x;
+				const int worldZ = region.getLowerZ() + z;
+				const int terrain = terrainHeight(worldX, worldZ);
+				for (int y = 0; y < height; ++y) {
+					column[y] = terrainVoxel(worldX, region.getLowerY() + y, worldZ, terrain);
+				}
+				ctx.chunk->setVoxels(x, 0, z, column.data(), height);
+			}
+		}
+		return true;
+	}
+
+	void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+	}
+};
+
+}
+
+class WalkableFloorCacheTest: public core::AbstractTest {
+protected:
+	const int _maxDistances[3] { 0, 3, voxel::MAX_HEIGHT };
+	const core::SharedPtr<TerrainPager> _pager = core::make_shared<TerrainPager>();
+
+	::testing::AssertionResult sameFloor(WorldMgr& world, const glm::ivec3& pos, int maxDistanceUpwards) const {
+		const voxelutil::FloorTraceResult& expected = voxelutil::findWalkableFloor(world.volumeData(), pos, maxDistanceUpwards);
+		const voxelutil::FloorTraceResult& result = world.findWalkableFloor(pos, maxDistanceUpwards);
+		if (expected.heightLevel != result.heightLevel || !expected.voxel.isSame(result.voxel)) {
+			return ::testing::AssertionFailure() << "floor differs at " << pos.x << ":" << pos.y << ":" << pos.z
+					<< " (max distance " << maxDistanceUpwards << "): expected " << expected.heightLevel << " ("
+					<< (int)expected.voxel.getMaterial() << ") - got " << result.heightLevel << " (" << (int)result.voxel.getMaterial() << ")";
+		}
+		return ::testing::AssertionSuccess();
+	}
+
+	/**
+	 * @brief Compares the cached floor levels with the volume traces
+	 */
+	void compareColumns(WorldMgr& world, int lowerX, int upperX, int lowerZ, int upperZ, int step) const {
+		for (int z = lowerZ; z <= upperZ; z += step) {
+			for (int x = lowerX; x <= upperX; x += step) {
+				for (int y = -2; y <= voxel::MAX_HEIGHT + 2; y += 3) {
+					for (int maxDistance : _maxDistances) {
+						ASSERT_TRUE(sameFloor(world, glm::ivec3(x, y, z), maxDistance));
+					}
+				}
+			}
+		}
+	}
+};
+
+TEST_F(WalkableFloorCacheTest, testPagedInTiles) {
+	WorldMgr world(_pager);
+	ASSERT_TRUE(world.init(128, 256));
+	// the chunks cover the whole height range - so the tiles are filled by the page in
+	world.volumeData()->voxel(0, 0, 0);
+	EXPECT_TRUE(world.floorCache().hasTile(0, 0));
+	EXPECT_FALSE(world.floorCache().hasTile(-1, 0));
+	compareColumns(world, 0, 40, 0, 40, 3);
+	EXPECT_EQ(1u, world.floorCache().tiles());
+	world.shutdown();
+}
+
+TEST_F(WalkableFloorCacheTest, testLazyTiles) {
+	WorldMgr world(_pager);
+	ASSERT_TRUE(world.init(128, 32));
+	EXPECT_EQ(0u, world.floorCache().tiles());
+	// columns on both sides of the tile borders
+	compareColumns(world, -20, 20, -20, 20, 3);
+	EXPECT_TRUE(world.floorCache().hasTile(-20, 20));
+	EXPECT_TRUE(world.floorCache().hasTile(20, -20));
+	world.shutdown();
+}
+
+TEST_F(WalkableFloorCacheTest, testSetVoxel) {
+	WorldMgr world(_pager);
+	ASSERT_TRUE(world.init(128, 64));
+	compareColumns(world, 0, 4, 0, 4, 1);
+	ASSERT_TRUE(world.floorCache().hasTile(0, 0));
+	const voxel::Voxel rock = voxel::createVoxel(voxel::VoxelType::Rock, 1);
+	// dig a hole down to the bottom
+	for (int y = 0; y <= voxel::MAX_HEIGHT; ++y) {
+		world.setVoxel(glm::ivec3(1, y, 1), voxel::Voxel());
+	}
+	// build a pillar that reaches the top
+	for (int y = 0; y <= voxel::MAX_HEIGHT; ++y) {
+		world.setVoxel(glm::ivec3(2, y, 2), rock);
+	}
+	// more surfaces than the column had before - the column is moved and the tile is compacted
+	for (int x = 0; x < 5; ++x) {
+		for (int y = 0; y <= voxel::MAX_HEIGHT; y += 2) {
+			world.setVoxel(glm::ivec3(x, y, 3), rock);
+			world.setVoxel(glm::ivec3(x, y + 1, 3), voxel::Voxel());
+		}
+	}
+	world.setVoxel(glm::ivec3(3, voxel::MAX_HEIGHT, 4), rock);
+	compareColumns(world, 0, 4, 0, 4, 1);
+	for (int y = 0; y <= voxel::MAX_HEIGHT + 1; ++y) {
+		ASSERT_TRUE(sameFloor(world, glm::ivec3(3, y, 3), 1));
+	}
+	world.shutdown();
+}
+
+TEST_F(WalkableFloorCacheTest, testModifiedWhileCaching) {
+	WorldMgr world(_pager);
+	ASSERT_TRUE(world.init(128, 32));
+	voxel::PagedVolume* volume = world.volumeData();
+	WalkableFloorCache cache;
+	cache.init(128);
+	const voxel::Voxel rock = voxel::createVoxel(voxel::VoxelType::Rock, 1);
+	std::atomic_bool done { false };
+	// the column is modified while the tile is read from the volume - no modification may get lost
+	std::thread writer([&] () {
+		// every write toggles the floor on top of the voxel - the last one adds it
+		for (int i = 0; i < 100; ++i) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			volume->setVoxel(glm::ivec3(1, 100, 1), i % 2 == 0 ? voxel::Voxel() : rock);
+			cache.updateColumn(volume, 1, 1);
+		}
+		done = true;
+	});
+	while (!done) {
+		cache.clear();
+		cache.cacheTile(volume, 1, 1);
+	}
+	writer.join();
+	for (int y = 0; y <= voxel::MAX_HEIGHT; ++y) {
+		voxelutil::FloorTraceResult result;
+		if (!cache.findWalkableFloor(glm::ivec3(1, y, 1), voxel::MAX_HEIGHT, result)) {
+			continue;
+		}
+		const voxelutil::FloorTraceResult& expected = voxelutil::findWalkableFloor(volume, glm::ivec3(1, y, 1), voxel::MAX_HEIGHT);
+		ASSERT_EQ(expected.heightLevel, result.heightLevel) << "floor differs at height " << y;
+	}
+	cache.shutdown();
+	world.shutdown();
+}
+
+}
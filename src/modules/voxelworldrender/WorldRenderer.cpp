@@ -156,7 +156,7 @@ int WorldRenderer::renderClippingPlanes(const video::Camera& camera) {
 	// render below water
 	const glm::mat4& vpmat = camera.viewProjectionMatrix();
 	_refractionBuffer.bind(true);
-	drawCallsWorld += renderTerrain(vpmat, waterBelowPlane);
+	drawCallsWorld += renderTerrain(vpmat, waterBelowPlane, true);
 	drawCallsWorld += renderEntities(vpmat, waterBelowPlane);
 	_refractionBuffer.unbind();
 
@@ -221,7 +221,7 @@ int WorldRenderer::renderToFrameBuffer(const video::Camera& camera) {
 	return drawCallsWorld;
 }
 
-int WorldRenderer::renderTerrain(const glm::mat4& viewProjectionMatrix, const glm::vec4& clipPlane) {
+int WorldRenderer::renderTerrain(const glm::mat4& viewProjectionMatrix, const glm::vec4& clipPlane, bool occlusionCulled) {
 	int drawCallsWorld = 0;
 	video_trace_scoped(WorldRendererRenderOpaque);
 	video::ScopedShader scoped(_worldShader);
@@ -249,7 +249,7 @@ int WorldRenderer::renderTerrain(const glm::mat4& viewProjectionMatrix, const gl
 		_worldShader.setCascades(_shadow.cascades());
 		_worldShader.setDistances(_shadow.distances());
 	}
-	drawCallsWorld += _worldChunkMgr.renderTerrain();
+	drawCallsWorld += _worldChunkMgr.renderTerrain(occlusionCulled);
 	return drawCallsWorld;
 }
 
@@ -312,7 +312,7 @@ int WorldRenderer::renderAll(const video::Camera& camera) {
 	// due to driver bugs the clip plane might still be taken into account
 	constexpr glm::vec4 ignoreClipPlane(glm::up, 0.0f);
 	const glm::mat4& vpmat = camera.viewProjectionMatrix();
-	drawCallsWorld += renderTerrain(vpmat, ignoreClipPlane);
+	drawCallsWorld += renderTerrain(vpmat, ignoreClipPlane, true);
 	drawCallsWorld += renderEntities(vpmat, ignoreClipPlane);
 	drawCallsWorld += renderEntityDetails(camera);
 	drawCallsWorld += renderWater(camera, ignoreClipPlane);
@@ -336,6 +336,7 @@ void WorldRenderer::construct() {
 	_shadowMap = core::Var::getSafe(cfg::ClientShadowMap);
 	_water = core::Var::getSafe(cfg::ClientWater);
 	_entityRenderer.construct();
+	_entityMgr.construct();
 }
 
 bool WorldRenderer::init(voxel::PagedVolume* volume, const glm::ivec2& position, const glm::ivec2& dimension) {
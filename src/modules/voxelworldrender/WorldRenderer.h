@@ -90,7 +90,11 @@ protected:
 	int renderEntitiesToDepthMap(const video::Camera& camera);
 
 	int renderAll(const video::Camera& camera);
-	int renderTerrain(const glm::mat4& viewProjectionMatrix, const glm::vec4& clipPlane);
+	/**
+	 * @param occlusionCulled Only render the chunks that are not occluded for the camera - the view projection
+	 * matrix must be the one of the camera that was used for culling
+	 */
+	int renderTerrain(const glm::mat4& viewProjectionMatrix, const glm::vec4& clipPlane, bool occlusionCulled = false);
 	int renderEntities(const glm::mat4& viewProjectionMatrix, const glm::vec4& clipPlane);
 	int renderEntityDetails(const video::Camera& camera);
 	int renderWater(const video::Camera& camera, const glm::vec4& clipPlane);
@@ -0,0 +1,141 @@
+/**
+ * @file
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "voxelworldrender/worldrenderer/ChunkGeometryArena.h"
+#include <vector>
+
+namespace {
+
+static constexpr int MeshSize = 32;
+static constexpr int MaxSlots = 2048;
+// the chunks that are kept around the player - in chunks
+static constexpr int ViewRadius = 12;
+// the distance that the player flies per iteration - in chunks
+static constexpr int FlightDistance = 256;
+
+/**
+ * @brief The mesh sizes of a chunk - stable per position like re-extracted chunks
+ */
+struct ChunkMesh {
+	uint32_t numVertices;
+	uint32_t numIndices;
+	uint32_t indexSize;
+};
+
+inline ChunkMesh chunkMesh(const glm::ivec3& pos) {
+	uint32_t hash = (uint32_t)pos.x * 73856093u ^ (uint32_t)pos.z * 83492791u;
+	hash ^= hash >> 13;
+	hash *= 0x5bd1e995u;
+	hash ^= hash >> 15;
+	// flat chunks have a few hundred vertices - the mountains some ten thousands
+	const uint32_t numVertices = 200u + hash % 24000u;
+	const uint32_t numIndices = numVertices * 3u / 2u;
+	const uint32_t indexSize = numVertices <= 0xFFu ? 1u : (numVertices <= 0xFFFFu ? 2u : 4u);
+	return ChunkMesh{numVertices, numIndices, indexSize};
+}
+
+}
+
+class ChunkGeometryArenaBenchmark : public core::AbstractBenchmark {
+};
+
+/**
+ * The player flies along the x axis - the chunks that leave the view radius are freed, the chunks that enter it
+ * are allocated. The arena is defragmented if the free space is fragmented, and grown if it is too small.
+ * range 0 is the initial vertex capacity in vertices.
+ */
+BENCHMARK_DEFINE_F(ChunkGeometryArenaBenchmark, Flight)(benchmark::State &state) {
+	const uint32_t initialVertices = (uint32_t)state.range(0);
+	int64_t allocations = 0;
+	int64_t defragmentations = 0;
+	int64_t grows = 0;
+	double fragmentation = 0.0;
+	int64_t samples = 0;
+	for (auto _ : state) {
+		voxelworldrender::ChunkGeometryArena arena(MaxSlots, initialVertices, initialVertices * 4u);
+		for (int player = 0; player < FlightDistance; ++player) {
+			// the column that left the view radius
+			const int leftX = player - ViewRadius - 1;
+			for (int z = -ViewRadius; z <= ViewRadius; ++z) {
+				arena.free(glm::ivec3(leftX * MeshSize, 0, z * MeshSize));
+			}
+			for (int x = player - ViewRadius; x <= player + ViewRadius; ++x) {
+				for (int z = -ViewRadius; z <= ViewRadius; ++z) {
+					const glm::ivec3 pos(x * MeshSize, 0, z * MeshSize);
+					if (arena.slot(pos) != -1) {
+						continue;
+					}
+					const ChunkMesh& mesh = chunkMesh(pos);
+					if (arena.allocate(pos, mesh.numVertices, mesh.numIndices, mesh.indexSize) != -1) {
+						++allocations;
+						continue;
+					}
+					if (arena.fits(mesh.numVertices, mesh.numIndices, mesh.indexSize)) {
+						arena.defragment([] (int, uint32_t, uint32_t, uint32_t) {}, [] (int, uint32_t, uint32_t, uint32_t) {});
+						++defragmentations;
+					} else {
+						arena.grow(arena.vertexCapacity() * 2u, arena.indexCapacity() * 2u);
+						++grows;
+					}
+					if (arena.allocate(pos, mesh.numVertices, mesh.numIndices, mesh.indexSize) != -1) {
+						++allocations;
+					}
+				}
+			}
+			fragmentation += arena.vertexAllocator().fragmentation();
+			++samples;
+		}
+	}
+	state.SetItemsProcessed(allocations);
+	state.counters["allocations"] = (double)allocations / (double)state.iterations();
+	state.counters["defragmentations"] = (double)defragmentations / (double)state.iterations();
+	state.counters["grows"] = (double)grows / (double)state.iterations();
+	state.counters["fragmentation"] = fragmentation / (double)samples;
+}
+
+BENCHMARK_REGISTER_F(ChunkGeometryArenaBenchmark, Flight)->ArgNames({"vertices"})->Arg(1 << 20)->Arg(1 << 23);
+
+/**
+ * The slot lookup by mesh position for a full set of chunks - compared to a linear scan over the slots
+ * range 0 is 1 for the arena index and 0 for the linear scan
+ */
+BENCHMARK_DEFINE_F(ChunkGeometryArenaBenchmark, SlotLookup)(benchmark::State &state) {
+	const bool indexed = state.range(0) != 0;
+	voxelworldrender::ChunkGeometryArena arena(MaxSlots, 1u << 20, 1u << 22);
+	std::vector<glm::ivec3> positions;
+	std::vector<glm::ivec3> slotPositions(MaxSlots, glm::ivec3(INT32_MIN));
+	for (int x = 0; x < 45; ++x) {
+		for (int z = 0; z < 45; ++z) {
+			const glm::ivec3 pos(x * MeshSize, 0, z * MeshSize);
+			const int slot = arena.allocate(pos, 100u, 150u, 2u);
+			if (slot == -1) {
+				continue;
+			}
+			slotPositions[slot] = pos;
+			positions.push_back(pos);
+		}
+	}
+	int64_t found = 0;
+	for (auto _ : state) {
+		for (const glm::ivec3& pos : positions) {
+			int slot = -1;
+			if (indexed) {
+				slot = arena.slot(pos);
+			} else {
+				for (int i = 0; i < MaxSlots; ++i) {
+					if (slotPositions[i] == pos) {
+						slot = i;
+						break;
+					}
+				}
+			}
+			found += slot != -1;
+		}
+	}
+	benchmark::DoNotOptimize(found);
+	state.SetItemsProcessed(state.iterations() * (int64_t)positions.size());
+}
+
+BENCHMARK_REGISTER_F(ChunkGeometryArenaBenchmark, SlotLookup)->ArgNames({"indexed"})->Arg(0)->Arg(1);
@@ -0,0 +1,136 @@
+/**
+ * @file
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "voxelworldrender/worldrenderer/WorldOcclusionCuller.h"
+#include "voxelworld/WorldMgr.h"
+#include "voxelworld/WorldPager.h"
+#include "voxelformat/VolumeCache.h"
+#include "voxel/Constants.h"
+#include "math/Random.h"
+#include <glm/trigonometric.hpp>
+#include <memory>
+#include <vector>
+
+namespace {
+
+static constexpr int MeshSize = 32;
+// the amount of mesh chunks per side around the origin
+static constexpr int ChunksPerSide = 16;
+static constexpr int Views = 16;
+
+}
+
+class WorldOcclusionCullerBenchmark : public core::AbstractBenchmark {
+protected:
+	voxelformat::VolumeCachePtr _volumeCache;
+	core::SharedPtr<voxelworld::WorldPager> _pager;
+	std::unique_ptr<voxelworld::WorldMgr> _world;
+	std::vector<voxelworldrender::ChunkOccluders> _chunks;
+	std::vector<const voxelworldrender::ChunkOccluders*> _chunkPtrs;
+	std::vector<video::Camera> _cameras;
+
+	bool onInitApp() override {
+		if (!voxel::initDefaultMaterialColors()) {
+			return false;
+		}
+		_volumeCache = std::make_shared<voxelformat::VolumeCache>();
+		if (!_volumeCache->init()) {
+			return false;
+		}
+		_pager = core::make_shared<voxelworld::WorldPager>(_volumeCache, std::make_shared<voxelworld::ChunkPersister>());
+		_pager->setSeed(1u);
+		_world = std::make_unique<voxelworld::WorldMgr>(_pager);
+		if (!_world->init()) {
+			return false;
+		}
+		const io::FilesystemPtr& filesystem = io::filesystem();
+		if (!_pager->init(_world->volumeData(), filesystem->load("worldparams.lua"), filesystem->load("biomes.lua"))) {
+			return false;
+		}
+		// the same regions as the mesh extraction of the world renderer
+		const int half = ChunksPerSide * MeshSize / 2;
+		for (int z = -half; z < half; z += MeshSize) {
+			for (int x = -half; x < half; x += MeshSize) {
+				for (int y = 0; y <= voxel::MAX_HEIGHT; y += voxel::MAX_MESH_CHUNK_HEIGHT) {
+					const voxel::Region region(x, y, z, x + MeshSize - 1, y + voxel::MAX_MESH_CHUNK_HEIGHT - 2, z + MeshSize - 1);
+					voxelworldrender::ChunkOccluders chunk;
+					if (voxelworldrender::extractChunkOccluders(_world->volumeData(), region, MeshSize / 8, chunk)) {
+						_chunks.push_back(chunk);
+					}
+				}
+			}
+		}
+		for (const voxelworldrender::ChunkOccluders& chunk : _chunks) {
+			_chunkPtrs.push_back(&chunk);
+		}
+		// the views of a player that walks over the terrain
+		math::Random random(1u);
+		for (int i = 0; i < Views; ++i) {
+			const glm::ivec3 pos(random.random(-half / 2, half / 2), voxel::MAX_HEIGHT, random.random(-half / 2, half / 2));
+			const int floor = _world->findWalkableFloor(pos).heightLevel;
+			const glm::vec3 eye((float)pos.x, (float)core_max(floor, 0) + 2.0f, (float)pos.z);
+			const float angle = glm::radians(360.0f * (float)i / (float)Views);
+			video::Camera camera;
+			camera.init(glm::ivec2(0), glm::ivec2(1024, 768), glm::ivec2(1024, 768));
+			camera.setFarPlane((float)half);
+			camera.setPosition(eye);
+			camera.lookAt(eye + glm::vec3(glm::cos(angle), -0.1f, glm::sin(angle)));
+			camera.update(0.0);
+			_cameras.push_back(camera);
+		}
+		return true;
+	}
+
+	void onCleanupApp() override {
+		_chunkPtrs.clear();
+		_chunks.clear();
+		_cameras.clear();
+		// the pager flushes the volume of the world
+		if (_pager) {
+			_pager->shutdown();
+		}
+		if (_world) {
+			_world->shutdown();
+			_world.reset();
+		}
+		_pager = core::SharedPtr<voxelworld::WorldPager>();
+		if (_volumeCache) {
+			_volumeCache->shutdown();
+		}
+	}
+};
+
+// range 0 is the maximum amount of rasterized occluders - 0 means frustum culling only. range 1 is the width of the depth buffer
+BENCHMARK_DEFINE_F(WorldOcclusionCullerBenchmark, Cull)(benchmark::State &state) {
+	const int width = (int)state.range(1);
+	voxelworldrender::WorldOcclusionCuller culler(width, width / 2, (int)state.range(0));
+	std::vector<int> visible;
+	int64_t chunks = 0;
+	int64_t frustumCulled = 0;
+	int64_t occlusionCulled = 0;
+	int64_t occluders = 0;
+	for (auto _ : state) {
+		for (const video::Camera& camera : _cameras) {
+			culler.cull(camera, _chunkPtrs, visible);
+			const voxelworldrender::WorldOcclusionCuller::Stats& stats = culler.stats();
+			chunks += stats.chunks;
+			frustumCulled += stats.frustumCulled;
+			occlusionCulled += stats.occlusionCulled;
+			occluders += stats.occluders;
+		}
+	}
+	const int64_t culls = state.iterations() * (int64_t)_cameras.size();
+	state.SetItemsProcessed(culls);
+	state.counters["chunks"] = (double)chunks / (double)culls;
+	state.counters["occluders"] = (double)occluders / (double)culls;
+	state.counters["frustumRejected"] = (double)frustumCulled / (double)chunks;
+	// the ratio of the chunks in the frustum that are rejected by the occlusion test
+	state.counters["occlusionRejected"] = (double)occlusionCulled / (double)core_max(chunks - frustumCulled, (int64_t)1);
+}
+
+BENCHMARK_REGISTER_F(WorldOcclusionCullerBenchmark, Cull)->ArgNames({"occluders", "width"})->Args({0, 128})
+		->Args({512, 128})->Args({2048, 128})->Args({512, 256})->Args({2048, 256});
+
+BENCHMARK_MAIN();
@@ -0,0 +1,109 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "voxelworldrender/worldrenderer/ChunkGeometryArena.h"
+
+namespace voxelworldrender {
+
+class ChunkGeometryArenaTest : public core::AbstractTest {
+};
+
+TEST_F(ChunkGeometryArenaTest, testAllocate) {
+	ChunkGeometryArena arena(4, 1000u, 1000u);
+	const int slot = arena.allocate(glm::ivec3(0, 0, 0), 100u, 150u, 2u);
+	ASSERT_NE(-1, slot);
+	EXPECT_EQ(slot, arena.slot(glm::ivec3(0, 0, 0)));
+	EXPECT_EQ(-1, arena.slot(glm::ivec3(32, 0, 0)));
+	EXPECT_EQ(1, arena.size());
+	EXPECT_EQ(0u, arena.baseVertex(slot));
+	EXPECT_EQ(0u, arena.baseIndex(slot));
+
+	const int slot2 = arena.allocate(glm::ivec3(32, 0, 0), 100u, 10u, 1u);
+	ASSERT_NE(-1, slot2);
+	EXPECT_NE(slot, slot2);
+	EXPECT_EQ(100u, arena.baseVertex(slot2));
+	// 150 indices with 2 bytes each - aligned to 4 bytes
+	EXPECT_EQ(300u, arena.indexOffset(slot2));
+	EXPECT_EQ(300u, arena.baseIndex(slot2));
+
+	const int slot3 = arena.allocate(glm::ivec3(64, 0, 0), 10u, 3u, 4u);
+	ASSERT_NE(-1, slot3);
+	EXPECT_EQ(312u, arena.indexOffset(slot3));
+	EXPECT_EQ(78u, arena.baseIndex(slot3));
+	EXPECT_EQ(0u, arena.indexOffset(slot3) % ChunkGeometryArena::IndexAlignment);
+
+	EXPECT_EQ(-1, arena.allocate(glm::ivec3(96, 0, 0), 0u, 3u, 4u)) << "Empty meshes are not allowed";
+	EXPECT_EQ(-1, arena.allocate(glm::ivec3(96, 0, 0), 1000u, 3u, 4u)) << "The vertex buffer is too small";
+	EXPECT_EQ(-1, arena.slot(glm::ivec3(96, 0, 0)));
+	EXPECT_EQ(3, arena.size());
+}
+
+TEST_F(ChunkGeometryArenaTest, testReplace) {
+	ChunkGeometryArena arena(4, 1000u, 1000u);
+	const glm::ivec3 pos(0, 0, 0);
+	const int slot = arena.allocate(pos, 100u, 100u, 4u);
+	ASSERT_NE(-1, slot);
+	// the mesh was re-extracted - the slot is kept
+	EXPECT_EQ(slot, arena.allocate(pos, 200u, 50u, 2u));
+	EXPECT_EQ(1, arena.size());
+	EXPECT_EQ(200u, arena.vertexAllocator().used());
+	EXPECT_EQ(200u, arena.get(slot).numVertices);
+	EXPECT_EQ(2u, arena.get(slot).indexSize);
+	EXPECT_TRUE(arena.free(pos));
+	EXPECT_FALSE(arena.free(pos));
+	EXPECT_EQ(0, arena.size());
+	EXPECT_EQ(0u, arena.vertexAllocator().used());
+	EXPECT_EQ(0u, arena.indexAllocator().used());
+}
+
+TEST_F(ChunkGeometryArenaTest, testMaxSlots) {
+	ChunkGeometryArena arena(2, 1000u, 1000u);
+	const int slot = arena.allocate(glm::ivec3(0, 0, 0), 10u, 10u, 1u);
+	ASSERT_NE(-1, slot);
+	ASSERT_NE(-1, arena.allocate(glm::ivec3(32, 0, 0), 10u, 10u, 1u));
+	EXPECT_EQ(-1, arena.allocate(glm::ivec3(64, 0, 0), 10u, 10u, 1u));
+	arena.freeSlot(slot);
+	EXPECT_EQ(slot, arena.allocate(glm::ivec3(64, 0, 0), 10u, 10u, 1u));
+	EXPECT_EQ(-1, arena.slot(glm::ivec3(0, 0, 0)));
+}
+
+TEST_F(ChunkGeometryArenaTest, testDefragmentAndGrow) {
+	ChunkGeometryArena arena(8, 400u, 400u);
+	for (int i = 0; i < 4; ++i) {
+		ASSERT_NE(-1, arena.allocate(glm::ivec3(i * 32, 0, 0), 100u, 100u, 1u));
+	}
+	EXPECT_TRUE(arena.free(glm::ivec3(0, 0, 0)));
+	EXPECT_TRUE(arena.free(glm::ivec3(64, 0, 0)));
+	// enough space - but not in one region
+	EXPECT_TRUE(arena.fits(200u, 100u, 1u));
+	EXPECT_EQ(-1, arena.allocate(glm::ivec3(128, 0, 0), 200u, 100u, 1u));
+
+	int vertexCalls = 0;
+	int indexCalls = 0;
+	arena.defragment([&] (int slot, uint32_t oldOffset, uint32_t newOffset, uint32_t amount) {
+		// the new offset is applied after the callback
+		EXPECT_EQ(arena.baseVertex(slot), oldOffset);
+		EXPECT_LT(newOffset, oldOffset);
+		EXPECT_EQ(100u, amount);
+		++vertexCalls;
+	}, [&] (int slot, uint32_t oldOffset, uint32_t newOffset, uint32_t amount) {
+		EXPECT_EQ(100u, amount);
+		++indexCalls;
+	});
+	EXPECT_EQ(2, vertexCalls);
+	EXPECT_EQ(2, indexCalls);
+	EXPECT_EQ(100u, arena.baseVertex(arena.slot(glm::ivec3(96, 0, 0))));
+	EXPECT_EQ(100u, arena.indexOffset(arena.slot(glm::ivec3(96, 0, 0))));
+	ASSERT_NE(-1, arena.allocate(glm::ivec3(128, 0, 0), 200u, 100u, 1u));
+
+	EXPECT_FALSE(arena.fits(100u, 100u, 1u));
+	EXPECT_FALSE(arena.grow(200u, 800u));
+	ASSERT_TRUE(arena.grow(800u, 800u));
+	EXPECT_EQ(800u, arena.vertexCapacity());
+	EXPECT_EQ(800u, arena.indexCapacity());
+	ASSERT_NE(-1, arena.allocate(glm::ivec3(160, 0, 0), 100u, 100u, 1u));
+}
+
+}
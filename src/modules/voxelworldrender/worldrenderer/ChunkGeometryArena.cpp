@@ -0,0 +1,119 @@
+/**
+ * @file
+ */
+
+#include "ChunkGeometryArena.h"
+#include "core/Assert.h"
+
+namespace voxelworldrender {
+
+ChunkGeometryArena::ChunkGeometryArena(int maxSlots, uint32_t vertexCapacity, uint32_t indexCapacity) :
+		_vertexAllocator(vertexCapacity), _indexAllocator(indexCapacity / IndexAlignment), _slots(maxSlots) {
+	core_assert_msg(indexCapacity % IndexAlignment == 0u, "The index capacity must be aligned to %u bytes", IndexAlignment);
+	reset();
+}
+
+void ChunkGeometryArena::reset() {
+	_vertexAllocator.reset(_vertexAllocator.capacity());
+	_indexAllocator.reset(_indexAllocator.capacity());
+	_slotByPos.clear();
+	_freeSlots.clear();
+	for (int i = (int)_slots.size() - 1; i >= 0; --i) {
+		_slots[i] = Slot();
+		_freeSlots.push_back(i);
+	}
+}
+
+uint32_t ChunkGeometryArena::indexUnits(uint32_t numIndices, uint32_t indexSize) {
+	return (numIndices * indexSize + IndexAlignment - 1u) / IndexAlignment;
+}
+
+bool ChunkGeometryArena::fits(uint32_t numVertices, uint32_t numIndices, uint32_t indexSize) const {
+	return _vertexAllocator.freeSpace() >= numVertices && _indexAllocator.freeSpace() >= indexUnits(numIndices, indexSize);
+}
+
+int ChunkGeometryArena::allocate(const glm::ivec3& pos, uint32_t numVertices, uint32_t numIndices, uint32_t indexSize) {
+	core_assert(indexSize == 1u || indexSize == 2u || indexSize == 4u);
+	if (numVertices == 0u || numIndices == 0u) {
+		return -1;
+	}
+	int slotIndex = slot(pos);
+	if (slotIndex != -1) {
+		Slot& existing = _slots[slotIndex];
+		_vertexAllocator.free(existing.vertices);
+		_indexAllocator.free(existing.indices);
+		existing.vertices = core::OffsetAllocator::InvalidHandle;
+		existing.indices = core::OffsetAllocator::InvalidHandle;
+	} else if (_freeSlots.empty()) {
+		return -1;
+	}
+	const core::OffsetAllocator::Handle vertices = _vertexAllocator.allocate(numVertices);
+	if (vertices == core::OffsetAllocator::InvalidHandle) {
+		if (slotIndex != -1) {
+			freeSlot(slotIndex);
+		}
+		return -1;
+	}
+	const core::OffsetAllocator::Handle indices = _indexAllocator.allocate(indexUnits(numIndices, indexSize));
+	if (indices == core::OffsetAllocator::InvalidHandle) {
+		_vertexAllocator.free(vertices);
+		if (slotIndex != -1) {
+			freeSlot(slotIndex);
+		}
+		return -1;
+	}
+	if (slotIndex == -1) {
+		slotIndex = _freeSlots.back();
+		_freeSlots.pop_back();
+		_slotByPos.put(pos, slotIndex);
+	}
+	Slot& s = _slots[slotIndex];
+	s.pos = pos;
+	s.vertices = vertices;
+	s.indices = indices;
+	s.numVertices = numVertices;
+	s.numIndices = numIndices;
+	s.indexSize = indexSize;
+	s.inuse = true;
+	return slotIndex;
+}
+
+int ChunkGeometryArena::slot(const glm::ivec3& pos) const {
+	auto iter = _slotByPos.find(pos);
+	if (iter == _slotByPos.end()) {
+		return -1;
+	}
+	return iter->value;
+}
+
+bool ChunkGeometryArena::free(const glm::ivec3& pos) {
+	const int slotIndex = slot(pos);
+	if (slotIndex == -1) {
+		return false;
+	}
+	freeSlot(slotIndex);
+	return true;
+}
+
+void ChunkGeometryArena::freeSlot(int slotIndex) {
+	core_assert(slotIndex >= 0 && slotIndex < (int)_slots.size());
+	Slot& s = _slots[slotIndex];
+	if (!s.inuse) {
+		return;
+	}
+	_vertexAllocator.free(s.vertices);
+	_indexAllocator.free(s.indices);
+	_slotByPos.remove(s.pos);
+	s = Slot();
+	_freeSlots.push_back(slotIndex);
+}
+
+bool ChunkGeometryArena::grow(uint32_t vertexCapacity, uint32_t indexCapacity) {
+	core_assert_msg(indexCapacity % IndexAlignment == 0u, "The index capacity must be aligned to %u bytes", IndexAlignment);
+	if (vertexCapacity < _vertexAllocator.capacity() || indexCapacity / IndexAlignment < _indexAllocator.capacity()) {
+		return false;
+	}
+	return _vertexAllocator.grow(vertexCapacity) && _indexAllocator.grow(indexCapacity / IndexAlignment);
+}
+
+}
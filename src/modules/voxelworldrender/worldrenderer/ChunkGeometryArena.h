@@ -0,0 +1,186 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/OffsetAllocator.h"
+#include "core/collection/HashMap.h"
+#include "core/GLM.h"
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+#include <vector>
+
+namespace voxelworldrender {
+
+/**
+ * @brief The cpu side bookkeeping of the chunk meshes that share one vertex and one index buffer
+ *
+ * Every chunk gets a slot that is found by the mesh position in O(1). The slot holds the ranges of the chunk
+ * inside of the shared buffers - the vertex ranges are measured in vertices, the index ranges in bytes. Index
+ * ranges are aligned to @c IndexAlignment bytes - this allows mixing chunks with different index sizes in one
+ * buffer and still address them with a base index.
+ *
+ * @note This doesn't touch any gpu memory - the caller has to upload the data to the offsets of the slot and
+ * has to copy the data if the arena is defragmented.
+ */
+class ChunkGeometryArena {
+public:
+	static constexpr uint32_t IndexAlignment = 4u;
+
+	struct Slot {
+		glm::ivec3 pos { 0 };
+		core::OffsetAllocator::Handle vertices = core::OffsetAllocator::InvalidHandle;
+		core::OffsetAllocator::Handle indices = core::OffsetAllocator::InvalidHandle;
+		uint32_t numVertices = 0u;
+		uint32_t numIndices = 0u;
+		uint32_t indexSize = 0u;
+		bool inuse = false;
+	};
+private:
+	core::OffsetAllocator _vertexAllocator;
+	// measured in IndexAlignment units
+	core::OffsetAllocator _indexAllocator;
+	std::vector<Slot> _slots;
+	std::vector<int> _freeSlots;
+	core::HashMap<glm::ivec3, int, glm::hash<glm::ivec3>> _slotByPos;
+
+	static uint32_t indexUnits(uint32_t numIndices, uint32_t indexSize);
+public:
+	/**
+	 * @param maxSlots The max amount of chunks - the slot indices are in the range [0, maxSlots)
+	 * @param vertexCapacity The amount of vertices in the shared vertex buffer
+	 * @param indexCapacity The size of the shared index buffer in bytes - must be a multiple of @c IndexAlignment
+	 */
+	ChunkGeometryArena(int maxSlots, uint32_t vertexCapacity, uint32_t indexCapacity);
+
+	void reset();
+
+	/**
+	 * @brief Reserves the ranges for the mesh at the given position. A mesh that already exists at the position
+	 * is replaced - but keeps its slot.
+	 * @return The slot index or @c -1 if there is no slot left or the buffers don't have a free region that is
+	 * large enough. In the latter case @c freeSlot() was already called for a previous mesh at the position.
+	 * @sa fits()
+	 */
+	int allocate(const glm::ivec3& pos, uint32_t numVertices, uint32_t numIndices, uint32_t indexSize);
+	/**
+	 * @return @c true if the free space of the buffers would be enough for the given mesh after the arena was
+	 * defragmented
+	 */
+	bool fits(uint32_t numVertices, uint32_t numIndices, uint32_t indexSize) const;
+	/**
+	 * @return The slot of the mesh at the given position or @c -1 if there is none
+	 */
+	int slot(const glm::ivec3& pos) const;
+	bool free(const glm::ivec3& pos);
+	void freeSlot(int slot);
+
+	/**
+	 * @brief Extends the buffers - existing allocations keep their offsets
+	 * @param indexCapacity Size in bytes - must be a multiple of @c IndexAlignment
+	 */
+	bool grow(uint32_t vertexCapacity, uint32_t indexCapacity);
+
+	/**
+	 * @brief Moves all ranges to the start of the buffers
+	 * @param vertexFunc Called with the slot index, old offset, new offset and the amount of vertices of every slot
+	 * @param indexFunc Called with the slot index, old offset, new offset and the size in bytes of every slot
+	 * @note See @c core::OffsetAllocator::defragment() for the call order
+	 */
+	template<class VERTEXFUNC, class INDEXFUNC>
+	void defragment(VERTEXFUNC&& vertexFunc, INDEXFUNC&& indexFunc);
+
+	const Slot& get(int slot) const;
+	/**
+	 * @return The offset in vertices in the shared vertex buffer
+	 */
+	uint32_t baseVertex(int slot) const;
+	/**
+	 * @return The offset in bytes in the shared index buffer
+	 */
+	uint32_t indexOffset(int slot) const;
+	/**
+	 * @return The offset in indices of the slot index size in the shared index buffer
+	 */
+	uint32_t baseIndex(int slot) const;
+
+	int size() const;
+	int maxSlots() const;
+	uint32_t vertexCapacity() const;
+	/**
+	 * @return The capacity of the index buffer in bytes
+	 */
+	uint32_t indexCapacity() const;
+	const core::OffsetAllocator& vertexAllocator() const;
+	/**
+	 * @note The sizes and offsets of this allocator are measured in @c IndexAlignment units
+	 */
+	const core::OffsetAllocator& indexAllocator() const;
+};
+
+template<class VERTEXFUNC, class INDEXFUNC>
+void ChunkGeometryArena::defragment(VERTEXFUNC&& vertexFunc, INDEXFUNC&& indexFunc) {
+	// the allocator handles are mapped back to the slots
+	core::HashMap<core::OffsetAllocator::Handle, int, std::hash<uint32_t>> vertexSlots;
+	core::HashMap<core::OffsetAllocator::Handle, int, std::hash<uint32_t>> indexSlots;
+	for (int i = 0; i < (int)_slots.size(); ++i) {
+		if (_slots[i].inuse) {
+			vertexSlots.put(_slots[i].vertices, i);
+			indexSlots.put(_slots[i].indices, i);
+		}
+	}
+	_vertexAllocator.defragment([&] (core::OffsetAllocator::Handle handle, uint32_t oldOffset, uint32_t newOffset, uint32_t size) {
+		auto iter = vertexSlots.find(handle);
+		core_assert(iter != vertexSlots.end());
+		vertexFunc(iter->value, oldOffset, newOffset, size);
+	});
+	_indexAllocator.defragment([&] (core::OffsetAllocator::Handle handle, uint32_t oldOffset, uint32_t newOffset, uint32_t size) {
+		auto iter = indexSlots.find(handle);
+		core_assert(iter != indexSlots.end());
+		indexFunc(iter->value, oldOffset * IndexAlignment, newOffset * IndexAlignment, size * IndexAlignment);
+	});
+}
+
+inline const ChunkGeometryArena::Slot& ChunkGeometryArena::get(int slot) const {
+	core_assert(slot >= 0 && slot < (int)_slots.size());
+	return _slots[slot];
+}
+
+inline uint32_t ChunkGeometryArena::baseVertex(int slot) const {
+	return _vertexAllocator.offset(get(slot).vertices);
+}
+
+inline uint32_t ChunkGeometryArena::indexOffset(int slot) const {
+	return _indexAllocator.offset(get(slot).indices) * IndexAlignment;
+}
+
+inline uint32_t ChunkGeometryArena::baseIndex(int slot) const {
+	return indexOffset(slot) / get(slot).indexSize;
+}
+
+inline int ChunkGeometryArena::size() const {
+	return (int)_slotByPos.size();
+}
+
+inline int ChunkGeometryArena::maxSlots() const {
+	return (int)_slots.size();
+}
+
+inline uint32_t ChunkGeometryArena::vertexCapacity() const {
+	return _vertexAllocator.capacity();
+}
+
+inline uint32_t ChunkGeometryArena::indexCapacity() const {
+	return _indexAllocator.capacity() * IndexAlignment;
+}
+
+inline const core::OffsetAllocator& ChunkGeometryArena::vertexAllocator() const {
+	return _vertexAllocator;
+}
+
+inline const core::OffsetAllocator& ChunkGeometryArena::indexAllocator() const {
+	return _indexAllocator;
+}
+
+}
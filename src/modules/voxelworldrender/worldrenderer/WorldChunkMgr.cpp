@@ -3,7 +3,9 @@
  */
 
 #include "WorldChunkMgr.h"
+#include "core/ArrayLength.h"
 #include "core/Trace.h"
+#include "core/GameConfig.h"
 #include "video/Trace.h"
 #include "voxel/Constants.h"
 #include "voxelrender/ShaderAttribute.h"
@@ -15,10 +17,13 @@ namespace voxelworldrender {
 
 namespace {
 constexpr double ScaleDuration = 1.5;
+// the initial capacities of the shared chunk buffers - they are doubled if they are exhausted
+constexpr uint32_t InitialVertexCapacity = 1u << 20;
+constexpr uint32_t InitialIndexCapacity = 1u << 22;
 }
 
 WorldChunkMgr::WorldChunkMgr(core::ThreadPool& threadPool) :
-		_octree({}, 30), _threadPool(threadPool) {
+		_octree({}, 30), _arena(MAX_CHUNKBUFFERS, InitialVertexCapacity, InitialIndexCapacity), _threadPool(threadPool) {
 }
 
 void WorldChunkMgr::updateViewDistance(float viewDistance) {
@@ -29,91 +34,173 @@ void WorldChunkMgr::updateViewDistance(float viewDistance) {
 
 bool WorldChunkMgr::init(shader::WorldShader* worldShader, voxel::PagedVolume* volume) {
 	_worldShader = worldShader;
+	_occlusionCulling = core::Var::get(cfg::ClientOcclusionCulling, "true");
 	if (!_meshExtractor.init(volume)) {
 		Log::error("Failed to initialize the mesh extractor");
 		return false;
 	}
+	if (!createGeometryBuffer(_geometryBuffers[_currentGeometryBuffer], _arena.vertexCapacity(), _arena.indexCapacity())) {
+		Log::error("Failed to create the chunk geometry buffer");
+		return false;
+	}
 	return true;
 }
 
 void WorldChunkMgr::shutdown() {
 	_meshExtractor.shutdown();
+	for (GeometryBuffer& geometry : _geometryBuffers) {
+		geometry._buffer.shutdown();
+		geometry._vbo = -1;
+		geometry._ibo = -1;
+	}
 }
 
 void WorldChunkMgr::reset() {
 	for (ChunkBuffer& chunkBuffer : _chunkBuffers) {
-		chunkBuffer.inuse = false;
+		chunkBuffer.reset();
 	}
+	_arena.reset();
 	_visibleBuffers.size = 0;
+	_unoccludedBuffers.size = 0;
 	_meshExtractor.reset();
 	_octree.clear();
 }
 
-void WorldChunkMgr::handleMeshQueue() {
-	voxel::Mesh mesh;
-	if (!_meshExtractor.pop(mesh)) {
-		return;
-	}
-
-	// Now add the mesh to the list of meshes to render.
-	core_trace_scoped(WorldRendererHandleMeshQueue);
-
-	ChunkBuffer* freeChunkBuffer = nullptr;
-	for (ChunkBuffer& chunkBuffer : _chunkBuffers) {
-		if (freeChunkBuffer == nullptr && !chunkBuffer.inuse) {
-			freeChunkBuffer = &chunkBuffer;
-		}
-		// check whether we update an existing one
-		if (chunkBuffer.aabb().mins() == mesh.getOffset()) {
-			freeChunkBuffer = &chunkBuffer;
-			break;
-		}
-	}
-
-	if (freeChunkBuffer == nullptr) {
-		Log::warn("Could not find free chunk buffer slot");
-		return;
-	}
-
-	video::Buffer& buffer = freeChunkBuffer->_buffer;
-	freeChunkBuffer->_vbo = buffer.create();
-	if (freeChunkBuffer->_vbo == -1) {
+bool WorldChunkMgr::createGeometryBuffer(GeometryBuffer& geometry, uint32_t vertexCapacity, uint32_t indexCapacity) {
+	video::Buffer& buffer = geometry._buffer;
+	const size_t vertexBytes = (size_t)vertexCapacity * sizeof(voxel::VoxelVertex);
+	geometry._vbo = buffer.create(nullptr, vertexBytes);
+	if (geometry._vbo == -1) {
 		Log::error("Failed to create vertex buffer");
-		return;
+		return false;
 	}
+	buffer.setMode(geometry._vbo, video::BufferMode::Dynamic);
+	video::bufferData(buffer.bufferHandle(geometry._vbo), video::BufferType::ArrayBuffer, video::BufferMode::Dynamic, nullptr, vertexBytes);
 	const int locationPos = _worldShader->getLocationPos();
-	const video::Attribute& posAttrib = voxelrender::getPositionVertexAttribute(freeChunkBuffer->_vbo, locationPos, _worldShader->getAttributeComponents(locationPos));
+	const video::Attribute& posAttrib = voxelrender::getPositionVertexAttribute(geometry._vbo, locationPos, _worldShader->getAttributeComponents(locationPos));
 	if (!buffer.addAttribute(posAttrib)) {
 		Log::error("Failed to add position attribute");
-		return;
+		return false;
 	}
 	const int locationInfo = _worldShader->getLocationInfo();
-	const video::Attribute& infoAttrib = voxelrender::getInfoVertexAttribute(freeChunkBuffer->_vbo, locationInfo, _worldShader->getAttributeComponents(locationInfo));
+	const video::Attribute& infoAttrib = voxelrender::getInfoVertexAttribute(geometry._vbo, locationInfo, _worldShader->getAttributeComponents(locationInfo));
 	if (!buffer.addAttribute(infoAttrib)) {
 		Log::error("Failed to add info attribute");
-		return;
+		return false;
 	}
-	freeChunkBuffer->_ibo = buffer.create(nullptr, 0, video::BufferType::IndexBuffer);
-	if (freeChunkBuffer->_ibo == -1) {
+	geometry._ibo = buffer.create(nullptr, indexCapacity, video::BufferType::IndexBuffer);
+	if (geometry._ibo == -1) {
 		Log::error("Failed to create index buffer");
+		return false;
+	}
+	buffer.setMode(geometry._ibo, video::BufferMode::Dynamic);
+	video::bufferData(buffer.bufferHandle(geometry._ibo), video::BufferType::IndexBuffer, video::BufferMode::Dynamic, nullptr, indexCapacity);
+	return true;
+}
+
+bool WorldChunkMgr::rebuildGeometryBuffer(uint32_t vertexCapacity, uint32_t indexCapacity) {
+	core_trace_scoped(WorldRendererRebuildGeometryBuffer);
+	const int targetIndex = (_currentGeometryBuffer + 1) % lengthof(_geometryBuffers);
+	GeometryBuffer& source = _geometryBuffers[_currentGeometryBuffer];
+	GeometryBuffer& target = _geometryBuffers[targetIndex];
+	if (!createGeometryBuffer(target, vertexCapacity, indexCapacity)) {
+		target._buffer.shutdown();
+		return false;
+	}
+	Log::debug("Rebuild the chunk geometry buffer (vertices: %u, indices: %u bytes, fragmentation: %f)",
+			vertexCapacity, indexCapacity, _arena.vertexAllocator().fragmentation());
+	const video::Id sourceVertices = source._buffer.bufferHandle(source._vbo);
+	const video::Id targetVertices = target._buffer.bufferHandle(target._vbo);
+	const video::Id sourceIndices = source._buffer.bufferHandle(source._ibo);
+	const video::Id targetIndices = target._buffer.bufferHandle(target._ibo);
+	_arena.defragment([&] (int, uint32_t oldOffset, uint32_t newOffset, uint32_t amount) {
+		const size_t vertexSize = sizeof(voxel::VoxelVertex);
+		video::copyBufferSubData(sourceVertices, targetVertices, oldOffset * vertexSize, newOffset * vertexSize, amount * vertexSize);
+	}, [&] (int, uint32_t oldOffset, uint32_t newOffset, uint32_t amount) {
+		video::copyBufferSubData(sourceIndices, targetIndices, oldOffset, newOffset, amount);
+	});
+	core_assert_always(_arena.grow(vertexCapacity, indexCapacity));
+	source._buffer.shutdown();
+	source._vbo = -1;
+	source._ibo = -1;
+	_currentGeometryBuffer = targetIndex;
+	return true;
+}
+
+void WorldChunkMgr::handleMeshQueue() {
+	ExtractedMesh extracted;
+	if (!_meshExtractor.pop(extracted)) {
 		return;
 	}
-	freeChunkBuffer->_compressedIndexSize = mesh.compressedIndexSize();
+	const voxel::Mesh& mesh = extracted.mesh;
+
+	// Now add the mesh to the list of meshes to render.
+	core_trace_scoped(WorldRendererHandleMeshQueue);
+
+	const glm::ivec3& mins = mesh.getOffset();
+	const int existingSlot = _arena.slot(mins);
+	if (existingSlot != -1) {
+		// we update an existing one
+		ChunkBuffer& existing = _chunkBuffers[existingSlot];
+		_octree.remove(&existing);
+		existing.reset();
+	}
 
 	const voxel::VertexArray& vertices = mesh.getVertexVector();
-	const uint8_t* indices = mesh.compressedIndices();
-	buffer.update(freeChunkBuffer->_vbo, &vertices.front(), vertices.size() * sizeof(voxel::VertexArray::value_type));
-	buffer.update(freeChunkBuffer->_ibo, indices, mesh.getNoOfIndices() * freeChunkBuffer->_compressedIndexSize);
+	const uint32_t numVertices = (uint32_t)vertices.size();
+	const uint32_t numIndices = (uint32_t)mesh.getNoOfIndices();
+	const uint32_t indexSize = (uint32_t)mesh.compressedIndexSize();
+	if (numIndices == 0u) {
+		_arena.free(mins);
+		return;
+	}
+	int slot = _arena.allocate(mins, numVertices, numIndices, indexSize);
+	if (slot == -1) {
+		if (_arena.size() >= _arena.maxSlots()) {
+			Log::warn("Could not find free chunk buffer slot");
+			return;
+		}
+		// the buffers are either too fragmented or too small
+		uint32_t vertexCapacity = _arena.vertexCapacity();
+		uint32_t indexCapacity = _arena.indexCapacity();
+		while (vertexCapacity - _arena.vertexAllocator().used() < numVertices) {
+			vertexCapacity *= 2u;
+		}
+		const uint32_t alignment = ChunkGeometryArena::IndexAlignment;
+		const uint32_t indexAlignedSize = (numIndices * indexSize + alignment - 1u) / alignment * alignment;
+		while (indexCapacity - _arena.indexAllocator().used() * alignment < indexAlignedSize) {
+			indexCapacity *= 2u;
+		}
+		if (!rebuildGeometryBuffer(vertexCapacity, indexCapacity)) {
+			Log::error("Failed to rebuild the chunk geometry buffer");
+			return;
+		}
+		slot = _arena.allocate(mins, numVertices, numIndices, indexSize);
+		if (slot == -1) {
+			Log::error("Could not allocate the chunk geometry");
+			return;
+		}
+	}
+
+	const GeometryBuffer& geometry = _geometryBuffers[_currentGeometryBuffer];
+	const video::Buffer& buffer = geometry._buffer;
+	video::bufferSubData(buffer.bufferHandle(geometry._vbo), video::BufferType::ArrayBuffer,
+			(intptr_t)_arena.baseVertex(slot) * sizeof(voxel::VertexArray::value_type), &vertices.front(),
+			numVertices * sizeof(voxel::VertexArray::value_type));
+	video::bufferSubData(buffer.bufferHandle(geometry._ibo), video::BufferType::IndexBuffer,
+			(intptr_t)_arena.indexOffset(slot), mesh.compressedIndices(), numIndices * indexSize);
 
+	ChunkBuffer& chunkBuffer = _chunkBuffers[slot];
 	const glm::ivec3& size = _meshExtractor.meshSize();
-	const glm::ivec3& mins = mesh.getOffset();
 	const glm::ivec3 maxs(mins.x + size.x, mins.y + size.y, mins.z + size.z);
-	freeChunkBuffer->_aabb = {mins, maxs};
-	if (!_octree.insert(freeChunkBuffer)) {
+	chunkBuffer._aabb = {mins, maxs};
+	chunkBuffer._occluders = std::move(extracted.occluders);
+	chunkBuffer._slot = slot;
+	if (!_octree.insert(&chunkBuffer)) {
 		Log::warn("Failed to insert into octree");
 	}
-	freeChunkBuffer->inuse = true;
-	freeChunkBuffer->scaleSeconds = ScaleDuration;
+	chunkBuffer.inuse = true;
+	chunkBuffer.scaleSeconds = ScaleDuration;
 }
 
 void WorldChunkMgr::update(double deltaFrameSeconds, const video::Camera &camera, const glm::vec3& focusPos) {
@@ -131,8 +218,9 @@ void WorldChunkMgr::update(double deltaFrameSeconds, const video::Camera &camera
 			continue;
 		}
 		core_assert_always(_meshExtractor.allowReExtraction(pos));
-		chunkBuffer.reset();
+		_arena.freeSlot(chunkBuffer._slot);
 		_octree.remove(&chunkBuffer);
+		chunkBuffer.reset();
 		Log::trace("Remove mesh from %i:%i", pos.x, pos.z);
 	}
 
@@ -160,6 +248,37 @@ void WorldChunkMgr::cull(const video::Camera& camera) {
 		_visibleBuffers.visible[index++] = chunkBuffer;
 	}
 	_visibleBuffers.size = index;
+
+	occlusionCull(camera);
+}
+
+void WorldChunkMgr::occlusionCull(const video::Camera& camera) {
+	if (!_occlusionCulling->boolVal()) {
+		for (int i = 0; i < _visibleBuffers.size; ++i) {
+			_unoccludedBuffers.visible[i] = _visibleBuffers.visible[i];
+		}
+		_unoccludedBuffers.size = _visibleBuffers.size;
+		return;
+	}
+	core_trace_scoped(WorldRendererOcclusionCull);
+	int index = 0;
+	_cullChunks.clear();
+	_cullBuffers.clear();
+	for (int i = 0; i < _visibleBuffers.size; ++i) {
+		ChunkBuffer* chunkBuffer = _visibleBuffers.visible[i];
+		if (chunkBuffer->scaleSeconds > 0.0) {
+			// the chunk doesn't match its occlusion data while it is scaled
+			_unoccludedBuffers.visible[index++] = chunkBuffer;
+			continue;
+		}
+		_cullChunks.push_back(&chunkBuffer->_occluders);
+		_cullBuffers.push_back(chunkBuffer);
+	}
+	_occlusionCuller.cull(camera, _cullChunks, _cullVisible);
+	for (int visibleIndex : _cullVisible) {
+		_unoccludedBuffers.visible[index++] = _cullBuffers[visibleIndex];
+	}
+	_unoccludedBuffers.size = index;
 }
 
 int WorldChunkMgr::distance2(const glm::ivec3& pos, const glm::ivec3& pos2) const {
@@ -193,28 +312,32 @@ void WorldChunkMgr::extractMesh(const glm::ivec3& pos) {
 	_meshExtractor.scheduleMeshExtraction(pos);
 }
 
-int WorldChunkMgr::renderTerrain() {
+int WorldChunkMgr::renderTerrain(bool occlusionCulled) {
 	video_trace_scoped(WorldChunkMgrRenderTerrain);
 	int drawCalls = 0;
 
-	for (int i = 0; i < _visibleBuffers.size; ++i) {
-		ChunkBuffer& chunkBuffer = *_visibleBuffers.visible[i];
+	const VisibleBuffers& buffers = occlusionCulled ? _unoccludedBuffers : _visibleBuffers;
+	if (buffers.size <= 0) {
+		return drawCalls;
+	}
+	// all chunks are rendered from the same buffers
+	video::ScopedBuffer scopedBuf(_geometryBuffers[_currentGeometryBuffer]._buffer);
+	for (int i = 0; i < buffers.size; ++i) {
+		const ChunkBuffer& chunkBuffer = *buffers.visible[i];
 		core_assert(chunkBuffer.inuse);
-		const video::Buffer& buffer = chunkBuffer._buffer;
-		const int ibo = chunkBuffer._ibo;
-		const uint32_t numIndices = buffer.elements(ibo, 1, chunkBuffer._compressedIndexSize);
-		core_assert_msg(numIndices > 0u, "Empty meshes should not be part of the array");
-		video::ScopedBuffer scopedBuf(buffer);
+		const ChunkGeometryArena::Slot& slot = _arena.get(chunkBuffer._slot);
+		core_assert_msg(slot.numIndices > 0u, "Empty meshes should not be part of the array");
 		if (_worldShader->isActive()) {
 			const double delta = glm::clamp(core_max(0.0, chunkBuffer.scaleSeconds) / ScaleDuration, 0.0, 1.0);
 			const glm::vec3 &size = glm::mix(glm::vec3(1.0f), glm::vec3(1.0f, 0.4f, 1.0f), (float)delta);
 			const glm::mat4& model = glm::scale(size);
 			_worldShader->setModel(model);
 		}
-		video::drawElements(video::Primitive::Triangles, numIndices, chunkBuffer._compressedIndexSize);
+		video::drawElementsBaseVertex(video::Primitive::Triangles, slot.numIndices, slot.indexSize,
+				(int)_arena.baseIndex(chunkBuffer._slot), (int)_arena.baseVertex(chunkBuffer._slot));
 		++drawCalls;
 	}
 	return drawCalls;
 }
 
-}
\ No newline at end of file
+}
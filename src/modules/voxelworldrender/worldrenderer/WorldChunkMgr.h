@@ -6,11 +6,14 @@
 
 #include "math/Octree.h"
 #include "WorldMeshExtractor.h"
+#include "WorldOcclusionCuller.h"
+#include "ChunkGeometryArena.h"
 #include "video/Camera.h"
 #include "voxel/VoxelVertex.h"
 #include "WorldShader.h"
 #include "voxel/Mesh.h"
 #include "video/Buffer.h"
+#include "core/Var.h"
 #include <future>
 
 namespace voxelworldrender {
@@ -21,20 +24,12 @@ protected:
 		bool inuse = false;
 		double scaleSeconds = 0.0;
 		math::AABB<int> _aabb = {glm::ivec3(0), glm::ivec3(0)};
-		size_t _compressedIndexSize = 0;
-
-		video::Buffer _buffer;
-		int32_t _vbo = -1;
-		int32_t _ibo = -1;
-
-		~ChunkBuffer() {
-			reset();
-		}
+		ChunkOccluders _occluders;
+		// the slot of the chunk geometry arena - this is also the index in the chunk buffer array
+		int _slot = -1;
 
 		void reset() {
-			_buffer.shutdown();
-			_vbo = -1;
-			_ibo = -1;
+			_slot = -1;
 			inuse = false;
 		}
 
@@ -47,18 +42,38 @@ protected:
 		}
 	};
 
+	/**
+	 * @brief The vertex and index buffer that are shared by all chunks
+	 */
+	struct GeometryBuffer {
+		video::Buffer _buffer;
+		int32_t _vbo = -1;
+		int32_t _ibo = -1;
+	};
 
 	using Tree = math::Octree<ChunkBuffer *>;
 	Tree _octree;
 	static constexpr int MAX_CHUNKBUFFERS = 2048;
 	ChunkBuffer _chunkBuffers[MAX_CHUNKBUFFERS];
+	ChunkGeometryArena _arena;
+	// the data is copied from one buffer into the other if the arena must be defragmented or grown
+	GeometryBuffer _geometryBuffers[2];
+	int _currentGeometryBuffer = 0;
 	int _maxAllowedDistance = -1;
 
 	struct VisibleBuffers {
 		int size = 0;
 		ChunkBuffer* visible[MAX_CHUNKBUFFERS];
 	};
+	// the chunks in the (shifted) frustum aabb - includes the chunks that are casting shadows or are reflected
 	VisibleBuffers _visibleBuffers;
+	// the chunks that passed the frustum planes and the occlusion test of the camera
+	VisibleBuffers _unoccludedBuffers;
+	WorldOcclusionCuller _occlusionCuller;
+	std::vector<const ChunkOccluders*> _cullChunks;
+	std::vector<ChunkBuffer*> _cullBuffers;
+	std::vector<int> _cullVisible;
+	core::VarPtr _occlusionCulling;
 
 	shader::WorldShader* _worldShader;
 
@@ -68,11 +83,23 @@ protected:
 	int distance2(const glm::ivec3 &pos, const glm::ivec3 &pos2) const;
 
 	void cull(const video::Camera &camera);
+	void occlusionCull(const video::Camera &camera);
 	void handleMeshQueue();
+	bool createGeometryBuffer(GeometryBuffer& geometry, uint32_t vertexCapacity, uint32_t indexCapacity);
+	/**
+	 * @brief Copies the chunk meshes into a new buffer pair with the given capacities and compacts them
+	 */
+	bool rebuildGeometryBuffer(uint32_t vertexCapacity, uint32_t indexCapacity);
 public:
 	WorldChunkMgr(core::ThreadPool& threadPool);
 
-	int renderTerrain();
+	/**
+	 * @param occlusionCulled Only render the chunks that are visible for the camera. Passes with a different view
+	 * (shadows, reflections) must render all chunks.
+	 */
+	int renderTerrain(bool occlusionCulled = false);
+
+	const WorldOcclusionCuller::Stats& occlusionStats() const;
 
 	void extractMesh(const glm::ivec3 &pos);
 	void extractMeshes(const video::Camera &camera);
@@ -86,4 +113,8 @@ public:
 	void reset();
 };
 
+inline const WorldOcclusionCuller::Stats& WorldChunkMgr::occlusionStats() const {
+	return _occlusionCuller.stats();
+}
+
 }
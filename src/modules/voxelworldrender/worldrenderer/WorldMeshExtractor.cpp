@@ -4,12 +4,18 @@
 
 #include "WorldMeshExtractor.h"
 #include "core/concurrent/Concurrency.h"
+#include "core/Common.h"
 #include "voxel/CubicSurfaceExtractor.h"
 #include "voxel/IsQuadNeeded.h"
 #include "voxel/Constants.h"
 
 namespace voxelworldrender {
 
+namespace {
+// the amount of occluder cells per mesh side - the solid column extents of a cell form one occluder
+constexpr int OccluderCellsPerSide = 8;
+}
+
 WorldMeshExtractor::WorldMeshExtractor() {
 }
 
@@ -38,7 +44,7 @@ void WorldMeshExtractor::reset() {
 	_pendingExtraction.clear();
 }
 
-bool WorldMeshExtractor::pop(voxel::Mesh& item) {
+bool WorldMeshExtractor::pop(ExtractedMesh& item) {
 	core_trace_value_scoped(QueryNewMesh, _positionsExtracted.size());
 	return _extracted.pop(item);
 }
@@ -101,11 +107,13 @@ void WorldMeshExtractor::extractScheduledMesh() {
 	// they also heavily depend on the size of the mesh region we extract
 	const int factor = 64;
 	const int vertices = region.getWidthInVoxels() * region.getDepthInVoxels() * factor;
-	voxel::Mesh mesh(vertices, vertices);
-	voxel::extractCubicMesh(_volume, region, &mesh, voxel::IsQuadNeeded(), region.getLowerCorner());
-	if (!mesh.isEmpty()) {
-		_extracted.push(std::move(mesh));
+	ExtractedMesh extracted { voxel::Mesh(vertices, vertices) };
+	voxel::extractCubicMesh(_volume, region, &extracted.mesh, voxel::IsQuadNeeded(), region.getLowerCorner());
+	if (extracted.mesh.isEmpty()) {
+		return;
 	}
+	extractChunkOccluders(_volume, region, core_max(1, size.x / OccluderCellsPerSide), extracted.occluders);
+	_extracted.push(std::move(extracted));
 }
 
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "voxel/Mesh.h"
+#include "WorldOcclusionCuller.h"
 #include "core/concurrent/ThreadPool.h"
 #include "core/Var.h"
 #include "core/collection/ConcurrentQueue.h"
@@ -20,9 +21,18 @@ namespace voxelworldrender {
 
 typedef std::unordered_set<glm::ivec3, std::hash<glm::ivec3> > PositionSet;
 
+struct ExtractedMesh {
+	voxel::Mesh mesh;
+	ChunkOccluders occluders;
+
+	inline bool operator<(const ExtractedMesh& rhs) const {
+		return mesh < rhs.mesh;
+	}
+};
+
 class WorldMeshExtractor {
 private:
-	core::ConcurrentQueue<voxel::Mesh> _extracted;
+	core::ConcurrentQueue<ExtractedMesh> _extracted;
 	glm::ivec3 _pendingExtractionSortPosition { 0, 0, 0 };
 	struct CloseToPoint {
 		glm::ivec2 _refPoint;
@@ -52,7 +62,7 @@ public:
 	 * @brief We need to pop the mesh extractor queue to find out if there are new and ready to use meshes for us
 	 * @return @c false if this isn't the case, @c true if the given reference was filled with valid data.
 	 */
-	bool pop(voxel::Mesh& item);
+	bool pop(ExtractedMesh& item);
 
 	/**
 	 * @brief If you don't need an extracted mesh anymore, make sure to allow the reextraction at a later time.
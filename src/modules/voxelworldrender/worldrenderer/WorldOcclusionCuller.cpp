@@ -0,0 +1,194 @@
+/**
+ * @file
+ */
+
+#include "WorldOcclusionCuller.h"
+#include "core/Common.h"
+#include "core/Trace.h"
+#include "math/Frustum.h"
+#include "voxel/Voxel.h"
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <algorithm>
+
+namespace voxelworldrender {
+
+namespace {
+
+inline bool isOpaque(voxel::VoxelType material) {
+	return !voxel::isEnterable(material) && !voxel::isLeaves(material);
+}
+
+}
+
+bool extractChunkOccluders(const voxel::PagedVolume* volume, const voxel::Region& region, int cellSize, ChunkOccluders& out) {
+	core_trace_scoped(ExtractChunkOccluders);
+	core_assert(cellSize > 0);
+	out.occluders.clear();
+	const int width = region.getWidthInVoxels();
+	const int depth = region.getDepthInVoxels();
+	const int lowerY = region.getLowerY();
+	const int upperY = region.getUpperY();
+	// the longest opaque run per column - the upper value is exclusive
+	std::vector<int> runLower((size_t)width * depth, 0);
+	std::vector<int> runUpper((size_t)width * depth, 0);
+	glm::ivec3 mins(INT32_MAX);
+	glm::ivec3 maxs(INT32_MIN);
+
+	voxel::PagedVolume::Sampler sampler(volume);
+	for (int z = 0; z < depth; ++z) {
+		for (int x = 0; x < width; ++x) {
+			const int worldX = region.getLowerX() + x;
+			const int worldZ = region.getLowerZ() + z;
+			sampler.setPosition(worldX, lowerY, worldZ);
+			int runStart = -1;
+			int bestLower = 0;
+			int bestUpper = 0;
+			for (int y = lowerY; y <= upperY + 1; ++y) {
+				voxel::VoxelType material = voxel::VoxelType::Air;
+				if (y <= upperY) {
+					if (y > lowerY) {
+						sampler.movePositiveY();
+					}
+					material = sampler.voxel().getMaterial();
+					if (!voxel::isAir(material)) {
+						mins = glm::min(mins, glm::ivec3(worldX, y, worldZ));
+						maxs = glm::max(maxs, glm::ivec3(worldX, y, worldZ));
+					}
+				}
+				if (isOpaque(material)) {
+					if (runStart == -1) {
+						runStart = y;
+					}
+				} else if (runStart != -1) {
+					if (y - runStart > bestUpper - bestLower) {
+						bestLower = runStart;
+						bestUpper = y;
+					}
+					runStart = -1;
+				}
+			}
+			runLower[z * width + x] = bestLower;
+			runUpper[z * width + x] = bestUpper;
+		}
+	}
+	if (mins.x == INT32_MAX) {
+		return false;
+	}
+	out.bounds = math::AABB<int>(mins, maxs + 1);
+
+	// the occluders of the previous row of cells - a box is extended along the z axis if the next row contains the same box
+	std::vector<math::AABB<int>> previousRow;
+	std::vector<math::AABB<int>> row;
+	for (int cellZ = 0; cellZ < depth; cellZ += cellSize) {
+		const int cellDepth = core_min(cellSize, depth - cellZ);
+		const int worldZ = region.getLowerZ() + cellZ;
+		row.clear();
+		for (int cellX = 0; cellX < width; cellX += cellSize) {
+			const int cellWidth = core_min(cellSize, width - cellX);
+			// the run that is shared by all columns of the cell
+			int lower = INT32_MIN;
+			int upper = INT32_MAX;
+			for (int z = cellZ; z < cellZ + cellDepth; ++z) {
+				for (int x = cellX; x < cellX + cellWidth; ++x) {
+					lower = core_max(lower, runLower[z * width + x]);
+					upper = core_min(upper, runUpper[z * width + x]);
+				}
+			}
+			if (lower >= upper) {
+				continue;
+			}
+			const int worldX = region.getLowerX() + cellX;
+			if (!row.empty()) {
+				math::AABB<int>& last = row.back();
+				if (last.getUpperX() == worldX && last.getLowerY() == lower && last.getUpperY() == upper) {
+					last.setUpperX(worldX + cellWidth);
+					continue;
+				}
+			}
+			row.emplace_back(worldX, lower, worldZ, worldX + cellWidth, upper, worldZ + cellDepth);
+		}
+		std::vector<math::AABB<int>> extended;
+		std::vector<bool> done(previousRow.size(), true);
+		for (const math::AABB<int>& occluder : row) {
+			bool merged = false;
+			for (size_t i = 0; i < previousRow.size(); ++i) {
+				math::AABB<int>& previous = previousRow[i];
+				if (done[i] && previous.getLowerX() == occluder.getLowerX() && previous.getUpperX() == occluder.getUpperX()
+						&& previous.getLowerY() == occluder.getLowerY() && previous.getUpperY() == occluder.getUpperY()) {
+					previous.setUpperZ(occluder.getUpperZ());
+					extended.push_back(previous);
+					done[i] = false;
+					merged = true;
+					break;
+				}
+			}
+			if (!merged) {
+				extended.push_back(occluder);
+			}
+		}
+		// the boxes of the previous row that were not extended are complete
+		for (size_t i = 0; i < previousRow.size(); ++i) {
+			if (done[i]) {
+				out.occluders.push_back(previousRow[i]);
+			}
+		}
+		previousRow = std::move(extended);
+	}
+	out.occluders.insert(out.occluders.end(), previousRow.begin(), previousRow.end());
+	return true;
+}
+
+WorldOcclusionCuller::WorldOcclusionCuller(int width, int height, int maxOccluders) :
+		_buffer(width, height), _maxOccluders(maxOccluders) {
+}
+
+void WorldOcclusionCuller::cull(const video::Camera& camera, const std::vector<const ChunkOccluders*>& chunks, std::vector<int>& visible) {
+	core_trace_scoped(WorldOcclusionCull);
+	_stats = Stats();
+	_stats.chunks = (int)chunks.size();
+	visible.clear();
+	_candidates.clear();
+
+	const math::SIMDFrustum frustum(camera.frustum());
+	const glm::vec3& eye = camera.eye();
+	for (int i = 0; i < (int)chunks.size(); ++i) {
+		const math::AABB<int>& bounds = chunks[i]->bounds;
+		const glm::vec3 mins(bounds.getLowerCorner());
+		const glm::vec3 maxs(bounds.getUpperCorner());
+		if (!frustum.isVisible(mins, maxs)) {
+			++_stats.frustumCulled;
+			continue;
+		}
+		const glm::vec3& delta = glm::clamp(eye, mins, maxs) - eye;
+		_candidates.push_back(Candidate{i, glm::dot(delta, delta)});
+	}
+	// the closest chunks are the best occluders - and are rendered first
+	std::sort(_candidates.begin(), _candidates.end(), [] (const Candidate& lhs, const Candidate& rhs) {
+		return lhs.distance < rhs.distance;
+	});
+
+	_buffer.clear(camera.viewProjectionMatrix());
+	int occluders = 0;
+	for (const Candidate& candidate : _candidates) {
+		if (occluders >= _maxOccluders) {
+			break;
+		}
+		for (const math::AABB<int>& occluder : chunks[candidate.index]->occluders) {
+			_buffer.addOccluder(glm::vec3(occluder.getLowerCorner()), glm::vec3(occluder.getUpperCorner()));
+			++occluders;
+		}
+	}
+	_stats.occluders = _buffer.occluders();
+
+	for (const Candidate& candidate : _candidates) {
+		const math::AABB<int>& bounds = chunks[candidate.index]->bounds;
+		if (!_buffer.isVisible(glm::vec3(bounds.getLowerCorner()), glm::vec3(bounds.getUpperCorner()))) {
+			++_stats.occlusionCulled;
+			continue;
+		}
+		visible.push_back(candidate.index);
+	}
+}
+
+}
@@ -0,0 +1,83 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "math/AABB.h"
+#include "math/OcclusionBuffer.h"
+#include "video/Camera.h"
+#include "voxel/PagedVolume.h"
+#include "voxel/Region.h"
+#include <vector>
+
+namespace voxelworldrender {
+
+/**
+ * @brief The occlusion data of a mesh chunk
+ */
+struct ChunkOccluders {
+	/**
+	 * The bounds of the non air voxels in the chunk - the upper corner is exclusive
+	 */
+	math::AABB<int> bounds { glm::ivec3(0), glm::ivec3(0) };
+	/**
+	 * Boxes that are completely filled with opaque voxels - the upper corners are exclusive
+	 */
+	std::vector<math::AABB<int>> occluders;
+};
+
+/**
+ * @brief Collects the bounds and the solid column extents of the given region
+ *
+ * The columns are grouped into cells of @c cellSize x @c cellSize columns. The solid run of voxels that all
+ * columns of a cell share is used as occluder - cells with the same run are merged along the x axis.
+ *
+ * @return @c false if the region doesn't contain any non air voxel
+ */
+extern bool extractChunkOccluders(const voxel::PagedVolume* volume, const voxel::Region& region, int cellSize, ChunkOccluders& out);
+
+/**
+ * @brief Culls the chunks against the camera frustum planes and afterwards against the occluders of the
+ * closest chunks that are rasterized into a low resolution depth buffer.
+ */
+class WorldOcclusionCuller {
+public:
+	struct Stats {
+		int chunks = 0;
+		int frustumCulled = 0;
+		int occlusionCulled = 0;
+		int occluders = 0;
+	};
+private:
+	math::OcclusionBuffer _buffer;
+	int _maxOccluders;
+	struct Candidate {
+		int index;
+		float distance;
+	};
+	std::vector<Candidate> _candidates;
+	Stats _stats;
+public:
+	/**
+	 * @param maxOccluders The maximum amount of occluder boxes that are rasterized per cull call
+	 */
+	WorldOcclusionCuller(int width = 256, int height = 128, int maxOccluders = 2048);
+
+	/**
+	 * @param[in] chunks The chunks to cull
+	 * @param[out] visible The indices of the visible chunks in the given chunk list
+	 */
+	void cull(const video::Camera& camera, const std::vector<const ChunkOccluders*>& chunks, std::vector<int>& visible);
+
+	/**
+	 * @return The statistics of the last @c cull() call
+	 */
+	const Stats& stats() const;
+};
+
+inline const WorldOcclusionCuller::Stats& WorldOcclusionCuller::stats() const {
+	return _stats;
+}
+
+}
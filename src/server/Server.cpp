@@ -51,6 +51,7 @@ core::AppState Server::onConstruct() {
 	core::Var::get(cfg::ServerPort, SERVER_PORT);
 	core::Var::get(cfg::ServerHost, "0.0.0.0");
 	core::Var::get(cfg::ServerMaxClients, "1024");
+	core::Var::get(cfg::ServerNetworkThread, "true");
 	core::Var::get(cfg::ServerHttpPort, HTTP_SERVER_PORT, core::CV_REPLICATE);
 	core::Var::get(cfg::ServerSeed, "1", core::CV_REPLICATE);
 	core::Var::get(cfg::VoxelMeshSize, "16", core::CV_READONLY);
@@ -273,6 +273,12 @@ void createConstructor(const Table& table, core::String& src) {
 	src += "\t\t_membersPointer = (uint8_t*)&_m;\n";
 	src += "\t\treturn *this;\n";
 	src += "\t}\n\n";
+
+	src += "\tpersistence::Model* clone() const override {\n";
+	src += "\t\t" + table.classname + "* c = new " + table.classname + "(*this);\n";
+	src += "\t\tc->_flagToDelete = _flagToDelete;\n";
+	src += "\t\treturn c;\n";
+	src += "\t}\n\n";
 }
 
 static void createDBConditions(const Table& table, core::String& src) {
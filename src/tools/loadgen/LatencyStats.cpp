@@ -0,0 +1,65 @@
+/**
+ * @file
+ */
+
+#include "LatencyStats.h"
+#include "core/Common.h"
+#include <algorithm>
+#include <math.h>
+
+namespace loadgen {
+
+void LatencyStats::add(double millis) {
+	_samples.push_back(millis);
+	_sum += millis;
+	_sorted = false;
+}
+
+void LatencyStats::clear() {
+	_samples.clear();
+	_sum = 0.0;
+	_sorted = true;
+}
+
+void LatencyStats::sort() const {
+	if (_sorted) {
+		return;
+	}
+	std::sort(_samples.begin(), _samples.end());
+	_sorted = true;
+}
+
+double LatencyStats::mean() const {
+	if (_samples.empty()) {
+		return 0.0;
+	}
+	return _sum / (double)_samples.size();
+}
+
+double LatencyStats::min() const {
+	if (_samples.empty()) {
+		return 0.0;
+	}
+	sort();
+	return _samples.front();
+}
+
+double LatencyStats::max() const {
+	if (_samples.empty()) {
+		return 0.0;
+	}
+	sort();
+	return _samples.back();
+}
+
+double LatencyStats::percentile(double percentile) const {
+	if (_samples.empty()) {
+		return 0.0;
+	}
+	sort();
+	const double rank = ceil(core_max(0.0, core_min(100.0, percentile)) / 100.0 * (double)_samples.size());
+	const size_t index = (size_t)core_max(1.0, rank) - 1u;
+	return _samples[index];
+}
+
+}
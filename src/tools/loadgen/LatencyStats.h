@@ -0,0 +1,41 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include <vector>
+#include <stddef.h>
+
+namespace loadgen {
+
+/**
+ * @brief Collects the samples of one report interval and calculates the percentiles
+ */
+class LatencyStats {
+private:
+	mutable std::vector<double> _samples;
+	mutable bool _sorted = true;
+	double _sum = 0.0;
+
+	void sort() const;
+public:
+	void add(double millis);
+	void clear();
+
+	size_t count() const;
+	double mean() const;
+	double min() const;
+	double max() const;
+	/**
+	 * @param[in] percentile The percentile in the range [0-100]
+	 * @return The nearest rank percentile or @c 0.0 if there are no samples
+	 */
+	double percentile(double percentile) const;
+};
+
+inline size_t LatencyStats::count() const {
+	return _samples.size();
+}
+
+}
@@ -0,0 +1,293 @@
+/**
+ * @file
+ */
+
+#include "LoadGen.h"
+#include "core/io/Filesystem.h"
+#include "core/metric/Metric.h"
+#include "core/EventBus.h"
+#include "core/TimeProvider.h"
+#include "core/StringUtil.h"
+#include "core/Var.h"
+#include "network/ClientNetwork.h"
+#include "network/ClientMessageSender.h"
+#include "network/AuthFailedHandler.h"
+#include "network/CountingHandlers.h"
+#include "network/EntityUpdateHandler.h"
+#include "network/UserSpawnHandler.h"
+#include "engine-config.h"
+#include <glm/trigonometric.hpp>
+
+LoadGen::LoadGen(const metric::MetricPtr& metric, const io::FilesystemPtr& filesystem, const core::EventBusPtr& eventBus, const core::TimeProviderPtr& timeProvider) :
+		Super(metric, filesystem, eventBus, timeProvider) {
+	init(ORGANISATION, "loadgen");
+	_protocolHandlerRegistry = std::make_shared<network::ProtocolHandlerRegistry>();
+}
+
+core::AppState LoadGen::onConstruct() {
+	const core::AppState state = Super::onConstruct();
+	registerArg("--host").setDescription("The server host").setDefaultValue("127.0.0.1");
+	registerArg("--port").setDescription("The server port").setDefaultValue(SERVER_PORT);
+	registerArg("--users").setShort("-u").setDescription("The amount of simulated users").setDefaultValue("100");
+	registerArg("--rampup").setDescription("The amount of users that are connecting per second").setDefaultValue("50");
+	registerArg("--duration").setShort("-d").setDescription("The seconds to run - 0 runs until quit").setDefaultValue("60");
+	registerArg("--report").setDescription("The seconds between two reports").setDefaultValue("10");
+	registerArg("--actionrate").setDescription("The triggered actions per second per user").setDefaultValue("0.2");
+	registerArg("--script").setDescription("The movement script that every user walks in a loop - the users walk randomly without a script");
+	registerArg("--emailprefix").setDescription("The simulated users log in as <prefix><index>@loadgen.local").setDefaultValue("loadgen");
+	registerArg("--password").setDescription("The password of all simulated users").setDefaultValue("loadgen");
+	registerArg("--accounts").setDescription("Write the server commands that create the accounts of the simulated users to the given file and quit");
+	return state;
+}
+
+core::String LoadGen::email(int index) const {
+	return core::string::format("%s%i@loadgen.local", _emailPrefix.c_str(), index);
+}
+
+core::String LoadGen::name(int index) const {
+	return core::string::format("%s%i", _emailPrefix.c_str(), index);
+}
+
+bool LoadGen::writeAccounts(const core::String& file, int users) const {
+	core::String commands;
+	for (int i = 0; i < users; ++i) {
+		commands += core::string::format("sv_createuser %s %s %s\n", email(i).c_str(), name(i).c_str(), _password.c_str());
+	}
+	if (!filesystem()->syswrite(file, commands)) {
+		Log::error("Failed to write the accounts to %s", file.c_str());
+		return false;
+	}
+	Log::info("Wrote %i accounts to %s - execute them on the server with 'exec %s'", users, file.c_str(), file.c_str());
+	return true;
+}
+
+bool LoadGen::loadScript(const core::String& file) {
+	const core::String& content = filesystem()->load(file);
+	if (content.empty()) {
+		Log::error("Failed to load the movement script %s", file.c_str());
+		return false;
+	}
+	std::vector<core::String> lines;
+	core::string::splitString(content, lines, "\n");
+	for (const core::String& l : lines) {
+		const core::String& line = l.trim();
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+		std::vector<core::String> tokens;
+		core::string::splitString(line, tokens);
+		if (tokens.size() < 3u) {
+			Log::error("Invalid movement script line: '%s' - expected <seconds> <direction> <yaw-degrees> [action]", line.c_str());
+			return false;
+		}
+		loadgen::MovementStep step;
+		step.durationMillis = core::string::toFloat(tokens[0]) * 1000.0;
+		std::vector<core::String> directions;
+		core::string::splitString(tokens[1], directions, ",");
+		for (const core::String& direction : directions) {
+			if (direction == "forward") {
+				step.direction |= network::MoveDirection::MOVEFORWARD;
+			} else if (direction == "backward") {
+				step.direction |= network::MoveDirection::MOVEBACKWARD;
+			} else if (direction == "left") {
+				step.direction |= network::MoveDirection::MOVELEFT;
+			} else if (direction == "right") {
+				step.direction |= network::MoveDirection::MOVERIGHT;
+			} else if (direction == "jump") {
+				step.direction |= network::MoveDirection::JUMP;
+			} else if (direction != "none") {
+				Log::error("Unknown direction '%s' in the movement script", direction.c_str());
+				return false;
+			}
+		}
+		step.yaw = glm::radians(core::string::toFloat(tokens[2]));
+		step.action = tokens.size() > 3u && tokens[3] == "action";
+		if (step.durationMillis <= 0.0) {
+			Log::error("Invalid step duration in the movement script line: '%s'", line.c_str());
+			return false;
+		}
+		_script.push_back(step);
+	}
+	Log::info("Loaded %i movement steps from %s", (int)_script.size(), file.c_str());
+	return !_script.empty();
+}
+
+#define regHandler(type, handler) \
+	_protocolHandlerRegistry->registerHandler(network::EnumNameServerMsgType(type), std::make_shared<handler>());
+
+core::AppState LoadGen::onInit() {
+	const core::AppState state = Super::onInit();
+	if (state != core::AppState::Running) {
+		return state;
+	}
+
+	_host = getArgVal("--host", "127.0.0.1");
+	_port = (uint16_t)core::string::toInt(getArgVal("--port", SERVER_PORT));
+	const int users = core::string::toInt(getArgVal("--users", getArgVal("-u", "100")));
+	_rampUp = core_max(0.1f, core::string::toFloat(getArgVal("--rampup", "50")));
+	_durationMillis = core::string::toFloat(getArgVal("--duration", getArgVal("-d", "60"))) * 1000.0;
+	_reportIntervalMillis = core_max(1.0f, core::string::toFloat(getArgVal("--report", "10"))) * 1000.0;
+	_actionRate = core::string::toFloat(getArgVal("--actionrate", "0.2"));
+	_emailPrefix = getArgVal("--emailprefix", "loadgen");
+	_password = getArgVal("--password", "loadgen");
+
+	if (users <= 0) {
+		Log::error("No users to simulate");
+		return core::AppState::InitFailure;
+	}
+
+	if (hasArg("--accounts")) {
+		if (!writeAccounts(getArgVal("--accounts"), users)) {
+			return core::AppState::InitFailure;
+		}
+		// there are no users to simulate - the app quits
+		return state;
+	}
+
+	if (hasArg("--script") && !loadScript(getArgVal("--script"))) {
+		return core::AppState::InitFailure;
+	}
+
+	regHandler(network::ServerMsgType::UserSpawn, UserSpawnHandler);
+	regHandler(network::ServerMsgType::EntitySpawn, EntitySpawnHandler);
+	regHandler(network::ServerMsgType::EntityRemove, EntityRemoveHandler);
+	regHandler(network::ServerMsgType::EntityUpdate, EntityUpdateHandler);
+	regHandler(network::ServerMsgType::AuthFailed, AuthFailedHandler);
+	regHandler(network::ServerMsgType::AttribUpdate, AttribUpdateHandler);
+	regHandler(network::ServerMsgType::StartCooldown, StartCooldownHandler);
+	regHandler(network::ServerMsgType::StopCooldown, StopCooldownHandler);
+	regHandler(network::ServerMsgType::VarUpdate, VarUpdateHandler);
+	regHandler(network::ServerMsgType::UserInfo, UserInfoHandler);
+
+	eventBus()->subscribe<network::NewConnectionEvent>(*this);
+	eventBus()->subscribe<network::DisconnectEvent>(*this);
+
+	// every user has its own enet host and thus its own socket - the users are connected during the ramp up
+	_users.reserve(users);
+	for (int i = 0; i < users; ++i) {
+		const network::ClientNetworkPtr& network = std::make_shared<network::ClientNetwork>(_protocolHandlerRegistry, eventBus());
+		const network::ClientMessageSenderPtr& messageSender = std::make_shared<network::ClientMessageSender>(network);
+		std::unique_ptr<loadgen::SimulatedUser> user(new loadgen::SimulatedUser(i, email(i), _password, network,
+				messageSender, _timeProvider, _stats, _script, _actionRate));
+		if (!user->init()) {
+			Log::error("Failed to initialize the network layer");
+			return core::AppState::InitFailure;
+		}
+		_users.push_back(std::move(user));
+	}
+
+	_startMillis = _timeProvider->tickMillis();
+	_lastReportMillis = _startMillis;
+	Log::info("Simulate %i users on %s:%i - %.1f connects per second", users, _host.c_str(), (int)_port, _rampUp);
+
+	return state;
+}
+
+void LoadGen::onEvent(const network::NewConnectionEvent& event) {
+	loadgen::SimulatedUser* user = static_cast<loadgen::SimulatedUser*>(event.get().peer->data);
+	if (user != nullptr) {
+		user->onConnect();
+	}
+}
+
+void LoadGen::onEvent(const network::DisconnectEvent& event) {
+	ENetPeer* peer = event.connection().peer;
+	if (peer == nullptr || peer->data == nullptr) {
+		return;
+	}
+	static_cast<loadgen::SimulatedUser*>(peer->data)->onDisconnect();
+}
+
+void LoadGen::report(double nowMillis) {
+	const double seconds = (nowMillis - _lastReportMillis) / 1000.0;
+	_lastReportMillis = nowMillis;
+	if (seconds <= 0.0) {
+		return;
+	}
+	int states[(int)loadgen::SimulatedUser::State::Failed + 1] {};
+	for (const auto& user : _users) {
+		++states[(int)user->state()];
+	}
+	const double users = (double)core_max(1, states[(int)loadgen::SimulatedUser::State::Playing]);
+
+	Log::info("---- %.0f seconds ----", (nowMillis - _startMillis) / 1000.0);
+	Log::info("users: %i playing, %i logging in, %i connecting, %i failed (%i auth failures, %i disconnects)",
+			states[(int)loadgen::SimulatedUser::State::Playing], states[(int)loadgen::SimulatedUser::State::LoggingIn],
+			states[(int)loadgen::SimulatedUser::State::Connecting], states[(int)loadgen::SimulatedUser::State::Failed],
+			_stats.authFailures, _stats.disconnects);
+	const auto logLatency = [] (const char *name, const loadgen::LatencyStats& stats) {
+		Log::info("%s: %i samples - p50: %.1fms, p90: %.1fms, p99: %.1fms, max: %.1fms", name, (int)stats.count(),
+				stats.percentile(50.0), stats.percentile(90.0), stats.percentile(99.0), stats.max());
+	};
+	logLatency("login latency", _stats.login);
+	logLatency("move latency", _stats.move);
+	logLatency("server tick interval", _stats.tickInterval);
+	Log::info("upstream: %.1f kbit/s (%.0f packets/s) - %.0f bytes/s per user",
+			(double)_stats.sentBytes * 8.0 / 1000.0 / seconds, (double)_stats.sentPackets / seconds,
+			(double)_stats.sentBytes / seconds / users);
+	Log::info("downstream: %.1f kbit/s (%.0f packets/s) - %.0f bytes/s per user",
+			(double)_stats.receivedBytes * 8.0 / 1000.0 / seconds, (double)_stats.receivedPackets / seconds,
+			(double)_stats.receivedBytes / seconds / users);
+	for (int i = (int)network::ClientMsgType::MIN + 1; i <= (int)network::ClientMsgType::MAX; ++i) {
+		if (_stats.sentMessages[i] == 0u) {
+			continue;
+		}
+		Log::info("sent %s: %.1f/s", network::EnumNameClientMsgType((network::ClientMsgType)i), (double)_stats.sentMessages[i] / seconds);
+	}
+	for (int i = (int)network::ServerMsgType::MIN + 1; i <= (int)network::ServerMsgType::MAX; ++i) {
+		if (_stats.receivedMessages[i] == 0u) {
+			continue;
+		}
+		Log::info("received %s: %.1f/s", network::EnumNameServerMsgType((network::ServerMsgType)i), (double)_stats.receivedMessages[i] / seconds);
+	}
+	_stats.reset();
+}
+
+core::AppState LoadGen::onRunning() {
+	Super::onRunning();
+	if (_users.empty()) {
+		return core::AppState::Cleanup;
+	}
+	const double nowMillis = _timeProvider->tickMillis();
+	const int connect = core_min((int)_users.size(), (int)((nowMillis - _startMillis) / 1000.0 * _rampUp) + 1);
+	for (; _connected < connect; ++_connected) {
+		_users[_connected]->connect(_port, _host);
+	}
+	for (const auto& user : _users) {
+		user->update();
+	}
+	if (nowMillis - _lastReportMillis >= _reportIntervalMillis) {
+		report(nowMillis);
+	}
+	if (_durationMillis > 0.0 && nowMillis - _startMillis >= _durationMillis) {
+		report(nowMillis);
+		return core::AppState::Cleanup;
+	}
+	return core::AppState::Running;
+}
+
+core::AppState LoadGen::onCleanup() {
+	eventBus()->unsubscribe<network::NewConnectionEvent>(*this);
+	eventBus()->unsubscribe<network::DisconnectEvent>(*this);
+	for (const auto& user : _users) {
+		user->disconnect();
+	}
+	// flush the disconnects
+	for (const auto& user : _users) {
+		user->update();
+	}
+	for (const auto& user : _users) {
+		user->shutdown();
+	}
+	_users.clear();
+	return Super::onCleanup();
+}
+
+int main(int argc, char *argv[]) {
+	const core::EventBusPtr& eventBus = std::make_shared<core::EventBus>();
+	const io::FilesystemPtr& filesystem = std::make_shared<io::Filesystem>();
+	const core::TimeProviderPtr& timeProvider = std::make_shared<core::TimeProvider>();
+	const metric::MetricPtr& metric = std::make_shared<metric::Metric>();
+	LoadGen app(metric, filesystem, eventBus, timeProvider);
+	return app.startMainLoop(argc, argv);
+}
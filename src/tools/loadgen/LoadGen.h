@@ -0,0 +1,67 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/CommandlineApp.h"
+#include "core/EventBus.h"
+#include "network/NetworkEvents.h"
+#include "network/ProtocolHandlerRegistry.h"
+#include "SimulatedUser.h"
+#include "Stats.h"
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Headless load generator for the server. Spawns a lot of simulated users in one process that log in
+ * and walk around and reports the latencies, the server tick timing and the bandwidth.
+ *
+ * @ingroup Tools
+ */
+class LoadGen: public core::CommandlineApp,
+		public core::IEventBusHandler<network::NewConnectionEvent>,
+		public core::IEventBusHandler<network::DisconnectEvent> {
+private:
+	using Super = core::CommandlineApp;
+	network::ProtocolHandlerRegistryPtr _protocolHandlerRegistry;
+	std::vector<std::unique_ptr<loadgen::SimulatedUser>> _users;
+	loadgen::MovementScript _script;
+	loadgen::Stats _stats;
+
+	core::String _host;
+	uint16_t _port = 0u;
+	core::String _emailPrefix;
+	core::String _password;
+	// the users that are connecting per second
+	double _rampUp = 0.0;
+	double _actionRate = 0.0;
+	double _durationMillis = 0.0;
+	double _reportIntervalMillis = 0.0;
+
+	double _startMillis = 0.0;
+	double _lastReportMillis = 0.0;
+	int _connected = 0;
+
+	core::String email(int index) const;
+	core::String name(int index) const;
+	/**
+	 * @brief Writes the server commands that create the accounts of the simulated users
+	 */
+	bool writeAccounts(const core::String& file, int users) const;
+	/**
+	 * @brief Parses a movement script - one step per line: @c <seconds> <direction> <yaw-degrees> [action]
+	 */
+	bool loadScript(const core::String& file);
+	void report(double nowMillis);
+public:
+	LoadGen(const metric::MetricPtr& metric, const io::FilesystemPtr& filesystem, const core::EventBusPtr& eventBus, const core::TimeProviderPtr& timeProvider);
+
+	void onEvent(const network::NewConnectionEvent& event) override;
+	void onEvent(const network::DisconnectEvent& event) override;
+
+	core::AppState onConstruct() override;
+	core::AppState onInit() override;
+	core::AppState onRunning() override;
+	core::AppState onCleanup() override;
+};
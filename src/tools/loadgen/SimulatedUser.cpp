@@ -0,0 +1,187 @@
+/**
+ * @file
+ */
+
+#include "SimulatedUser.h"
+#include "core/Log.h"
+#include "core/Password.h"
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/epsilon.hpp>
+
+namespace loadgen {
+
+SimulatedUser::SimulatedUser(int index, const core::String& email, const core::String& password,
+		const network::ClientNetworkPtr& network, const network::ClientMessageSenderPtr& messageSender,
+		const core::TimeProviderPtr& timeProvider, Stats& stats, const MovementScript& script, double actionRate) :
+		_index(index), _email(email), _password(password), _network(network), _messageSender(messageSender),
+		_timeProvider(timeProvider), _stats(stats), _script(script), _random(index + 1), _actionRate(actionRate) {
+}
+
+bool SimulatedUser::init() {
+	return _network->init();
+}
+
+void SimulatedUser::shutdown() {
+	_network->shutdown();
+	_state = State::Idle;
+}
+
+bool SimulatedUser::connect(uint16_t port, const core::String& hostname) {
+	ENetPeer* peer = _network->connect(port, hostname);
+	if (peer == nullptr) {
+		Log::error("User %i failed to connect to server %s:%i", _index, hostname.c_str(), port);
+		_state = State::Failed;
+		return false;
+	}
+	peer->data = this;
+	_state = State::Connecting;
+	return true;
+}
+
+void SimulatedUser::disconnect() {
+	if (_state == State::Playing) {
+		send(network::ClientMsgType::UserDisconnect, network::CreateUserDisconnect(_fbb).Union());
+	}
+	_network->disconnect();
+	_state = State::Idle;
+}
+
+void SimulatedUser::send(network::ClientMsgType type, flatbuffers::Offset<void> data, uint32_t flags) {
+	if (_messageSender->sendClientMessage(_fbb, type, data, flags)) {
+		++_stats.sentMessages[(int)type];
+	}
+}
+
+void SimulatedUser::onConnect() {
+	Log::debug("User %i is connected - log in as %s", _index, _email.c_str());
+	const core::String& pwhash = core::pwhash(_password, "TODO");
+	_loginMillis = _timeProvider->tickMillis();
+	_state = State::LoggingIn;
+	send(network::ClientMsgType::UserConnect, network::CreateUserConnect(_fbb, _fbb.CreateString(_email.c_str(), _email.size()),
+			_fbb.CreateString(pwhash.c_str(), pwhash.size())).Union());
+}
+
+void SimulatedUser::onDisconnect() {
+	if (_state == State::Idle || _state == State::Failed) {
+		return;
+	}
+	Log::debug("User %i was disconnected", _index);
+	++_stats.disconnects;
+	_state = State::Failed;
+}
+
+void SimulatedUser::onAuthFailed() {
+	Log::warn("User %i failed to log in as %s", _index, _email.c_str());
+	++_stats.authFailures;
+	_state = State::Failed;
+}
+
+void SimulatedUser::onUserSpawn(int64_t id) {
+	// the first spawn after the login is our own user - all others are the users around us
+	if (_state != State::LoggingIn) {
+		return;
+	}
+	const double nowMillis = _timeProvider->tickMillis();
+	_stats.login.add(nowMillis - _loginMillis);
+	_entityId = id;
+	_state = State::Playing;
+	_nextStepMillis = nowMillis;
+	_nextActionMillis = nowMillis;
+	send(network::ClientMsgType::UserConnected, network::CreateUserConnected(_fbb).Union());
+}
+
+void SimulatedUser::onEntityUpdate(int64_t id, float rotation, int64_t serverMillis) {
+	if (id != _entityId) {
+		return;
+	}
+	if (_pendingMoveMillis >= 0.0 && glm::epsilonEqual(rotation, _pendingMoveYaw, 0.0001f)) {
+		_stats.move.add(_timeProvider->tickMillis() - _pendingMoveMillis);
+		_pendingMoveMillis = -1.0;
+	}
+	if (serverMillis <= 0) {
+		return;
+	}
+	// the server sends an update of the own user in every tick as long as it is moving
+	if (_direction == network::MoveDirection::NONE) {
+		_lastUpdateServerMillis = 0;
+		return;
+	}
+	if (_lastUpdateServerMillis > 0 && serverMillis > _lastUpdateServerMillis) {
+		_stats.tickInterval.add((double)(serverMillis - _lastUpdateServerMillis));
+	}
+	_lastUpdateServerMillis = serverMillis;
+}
+
+void SimulatedUser::onMessage(network::ServerMsgType type) {
+	++_stats.receivedMessages[(int)type];
+}
+
+void SimulatedUser::move(double nowMillis, network::MoveDirection direction, float yaw) {
+	if (direction == _direction && glm::epsilonEqual(yaw, _yaw, 0.0001f)) {
+		return;
+	}
+	if (direction != _direction) {
+		// the next update interval doesn't belong to the same movement
+		_lastUpdateServerMillis = 0;
+	}
+	_direction = direction;
+	_yaw = yaw;
+	_pendingMoveMillis = nowMillis;
+	_pendingMoveYaw = yaw;
+	// like the client the movement is sent unreliable
+	send(network::ClientMsgType::Move, network::CreateMove(_fbb, direction, 0.0f, yaw).Union(), 0u);
+}
+
+void SimulatedUser::nextStep(double nowMillis) {
+	if (!_script.empty()) {
+		const MovementStep& step = _script[_scriptStep];
+		_scriptStep = (_scriptStep + 1) % _script.size();
+		_nextStepMillis = nowMillis + step.durationMillis;
+		move(nowMillis, step.direction, step.yaw);
+		if (step.action) {
+			send(network::ClientMsgType::TriggerAction, network::CreateTriggerAction(_fbb).Union());
+		}
+		return;
+	}
+
+	_nextStepMillis = nowMillis + _random.randomf(1000.0f, 4000.0f);
+	const float yaw = _random.randomf(0.0f, glm::two_pi<float>());
+	const int choice = _random.random(0, 9);
+	network::MoveDirection direction;
+	if (choice < 3) {
+		direction = network::MoveDirection::NONE;
+	} else if (choice < 7) {
+		direction = network::MoveDirection::MOVEFORWARD;
+	} else if (choice == 7) {
+		direction = network::MoveDirection::MOVEFORWARD | network::MoveDirection::MOVELEFT;
+	} else if (choice == 8) {
+		direction = network::MoveDirection::MOVEFORWARD | network::MoveDirection::MOVERIGHT;
+	} else {
+		direction = network::MoveDirection::MOVEBACKWARD;
+	}
+	move(nowMillis, direction, yaw);
+}
+
+void SimulatedUser::update() {
+	_network->update();
+	const network::TrafficStats& traffic = _network->consumeTrafficStats();
+	_stats.sentBytes += traffic.sentBytes;
+	_stats.receivedBytes += traffic.receivedBytes;
+	_stats.sentPackets += traffic.sentPackets;
+	_stats.receivedPackets += traffic.receivedPackets;
+
+	if (_state != State::Playing) {
+		return;
+	}
+	const double nowMillis = _timeProvider->tickMillis();
+	if (nowMillis >= _nextStepMillis) {
+		nextStep(nowMillis);
+	}
+	if (_actionRate > 0.0 && nowMillis >= _nextActionMillis) {
+		send(network::ClientMsgType::TriggerAction, network::CreateTriggerAction(_fbb).Union());
+		// spread the actions of all users
+		_nextActionMillis = nowMillis + _random.randomf(0.5f, 1.5f) * 1000.0 / _actionRate;
+	}
+}
+
+}
@@ -0,0 +1,113 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Stats.h"
+#include "network/ClientNetwork.h"
+#include "network/ClientMessageSender.h"
+#include "math/Random.h"
+#include "core/String.h"
+#include "core/TimeProvider.h"
+#include <vector>
+
+namespace loadgen {
+
+/**
+ * @brief One step of a movement script that all simulated users are walking in a loop
+ */
+struct MovementStep {
+	double durationMillis = 1000.0;
+	network::MoveDirection direction = network::MoveDirection::NONE;
+	// radians
+	float yaw = 0.0f;
+	// trigger an action at the begin of the step
+	bool action = false;
+};
+
+using MovementScript = std::vector<MovementStep>;
+
+/**
+ * @brief A headless user that logs into the server and walks around - the server doesn't see a difference
+ * to a real client.
+ */
+class SimulatedUser {
+public:
+	enum class State {
+		Idle, Connecting, LoggingIn, Playing, Failed
+	};
+private:
+	const int _index;
+	const core::String _email;
+	const core::String _password;
+	network::ClientNetworkPtr _network;
+	network::ClientMessageSenderPtr _messageSender;
+	core::TimeProviderPtr _timeProvider;
+	Stats& _stats;
+	// if this is empty, the user walks randomly
+	const MovementScript& _script;
+	math::Random _random;
+	// the triggered actions per second
+	const double _actionRate;
+
+	State _state = State::Idle;
+	int64_t _entityId = -1;
+	flatbuffers::FlatBufferBuilder _fbb;
+
+	double _loginMillis = 0.0;
+	size_t _scriptStep = 0u;
+	double _nextStepMillis = 0.0;
+	double _nextActionMillis = 0.0;
+	network::MoveDirection _direction = network::MoveDirection::NONE;
+	float _yaw = 0.0f;
+
+	// the local time the last move was sent at - negative if the server already answered it
+	double _pendingMoveMillis = -1.0;
+	float _pendingMoveYaw = 0.0f;
+	// the server time of the last update of the own user that was received while moving
+	int64_t _lastUpdateServerMillis = 0;
+
+	void send(network::ClientMsgType type, flatbuffers::Offset<void> data, uint32_t flags = ENET_PACKET_FLAG_RELIABLE);
+	void nextStep(double nowMillis);
+	void move(double nowMillis, network::MoveDirection direction, float yaw);
+public:
+	SimulatedUser(int index, const core::String& email, const core::String& password,
+			const network::ClientNetworkPtr& network, const network::ClientMessageSenderPtr& messageSender,
+			const core::TimeProviderPtr& timeProvider, Stats& stats, const MovementScript& script, double actionRate);
+
+	bool init();
+	void shutdown();
+
+	bool connect(uint16_t port, const core::String& hostname);
+	/**
+	 * @brief Logs out and starts the disconnect - the network still has to be updated to send it
+	 */
+	void disconnect();
+
+	/**
+	 * @brief Services the connection and walks the user around
+	 */
+	void update();
+
+	// the callbacks of the network layer
+	void onConnect();
+	void onDisconnect();
+	void onAuthFailed();
+	void onUserSpawn(int64_t id);
+	void onEntityUpdate(int64_t id, float rotation, int64_t serverMillis);
+	void onMessage(network::ServerMsgType type);
+
+	int index() const;
+	State state() const;
+};
+
+inline int SimulatedUser::index() const {
+	return _index;
+}
+
+inline SimulatedUser::State SimulatedUser::state() const {
+	return _state;
+}
+
+}
@@ -0,0 +1,53 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "LatencyStats.h"
+#include "ClientMessages_generated.h"
+#include "ServerMessages_generated.h"
+#include <stdint.h>
+
+namespace loadgen {
+
+/**
+ * @brief The measurements of all simulated users
+ */
+struct Stats {
+	// UserConnect until the UserSpawn of the own user - collected over the whole run
+	LatencyStats login;
+	// Move until the own EntityUpdate with the new orientation
+	LatencyStats move;
+	// the server time between two consecutive EntityUpdates of the own moving user - this is the world tick
+	LatencyStats tickInterval;
+
+	uint64_t sentBytes = 0u;
+	uint64_t receivedBytes = 0u;
+	uint64_t sentPackets = 0u;
+	uint64_t receivedPackets = 0u;
+
+	uint64_t sentMessages[(int)network::ClientMsgType::MAX + 1] {};
+	uint64_t receivedMessages[(int)network::ServerMsgType::MAX + 1] {};
+
+	int authFailures = 0;
+	int disconnects = 0;
+
+	/**
+	 * @brief Resets the values of the report interval
+	 */
+	void reset() {
+		move.clear();
+		tickInterval.clear();
+		sentBytes = receivedBytes = 0u;
+		sentPackets = receivedPackets = 0u;
+		for (uint64_t& n : sentMessages) {
+			n = 0u;
+		}
+		for (uint64_t& n : receivedMessages) {
+			n = 0u;
+		}
+	}
+};
+
+}
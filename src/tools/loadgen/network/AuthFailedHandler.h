@@ -0,0 +1,14 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "ILoadGenProtocolHandler.h"
+
+/**
+ * The account of the simulated user doesn't exist or the password is wrong
+ */
+LOADGENPROTOHANDLERIMPL(AuthFailed) {
+	user->onAuthFailed();
+}
@@ -0,0 +1,18 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "ILoadGenProtocolHandler.h"
+
+/**
+ * The messages that the simulated users don't react on - they are only counted for the report
+ */
+LOADGENCOUNTHANDLER(EntitySpawn);
+LOADGENCOUNTHANDLER(EntityRemove);
+LOADGENCOUNTHANDLER(AttribUpdate);
+LOADGENCOUNTHANDLER(StartCooldown);
+LOADGENCOUNTHANDLER(StopCooldown);
+LOADGENCOUNTHANDLER(VarUpdate);
+LOADGENCOUNTHANDLER(UserInfo);
@@ -0,0 +1,14 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "ILoadGenProtocolHandler.h"
+
+/**
+ * Measures the latency of the movement and the tick interval of the server
+ */
+LOADGENPROTOHANDLERIMPL(EntityUpdate) {
+	user->onEntityUpdate(message->id(), message->rotation(), message->serverMillis());
+}
@@ -0,0 +1,51 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "ServerMessages_generated.h"
+#include "network/IMsgProtocolHandler.h"
+#include "../SimulatedUser.h"
+
+namespace loadgen {
+
+/**
+ * @brief Counts the received messages for the simulated user that is attached to the peer
+ */
+template<class MSGTYPE, network::ServerMsgType TYPE>
+class ILoadGenProtocolHandler: public network::IMsgProtocolHandler<MSGTYPE, SimulatedUser> {
+public:
+	ILoadGenProtocolHandler() :
+			network::IMsgProtocolHandler<MSGTYPE, SimulatedUser>(true, network::EnumNameServerMsgType(TYPE)) {
+	}
+
+	virtual ~ILoadGenProtocolHandler() {
+	}
+
+	void execute(SimulatedUser* user, const MSGTYPE* message) override {
+		user->onMessage(TYPE);
+		handle(user, message);
+	}
+
+	virtual void handle(SimulatedUser* user, const MSGTYPE* message) {
+	}
+};
+
+}
+
+#define LOADGENPROTOHANDLER(msgType) \
+struct msgType##Handler: public loadgen::ILoadGenProtocolHandler<network::msgType, network::ServerMsgType::msgType> { \
+	void handle(loadgen::SimulatedUser* user, const network::msgType* message) override; \
+}
+
+#define LOADGENPROTOHANDLERIMPL(msgType) \
+LOADGENPROTOHANDLER(msgType); \
+inline void msgType##Handler::handle(loadgen::SimulatedUser* user, const network::msgType* message)
+
+/**
+ * @brief The messages that are only counted
+ */
+#define LOADGENCOUNTHANDLER(msgType) \
+struct msgType##Handler: public loadgen::ILoadGenProtocolHandler<network::msgType, network::ServerMsgType::msgType> { \
+}
@@ -0,0 +1,14 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "ILoadGenProtocolHandler.h"
+
+/**
+ * The first spawn after the login is the simulated user itself
+ */
+LOADGENPROTOHANDLERIMPL(UserSpawn) {
+	user->onUserSpawn(message->id());
+}
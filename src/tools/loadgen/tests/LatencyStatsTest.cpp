@@ -0,0 +1,58 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "../LatencyStats.h"
+
+namespace loadgen {
+
+class LatencyStatsTest: public core::AbstractTest {
+};
+
+TEST_F(LatencyStatsTest, testEmpty) {
+	LatencyStats stats;
+	EXPECT_EQ(0u, stats.count());
+	EXPECT_DOUBLE_EQ(0.0, stats.percentile(50.0));
+	EXPECT_DOUBLE_EQ(0.0, stats.mean());
+	EXPECT_DOUBLE_EQ(0.0, stats.max());
+}
+
+TEST_F(LatencyStatsTest, testPercentiles) {
+	LatencyStats stats;
+	// add them in reverse order - the samples must be sorted
+	for (int i = 100; i >= 1; --i) {
+		stats.add((double)i);
+	}
+	EXPECT_EQ(100u, stats.count());
+	EXPECT_DOUBLE_EQ(1.0, stats.min());
+	EXPECT_DOUBLE_EQ(100.0, stats.max());
+	EXPECT_DOUBLE_EQ(50.5, stats.mean());
+	EXPECT_DOUBLE_EQ(1.0, stats.percentile(0.0));
+	EXPECT_DOUBLE_EQ(50.0, stats.percentile(50.0));
+	EXPECT_DOUBLE_EQ(90.0, stats.percentile(90.0));
+	EXPECT_DOUBLE_EQ(99.0, stats.percentile(99.0));
+	EXPECT_DOUBLE_EQ(100.0, stats.percentile(100.0));
+}
+
+TEST_F(LatencyStatsTest, testAddAfterPercentile) {
+	LatencyStats stats;
+	stats.add(10.0);
+	stats.add(20.0);
+	EXPECT_DOUBLE_EQ(20.0, stats.percentile(99.0));
+	stats.add(5.0);
+	EXPECT_DOUBLE_EQ(5.0, stats.percentile(1.0));
+	EXPECT_DOUBLE_EQ(20.0, stats.max());
+}
+
+TEST_F(LatencyStatsTest, testClear) {
+	LatencyStats stats;
+	stats.add(10.0);
+	stats.clear();
+	EXPECT_EQ(0u, stats.count());
+	stats.add(3.0);
+	EXPECT_DOUBLE_EQ(3.0, stats.mean());
+	EXPECT_DOUBLE_EQ(3.0, stats.percentile(50.0));
+}
+
+}
@@ -0,0 +1,108 @@
+/**
+ * @file
+ */
+
+#include "HeadlessThumbnailer.h"
+#include "core/Var.h"
+#include "core/command/Command.h"
+#include "core/concurrent/Concurrency.h"
+#include "core/io/Filesystem.h"
+#include "core/StringUtil.h"
+#include "image/Image.h"
+#include "voxel/MaterialColor.h"
+#include "voxelformat/Loader.h"
+#include "voxelformat/VoxFileFormat.h"
+
+HeadlessThumbnailer::HeadlessThumbnailer(const metric::MetricPtr& metric, const io::FilesystemPtr& filesystem, const core::EventBusPtr& eventBus, const core::TimeProviderPtr& timeProvider) :
+		Super(metric, filesystem, eventBus, timeProvider), _rasterizer(core::cpus()) {
+	init(ORGANISATION, "thumbnailer");
+	_initialLogLevel = SDL_LOG_PRIORITY_ERROR;
+}
+
+core::AppState HeadlessThumbnailer::onConstruct() {
+	core::AppState state = Super::onConstruct();
+
+	auto thumbnailSizeFunc = [&] (const core::CmdArgs& args) {
+		if (args.size() == 0) {
+			return;
+		}
+		_outputSize = core::string::toInt(args[0]);
+	};
+
+	core::Command::registerCommand("s", thumbnailSizeFunc).setHelp("Size of the thumbnail in pixels");
+	core::Command::registerCommand("size", thumbnailSizeFunc).setHelp("Size of the thumbnail in pixels");
+	registerArg("--cpu").setDescription("Render the thumbnail on the cpu - no graphics context is needed");
+
+	return state;
+}
+
+core::AppState HeadlessThumbnailer::onInit() {
+	const core::AppState state = Super::onInit();
+	if (state != core::AppState::Running) {
+		Log::error("Failed to init application");
+		return state;
+	}
+
+	if (_argc < 3) {
+		_logLevelVar->setVal(SDL_LOG_PRIORITY_INFO);
+		Log::init();
+		usage();
+		return core::AppState::InitFailure;
+	}
+
+	const core::String infile = _argv[_argc - 2];
+	_outfile = _argv[_argc - 1];
+
+	Log::debug("infile: %s", infile.c_str());
+	Log::debug("outfile: %s", _outfile.c_str());
+
+	_infile = filesystem()->open(infile, io::FileMode::Read);
+	if (!_infile->exists()) {
+		Log::error("Given input file '%s' does not exist", infile.c_str());
+		return core::AppState::InitFailure;
+	}
+
+	if (!voxel::initDefaultMaterialColors()) {
+		Log::error("Failed to init default material colors");
+		return core::AppState::InitFailure;
+	}
+
+	_rasterizer.init();
+
+	return state;
+}
+
+core::AppState HeadlessThumbnailer::onRunning() {
+	const core::AppState state = Super::onRunning();
+
+	voxel::VoxelVolumes volumes;
+	if (!voxelformat::loadVolumeFormat(_infile, volumes)) {
+		Log::error("Failed to load given input file");
+		return core::AppState::Cleanup;
+	}
+	voxel::RawVolume* volume = volumes.merge();
+	voxelformat::clearVolumes(volumes);
+	if (volume == nullptr) {
+		Log::error("Failed to merge volumes");
+		return core::AppState::Cleanup;
+	}
+
+	std::vector<uint8_t> pixels;
+	if (_rasterizer.render(*volume, _outputSize, _outputSize, pixels)) {
+		const io::FilePtr& outfile = filesystem()->open(_outfile, io::FileMode::Write);
+		if (!image::Image::writePng(outfile->name().c_str(), pixels.data(), _outputSize, _outputSize, 4)) {
+			Log::error("Failed to write image %s", outfile->name().c_str());
+		} else {
+			Log::info("Created thumbnail at %s", outfile->name().c_str());
+		}
+	} else {
+		Log::error("Failed to render the volume");
+	}
+	delete volume;
+	return state;
+}
+
+core::AppState HeadlessThumbnailer::onCleanup() {
+	_rasterizer.shutdown();
+	return Super::onCleanup();
+}
@@ -0,0 +1,35 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/CommandlineApp.h"
+#include "core/io/File.h"
+#include "voxelutil/VolumeRasterizer.h"
+
+/**
+ * @brief Generates the thumbnails on the cpu - this doesn't need a graphics context and works on
+ * machines without gpu (e.g. build or asset servers).
+ *
+ * @see voxelutil::VolumeRasterizer
+ * @ingroup Tools
+ */
+class HeadlessThumbnailer: public core::CommandlineApp {
+private:
+	using Super = core::CommandlineApp;
+
+	io::FilePtr _infile;
+	core::String _outfile;
+	int _outputSize = 128;
+
+	voxelutil::VolumeRasterizer _rasterizer;
+
+public:
+	HeadlessThumbnailer(const metric::MetricPtr& metric, const io::FilesystemPtr& filesystem, const core::EventBusPtr& eventBus, const core::TimeProviderPtr& timeProvider);
+
+	core::AppState onConstruct() override;
+	core::AppState onInit() override;
+	core::AppState onRunning() override;
+	core::AppState onCleanup() override;
+};
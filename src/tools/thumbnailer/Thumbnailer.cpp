@@ -3,6 +3,7 @@
  */
 
 #include "Thumbnailer.h"
+#include "HeadlessThumbnailer.h"
 #include "core/Color.h"
 #include "core/command/Command.h"
 #include "core/io/Filesystem.h"
@@ -34,6 +35,7 @@ core::AppState Thumbnailer::onConstruct() {
 
 	core::Command::registerCommand("s", thumbnailSizeFunc).setHelp("Size of the thumbnail in pixels");
 	core::Command::registerCommand("size", thumbnailSizeFunc).setHelp("Size of the thumbnail in pixels");
+	registerArg("--cpu").setDescription("Render the thumbnail on the cpu - no graphics context is needed");
 
 	_renderer.construct();
 
@@ -171,6 +173,12 @@ int main(int argc, char *argv[]) {
 	const io::FilesystemPtr& filesystem = std::make_shared<io::Filesystem>();
 	const core::TimeProviderPtr& timeProvider = std::make_shared<core::TimeProvider>();
 	const metric::MetricPtr& metric = std::make_shared<metric::Metric>();
+	for (int i = 1; i < argc; ++i) {
+		if (!SDL_strcmp(argv[i], "--cpu")) {
+			HeadlessThumbnailer app(metric, filesystem, eventBus, timeProvider);
+			return app.startMainLoop(argc, argv);
+		}
+	}
 	Thumbnailer app(metric, filesystem, eventBus, timeProvider);
 	return app.startMainLoop(argc, argv);
 }
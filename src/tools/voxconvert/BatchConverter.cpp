@@ -0,0 +1,207 @@
+/**
+ * @file
+ */
+
+#include "BatchConverter.h"
+#include "core/Common.h"
+#include "core/Log.h"
+#include "core/MD5.h"
+#include "core/StringUtil.h"
+#include "core/concurrent/ThreadPool.h"
+#include <algorithm>
+#include <future>
+#include <unordered_map>
+
+namespace voxconvert {
+
+BatchConverter::BatchConverter(const io::FilesystemPtr& filesystem, const core::String& outputDir, const core::String& format,
+		const core::String& options, const ConvertFunc& convert) :
+		_filesystem(filesystem), _outputDir(outputDir), _format(format), _options(options), _convert(convert) {
+}
+
+core::String BatchConverter::outfile(const core::String& infile) const {
+	// keep the source extension - a.vox and a.qb must not end up in the same output file
+	return _outputDir + "/" + core::string::extractFilenameWithExtension(infile) + "." + _format;
+}
+
+bool BatchConverter::parseManifest(const core::String& content, Jobs& jobs) const {
+	std::vector<core::String> lines;
+	core::string::splitString(content, lines, "\r\n");
+	for (const core::String& line : lines) {
+		if (line[0] == '#') {
+			continue;
+		}
+		// the file names may contain spaces - only a tab separates the output file
+		const size_t tab = line.find("\t");
+		const core::String infile = tab == core::String::npos ? line : line.substr(0, tab);
+		if (infile.empty()) {
+			Log::error("Invalid manifest line '%s'", line.c_str());
+			return false;
+		}
+		const core::String outfile = tab == core::String::npos ? "" : line.substr(tab + 1);
+		jobs.push_back(Job{infile, outfile.empty() ? this->outfile(infile) : outfile});
+	}
+	return true;
+}
+
+bool BatchConverter::collectJobs(const core::String& input, const std::vector<core::String>& extensions, Jobs& jobs) const {
+	if (io::Filesystem::isReadableDir(input)) {
+		const core::String& dir = io::Filesystem::absolutePath(input);
+		// the output files would be picked up as input files by the next run
+		if (dir == io::Filesystem::absolutePath(_outputDir)) {
+			Log::error("The output directory must differ from the input directory '%s'", dir.c_str());
+			return false;
+		}
+		std::vector<io::Filesystem::DirEntry> entries;
+		_filesystem->list(dir, entries);
+		for (const io::Filesystem::DirEntry& entry : entries) {
+			if (entry.type != io::Filesystem::DirEntry::Type::file) {
+				continue;
+			}
+			const core::String& ext = entry.name.substr(entry.name.rfind('.') + 1);
+			if (std::find(extensions.begin(), extensions.end(), ext) == extensions.end()) {
+				continue;
+			}
+			const core::String infile = dir + "/" + entry.name;
+			jobs.push_back(Job{infile, outfile(infile)});
+		}
+	} else {
+		const io::FilePtr& manifest = _filesystem->open(input, io::FileMode::Read);
+		if (!manifest->exists()) {
+			Log::error("Given batch input '%s' is neither a directory nor a manifest file", input.c_str());
+			return false;
+		}
+		if (!parseManifest(manifest->load(), jobs)) {
+			return false;
+		}
+	}
+
+	std::unordered_map<core::String, const Job*, core::StringHash> outfiles;
+	for (const Job& job : jobs) {
+		auto i = outfiles.find(job.outfile);
+		if (i != outfiles.end()) {
+			Log::error("'%s' and '%s' would both be written to '%s'", i->second->infile.c_str(),
+					job.infile.c_str(), job.outfile.c_str());
+			return false;
+		}
+		outfiles.emplace(job.outfile, &job);
+	}
+	return true;
+}
+
+BatchConverter::Result BatchConverter::convertJob(const Job& job, const core::String& cachedHash, bool outputExists, bool force) const {
+	// the input buffer is reused for all files that are converted by this worker
+	thread_local std::vector<uint8_t> buffer;
+	Result result;
+	{
+		// the calling thread made sure that the file exists
+		const io::FilePtr& file = _filesystem->open(job.infile, io::FileMode::Read);
+		const long length = file->length();
+		if (length <= 0) {
+			Log::error("Given input file '%s' is empty", job.infile.c_str());
+			return result;
+		}
+		buffer.resize(length);
+		if (file->read(buffer.data(), (int)length) != (int)length) {
+			Log::error("Failed to read input file '%s'", job.infile.c_str());
+			return result;
+		}
+	}
+	const long length = (long)buffer.size();
+	result.bytes = (uint64_t)length;
+	result.hash = core::md5sum(buffer.data(), (uint32_t)length);
+
+	if (outputExists && result.hash == cachedHash) {
+		result.state = Result::State::Skipped;
+		return result;
+	}
+	if (outputExists && cachedHash.empty() && !force) {
+		Log::error("Given output file '%s' already exists", job.outfile.c_str());
+		return result;
+	}
+
+	const io::FilePtr& outputFile = _filesystem->open(job.outfile, io::FileMode::Write);
+	if (!outputFile->validHandle()) {
+		Log::error("Could not open target file: %s", job.outfile.c_str());
+		return result;
+	}
+	// the input is converted from the loaded buffer - it's not read a second time
+	const io::FilePtr& inputFile = io::Filesystem::openMemory(job.infile, buffer.data(), buffer.size());
+	if (_convert(inputFile, outputFile)) {
+		Log::info("Wrote output file %s", outputFile->name().c_str());
+		result.state = Result::State::Converted;
+	}
+	return result;
+}
+
+bool BatchConverter::run(const Jobs& jobs, int threads, bool force, Stats& stats) const {
+	if (!_filesystem->createDir(_outputDir)) {
+		Log::error("Failed to create output directory '%s'", _outputDir.c_str());
+		return false;
+	}
+
+	// the cache maps the input files to the content hash of the last successful conversion - one
+	// tab separated line of hash, options and input file per entry
+	const core::String cacheFile = _outputDir + "/" + CacheFile;
+	std::unordered_map<core::String, core::String, core::StringHash> cache;
+	const io::FilePtr& cacheFilePtr = _filesystem->open(cacheFile, io::FileMode::Read);
+	if (cacheFilePtr->exists()) {
+		std::vector<core::String> lines;
+		core::string::splitString(cacheFilePtr->load(), lines, "\n");
+		for (const core::String& line : lines) {
+			std::vector<core::String> tokens;
+			core::string::splitString(line, tokens, "\t");
+			if (tokens.size() == 3u && tokens[1] == _options) {
+				cache[tokens[2]] = tokens[0];
+			}
+		}
+	}
+
+	// the jobs with a missing input file are not queued - their future stays invalid
+	std::vector<std::future<Result>> futures(jobs.size());
+	{
+		core::ThreadPool pool(core_max(1, threads), "voxconvert");
+		pool.init();
+		for (size_t n = 0; n < jobs.size(); ++n) {
+			const Job& job = jobs[n];
+			// opening a missing file sets the sdl error - the error buffers of the pool threads are never freed
+			if (!_filesystem->exists(job.infile)) {
+				Log::error("Given input file '%s' does not exist", job.infile.c_str());
+				continue;
+			}
+			auto i = cache.find(job.infile);
+			const core::String cachedHash = i == cache.end() ? "" : i->second;
+			const io::FilePtr& existing = _filesystem->open(job.outfile, io::FileMode::Read);
+			const bool outputExists = existing->exists() && existing->length() > 0;
+			futures[n] = pool.enqueue([this, &job, cachedHash, outputExists, force] () {
+				return convertJob(job, cachedHash, outputExists, force);
+			});
+		}
+		// wait for all queued jobs - the destructor would drop them
+		pool.shutdown(true);
+	}
+
+	core::String cacheContent;
+	for (size_t i = 0; i < futures.size(); ++i) {
+		const Result& result = futures[i].valid() ? futures[i].get() : Result();
+		stats.bytes += result.bytes;
+		switch (result.state) {
+		case Result::State::Converted:
+			++stats.converted;
+			break;
+		case Result::State::Skipped:
+			++stats.skipped;
+			break;
+		case Result::State::Failed:
+			++stats.failed;
+			continue;
+		}
+		cacheContent += core::string::format("%s\t%s\t%s\n", result.hash.c_str(), _options.c_str(), jobs[i].infile.c_str());
+	}
+	if (!_filesystem->syswrite(cacheFile, cacheContent)) {
+		Log::warn("Failed to write the conversion cache '%s'", cacheFile.c_str());
+	}
+	return true;
+}
+
+}
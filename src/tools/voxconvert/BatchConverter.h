@@ -0,0 +1,91 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include "core/io/File.h"
+#include "core/io/Filesystem.h"
+#include <functional>
+#include <stdint.h>
+#include <vector>
+
+namespace voxconvert {
+
+/**
+ * @brief Converts the files of a directory or a manifest file in parallel
+ *
+ * The output files are named after the input file - including its extension - with the extension of
+ * the target format appended (@c a.qb is converted to @c a.qb.vox). The conversion fails if two input
+ * files would be written to the same output file.
+ *
+ * The content hashes of the converted input files are stored in the cache file of the output directory.
+ * Input files that didn't change since the last run with the same options are skipped.
+ */
+class BatchConverter {
+public:
+	/**
+	 * @param[in] inputFile Read only file with the already loaded content of the input file
+	 */
+	using ConvertFunc = std::function<bool(const io::FilePtr& inputFile, const io::FilePtr& outputFile)>;
+
+	struct Job {
+		core::String infile;
+		core::String outfile;
+	};
+	using Jobs = std::vector<Job>;
+
+	struct Stats {
+		int converted = 0;
+		int skipped = 0;
+		int failed = 0;
+		uint64_t bytes = 0u;
+	};
+
+	static constexpr const char* CacheFile = ".voxconvert-cache";
+private:
+	struct Result {
+		enum class State {
+			Converted, Skipped, Failed
+		};
+		State state = State::Failed;
+		core::String hash;
+		uint64_t bytes = 0u;
+	};
+
+	const io::FilesystemPtr _filesystem;
+	const core::String _outputDir;
+	const core::String _format;
+	const core::String _options;
+	const ConvertFunc _convert;
+
+	Result convertJob(const Job& job, const core::String& cachedHash, bool outputExists, bool force) const;
+	bool parseManifest(const core::String& content, Jobs& jobs) const;
+public:
+	/**
+	 * @param[in] options Identifies the conversion options - the cached content hashes are only
+	 * valid for the same options
+	 */
+	BatchConverter(const io::FilesystemPtr& filesystem, const core::String& outputDir, const core::String& format,
+			const core::String& options, const ConvertFunc& convert);
+
+	core::String outfile(const core::String& infile) const;
+
+	/**
+	 * @brief Collects the conversion jobs for the given directory or manifest file
+	 * @param[in] input Either a directory that is scanned for files with one of the given extensions, or a
+	 * manifest file with one @c infile per line - optionally followed by a tab and the @c outfile
+	 * @return @c false if the input couldn't get read, the output directory is the given input directory or two
+	 * jobs would write the same output file
+	 */
+	bool collectJobs(const core::String& input, const std::vector<core::String>& extensions, Jobs& jobs) const;
+
+	/**
+	 * @param[in] force Overwrite existing output files that are not known to the cache
+	 * @return @c false if the output directory couldn't get created
+	 */
+	bool run(const Jobs& jobs, int threads, bool force, Stats& stats) const;
+};
+
+}
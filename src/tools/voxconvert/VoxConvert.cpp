@@ -3,6 +3,7 @@
  */
 
 #include "VoxConvert.h"
+#include "BatchConverter.h"
 #include "core/Color.h"
 #include "core/Var.h"
 #include "core/command/Command.h"
@@ -10,6 +11,8 @@
 #include "core/metric/Metric.h"
 #include "core/EventBus.h"
 #include "core/TimeProvider.h"
+#include "core/StringUtil.h"
+#include "core/concurrent/Concurrency.h"
 #include "voxel/MaterialColor.h"
 #include "voxelformat/Loader.h"
 #include "voxelformat/VoxFileFormat.h"
@@ -26,6 +29,10 @@ core::AppState VoxConvert::onConstruct() {
 	registerArg("--merge").setShort("-m").setDescription("Merge layers into one volume");
 	registerArg("--scale").setShort("-s").setDescription("Scale layer to 50% of its original size");
 	registerArg("--force").setShort("-f").setDescription("Overwrite existing files");
+	registerArg("--batch").setShort("-b").setDescription("Convert all supported files of the given directory or manifest file");
+	registerArg("--output").setShort("-o").setDescription("The output directory for the batch mode - must differ from an input directory");
+	registerArg("--format").setDescription("The target format extension for the batch mode").setDefaultValue("vox");
+	registerArg("--threads").setShort("-t").setDescription("The amount of conversion threads for the batch mode");
 
 	_palette = core::Var::get("palette", voxel::getDefaultPaletteName());
 	_palette->setHelp("Specify the palette base name or absolute png file to use (1x256)");
@@ -33,6 +40,85 @@ core::AppState VoxConvert::onConstruct() {
 	return state;
 }
 
+core::String VoxConvert::optionsKey() const {
+	return core::string::format("m%is%ip%s", _merge ? 1 : 0, _scale ? 1 : 0, _palette->strVal().c_str());
+}
+
+bool VoxConvert::convert(const io::FilePtr& inputFile, const io::FilePtr& outputFile) const {
+	voxel::VoxelVolumes volumes;
+	if (!voxelformat::loadVolumeFormat(inputFile, volumes)) {
+		Log::error("Failed to load given input file '%s'", inputFile->name().c_str());
+		return false;
+	}
+
+	if (_merge) {
+		voxel::RawVolume* merged = volumes.merge();
+		if (merged == nullptr) {
+			Log::error("Failed to merge volumes");
+			voxelformat::clearVolumes(volumes);
+			return false;
+		}
+		voxelformat::clearVolumes(volumes);
+		volumes.push_back(voxel::VoxelVolume(merged));
+	}
+
+	if (_scale) {
+		for (auto& v : volumes) {
+			const voxel::Region srcRegion = v.volume->region();
+			const glm::ivec3& targetDimensionsHalf = (srcRegion.getDimensionsInVoxels() / 2) - 1;
+			const voxel::Region destRegion(srcRegion.getLowerCorner(), srcRegion.getLowerCorner() + targetDimensionsHalf);
+			voxel::RawVolume* destVolume = new voxel::RawVolume(destRegion);
+			rescaleVolume(*v.volume, *destVolume);
+			delete v.volume;
+			v.volume = destVolume;
+		}
+	}
+
+	if (!voxelformat::saveVolumeFormat(outputFile, volumes)) {
+		voxelformat::clearVolumes(volumes);
+		Log::error("Failed to write to output file '%s'", outputFile->name().c_str());
+		return false;
+	}
+
+	voxelformat::clearVolumes(volumes);
+	return true;
+}
+
+core::AppState VoxConvert::runBatch(const core::String& input) {
+	const core::String& outputDir = getArgVal("--output", getArgVal("-o", "."));
+	const core::String& format = getArgVal("--format", "vox");
+	const int threads = core_max(1, core::string::toInt(getArgVal("--threads", getArgVal("-t", core::string::toString(core::cpus())))));
+	const bool force = hasArg("--force") || hasArg("-f");
+
+	voxconvert::BatchConverter converter(filesystem(), outputDir, format, optionsKey(),
+			[this] (const io::FilePtr& inputFile, const io::FilePtr& outputFile) {
+		return convert(inputFile, outputFile);
+	});
+	std::vector<core::String> extensions;
+	core::string::splitString(voxelformat::SUPPORTED_VOXEL_FORMATS_LOAD, extensions, ",");
+	voxconvert::BatchConverter::Jobs jobs;
+	if (!converter.collectJobs(input, extensions, jobs)) {
+		return core::AppState::InitFailure;
+	}
+
+	Log::info("Converting %i files with %i threads", (int)jobs.size(), threads);
+	const uint64_t start = core::TimeProvider::systemMillis();
+	voxconvert::BatchConverter::Stats stats;
+	if (!converter.run(jobs, threads, force, stats)) {
+		return core::AppState::InitFailure;
+	}
+
+	const uint64_t millis = core_max((uint64_t)1u, core::TimeProvider::systemMillis() - start);
+	const double seconds = (double)millis / 1000.0;
+	Log::info("Converted: %i, skipped: %i, failed: %i in %.2fs (%.2f files/s, %.2f MB/s)",
+			stats.converted, stats.skipped, stats.failed, seconds, (double)jobs.size() / seconds,
+			(double)stats.bytes / (1024.0 * 1024.0) / seconds);
+	if (stats.failed > 0) {
+		_exitCode = 1;
+	}
+	return core::AppState::Running;
+}
+
 core::AppState VoxConvert::onInit() {
 	const core::AppState state = Super::onInit();
 	if (state != core::AppState::Running) {
@@ -40,7 +126,8 @@ core::AppState VoxConvert::onInit() {
 		return state;
 	}
 
-	if (_argc < 2) {
+	const bool batch = hasArg("--batch") || hasArg("-b");
+	if (_argc < 2 || (batch && _argc < 3)) {
 		_logLevelVar->setVal(SDL_LOG_PRIORITY_INFO);
 		Log::init();
 		usage();
@@ -56,6 +143,18 @@ core::AppState VoxConvert::onInit() {
 		return core::AppState::InitFailure;
 	}
 
+	_merge = hasArg("--merge") || hasArg("-m");
+	_scale = hasArg("--scale") || hasArg("-s");
+
+	if (batch) {
+		const core::String& input = getArgVal("--batch");
+		const core::AppState batchState = runBatch(input);
+		if (batchState != core::AppState::Running) {
+			return batchState;
+		}
+		return state;
+	}
+
 	const core::String infile = _argv[_argc - 2];
 	const core::String outfile = _argv[_argc - 1];
 
@@ -81,43 +180,11 @@ core::AppState VoxConvert::onInit() {
 		}
 	}
 
-	voxel::VoxelVolumes volumes;
-	if (!voxelformat::loadVolumeFormat(inputFile, volumes)) {
-		Log::error("Failed to load given input file");
-		return core::AppState::InitFailure;
-	}
-
-	if (hasArg("--merge") || hasArg("-m")) {
-		voxel::RawVolume* merged = volumes.merge();
-		if (merged == nullptr) {
-			Log::error("Failed to merge volumes");
-			return core::AppState::InitFailure;
-		}
-		voxelformat::clearVolumes(volumes);
-		volumes.push_back(voxel::VoxelVolume(merged));
-	}
-
-	if (hasArg("--scale") || hasArg("-s")) {
-		for (auto& v : volumes) {
-			const voxel::Region srcRegion = v.volume->region();
-			const glm::ivec3& targetDimensionsHalf = (srcRegion.getDimensionsInVoxels() / 2) - 1;
-			const voxel::Region destRegion(srcRegion.getLowerCorner(), srcRegion.getLowerCorner() + targetDimensionsHalf);
-			voxel::RawVolume* destVolume = new voxel::RawVolume(destRegion);
-			rescaleVolume(*v.volume, *destVolume);
-			delete v.volume;
-			v.volume = destVolume;
-		}
-	}
-
-	if (!voxelformat::saveVolumeFormat(outputFile, volumes)) {
-		voxelformat::clearVolumes(volumes);
-		Log::error("Failed to write to output file '%s'", outfile.c_str());
+	if (!convert(inputFile, outputFile)) {
 		return core::AppState::InitFailure;
 	}
 	Log::info("Wrote output file %s", outputFile->name().c_str());
 
-	voxelformat::clearVolumes(volumes);
-
 	return state;
 }
 
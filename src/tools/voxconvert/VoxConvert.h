@@ -5,6 +5,7 @@
 #pragma once
 
 #include "core/CommandlineApp.h"
+#include "core/io/File.h"
 
 /**
  * @brief This tool is able to convert voxel volumes between different formats
@@ -15,6 +16,16 @@ class VoxConvert: public core::CommandlineApp {
 private:
 	using Super = core::CommandlineApp;
 	core::VarPtr _palette;
+	bool _merge = false;
+	bool _scale = false;
+
+	bool convert(const io::FilePtr& inputFile, const io::FilePtr& outputFile) const;
+	core::AppState runBatch(const core::String& input);
+	/**
+	 * @return A string that identifies the conversion options - the content hashes are only
+	 * valid for the same options
+	 */
+	core::String optionsKey() const;
 public:
 	VoxConvert(const metric::MetricPtr& metric, const io::FilesystemPtr& filesystem, const core::EventBusPtr& eventBus, const core::TimeProviderPtr& timeProvider);
 
@@ -0,0 +1,169 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "../BatchConverter.h"
+#include <algorithm>
+#include <atomic>
+
+namespace voxconvert {
+
+class BatchConverterTest: public core::AbstractTest {
+protected:
+	std::vector<core::String> _extensions { "vox", "qb" };
+	std::atomic_int _conversions { 0 };
+	core::String _inputDir;
+	core::String _outputDir;
+
+	bool onInitApp() override {
+		const io::FilesystemPtr& fs = io::filesystem();
+		if (!fs->createDir("batchconvertertest/input with spaces") || !fs->createDir("batchconvertertest/output")) {
+			return false;
+		}
+		_inputDir = io::Filesystem::absolutePath("batchconvertertest/input with spaces");
+		_outputDir = io::Filesystem::absolutePath("batchconvertertest/output");
+		// start every test with empty directories and an empty cache
+		fs->removeFile(_outputDir + "/" + BatchConverter::CacheFile);
+		for (const char* name : { "a.vox", "a.qb", "b c.vox" }) {
+			fs->removeFile(_inputDir + "/" + name);
+			fs->removeFile(_outputDir + "/" + name + ".qbt");
+		}
+		return true;
+	}
+
+	BatchConverter converter() {
+		return BatchConverter(io::filesystem(), _outputDir, "qbt", "options",
+				[this] (const io::FilePtr& inputFile, const io::FilePtr& outputFile) {
+			++_conversions;
+			const core::String& content = inputFile->load();
+			return outputFile->write((const unsigned char*)content.c_str(), content.size()) == (long)content.size();
+		});
+	}
+
+	void writeInput(const core::String& name, const core::String& content) {
+		ASSERT_TRUE(io::filesystem()->syswrite(_inputDir + "/" + name, content));
+	}
+
+	static void sort(BatchConverter::Jobs& jobs) {
+		std::sort(jobs.begin(), jobs.end(), [] (const BatchConverter::Job& a, const BatchConverter::Job& b) {
+			return a.infile < b.infile;
+		});
+	}
+};
+
+TEST_F(BatchConverterTest, testDirectory) {
+	writeInput("a.vox", "a");
+	writeInput("b c.vox", "b");
+	writeInput("ignored.txt", "ignored");
+	const BatchConverter& batch = converter();
+	BatchConverter::Jobs jobs;
+	ASSERT_TRUE(batch.collectJobs(_inputDir, _extensions, jobs));
+	sort(jobs);
+	ASSERT_EQ(2u, jobs.size());
+	EXPECT_EQ(_inputDir + "/a.vox", jobs[0].infile);
+	EXPECT_EQ(_outputDir + "/a.vox.qbt", jobs[0].outfile);
+	EXPECT_EQ(_inputDir + "/b c.vox", jobs[1].infile);
+	EXPECT_EQ(_outputDir + "/b c.vox.qbt", jobs[1].outfile);
+
+	BatchConverter::Stats stats;
+	ASSERT_TRUE(batch.run(jobs, 2, false, stats));
+	EXPECT_EQ(2, stats.converted);
+	EXPECT_EQ(0, stats.failed);
+	EXPECT_EQ("b", io::filesystem()->load(_outputDir + "/b c.vox.qbt"));
+}
+
+TEST_F(BatchConverterTest, testSameBasename) {
+	writeInput("a.vox", "a");
+	writeInput("a.qb", "a");
+	BatchConverter::Jobs jobs;
+	ASSERT_TRUE(converter().collectJobs(_inputDir, _extensions, jobs));
+	sort(jobs);
+	ASSERT_EQ(2u, jobs.size());
+	EXPECT_EQ(_outputDir + "/a.qb.qbt", jobs[0].outfile);
+	EXPECT_EQ(_outputDir + "/a.vox.qbt", jobs[1].outfile);
+}
+
+TEST_F(BatchConverterTest, testOutputIsInputDirectory) {
+	writeInput("a.vox", "a");
+	const BatchConverter batch(io::filesystem(), _inputDir, "qbt", "options",
+			[] (const io::FilePtr&, const io::FilePtr&) { return true; });
+	BatchConverter::Jobs jobs;
+	EXPECT_FALSE(batch.collectJobs(_inputDir, _extensions, jobs));
+}
+
+TEST_F(BatchConverterTest, testMissingInput) {
+	writeInput("a.vox", "a");
+	const BatchConverter& batch = converter();
+	BatchConverter::Jobs jobs;
+	jobs.push_back(BatchConverter::Job{_inputDir + "/missing.vox", batch.outfile(_inputDir + "/missing.vox")});
+	jobs.push_back(BatchConverter::Job{_inputDir + "/a.vox", batch.outfile(_inputDir + "/a.vox")});
+	BatchConverter::Stats stats;
+	ASSERT_TRUE(batch.run(jobs, 2, false, stats));
+	EXPECT_EQ(1, stats.converted);
+	EXPECT_EQ(1, stats.failed);
+	EXPECT_EQ(1, _conversions);
+	EXPECT_EQ("a", io::filesystem()->load(_outputDir + "/a.vox.qbt"));
+}
+
+TEST_F(BatchConverterTest, testManifest) {
+	writeInput("a.vox", "a");
+	writeInput("b c.vox", "b");
+	const core::String manifest = _inputDir + "/manifest.txt";
+	ASSERT_TRUE(io::filesystem()->syswrite(manifest,
+			"# comment\n" + _inputDir + "/b c.vox\n" + _inputDir + "/a.vox\t" + _outputDir + "/out put.qbt\r\n"));
+	BatchConverter::Jobs jobs;
+	ASSERT_TRUE(converter().collectJobs(manifest, _extensions, jobs));
+	ASSERT_EQ(2u, jobs.size());
+	EXPECT_EQ(_inputDir + "/b c.vox", jobs[0].infile);
+	EXPECT_EQ(_outputDir + "/b c.vox.qbt", jobs[0].outfile);
+	EXPECT_EQ(_inputDir + "/a.vox", jobs[1].infile);
+	EXPECT_EQ(_outputDir + "/out put.qbt", jobs[1].outfile);
+}
+
+TEST_F(BatchConverterTest, testManifestCollision) {
+	const core::String manifest = _inputDir + "/collision.txt";
+	ASSERT_TRUE(io::filesystem()->syswrite(manifest,
+			_inputDir + "/a.vox\tsame.qbt\n" + _inputDir + "/a.qb\tsame.qbt\n"));
+	BatchConverter::Jobs jobs;
+	EXPECT_FALSE(converter().collectJobs(manifest, _extensions, jobs));
+}
+
+TEST_F(BatchConverterTest, testIncremental) {
+	writeInput("a.vox", "a");
+	writeInput("b c.vox", "b");
+	const BatchConverter& batch = converter();
+	BatchConverter::Jobs jobs;
+	jobs.push_back(BatchConverter::Job{_inputDir + "/a.vox", batch.outfile(_inputDir + "/a.vox")});
+	jobs.push_back(BatchConverter::Job{_inputDir + "/b c.vox", batch.outfile(_inputDir + "/b c.vox")});
+
+	BatchConverter::Stats first;
+	ASSERT_TRUE(batch.run(jobs, 1, false, first));
+	EXPECT_EQ(2, first.converted);
+	EXPECT_EQ(2, _conversions);
+
+	// nothing changed - both files are known to the cache, even the one with spaces in the name
+	BatchConverter::Stats second;
+	ASSERT_TRUE(batch.run(jobs, 1, false, second));
+	EXPECT_EQ(0, second.converted);
+	EXPECT_EQ(2, second.skipped);
+	EXPECT_EQ(2, _conversions);
+
+	writeInput("b c.vox", "changed");
+	BatchConverter::Stats third;
+	ASSERT_TRUE(batch.run(jobs, 1, false, third));
+	EXPECT_EQ(1, third.converted);
+	EXPECT_EQ(1, third.skipped);
+	EXPECT_EQ(3, _conversions);
+	EXPECT_EQ("changed", io::filesystem()->load(_outputDir + "/b c.vox.qbt"));
+
+	// the cached hashes are only valid for the same options - and existing files are not overwritten
+	const BatchConverter other(io::filesystem(), _outputDir, "qbt", "other options",
+			[] (const io::FilePtr&, const io::FilePtr&) { return true; });
+	BatchConverter::Stats fourth;
+	ASSERT_TRUE(other.run(jobs, 1, false, fourth));
+	EXPECT_EQ(0, fourth.skipped);
+	EXPECT_EQ(2, fourth.failed);
+}
+
+}
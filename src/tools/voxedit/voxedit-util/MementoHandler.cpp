@@ -12,6 +12,7 @@
 #include "core/StandardLib.h"
 #include "core/Log.h"
 #include "core/Zip.h"
+#include <utility>
 
 namespace voxedit {
 